@@ -4,6 +4,9 @@
 #include "cryptoauthlib.h"
 #include "mbedtls/atca_mbedtls_wrap.h"
 #include "esp_log.h"
+#ifdef CONFIG_ATCA_ENTROPY_POOL
+#include "atca_entropy_pool.h"
+#endif
 
 #include "i2c_device.h"
 #include "atecc608.h"
@@ -109,8 +112,22 @@ ATCA_STATUS Atecc608_Init() {
                 handleErr();
             }
             ESP_LOGI(TAG, "ok: %02x %02x", buf[2], buf[3]);
+#ifdef CONFIG_ATCA_ENTROPY_POOL
+            ESP_LOGI(TAG, "Filling the random number pool...");
+            if (atca_entropy_pool_init() != 0) {
+                ESP_LOGE(TAG, "*FAILED* could not fill the random number pool");
+            }
+#endif
         }
     }
 
     return ret;
 }
+
+int Atecc608_GetRandom(uint8_t *buf, size_t len) {
+#ifdef CONFIG_ATCA_ENTROPY_POOL
+    return atca_entropy_pool_random(NULL, buf, len);
+#else
+    return mbedtls_ctr_drbg_random(&ctr_drbg, buf, len);
+#endif
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "stdio.h"
+#include "stdint.h"
 
 /** @brief I2C port the ATECC608 uses to communicate with the ESP32-D0WD main MCU */
 /* @[declare_atecc608_i2c_port] */
@@ -53,4 +54,23 @@ ATCA_STATUS Atecc608_Init();
  */
 /* @[declare_atecc608_getserialstring] */
 ATCA_STATUS Atecc608_GetSerialString(char * sn);
-/* @[declare_atecc608_getserialstring] */
\ No newline at end of file
+/* @[declare_atecc608_getserialstring] */
+
+/**
+ * @brief Fills a buffer with random bytes.
+ * 
+ * With the ATECC608 random number pool enabled in menuconfig, the
+ * bytes come from a CTR-DRBG seeded from random numbers the ATECC608
+ * generated earlier, so this call does not use the I2C bus. Use it for
+ * nonces and client tokens.
+ * 
+ * @note Call Atecc608_Init() first.
+ * 
+ * @param[out] buf Buffer to fill.
+ * @param[in] len Number of random bytes to write to buf.
+ * 
+ * @return 0 on success, otherwise an mbedTLS error code.
+ */
+/* @[declare_atecc608_getrandom] */
+int Atecc608_GetRandom(uint8_t *buf, size_t len);
+/* @[declare_atecc608_getrandom] */
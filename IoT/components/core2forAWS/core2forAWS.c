@@ -266,15 +266,32 @@ void Core2ForAWS_Sk6812_Clear(void) {
 
 #define DISPLAY_BRIGHTNESS_MIN_VOLT 2200
 #define DISPLAY_BRIGHTNESS_MAX_VOLT 3300
-#define LV_TICK_PERIOD_MS 1
+#define GUI_IDLE_WAKE_MS 1000   // longest sleep, picks up LVGL changes that invalidate nothing
 
 SemaphoreHandle_t xGuiSemaphore;
 
+static void (*gui_update_cb)(void);
+static volatile uint32_t gui_hold_max_us;
+static volatile uint32_t gui_redrawn_px;
+static volatile uint32_t gui_spi_bytes;
+static volatile uint32_t gui_frames;
+static volatile uint32_t gui_frame_us;
+static volatile uint32_t gui_frame_max_us;
+static TaskHandle_t gui_task_handle;
+static int64_t gui_tick_us;
+
 static void guiTask(void *pvParameter);
-static void lv_tick_task(void *arg);
+static void display_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
+static void display_monitor(lv_disp_drv_t * drv, uint32_t time, uint32_t px);
+static void display_invalidate(lv_disp_drv_t * drv);
 
 #if CONFIG_SOFTWARE_FT6336U_SUPPORT
+static lv_indev_t *touch_indev;
+static volatile bool touch_pending;
+static bool touch_released;
+
 static bool ft6336u_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
+static void ft6336u_touched(void);
 #endif
 
 void Core2ForAWS_Display_Init(void) {
@@ -294,15 +311,17 @@ void Core2ForAWS_Display_Init(void) {
     static lv_disp_buf_t disp_buf;
 
     uint32_t size_in_px = DISP_BUF_SIZE;
-    lv_color_t *buf1 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT); //Assuming max size of lv_color_t = 16bit, DISP_BUF_SIZE calculated from max horizontal display size 480
-    lv_color_t *buf2 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT); //Assuming max size of lv_color_t = 16bit, DISP_BUF_SIZE calculated from max horizontal display size 480
+    lv_color_t *buf1 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), DISP_BUF_CAPS); //Assuming max size of lv_color_t = 16bit, DISP_BUF_SIZE calculated from max horizontal display size 480
+    lv_color_t *buf2 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), DISP_BUF_CAPS); //Assuming max size of lv_color_t = 16bit, DISP_BUF_SIZE calculated from max horizontal display size 480
     
     /* Initialize the working buffer depending on the selected display */
     lv_disp_buf_init(&disp_buf, buf1, buf2, size_in_px);
 
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
-    disp_drv.flush_cb = disp_driver_flush;
+    disp_drv.flush_cb = display_flush;
+    disp_drv.monitor_cb = display_monitor;
+    disp_drv.invalidate_cb = display_invalidate;
 
     disp_drv.buffer = &disp_buf;
     lv_disp_drv_register(&disp_drv);
@@ -313,21 +332,60 @@ void Core2ForAWS_Display_Init(void) {
     lv_indev_drv_init(&indev_drv);
     indev_drv.read_cb = ft6336u_read;
     indev_drv.type = LV_INDEV_TYPE_POINTER;
-    lv_indev_drv_register(&indev_drv);
+    touch_indev = lv_indev_drv_register(&indev_drv);
+    FT6336U_SetTouchCallback(ft6336u_touched);
 #endif
 
-    /* Create and start a periodic timer interrupt to call lv_tick_inc */
-    const esp_timer_create_args_t periodic_timer_args = {
-        .callback = &lv_tick_task,
-        .name = "periodic_gui"
-    };
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, LV_TICK_PERIOD_MS * 1000));
+    /* The gui task advances lv_tick itself, no periodic timer needed */
+    gui_tick_us = esp_timer_get_time();
+
+    xSemaphoreGive(xGuiSemaphore);
+
+    xTaskCreatePinnedToCore(guiTask, "gui", 4096*2, NULL, 2, &gui_task_handle, 1);
+}
+
+void Core2ForAWS_Display_Wake(void) {
+    TaskHandle_t task = gui_task_handle;
+    if (task != NULL && task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(task);
+    }
+}
 
+void Core2ForAWS_Display_SetUpdateCallback(void (*update_cb)(void)) {
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    gui_update_cb = update_cb;
     xSemaphoreGive(xGuiSemaphore);
+}
+
+uint32_t Core2ForAWS_Display_GetMaxHoldTime(void) {
+    return gui_hold_max_us;
+}
+
+void Core2ForAWS_Display_GetRedrawStats(uint32_t *redrawn_px, uint32_t *spi_bytes) {
+    *redrawn_px = gui_redrawn_px;
+    *spi_bytes = gui_spi_bytes;
+}
 
-    xTaskCreatePinnedToCore(guiTask, "gui", 4096*2, NULL, 2, NULL, 1);
+void Core2ForAWS_Display_GetFrameStats(uint32_t *frames, uint32_t *frame_us, uint32_t *frame_max_us) {
+    *frames = gui_frames;
+    *frame_us = gui_frame_us;
+    *frame_max_us = gui_frame_max_us;
+}
+
+static void display_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map) {
+    // 3 command bytes, 8 bytes of column/page addresses, then the pixels
+    gui_spi_bytes += 11 + lv_area_get_size(area) * sizeof(lv_color_t);
+    disp_driver_flush(drv, area, color_map);
+}
+
+// an object changed outside the gui task, it has to redraw before its next deadline
+static void display_invalidate(lv_disp_drv_t * drv) {
+    Core2ForAWS_Display_Wake();
+}
+
+// called by lvgl after every refresh with the number of pixels it redrew
+static void display_monitor(lv_disp_drv_t * drv, uint32_t time, uint32_t px) {
+    gui_redrawn_px += px;
 }
 
 void Core2ForAWS_Display_SetBrightness(uint8_t brightness) {
@@ -352,36 +410,93 @@ static bool ft6336u_read(lv_indev_drv_t * drv, lv_indev_data_t * data) {
     data->point.x = x;
     data->point.y = y;
     data->state = valid == false ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR;
+    touch_released = !valid;
     return false;
 }
+
+// FT6336Task read new touch data
+static void ft6336u_touched(void) {
+    touch_pending = true;
+    Core2ForAWS_Display_Wake();
+}
+
+/* Polls the touch panel only between a press and the read that saw its
+ * release, the FT6336U interrupt restarts the polling */
+static void gui_touch_update(void) {
+    lv_task_t *read_task = touch_indev->driver.read_task;
+
+    if (touch_pending) {
+        touch_pending = false;
+        lv_task_set_prio(read_task, LV_TASK_PRIO_HIGH);
+        lv_task_ready(read_task);
+    } else if (touch_released) {
+        lv_task_set_prio(read_task, LV_TASK_PRIO_OFF);
+    }
+}
 #endif
 
-static void lv_tick_task(void *arg) {
-    (void) arg;
-    lv_tick_inc(LV_TICK_PERIOD_MS);
+/* Advances lv_tick by the time passed since the last call */
+static void gui_tick_update(void) {
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - gui_tick_us) / 1000);
+    if (elapsed_ms > 0) {
+        lv_tick_inc(elapsed_ms);
+        gui_tick_us += elapsed_ms * 1000;
+    }
 }
 
 /**
- * @brief The FreeRTOS task that periodically calls lv_task_handler
+ * @brief The FreeRTOS task that calls lv_task_handler
  * 
  * A FreeRTOS task function that calls [lv_task_handler](https://docs.lvgl.io/7.11/porting/task-handler.html)
- * after a tick (depends on task prioritization), which executes 
- * LVGL tasks to then pass to the display controller. Learn more 
- * about LVGL Tasks[https://docs.lvgl.io/7.11/overview/task.html].
+ * when the next LVGL task is due, which executes LVGL tasks to then
+ * pass to the display controller. Learn more about LVGL
+ * Tasks[https://docs.lvgl.io/7.11/overview/task.html].
+ * In between it sleeps until then, or until an object gets invalidated,
+ * the touch panel reports new data or Core2ForAWS_Display_Wake() is called.
  */
 static void guiTask(void *pvParameter) {
     
     (void) pvParameter;
 
+    uint32_t next_ms = 0;
 
     while (1) {
-        /* Delay 1 tick (assumes FreeRTOS tick is 10ms */
-        vTaskDelay(pdMS_TO_TICKS(10));
+        /* Sleep until the next LVGL task is due, rounded up to whole ticks */
+        TickType_t wait = (next_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        ulTaskNotifyTake(pdTRUE, wait > 0 ? wait : 1);
 
         /* Try to take the semaphore, call lvgl related function on success */
         if (pdTRUE == xSemaphoreTake(xGuiSemaphore, portMAX_DELAY)) {
-            lv_task_handler();
+            int64_t start_us = esp_timer_get_time();
+            gui_tick_update();
+#if CONFIG_SOFTWARE_FT6336U_SUPPORT
+            gui_touch_update();
+#endif
+            if (gui_update_cb != NULL) {
+                gui_update_cb();
+            }
+            uint32_t redrawn_px = gui_redrawn_px;
+            int64_t frame_start_us = esp_timer_get_time();
+            next_ms = lv_task_handler();
+            int64_t end_us = esp_timer_get_time();
+            uint32_t hold_us = (uint32_t)(end_us - start_us);
             xSemaphoreGive(xGuiSemaphore);
+
+            if (next_ms > GUI_IDLE_WAKE_MS) {
+                next_ms = GUI_IDLE_WAKE_MS;     // also covers LV_NO_TASK_READY
+            }
+            if (hold_us > gui_hold_max_us) {
+                gui_hold_max_us = hold_us;
+            }
+            /* A pass that redrew something rendered a frame */
+            if (redrawn_px != gui_redrawn_px) {
+                uint32_t frame_us = (uint32_t)(end_us - frame_start_us);
+                gui_frames++;
+                gui_frame_us += frame_us;
+                if (frame_us > gui_frame_max_us) {
+                    gui_frame_max_us = frame_us;
+                }
+            }
        }
     }
 
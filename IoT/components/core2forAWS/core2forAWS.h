@@ -434,6 +434,82 @@ void Core2ForAWS_Display_Init(void);
 /* @[declare_core2foraws_display_setbrightness] */
 void Core2ForAWS_Display_SetBrightness(uint8_t brightness);
 /* @[declare_core2foraws_display_setbrightness] */
+
+/**
+ * @brief Sets a function the gui task calls before each
+ * lv_task_handler() pass.
+ *
+ * The callback runs in the gui task with the xGuiSemaphore
+ * mutex already held, so it can use the LVGL API directly.
+ * Other tasks can hand it their display updates instead of
+ * taking the mutex themselves and waiting for a whole
+ * rendering pass.
+ *
+ * @param[in] update_cb the function to call, or NULL to
+ * remove it.
+ */
+/* @[declare_core2foraws_display_setupdatecallback] */
+void Core2ForAWS_Display_SetUpdateCallback(void (*update_cb)(void));
+/* @[declare_core2foraws_display_setupdatecallback] */
+
+/**
+ * @brief Wakes the gui task for an lv_task_handler() pass.
+ *
+ * The gui task sleeps until the next LVGL task is due. It wakes
+ * up by itself when an object gets invalidated or the screen is
+ * touched, and at least once a second. Call this function after
+ * handing the update callback new work, or after an LVGL change
+ * that should show sooner, e.g. starting an animation.
+ */
+/* @[declare_core2foraws_display_wake] */
+void Core2ForAWS_Display_Wake(void);
+/* @[declare_core2foraws_display_wake] */
+
+/**
+ * @brief Gets the longest time the gui task held the
+ * xGuiSemaphore mutex.
+ *
+ * This is the worst case a task taking xGuiSemaphore has to
+ * wait for one update callback and lv_task_handler() pass.
+ *
+ * @return the longest hold time in microseconds.
+ */
+/* @[declare_core2foraws_display_getmaxholdtime] */
+uint32_t Core2ForAWS_Display_GetMaxHoldTime(void);
+/* @[declare_core2foraws_display_getmaxholdtime] */
+
+/**
+ * @brief Gets how much display work the UI caused since boot.
+ *
+ * Both counters only grow; compare two readings to get the
+ * work done in between. Every redrawn pixel was invalidated
+ * by a change to an LVGL object, so the pixel count shows
+ * how much of the screen the application keeps dirtying.
+ *
+ * @param[out] redrawn_px the pixels LVGL rendered again.
+ * @param[out] spi_bytes the bytes sent to the ILI9342C to
+ * show them, including the command and address bytes.
+ */
+/* @[declare_core2foraws_display_getredrawstats] */
+void Core2ForAWS_Display_GetRedrawStats(uint32_t *redrawn_px, uint32_t *spi_bytes);
+/* @[declare_core2foraws_display_getredrawstats] */
+
+/**
+ * @brief Gets how long the gui task took to render frames.
+ *
+ * A frame is an lv_task_handler() pass that redrew part of the
+ * screen. Its time covers rendering and flushing all bands but
+ * the last, whose transfer overlaps whatever runs next. Compare
+ * two readings to get the average over an interval, e.g. with
+ * and without CONFIG_LV_DISP_FLUSH_PIPELINE.
+ *
+ * @param[out] frames frames rendered since boot.
+ * @param[out] frame_us their total time in microseconds.
+ * @param[out] frame_max_us the longest frame in microseconds.
+ */
+/* @[declare_core2foraws_display_getframestats] */
+void Core2ForAWS_Display_GetFrameStats(uint32_t *frames, uint32_t *frame_us, uint32_t *frame_max_us);
+/* @[declare_core2foraws_display_getframestats] */
 #endif
 
 /**
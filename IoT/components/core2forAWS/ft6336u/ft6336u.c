@@ -16,12 +16,14 @@ static bool _pressed;
 static I2CDevice_t ft6336u_i2c;
 static xTaskHandle ft6336_task_handle;
 static SemaphoreHandle_t thread_mutex;
+static void (*touch_cb)(void);
 
 static void IRAM_ATTR FT6336U_ISRHandler(void* arg);
 static void FT6336U_UpdateTask(void *arg);
 
 void FT6336U_Init() {
     ft6336u_i2c = i2c_malloc_device(I2C_NUM_1, 21, 22, 400000, FT6336U_I2C_ADDR);
+    i2c_device_set_priority(ft6336u_i2c, I2C_DEVICE_PRIORITY_HIGH);
     i2c_write_byte(ft6336u_i2c, 0xa4, 0x00);
     
     thread_mutex = xSemaphoreCreateMutex();
@@ -55,6 +57,10 @@ static void FT6336U_UpdateTask(void *arg) {
         press_stash = _pressed;
         xSemaphoreGive(thread_mutex);
 
+        if (touch_cb != NULL) {
+            touch_cb();
+        }
+
         if (press_stash == false) {
             vTaskSuspend(NULL);
         } else {
@@ -63,6 +69,10 @@ static void FT6336U_UpdateTask(void *arg) {
     }
 }
 
+void FT6336U_SetTouchCallback(void (*cb)(void)) {
+    touch_cb = cb;
+}
+
 void FT6336U_GetTouch(uint16_t* x, uint16_t* y, bool* press_down) {
     xSemaphoreTake(thread_mutex, portMAX_DELAY);
     *x = _x;
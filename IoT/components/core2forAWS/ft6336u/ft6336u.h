@@ -26,6 +26,20 @@
 void FT6336U_Init();
 /* @[declare_ft6336_init] */
 
+/**
+ * @brief Sets a function to call whenever new touch data was read.
+ *
+ * The function runs in the `FT6336Task` task right after the
+ * FT6336U reported a press, every 20 ticks while the screen
+ * stays pressed, and once more after the release. It lets a
+ * consumer sleep instead of polling FT6336U_GetTouch().
+ *
+ * @param[in] cb the function to call, or NULL to remove it.
+ */
+/* @[declare_ft6336_settouchcallback] */
+void FT6336U_SetTouchCallback(void (*cb)(void));
+/* @[declare_ft6336_settouchcallback] */
+
 /**
  * @brief Retrieves the most recent touch data from the FT6336U.
  * 
@@ -1,9 +1,14 @@
+#include <string.h>
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #include "driver/i2c.h"
+#include "soc/soc.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 #include "i2c_device.h"
 
@@ -30,6 +35,18 @@
 #define I2C_TIMEOUT_MS (100) // 1000ms
 #define MAX_DEVICE_NUMBER 24
 
+// A queued transaction gains one priority level for every this much waiting
+#ifndef I2C_PRIORITY_AGING_MS
+#define I2C_PRIORITY_AGING_MS (50)
+#endif
+
+#ifndef CONFIG_I2C_BUS_SCHEDULER_PRIORITY
+#define CONFIG_I2C_BUS_SCHEDULER_PRIORITY (5)
+#endif
+
+// Clock cycles the SCL timeout of the controller lasts, as i2c_param_config() sets it
+#define I2C_TIMEOUT_CYCLES (8)
+
 typedef struct _i2c_port_obj_t {
     i2c_port_t port;
     gpio_num_t scl;
@@ -37,17 +54,48 @@ typedef struct _i2c_port_obj_t {
     uint32_t freq;
 } i2c_port_obj_t;
 
+typedef struct _i2c_transaction_t {
+    i2c_cmd_handle_t *cmds;
+    size_t count;
+    esp_err_t err;
+    int64_t queued_us;
+    SemaphoreHandle_t done;
+    struct _i2c_transaction_t *next;
+} i2c_transaction_t;
+
 typedef struct _i2c_device_t {
     i2c_port_obj_t* i2c_port;
     uint8_t addr;
+    i2c_device_priority_t priority;
+    i2c_transaction_t *queue_head;
+    i2c_transaction_t *queue_tail;
+    i2c_device_stats_t stats;
+    struct _i2c_device_t *next;
 } i2c_device_t;
 
+// What the controller of a port is set up for, freq is 0 while no driver is installed
+typedef struct _i2c_bus_t {
+    gpio_num_t scl;
+    gpio_num_t sda;
+    uint32_t freq;
+    i2c_device_t *devices;
+    TaskHandle_t task;
+    i2c_bus_stats_t stats;
+} i2c_bus_t;
+
 static SemaphoreHandle_t i2c_mutex[I2C_NUM_MAX];
-static i2c_port_obj_t *i2c_port_used[2] = { NULL, NULL };
+static i2c_bus_t i2c_bus[I2C_NUM_MAX];
+
+// Guards the device lists and their queues
+static portMUX_TYPE i2c_queue_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#ifdef CONFIG_I2C_BUS_SCHEDULER
+static void i2c_bus_task(void *arg);
+#endif
 
 I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl, uint32_t freq, uint8_t device_addr) {
-    if (i2c_num > I2C_NUM_MAX) {
-        i2c_num = I2C_NUM_MAX;
+    if (i2c_num >= I2C_NUM_MAX) {
+        i2c_num = I2C_NUM_MAX - 1;
     }
 
     if (i2c_mutex[0] == NULL) {
@@ -55,7 +103,7 @@ I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl
     }
 
     if (i2c_mutex[1] == NULL) {
-        i2c_mutex[1] = xSemaphoreCreateRecursiveMutex(); 
+        i2c_mutex[1] = xSemaphoreCreateRecursiveMutex();
     }
 
     i2c_port_obj_t* new_device_port = (i2c_port_obj_t *)malloc(sizeof(i2c_port_obj_t));
@@ -68,13 +116,29 @@ I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl
     new_device_port->freq = freq;
     new_device_port->port = i2c_num;
 
-    i2c_device_t* device = (i2c_device_t *)malloc(sizeof(i2c_device_t));
+    i2c_device_t* device = (i2c_device_t *)calloc(1, sizeof(i2c_device_t));
     if (device == NULL) {
+        free(new_device_port);
         return NULL;
     }
 
     device->i2c_port = new_device_port;
     device->addr = device_addr;
+    device->priority = I2C_DEVICE_PRIORITY_NORMAL;
+
+    portENTER_CRITICAL(&i2c_queue_lock);
+    device->next = i2c_bus[i2c_num].devices;
+    i2c_bus[i2c_num].devices = device;
+    portEXIT_CRITICAL(&i2c_queue_lock);
+
+#ifdef CONFIG_I2C_BUS_SCHEDULER
+    xSemaphoreTakeRecursive(i2c_mutex[i2c_num], portMAX_DELAY);
+    if (i2c_bus[i2c_num].task == NULL) {
+        xTaskCreate(i2c_bus_task, "i2c_bus", 2 * 1024, (void *)(intptr_t)i2c_num, CONFIG_I2C_BUS_SCHEDULER_PRIORITY, &i2c_bus[i2c_num].task);
+    }
+    xSemaphoreGiveRecursive(i2c_mutex[i2c_num]);
+#endif
+
     log_i("New device malloc, scl: %d, sda: %d, freq: %d HZ",
         device->i2c_port->scl, device->i2c_port->sda, device->i2c_port->freq);
 
@@ -85,8 +149,27 @@ void i2c_free_device(I2CDevice_t i2c_device) {
     if (i2c_device == NULL) {
         return ;
     }
-    free(((i2c_device_t *)i2c_device)->i2c_port);
-    free(i2c_device);
+
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    portENTER_CRITICAL(&i2c_queue_lock);
+    i2c_device_t** link = &i2c_bus[device->i2c_port->port].devices;
+    while (*link != NULL && *link != device) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = device->next;
+    }
+    portEXIT_CRITICAL(&i2c_queue_lock);
+
+    free(device->i2c_port);
+    free(device);
+}
+
+void i2c_device_set_priority(I2CDevice_t i2c_device, i2c_device_priority_t priority) {
+    if (i2c_device == NULL) {
+        return ;
+    }
+    ((i2c_device_t *)i2c_device)->priority = priority;
 }
 
 BaseType_t i2c_take_port(i2c_port_t i2c_num, uint32_t timeout) {
@@ -105,50 +188,66 @@ BaseType_t i2c_free_port(i2c_port_t i2c_num) {
     return xSemaphoreGiveRecursive(i2c_mutex[i2c_num]);
 }
 
-esp_err_t i2c_apply_bus(I2CDevice_t i2c_device) {
-    if (i2c_device == NULL) {
-        return ESP_FAIL;
-    }
+// Same SCL and SDA timing i2c_param_config() derives from clk_speed, without resetting the controller
+static void i2c_bus_set_timing(i2c_port_t port, uint32_t freq) {
+    int cycle = APB_CLK_FREQ / freq;
+    int half_cycle = cycle / 2;
 
-    i2c_device_t* device = (i2c_device_t *)i2c_device;
-    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
-    i2c_port_obj_t* used_port = i2c_port_used[device->i2c_port->port];
-    
-    if (used_port == device->i2c_port) {
-        return ESP_OK;
-    }
+    i2c_set_period(port, half_cycle, half_cycle);
+    i2c_set_start_timing(port, half_cycle, half_cycle);
+    i2c_set_stop_timing(port, half_cycle, half_cycle);
+    i2c_set_data_timing(port, half_cycle / 2, half_cycle / 2);
+    i2c_set_timeout(port, cycle * I2C_TIMEOUT_CYCLES);
+}
 
-    if ((used_port != NULL) && 
-        (device->i2c_port->sda == used_port->sda) && 
-        (device->i2c_port->scl == used_port->scl) && 
-        ((device->i2c_port->freq == used_port->freq))) {
-            i2c_port_used[device->i2c_port->port] = device->i2c_port;
-            return ESP_OK;    
+// Port mutex must be held
+static void i2c_bus_configure(i2c_device_t* device) {
+    i2c_port_obj_t* want = device->i2c_port;
+    i2c_bus_t* bus = &i2c_bus[want->port];
+
+    if (bus->freq != 0 && bus->sda == want->sda && bus->scl == want->scl) {
+        if (bus->freq != want->freq) {
+            i2c_bus_set_timing(want->port, want->freq);
+            bus->freq = want->freq;
+            bus->stats.retimes++;
+            log_i("I2C freq update: %d HZ", want->freq);
+        }
+        return ;
     }
 
-    if (used_port != NULL) {
-        i2c_driver_delete(device->i2c_port->port);
-        if ((device->i2c_port->sda != used_port->sda) || (device->i2c_port->scl != used_port->scl)) {
-            gpio_reset_pin(used_port->sda);
-            gpio_reset_pin(used_port->scl);
-        }
+    if (bus->freq != 0) {
+        i2c_driver_delete(want->port);
+        gpio_reset_pin(bus->sda);
+        gpio_reset_pin(bus->scl);
     }
 
     i2c_config_t conf = {
         .mode = I2C_MODE_MASTER,
-        .sda_io_num = device->i2c_port->sda,
+        .sda_io_num = want->sda,
         .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_io_num = device->i2c_port->scl,
+        .scl_io_num = want->scl,
         .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = device->i2c_port->freq,
+        .master.clk_speed = want->freq,
     };
 
-    i2c_param_config(device->i2c_port->port, &conf);
-    i2c_driver_install(device->i2c_port->port, I2C_MODE_MASTER, 0, 0, 0);
+    i2c_param_config(want->port, &conf);
+    i2c_driver_install(want->port, I2C_MODE_MASTER, 0, 0, 0);
 
-    i2c_port_used[device->i2c_port->port] = device->i2c_port;
-    log_i("I2C config update, scl: %d, sda: %d, freq: %d HZ",
-            device->i2c_port->scl, device->i2c_port->sda, device->i2c_port->freq);
+    bus->sda = want->sda;
+    bus->scl = want->scl;
+    bus->freq = want->freq;
+    bus->stats.installs++;
+    log_i("I2C config update, scl: %d, sda: %d, freq: %d HZ", want->scl, want->sda, want->freq);
+}
+
+esp_err_t i2c_apply_bus(I2CDevice_t i2c_device) {
+    if (i2c_device == NULL) {
+        return ESP_FAIL;
+    }
+
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
+    i2c_bus_configure(device);
     return ESP_OK;
 }
 
@@ -160,41 +259,195 @@ void i2c_free_bus(I2CDevice_t i2c_device) {
     xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
 }
 
-esp_err_t i2c_read_bytes(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t *data, uint16_t length) {
-    if (i2c_device == NULL || (length > 0 && data == NULL)) {
+// Port mutex must be held
+static esp_err_t i2c_device_run(i2c_device_t* device, i2c_cmd_handle_t *cmds, size_t count) {
+    esp_err_t err = ESP_OK;
+    int64_t start_us = esp_timer_get_time();
+
+    i2c_bus_configure(device);
+    for (size_t i = 0; i < count && err == ESP_OK; i++) {
+        err = i2c_master_cmd_begin(device->i2c_port->port, cmds[i], pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    }
+
+    uint32_t busy_us = (uint32_t)(esp_timer_get_time() - start_us);
+    device->stats.transactions++;
+    device->stats.busy_us += busy_us;
+    if (busy_us > device->stats.busy_max_us) {
+        device->stats.busy_max_us = busy_us;
+    }
+    if (err != ESP_OK) {
+        device->stats.errors++;
+    }
+    return err;
+}
+
+#ifdef CONFIG_I2C_BUS_SCHEDULER
+// Device whose oldest transaction goes next, called with i2c_queue_lock held
+static i2c_device_t* i2c_bus_pick(i2c_bus_t* bus, int64_t now_us) {
+    i2c_device_t* best = NULL;
+    int64_t best_age = 0;
+    int best_priority = 0;
+    bool best_same_freq = false;
+
+    for (i2c_device_t* device = bus->devices; device != NULL; device = device->next) {
+        if (device->queue_head == NULL) {
+            continue;
+        }
+
+        int64_t age = now_us - device->queue_head->queued_us;
+        int priority = device->priority + (int)(age / (I2C_PRIORITY_AGING_MS * 1000));
+        bool same_freq = device->i2c_port->freq == bus->freq;
+
+        if (best == NULL || priority > best_priority ||
+            (priority == best_priority && (same_freq > best_same_freq ||
+                                           (same_freq == best_same_freq && age > best_age)))) {
+            best = device;
+            best_age = age;
+            best_priority = priority;
+            best_same_freq = same_freq;
+        }
+    }
+    return best;
+}
+
+static void i2c_bus_task(void *arg) {
+    i2c_port_t port = (i2c_port_t)(intptr_t)arg;
+    i2c_bus_t* bus = &i2c_bus[port];
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        for (;;) {
+            // Picked with the bus in hand, so a task holding the port cannot make the choice stale
+            xSemaphoreTakeRecursive(i2c_mutex[port], portMAX_DELAY);
+            int64_t now_us = esp_timer_get_time();
+
+            portENTER_CRITICAL(&i2c_queue_lock);
+            i2c_device_t* device = i2c_bus_pick(bus, now_us);
+            i2c_transaction_t* transaction = NULL;
+            if (device != NULL) {
+                transaction = device->queue_head;
+                device->queue_head = transaction->next;
+                if (device->queue_head == NULL) {
+                    device->queue_tail = NULL;
+                }
+            }
+            portEXIT_CRITICAL(&i2c_queue_lock);
+
+            if (transaction == NULL) {
+                xSemaphoreGiveRecursive(i2c_mutex[port]);
+                break;
+            }
+
+            uint32_t wait_us = (uint32_t)(now_us - transaction->queued_us);
+            device->stats.wait_us += wait_us;
+            if (wait_us > device->stats.wait_max_us) {
+                device->stats.wait_max_us = wait_us;
+            }
+
+            transaction->err = i2c_device_run(device, transaction->cmds, transaction->count);
+            xSemaphoreGiveRecursive(i2c_mutex[port]);
+            xSemaphoreGive(transaction->done);
+        }
+    }
+}
+#endif
+
+esp_err_t i2c_device_exec(I2CDevice_t i2c_device, i2c_cmd_handle_t *cmds, size_t count) {
+    if (i2c_device == NULL || (count > 0 && cmds == NULL)) {
         return ESP_FAIL;
     }
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
+    i2c_port_t port = device->i2c_port->port;
+    esp_err_t err;
+
+#ifdef CONFIG_I2C_BUS_SCHEDULER
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    // A task that holds the port runs its own transactions, the scheduler is waiting for it
+    if (i2c_bus[port].task != NULL && i2c_bus[port].task != self &&
+        xSemaphoreGetMutexHolder(i2c_mutex[port]) != self) {
+        StaticSemaphore_t done_buffer;
+        i2c_transaction_t transaction = {
+            .cmds = cmds,
+            .count = count,
+            .err = ESP_FAIL,
+            .queued_us = esp_timer_get_time(),
+            .done = xSemaphoreCreateBinaryStatic(&done_buffer),
+            .next = NULL,
+        };
+
+        portENTER_CRITICAL(&i2c_queue_lock);
+        if (device->queue_tail != NULL) {
+            device->queue_tail->next = &transaction;
+        } else {
+            device->queue_head = &transaction;
+        }
+        device->queue_tail = &transaction;
+        portEXIT_CRITICAL(&i2c_queue_lock);
 
-    i2c_cmd_handle_t write_cmd = i2c_cmd_link_create();
-    i2c_master_start(write_cmd);
-    i2c_master_write_byte(write_cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-    i2c_master_write_byte(write_cmd, reg_addr, 1);
-    i2c_master_stop(write_cmd);
+        xTaskNotifyGive(i2c_bus[port].task);
+        xSemaphoreTake(transaction.done, portMAX_DELAY);
+        vSemaphoreDelete(transaction.done);
+        return transaction.err;
+    }
+#endif
+
+    xSemaphoreTakeRecursive(i2c_mutex[port], portMAX_DELAY);
+    err = i2c_device_run(device, cmds, count);
+    xSemaphoreGiveRecursive(i2c_mutex[port]);
+    return err;
+}
 
-    i2c_cmd_handle_t read_cmd = i2c_cmd_link_create();
-    i2c_master_start(read_cmd);
-    i2c_master_write_byte(read_cmd, (device->addr << 1) | I2C_MASTER_READ, 1);
+// Register address write, then the read in a transaction of its own; returns the number of links
+static size_t i2c_build_reg_read(i2c_device_t* device, uint8_t reg_addr, uint8_t *data, uint16_t length, i2c_cmd_handle_t *cmds) {
+    cmds[0] = i2c_cmd_link_create();
+    i2c_master_start(cmds[0]);
+    i2c_master_write_byte(cmds[0], (device->addr << 1) | I2C_MASTER_WRITE, 1);
+    i2c_master_write_byte(cmds[0], reg_addr, 1);
+    i2c_master_stop(cmds[0]);
+
+    if (length == 0) {
+        return 1;
+    }
+
+    cmds[1] = i2c_cmd_link_create();
+    i2c_master_start(cmds[1]);
+    i2c_master_write_byte(cmds[1], (device->addr << 1) | I2C_MASTER_READ, 1);
     if (length > 1) {
-        i2c_master_read(read_cmd, data, length - 1, I2C_MASTER_ACK);
+        i2c_master_read(cmds[1], data, length - 1, I2C_MASTER_ACK);
     }
+    i2c_master_read_byte(cmds[1], &data[length-1], I2C_MASTER_NACK);
+    i2c_master_stop(cmds[1]);
+    return 2;
+}
+
+static i2c_cmd_handle_t i2c_build_reg_write(i2c_device_t* device, uint8_t reg_addr, uint8_t *data, uint16_t length) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
+    i2c_master_write_byte(cmd, reg_addr, 1);
     if (length > 0) {
-        i2c_master_read_byte(read_cmd, &data[length-1], I2C_MASTER_NACK);
+        i2c_master_write(cmd, data, length, 1);
     }
-    i2c_master_stop(read_cmd);
-
+    i2c_master_stop(cmd);
+    return cmd;
+}
 
-    i2c_apply_bus(i2c_device);
-    esp_err_t err = ESP_FAIL;
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    if (err == ESP_OK && length > 0) {
-        err = i2c_master_cmd_begin(device->i2c_port->port, read_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+esp_err_t i2c_read_bytes(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t *data, uint16_t length) {
+    if (i2c_device == NULL || (length > 0 && data == NULL)) {
+        return ESP_FAIL;
     }
-    i2c_free_bus(i2c_device);
 
-    i2c_cmd_link_delete(write_cmd);
-    i2c_cmd_link_delete(read_cmd);
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    i2c_cmd_handle_t cmds[2];
+
+    size_t count = i2c_build_reg_read(device, reg_addr, data, length, cmds);
+    esp_err_t err = i2c_device_exec(i2c_device, cmds, count);
+    for (size_t i = 0; i < count; i++) {
+        i2c_cmd_link_delete(cmds[i]);
+    }
 
     if (err != ESP_OK) {
         log_e("I2C Read Error: 0x%02x, reg: 0x%02x, length: %d, Code: 0x%x", device->addr, reg_addr, length, err);
@@ -227,11 +480,7 @@ esp_err_t i2c_read_bytes_no_stop(I2CDevice_t i2c_device, uint8_t reg_addr, uint8
     }
     i2c_master_stop(write_cmd);
 
-
-    i2c_apply_bus(i2c_device);
-    esp_err_t err = ESP_FAIL;
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
+    esp_err_t err = i2c_device_exec(i2c_device, &write_cmd, 1);
 
     i2c_cmd_link_delete(write_cmd);
 
@@ -262,7 +511,7 @@ esp_err_t i2c_read_bit(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t *data,
     }
 
     *data = (bit_data >> bit_pos) & 0x01;
-    return ESP_OK; 
+    return ESP_OK;
 }
 
 esp_err_t i2c_read_bits(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t *data, uint8_t bit_pos, uint8_t bit_length) {
@@ -290,21 +539,8 @@ esp_err_t i2c_write_bytes(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t *dat
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
 
-    i2c_cmd_handle_t write_cmd = i2c_cmd_link_create();
-    i2c_master_start(write_cmd);
-    i2c_master_write_byte(write_cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-    i2c_master_write_byte(write_cmd, reg_addr, 1);
-    if (length > 0) {
-        i2c_master_write(write_cmd, data, length, 1);
-    }
-    i2c_master_stop(write_cmd);
-
-    esp_err_t err = ESP_FAIL;
-
-    i2c_apply_bus(i2c_device);
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
-
+    i2c_cmd_handle_t write_cmd = i2c_build_reg_write(device, reg_addr, data, length);
+    esp_err_t err = i2c_device_exec(i2c_device, &write_cmd, 1);
     i2c_cmd_link_delete(write_cmd);
 
     if (err != ESP_OK) {
@@ -354,20 +590,13 @@ esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t data,
 }
 
 esp_err_t i2c_device_change_freq(I2CDevice_t i2c_device, uint32_t freq) {
-    if (i2c_device == NULL) {
+    if (i2c_device == NULL || freq == 0) {
         return ESP_FAIL;
     }
     i2c_device_t* device = (i2c_device_t *)i2c_device;
+    // The bus is retimed before the device's next transaction
     xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
-    if (device->i2c_port->freq == freq) {
-        xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
-        return ESP_OK;
-    }
-
     device->i2c_port->freq = freq;
-    if (i2c_port_used[device->i2c_port->port] == device->i2c_port) {
-        i2c_port_used[device->i2c_port->port] = NULL;
-    }
     xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
     return ESP_OK;
 }
@@ -384,12 +613,37 @@ esp_err_t i2c_device_valid(I2CDevice_t i2c_device) {
     i2c_master_write_byte(write_cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
     i2c_master_stop(write_cmd);
 
-    esp_err_t err = ESP_FAIL;
-
-    i2c_apply_bus(i2c_device);
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
+    esp_err_t err = i2c_device_exec(i2c_device, &write_cmd, 1);
 
     i2c_cmd_link_delete(write_cmd);
     return err;
-}
\ No newline at end of file
+}
+
+void i2c_device_get_stats(I2CDevice_t i2c_device, i2c_device_stats_t *stats) {
+    if (i2c_device == NULL || stats == NULL) {
+        return ;
+    }
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
+    *stats = device->stats;
+    xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
+}
+
+void i2c_device_clear_stats(I2CDevice_t i2c_device) {
+    if (i2c_device == NULL) {
+        return ;
+    }
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
+    memset(&device->stats, 0, sizeof(device->stats));
+    xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
+}
+
+void i2c_bus_get_stats(i2c_port_t i2c_num, i2c_bus_stats_t *stats) {
+    if (i2c_num >= I2C_NUM_MAX || stats == NULL || i2c_mutex[i2c_num] == NULL) {
+        return ;
+    }
+    xSemaphoreTakeRecursive(i2c_mutex[i2c_num], portMAX_DELAY);
+    *stats = i2c_bus[i2c_num].stats;
+    xSemaphoreGiveRecursive(i2c_mutex[i2c_num]);
+}
@@ -4,6 +4,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
@@ -19,6 +20,35 @@ extern "C" {
 
 typedef void * I2CDevice_t;
 
+/*
+    Transactions of devices on the same port are executed one after another.
+    With CONFIG_I2C_BUS_SCHEDULER a task per port picks the next one: the
+    highest priority first, a transaction that waited I2C_PRIORITY_AGING_MS
+    gains a level, and among equal priorities the ones at the current bus
+    frequency go first, so the bus is retimed as rarely as possible.
+    A frequency change only retimes SCL, the driver is reinstalled only
+    when a device on other pins takes the port.
+*/
+typedef enum {
+    I2C_DEVICE_PRIORITY_LOW = 0,
+    I2C_DEVICE_PRIORITY_NORMAL,
+    I2C_DEVICE_PRIORITY_HIGH,
+} i2c_device_priority_t;
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t errors;
+    uint64_t wait_us;       // Time spent queued behind other devices
+    uint32_t wait_max_us;
+    uint64_t busy_us;       // Time the device occupied the bus
+    uint32_t busy_max_us;
+} i2c_device_stats_t;
+
+typedef struct {
+    uint32_t installs;      // Driver (re)installs
+    uint32_t retimes;       // Frequency changes without reinstall
+} i2c_bus_stats_t;
+
 I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl, uint32_t freq, uint8_t device_addr);
 
 void i2c_free_device(I2CDevice_t i2c_device);
@@ -65,6 +95,21 @@ esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint8_t reg_addr, uint8_t data,
 
 esp_err_t i2c_device_valid(I2CDevice_t i2c_device);
 
+// Default is I2C_DEVICE_PRIORITY_NORMAL
+void i2c_device_set_priority(I2CDevice_t i2c_device, i2c_device_priority_t priority);
+
+/*
+    Run prepared command links back to back, no other device gets the bus
+    in between. Stops at the first error. The caller keeps the links.
+*/
+esp_err_t i2c_device_exec(I2CDevice_t i2c_device, i2c_cmd_handle_t *cmds, size_t count);
+
+void i2c_device_get_stats(I2CDevice_t i2c_device, i2c_device_stats_t *stats);
+
+void i2c_device_clear_stats(I2CDevice_t i2c_device);
+
+void i2c_bus_get_stats(i2c_port_t i2c_num, i2c_bus_stats_t *stats);
+
 BaseType_t i2c_take_port(i2c_port_t i2c_num, uint32_t timeout);
 
 BaseType_t i2c_free_port(i2c_port_t i2c_num);
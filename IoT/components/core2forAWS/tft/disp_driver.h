@@ -20,7 +20,13 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+#if CONFIG_LV_DISP_FLUSH_PIPELINE
+#define DISP_BUF_SIZE  (LV_HOR_RES_MAX * CONFIG_LV_DISP_FLUSH_PIPELINE_LINES)
+#define DISP_BUF_CAPS  (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL)
+#else
 #define DISP_BUF_SIZE  (LV_HOR_RES_MAX * 64)
+#define DISP_BUF_CAPS  (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#endif
 
 /**********************
  *      TYPEDEFS
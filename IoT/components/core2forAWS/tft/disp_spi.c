@@ -21,11 +21,17 @@
 SemaphoreHandle_t spi_mutex;
 
 static void IRAM_ATTR spi_ready (spi_transaction_t *trans);
+static void IRAM_ATTR spi_pre_transfer (spi_transaction_t *trans);
 
 static spi_host_device_t spi_host;
 static spi_device_handle_t spi;
 static volatile uint8_t spi_pending_trans = 0;
 static transaction_cb_t chained_post_cb;
+static int dc_gpio = -1;
+
+/* Transactions of the sequence being queued, the driver keeps pointers to them */
+static spi_transaction_ext_t queued_trans[DISP_SPI_QUEUE_SIZE];
+static uint8_t queued_count;
 
 static uint8_t tft_used_spi_dma = 0;
 
@@ -50,6 +56,7 @@ void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_con
     spi_host=host;
     chained_post_cb=devcfg->post_cb;
     devcfg->post_cb=spi_ready;
+    devcfg->pre_cb=spi_pre_transfer;
     esp_err_t ret=spi_bus_add_device(host, devcfg, &spi);
     assert(ret==ESP_OK);
 }
@@ -65,7 +72,7 @@ void disp_spi_add_device(spi_host_device_t host) {
         .mode = 0,
         .spics_io_num=CONFIG_LV_DISP_SPI_CS,              // CS pin
         .input_delay_ns=0,
-        .queue_size=1,
+        .queue_size=DISP_SPI_QUEUE_SIZE,
         .pre_cb=NULL,
         .post_cb=NULL,
         .flags = SPI_DEVICE_NO_DUMMY,
@@ -144,6 +151,47 @@ void disp_spi_transaction(const uint8_t *data, size_t length,
     }
 }
 
+void disp_spi_set_dc_gpio(int gpio) {
+    dc_gpio = gpio;
+}
+
+void disp_spi_begin_queue(void) {
+    /* Results of the previous sequence free its transactions */
+    disp_wait_for_pending_transactions();
+
+    xSemaphoreTake(spi_mutex, portMAX_DELAY);
+    spi_device_acquire_bus(spi, portMAX_DELAY);
+    gpio_set_level(CONFIG_LV_DISP_SPI_CS, 0);
+    queued_count = 0;
+}
+
+void disp_spi_queue(const uint8_t *data, size_t length, disp_spi_send_flag_t flags) {
+    assert(queued_count < DISP_SPI_QUEUE_SIZE);
+    if (0 == length) {
+        return;
+    }
+
+    spi_transaction_ext_t *t = &queued_trans[queued_count++];
+    memset(t, 0, sizeof *t);
+
+    /* transaction length is in bits */
+    t->base.length = length * 8;
+
+    if (length <= 4 && data != NULL) {
+        t->base.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t->base.tx_data, data, length);
+    } else {
+        t->base.tx_buffer = data;
+    }
+
+    t->base.user = (void *) flags;
+
+    spi_pending_trans++;
+    if (spi_device_queue_trans(spi, (spi_transaction_t *) t, portMAX_DELAY) != ESP_OK) {
+        spi_pending_trans--; /* Clear wait state */
+    }
+}
+
 void disp_wait_for_pending_transactions(void) {
     spi_transaction_t *presult;
 
@@ -154,6 +202,19 @@ void disp_wait_for_pending_transactions(void) {
     }
 }
 
+static void IRAM_ATTR spi_pre_transfer(spi_transaction_t *trans) {
+    disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
+
+    if (dc_gpio < 0) {
+        return;
+    }
+    if (flags & DISP_SPI_DC_CMD) {
+        gpio_set_level(dc_gpio, 0);
+    } else if (flags & DISP_SPI_DC_DATA) {
+        gpio_set_level(dc_gpio, 1);
+    }
+}
+
 static void IRAM_ATTR spi_ready(spi_transaction_t *trans) {
     disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
     int higher_priority_task_awoken = pdFALSE;
@@ -29,8 +29,17 @@ typedef enum _disp_spi_send_flag_t {
     DISP_SPI_MODE_DIO           = 0x00000400, /* Reserved */
     DISP_SPI_MODE_QIO           = 0x00000800, /* Reserved */
     DISP_SPI_MODE_DIOQIO_ADDR   = 0x00001000, /* Reserved */
+    DISP_SPI_DC_CMD             = 0x00002000, /* D/C low while sending */
+    DISP_SPI_DC_DATA            = 0x00004000, /* D/C high while sending */
 } disp_spi_send_flag_t;
 
+/* Transactions that can wait in the queue of the display device */
+#if CONFIG_LV_DISP_FLUSH_PIPELINE
+#define DISP_SPI_QUEUE_SIZE 8
+#else
+#define DISP_SPI_QUEUE_SIZE 1
+#endif
+
 typedef struct _disp_spi_read_data {
     uint8_t _dummy_byte;
     union {
@@ -56,6 +65,17 @@ void disp_spi_transaction(const uint8_t *data, size_t length,
     disp_spi_send_flag_t flags, disp_spi_read_data *out, uint64_t addr);
 void disp_wait_for_pending_transactions(void);
 
+/* Lets the DISP_SPI_DC_* flags drive the D/C line from the transfer itself */
+void disp_spi_set_dc_gpio(int gpio);
+
+/* Queues a sequence of transactions that runs without the caller waiting.
+ * disp_spi_begin_queue() takes the bus, the last disp_spi_queue() of the
+ * sequence has to carry DISP_SPI_SIGNAL_FLUSH, which releases it again once
+ * that transaction is done. Data longer than 4 bytes must stay valid until
+ * then. At most DISP_SPI_QUEUE_SIZE transactions per sequence. */
+void disp_spi_begin_queue(void);
+void disp_spi_queue(const uint8_t *data, size_t length, disp_spi_send_flag_t flags);
+
 static inline void disp_spi_send_data(uint8_t *data, size_t length) {
     disp_spi_transaction(data, length, DISP_SPI_SEND_POLLING, NULL, 0);
 }
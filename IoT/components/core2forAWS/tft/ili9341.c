@@ -85,6 +85,7 @@ void ili9341_init(void)
 	//Initialize non-SPI GPIOs
 	gpio_pad_select_gpio(ILI9341_DC);
 	gpio_set_direction(ILI9341_DC, GPIO_MODE_OUTPUT);
+	disp_spi_set_dc_gpio(ILI9341_DC);
 
 	//Reset the display
 	Axp192_SetGPIO4Level(0);
@@ -108,6 +109,43 @@ void ili9341_init(void)
 	ili9341_send_cmd(0x21);
 }
 
+#if CONFIG_LV_DISP_FLUSH_PIPELINE
+/* The draw buffers are DMA-capable, so the whole sequence is queued and this
+ * returns right away; the SPI ISR reports the flush as ready to LVGL */
+void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
+{
+	uint8_t cmd;
+	uint8_t data[4];
+
+	disp_spi_begin_queue();
+
+	/*Column addresses*/
+	cmd = 0x2A;
+	disp_spi_queue(&cmd, 1, DISP_SPI_DC_CMD);
+	data[0] = (area->x1 >> 8) & 0xFF;
+	data[1] = area->x1 & 0xFF;
+	data[2] = (area->x2 >> 8) & 0xFF;
+	data[3] = area->x2 & 0xFF;
+	disp_spi_queue(data, 4, DISP_SPI_DC_DATA);
+
+	/*Page addresses*/
+	cmd = 0x2B;
+	disp_spi_queue(&cmd, 1, DISP_SPI_DC_CMD);
+	data[0] = (area->y1 >> 8) & 0xFF;
+	data[1] = area->y1 & 0xFF;
+	data[2] = (area->y2 >> 8) & 0xFF;
+	data[3] = area->y2 & 0xFF;
+	disp_spi_queue(data, 4, DISP_SPI_DC_DATA);
+
+	/*Memory write*/
+	cmd = 0x2C;
+	disp_spi_queue(&cmd, 1, DISP_SPI_DC_CMD);
+
+	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
+
+	disp_spi_queue((uint8_t *) color_map, size * 2, DISP_SPI_DC_DATA | DISP_SPI_SIGNAL_FLUSH);
+}
+#else
 void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
 	uint8_t data[4];
@@ -136,6 +174,7 @@ void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * col
 
 	ili9341_send_color((void*)color_map, size * 2);
 }
+#endif
 
 void ili9341_sleep_in()
 {
@@ -128,10 +128,14 @@ typedef int16_t lv_coord_t;
  * The graphical objects and other related data are stored here. */
 
 /* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc` and `lv_mem_free` */
+#if defined (CONFIG_LV_MEM_ALLOCATOR_FIRST_FIT) || defined (CONFIG_LV_MEM_ALLOCATOR_TLSF)
+#define LV_MEM_CUSTOM      0
+#else
 #define LV_MEM_CUSTOM      1
+#endif
 #if LV_MEM_CUSTOM == 0
 /* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB)*/
-#  define LV_MEM_SIZE    ( CONFIG_LV_MEM_SIZE * 1024U)
+#  define LV_MEM_SIZE    ( CONFIG_LV_MEM_SIZE_BYTES * 1024U)
 
 /* Complier prefix for a big array declaration */
 #  define LV_MEM_ATTR
@@ -142,6 +146,14 @@ typedef int16_t lv_coord_t;
 
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+
+/* 1: Manage the memory with a two-level segregated fit allocator instead of first fit.
+ * Allocation and free take constant time and the fragmentation stays low. `LV_MEM_AUTO_DEFRAG` is not used.*/
+#if defined (CONFIG_LV_MEM_ALLOCATOR_TLSF)
+#  define LV_MEM_TLSF         1
+#else
+#  define LV_MEM_TLSF         0
+#endif
 #else       /*LV_MEM_CUSTOM*/
 #  define LV_MEM_CUSTOM_INCLUDE "freertos/FreeRTOS.h"   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   pvPortMalloc       /*Wrapper to malloc*/
@@ -544,6 +556,15 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
     #define LV_FONT_FMT_TXT_LARGE   0
 #endif
 
+/* Keep the decompressed bitmaps of compressed font glyphs in an LRU cache
+ * of this many bytes instead of decompressing them on every draw. 0: no cache */
+#define LV_FONT_GLYPH_CACHE_SIZE    CONFIG_LV_FONT_GLYPH_CACHE_SIZE
+#if defined (CONFIG_LV_FONT_GLYPH_CACHE_SPIRAM)
+#  define LV_FONT_GLYPH_CACHE_INCLUDE       "esp_heap_caps.h"
+#  define LV_FONT_GLYPH_CACHE_ALLOC(size)   heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#  define LV_FONT_GLYPH_CACHE_FREE(p)       heap_caps_free(p)
+#endif
+
 /* Set the pixel order of the display.
  * Important only if "subpx fonts" are used.
  * With "normal" font it doesn't matter.
@@ -1015,6 +1036,14 @@ typedef void * lv_obj_user_data_t;
     #define LV_USE_OBJ_REALIGN          0
 #endif
 
+/*1: keep the rectangle and label draw descriptors resolved from the styles
+ * and reuse them until a style or the state of the object changes*/
+#if defined (CONFIG_LV_USE_OBJ_DRAW_CACHE)
+    #define LV_USE_OBJ_DRAW_CACHE       1
+#else
+    #define LV_USE_OBJ_DRAW_CACHE       0
+#endif
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
@@ -1172,6 +1201,12 @@ typedef void * lv_obj_user_data_t;
     #define LV_LABEL_TEXT_SEL               0
 /*Store extra some info in labels (12 bytes) to speed up drawing of very long texts*/
     #define LV_LABEL_LONG_TXT_HINT          0
+/*Cache the line breaks and line widths of the text to not wrap it again on every redraw*/
+#if defined (CONFIG_LV_LABEL_LINE_CACHE)
+    #define LV_LABEL_LINE_CACHE             1
+#else
+    #define LV_LABEL_LINE_CACHE             0
+#endif
 #endif
 
 /*LED (dependencies: -)*/
@@ -1222,6 +1257,19 @@ typedef void * lv_obj_user_data_t;
 #  define LV_LINEMETER_PRECISE    0
 #endif
 
+/*Log view (dependencies: -)*/
+#if defined (CONFIG_LV_USE_LOGVIEW)
+    #define LV_USE_LOGVIEW          1
+#else
+    #define LV_USE_LOGVIEW          0
+#endif
+
+#if LV_USE_LOGVIEW != 0
+/*Default number of lines kept and their max. length in bytes*/
+#  define LV_LOGVIEW_DEF_LINE_CNT   CONFIG_LV_LOGVIEW_DEF_LINE_CNT
+#  define LV_LOGVIEW_DEF_LINE_LEN   CONFIG_LV_LOGVIEW_DEF_LINE_LEN
+#endif
+
 /*Mask (dependencies: -)*/
 #if defined (CONFIG_LV_WIDGETS_USE_OBJMASK)
     #define LV_USE_OBJMASK          1
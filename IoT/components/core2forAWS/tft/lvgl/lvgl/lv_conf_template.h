@@ -94,6 +94,10 @@ typedef int16_t lv_coord_t;
 
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+
+/* 1: Manage the memory with a two-level segregated fit allocator instead of first fit.
+ * Allocation and free take constant time and the fragmentation stays low. `LV_MEM_AUTO_DEFRAG` is not used.*/
+#  define LV_MEM_TLSF         0
 #else       /*LV_MEM_CUSTOM*/
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
@@ -432,6 +436,16 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
  */
 #define LV_USE_FONT_COMPRESSED 1
 
+/* Keep the decompressed bitmaps of compressed font glyphs in an LRU cache
+ * of this many bytes instead of decompressing them on every draw. 0: no cache */
+#define LV_FONT_GLYPH_CACHE_SIZE 0
+#if LV_FONT_GLYPH_CACHE_SIZE
+/* Allocate the cache with these (e.g. in external RAM) */
+#  define LV_FONT_GLYPH_CACHE_INCLUDE <stdint.h>    /*Header for the allocator functions*/
+#  define LV_FONT_GLYPH_CACHE_ALLOC(size)   lv_mem_alloc(size)
+#  define LV_FONT_GLYPH_CACHE_FREE(p)       lv_mem_free(p)
+#endif
+
 /* Enable subpixel rendering */
 #define LV_USE_FONT_SUBPX 1
 #if LV_USE_FONT_SUBPX
@@ -561,6 +575,11 @@ typedef void * lv_obj_user_data_t;
 /*1: enable `lv_obj_realign()` based on `lv_obj_align()` parameters*/
 #define LV_USE_OBJ_REALIGN          1
 
+/*1: keep the rectangle and label draw descriptors resolved from the styles
+ * and reuse them until a style or the state of the object changes.
+ * Needs about 100 bytes per drawn part of an object*/
+#define LV_USE_OBJ_DRAW_CACHE       0
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
@@ -648,6 +667,9 @@ typedef void * lv_obj_user_data_t;
 
 /*Store extra some info in labels (12 bytes) to speed up drawing of very long texts*/
 #  define LV_LABEL_LONG_TXT_HINT          0
+
+/*Cache the line breaks and line widths of the text to not wrap it again on every redraw*/
+#  define LV_LABEL_LINE_CACHE             0
 #endif
 
 /*LED (dependencies: -)*/
@@ -679,6 +701,14 @@ typedef void * lv_obj_user_data_t;
 #  define LV_LINEMETER_PRECISE    1
 #endif
 
+/*Log view (dependencies: -)*/
+#define LV_USE_LOGVIEW  1
+#if LV_USE_LOGVIEW != 0
+/*Default number of lines kept and their max. length in bytes*/
+#  define LV_LOGVIEW_DEF_LINE_CNT   32
+#  define LV_LOGVIEW_DEF_LINE_LEN   64
+#endif
+
 /*Mask (dependencies: -)*/
 #define LV_USE_OBJMASK  1
 
@@ -26,6 +26,7 @@ extern "C" {
 #include "src/lv_misc/lv_task.h"
 #include "src/lv_misc/lv_math.h"
 #include "src/lv_misc/lv_async.h"
+#include "src/lv_misc/lv_tlsf.h"
 
 #include "src/lv_hal/lv_hal.h"
 
@@ -71,6 +72,7 @@ extern "C" {
 #include "src/lv_widgets/lv_objmask.h"
 #include "src/lv_widgets/lv_gauge.h"
 #include "src/lv_widgets/lv_linemeter.h"
+#include "src/lv_widgets/lv_logview.h"
 #include "src/lv_widgets/lv_switch.h"
 #include "src/lv_widgets/lv_arc.h"
 #include "src/lv_widgets/lv_spinner.h"
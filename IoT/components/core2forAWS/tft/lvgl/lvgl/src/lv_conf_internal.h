@@ -231,6 +231,16 @@
 #    define  LV_MEM_AUTO_DEFRAG  1
 #  endif
 #endif
+
+/* 1: Manage the memory with a two-level segregated fit allocator instead of first fit.
+ * Allocation and free take constant time and the fragmentation stays low. `LV_MEM_AUTO_DEFRAG` is not used.*/
+#ifndef LV_MEM_TLSF
+#  ifdef CONFIG_LV_MEM_TLSF
+#    define LV_MEM_TLSF CONFIG_LV_MEM_TLSF
+#  else
+#    define  LV_MEM_TLSF         0
+#  endif
+#endif
 #else       /*LV_MEM_CUSTOM*/
 #ifndef LV_MEM_CUSTOM_INCLUDE
 #  ifdef CONFIG_LV_MEM_CUSTOM_INCLUDE
@@ -1115,6 +1125,32 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/* Keep the decompressed bitmaps of compressed font glyphs in an LRU cache
+ * of this many bytes instead of decompressing them on every draw. 0: no cache */
+#ifndef LV_FONT_GLYPH_CACHE_SIZE
+#  ifdef CONFIG_LV_FONT_GLYPH_CACHE_SIZE
+#    define LV_FONT_GLYPH_CACHE_SIZE CONFIG_LV_FONT_GLYPH_CACHE_SIZE
+#  else
+#    define  LV_FONT_GLYPH_CACHE_SIZE 0
+#  endif
+#endif
+#if LV_FONT_GLYPH_CACHE_SIZE
+/* Allocate the cache with these (e.g. in external RAM) */
+#ifndef LV_FONT_GLYPH_CACHE_INCLUDE
+#  ifdef CONFIG_LV_FONT_GLYPH_CACHE_INCLUDE
+#    define LV_FONT_GLYPH_CACHE_INCLUDE CONFIG_LV_FONT_GLYPH_CACHE_INCLUDE
+#  else
+#    define  LV_FONT_GLYPH_CACHE_INCLUDE <stdint.h>    /*Header for the allocator functions*/
+#  endif
+#endif
+#ifndef LV_FONT_GLYPH_CACHE_ALLOC
+#  define  LV_FONT_GLYPH_CACHE_ALLOC(size)   lv_mem_alloc(size)
+#endif
+#ifndef LV_FONT_GLYPH_CACHE_FREE
+#  define  LV_FONT_GLYPH_CACHE_FREE(p)       lv_mem_free(p)
+#endif
+#endif
+
 /* Enable subpixel rendering */
 #ifndef LV_USE_FONT_SUBPX
 #  ifdef CONFIG_LV_USE_FONT_SUBPX
@@ -1440,6 +1476,17 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/*1: keep the rectangle and label draw descriptors resolved from the styles
+ * and reuse them until a style or the state of the object changes.
+ * Needs about 100 bytes per drawn part of an object*/
+#ifndef LV_USE_OBJ_DRAW_CACHE
+#  ifdef CONFIG_LV_USE_OBJ_DRAW_CACHE
+#    define LV_USE_OBJ_DRAW_CACHE CONFIG_LV_USE_OBJ_DRAW_CACHE
+#  else
+#    define  LV_USE_OBJ_DRAW_CACHE       0
+#  endif
+#endif
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
@@ -1677,6 +1724,15 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #    define  LV_LABEL_LONG_TXT_HINT          0
 #  endif
 #endif
+
+/*Cache the line breaks and line widths of the text to not wrap it again on every redraw*/
+#ifndef LV_LABEL_LINE_CACHE
+#  ifdef CONFIG_LV_LABEL_LINE_CACHE
+#    define LV_LABEL_LINE_CACHE CONFIG_LV_LABEL_LINE_CACHE
+#  else
+#    define  LV_LABEL_LINE_CACHE             0
+#  endif
+#endif
 #endif
 
 /*LED (dependencies: -)*/
@@ -1756,6 +1812,32 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #endif
 #endif
 
+/*Log view (dependencies: -)*/
+#ifndef LV_USE_LOGVIEW
+#  ifdef CONFIG_LV_USE_LOGVIEW
+#    define LV_USE_LOGVIEW CONFIG_LV_USE_LOGVIEW
+#  else
+#    define  LV_USE_LOGVIEW  1
+#  endif
+#endif
+#if LV_USE_LOGVIEW != 0
+/*Default number of lines kept and their max. length in bytes*/
+#ifndef LV_LOGVIEW_DEF_LINE_CNT
+#  ifdef CONFIG_LV_LOGVIEW_DEF_LINE_CNT
+#    define LV_LOGVIEW_DEF_LINE_CNT CONFIG_LV_LOGVIEW_DEF_LINE_CNT
+#  else
+#    define  LV_LOGVIEW_DEF_LINE_CNT   32
+#  endif
+#endif
+#ifndef LV_LOGVIEW_DEF_LINE_LEN
+#  ifdef CONFIG_LV_LOGVIEW_DEF_LINE_LEN
+#    define LV_LOGVIEW_DEF_LINE_LEN CONFIG_LV_LOGVIEW_DEF_LINE_LEN
+#  else
+#    define  LV_LOGVIEW_DEF_LINE_LEN   64
+#  endif
+#endif
+#endif
+
 /*Mask (dependencies: -)*/
 #ifndef LV_USE_OBJMASK
 #  ifdef CONFIG_LV_USE_OBJMASK
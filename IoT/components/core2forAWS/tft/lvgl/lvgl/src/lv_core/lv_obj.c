@@ -110,6 +110,24 @@ typedef enum {
     STYLE_COMPARE_DIFF,
 } style_snapshot_res_t;
 
+enum {
+    DRAW_CACHE_RECT,
+    DRAW_CACHE_LABEL,
+};
+
+/*The style properties `lv_obj_init_draw_rect/label_dsc()` read for a part, resolved on the last draw*/
+typedef struct _draw_cache_t {
+    struct _draw_cache_t * next;
+    uint8_t part;
+    uint8_t type  : 1;
+    uint8_t valid : 1;
+    lv_opa_t opa_scale;
+    union {
+        lv_draw_rect_dsc_t rect;
+        lv_draw_label_dsc_t label;
+    } dsc;  /*Only as large as the descriptor of `type`*/
+} draw_cache_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
@@ -141,6 +159,15 @@ static void update_style_cache(lv_obj_t * obj, uint8_t part, uint16_t prop);
 static void update_style_cache_children(lv_obj_t * obj);
 static void invalidate_style_cache(lv_obj_t * obj, uint8_t part, lv_style_property_t prop);
 static void style_snapshot(lv_obj_t * obj, uint8_t part, style_snapshot_t * shot);
+static void init_draw_rect_dsc_core(lv_obj_t * obj, uint8_t part, lv_draw_rect_dsc_t * draw_dsc,
+                                    const draw_cache_t * res);
+static void init_draw_label_dsc_core(lv_obj_t * obj, uint8_t part, lv_draw_label_dsc_t * draw_dsc,
+                                     const draw_cache_t * res);
+#if LV_USE_OBJ_DRAW_CACHE
+static const draw_cache_t * draw_cache_get(lv_obj_t * obj, uint8_t part, uint8_t type);
+static void draw_cache_invalidate(lv_obj_t * obj);
+static void draw_cache_free(lv_obj_t * obj);
+#endif
 static style_snapshot_res_t style_snapshot_compare(style_snapshot_t * shot1, style_snapshot_t * shot2);
 
 /**********************
@@ -149,10 +176,16 @@ static style_snapshot_res_t style_snapshot_compare(style_snapshot_t * shot1, sty
 static bool lv_initialized = false;
 static lv_event_temp_data_t * event_temp_data_head;
 static const void * event_act_data;
+#if LV_USE_OBJ_DRAW_CACHE
+    static lv_obj_draw_cache_stats_t draw_cache_stats;
+#endif
 
 /**********************
  *      MACROS
  **********************/
+/*Read a property from the resolved descriptor `res` if there is one, else from the styles*/
+#define RECT_STYLE(field, getter)  (res ? res->dsc.rect.field : getter(obj, part))
+#define LABEL_STYLE(field, getter) (res ? res->dsc.label.field : getter(obj, part))
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -685,6 +718,11 @@ void lv_obj_set_parent(lv_obj_t * obj, lv_obj_t * parent)
     _lv_ll_chg_list(&obj->parent->child_ll, &parent->child_ll, obj, true);
     obj->parent = parent;
 
+#if LV_USE_OBJ_DRAW_CACHE
+    /*The inherited properties might be different under the new parent*/
+    draw_cache_invalidate(obj);
+#endif
+
     if(new_base_dir != LV_BIDI_DIR_RTL) {
         lv_obj_set_pos(obj, old_pos.x, old_pos.y);
     }
@@ -1237,6 +1275,9 @@ void lv_obj_clean_style_list(lv_obj_t * obj, uint8_t part)
 #if LV_USE_ANIMATION
     trans_del(obj, part, 0xFF, NULL);
 #endif
+#if LV_USE_OBJ_DRAW_CACHE
+    draw_cache_invalidate(obj);
+#endif
 }
 
 /**
@@ -1357,8 +1398,13 @@ bool lv_obj_remove_style_local_prop(lv_obj_t * obj, uint8_t part, lv_style_prope
 {
     LV_ASSERT_OBJ(obj, LV_OBJX_NAME);
     lv_style_t * style = lv_obj_get_local_style(obj, part);
-    if(style) return lv_style_remove_prop(style, prop);
-    else return false;
+    if(style == NULL) return false;
+
+    bool removed = lv_style_remove_prop(style, prop);
+#if LV_USE_OBJ_DRAW_CACHE
+    if(removed) draw_cache_invalidate(obj);
+#endif
+    return removed;
 }
 
 /**
@@ -1372,6 +1418,9 @@ void lv_obj_refresh_style(lv_obj_t * obj, uint8_t part, lv_style_property_t prop
     LV_ASSERT_OBJ(obj, LV_OBJX_NAME);
 
     invalidate_style_cache(obj, part, prop);
+#if LV_USE_OBJ_DRAW_CACHE
+    draw_cache_invalidate(obj);
+#endif
 
     /*If a real style refresh is required*/
     bool real_refr = false;
@@ -1726,6 +1775,11 @@ void lv_obj_set_state(lv_obj_t * obj, lv_state_t new_state)
 
     obj->state = new_state;
 
+#if LV_USE_OBJ_DRAW_CACHE
+    /*The snapshots only compare this object but the children inherit from it too*/
+    draw_cache_invalidate(obj);
+#endif
+
     if(cmp_res == STYLE_COMPARE_SAME) {
         return;
     }
@@ -3347,10 +3401,15 @@ lv_res_t lv_obj_handle_get_type_signal(lv_obj_type_t * buf, const char * name)
  */
 void lv_obj_init_draw_rect_dsc(lv_obj_t * obj, uint8_t part, lv_draw_rect_dsc_t * draw_dsc)
 {
-    draw_dsc->radius = lv_obj_get_style_radius(obj, part);
+    const draw_cache_t * res = NULL;
+#if LV_USE_OBJ_DRAW_CACHE
+    res = draw_cache_get(obj, part, DRAW_CACHE_RECT);
+#endif
+
+    draw_dsc->radius = RECT_STYLE(radius, lv_obj_get_style_radius);
 
 #if LV_USE_OPA_SCALE
-    lv_opa_t opa_scale = lv_obj_get_style_opa_scale(obj, part);
+    lv_opa_t opa_scale = res ? res->opa_scale : lv_obj_get_style_opa_scale(obj, part);
     if(opa_scale <= LV_OPA_MIN) {
         draw_dsc->bg_opa = LV_OPA_TRANSP;
         draw_dsc->border_opa = LV_OPA_TRANSP;
@@ -3361,114 +3420,7 @@ void lv_obj_init_draw_rect_dsc(lv_obj_t * obj, uint8_t part, lv_draw_rect_dsc_t
     }
 #endif
 
-    if(draw_dsc->bg_opa != LV_OPA_TRANSP) {
-        draw_dsc->bg_opa = lv_obj_get_style_bg_opa(obj, part);
-        if(draw_dsc->bg_opa > LV_OPA_MIN) {
-            draw_dsc->bg_color = lv_obj_get_style_bg_color(obj, part);
-            draw_dsc->bg_grad_dir =  lv_obj_get_style_bg_grad_dir(obj, part);
-            if(draw_dsc->bg_grad_dir != LV_GRAD_DIR_NONE) {
-                draw_dsc->bg_grad_color = lv_obj_get_style_bg_grad_color(obj, part);
-                draw_dsc->bg_main_color_stop =  lv_obj_get_style_bg_main_stop(obj, part);
-                draw_dsc->bg_grad_color_stop =  lv_obj_get_style_bg_grad_stop(obj, part);
-            }
-
-#if LV_USE_BLEND_MODES
-            draw_dsc->bg_blend_mode = lv_obj_get_style_bg_blend_mode(obj, part);
-#endif
-        }
-    }
-
-    draw_dsc->border_width = lv_obj_get_style_border_width(obj, part);
-    if(draw_dsc->border_width) {
-        if(draw_dsc->border_opa != LV_OPA_TRANSP) {
-            draw_dsc->border_opa = lv_obj_get_style_border_opa(obj, part);
-            if(draw_dsc->border_opa > LV_OPA_MIN) {
-                draw_dsc->border_side = lv_obj_get_style_border_side(obj, part);
-                draw_dsc->border_color = lv_obj_get_style_border_color(obj, part);
-            }
-#if LV_USE_BLEND_MODES
-            draw_dsc->border_blend_mode = lv_obj_get_style_border_blend_mode(obj, part);
-#endif
-        }
-    }
-
-#if LV_USE_OUTLINE
-    draw_dsc->outline_width = lv_obj_get_style_outline_width(obj, part);
-    if(draw_dsc->outline_width) {
-        if(draw_dsc->outline_opa != LV_OPA_TRANSP) {
-            draw_dsc->outline_opa = lv_obj_get_style_outline_opa(obj, part);
-            if(draw_dsc->outline_opa > LV_OPA_MIN) {
-                draw_dsc->outline_pad = lv_obj_get_style_outline_pad(obj, part);
-                draw_dsc->outline_color = lv_obj_get_style_outline_color(obj, part);
-            }
-#if LV_USE_BLEND_MODES
-            draw_dsc->outline_blend_mode = lv_obj_get_style_outline_blend_mode(obj, part);
-#endif
-        }
-    }
-#endif
-
-#if LV_USE_PATTERN
-    draw_dsc->pattern_image = lv_obj_get_style_pattern_image(obj, part);
-    if(draw_dsc->pattern_image) {
-        if(draw_dsc->pattern_opa != LV_OPA_TRANSP) {
-            draw_dsc->pattern_opa = lv_obj_get_style_pattern_opa(obj, part);
-            if(draw_dsc->pattern_opa > LV_OPA_MIN) {
-                draw_dsc->pattern_recolor_opa = lv_obj_get_style_pattern_recolor_opa(obj, part);
-                draw_dsc->pattern_repeat = lv_obj_get_style_pattern_repeat(obj, part);
-                if(lv_img_src_get_type(draw_dsc->pattern_image) == LV_IMG_SRC_SYMBOL) {
-                    draw_dsc->pattern_recolor = lv_obj_get_style_pattern_recolor(obj, part);
-                    draw_dsc->pattern_font = lv_obj_get_style_text_font(obj, part);
-                }
-                else if(draw_dsc->pattern_recolor_opa > LV_OPA_MIN) {
-                    draw_dsc->pattern_recolor = lv_obj_get_style_pattern_recolor(obj, part);
-                }
-#if LV_USE_BLEND_MODES
-                draw_dsc->pattern_blend_mode = lv_obj_get_style_pattern_blend_mode(obj, part);
-#endif
-            }
-        }
-    }
-#endif
-
-#if LV_USE_SHADOW
-    draw_dsc->shadow_width = lv_obj_get_style_shadow_width(obj, part);
-    if(draw_dsc->shadow_width) {
-        if(draw_dsc->shadow_opa > LV_OPA_MIN) {
-            draw_dsc->shadow_opa = lv_obj_get_style_shadow_opa(obj, part);
-            if(draw_dsc->shadow_opa > LV_OPA_MIN) {
-                draw_dsc->shadow_ofs_x = lv_obj_get_style_shadow_ofs_x(obj, part);
-                draw_dsc->shadow_ofs_y = lv_obj_get_style_shadow_ofs_y(obj, part);
-                draw_dsc->shadow_spread = lv_obj_get_style_shadow_spread(obj, part);
-                draw_dsc->shadow_color = lv_obj_get_style_shadow_color(obj, part);
-#if LV_USE_BLEND_MODES
-                draw_dsc->shadow_blend_mode = lv_obj_get_style_shadow_blend_mode(obj, part);
-#endif
-            }
-        }
-    }
-#endif
-
-#if LV_USE_VALUE_STR
-    draw_dsc->value_str = lv_obj_get_style_value_str(obj, part);
-    if(draw_dsc->value_str) {
-        if(draw_dsc->value_opa > LV_OPA_MIN) {
-            draw_dsc->value_opa = lv_obj_get_style_value_opa(obj, part);
-            if(draw_dsc->value_opa > LV_OPA_MIN) {
-                draw_dsc->value_ofs_x = lv_obj_get_style_value_ofs_x(obj, part);
-                draw_dsc->value_ofs_y = lv_obj_get_style_value_ofs_y(obj, part);
-                draw_dsc->value_color = lv_obj_get_style_value_color(obj, part);
-                draw_dsc->value_font = lv_obj_get_style_value_font(obj, part);
-                draw_dsc->value_letter_space = lv_obj_get_style_value_letter_space(obj, part);
-                draw_dsc->value_line_space = lv_obj_get_style_value_line_space(obj, part);
-                draw_dsc->value_align = lv_obj_get_style_value_align(obj, part);
-#if LV_USE_BLEND_MODES
-                draw_dsc->value_blend_mode = lv_obj_get_style_value_blend_mode(obj, part);
-#endif
-            }
-        }
-    }
-#endif
+    init_draw_rect_dsc_core(obj, part, draw_dsc, res);
 
 #if LV_USE_OPA_SCALE
     if(opa_scale < LV_OPA_MAX) {
@@ -3484,31 +3436,23 @@ void lv_obj_init_draw_rect_dsc(lv_obj_t * obj, uint8_t part, lv_draw_rect_dsc_t
 
 void lv_obj_init_draw_label_dsc(lv_obj_t * obj, uint8_t part, lv_draw_label_dsc_t * draw_dsc)
 {
-    draw_dsc->opa = lv_obj_get_style_text_opa(obj, part);
+    const draw_cache_t * res = NULL;
+#if LV_USE_OBJ_DRAW_CACHE
+    res = draw_cache_get(obj, part, DRAW_CACHE_LABEL);
+#endif
+
+    draw_dsc->opa = LABEL_STYLE(opa, lv_obj_get_style_text_opa);
     if(draw_dsc->opa <= LV_OPA_MIN) return;
 
 #if LV_USE_OPA_SCALE
-    lv_opa_t opa_scale = lv_obj_get_style_opa_scale(obj, part);
+    lv_opa_t opa_scale = res ? res->opa_scale : lv_obj_get_style_opa_scale(obj, part);
     if(opa_scale < LV_OPA_MAX) {
         draw_dsc->opa = (uint16_t)((uint16_t)draw_dsc->opa * opa_scale) >> 8;
     }
     if(draw_dsc->opa <= LV_OPA_MIN) return;
 #endif
 
-    draw_dsc->color = lv_obj_get_style_text_color(obj, part);
-    draw_dsc->letter_space = lv_obj_get_style_text_letter_space(obj, part);
-    draw_dsc->line_space = lv_obj_get_style_text_line_space(obj, part);
-    draw_dsc->decor = lv_obj_get_style_text_decor(obj, part);
-#if LV_USE_BLEND_MODES
-    draw_dsc->blend_mode = lv_obj_get_style_text_blend_mode(obj, part);
-#endif
-
-    draw_dsc->font = lv_obj_get_style_text_font(obj, part);
-
-    if(draw_dsc->sel_start != LV_DRAW_LABEL_NO_TXT_SEL && draw_dsc->sel_end != LV_DRAW_LABEL_NO_TXT_SEL) {
-        draw_dsc->sel_color = lv_obj_get_style_text_sel_color(obj, part);
-        draw_dsc->sel_bg_color = lv_obj_get_style_text_sel_bg_color(obj, part);
-    }
+    init_draw_label_dsc_core(obj, part, draw_dsc, res);
 
 #if LV_USE_BIDI
     draw_dsc->bidi_dir = lv_obj_get_base_dir(obj);
@@ -3573,6 +3517,19 @@ void lv_obj_init_draw_line_dsc(lv_obj_t * obj, uint8_t part, lv_draw_line_dsc_t
 #endif
 }
 
+/**
+ * Get how often the draw descriptors were served from the cache
+ * @param stats the counters will be copied here. All zero if `LV_USE_OBJ_DRAW_CACHE` is disabled.
+ */
+void lv_obj_get_draw_cache_stats(lv_obj_draw_cache_stats_t * stats)
+{
+#if LV_USE_OBJ_DRAW_CACHE
+    *stats = draw_cache_stats;
+#else
+    _lv_memset_00(stats, sizeof(lv_obj_draw_cache_stats_t));
+#endif
+}
+
 /**
  * Get the required extra size (around the object's part) to draw shadow, outline, value etc.
  * @param obj pointer to an object
@@ -3824,6 +3781,9 @@ static void obj_del_core(lv_obj_t * obj)
     }
 
     /*Delete the base objects*/
+#if LV_USE_OBJ_DRAW_CACHE
+    draw_cache_free(obj);
+#endif
     if(obj->ext_attr != NULL) lv_mem_free(obj->ext_attr);
     lv_mem_free(obj); /*Free the object itself*/
 }
@@ -4418,6 +4378,9 @@ static void trans_del(lv_obj_t * obj, uint8_t part, lv_style_property_t prop, lv
             lv_style_list_t * list = lv_obj_get_style_list(tr->obj, tr->part);
             lv_style_t * style_trans = _lv_style_list_get_transition_style(list);
             lv_style_remove_prop(style_trans, tr->prop);
+#if LV_USE_OBJ_DRAW_CACHE
+            draw_cache_invalidate(tr->obj);
+#endif
 
             lv_anim_del(tr, NULL);
             _lv_ll_remove(&LV_GC_ROOT(_lv_obj_style_trans_ll), tr);
@@ -4512,6 +4475,9 @@ static void trans_anim_ready_cb(lv_anim_t * a)
         lv_style_list_t * list = lv_obj_get_style_list(tr->obj, tr->part);
         lv_style_t * style_trans = _lv_style_list_get_transition_style(list);
         lv_style_remove_prop(style_trans, tr->prop);
+#if LV_USE_OBJ_DRAW_CACHE
+        draw_cache_invalidate(tr->obj);
+#endif
     }
 
     _lv_ll_remove(&LV_GC_ROOT(_lv_obj_style_trans_ll), tr);
@@ -4526,6 +4492,9 @@ static void opa_scale_anim(lv_obj_t * obj, lv_anim_value_t v)
 static void fade_in_anim_ready(lv_anim_t * a)
 {
     lv_style_remove_prop(lv_obj_get_local_style(a->var, LV_OBJ_PART_MAIN), LV_STYLE_OPA_SCALE);
+#if LV_USE_OBJ_DRAW_CACHE
+    draw_cache_invalidate(a->var);
+#endif
 }
 
 #endif
@@ -4754,6 +4723,250 @@ static void invalidate_style_cache(lv_obj_t * obj, uint8_t part, lv_style_proper
     }
 }
 
+/**
+ * Set the fields of a rectangle descriptor after `radius` and the opacity scale
+ * @param obj pointer to an object
+ * @param part part of the object
+ * @param draw_dsc the descriptor to initialize
+ * @param res the properties resolved on an earlier draw or NULL to read the styles
+ */
+static void init_draw_rect_dsc_core(lv_obj_t * obj, uint8_t part, lv_draw_rect_dsc_t * draw_dsc,
+                                    const draw_cache_t * res)
+{
+    if(draw_dsc->bg_opa != LV_OPA_TRANSP) {
+        draw_dsc->bg_opa = RECT_STYLE(bg_opa, lv_obj_get_style_bg_opa);
+        if(draw_dsc->bg_opa > LV_OPA_MIN) {
+            draw_dsc->bg_color = RECT_STYLE(bg_color, lv_obj_get_style_bg_color);
+            draw_dsc->bg_grad_dir = RECT_STYLE(bg_grad_dir, lv_obj_get_style_bg_grad_dir);
+            if(draw_dsc->bg_grad_dir != LV_GRAD_DIR_NONE) {
+                draw_dsc->bg_grad_color = RECT_STYLE(bg_grad_color, lv_obj_get_style_bg_grad_color);
+                draw_dsc->bg_main_color_stop = RECT_STYLE(bg_main_color_stop, lv_obj_get_style_bg_main_stop);
+                draw_dsc->bg_grad_color_stop = RECT_STYLE(bg_grad_color_stop, lv_obj_get_style_bg_grad_stop);
+            }
+
+#if LV_USE_BLEND_MODES
+            draw_dsc->bg_blend_mode = RECT_STYLE(bg_blend_mode, lv_obj_get_style_bg_blend_mode);
+#endif
+        }
+    }
+
+    draw_dsc->border_width = RECT_STYLE(border_width, lv_obj_get_style_border_width);
+    if(draw_dsc->border_width) {
+        if(draw_dsc->border_opa != LV_OPA_TRANSP) {
+            draw_dsc->border_opa = RECT_STYLE(border_opa, lv_obj_get_style_border_opa);
+            if(draw_dsc->border_opa > LV_OPA_MIN) {
+                draw_dsc->border_side = RECT_STYLE(border_side, lv_obj_get_style_border_side);
+                draw_dsc->border_color = RECT_STYLE(border_color, lv_obj_get_style_border_color);
+            }
+#if LV_USE_BLEND_MODES
+            draw_dsc->border_blend_mode = RECT_STYLE(border_blend_mode, lv_obj_get_style_border_blend_mode);
+#endif
+        }
+    }
+
+#if LV_USE_OUTLINE
+    draw_dsc->outline_width = RECT_STYLE(outline_width, lv_obj_get_style_outline_width);
+    if(draw_dsc->outline_width) {
+        if(draw_dsc->outline_opa != LV_OPA_TRANSP) {
+            draw_dsc->outline_opa = RECT_STYLE(outline_opa, lv_obj_get_style_outline_opa);
+            if(draw_dsc->outline_opa > LV_OPA_MIN) {
+                draw_dsc->outline_pad = RECT_STYLE(outline_pad, lv_obj_get_style_outline_pad);
+                draw_dsc->outline_color = RECT_STYLE(outline_color, lv_obj_get_style_outline_color);
+            }
+#if LV_USE_BLEND_MODES
+            draw_dsc->outline_blend_mode = RECT_STYLE(outline_blend_mode, lv_obj_get_style_outline_blend_mode);
+#endif
+        }
+    }
+#endif
+
+#if LV_USE_PATTERN
+    draw_dsc->pattern_image = RECT_STYLE(pattern_image, lv_obj_get_style_pattern_image);
+    if(draw_dsc->pattern_image) {
+        if(draw_dsc->pattern_opa != LV_OPA_TRANSP) {
+            draw_dsc->pattern_opa = RECT_STYLE(pattern_opa, lv_obj_get_style_pattern_opa);
+            if(draw_dsc->pattern_opa > LV_OPA_MIN) {
+                draw_dsc->pattern_recolor_opa = RECT_STYLE(pattern_recolor_opa, lv_obj_get_style_pattern_recolor_opa);
+                draw_dsc->pattern_repeat = RECT_STYLE(pattern_repeat, lv_obj_get_style_pattern_repeat);
+                if(lv_img_src_get_type(draw_dsc->pattern_image) == LV_IMG_SRC_SYMBOL) {
+                    draw_dsc->pattern_recolor = RECT_STYLE(pattern_recolor, lv_obj_get_style_pattern_recolor);
+                    draw_dsc->pattern_font = RECT_STYLE(pattern_font, lv_obj_get_style_text_font);
+                }
+                else if(draw_dsc->pattern_recolor_opa > LV_OPA_MIN) {
+                    draw_dsc->pattern_recolor = RECT_STYLE(pattern_recolor, lv_obj_get_style_pattern_recolor);
+                }
+#if LV_USE_BLEND_MODES
+                draw_dsc->pattern_blend_mode = RECT_STYLE(pattern_blend_mode, lv_obj_get_style_pattern_blend_mode);
+#endif
+            }
+        }
+    }
+#endif
+
+#if LV_USE_SHADOW
+    draw_dsc->shadow_width = RECT_STYLE(shadow_width, lv_obj_get_style_shadow_width);
+    if(draw_dsc->shadow_width) {
+        if(draw_dsc->shadow_opa > LV_OPA_MIN) {
+            draw_dsc->shadow_opa = RECT_STYLE(shadow_opa, lv_obj_get_style_shadow_opa);
+            if(draw_dsc->shadow_opa > LV_OPA_MIN) {
+                draw_dsc->shadow_ofs_x = RECT_STYLE(shadow_ofs_x, lv_obj_get_style_shadow_ofs_x);
+                draw_dsc->shadow_ofs_y = RECT_STYLE(shadow_ofs_y, lv_obj_get_style_shadow_ofs_y);
+                draw_dsc->shadow_spread = RECT_STYLE(shadow_spread, lv_obj_get_style_shadow_spread);
+                draw_dsc->shadow_color = RECT_STYLE(shadow_color, lv_obj_get_style_shadow_color);
+#if LV_USE_BLEND_MODES
+                draw_dsc->shadow_blend_mode = RECT_STYLE(shadow_blend_mode, lv_obj_get_style_shadow_blend_mode);
+#endif
+            }
+        }
+    }
+#endif
+
+#if LV_USE_VALUE_STR
+    draw_dsc->value_str = RECT_STYLE(value_str, lv_obj_get_style_value_str);
+    if(draw_dsc->value_str) {
+        if(draw_dsc->value_opa > LV_OPA_MIN) {
+            draw_dsc->value_opa = RECT_STYLE(value_opa, lv_obj_get_style_value_opa);
+            if(draw_dsc->value_opa > LV_OPA_MIN) {
+                draw_dsc->value_ofs_x = RECT_STYLE(value_ofs_x, lv_obj_get_style_value_ofs_x);
+                draw_dsc->value_ofs_y = RECT_STYLE(value_ofs_y, lv_obj_get_style_value_ofs_y);
+                draw_dsc->value_color = RECT_STYLE(value_color, lv_obj_get_style_value_color);
+                draw_dsc->value_font = RECT_STYLE(value_font, lv_obj_get_style_value_font);
+                draw_dsc->value_letter_space = RECT_STYLE(value_letter_space, lv_obj_get_style_value_letter_space);
+                draw_dsc->value_line_space = RECT_STYLE(value_line_space, lv_obj_get_style_value_line_space);
+                draw_dsc->value_align = RECT_STYLE(value_align, lv_obj_get_style_value_align);
+#if LV_USE_BLEND_MODES
+                draw_dsc->value_blend_mode = RECT_STYLE(value_blend_mode, lv_obj_get_style_value_blend_mode);
+#endif
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * Set the fields of a label descriptor after the opacity
+ * @param obj pointer to an object
+ * @param part part of the object
+ * @param draw_dsc the descriptor to initialize
+ * @param res the properties resolved on an earlier draw or NULL to read the styles
+ */
+static void init_draw_label_dsc_core(lv_obj_t * obj, uint8_t part, lv_draw_label_dsc_t * draw_dsc,
+                                     const draw_cache_t * res)
+{
+    draw_dsc->color = LABEL_STYLE(color, lv_obj_get_style_text_color);
+    draw_dsc->letter_space = LABEL_STYLE(letter_space, lv_obj_get_style_text_letter_space);
+    draw_dsc->line_space = LABEL_STYLE(line_space, lv_obj_get_style_text_line_space);
+    draw_dsc->decor = LABEL_STYLE(decor, lv_obj_get_style_text_decor);
+#if LV_USE_BLEND_MODES
+    draw_dsc->blend_mode = LABEL_STYLE(blend_mode, lv_obj_get_style_text_blend_mode);
+#endif
+
+    draw_dsc->font = LABEL_STYLE(font, lv_obj_get_style_text_font);
+
+    if(draw_dsc->sel_start != LV_DRAW_LABEL_NO_TXT_SEL && draw_dsc->sel_end != LV_DRAW_LABEL_NO_TXT_SEL) {
+        draw_dsc->sel_color = LABEL_STYLE(sel_color, lv_obj_get_style_text_sel_color);
+        draw_dsc->sel_bg_color = LABEL_STYLE(sel_bg_color, lv_obj_get_style_text_sel_bg_color);
+    }
+}
+
+#if LV_USE_OBJ_DRAW_CACHE
+
+/**
+ * Get the resolved properties of an object's part. Resolve them if the part was not drawn yet
+ * or its styles changed since then.
+ * @param obj pointer to an object
+ * @param part part of the object
+ * @param type `DRAW_CACHE_RECT` or `DRAW_CACHE_LABEL`
+ * @return the resolved properties or NULL if they can't be cached
+ */
+static const draw_cache_t * draw_cache_get(lv_obj_t * obj, uint8_t part, uint8_t type)
+{
+    /*The state of the real parts is not stored in the object.
+     *`lv_obj_set_state` takes its snapshots with the caching disabled.*/
+    if(part >= _LV_OBJ_PART_REAL_FIRST) return NULL;
+    lv_style_list_t * list = lv_obj_get_style_list(obj, part);
+    if(list == NULL || list->ignore_cache || list->skip_trans) return NULL;
+
+    draw_cache_t * cache = obj->draw_cache;
+    while(cache) {
+        if(cache->part == part && cache->type == type) break;
+        cache = cache->next;
+    }
+
+    if(cache == NULL) {
+        size_t size = sizeof(draw_cache_t) - sizeof(cache->dsc);
+        size += type == DRAW_CACHE_RECT ? sizeof(lv_draw_rect_dsc_t) : sizeof(lv_draw_label_dsc_t);
+        cache = lv_mem_alloc(size);
+        if(cache == NULL) return NULL;
+
+        cache->part = part;
+        cache->type = type;
+        cache->valid = 0;
+        cache->next = obj->draw_cache;
+        obj->draw_cache = cache;
+    }
+
+    if(cache->valid) {
+        draw_cache_stats.hit++;
+        return cache;
+    }
+
+    draw_cache_stats.miss++;
+
+    /*Start from a descriptor which lets through every property a caller's descriptor could ask for*/
+#if LV_USE_OPA_SCALE
+    cache->opa_scale = lv_obj_get_style_opa_scale(obj, part);
+#else
+    cache->opa_scale = LV_OPA_COVER;
+#endif
+    if(type == DRAW_CACHE_RECT) {
+        lv_draw_rect_dsc_init(&cache->dsc.rect);
+        cache->dsc.rect.radius = lv_obj_get_style_radius(obj, part);
+        init_draw_rect_dsc_core(obj, part, &cache->dsc.rect, NULL);
+    }
+    else {
+        lv_draw_label_dsc_init(&cache->dsc.label);
+        cache->dsc.label.opa = lv_obj_get_style_text_opa(obj, part);
+        cache->dsc.label.sel_start = 0;
+        cache->dsc.label.sel_end = 0;
+        init_draw_label_dsc_core(obj, part, &cache->dsc.label, NULL);
+    }
+
+    cache->valid = 1;
+    return cache;
+}
+
+/**
+ * Mark the resolved properties of an object and its children as outdated
+ * @param obj pointer to an object
+ */
+static void draw_cache_invalidate(lv_obj_t * obj)
+{
+    draw_cache_t * cache;
+    for(cache = obj->draw_cache; cache != NULL; cache = cache->next) {
+        cache->valid = 0;
+    }
+
+    lv_obj_t * child = lv_obj_get_child(obj, NULL);
+    while(child) {
+        draw_cache_invalidate(child);
+        child = lv_obj_get_child(obj, child);
+    }
+}
+
+static void draw_cache_free(lv_obj_t * obj)
+{
+    draw_cache_t * cache = obj->draw_cache;
+    while(cache) {
+        draw_cache_t * next = cache->next;
+        lv_mem_free(cache);
+        cache = next;
+    }
+    obj->draw_cache = NULL;
+}
+
+#endif /*LV_USE_OBJ_DRAW_CACHE*/
+
 static void style_snapshot(lv_obj_t * obj, uint8_t part, style_snapshot_t * shot)
 {
     _lv_obj_disable_style_caching(obj, true);
@@ -242,6 +242,10 @@ typedef struct _lv_obj_t {
     lv_realign_t realign;       /**< Information about the last call to ::lv_obj_align. */
 #endif
 
+#if LV_USE_OBJ_DRAW_CACHE
+    void * draw_cache;          /**< Draw descriptors resolved from the styles on the last draw*/
+#endif
+
 #if LV_USE_USER_DATA
     lv_obj_user_data_t user_data; /**< Custom user data for object. */
 #endif
@@ -278,6 +282,12 @@ typedef struct {
     lv_state_t result;
 } lv_get_state_info_t;
 
+/** Counters of `lv_obj_init_draw_rect/label_dsc()` calls served from the draw descriptor cache*/
+typedef struct {
+    uint32_t hit;   /**< The descriptor was copied from the cache*/
+    uint32_t miss;  /**< The descriptor was resolved from the styles*/
+} lv_obj_draw_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -1439,6 +1449,12 @@ void lv_obj_init_draw_img_dsc(lv_obj_t * obj, uint8_t part, lv_draw_img_dsc_t *
 
 void lv_obj_init_draw_line_dsc(lv_obj_t * obj, uint8_t part, lv_draw_line_dsc_t * draw_dsc);
 
+/**
+ * Get how often the draw descriptors were served from the cache
+ * @param stats the counters will be copied here. All zero if `LV_USE_OBJ_DRAW_CACHE` is disabled.
+ */
+void lv_obj_get_draw_cache_stats(lv_obj_draw_cache_stats_t * stats);
+
 /**
  * Get the required extra size (around the object's part) to draw shadow, outline, value etc.
  * @param obj pointer to an object
@@ -37,6 +37,7 @@
  *  STATIC PROTOTYPES
  **********************/
 static void lv_refr_join_area(void);
+static bool lv_refr_join_pays(const lv_area_t * a1, const lv_area_t * a2);
 static void lv_refr_areas(void);
 static void lv_refr_area(const lv_area_t * area_p);
 static void lv_refr_area_part(const lv_area_t * area_p);
@@ -138,16 +139,75 @@ void _lv_inv_area(lv_disp_t * disp, const lv_area_t * area_p)
         /*Save the area*/
         if(disp->inv_p < LV_INV_BUF_SIZE) {
             lv_area_copy(&disp->inv_areas[disp->inv_p], &com_area);
+            disp->inv_p++;
         }
-        else {   /*If no place for the area add the screen*/
-            disp->inv_p = 0;
-            lv_area_copy(&disp->inv_areas[disp->inv_p], &scr_area);
+        else {   /*If no place for the area join it into the saved area which grows the least*/
+            uint16_t best_i = 0;
+            uint32_t best_grow = UINT32_MAX;
+            lv_area_t joined_area;
+            for(i = 0; i < disp->inv_p; i++) {
+                _lv_area_join(&joined_area, &com_area, &disp->inv_areas[i]);
+                uint32_t grow = lv_area_get_size(&joined_area) - lv_area_get_size(&disp->inv_areas[i]);
+                if(grow < best_grow) {
+                    best_grow = grow;
+                    best_i = i;
+                }
+            }
+            _lv_area_join(&disp->inv_areas[best_i], &disp->inv_areas[best_i], &com_area);
         }
-        disp->inv_p++;
         lv_task_set_prio(disp->refr_task, LV_REFR_TASK_PRIO);
+        if(disp->driver.invalidate_cb) disp->driver.invalidate_cb(&disp->driver);
     }
 }
 
+/**
+ * Join invalid areas where redrawing their bounding box is cheaper than redrawing them one by one.
+ * The areas are sorted by their top edge, the ones joined into an other are marked in `joined`.
+ * @param areas array of areas, will be sorted and enlarged
+ * @param joined one flag for each area, should be all 0 and will be 1 for the areas joined into an other
+ * @param cnt number of areas
+ */
+void _lv_refr_join_areas(lv_area_t * areas, uint8_t * joined, uint32_t cnt)
+{
+    uint32_t i;
+    uint32_t j;
+
+    /*Sort by the top edge (insertion sort, there are only a few areas)*/
+    for(i = 1; i < cnt; i++) {
+        lv_area_t tmp;
+        lv_area_copy(&tmp, &areas[i]);
+        for(j = i; j > 0 && areas[j - 1].y1 > tmp.y1; j--) {
+            lv_area_copy(&areas[j], &areas[j - 1]);
+        }
+        lv_area_copy(&areas[j], &tmp);
+    }
+
+    /*Sweep down from every area and join the ones below it while it pays off.
+     *A join can make an other join worth it so repeat until nothing changes.*/
+    bool changed;
+    do {
+        changed = false;
+        for(i = 0; i < cnt; i++) {
+            if(joined[i]) continue;
+
+            for(j = i + 1; j < cnt; j++) {
+                if(joined[j]) continue;
+
+                /*The rows between the areas would be drawn at least as wide as 'i'.
+                 *The areas are sorted so the areas after 'j' are even farther.*/
+                int32_t gap = areas[j].y1 - areas[i].y2 - 1;
+                if(gap > 0 && (uint32_t)gap * lv_area_get_width(&areas[i]) >= LV_INV_AREA_COST) break;
+
+                if(lv_refr_join_pays(&areas[i], &areas[j])) {
+                    _lv_area_join(&areas[i], &areas[i], &areas[j]);
+                    joined[j] = 1;
+                    changed = true;
+                }
+            }
+        }
+    } while(changed);
+}
+
 /**
  * Get the display which is being refreshed
  * @return the display being refreshed
@@ -333,40 +393,26 @@ uint32_t lv_refr_get_fps_avg(void)
  **********************/
 
 /**
- * Join the areas which has got common parts
+ * Join the areas which has got common parts or are close enough to be drawn together
  */
 static void lv_refr_join_area(void)
 {
-    uint32_t join_from;
-    uint32_t join_in;
-    lv_area_t joined_area;
-    for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
-        if(disp_refr->inv_area_joined[join_in] != 0) continue;
-
-        /*Check all areas to join them in 'join_in'*/
-        for(join_from = 0; join_from < disp_refr->inv_p; join_from++) {
-            /*Handle only unjoined areas and ignore itself*/
-            if(disp_refr->inv_area_joined[join_from] != 0 || join_in == join_from) {
-                continue;
-            }
-
-            /*Check if the areas are on each other*/
-            if(_lv_area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]) == false) {
-                continue;
-            }
-
-            _lv_area_join(&joined_area, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+    _lv_refr_join_areas(disp_refr->inv_areas, disp_refr->inv_area_joined, disp_refr->inv_p);
+}
 
-            /*Join two area only if the joined area size is smaller*/
-            if(lv_area_get_size(&joined_area) < (lv_area_get_size(&disp_refr->inv_areas[join_in]) +
-                                                 lv_area_get_size(&disp_refr->inv_areas[join_from]))) {
-                lv_area_copy(&disp_refr->inv_areas[join_in], &joined_area);
+/**
+ * Tell whether drawing the bounding box of two areas is cheaper than drawing them one by one.
+ * Overlapping parts are drawn twice if the areas are drawn one by one.
+ * @param a1 pointer to an area
+ * @param a2 pointer to an other area
+ * @return true: worth to join them
+ */
+static bool lv_refr_join_pays(const lv_area_t * a1, const lv_area_t * a2)
+{
+    lv_area_t joined_area;
+    _lv_area_join(&joined_area, a1, a2);
 
-                /*Mark 'join_form' is joined into 'join_in'*/
-                disp_refr->inv_area_joined[join_from] = 1;
-            }
-        }
-    }
+    return lv_area_get_size(&joined_area) < lv_area_get_size(a1) + lv_area_get_size(a2) + LV_INV_AREA_COST;
 }
 
 /**
@@ -64,6 +64,15 @@ void lv_refr_now(lv_disp_t * disp);
  */
 void _lv_inv_area(lv_disp_t * disp, const lv_area_t * area_p);
 
+/**
+ * Join invalid areas where redrawing their bounding box is cheaper than redrawing them one by one.
+ * The areas are sorted by their top edge, the ones joined into an other are marked in `joined`.
+ * @param areas array of areas, will be sorted and enlarged
+ * @param joined one flag for each area, should be all 0 and will be 1 for the areas joined into an other
+ * @param cnt number of areas
+ */
+void _lv_refr_join_areas(lv_area_t * areas, uint8_t * joined, uint32_t cnt);
+
 /**
  * Get the display which is being refreshed
  * @return the display being refreshed
@@ -42,6 +42,10 @@ static void draw_letter_subpx(lv_coord_t pos_x, lv_coord_t pos_y, lv_font_glyph_
                               const uint8_t * map_p, lv_color_t color, lv_opa_t opa, lv_blend_mode_t blend_mode);
 
 static uint8_t hex_char_to_num(char hex);
+static uint32_t get_next_line(const lv_draw_label_dsc_t * dsc, const char * txt, uint32_t line_start,
+                              uint32_t line_id, lv_coord_t max_w);
+static lv_coord_t get_line_width(const lv_draw_label_dsc_t * dsc, const char * txt, uint32_t line_start,
+                                 uint32_t line_end, uint32_t line_id);
 
 /**********************
  *  STATIC VARIABLES
@@ -128,8 +132,8 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
     bool clip_ok = _lv_area_intersect(&clipped_area, coords, mask);
     if(!clip_ok) return;
 
-    if((dsc->flag & LV_TXT_FLAG_EXPAND) == 0) {
-        /*Normally use the label's width as width*/
+    if((dsc->flag & LV_TXT_FLAG_EXPAND) == 0 || dsc->lines) {
+        /*Normally use the label's width as width. The width is not used if the lines are known.*/
         w = lv_area_get_width(coords);
     }
     else {
@@ -156,8 +160,12 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
     pos.y += y_ofs;
 
     uint32_t line_start     = 0;
+    uint32_t line_id        = 0;
     int32_t last_line_start = -1;
 
+    /*The known lines are faster to skip than a hint*/
+    if(dsc->lines) hint = NULL;
+
     /*Check the hint to use the cached info*/
     if(hint && y_ofs == 0 && coords->y1 < 0) {
         /*If the label changed too much recalculate the hint.*/
@@ -173,13 +181,14 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
         pos.y += hint->y;
     }
 
-    uint32_t line_end = line_start + _lv_txt_get_next_line(&txt[line_start], font, dsc->letter_space, w, dsc->flag);
+    uint32_t line_end = line_start + get_next_line(dsc, txt, line_start, line_id, w);
 
     /*Go the first visible line*/
     while(pos.y + line_height_font < mask->y1) {
         /*Go to next line*/
         line_start = line_end;
-        line_end += _lv_txt_get_next_line(&txt[line_start], font, dsc->letter_space, w, dsc->flag);
+        line_id++;
+        line_end += get_next_line(dsc, txt, line_start, line_id, w);
         pos.y += line_height;
 
         /*Save at the threshold coordinate*/
@@ -194,14 +203,14 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
 
     /*Align to middle*/
     if(dsc->flag & LV_TXT_FLAG_CENTER) {
-        line_width = _lv_txt_get_width(&txt[line_start], line_end - line_start, font, dsc->letter_space, dsc->flag);
+        line_width = get_line_width(dsc, txt, line_start, line_end, line_id);
 
         pos.x += (lv_area_get_width(coords) - line_width) / 2;
 
     }
     /*Align to the right*/
     else if(dsc->flag & LV_TXT_FLAG_RIGHT) {
-        line_width = _lv_txt_get_width(&txt[line_start], line_end - line_start, font, dsc->letter_space, dsc->flag);
+        line_width = get_line_width(dsc, txt, line_start, line_end, line_id);
         pos.x += lv_area_get_width(coords) - line_width;
     }
 
@@ -355,21 +364,20 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
 #endif
         /*Go to next line*/
         line_start = line_end;
-        line_end += _lv_txt_get_next_line(&txt[line_start], font, dsc->letter_space, w, dsc->flag);
+        line_id++;
+        line_end += get_next_line(dsc, txt, line_start, line_id, w);
 
         pos.x = coords->x1;
         /*Align to middle*/
         if(dsc->flag & LV_TXT_FLAG_CENTER) {
-            line_width =
-                _lv_txt_get_width(&txt[line_start], line_end - line_start, font, dsc->letter_space, dsc->flag);
+            line_width = get_line_width(dsc, txt, line_start, line_end, line_id);
 
             pos.x += (lv_area_get_width(coords) - line_width) / 2;
 
         }
         /*Align to the right*/
         else if(dsc->flag & LV_TXT_FLAG_RIGHT) {
-            line_width =
-                _lv_txt_get_width(&txt[line_start], line_end - line_start, font, dsc->letter_space, dsc->flag);
+            line_width = get_line_width(dsc, txt, line_start, line_end, line_id);
             pos.x += lv_area_get_width(coords) - line_width;
         }
 
@@ -851,3 +859,43 @@ static uint8_t hex_char_to_num(char hex)
 
     return result;
 }
+
+/**
+ * Get the length of a line, from `dsc->lines` if the text is already broken
+ * @param dsc pointer to the draw descriptor
+ * @param txt the text
+ * @param line_start byte index of the line's first character
+ * @param line_id index of the line
+ * @param max_w max. width of a line if the text needs to be broken here
+ * @return length of the line in bytes, 0 at the end of the text
+ */
+static uint32_t get_next_line(const lv_draw_label_dsc_t * dsc, const char * txt, uint32_t line_start,
+                              uint32_t line_id, lv_coord_t max_w)
+{
+    if(dsc->lines == NULL) {
+        return _lv_txt_get_next_line(&txt[line_start], dsc->font, dsc->letter_space, max_w, dsc->flag);
+    }
+
+    if(line_id >= dsc->lines->cnt) return 0;
+    return dsc->lines->line[line_id + 1].start - line_start;
+}
+
+/**
+ * Get the width of a line, from `dsc->lines` if the text is already broken
+ * @param dsc pointer to the draw descriptor
+ * @param txt the text
+ * @param line_start byte index of the line's first character
+ * @param line_end byte index after the line's last character
+ * @param line_id index of the line
+ * @return width of the line
+ */
+static lv_coord_t get_line_width(const lv_draw_label_dsc_t * dsc, const char * txt, uint32_t line_start,
+                                 uint32_t line_end, uint32_t line_id)
+{
+    if(dsc->lines == NULL) {
+        return _lv_txt_get_width(&txt[line_start], line_end - line_start, dsc->font, dsc->letter_space, dsc->flag);
+    }
+
+    if(line_id >= dsc->lines->cnt) return 0;
+    return dsc->lines->line[line_id].w;
+}
@@ -26,6 +26,18 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
+/** A line of an already broken text*/
+typedef struct {
+    uint32_t start;     /*Byte index of the first character of the line*/
+    lv_coord_t w;       /*Width of the line*/
+} lv_draw_label_line_t;
+
+/** The lines of a text broken in advance, e.g. cached by a label*/
+typedef struct {
+    const lv_draw_label_line_t * line;  /*`cnt + 1` elements, `start` of the last one is the length of the text*/
+    uint32_t cnt;
+} lv_draw_label_lines_t;
+
 typedef struct {
     lv_color_t color;
     lv_color_t sel_color;
@@ -42,6 +54,7 @@ typedef struct {
     lv_txt_flag_t flag;
     lv_text_decor_t decor;
     lv_blend_mode_t blend_mode;
+    const lv_draw_label_lines_t * lines;    /*Lines of the text or NULL to break the text while drawing*/
 } lv_draw_label_dsc_t;
 
 /** Store some info to speed up drawing of very large texts
@@ -15,6 +15,10 @@
 #include "../lv_misc/lv_utils.h"
 #include "../lv_misc/lv_mem.h"
 
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    #include LV_FONT_GLYPH_CACHE_INCLUDE
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -22,6 +26,17 @@
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+/*A decompressed glyph. The entries are linked from the most recently used one*/
+typedef struct _glyph_cache_entry_t {
+    struct _glyph_cache_entry_t * prev;
+    struct _glyph_cache_entry_t * next;
+    const lv_font_t * font;
+    uint32_t gid;
+    uint32_t size;          /*Size of the whole entry*/
+    uint8_t bitmap[];
+} glyph_cache_entry_t;
+#endif
 typedef enum {
     RLE_STATE_SINGLE = 0,
     RLE_STATE_REPEATE,
@@ -46,6 +61,13 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element);
     static inline uint8_t rle_next(void);
 #endif /* LV_USE_FONT_COMPRESSED */
 
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    static const uint8_t * glyph_cache_get(const lv_font_t * font, uint32_t gid);
+    static uint8_t * glyph_cache_add(const lv_font_t * font, uint32_t gid, uint32_t bitmap_size);
+    static void glyph_cache_unlink(glyph_cache_entry_t * entry);
+    static void glyph_cache_remove(glyph_cache_entry_t * entry);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -58,6 +80,11 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element);
     static rle_state_t rle_state;
 #endif /* LV_USE_FONT_COMPRESSED */
 
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    static glyph_cache_entry_t * glyph_cache_lru;     /*Least recently used glyph, dropped first*/
+    static lv_font_glyph_cache_stats_t glyph_cache_stats;
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -112,6 +139,21 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
                 break;
         }
 
+        bool prefilter = fdsc->bitmap_format == LV_FONT_FMT_TXT_COMPRESSED ? true : false;
+
+#if LV_FONT_GLYPH_CACHE_SIZE
+        const uint8_t * cached = glyph_cache_get(font, gid);
+        if(cached) return cached;
+
+        uint8_t * cache_buf = glyph_cache_add(font, gid, buf_size);
+        if(cache_buf) {
+            decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], cache_buf, gdsc->box_w, gdsc->box_h,
+                       (uint8_t)fdsc->bpp, prefilter);
+            return cache_buf;
+        }
+        /*Larger than the cache or out of memory: use the shared buffer*/
+#endif
+
         if(_lv_mem_get_size(LV_GC_ROOT(_lv_font_decompr_buf)) < buf_size) {
             uint8_t * tmp = lv_mem_realloc(LV_GC_ROOT(_lv_font_decompr_buf), buf_size);
             LV_ASSERT_MEM(tmp);
@@ -119,7 +161,6 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
             LV_GC_ROOT(_lv_font_decompr_buf) = tmp;
         }
 
-        bool prefilter = fdsc->bitmap_format == LV_FONT_FMT_TXT_COMPRESSED ? true : false;
         decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], LV_GC_ROOT(_lv_font_decompr_buf), gdsc->box_w, gdsc->box_h,
                    (uint8_t)fdsc->bpp, prefilter);
         return LV_GC_ROOT(_lv_font_decompr_buf);
@@ -192,6 +233,39 @@ void _lv_font_clean_up_fmt_txt(void)
         lv_mem_free(LV_GC_ROOT(_lv_font_decompr_buf));
         LV_GC_ROOT(_lv_font_decompr_buf) = NULL;
     }
+
+    lv_font_glyph_cache_invalidate(NULL);
+}
+
+/**
+ * Get the counters of the decompressed glyph cache. All 0 if `LV_FONT_GLYPH_CACHE_SIZE` is 0.
+ * @param stats store the counters here
+ */
+void lv_font_glyph_cache_get_stats(lv_font_glyph_cache_stats_t * stats)
+{
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    *stats = glyph_cache_stats;
+#else
+    _lv_memset_00(stats, sizeof(lv_font_glyph_cache_stats_t));
+#endif
+}
+
+/**
+ * Drop the cached glyphs of a font. Has to be called before a font is freed.
+ * @param font pointer to a font or NULL to drop every glyph
+ */
+void lv_font_glyph_cache_invalidate(const lv_font_t * font)
+{
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    glyph_cache_entry_t * entry = LV_GC_ROOT(_lv_font_glyph_cache);
+    while(entry) {
+        glyph_cache_entry_t * next = entry->next;
+        if(font == NULL || entry->font == font) glyph_cache_remove(entry);
+        entry = next;
+    }
+#else
+    LV_UNUSED(font);
+#endif
 }
 
 /**********************
@@ -563,6 +637,101 @@ static inline uint8_t rle_next(void)
 }
 #endif /* LV_USE_FONT_COMPRESSED */
 
+#if LV_USE_FONT_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+/**
+ * Look up a decompressed glyph and make it the most recently used one
+ * @param font pointer to the font
+ * @param gid glyph id in the font
+ * @return the decompressed bitmap or NULL if not cached
+ */
+static const uint8_t * glyph_cache_get(const lv_font_t * font, uint32_t gid)
+{
+    glyph_cache_entry_t * entry;
+    for(entry = LV_GC_ROOT(_lv_font_glyph_cache); entry; entry = entry->next) {
+        if(entry->gid == gid && entry->font == font) break;
+    }
+
+    if(entry == NULL) {
+        glyph_cache_stats.miss++;
+        return NULL;
+    }
+
+    glyph_cache_stats.hit++;
+    if(entry->prev) {
+        glyph_cache_unlink(entry);
+        entry->next = LV_GC_ROOT(_lv_font_glyph_cache);
+        entry->next->prev = entry;
+        LV_GC_ROOT(_lv_font_glyph_cache) = entry;
+    }
+
+    return entry->bitmap;
+}
+
+/**
+ * Allocate a new most recently used entry, dropping the least recently used ones to stay in
+ * `LV_FONT_GLYPH_CACHE_SIZE` bytes
+ * @param font pointer to the font
+ * @param gid glyph id in the font
+ * @param bitmap_size size of the decompressed bitmap
+ * @return buffer to decompress the glyph into or NULL if it doesn't fit
+ */
+static uint8_t * glyph_cache_add(const lv_font_t * font, uint32_t gid, uint32_t bitmap_size)
+{
+    uint32_t size = sizeof(glyph_cache_entry_t) + bitmap_size;
+    if(size > LV_FONT_GLYPH_CACHE_SIZE) return NULL;
+
+    while(glyph_cache_lru && glyph_cache_stats.used + size > LV_FONT_GLYPH_CACHE_SIZE) {
+        glyph_cache_remove(glyph_cache_lru);
+        glyph_cache_stats.evicted++;
+    }
+
+    glyph_cache_entry_t * entry = LV_FONT_GLYPH_CACHE_ALLOC(size);
+    if(entry == NULL) return NULL;
+
+    entry->font = font;
+    entry->gid = gid;
+    entry->size = size;
+    entry->prev = NULL;
+    entry->next = LV_GC_ROOT(_lv_font_glyph_cache);
+    if(entry->next) entry->next->prev = entry;
+    else glyph_cache_lru = entry;
+    LV_GC_ROOT(_lv_font_glyph_cache) = entry;
+
+    glyph_cache_stats.used += size;
+    glyph_cache_stats.entries++;
+
+    return entry->bitmap;
+}
+
+/**
+ * Take an entry out of the list
+ * @param entry pointer to a cached entry
+ */
+static void glyph_cache_unlink(glyph_cache_entry_t * entry)
+{
+    if(entry->prev) entry->prev->next = entry->next;
+    else LV_GC_ROOT(_lv_font_glyph_cache) = entry->next;
+
+    if(entry->next) entry->next->prev = entry->prev;
+    else glyph_cache_lru = entry->prev;
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+/**
+ * Unlink and free an entry
+ * @param entry pointer to a cached entry
+ */
+static void glyph_cache_remove(glyph_cache_entry_t * entry)
+{
+    glyph_cache_unlink(entry);
+    glyph_cache_stats.used -= entry->size;
+    glyph_cache_stats.entries--;
+    LV_FONT_GLYPH_CACHE_FREE(entry);
+}
+#endif
+
 /** Code Comparator.
  *
  *  Compares the value of both input arguments.
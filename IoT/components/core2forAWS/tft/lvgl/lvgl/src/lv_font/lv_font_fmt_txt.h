@@ -192,6 +192,15 @@ typedef struct {
 
 } lv_font_fmt_txt_dsc_t;
 
+/** Counters of the decompressed glyph cache */
+typedef struct {
+    uint32_t hit;           /**< Glyphs found in the cache*/
+    uint32_t miss;          /**< Glyphs decompressed*/
+    uint32_t evicted;       /**< Glyphs dropped to make room*/
+    uint32_t used;          /**< Bytes allocated for the cached glyphs*/
+    uint32_t entries;       /**< Number of cached glyphs*/
+} lv_font_glyph_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -220,6 +229,18 @@ bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t * font, lv_font_glyph_dsc_t *
  */
 void _lv_font_clean_up_fmt_txt(void);
 
+/**
+ * Get the counters of the decompressed glyph cache. All 0 if `LV_FONT_GLYPH_CACHE_SIZE` is 0.
+ * @param stats store the counters here
+ */
+void lv_font_glyph_cache_get_stats(lv_font_glyph_cache_stats_t * stats);
+
+/**
+ * Drop the cached glyphs of a font. Has to be called before a font is freed.
+ * @param font pointer to a font or NULL to drop every glyph
+ */
+void lv_font_glyph_cache_invalidate(const lv_font_t * font);
+
 /**********************
  *      MACROS
  **********************/
@@ -30,6 +30,12 @@ extern "C" {
 #define LV_INV_BUF_SIZE 32 /*Buffer size for invalid areas */
 #endif
 
+/*Work of refreshing one more area (object tree walk, flush setup) expressed in pixels.
+ *Two invalid areas are redrawn as one if their bounding box is larger than both of them by less than this.*/
+#ifndef LV_INV_AREA_COST
+#define LV_INV_AREA_COST 256
+#endif
+
 #ifndef LV_ATTRIBUTE_FLUSH_READY
 #define LV_ATTRIBUTE_FLUSH_READY
 #endif
@@ -115,6 +121,10 @@ typedef struct _disp_drv_t {
      * number of flushed pixels */
     void (*monitor_cb)(struct _disp_drv_t * disp_drv, uint32_t time, uint32_t px);
 
+    /** OPTIONAL: Called when an area got invalidated and the display needs to be refreshed.
+     * E.g. to wake up the task calling `lv_task_handler()` when it sleeps until the next task is due */
+    void (*invalidate_cb)(struct _disp_drv_t * disp_drv);
+
     /** OPTIONAL: Called periodically while lvgl waits for operation to be completed.
      * For example flushing or GPU
      * User can execute very simple tasks here or yield the task */
@@ -37,6 +37,7 @@ extern "C" {
     f(lv_ll_t, _lv_obj_style_trans_ll)                             \
     f(lv_img_cache_entry_t*, _lv_img_cache_array)                  \
     f(lv_task_t*, _lv_task_act)                                    \
+    f(lv_task_heap_arr_t, _lv_task_heap) /*Task queues by priority*/  \
     f(lv_mem_buf_arr_t , _lv_mem_buf)                              \
     f(_lv_draw_mask_saved_arr_t , _lv_draw_mask_list)              \
     f(void * , _lv_theme_material_styles)                          \
@@ -44,6 +45,7 @@ extern "C" {
     f(void * , _lv_theme_mono_styles)                              \
     f(void * , _lv_theme_empty_styles)                             \
     f(uint8_t *, _lv_font_decompr_buf)                             \
+    f(void * , _lv_font_glyph_cache)  /*Most recently used glyph*/  \
 
 #define LV_DEFINE_ROOT(root_type, root_name) root_type root_name;
 #define LV_ROOTS LV_ITERATE_ROOTS(LV_DEFINE_ROOT)
@@ -15,6 +15,8 @@
 
 #if LV_MEM_CUSTOM != 0
     #include LV_MEM_CUSTOM_INCLUDE
+#elif LV_MEM_TLSF
+    #include "lv_tlsf.h"
 #endif
 
 /*********************
@@ -68,7 +70,7 @@ typedef struct {
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
     static lv_mem_ent_t * ent_get_next(lv_mem_ent_t * act_e);
     static void * ent_alloc(lv_mem_ent_t * e, size_t size);
     static void ent_trunc(lv_mem_ent_t * e, size_t size);
@@ -79,11 +81,14 @@ typedef struct {
  **********************/
 #if LV_MEM_CUSTOM == 0
     static uint8_t * work_mem;
+#if LV_MEM_TLSF
+    static lv_tlsf_t * tlsf;
+#endif
 #endif
 
 static uint32_t zero_mem; /*Give the address of this variable if 0 byte should be allocated*/
 
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
     static uint32_t mem_max_size; /*Tracks the maximum total size of memory ever used from the internal heap*/
 #endif
 
@@ -123,11 +128,16 @@ void _lv_mem_init(void)
     work_mem = (uint8_t *)LV_MEM_ADR;
 #endif
 
+#if LV_MEM_TLSF
+    tlsf = lv_tlsf_create(work_mem, LV_MEM_SIZE);
+    LV_ASSERT_NULL(tlsf);
+#else
     lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
     full->header.s.used = 0;
     /*The total mem size reduced by the first header and the close patterns */
     full->header.s.d_size = LV_MEM_SIZE - sizeof(lv_mem_header_t);
 #endif
+#endif
 }
 
 /**
@@ -137,11 +147,15 @@ void _lv_mem_init(void)
 void _lv_mem_deinit(void)
 {
 #if LV_MEM_CUSTOM == 0
+#if LV_MEM_TLSF
+    tlsf = lv_tlsf_create(work_mem, LV_MEM_SIZE);
+#else
     lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
     full->header.s.used = 0;
     /*The total mem size reduced by the first header and the close patterns */
     full->header.s.d_size = LV_MEM_SIZE - sizeof(lv_mem_header_t);
 #endif
+#endif
 }
 
 /**
@@ -159,7 +173,10 @@ void * lv_mem_alloc(size_t size)
     size = (size + ALIGN_MASK) & (~ALIGN_MASK);
     void * alloc = NULL;
 
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+    /*The blocks of the pool have their own headers*/
+    alloc = lv_tlsf_alloc(tlsf, size);
+#elif LV_MEM_CUSTOM == 0
     /*Use the built-in allocators*/
     lv_mem_ent_t * e = NULL;
 
@@ -199,7 +216,7 @@ void * lv_mem_alloc(size_t size)
         LV_LOG_WARN("Couldn't allocate memory");
     }
     else {
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
         /* just a safety check, should always be true */
         if((uintptr_t) alloc > (uintptr_t) work_mem) {
             if((((uintptr_t) alloc - (uintptr_t) work_mem) + size) > mem_max_size) {
@@ -225,6 +242,10 @@ void lv_mem_free(const void * data)
     _lv_memset((void *)data, 0xbb, _lv_mem_get_size(data));
 #endif
 
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+    /*Joined with the free neighbors right away*/
+    lv_tlsf_free(tlsf, data);
+#else
 #if LV_ENABLE_GC == 0
     /*e points to the header*/
     lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data - sizeof(lv_mem_header_t));
@@ -263,6 +284,7 @@ void lv_mem_free(const void * data)
     LV_MEM_CUSTOM_FREE((void *)data);
 #endif /*LV_ENABLE_GC*/
 #endif
+#endif /*LV_MEM_TLSF*/
 }
 
 /**
@@ -280,6 +302,15 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
     /*Round the size up to ALIGN_MASK*/
     new_size = (new_size + ALIGN_MASK) & (~ALIGN_MASK);
 
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+    if(data_p == &zero_mem) data_p = NULL;
+
+    uint32_t old_size = _lv_mem_get_size(data_p);
+    if(old_size == new_size) return data_p; /*Also avoid reallocating the same memory*/
+
+    /*Shrink or grow into the next free block without copying*/
+    if(data_p != NULL && new_size != 0 && lv_tlsf_resize(tlsf, data_p, new_size)) return data_p;
+#else
     /*data_p could be previously freed pointer (in this case it is invalid)*/
     if(data_p != NULL) {
         lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
@@ -290,8 +321,9 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
 
     uint32_t old_size = _lv_mem_get_size(data_p);
     if(old_size == new_size) return data_p; /*Also avoid reallocating the same memory*/
+#endif
 
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
     /* Truncate the memory if the new size is smaller. */
     if(new_size < old_size) {
         lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
@@ -334,7 +366,8 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
  */
 void lv_mem_defrag(void)
 {
-#if LV_MEM_CUSTOM == 0
+    /*TLSF joins the free blocks on free*/
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
     lv_mem_ent_t * e_free;
     lv_mem_ent_t * e_next;
     e_free = ent_get_next(NULL);
@@ -375,7 +408,9 @@ void lv_mem_defrag(void)
 
 lv_res_t lv_mem_test(void)
 {
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+    return lv_tlsf_check(tlsf);
+#elif LV_MEM_CUSTOM == 0
     lv_mem_ent_t * e;
     e = ent_get_next(NULL);
     while(e) {
@@ -402,6 +437,15 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
     /*Init the data*/
     _lv_memset(mon_p, 0, sizeof(lv_mem_monitor_t));
 #if LV_MEM_CUSTOM == 0
+#if LV_MEM_TLSF
+    lv_tlsf_monitor_t tlsf_mon;
+    lv_tlsf_monitor(tlsf, &tlsf_mon);
+    mon_p->free_cnt = tlsf_mon.free_cnt;
+    mon_p->free_size = tlsf_mon.free_size;
+    mon_p->free_biggest_size = tlsf_mon.free_biggest_size;
+    mon_p->used_cnt = tlsf_mon.used_cnt;
+    mon_p->max_used = tlsf_mon.used_max;
+#else
     lv_mem_ent_t * e;
 
     e = ent_get_next(NULL);
@@ -420,8 +464,9 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
 
         e = ent_get_next(e);
     }
-    mon_p->total_size = LV_MEM_SIZE;
     mon_p->max_used = mem_max_size;
+#endif
+    mon_p->total_size = LV_MEM_SIZE;
     mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
     if(mon_p->free_size > 0) {
         mon_p->frag_pct = mon_p->free_biggest_size * 100U / mon_p->free_size;
@@ -446,9 +491,13 @@ uint32_t _lv_mem_get_size(const void * data)
     if(data == NULL) return 0;
     if(data == &zero_mem) return 0;
 
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+    return lv_tlsf_get_size(data);
+#else
     lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data - sizeof(lv_mem_header_t));
 
     return e->header.s.d_size;
+#endif
 }
 
 #else /* LV_ENABLE_GC */
@@ -757,7 +806,7 @@ LV_ATTRIBUTE_FAST_MEM void _lv_memset_ff(void * dst, size_t len)
  *   STATIC FUNCTIONS
  **********************/
 
-#if LV_MEM_CUSTOM == 0
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF == 0
 /**
  * Give the next entry after 'act_e'
  * @param act_e pointer to an entry
@@ -3,6 +3,7 @@ CSRCS += lv_task.c
 CSRCS += lv_fs.c
 CSRCS += lv_anim.c
 CSRCS += lv_mem.c
+CSRCS += lv_tlsf.c
 CSRCS += lv_ll.c
 CSRCS += lv_color.c
 CSRCS += lv_txt.c
@@ -29,6 +29,16 @@
  **********************/
 static bool lv_task_exec(lv_task_t * task);
 static uint32_t lv_task_time_remaining(lv_task_t * task);
+static uint32_t task_remaining_at(const lv_task_t * task, uint32_t now);
+static bool heap_reserve(lv_task_heap_t * heap);
+static bool heap_insert(lv_task_t * task);
+static void heap_remove(lv_task_t * task);
+static void heap_update(lv_task_t * task);
+static void heap_pop(lv_task_heap_t * heap);
+static void heap_unpark(lv_task_heap_t * heap);
+static void heap_sift_up(lv_task_heap_t * heap, uint32_t i, uint32_t now);
+static void heap_sift_down(lv_task_heap_t * heap, uint32_t i, uint32_t now);
+static void heap_move(lv_task_heap_t * heap, uint32_t from, uint32_t to);
 
 /**********************
  *  STATIC VARIABLES
@@ -36,8 +46,6 @@ static uint32_t lv_task_time_remaining(lv_task_t * task);
 static bool lv_task_run  = false;
 static uint8_t idle_last = 0;
 static bool task_deleted;
-static bool task_list_changed;
-static bool task_created;
 
 /**********************
  *      MACROS
@@ -53,6 +61,7 @@ static bool task_created;
 void _lv_task_core_init(void)
 {
     _lv_ll_init(&LV_GC_ROOT(_lv_task_ll), sizeof(lv_task_t));
+    _lv_memset_00(LV_GC_ROOT(_lv_task_heap), sizeof(LV_GC_ROOT(_lv_task_heap)));
 
     /*Initially enable the lv_task handling*/
     lv_task_enable(true);
@@ -81,89 +90,37 @@ LV_ATTRIBUTE_TASK_HANDLER uint32_t lv_task_handler(void)
 
     uint32_t handler_start = lv_tick_get();
 
-    /* Run all task from the highest to the lowest priority
-     * If a lower priority task is executed check task again from the highest priority
-     * but on the priority of executed tasks don't run tasks before the executed*/
-    lv_task_t * task_interrupter = NULL;
-    lv_task_t * next;
-    bool end_flag;
-    do {
-        end_flag                 = true;
-        task_deleted             = false;
-        task_created             = false;
-        task_list_changed        = false;
-        LV_GC_ROOT(_lv_task_act) = _lv_ll_get_head(&LV_GC_ROOT(_lv_task_ll));
-        while(LV_GC_ROOT(_lv_task_act)) {
-            /* The task might be deleted if it runs only once ('once = 1')
-             * So get next element until the current is surely valid*/
-            next = _lv_ll_get_next(&LV_GC_ROOT(_lv_task_ll), LV_GC_ROOT(_lv_task_act));
-
-            /*We reach priority of the turned off task. There is nothing more to do.*/
-            if(LV_GC_ROOT(_lv_task_act)->prio == LV_TASK_PRIO_OFF) {
+    /* Every priority has its own queue with the task to run next on the top.
+     * Run the due task of the highest priority, then look at the highest priority again.
+     * A task which ran is kept out of the queue until the end, so every task runs at most once.*/
+    while(1) {
+        uint32_t now = lv_tick_get();
+        lv_task_heap_t * heap = NULL;
+        int8_t p;
+        for(p = LV_TASK_PRIO_HIGHEST; p > LV_TASK_PRIO_OFF; p--) {
+            lv_task_heap_t * h = &LV_GC_ROOT(_lv_task_heap)[p];
+            if(h->cnt > 0 && task_remaining_at(h->tasks[0], now) == 0) {
+                heap = h;
                 break;
             }
-
-            /*Here is the interrupter task. Don't execute it again.*/
-            if(LV_GC_ROOT(_lv_task_act) == task_interrupter) {
-                task_interrupter = NULL; /*From this point only task after the interrupter comes, so
-                                            the interrupter is not interesting anymore*/
-                LV_GC_ROOT(_lv_task_act) = next;
-                continue; /*Load the next task*/
-            }
-
-            /*Just try to run the tasks with highest priority.*/
-            if(LV_GC_ROOT(_lv_task_act)->prio == LV_TASK_PRIO_HIGHEST) {
-                lv_task_exec(LV_GC_ROOT(_lv_task_act));
-            }
-            /*Tasks with higher priority than the interrupted shall be run in every case*/
-            else if(task_interrupter) {
-                if(LV_GC_ROOT(_lv_task_act)->prio > task_interrupter->prio) {
-                    if(lv_task_exec(LV_GC_ROOT(_lv_task_act))) {
-                        if(!task_created && !task_deleted) {
-                            /*Check all tasks again from the highest priority */
-                            task_interrupter = LV_GC_ROOT(_lv_task_act);
-                            end_flag = false;
-                            break;
-                        }
-                    }
-                }
-            }
-            /* It is no interrupter task or we already reached it earlier.
-             * Just run the remaining tasks*/
-            else {
-                if(lv_task_exec(LV_GC_ROOT(_lv_task_act))) {
-                    if(!task_created && !task_deleted) {
-                        task_interrupter = LV_GC_ROOT(_lv_task_act); /*Check all tasks again from the highest priority */
-                        end_flag         = false;
-                        break;
-                    }
-                }
-            }
-
-            /*If a task was created or deleted then this or the next item might be corrupted*/
-            if(task_created || task_deleted) {
-                task_interrupter = NULL;
-                break;
-            }
-
-            if(task_list_changed) {
-                task_interrupter = NULL;
-                end_flag = false;
-                break;
-            }
-
-            LV_GC_ROOT(_lv_task_act) = next; /*Load the next task*/
         }
-    } while(!end_flag);
+        if(heap == NULL) break;
 
-    uint32_t time_till_next = LV_NO_TASK_READY;
-    next = _lv_ll_get_head(&LV_GC_ROOT(_lv_task_ll));
-    while(next && next->prio != LV_TASK_PRIO_OFF) {
-        uint32_t delay = lv_task_time_remaining(next);
-        if(delay < time_till_next)
-            time_till_next = delay;
+        lv_task_t * task = heap->tasks[0];
+        heap_pop(heap);
+        lv_task_exec(task);
+    }
 
-        next = _lv_ll_get_next(&LV_GC_ROOT(_lv_task_ll), next); /*Find the next task*/
+    uint32_t time_till_next = LV_NO_TASK_READY;
+    uint8_t p;
+    for(p = LV_TASK_PRIO_LOWEST; p < _LV_TASK_PRIO_NUM; p++) {
+        lv_task_heap_t * h = &LV_GC_ROOT(_lv_task_heap)[p];
+        heap_unpark(h);
+        if(h->cnt > 0) {
+            uint32_t delay = lv_task_time_remaining(h->tasks[0]);
+            if(delay < time_till_next)
+                time_till_next = delay;
+        }
     }
 
     busy_time += lv_tick_elaps(handler_start);
@@ -202,38 +159,9 @@ lv_task_t * lv_task_create_basic(void)
  */
 lv_task_t * lv_task_create(lv_task_cb_t task_xcb, uint32_t period, lv_task_prio_t prio, void * user_data)
 {
-    lv_task_t * new_task = NULL;
-    lv_task_t * tmp;
-
-    /*Create task lists in order of priority from high to low*/
-    tmp = _lv_ll_get_head(&LV_GC_ROOT(_lv_task_ll));
-
-    /*It's the first task*/
-    if(NULL == tmp) {
-        new_task = _lv_ll_ins_head(&LV_GC_ROOT(_lv_task_ll));
-        LV_ASSERT_MEM(new_task);
-        if(new_task == NULL) return NULL;
-    }
-    /*Insert the new task to proper place according to its priority*/
-    else {
-        do {
-            if(tmp->prio <= prio) {
-                new_task = _lv_ll_ins_prev(&LV_GC_ROOT(_lv_task_ll), tmp);
-                LV_ASSERT_MEM(new_task);
-                if(new_task == NULL) return NULL;
-                break;
-            }
-            tmp = _lv_ll_get_next(&LV_GC_ROOT(_lv_task_ll), tmp);
-        } while(tmp != NULL);
-
-        /*Only too high priority tasks were found. Add the task to the end*/
-        if(tmp == NULL) {
-            new_task = _lv_ll_ins_tail(&LV_GC_ROOT(_lv_task_ll));
-            LV_ASSERT_MEM(new_task);
-            if(new_task == NULL) return NULL;
-        }
-    }
-    task_list_changed = true;
+    lv_task_t * new_task = _lv_ll_ins_head(&LV_GC_ROOT(_lv_task_ll));
+    LV_ASSERT_MEM(new_task);
+    if(new_task == NULL) return NULL;
 
     new_task->period  = period;
     new_task->task_cb = task_xcb;
@@ -244,7 +172,11 @@ lv_task_t * lv_task_create(lv_task_cb_t task_xcb, uint32_t period, lv_task_prio_
 
     new_task->user_data = user_data;
 
-    task_created = true;
+    if(heap_insert(new_task) == false) {
+        _lv_ll_remove(&LV_GC_ROOT(_lv_task_ll), new_task);
+        lv_mem_free(new_task);
+        return NULL;
+    }
 
     return new_task;
 }
@@ -265,8 +197,8 @@ void lv_task_set_cb(lv_task_t * task, lv_task_cb_t task_cb)
  */
 void lv_task_del(lv_task_t * task)
 {
+    heap_remove(task);
     _lv_ll_remove(&LV_GC_ROOT(_lv_task_ll), task);
-    task_list_changed = true;
 
     lv_mem_free(task);
 
@@ -282,22 +214,13 @@ void lv_task_set_prio(lv_task_t * task, lv_task_prio_t prio)
 {
     if(task->prio == prio) return;
 
-    /*Find the tasks with new priority*/
-    lv_task_t * i;
-    _LV_LL_READ(LV_GC_ROOT(_lv_task_ll), i) {
-        if(i->prio <= prio) {
-            if(i != task) _lv_ll_move_before(&LV_GC_ROOT(_lv_task_ll), task, i);
-            break;
-        }
-    }
-
-    /*There was no such a low priority so far then add the node to the tail*/
-    if(i == NULL) {
-        _lv_ll_move_before(&LV_GC_ROOT(_lv_task_ll), task, NULL);
-    }
-    task_list_changed = true;
+    /*Make room in the new queue first, so the task stays where it is if that fails*/
+    lv_task_heap_t * heap = &LV_GC_ROOT(_lv_task_heap)[prio];
+    if(heap_reserve(heap) == false) return;
 
+    heap_remove(task);
     task->prio = prio;
+    heap_insert(task);
 }
 
 /**
@@ -308,6 +231,7 @@ void lv_task_set_prio(lv_task_t * task, lv_task_prio_t prio)
 void lv_task_set_period(lv_task_t * task, uint32_t period)
 {
     task->period = period;
+    heap_update(task);
 }
 
 /**
@@ -317,6 +241,7 @@ void lv_task_set_period(lv_task_t * task, uint32_t period)
 void lv_task_ready(lv_task_t * task)
 {
     task->last_run = lv_tick_get() - task->period - 1;
+    heap_update(task);
 }
 
 /**
@@ -337,6 +262,7 @@ void lv_task_set_repeat_count(lv_task_t * task, int32_t repeat_count)
 void lv_task_reset(lv_task_t * task)
 {
     task->last_run = lv_tick_get();
+    heap_update(task);
 }
 
 /**
@@ -373,7 +299,7 @@ lv_task_t * lv_task_get_next(lv_task_t * task)
  **********************/
 
 /**
- * Execute task if its the priority is appropriate
+ * Execute a task which is due
  * @param task pointer to lv_task
  * @return true: execute, false: not executed
  */
@@ -382,6 +308,9 @@ static bool lv_task_exec(lv_task_t * task)
     bool exec = false;
 
     if(lv_task_time_remaining(task) == 0) {
+        LV_GC_ROOT(_lv_task_act) = task;
+        task_deleted = false;
+
         task->last_run = lv_tick_get();
         if(task->task_cb) task->task_cb(task);
 
@@ -394,6 +323,8 @@ static bool lv_task_exec(lv_task_t * task)
                 lv_task_del(task);
             }
         }
+
+        LV_GC_ROOT(_lv_task_act) = NULL;
         exec = true;
     }
 
@@ -406,10 +337,192 @@ static bool lv_task_exec(lv_task_t * task)
  * @return the time remaining, or 0 if it needs to be run again
  */
 static uint32_t lv_task_time_remaining(lv_task_t * task)
+{
+    return task_remaining_at(task, lv_tick_get());
+}
+
+/**
+ * The time remaining before a task must be run, as seen at `now`.
+ * As time goes on it decreases by the same amount for every task until it reaches 0,
+ * so an order by it stays valid and the queues never have to be rebuilt.
+ * @param task pointer to lv_task
+ * @param now the current tick
+ * @return the time remaining, or 0 if it needs to be run again
+ */
+static uint32_t task_remaining_at(const lv_task_t * task, uint32_t now)
 {
     /*Check if at least 'period' time elapsed*/
-    uint32_t elp = lv_tick_elaps(task->last_run);
+    uint32_t elp = now - task->last_run;
     if(elp >= task->period)
         return 0;
     return task->period - elp;
 }
+
+/**
+ * Make sure a queue has room for one more task
+ * @param heap pointer to a queue
+ * @return false: out of memory
+ */
+static bool heap_reserve(lv_task_heap_t * heap)
+{
+    if(heap->total < heap->size) return true;
+
+    uint32_t new_size = heap->size ? heap->size * 2 : 4;
+    lv_task_t ** tasks = lv_mem_realloc(heap->tasks, new_size * sizeof(lv_task_t *));
+    LV_ASSERT_MEM(tasks);
+    if(tasks == NULL) return false;
+
+    heap->tasks = tasks;
+    heap->size = new_size;
+    return true;
+}
+
+/**
+ * Add a task to the queue of its priority
+ * @param task pointer to lv_task
+ * @return false: out of memory
+ */
+static bool heap_insert(lv_task_t * task)
+{
+    lv_task_heap_t * heap = &LV_GC_ROOT(_lv_task_heap)[task->prio];
+
+    if(heap_reserve(heap) == false) return false;
+
+    /*Tasks which already ran in this handler call are stored right after the heap, make room*/
+    if(heap->cnt != heap->total) heap_move(heap, heap->cnt, heap->total);
+    heap->total++;
+
+    heap->tasks[heap->cnt] = task;
+    task->heap_index = heap->cnt;
+    heap->cnt++;
+    heap_sift_up(heap, task->heap_index, lv_tick_get());
+
+    return true;
+}
+
+/**
+ * Remove a task from the queue of its priority
+ * @param task pointer to lv_task
+ */
+static void heap_remove(lv_task_t * task)
+{
+    lv_task_heap_t * heap = &LV_GC_ROOT(_lv_task_heap)[task->prio];
+    uint32_t i = task->heap_index;
+
+    if(i < heap->cnt) {
+        /*Fill the hole with the last task of the heap, then the hole this leaves with the last task ran*/
+        heap->cnt--;
+        if(i != heap->cnt) heap_move(heap, heap->cnt, i);
+        heap->total--;
+        if(heap->cnt != heap->total) heap_move(heap, heap->total, heap->cnt);
+
+        if(i < heap->cnt) {
+            lv_task_t * moved = heap->tasks[i];
+            uint32_t now = lv_tick_get();
+            heap_sift_up(heap, i, now);
+            heap_sift_down(heap, moved->heap_index, now);
+        }
+    }
+    else {
+        heap->total--;
+        if(i != heap->total) heap_move(heap, heap->total, i);
+    }
+}
+
+/**
+ * Restore the order of a queue after the time of a task's next run has changed
+ * @param task pointer to lv_task
+ */
+static void heap_update(lv_task_t * task)
+{
+    lv_task_heap_t * heap = &LV_GC_ROOT(_lv_task_heap)[task->prio];
+    uint32_t i = task->heap_index;
+
+    /*A task that already ran is put back in order at the end of the handler call*/
+    if(i >= heap->cnt) return;
+
+    uint32_t now = lv_tick_get();
+    heap_sift_up(heap, i, now);
+    heap_sift_down(heap, task->heap_index, now);
+}
+
+/**
+ * Take the top task out of the heap and keep it right after the heap
+ * @param heap pointer to a queue
+ */
+static void heap_pop(lv_task_heap_t * heap)
+{
+    lv_task_t * top = heap->tasks[0];
+
+    heap->cnt--;
+    if(heap->cnt != 0) {
+        heap_move(heap, heap->cnt, 0);
+        heap->tasks[heap->cnt] = top;
+        top->heap_index = heap->cnt;
+        heap_sift_down(heap, 0, lv_tick_get());
+    }
+}
+
+/**
+ * Put the tasks which ran in the handler call back to the heap
+ * @param heap pointer to a queue
+ */
+static void heap_unpark(lv_task_heap_t * heap)
+{
+    uint32_t now = lv_tick_get();
+    while(heap->cnt < heap->total) {
+        heap->cnt++;
+        heap_sift_up(heap, heap->cnt - 1, now);
+    }
+}
+
+static void heap_sift_up(lv_task_heap_t * heap, uint32_t i, uint32_t now)
+{
+    lv_task_t * task = heap->tasks[i];
+    uint32_t remaining = task_remaining_at(task, now);
+
+    while(i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if(task_remaining_at(heap->tasks[parent], now) <= remaining) break;
+        heap_move(heap, parent, i);
+        i = parent;
+    }
+
+    heap->tasks[i] = task;
+    task->heap_index = i;
+}
+
+static void heap_sift_down(lv_task_heap_t * heap, uint32_t i, uint32_t now)
+{
+    if(i >= heap->cnt) return;
+
+    lv_task_t * task = heap->tasks[i];
+    uint32_t remaining = task_remaining_at(task, now);
+
+    while(1) {
+        uint32_t child = 2 * i + 1;
+        if(child >= heap->cnt) break;
+
+        uint32_t child_remaining = task_remaining_at(heap->tasks[child], now);
+        if(child + 1 < heap->cnt) {
+            uint32_t right_remaining = task_remaining_at(heap->tasks[child + 1], now);
+            if(right_remaining < child_remaining) {
+                child++;
+                child_remaining = right_remaining;
+            }
+        }
+        if(remaining <= child_remaining) break;
+
+        heap_move(heap, child, i);
+        i = child;
+    }
+
+    heap->tasks[i] = task;
+    task->heap_index = i;
+}
+
+static void heap_move(lv_task_heap_t * heap, uint32_t from, uint32_t to)
+{
+    heap->tasks[to] = heap->tasks[from];
+    heap->tasks[to]->heap_index = to;
+}
@@ -65,9 +65,24 @@ typedef struct _lv_task_t {
     void * user_data; /**< Custom user data */
 
     int32_t repeat_count; /**< 1: Task times;  -1 : infinity;  0 : stop ;  n>0: residual times */
+    uint32_t heap_index; /**< Position in the queue of its priority (internal)*/
     uint8_t prio : 3; /**< Task priority */
 } lv_task_t;
 
+/**
+ * Tasks of one priority, a binary min-heap ordered by the time of their next run.
+ * Tasks which already ran in the current `lv_task_handler()` call are kept behind the heap
+ * until the call ends, so `tasks[0 .. cnt-1]` is the heap and `tasks[cnt .. total-1]` the rest.
+ */
+typedef struct {
+    lv_task_t ** tasks;
+    uint32_t cnt;
+    uint32_t total;
+    uint32_t size;
+} lv_task_heap_t;
+
+typedef lv_task_heap_t lv_task_heap_arr_t[_LV_TASK_PRIO_NUM];
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
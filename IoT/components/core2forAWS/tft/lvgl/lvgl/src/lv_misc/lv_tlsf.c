@@ -0,0 +1,508 @@
+/**
+ * @file lv_tlsf.c
+ * Two-level segregated fit allocator.
+ * The free blocks are kept in lists by size class. The first level splits the sizes by powers of 2,
+ * the second level splits every power of 2 into `SL_INDEX_COUNT` equal ranges. A bitmap per level
+ * tells which lists are not empty, so a suitable block is found with two "find first set" operations.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_tlsf.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT      (1 << SL_INDEX_COUNT_LOG2)
+
+#define ALIGN_SIZE          sizeof(void *)
+#define ALIGN_SIZE_LOG2     (sizeof(void *) == 8 ? 3 : 2)
+
+/*Blocks smaller than this are all in the first first-level list in linear steps of `ALIGN_SIZE`*/
+#define FL_INDEX_SHIFT      (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define SMALL_BLOCK_SIZE    ((size_t)1 << FL_INDEX_SHIFT)
+#define FL_INDEX_COUNT_MAX  32  /*Bits of `fl_bitmap`*/
+
+/*The header of the used blocks. The free list pointers are stored in the data of the free blocks.*/
+#define BLOCK_OVERHEAD      offsetof(lv_tlsf_block_t, next_free)
+#define BLOCK_SIZE_MIN      (sizeof(lv_tlsf_block_t) - BLOCK_OVERHEAD)
+
+#define BLOCK_FREE_BIT      ((size_t)1)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _lv_tlsf_block_t {
+    struct _lv_tlsf_block_t * prev_phys;    /*The previous block in the pool, NULL in the first one*/
+    size_t size;                            /*Size of the data, `BLOCK_FREE_BIT` is set if free*/
+    struct _lv_tlsf_block_t * next_free;    /*Only in free blocks*/
+    struct _lv_tlsf_block_t * prev_free;    /*Only in free blocks*/
+} lv_tlsf_block_t;
+
+struct _lv_tlsf_t {
+    uint32_t fl_bitmap;         /*Bit `fl` is set if `sl_bitmap[fl]` is not 0*/
+    uint32_t fl_cnt;            /*Number of first-level classes needed for the pool*/
+    uint32_t * sl_bitmap;       /*Bit `sl` of `sl_bitmap[fl]` is set if the list `fl, sl` is not empty*/
+    lv_tlsf_block_t ** blocks;  /*Heads of the free lists, `fl_cnt * SL_INDEX_COUNT` entries*/
+    lv_tlsf_block_t * first;    /*The first block of the pool, the last is a zero sized used block*/
+    size_t total_size;
+    size_t used_size;
+    size_t used_max;
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static inline uint32_t bit_ffs(uint32_t word);
+static inline uint32_t bit_fls(size_t word);
+static inline size_t block_size(const lv_tlsf_block_t * block);
+static inline bool block_is_free(const lv_tlsf_block_t * block);
+static inline void * block_to_data(const lv_tlsf_block_t * block);
+static inline lv_tlsf_block_t * data_to_block(const void * data);
+static inline lv_tlsf_block_t * block_next(const lv_tlsf_block_t * block);
+static inline size_t adjust_size(size_t size);
+static void mapping_insert(size_t size, uint32_t * fl, uint32_t * sl);
+static void mapping_search(size_t size, uint32_t * fl, uint32_t * sl);
+static lv_tlsf_block_t * search_suitable_block(lv_tlsf_t * tlsf, uint32_t * fl, uint32_t * sl);
+static void insert_free_block(lv_tlsf_t * tlsf, lv_tlsf_block_t * block);
+static void remove_free_block(lv_tlsf_t * tlsf, lv_tlsf_block_t * block);
+static void trim_used(lv_tlsf_t * tlsf, lv_tlsf_block_t * block, size_t size);
+static lv_tlsf_block_t * merge_next(lv_tlsf_t * tlsf, lv_tlsf_block_t * block);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Create a pool in a memory area
+ * @param mem pointer to the memory area. It's used for the descriptor and the blocks.
+ * @param size size of the memory area in bytes
+ * @return pointer to the pool or NULL if `size` is too small
+ */
+lv_tlsf_t * lv_tlsf_create(void * mem, size_t size)
+{
+    if(mem == NULL) return NULL;
+
+    /*Align the start and the end of the area*/
+    uintptr_t start = ((uintptr_t)mem + ALIGN_SIZE - 1) & ~(uintptr_t)(ALIGN_SIZE - 1);
+    if(size < start - (uintptr_t)mem) return NULL;
+    size = (size - (start - (uintptr_t)mem)) & ~(ALIGN_SIZE - 1);
+
+    /*Only as many first-level classes are needed as the biggest block of the pool requires*/
+    uint32_t fl_cnt = 1;
+    if(size >= SMALL_BLOCK_SIZE) fl_cnt = bit_fls(size) - FL_INDEX_SHIFT + 2;
+    if(fl_cnt > FL_INDEX_COUNT_MAX) fl_cnt = FL_INDEX_COUNT_MAX;
+
+    size_t ctrl_size = sizeof(lv_tlsf_t) + fl_cnt * sizeof(uint32_t) +
+                       fl_cnt * SL_INDEX_COUNT * sizeof(lv_tlsf_block_t *);
+    ctrl_size = (ctrl_size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+
+    /*The descriptor, one free block and the closing zero sized block*/
+    if(size < ctrl_size + BLOCK_OVERHEAD + BLOCK_SIZE_MIN + BLOCK_OVERHEAD) return NULL;
+
+    lv_tlsf_t * tlsf = (lv_tlsf_t *)start;
+    memset(tlsf, 0, ctrl_size);
+    tlsf->fl_cnt = fl_cnt;
+    tlsf->sl_bitmap = (uint32_t *)(start + sizeof(lv_tlsf_t));
+    tlsf->blocks = (lv_tlsf_block_t **)(start + sizeof(lv_tlsf_t) + fl_cnt * sizeof(uint32_t));
+    tlsf->total_size = size - ctrl_size;
+
+    lv_tlsf_block_t * block = (lv_tlsf_block_t *)(start + ctrl_size);
+    block->prev_phys = NULL;
+    block->size = size - ctrl_size - 2 * BLOCK_OVERHEAD;
+    tlsf->first = block;
+
+    lv_tlsf_block_t * sentinel = block_next(block);
+    sentinel->prev_phys = block;
+    sentinel->size = 0;
+
+    insert_free_block(tlsf, block);
+
+    return tlsf;
+}
+
+/**
+ * Allocate from a pool
+ * @param tlsf pointer to a pool
+ * @param size size of the memory to allocate in bytes
+ * @return pointer to the allocated memory, aligned to `sizeof(void *)`, or NULL if there is no big enough free block
+ */
+void * lv_tlsf_alloc(lv_tlsf_t * tlsf, size_t size)
+{
+    if(size == 0 || size > tlsf->total_size) return NULL;
+    size = adjust_size(size);
+
+    uint32_t fl;
+    uint32_t sl;
+    mapping_search(size, &fl, &sl);
+    if(fl >= tlsf->fl_cnt) return NULL;
+
+    lv_tlsf_block_t * block = search_suitable_block(tlsf, &fl, &sl);
+    if(block == NULL) return NULL;
+
+    remove_free_block(tlsf, block);
+    block->size &= ~BLOCK_FREE_BIT;
+    tlsf->used_size += block_size(block) + BLOCK_OVERHEAD;
+
+    /*Give back the rest*/
+    trim_used(tlsf, block, size);
+
+    if(tlsf->used_size > tlsf->used_max) tlsf->used_max = tlsf->used_size;
+
+    return block_to_data(block);
+}
+
+/**
+ * Free an allocation. It's joined with its free neighbors.
+ * @param tlsf pointer to the pool of the allocation
+ * @param data pointer to an allocated memory (NULL is ignored)
+ */
+void lv_tlsf_free(lv_tlsf_t * tlsf, const void * data)
+{
+    if(data == NULL) return;
+
+    lv_tlsf_block_t * block = data_to_block(data);
+    tlsf->used_size -= block_size(block) + BLOCK_OVERHEAD;
+    block->size |= BLOCK_FREE_BIT;
+
+    /*Join with the previous block if it's free*/
+    lv_tlsf_block_t * prev = block->prev_phys;
+    if(prev && block_is_free(prev)) {
+        remove_free_block(tlsf, prev);
+        prev->size += block_size(block) + BLOCK_OVERHEAD;
+        block = prev;
+        block_next(block)->prev_phys = block;
+    }
+
+    block = merge_next(tlsf, block);
+    insert_free_block(tlsf, block);
+}
+
+/**
+ * Change the size of an allocation without moving it.
+ * Shrinking always succeeds, growing succeeds if the next block is free and big enough.
+ * @param tlsf pointer to the pool of the allocation
+ * @param data pointer to an allocated memory
+ * @param size the new size in bytes
+ * @return true: the allocation has the new size; false: it's unchanged and needs to be moved
+ */
+bool lv_tlsf_resize(lv_tlsf_t * tlsf, void * data, size_t size)
+{
+    if(data == NULL || size == 0 || size > tlsf->total_size) return false;
+    size = adjust_size(size);
+
+    lv_tlsf_block_t * block = data_to_block(data);
+    size_t cur = block_size(block);
+    if(size > cur) {
+        lv_tlsf_block_t * next = block_next(block);
+        if(!block_is_free(next) || cur + BLOCK_OVERHEAD + block_size(next) < size) return false;
+
+        /*Take the next block*/
+        remove_free_block(tlsf, next);
+        block->size = cur + BLOCK_OVERHEAD + block_size(next);
+        block_next(block)->prev_phys = block;
+        tlsf->used_size += block_size(block) - cur;
+    }
+
+    trim_used(tlsf, block, size);
+
+    if(tlsf->used_size > tlsf->used_max) tlsf->used_max = tlsf->used_size;
+
+    return true;
+}
+
+/**
+ * Get the usable size of an allocation
+ * @param data pointer to an allocated memory
+ * @return its size in bytes, at least the requested size
+ */
+size_t lv_tlsf_get_size(const void * data)
+{
+    if(data == NULL) return 0;
+    return block_size(data_to_block(data));
+}
+
+/**
+ * Collect the usage and the fragmentation of a pool by walking all of its blocks
+ * @param tlsf pointer to a pool
+ * @param mon_p the result is stored here
+ */
+void lv_tlsf_monitor(const lv_tlsf_t * tlsf, lv_tlsf_monitor_t * mon_p)
+{
+    memset(mon_p, 0, sizeof(lv_tlsf_monitor_t));
+    mon_p->total_size = tlsf->total_size;
+    mon_p->used_size = tlsf->used_size;
+    mon_p->used_max = tlsf->used_max;
+
+    lv_tlsf_block_t * block;
+    for(block = tlsf->first; block_size(block) != 0; block = block_next(block)) {
+        if(block_is_free(block)) {
+            mon_p->free_cnt++;
+            mon_p->free_size += block_size(block);
+            if(block_size(block) > mon_p->free_biggest_size) mon_p->free_biggest_size = block_size(block);
+        }
+        else {
+            mon_p->used_cnt++;
+        }
+    }
+}
+
+/**
+ * Check the consistency of the blocks and the free lists of a pool
+ * @param tlsf pointer to a pool
+ * @return LV_RES_OK: the pool is consistent; LV_RES_INV: it's corrupted
+ */
+lv_res_t lv_tlsf_check(const lv_tlsf_t * tlsf)
+{
+    const uint8_t * end = (const uint8_t *)tlsf->first + tlsf->total_size;
+    uint32_t free_cnt = 0;
+    size_t used_size = 0;
+
+    /*Walk the blocks: each one has to point back to the previous and no free blocks are adjacent*/
+    const lv_tlsf_block_t * prev = NULL;
+    const lv_tlsf_block_t * block = tlsf->first;
+    while(1) {
+        if((const uint8_t *)block + BLOCK_OVERHEAD > end) return LV_RES_INV;
+        if(block->prev_phys != prev) return LV_RES_INV;
+        if(block_size(block) == 0) break;
+        if(block_size(block) < BLOCK_SIZE_MIN || (block_size(block) & (ALIGN_SIZE - 1))) return LV_RES_INV;
+
+        if(block_is_free(block)) {
+            if(prev && block_is_free(prev)) return LV_RES_INV;
+            free_cnt++;
+
+            uint32_t fl;
+            uint32_t sl;
+            mapping_insert(block_size(block), &fl, &sl);
+            if(fl >= tlsf->fl_cnt || (tlsf->sl_bitmap[fl] & (1U << sl)) == 0) return LV_RES_INV;
+        }
+        else {
+            used_size += block_size(block) + BLOCK_OVERHEAD;
+        }
+
+        prev = block;
+        block = block_next(block);
+    }
+    if((const uint8_t *)block + BLOCK_OVERHEAD != end) return LV_RES_INV;
+    if(used_size != tlsf->used_size) return LV_RES_INV;
+
+    /*Every free block has to be in the list of its size class*/
+    uint32_t fl;
+    uint32_t sl;
+    for(fl = 0; fl < tlsf->fl_cnt; fl++) {
+        if(((tlsf->fl_bitmap >> fl) & 1U) != (tlsf->sl_bitmap[fl] != 0)) return LV_RES_INV;
+        for(sl = 0; sl < SL_INDEX_COUNT; sl++) {
+            const lv_tlsf_block_t * b = tlsf->blocks[fl * SL_INDEX_COUNT + sl];
+            if(((tlsf->sl_bitmap[fl] >> sl) & 1U) != (b != NULL)) return LV_RES_INV;
+            for(; b != NULL; b = b->next_free) {
+                uint32_t b_fl;
+                uint32_t b_sl;
+                if(!block_is_free(b)) return LV_RES_INV;
+                mapping_insert(block_size(b), &b_fl, &b_sl);
+                if(b_fl != fl || b_sl != sl) return LV_RES_INV;
+                if(free_cnt == 0) return LV_RES_INV;
+                free_cnt--;
+            }
+        }
+    }
+
+    return free_cnt == 0 ? LV_RES_OK : LV_RES_INV;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Index of the lowest set bit. `word` must not be 0.
+ */
+static inline uint32_t bit_ffs(uint32_t word)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctz(word);
+#else
+    uint32_t bit = 0;
+    while((word & 1U) == 0) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * Index of the highest set bit. `word` must not be 0.
+ */
+static inline uint32_t bit_fls(size_t word)
+{
+#if defined(__GNUC__)
+    if(sizeof(size_t) > sizeof(unsigned long)) return (uint32_t)(63 - __builtin_clzll((unsigned long long)word));
+    return (uint32_t)(sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long)word));
+#else
+    uint32_t bit = 0;
+    while(word >>= 1) bit++;
+    return bit;
+#endif
+}
+
+static inline size_t block_size(const lv_tlsf_block_t * block)
+{
+    return block->size & ~BLOCK_FREE_BIT;
+}
+
+static inline bool block_is_free(const lv_tlsf_block_t * block)
+{
+    return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+static inline void * block_to_data(const lv_tlsf_block_t * block)
+{
+    return (uint8_t *)block + BLOCK_OVERHEAD;
+}
+
+static inline lv_tlsf_block_t * data_to_block(const void * data)
+{
+    return (lv_tlsf_block_t *)((uint8_t *)data - BLOCK_OVERHEAD);
+}
+
+static inline lv_tlsf_block_t * block_next(const lv_tlsf_block_t * block)
+{
+    return (lv_tlsf_block_t *)((uint8_t *)block_to_data(block) + block_size(block));
+}
+
+/**
+ * Round up a requested size to the alignment and to the room needed when the block is free again
+ */
+static inline size_t adjust_size(size_t size)
+{
+    size = (size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+    return size < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : size;
+}
+
+/**
+ * Get the list of a free block by its size
+ */
+static void mapping_insert(size_t size, uint32_t * fl, uint32_t * sl)
+{
+    if(size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (uint32_t)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    }
+    else {
+        uint32_t bit = bit_fls(size);
+        *sl = (uint32_t)(size >> (bit - SL_INDEX_COUNT_LOG2)) ^ (1U << SL_INDEX_COUNT_LOG2);
+        *fl = bit - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+/**
+ * Get the first list whose all blocks are at least `size` large
+ */
+static void mapping_search(size_t size, uint32_t * fl, uint32_t * sl)
+{
+    if(size >= SMALL_BLOCK_SIZE) {
+        size_t round = ((size_t)1 << (bit_fls(size) - SL_INDEX_COUNT_LOG2)) - 1;
+        size += round;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+/**
+ * Find a free block in the list `fl, sl` or in the next non-empty list of bigger blocks
+ */
+static lv_tlsf_block_t * search_suitable_block(lv_tlsf_t * tlsf, uint32_t * fl, uint32_t * sl)
+{
+    uint32_t sl_map = tlsf->sl_bitmap[*fl] & (~0U << *sl);
+    if(sl_map == 0) {
+        /*No block in this first-level class, take the next bigger one*/
+        uint32_t fl_map = *fl + 1 < FL_INDEX_COUNT_MAX ? tlsf->fl_bitmap & (~0U << (*fl + 1)) : 0;
+        if(fl_map == 0) return NULL;
+
+        *fl = bit_ffs(fl_map);
+        sl_map = tlsf->sl_bitmap[*fl];
+    }
+    *sl = bit_ffs(sl_map);
+
+    return tlsf->blocks[*fl * SL_INDEX_COUNT + *sl];
+}
+
+static void insert_free_block(lv_tlsf_t * tlsf, lv_tlsf_block_t * block)
+{
+    uint32_t fl;
+    uint32_t sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    lv_tlsf_block_t ** head = &tlsf->blocks[fl * SL_INDEX_COUNT + sl];
+    block->size |= BLOCK_FREE_BIT;
+    block->prev_free = NULL;
+    block->next_free = *head;
+    if(*head) (*head)->prev_free = block;
+    *head = block;
+
+    tlsf->fl_bitmap |= 1U << fl;
+    tlsf->sl_bitmap[fl] |= 1U << sl;
+}
+
+static void remove_free_block(lv_tlsf_t * tlsf, lv_tlsf_block_t * block)
+{
+    uint32_t fl;
+    uint32_t sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    if(block->prev_free) block->prev_free->next_free = block->next_free;
+    if(block->next_free) block->next_free->prev_free = block->prev_free;
+
+    lv_tlsf_block_t ** head = &tlsf->blocks[fl * SL_INDEX_COUNT + sl];
+    if(*head == block) {
+        *head = block->next_free;
+        if(*head == NULL) {
+            tlsf->sl_bitmap[fl] &= ~(1U << sl);
+            if(tlsf->sl_bitmap[fl] == 0) tlsf->fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+/**
+ * Cut a used block to `size` and free the rest if it's big enough to be a block
+ */
+static void trim_used(lv_tlsf_t * tlsf, lv_tlsf_block_t * block, size_t size)
+{
+    size_t cur = block_size(block);
+    if(cur < size + sizeof(lv_tlsf_block_t)) return;
+
+    block->size = size;
+    lv_tlsf_block_t * rest = block_next(block);
+    rest->prev_phys = block;
+    rest->size = cur - size - BLOCK_OVERHEAD;
+    block_next(rest)->prev_phys = rest;
+    tlsf->used_size -= cur - size;
+
+    rest = merge_next(tlsf, rest);
+    insert_free_block(tlsf, rest);
+}
+
+/**
+ * Join a block with the next block if that is free
+ */
+static lv_tlsf_block_t * merge_next(lv_tlsf_t * tlsf, lv_tlsf_block_t * block)
+{
+    lv_tlsf_block_t * next = block_next(block);
+    if(block_is_free(next)) {
+        remove_free_block(tlsf, next);
+        block->size += block_size(next) + BLOCK_OVERHEAD;
+        block_next(block)->prev_phys = block;
+    }
+    return block;
+}
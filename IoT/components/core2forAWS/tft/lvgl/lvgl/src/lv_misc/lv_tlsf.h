@@ -0,0 +1,116 @@
+/**
+ * @file lv_tlsf.h
+ * Two-level segregated fit allocator working in a given memory pool.
+ * Allocation and free take constant time and the free blocks are joined immediately.
+ */
+
+#ifndef LV_TLSF_H
+#define LV_TLSF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_conf_internal.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "lv_types.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * Descriptor of a pool, stored at the beginning of the pool
+ */
+typedef struct _lv_tlsf_t lv_tlsf_t;
+
+/**
+ * Usage of a pool
+ */
+typedef struct {
+    size_t total_size;          /**< Size of the pool usable for blocks (without the descriptor)*/
+    size_t free_size;           /**< Sum of the free blocks*/
+    size_t free_biggest_size;   /**< Size of the biggest free block*/
+    uint32_t free_cnt;          /**< Number of free blocks*/
+    uint32_t used_cnt;          /**< Number of allocated blocks*/
+    size_t used_size;           /**< Allocated size with the block headers*/
+    size_t used_max;            /**< The highest `used_size` since the creation of the pool*/
+} lv_tlsf_monitor_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a pool in a memory area
+ * @param mem pointer to the memory area. It's used for the descriptor and the blocks.
+ * @param size size of the memory area in bytes
+ * @return pointer to the pool or NULL if `size` is too small
+ */
+lv_tlsf_t * lv_tlsf_create(void * mem, size_t size);
+
+/**
+ * Allocate from a pool
+ * @param tlsf pointer to a pool
+ * @param size size of the memory to allocate in bytes
+ * @return pointer to the allocated memory, aligned to `sizeof(void *)`, or NULL if there is no big enough free block
+ */
+void * lv_tlsf_alloc(lv_tlsf_t * tlsf, size_t size);
+
+/**
+ * Free an allocation. It's joined with its free neighbors.
+ * @param tlsf pointer to the pool of the allocation
+ * @param data pointer to an allocated memory (NULL is ignored)
+ */
+void lv_tlsf_free(lv_tlsf_t * tlsf, const void * data);
+
+/**
+ * Change the size of an allocation without moving it.
+ * Shrinking always succeeds, growing succeeds if the next block is free and big enough.
+ * @param tlsf pointer to the pool of the allocation
+ * @param data pointer to an allocated memory
+ * @param size the new size in bytes
+ * @return true: the allocation has the new size; false: it's unchanged and needs to be moved
+ */
+bool lv_tlsf_resize(lv_tlsf_t * tlsf, void * data, size_t size);
+
+/**
+ * Get the usable size of an allocation
+ * @param data pointer to an allocated memory
+ * @return its size in bytes, at least the requested size
+ */
+size_t lv_tlsf_get_size(const void * data);
+
+/**
+ * Collect the usage and the fragmentation of a pool by walking all of its blocks
+ * @param tlsf pointer to a pool
+ * @param mon_p the result is stored here
+ */
+void lv_tlsf_monitor(const lv_tlsf_t * tlsf, lv_tlsf_monitor_t * mon_p);
+
+/**
+ * Check the consistency of the blocks and the free lists of a pool
+ * @param tlsf pointer to a pool
+ * @return LV_RES_OK: the pool is consistent; LV_RES_INV: it's corrupted
+ */
+lv_res_t lv_tlsf_check(const lv_tlsf_t * tlsf);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_TLSF_H*/
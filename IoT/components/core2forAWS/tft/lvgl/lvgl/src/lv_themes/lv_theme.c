@@ -460,6 +460,11 @@ static void clear_styles(lv_obj_t * obj, lv_theme_style_t name)
             lv_obj_clean_style_list(obj, LV_LINEMETER_PART_MAIN);
             break;
 #endif
+#if LV_USE_LOGVIEW
+        case LV_THEME_LOGVIEW:
+            lv_obj_clean_style_list(obj, LV_LOGVIEW_PART_MAIN);
+            break;
+#endif
 #if LV_USE_GAUGE
         case LV_THEME_GAUGE:
             lv_obj_clean_style_list(obj, LV_GAUGE_PART_MAIN);
@@ -96,6 +96,9 @@ typedef enum {
 #if LV_USE_LINEMETER
     LV_THEME_LINEMETER,
 #endif
+#if LV_USE_LOGVIEW
+    LV_THEME_LOGVIEW,
+#endif
 #if LV_USE_MSGBOX
     LV_THEME_MSGBOX,
     LV_THEME_MSGBOX_BTNS,   /*The button matrix of the buttons are initialized separately*/
@@ -815,6 +815,12 @@ static void theme_apply(lv_theme_t * th, lv_obj_t * obj, lv_theme_style_t name)
             _lv_style_list_add_style(list, &styles->round);
             break;
 #endif
+#if LV_USE_LOGVIEW
+        case LV_THEME_LOGVIEW:
+            list = lv_obj_get_style_list(obj, LV_LOGVIEW_PART_MAIN);
+            _lv_style_list_add_style(list, &styles->bg);
+            break;
+#endif
 #if LV_USE_GAUGE
         case LV_THEME_GAUGE:
             list = lv_obj_get_style_list(obj, LV_GAUGE_PART_MAIN);
@@ -53,11 +53,24 @@ static bool lv_label_set_dot_tmp(lv_obj_t * label, char * data, uint32_t len);
 static char * lv_label_get_dot_tmp(lv_obj_t * label);
 static void lv_label_dot_tmp_free(lv_obj_t * label);
 static void get_txt_coords(const lv_obj_t * label, lv_area_t * area);
+static lv_txt_flag_t get_txt_flag(const lv_obj_t * label);
+static uint32_t get_next_line(const lv_obj_t * label, const char * txt, uint32_t line_start, const lv_font_t * font,
+                              lv_style_int_t letter_space, lv_coord_t max_w, lv_txt_flag_t flag);
+static void get_txt_size(const lv_obj_t * label, lv_point_t * size, const lv_font_t * font, lv_style_int_t letter_space,
+                         lv_style_int_t line_space, lv_coord_t max_w, lv_txt_flag_t flag);
+#if LV_LABEL_LINE_CACHE
+    static const lv_label_line_cache_t * line_cache_get(const lv_obj_t * label, const lv_font_t * font,
+                                                        lv_style_int_t letter_space, lv_coord_t max_w, lv_txt_flag_t flag);
+    static void line_cache_invalidate(lv_obj_t * label);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static lv_signal_cb_t ancestor_signal;
+#if LV_LABEL_LINE_CACHE
+    static lv_label_line_cache_stats_t line_cache_stats;
+#endif
 
 /**********************
  *      MACROS
@@ -119,6 +132,10 @@ lv_obj_t * lv_label_create(lv_obj_t * par, const lv_obj_t * copy)
     ext->dot.tmp_ptr   = NULL;
     ext->dot_tmp_alloc = 0;
 
+#if LV_LABEL_LINE_CACHE
+    _lv_memset_00(&ext->line_cache, sizeof(ext->line_cache));
+#endif
+
     lv_obj_set_design_cb(new_label, lv_label_design);
     lv_obj_set_signal_cb(new_label, lv_label_signal);
 
@@ -548,7 +565,6 @@ void lv_label_get_letter_pos(const lv_obj_t * label, uint32_t char_id, lv_point_
     lv_area_t txt_coords;
     get_txt_coords(label, &txt_coords);
 
-    lv_label_ext_t * ext     = lv_obj_get_ext_attr(label);
     uint32_t line_start      = 0;
     uint32_t new_line_start  = 0;
     lv_coord_t max_w         = lv_area_get_width(&txt_coords);
@@ -557,11 +573,7 @@ void lv_label_get_letter_pos(const lv_obj_t * label, uint32_t char_id, lv_point_
     lv_style_int_t letter_space = lv_obj_get_style_text_letter_space(label, LV_LABEL_PART_MAIN);
     lv_coord_t letter_height    = lv_font_get_line_height(font);
     lv_coord_t y             = 0;
-    lv_txt_flag_t flag       = LV_TXT_FLAG_NONE;
-
-    if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
-    if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
-    if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
+    lv_txt_flag_t flag       = get_txt_flag(label);
 
     if(align == LV_LABEL_ALIGN_CENTER) flag |= LV_TXT_FLAG_CENTER;
     if(align == LV_LABEL_ALIGN_RIGHT) flag |= LV_TXT_FLAG_RIGHT;
@@ -570,7 +582,7 @@ void lv_label_get_letter_pos(const lv_obj_t * label, uint32_t char_id, lv_point_
 
     /*Search the line of the index letter */;
     while(txt[new_line_start] != '\0') {
-        new_line_start += _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+        new_line_start += get_next_line(label, txt, line_start, font, letter_space, max_w, flag);
         if(byte_id < new_line_start || txt[new_line_start] == '\0')
             break; /*The line of 'index' letter begins at 'line_start'*/
 
@@ -654,7 +666,6 @@ uint32_t lv_label_get_letter_on(const lv_obj_t * label, lv_point_t * pos_in)
     lv_area_t txt_coords;
     get_txt_coords(label, &txt_coords);
     const char * txt         = lv_label_get_text(label);
-    lv_label_ext_t * ext     = lv_obj_get_ext_attr(label);
     uint32_t line_start      = 0;
     uint32_t new_line_start  = 0;
     lv_coord_t max_w         = lv_area_get_width(&txt_coords);
@@ -663,21 +674,17 @@ uint32_t lv_label_get_letter_on(const lv_obj_t * label, lv_point_t * pos_in)
     lv_style_int_t letter_space = lv_obj_get_style_text_letter_space(label, LV_LABEL_PART_MAIN);
     lv_coord_t letter_height    = lv_font_get_line_height(font);
     lv_coord_t y             = 0;
-    lv_txt_flag_t flag       = LV_TXT_FLAG_NONE;
+    lv_txt_flag_t flag       = get_txt_flag(label);
     uint32_t logical_pos;
     char * bidi_txt;
 
-    if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
-    if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
-    if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
-
     lv_label_align_t align = lv_label_get_align(label);
     if(align == LV_LABEL_ALIGN_CENTER) flag |= LV_TXT_FLAG_CENTER;
     if(align == LV_LABEL_ALIGN_RIGHT) flag |= LV_TXT_FLAG_RIGHT;
 
     /*Search the line of the index letter */;
     while(txt[line_start] != '\0') {
-        new_line_start += _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+        new_line_start += get_next_line(label, txt, line_start, font, letter_space, max_w, flag);
 
         if(pos.y <= y + letter_height) {
             /*The line is found (stored in 'line_start')*/
@@ -819,7 +826,6 @@ bool lv_label_is_char_under_pos(const lv_obj_t * label, lv_point_t * pos)
     lv_area_t txt_coords;
     get_txt_coords(label, &txt_coords);
     const char * txt         = lv_label_get_text(label);
-    lv_label_ext_t * ext     = lv_obj_get_ext_attr(label);
     uint32_t line_start      = 0;
     uint32_t new_line_start  = 0;
     lv_coord_t max_w         = lv_area_get_width(&txt_coords);
@@ -828,17 +834,14 @@ bool lv_label_is_char_under_pos(const lv_obj_t * label, lv_point_t * pos)
     lv_style_int_t letter_space = lv_obj_get_style_text_letter_space(label, LV_LABEL_PART_MAIN);
     lv_coord_t letter_height    = lv_font_get_line_height(font);
     lv_coord_t y             = 0;
-    lv_txt_flag_t flag       = LV_TXT_FLAG_NONE;
+    lv_txt_flag_t flag       = get_txt_flag(label);
     lv_label_align_t align = lv_label_get_align(label);
 
-    if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
-    if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
-    if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
     if(align == LV_LABEL_ALIGN_CENTER) flag |= LV_TXT_FLAG_CENTER;
 
     /*Search the line of the index letter */;
     while(txt[line_start] != '\0') {
-        new_line_start += _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+        new_line_start += get_next_line(label, txt, line_start, font, letter_space, max_w, flag);
 
         if(pos->y <= y + letter_height) break; /*The line is found (stored in 'line_start')*/
         y += letter_height + line_space;
@@ -897,6 +900,19 @@ bool lv_label_is_char_under_pos(const lv_obj_t * label, lv_point_t * pos)
     return (pos->x >= (last_x - letter_space) && pos->x <= (last_x + max_diff));
 }
 
+/**
+ * Get the counters of the labels' line caches. All 0 if `LV_LABEL_LINE_CACHE` is 0.
+ * @param stats store the counters here
+ */
+void lv_label_line_cache_get_stats(lv_label_line_cache_stats_t * stats)
+{
+#if LV_LABEL_LINE_CACHE
+    *stats = line_cache_stats;
+#else
+    _lv_memset_00(stats, sizeof(lv_label_line_cache_stats_t));
+#endif
+}
+
 lv_style_list_t * lv_label_get_style(lv_obj_t * label, uint8_t type)
 {
     lv_style_list_t * style_dsc_p;
@@ -998,6 +1014,9 @@ void lv_label_refr_text(lv_obj_t * label)
 #if LV_LABEL_LONG_TXT_HINT
     ext->hint.line_start = -1; /*The hint is invalid if the text changes*/
 #endif
+#if LV_LABEL_LINE_CACHE
+    line_cache_invalidate(label);
+#endif
 
     lv_area_t txt_coords;
     get_txt_coords(label, &txt_coords);
@@ -1008,11 +1027,8 @@ void lv_label_refr_text(lv_obj_t * label)
 
     /*Calc. the height and longest line*/
     lv_point_t size;
-    lv_txt_flag_t flag = LV_TXT_FLAG_NONE;
-    if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
-    if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
-    if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
-    _lv_txt_get_size(&size, ext->text, font, letter_space, line_space, max_w, flag);
+    lv_txt_flag_t flag = get_txt_flag(label);
+    get_txt_size(label, &size, font, letter_space, line_space, max_w, flag);
 
     /*Set the full size in expand mode*/
     if(ext->long_mode == LV_LABEL_LONG_EXPAND) {
@@ -1243,6 +1259,9 @@ void lv_label_refr_text(lv_obj_t * label)
                 }
                 ext->text[byte_id_ori + LV_LABEL_DOT_NUM] = '\0';
                 ext->dot_end                              = letter_id + LV_LABEL_DOT_NUM;
+#if LV_LABEL_LINE_CACHE
+                line_cache_invalidate(label);
+#endif
             }
         }
     }
@@ -1305,10 +1324,7 @@ static lv_design_res_t lv_label_design(lv_obj_t * label, const lv_area_t * clip_
 
         lv_label_align_t align = lv_label_get_align(label);
 
-        lv_txt_flag_t flag = LV_TXT_FLAG_NONE;
-        if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
-        if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
-        if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
+        lv_txt_flag_t flag = get_txt_flag(label);
         if(align == LV_LABEL_ALIGN_CENTER) flag |= LV_TXT_FLAG_CENTER;
         if(align == LV_LABEL_ALIGN_RIGHT) flag |= LV_TXT_FLAG_RIGHT;
 
@@ -1322,13 +1338,19 @@ static lv_design_res_t lv_label_design(lv_obj_t * label, const lv_area_t * clip_
         label_draw_dsc.flag = flag;
         lv_obj_init_draw_label_dsc(label, LV_LABEL_PART_MAIN, &label_draw_dsc);
 
+#if LV_LABEL_LINE_CACHE
+        const lv_label_line_cache_t * line_cache = line_cache_get(label, label_draw_dsc.font, label_draw_dsc.letter_space,
+                                                                  lv_area_get_width(&txt_coords), flag);
+        if(line_cache) label_draw_dsc.lines = &line_cache->lines;
+#endif
+
         /* In SROLL and SROLL_CIRC mode the CENTER and RIGHT are pointless so remove them.
          * (In addition they will result misalignment is this case)*/
         if((ext->long_mode == LV_LABEL_LONG_SROLL || ext->long_mode == LV_LABEL_LONG_SROLL_CIRC) &&
            (ext->align == LV_LABEL_ALIGN_CENTER || ext->align == LV_LABEL_ALIGN_RIGHT)) {
             lv_point_t size;
-            _lv_txt_get_size(&size, ext->text, label_draw_dsc.font, label_draw_dsc.letter_space, label_draw_dsc.line_space,
-                             LV_COORD_MAX, flag);
+            get_txt_size(label, &size, label_draw_dsc.font, label_draw_dsc.letter_space, label_draw_dsc.line_space,
+                         LV_COORD_MAX, flag);
             if(size.x > lv_area_get_width(&txt_coords)) {
                 label_draw_dsc.flag &= ~LV_TXT_FLAG_RIGHT;
                 label_draw_dsc.flag &= ~LV_TXT_FLAG_CENTER;
@@ -1348,8 +1370,8 @@ static lv_design_res_t lv_label_design(lv_obj_t * label, const lv_area_t * clip_
 
         if(ext->long_mode == LV_LABEL_LONG_SROLL_CIRC) {
             lv_point_t size;
-            _lv_txt_get_size(&size, ext->text, label_draw_dsc.font, label_draw_dsc.letter_space, label_draw_dsc.line_space,
-                             LV_COORD_MAX, flag);
+            get_txt_size(label, &size, label_draw_dsc.font, label_draw_dsc.letter_space, label_draw_dsc.line_space,
+                         LV_COORD_MAX, flag);
 
             /*Draw the text again next to the original to make an circular effect */
             if(size.x > lv_area_get_width(&txt_coords)) {
@@ -1403,6 +1425,10 @@ static lv_res_t lv_label_signal(lv_obj_t * label, lv_signal_t sign, void * param
             ext->text = NULL;
         }
         lv_label_dot_tmp_free(label);
+#if LV_LABEL_LINE_CACHE
+        lv_mem_free(ext->line_cache.buf);
+        ext->line_cache.buf = NULL;
+#endif
     }
     else if(sign == LV_SIGNAL_STYLE_CHG) {
         /*Revert dots for proper refresh*/
@@ -1444,6 +1470,9 @@ static void lv_label_revert_dots(lv_obj_t * label)
     lv_label_dot_tmp_free(label);
 
     ext->dot_end = LV_LABEL_DOT_END_INV;
+#if LV_LABEL_LINE_CACHE
+    line_cache_invalidate(label);
+#endif
 }
 
 #if LV_USE_ANIMATION
@@ -1538,4 +1567,176 @@ static void get_txt_coords(const lv_obj_t * label, lv_area_t * area)
     area->y2 -= bottom;
 }
 
+/**
+ * Get the text flags which change the line breaks of the label's text
+ * @param label pointer to a label object
+ * @return `LV_TXT_FLAG_RECOLOR`, `LV_TXT_FLAG_EXPAND` and `LV_TXT_FLAG_FIT` as set for the label
+ */
+static lv_txt_flag_t get_txt_flag(const lv_obj_t * label)
+{
+    lv_label_ext_t * ext = lv_obj_get_ext_attr(label);
+    lv_txt_flag_t flag = LV_TXT_FLAG_NONE;
+    if(ext->recolor != 0) flag |= LV_TXT_FLAG_RECOLOR;
+    if(ext->expand != 0) flag |= LV_TXT_FLAG_EXPAND;
+    if(ext->long_mode == LV_LABEL_LONG_EXPAND) flag |= LV_TXT_FLAG_FIT;
+    return flag;
+}
+
+/**
+ * Get the length of a line of the label's text. Use the cached line breaks if possible.
+ * @param label pointer to a label object
+ * @param txt the text of the label
+ * @param line_start byte index of the line's first character
+ * @param font font of the text
+ * @param letter_space letter space of the text
+ * @param max_w max. width of a line
+ * @param flag settings for the text from 'txt_flag_t' enum
+ * @return length of the line in bytes
+ */
+static uint32_t get_next_line(const lv_obj_t * label, const char * txt, uint32_t line_start, const lv_font_t * font,
+                              lv_style_int_t letter_space, lv_coord_t max_w, lv_txt_flag_t flag)
+{
+#if LV_LABEL_LINE_CACHE
+    const lv_label_line_cache_t * cache = line_cache_get(label, font, letter_space, max_w, flag);
+    if(cache && txt == lv_label_get_text(label)) {
+        /*Binary search the line starting at `line_start`*/
+        const lv_draw_label_line_t * line = cache->lines.line;
+        uint32_t min = 0;
+        uint32_t max = cache->lines.cnt;
+        while(min < max) {
+            uint32_t mid = (min + max) / 2;
+            if(line[mid].start < line_start) min = mid + 1;
+            else max = mid;
+        }
+
+        if(min < cache->lines.cnt && line[min].start == line_start) return line[min + 1].start - line_start;
+    }
+#else
+    LV_UNUSED(label);
+#endif
+
+    return _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+}
+
+/**
+ * Get the size of the label's text like `_lv_txt_get_size` does. Use the cached line breaks if possible.
+ * @param label pointer to a label object
+ * @param size store the result here
+ * @param font font of the text
+ * @param letter_space letter space of the text
+ * @param line_space line space of the text
+ * @param max_w max. width of a line
+ * @param flag settings for the text from 'txt_flag_t' enum
+ */
+static void get_txt_size(const lv_obj_t * label, lv_point_t * size, const lv_font_t * font, lv_style_int_t letter_space,
+                         lv_style_int_t line_space, lv_coord_t max_w, lv_txt_flag_t flag)
+{
+    const char * txt = lv_label_get_text(label);
+
+#if LV_LABEL_LINE_CACHE
+    const lv_label_line_cache_t * cache = line_cache_get(label, font, letter_space, max_w, flag);
+    if(cache) {
+        int32_t letter_height = lv_font_get_line_height(font);
+        int32_t line_cnt = cache->lines.cnt;
+        int32_t y = line_cnt * (letter_height + line_space);
+
+        /*`_lv_txt_get_size` gives up if the height overflows, let it do so*/
+        if(y <= (int32_t)LV_MAX_OF(lv_coord_t)) {
+            /*Make the text one line taller if the last character is '\n' or '\r'*/
+            uint32_t len = cache->lines.line[line_cnt].start;
+            if(len != 0 && (txt[len - 1] == '\n' || txt[len - 1] == '\r')) y += letter_height + line_space;
+
+            size->x = cache->longest;
+            size->y = y == 0 ? letter_height : y - line_space;
+            return;
+        }
+    }
+#else
+    LV_UNUSED(label);
+#endif
+
+    _lv_txt_get_size(size, txt, font, letter_space, line_space, max_w, flag);
+}
+
+#if LV_LABEL_LINE_CACHE
+/**
+ * Get the line breaks of the label's text. Break the text again if it was broken with other parameters.
+ * @param label pointer to a label object
+ * @param font font of the text
+ * @param letter_space letter space of the text
+ * @param max_w max. width of a line
+ * @param flag settings for the text from 'txt_flag_t' enum
+ * @return the line cache or NULL if there is no text or not enough memory
+ */
+static const lv_label_line_cache_t * line_cache_get(const lv_obj_t * label, const lv_font_t * font,
+                                                    lv_style_int_t letter_space, lv_coord_t max_w, lv_txt_flag_t flag)
+{
+    lv_label_ext_t * ext = lv_obj_get_ext_attr(label);
+    lv_label_line_cache_t * cache = &ext->line_cache;
+    const char * txt = ext->text;
+    if(txt == NULL || font == NULL) return NULL;
+
+    /*The alignment doesn't change the line breaks and the width doesn't matter if only '\n' breaks the lines.
+     *Take the label's own flags too so every caller builds the same key.*/
+    flag = (flag | get_txt_flag(label)) & (LV_TXT_FLAG_RECOLOR | LV_TXT_FLAG_EXPAND | LV_TXT_FLAG_FIT);
+    if(flag & (LV_TXT_FLAG_EXPAND | LV_TXT_FLAG_FIT)) max_w = LV_COORD_MAX;
+
+    if(cache->valid && cache->font == font && cache->letter_space == letter_space &&
+       cache->max_w == max_w && cache->flag == flag) {
+        line_cache_stats.hit++;
+        return cache;
+    }
+
+    cache->valid = 0;
+    line_cache_stats.miss++;
+
+    uint32_t line_cnt = 0;
+    uint32_t line_start = 0;
+    lv_coord_t longest = 0;
+    while(1) {
+        /*Keep place for the line after the last to store the end of the text*/
+        if(line_cnt >= cache->alloc) {
+            uint32_t alloc = cache->alloc ? cache->alloc * 2 : 2;
+            lv_draw_label_line_t * buf = lv_mem_realloc(cache->buf, alloc * sizeof(lv_draw_label_line_t));
+            if(buf == NULL) return NULL;
+            cache->buf = buf;
+            cache->alloc = alloc;
+        }
+
+        cache->buf[line_cnt].start = line_start;
+        cache->buf[line_cnt].w = 0;
+        if(txt[line_start] == '\0') break;
+
+        uint32_t len = _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+        lv_coord_t w = _lv_txt_get_width(&txt[line_start], len, font, letter_space, flag);
+        cache->buf[line_cnt].w = w;
+        longest = LV_MATH_MAX(longest, w);
+
+        line_start += len;
+        line_cnt++;
+    }
+
+    cache->lines.line = cache->buf;
+    cache->lines.cnt = line_cnt;
+    cache->longest = longest;
+    cache->font = font;
+    cache->letter_space = letter_space;
+    cache->max_w = max_w;
+    cache->flag = flag;
+    cache->valid = 1;
+
+    return cache;
+}
+
+/**
+ * Drop the line breaks of the label's text, e.g. because the text has changed
+ * @param label pointer to a label object
+ */
+static void line_cache_invalidate(lv_obj_t * label)
+{
+    lv_label_ext_t * ext = lv_obj_get_ext_attr(label);
+    ext->line_cache.valid = 0;
+}
+#endif
+
 #endif
@@ -60,6 +60,27 @@ enum {
 };
 typedef uint8_t lv_label_align_t;
 
+#if LV_LABEL_LINE_CACHE
+/** Line breaks of the text, valid for the font, max. width, letter space and flags they were made with*/
+typedef struct {
+    lv_draw_label_lines_t lines;
+    lv_draw_label_line_t * buf;     /*The lines, `alloc` elements*/
+    uint32_t alloc;
+    const lv_font_t * font;
+    lv_coord_t max_w;
+    lv_coord_t longest;             /*Width of the longest line*/
+    lv_style_int_t letter_space;
+    lv_txt_flag_t flag;
+    uint8_t valid : 1;
+} lv_label_line_cache_t;
+#endif
+
+/** Counters of the labels' line caches*/
+typedef struct {
+    uint32_t hit;           /**< Line breaks found in the cache*/
+    uint32_t miss;          /**< Texts broken into lines again*/
+} lv_label_line_cache_stats_t;
+
 /** Data of label*/
 typedef struct {
     /*Inherited from 'base_obj' so no inherited ext.*/ /*Ext. of ancestor*/
@@ -89,6 +110,10 @@ typedef struct {
     uint32_t sel_end;
 #endif
 
+#if LV_LABEL_LINE_CACHE
+    lv_label_line_cache_t line_cache; /*Line breaks of the text (Handled by the library)*/
+#endif
+
     lv_label_long_mode_t long_mode : 3; /*Determinate what to do with the long texts*/
     uint8_t static_txt : 1;             /*Flag to indicate the text is static*/
     uint8_t align : 2;                  /*Align type from 'lv_label_align_t'*/
@@ -265,6 +290,12 @@ uint32_t lv_label_get_text_sel_start(const lv_obj_t * label);
  */
 uint32_t lv_label_get_text_sel_end(const lv_obj_t * label);
 
+/**
+ * Get the counters of the labels' line caches. All 0 if `LV_LABEL_LINE_CACHE` is 0.
+ * @param stats store the counters here
+ */
+void lv_label_line_cache_get_stats(lv_label_line_cache_stats_t * stats);
+
 lv_style_list_t * lv_label_get_style(lv_obj_t * label, uint8_t type);
 
 /*=====================
@@ -0,0 +1,522 @@
+/**
+ * @file lv_logview.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_logview.h"
+#if LV_USE_LOGVIEW != 0
+
+#include "../lv_misc/lv_debug.h"
+#include "../lv_core/lv_indev.h"
+#include "../lv_themes/lv_theme.h"
+#include "../lv_draw/lv_draw.h"
+#include "../lv_misc/lv_txt.h"
+#include "../lv_misc/lv_math.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define LV_OBJX_NAME "lv_logview"
+
+#define LV_LOGVIEW_WIDTH_DEF (LV_DPI * 2)
+#define LV_LOGVIEW_HEIGHT_DEF (LV_DPI)
+
+#define LV_LOGVIEW_LINE_CNT_MIN 2
+#define LV_LOGVIEW_LINE_LEN_MIN 4   /*The longest UTF-8 character has to fit*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_design_res_t lv_logview_design(lv_obj_t * logview, const lv_area_t * clip_area, lv_design_mode_t mode);
+static lv_res_t lv_logview_signal(lv_obj_t * logview, lv_signal_t sign, void * param);
+static char * get_line(const lv_logview_ext_t * ext, uint16_t id);
+static char * push_line(lv_logview_ext_t * ext);
+static lv_coord_t get_row_height(const lv_obj_t * logview);
+static uint16_t get_row_cnt(const lv_obj_t * logview);
+static void invalidate_rows(lv_obj_t * logview, uint16_t row_first, uint16_t row_last);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_design_cb_t ancestor_design;
+static lv_signal_cb_t ancestor_signal;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Create a log view objects
+ * @param par pointer to an object, it will be the parent of the new log view
+ * @param copy pointer to a log view object, if not NULL then the new object will be copied from it
+ * @return pointer to the created log view
+ */
+lv_obj_t * lv_logview_create(lv_obj_t * par, const lv_obj_t * copy)
+{
+    LV_LOG_TRACE("log view create started");
+
+    /*Create the ancestor basic object*/
+    lv_obj_t * logview = lv_obj_create(par, copy);
+    LV_ASSERT_MEM(logview);
+    if(logview == NULL) return NULL;
+
+    if(ancestor_signal == NULL) ancestor_signal = lv_obj_get_signal_cb(logview);
+    if(ancestor_design == NULL) ancestor_design = lv_obj_get_design_cb(logview);
+
+    /*Allocate the object type specific extended data*/
+    lv_logview_ext_t * ext = lv_obj_allocate_ext_attr(logview, sizeof(lv_logview_ext_t));
+    LV_ASSERT_MEM(ext);
+    if(ext == NULL) {
+        lv_obj_del(logview);
+        return NULL;
+    }
+
+    _lv_memset_00(ext, sizeof(lv_logview_ext_t));
+
+    lv_obj_set_signal_cb(logview, lv_logview_signal);
+    lv_obj_set_design_cb(logview, lv_logview_design);
+
+    /*Init the new log view object*/
+    if(copy == NULL) {
+        lv_logview_set_buffer(logview, LV_LOGVIEW_DEF_LINE_CNT, LV_LOGVIEW_DEF_LINE_LEN);
+        lv_obj_set_size(logview, LV_LOGVIEW_WIDTH_DEF, LV_LOGVIEW_HEIGHT_DEF);
+
+        lv_theme_apply(logview, LV_THEME_LOGVIEW);
+    }
+    /*Copy an existing object*/
+    else {
+        lv_logview_ext_t * copy_ext = lv_obj_get_ext_attr(copy);
+        lv_logview_set_buffer(logview, copy_ext->line_max, copy_ext->line_len);
+        if(ext->buf && copy_ext->buf) {
+            _lv_memcpy(ext->buf, copy_ext->buf, (uint32_t)ext->line_max * (ext->line_len + 1));
+            ext->first = copy_ext->first;
+            ext->cnt = copy_ext->cnt;
+            ext->scroll = copy_ext->scroll;
+            ext->open = copy_ext->open;
+        }
+
+        /*Refresh the style with new signal function*/
+        lv_obj_refresh_style(logview, LV_OBJ_PART_ALL, LV_STYLE_PROP_ALL);
+    }
+
+    LV_LOG_INFO("log view created");
+
+    return logview;
+}
+
+/*=====================
+ * Setter functions
+ *====================*/
+
+/**
+ * Set the number of lines a log view keeps and their max. length. The stored lines are cleared.
+ * @param logview pointer to a log view object
+ * @param line_cnt number of lines to keep (min. 2), the oldest line is dropped if a new one doesn't fit
+ * @param line_len max. length of a line in bytes (min. 4), longer lines are broken
+ */
+void lv_logview_set_buffer(lv_obj_t * logview, uint16_t line_cnt, uint16_t line_len)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+
+    if(line_cnt < LV_LOGVIEW_LINE_CNT_MIN) line_cnt = LV_LOGVIEW_LINE_CNT_MIN;
+    if(line_len < LV_LOGVIEW_LINE_LEN_MIN) line_len = LV_LOGVIEW_LINE_LEN_MIN;
+
+    char * buf = lv_mem_alloc((uint32_t)line_cnt * (line_len + 1));
+    LV_ASSERT_MEM(buf);
+    if(buf == NULL) return;
+
+    if(ext->buf) lv_mem_free(ext->buf);
+    ext->buf = buf;
+    ext->line_max = line_cnt;
+    ext->line_len = line_len;
+
+    lv_logview_clear(logview);
+}
+
+/**
+ * Append text to a log view. The text continues the last line until a '\n'.
+ * Lines wider than the log view are wrapped when they are added.
+ * @param logview pointer to a log view object
+ * @param txt a '\0' terminated string to append
+ */
+void lv_logview_add_text(lv_obj_t * logview, const char * txt)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+    LV_ASSERT_STR(txt);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+    if(ext->buf == NULL || txt[0] == '\0') return;
+
+    const lv_font_t * font = lv_obj_get_style_text_font(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t letter_space = lv_obj_get_style_text_letter_space(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t max_w = lv_obj_get_width_fit(logview);
+    uint16_t rows = get_row_cnt(logview);
+
+    /*Remember what is visible now to redraw only the changed rows*/
+    uint16_t cnt_prev = ext->cnt;
+    uint16_t first_changed = ext->open ? ext->cnt - 1 : ext->cnt;
+    bool dropped = false;
+
+    while(*txt != '\0') {
+        char * line;
+        if(ext->open) {
+            line = get_line(ext, ext->cnt - 1);
+        }
+        else {
+            if(ext->cnt == ext->line_max) dropped = true;
+            line = push_line(ext);
+            ext->open = 1;
+        }
+
+        /*Copy whole characters until the end of the line or until the slot is full*/
+        uint32_t len = strlen(line);
+        while(*txt != '\0' && *txt != '\n') {
+            uint32_t size = _lv_txt_encoded_size(txt);
+            if(size == 0) size = 1;
+            if(len + size > ext->line_len) break;
+
+            /*A character cut at the end of `txt` is continued by the next call*/
+            uint32_t i;
+            for(i = 0; i < size && txt[0] != '\0'; i++) {
+                line[len] = txt[0];
+                len++;
+                txt++;
+            }
+        }
+        line[len] = '\0';
+
+        /*Move the words which don't fit to the width into new lines*/
+        while(1) {
+            uint32_t brk = _lv_txt_get_next_line(line, font, letter_space, max_w, LV_TXT_FLAG_NONE);
+            if(brk == 0 || brk >= len) break;
+
+            if(ext->cnt == ext->line_max) dropped = true;
+            char * next = push_line(ext);
+            len -= brk;
+            _lv_memcpy(next, &line[brk], len + 1);
+            line[brk] = '\0';
+            line = next;
+        }
+
+        if(*txt == '\n') {
+            ext->open = 0;
+            txt++;
+        }
+        /*The slot is still full after wrapping: break the line here*/
+        else if(*txt != '\0') {
+            uint32_t size = _lv_txt_encoded_size(txt);
+            if(len + LV_MATH_MAX(size, 1) > ext->line_len) ext->open = 0;
+        }
+    }
+
+    /*The oldest lines might be dropped while scrolled back to them*/
+    uint16_t scroll_max = ext->cnt > rows ? ext->cnt - rows : 0;
+    if(ext->scroll > scroll_max) ext->scroll = scroll_max;
+
+    /*The newest lines are shown at the bottom so the rows move if the view was or became full*/
+    uint16_t top_prev = cnt_prev > rows ? cnt_prev - rows : 0;
+    uint16_t top = ext->cnt > rows ? ext->cnt - rows : 0;
+    if(ext->scroll != 0 || dropped || top != top_prev) {
+        lv_obj_invalidate(logview);
+    }
+    else {
+        invalidate_rows(logview, first_changed - top, ext->cnt - 1 - top);
+    }
+}
+
+/**
+ * Remove all lines of a log view
+ * @param logview pointer to a log view object
+ */
+void lv_logview_clear(lv_obj_t * logview)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+    ext->first = 0;
+    ext->cnt = 0;
+    ext->scroll = 0;
+    ext->drag_sum = 0;
+    ext->open = 0;
+
+    lv_obj_invalidate(logview);
+}
+
+/**
+ * Scroll back a log view
+ * @param logview pointer to a log view object
+ * @param line_ofs number of lines to scroll back from the newest line. 0: show the newest lines
+ */
+void lv_logview_set_scroll(lv_obj_t * logview, uint16_t line_ofs)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+
+    uint16_t rows = get_row_cnt(logview);
+    uint16_t max = ext->cnt > rows ? ext->cnt - rows : 0;
+    if(line_ofs > max) line_ofs = max;
+    if(ext->scroll == line_ofs) return;
+
+    ext->scroll = line_ofs;
+    lv_obj_invalidate(logview);
+}
+
+/*=====================
+ * Getter functions
+ *====================*/
+
+/**
+ * Get the number of lines stored in a log view
+ * @param logview pointer to a log view object
+ * @return number of lines
+ */
+uint16_t lv_logview_get_line_count(const lv_obj_t * logview)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+    return ext->cnt;
+}
+
+/**
+ * Get a stored line of a log view
+ * @param logview pointer to a log view object
+ * @param id index of the line, 0: the oldest line
+ * @return the text of the line or NULL if `id` is out of range
+ */
+const char * lv_logview_get_line(const lv_obj_t * logview, uint16_t id)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+    if(id >= ext->cnt) return NULL;
+
+    return get_line(ext, id);
+}
+
+/**
+ * Get how many lines a log view is scrolled back
+ * @param logview pointer to a log view object
+ * @return number of lines scrolled back from the newest line
+ */
+uint16_t lv_logview_get_scroll(const lv_obj_t * logview)
+{
+    LV_ASSERT_OBJ(logview, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+    return ext->scroll;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Handle the drawing related tasks of the log views
+ * @param logview pointer to an object
+ * @param clip_area the object will be drawn only in this area
+ * @param mode LV_DESIGN_COVER_CHK: only check if the object fully covers the 'mask_p' area
+ *                                  (return 'true' if yes)
+ *             LV_DESIGN_DRAW: draw the object (always return 'true')
+ *             LV_DESIGN_DRAW_POST: drawing after every children are drawn
+ * @param return an element of `lv_design_res_t`
+ */
+static lv_design_res_t lv_logview_design(lv_obj_t * logview, const lv_area_t * clip_area, lv_design_mode_t mode)
+{
+    if(mode == LV_DESIGN_COVER_CHK) {
+        /*Return false if the object is not covers the clip_area area*/
+        return ancestor_design(logview, clip_area, mode);
+    }
+    else if(mode == LV_DESIGN_DRAW_MAIN) {
+        /*Draw the background*/
+        ancestor_design(logview, clip_area, mode);
+
+        lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+        if(ext->cnt == 0) return LV_DESIGN_RES_OK;
+
+        lv_area_t content;
+        content.x1 = logview->coords.x1 + lv_obj_get_style_pad_left(logview, LV_LOGVIEW_PART_MAIN);
+        content.x2 = logview->coords.x2 - lv_obj_get_style_pad_right(logview, LV_LOGVIEW_PART_MAIN);
+        content.y1 = logview->coords.y1 + lv_obj_get_style_pad_top(logview, LV_LOGVIEW_PART_MAIN);
+        content.y2 = logview->coords.y2 - lv_obj_get_style_pad_bottom(logview, LV_LOGVIEW_PART_MAIN);
+
+        lv_area_t txt_clip;
+        if(_lv_area_intersect(&txt_clip, clip_area, &content) == false) return LV_DESIGN_RES_OK;
+
+        lv_draw_label_dsc_t label_dsc;
+        lv_draw_label_dsc_init(&label_dsc);
+        lv_obj_init_draw_label_dsc(logview, LV_LOGVIEW_PART_MAIN, &label_dsc);
+
+        /*Only the lines of the visible rows are drawn, the newest one in the last row*/
+        lv_coord_t font_h = lv_font_get_line_height(label_dsc.font);
+        lv_coord_t row_h = get_row_height(logview);
+        uint16_t rows = get_row_cnt(logview);
+        uint16_t last = ext->cnt - 1 - ext->scroll;
+        uint16_t shown = LV_MATH_MIN(rows, last + 1);
+        uint16_t first = last + 1 - shown;
+
+        uint16_t i = 0;
+        if(txt_clip.y1 > content.y1) i = (txt_clip.y1 - content.y1) / row_h;
+
+        lv_area_t row_area;
+        row_area.x1 = content.x1;
+        row_area.x2 = content.x2;
+        for(; i < shown; i++) {
+            row_area.y1 = content.y1 + i * row_h;
+            row_area.y2 = row_area.y1 + font_h - 1;
+            if(row_area.y1 > txt_clip.y2) break;
+
+            /*Don't let a line wider than the view (e.g. after a resize) overflow into the next row*/
+            lv_area_t row_clip;
+            if(_lv_area_intersect(&row_clip, &txt_clip, &row_area) == false) continue;
+
+            lv_draw_label(&row_area, &row_clip, &label_dsc, get_line(ext, first + i), NULL);
+        }
+    }
+    else if(mode == LV_DESIGN_DRAW_POST) {
+        ancestor_design(logview, clip_area, mode);
+    }
+    return LV_DESIGN_RES_OK;
+}
+
+/**
+ * Signal function of the log view
+ * @param logview pointer to a log view object
+ * @param sign a signal type from lv_signal_t enum
+ * @param param pointer to a signal specific variable
+ * @return LV_RES_OK: the object is not deleted in the function; LV_RES_INV: the object is deleted
+ */
+static lv_res_t lv_logview_signal(lv_obj_t * logview, lv_signal_t sign, void * param)
+{
+    lv_res_t res;
+
+    /* Include the ancient signal function */
+    res = ancestor_signal(logview, sign, param);
+    if(res != LV_RES_OK) return res;
+
+    if(sign == LV_SIGNAL_GET_TYPE) return lv_obj_handle_get_type_signal(param, LV_OBJX_NAME);
+
+    lv_logview_ext_t * ext = lv_obj_get_ext_attr(logview);
+
+    if(sign == LV_SIGNAL_CLEANUP) {
+        lv_mem_free(ext->buf);
+        ext->buf = NULL;
+    }
+    else if(sign == LV_SIGNAL_PRESSED) {
+        ext->drag_sum = 0;
+    }
+    else if(sign == LV_SIGNAL_PRESSING) {
+        /*Dragging down reveals the older lines*/
+        lv_indev_t * indev = lv_indev_get_act();
+        if(indev == NULL) return res;
+
+        lv_point_t vect;
+        lv_indev_get_vect(indev, &vect);
+        ext->drag_sum += vect.y;
+
+        lv_coord_t row_h = get_row_height(logview);
+        int32_t steps = ext->drag_sum / row_h;
+        if(steps != 0) {
+            ext->drag_sum -= steps * row_h;
+            int32_t scroll = (int32_t)ext->scroll + steps;
+            lv_logview_set_scroll(logview, scroll < 0 ? 0 : (uint16_t)LV_MATH_MIN(scroll, UINT16_MAX));
+        }
+    }
+
+    return res;
+}
+
+/**
+ * Get a stored line from the ring
+ * @param ext pointer to the ext. data of a log view
+ * @param id index of the line, 0: the oldest line
+ * @return pointer to the slot of the line
+ */
+static char * get_line(const lv_logview_ext_t * ext, uint16_t id)
+{
+    uint32_t slot = ((uint32_t)ext->first + id) % ext->line_max;
+    return &ext->buf[slot * (ext->line_len + 1)];
+}
+
+/**
+ * Add a new empty line to the ring. The oldest line is dropped if the ring is full.
+ * The view stays on the same lines if it's scrolled back, the caller limits the scroll.
+ * @param ext pointer to the ext. data of a log view
+ * @return pointer to the slot of the new line
+ */
+static char * push_line(lv_logview_ext_t * ext)
+{
+    if(ext->cnt == ext->line_max) {
+        ext->first = (ext->first + 1) % ext->line_max;
+        ext->cnt--;
+    }
+    if(ext->scroll != 0) ext->scroll++;
+
+    ext->cnt++;
+    char * line = get_line(ext, ext->cnt - 1);
+    line[0] = '\0';
+    return line;
+}
+
+/**
+ * Get the distance of two rows of a log view
+ * @param logview pointer to a log view object
+ * @return the height of a row with the line space
+ */
+static lv_coord_t get_row_height(const lv_obj_t * logview)
+{
+    const lv_font_t * font = lv_obj_get_style_text_font(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t line_space = lv_obj_get_style_text_line_space(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t row_h = lv_font_get_line_height(font) + line_space;
+    return row_h > 0 ? row_h : 1;
+}
+
+/**
+ * Get how many lines fit into a log view
+ * @param logview pointer to a log view object
+ * @return number of rows, at least 1
+ */
+static uint16_t get_row_cnt(const lv_obj_t * logview)
+{
+    lv_coord_t line_space = lv_obj_get_style_text_line_space(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t h = lv_obj_get_height_fit(logview) + line_space;
+    lv_coord_t rows = h / get_row_height(logview);
+    return rows > 0 ? (uint16_t)rows : 1;
+}
+
+/**
+ * Invalidate only some rows of a log view
+ * @param logview pointer to a log view object
+ * @param row_first index of the first row to invalidate, 0: the top row
+ * @param row_last index of the last row to invalidate
+ */
+static void invalidate_rows(lv_obj_t * logview, uint16_t row_first, uint16_t row_last)
+{
+    const lv_font_t * font = lv_obj_get_style_text_font(logview, LV_LOGVIEW_PART_MAIN);
+    lv_coord_t row_h = get_row_height(logview);
+    lv_coord_t top = logview->coords.y1 + lv_obj_get_style_pad_top(logview, LV_LOGVIEW_PART_MAIN);
+
+    lv_area_t area;
+    area.x1 = logview->coords.x1 + lv_obj_get_style_pad_left(logview, LV_LOGVIEW_PART_MAIN);
+    area.x2 = logview->coords.x2 - lv_obj_get_style_pad_right(logview, LV_LOGVIEW_PART_MAIN);
+    area.y1 = top + row_first * row_h;
+    area.y2 = top + row_last * row_h + lv_font_get_line_height(font) - 1;
+
+    lv_obj_invalidate_area(logview, &area);
+}
+
+#endif
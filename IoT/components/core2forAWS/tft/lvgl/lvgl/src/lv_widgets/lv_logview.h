@@ -0,0 +1,131 @@
+/**
+ * @file lv_logview.h
+ *
+ */
+
+#ifndef LV_LOGVIEW_H
+#define LV_LOGVIEW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_conf_internal.h"
+
+#if LV_USE_LOGVIEW != 0
+
+#include "../lv_core/lv_obj.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*Data of log view*/
+typedef struct {
+    /*No inherited ext.*/
+    /*New data for this type */
+    char * buf;             /*`line_max` slots of `line_len + 1` bytes used as a ring of lines*/
+    uint16_t line_max;      /*Number of slots in `buf`*/
+    uint16_t line_len;      /*Max. length of a line in bytes, without the closing '\0'*/
+    uint16_t first;         /*Slot of the oldest line*/
+    uint16_t cnt;           /*Number of stored lines*/
+    uint16_t scroll;        /*Number of lines scrolled back from the newest one*/
+    lv_coord_t drag_sum;    /*Vertical drag not applied to `scroll` yet*/
+    uint8_t open : 1;       /*1: the newest line is not closed with '\n' yet*/
+} lv_logview_ext_t;
+
+/*Parts of log view*/
+enum {
+    LV_LOGVIEW_PART_MAIN = LV_OBJ_PART_MAIN,
+};
+typedef uint8_t lv_logview_part_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a log view objects
+ * @param par pointer to an object, it will be the parent of the new log view
+ * @param copy pointer to a log view object, if not NULL then the new object will be copied from it
+ * @return pointer to the created log view
+ */
+lv_obj_t * lv_logview_create(lv_obj_t * par, const lv_obj_t * copy);
+
+/*=====================
+ * Setter functions
+ *====================*/
+
+/**
+ * Set the number of lines a log view keeps and their max. length. The stored lines are cleared.
+ * @param logview pointer to a log view object
+ * @param line_cnt number of lines to keep (min. 2), the oldest line is dropped if a new one doesn't fit
+ * @param line_len max. length of a line in bytes (min. 4), longer lines are broken
+ */
+void lv_logview_set_buffer(lv_obj_t * logview, uint16_t line_cnt, uint16_t line_len);
+
+/**
+ * Append text to a log view. The text continues the last line until a '\n'.
+ * Lines wider than the log view are wrapped when they are added.
+ * @param logview pointer to a log view object
+ * @param txt a '\0' terminated string to append
+ */
+void lv_logview_add_text(lv_obj_t * logview, const char * txt);
+
+/**
+ * Remove all lines of a log view
+ * @param logview pointer to a log view object
+ */
+void lv_logview_clear(lv_obj_t * logview);
+
+/**
+ * Scroll back a log view
+ * @param logview pointer to a log view object
+ * @param line_ofs number of lines to scroll back from the newest line. 0: show the newest lines
+ */
+void lv_logview_set_scroll(lv_obj_t * logview, uint16_t line_ofs);
+
+/*=====================
+ * Getter functions
+ *====================*/
+
+/**
+ * Get the number of lines stored in a log view
+ * @param logview pointer to a log view object
+ * @return number of lines
+ */
+uint16_t lv_logview_get_line_count(const lv_obj_t * logview);
+
+/**
+ * Get a stored line of a log view
+ * @param logview pointer to a log view object
+ * @param id index of the line, 0: the oldest line
+ * @return the text of the line or NULL if `id` is out of range
+ */
+const char * lv_logview_get_line(const lv_obj_t * logview, uint16_t id);
+
+/**
+ * Get how many lines a log view is scrolled back
+ * @param logview pointer to a log view object
+ * @return number of lines scrolled back from the newest line
+ */
+uint16_t lv_logview_get_scroll(const lv_obj_t * logview);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /*LV_USE_LOGVIEW*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_LOGVIEW_H*/
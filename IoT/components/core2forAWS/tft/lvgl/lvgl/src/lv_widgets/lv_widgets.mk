@@ -27,6 +27,7 @@ CSRCS += lv_img.c
 CSRCS += lv_imgbtn.c
 CSRCS += lv_led.c
 CSRCS += lv_linemeter.c
+CSRCS += lv_logview.c
 CSRCS += lv_page.c
 CSRCS += lv_switch.c
 CSRCS += lv_win.c
@@ -52,6 +52,7 @@ def build(name, defines):
 minimal_monochrome = {
   "LV_DPI":40,
   "LV_MEM_SIZE":4*1024,
+  "LV_MEM_TLSF":0,
   "LV_HOR_RES_MAX":128,
   "LV_VER_RES_MAX":64,
   "LV_COLOR_DEPTH":1,
@@ -90,6 +91,8 @@ minimal_monochrome = {
   "LV_FONT_MONTSERRAT_28":0,
   "LV_FONT_MONTSERRAT_12_SUBPX":0,
   "LV_FONT_MONTSERRAT_28_COMPRESSED":0,
+  "LV_FONT_GLYPH_CACHE_SIZE":0,
+  "LV_USE_OBJ_DRAW_CACHE":0,
   "LV_FONT_UNSCII_8":1,
   "LV_USE_BIDI": 0,
   "LV_USE_OBJ_REALIGN": 0,
@@ -109,10 +112,12 @@ minimal_monochrome = {
   "LV_USE_IMGBTN":0,
   "LV_USE_KEYBOARD":0,
   "LV_USE_LABEL":1,
+  "LV_LABEL_LINE_CACHE":0,
   "LV_USE_LED":0,
   "LV_USE_LINE":0,
   "LV_USE_LIST":0,
   "LV_USE_LINEMETER":0,
+  "LV_USE_LOGVIEW":0,
   "LV_USE_OBJMASK":0,
   "LV_USE_MBOX":0,
   "LV_USE_PAGE":0,
@@ -131,6 +136,7 @@ minimal_monochrome = {
 all_obj_minimal_features = {
   "LV_DPI":60,
   "LV_MEM_SIZE":12*1024,
+  "LV_MEM_TLSF":1,
   "LV_HOR_RES_MAX":320,
   "LV_VER_RES_MAX":240,
   "LV_COLOR_DEPTH":8,
@@ -165,6 +171,8 @@ all_obj_minimal_features = {
   "LV_FONT_MONTSERRAT_28":0,
   "LV_FONT_MONTSERRAT_12_SUBPX":0,
   "LV_FONT_MONTSERRAT_28_COMPRESSED":0,
+  "LV_FONT_GLYPH_CACHE_SIZE":0,
+  "LV_USE_OBJ_DRAW_CACHE":0,
   "LV_FONT_UNSCII_8":0,
   "LV_USE_BIDI": 0,
   "LV_USE_OBJ_REALIGN": 0,
@@ -185,10 +193,12 @@ all_obj_minimal_features = {
   "LV_USE_IMGBTN":1,
   "LV_USE_KEYBOARD":1,
   "LV_USE_LABEL":1,
+  "LV_LABEL_LINE_CACHE":0,
   "LV_USE_LED":1,
   "LV_USE_LINE":1,
   "LV_USE_LIST":1,
   "LV_USE_LINEMETER":1,
+  "LV_USE_LOGVIEW":1,
   "LV_USE_OBJMASK":1,
   "LV_USE_MBOX":1,
   "LV_USE_PAGE":1,
@@ -207,6 +217,7 @@ all_obj_minimal_features = {
 all_obj_all_features = {
   "LV_DPI":100,
   "LV_MEM_SIZE":32*1024,
+  "LV_MEM_TLSF":1,
   "LV_HOR_RES_MAX":480,
   "LV_VER_RES_MAX":320,
   "LV_COLOR_DEPTH":32,
@@ -246,6 +257,8 @@ all_obj_all_features = {
   "LV_FONT_MONTSERRAT_28":1,
   "LV_FONT_MONTSERRAT_12_SUBPX":1,
   "LV_FONT_MONTSERRAT_28_COMPRESSED":1,
+  "LV_FONT_GLYPH_CACHE_SIZE":2048,
+  "LV_USE_OBJ_DRAW_CACHE":1,
   "LV_FONT_UNSCII_8":1,
   "LV_USE_ARC":1,
   "LV_USE_BAR":1,
@@ -263,10 +276,12 @@ all_obj_all_features = {
   "LV_USE_IMGBTN":1,
   "LV_USE_KEYBOARD":1,
   "LV_USE_LABEL":1,
+  "LV_LABEL_LINE_CACHE":1,
   "LV_USE_LED":1,
   "LV_USE_LINE":1,
   "LV_USE_LIST":1,
   "LV_USE_LINEMETER":1,
+  "LV_USE_LOGVIEW":1,
   "LV_USE_OBJMASK":1,
   "LV_USE_MBOX":1,
   "LV_USE_PAGE":1,
@@ -325,6 +340,8 @@ advanced_features = {
   "LV_FONT_MONTSERRAT_28":1,
   "LV_FONT_MONTSERRAT_12_SUBPX":1,
   "LV_FONT_MONTSERRAT_28_COMPRESSED":1,
+  "LV_FONT_GLYPH_CACHE_SIZE":8192,
+  "LV_USE_OBJ_DRAW_CACHE":1,
   "LV_FONT_UNSCII_8":1,
   "LV_USE_BIDI": 1,
   "LV_USE_REVERSE_ARABIC_PERSIAN_CHARS":1,
@@ -350,10 +367,12 @@ advanced_features = {
   "LV_USE_IMGBTN":1,
   "LV_USE_KEYBOARD":1,
   "LV_USE_LABEL":1,
+  "LV_LABEL_LINE_CACHE":1,
   "LV_USE_LED":1,
   "LV_USE_LINE":1,
   "LV_USE_LIST":1,
   "LV_USE_LINEMETER":1,
+  "LV_USE_LOGVIEW":1,
   "LV_USE_OBJMASK":1,
   "LV_USE_MBOX":1,
   "LV_USE_PAGE":1,
@@ -0,0 +1,264 @@
+/**
+ * @file lv_bench_draw_cache.c
+ * Renders the CleaningTracker screen (labels, due bar, button, log) frame by frame and measures
+ * the time of a frame and of resolving the draw descriptors from the styles.
+ * Build it once with and once without the draw descriptor cache to compare:
+ *
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144 -DLV_USE_OBJ_DRAW_CACHE=0"
+ * ./bench_draw_cache
+ * make clean
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144 -DLV_USE_OBJ_DRAW_CACHE=1"
+ * ./bench_draw_cache
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         320
+#define VER_RES         240
+#define FRAMES          500
+#define DSC_REPEAT      20000
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void create_screen(void);
+static void scenario_full(void);
+static void scenario_due_bar(void);
+static void scenario_clock(void);
+static void scenario_press(void);
+static void scenario_dsc(void);
+static void frame(void);
+static void print_result(const char * name, uint64_t ns, uint32_t frames);
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t * disp;
+static lv_obj_t * scr;
+static lv_obj_t * wifi_label;
+static lv_obj_t * date_label;
+static lv_obj_t * due_bar;
+static lv_obj_t * btn;
+static lv_obj_t * btn_label;
+static lv_obj_t * txtarea;
+static lv_obj_draw_cache_stats_t stats_start;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    static lv_disp_buf_t disp_buf;
+    static lv_color_t buf[HOR_RES * 24];
+    lv_disp_buf_init(&disp_buf, buf, NULL, HOR_RES * 24);
+
+    lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.buffer = &disp_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp = lv_disp_drv_register(&disp_drv);
+
+    create_screen();
+
+    printf("LV_USE_OBJ_DRAW_CACHE %d\n", LV_USE_OBJ_DRAW_CACHE);
+    printf("scenario   frames  us/frame  cache hits\n");
+    scenario_full();
+    scenario_due_bar();
+    scenario_clock();
+    scenario_press();
+    scenario_dsc();
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The CleaningTracker screen with the log visible: clock, Wi-Fi state, due bar, button and log lines
+ */
+static void create_screen(void)
+{
+    scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    wifi_label = lv_label_create(scr, NULL);
+    lv_obj_align(wifi_label, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 6);
+    lv_label_set_text(wifi_label, LV_SYMBOL_WIFI);
+
+    lv_obj_t * room_label = lv_label_create(scr, NULL);
+    lv_obj_align(room_label, NULL, LV_ALIGN_IN_TOP_RIGHT, -150, 6);
+    lv_label_set_text(room_label, "Cafeteria");
+
+    date_label = lv_label_create(scr, NULL);
+    lv_label_set_text(date_label, "00:00");
+    lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);
+
+    due_bar = lv_bar_create(scr, NULL);
+    lv_obj_set_size(due_bar, 180, 20);
+    lv_obj_align(due_bar, NULL, LV_ALIGN_IN_TOP_MID, 0, 140);
+    lv_bar_set_value(due_bar, 100, LV_ANIM_OFF);
+
+    btn = lv_btn_create(scr, NULL);
+    lv_obj_set_width(btn, 200);
+    lv_obj_align(btn, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -20);
+    btn_label = lv_label_create(btn, NULL);
+    lv_label_set_text(btn_label, "Cleaned");
+
+    txtarea = lv_textarea_create(scr, NULL);
+    lv_obj_set_size(txtarea, 300, 80);
+    lv_obj_align(txtarea, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -80);
+    lv_textarea_set_cursor_hidden(txtarea, true);
+    lv_textarea_set_text(txtarea, "Starting CleaningTracker\nConnected to AWS IoT\nPublished the due time\n");
+
+    lv_refr_now(disp);
+}
+
+/**
+ * Redraw the whole screen, e.g. after a screen load
+ */
+static void scenario_full(void)
+{
+    lv_obj_get_draw_cache_stats(&stats_start);
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_obj_invalidate(scr);
+        frame();
+    }
+    print_result("full", time_ns() - start, FRAMES);
+}
+
+/**
+ * The due bar counts down
+ */
+static void scenario_due_bar(void)
+{
+    lv_obj_get_draw_cache_stats(&stats_start);
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_bar_set_value(due_bar, 100 - (f % 100), LV_ANIM_OFF);
+        frame();
+    }
+    print_result("due bar", time_ns() - start, FRAMES);
+}
+
+/**
+ * The clock and the Wi-Fi state change
+ */
+static void scenario_clock(void)
+{
+    lv_obj_get_draw_cache_stats(&stats_start);
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_label_set_text_fmt(date_label, "%02u:%02u", (unsigned)((f / 60) % 24), (unsigned)(f % 60));
+        if(f % 10 == 5) lv_label_set_text(wifi_label, f % 20 == 5 ? LV_SYMBOL_WIFI " Offline" : LV_SYMBOL_WIFI);
+        frame();
+    }
+    print_result("clock", time_ns() - start, FRAMES);
+}
+
+/**
+ * The button is pressed and released, every frame drops the cached descriptors of the button
+ */
+static void scenario_press(void)
+{
+    lv_obj_get_draw_cache_stats(&stats_start);
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        if(f & 1) lv_obj_clear_state(btn, LV_STATE_PRESSED);
+        else lv_obj_add_state(btn, LV_STATE_PRESSED);
+        frame();
+    }
+    print_result("press", time_ns() - start, FRAMES);
+}
+
+/**
+ * Only resolve the descriptors the widgets of the screen use for drawing, without drawing them
+ */
+static void scenario_dsc(void)
+{
+    lv_obj_get_draw_cache_stats(&stats_start);
+    uint64_t start = time_ns();
+    uint32_t i;
+    for(i = 0; i < DSC_REPEAT; i++) {
+        lv_draw_rect_dsc_t rect;
+        lv_draw_label_dsc_t label;
+
+        lv_draw_rect_dsc_init(&rect);
+        lv_obj_init_draw_rect_dsc(due_bar, LV_BAR_PART_BG, &rect);
+        lv_draw_rect_dsc_init(&rect);
+        lv_obj_init_draw_rect_dsc(due_bar, LV_BAR_PART_INDIC, &rect);
+        lv_draw_rect_dsc_init(&rect);
+        lv_obj_init_draw_rect_dsc(btn, LV_BTN_PART_MAIN, &rect);
+        lv_draw_label_dsc_init(&label);
+        lv_obj_init_draw_label_dsc(btn_label, LV_LABEL_PART_MAIN, &label);
+        lv_draw_label_dsc_init(&label);
+        lv_obj_init_draw_label_dsc(date_label, LV_LABEL_PART_MAIN, &label);
+    }
+    print_result("dsc only", time_ns() - start, DSC_REPEAT);
+}
+
+static void frame(void)
+{
+    lv_refr_now(disp);
+}
+
+static void print_result(const char * name, uint64_t ns, uint32_t frames)
+{
+    lv_obj_draw_cache_stats_t stats;
+    lv_obj_get_draw_cache_stats(&stats);
+    uint32_t hit = stats.hit - stats_start.hit;
+    uint32_t miss = stats.miss - stats_start.miss;
+    uint32_t all = hit + miss;
+
+    printf("%-9s  %6u  %8.2f  %9u%%\n", name, (unsigned)frames, (double)ns / frames / 1000,
+           all ? (unsigned)((uint64_t)hit * 100 / all) : 0);
+}
+
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(color_p);
+    lv_disp_flush_ready(disp_drv);
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,400 @@
+/**
+ * @file lv_bench_inv_area.c
+ * Records the areas invalidated by a few UI scenarios frame by frame and compares the pixels
+ * which really changed with the pixels the refresh would draw:
+ * - old: pairwise join of overlapping areas, whole screen if the buffer overflows
+ * - new: `_lv_refr_join_areas()` and joining into the closest area on overflow
+ *
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144"
+ * ./bench_inv_area
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         320
+#define VER_RES         240
+#define TRACE_SIZE      512
+#define JOIN_REPEAT     1000
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t frames;
+    uint32_t dirty_px;
+    uint32_t old_px;
+    uint32_t old_areas;
+    uint32_t old_join_ns;
+    uint32_t new_px;
+    uint32_t new_areas;
+    uint32_t new_join_ns;
+} bench_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void scenario_cleaning(void);
+static void scenario_dashboard(void);
+static void scenario_corners(void);
+static void scenario_readings(void);
+static void frame_start(void);
+static void frame_end(void);
+static void print_result(const char * name);
+static void record_cb(lv_disp_drv_t * disp_drv, lv_area_t * area);
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+static void old_inv_area(lv_area_t * areas, uint32_t * cnt, const lv_area_t * area);
+static void old_join_area(lv_area_t * areas, uint8_t * joined, uint32_t cnt);
+static uint32_t drawn_px(const lv_area_t * areas, const uint8_t * joined, uint32_t cnt, uint32_t * area_cnt);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t * disp;
+static lv_area_t trace[TRACE_SIZE];
+static uint32_t trace_cnt;
+static bool recording;
+static uint8_t dirty_map[HOR_RES * VER_RES];
+static bench_result_t res;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    static lv_disp_buf_t disp_buf;
+    static lv_color_t buf[HOR_RES * 24];
+    lv_disp_buf_init(&disp_buf, buf, NULL, HOR_RES * 24);
+
+    lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.buffer = &disp_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp_drv.rounder_cb = record_cb;    /*Called with every invalidated area, the trace is recorded here*/
+    disp = lv_disp_drv_register(&disp_drv);
+
+    printf("scenario   frames  dirty px  old px  old areas  old ns  new px  new areas  new ns\n");
+    printf("(averages per frame, ns: time of joining the areas)\n");
+    scenario_cleaning();
+    scenario_dashboard();
+    scenario_corners();
+    scenario_readings();
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The CleaningTracker screen with the log visible: clock, Wi-Fi state, due bar and log lines
+ */
+static void scenario_cleaning(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    lv_obj_t * wifi_label = lv_label_create(scr, NULL);
+    lv_obj_align(wifi_label, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 6);
+    lv_label_set_text(wifi_label, LV_SYMBOL_WIFI);
+
+    lv_obj_t * room_label = lv_label_create(scr, NULL);
+    lv_obj_align(room_label, NULL, LV_ALIGN_IN_TOP_RIGHT, -150, 6);
+    lv_label_set_text(room_label, "Cafeteria");
+
+    lv_obj_t * date_label = lv_label_create(scr, NULL);
+    lv_label_set_text(date_label, "00:00");
+    lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);
+
+    lv_obj_t * due_bar = lv_bar_create(scr, NULL);
+    lv_obj_set_size(due_bar, 180, 20);
+    lv_obj_align(due_bar, NULL, LV_ALIGN_IN_TOP_MID, 0, 140);
+    lv_bar_set_value(due_bar, 100, LV_ANIM_OFF);
+
+    lv_obj_t * btn = lv_btn_create(scr, NULL);
+    lv_obj_set_width(btn, 200);
+    lv_obj_align(btn, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -20);
+
+    lv_obj_t * txtarea = lv_textarea_create(scr, NULL);
+    lv_obj_set_size(txtarea, 300, 80);
+    lv_obj_align(txtarea, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -80);
+    lv_textarea_set_cursor_hidden(txtarea, true);
+    lv_textarea_set_text(txtarea, "Starting CleaningTracker\n");
+
+    uint32_t i;
+    for(i = 0; i < 60; i++) {
+        frame_start();
+        lv_label_set_text_fmt(date_label, "%02u:%02u", (unsigned)(8 + i / 60), (unsigned)(i % 60));
+        lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);
+        lv_bar_set_value(due_bar, 100 - i, LV_ANIM_OFF);
+        if(i % 10 == 5) lv_label_set_text(wifi_label, i % 20 == 5 ? LV_SYMBOL_WIFI " Offline" : LV_SYMBOL_WIFI);
+        if(i % 3 == 0) lv_textarea_add_text(txtarea, "Published the due time\n");
+        frame_end();
+    }
+
+    print_result("cleaning");
+    lv_obj_del(scr);
+}
+
+/**
+ * A grid of sensor values all updated in every frame. More areas than LV_INV_BUF_SIZE.
+ */
+static void scenario_dashboard(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    lv_obj_t * labels[48];
+    uint32_t i;
+    for(i = 0; i < 48; i++) {
+        labels[i] = lv_label_create(scr, NULL);
+        lv_obj_set_pos(labels[i], (i % 6) * 53 + 4, (i / 6) * 30 + 4);
+        lv_label_set_text(labels[i], "0.0");
+    }
+
+    uint32_t f;
+    for(f = 0; f < 30; f++) {
+        frame_start();
+        for(i = 0; i < 48; i++) {
+            uint32_t v = (f * 7 + i * 13) % 1000;
+            lv_label_set_text_fmt(labels[i], "%u.%u", (unsigned)(v / 10), (unsigned)(v % 10));
+        }
+        frame_end();
+    }
+
+    print_result("dashboard");
+    lv_obj_del(scr);
+}
+
+/**
+ * Small labels in the corners and a slider in the middle, far from each other
+ */
+static void scenario_corners(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    static const lv_align_t aligns[4] = {LV_ALIGN_IN_TOP_LEFT, LV_ALIGN_IN_TOP_RIGHT, LV_ALIGN_IN_BOTTOM_LEFT, LV_ALIGN_IN_BOTTOM_RIGHT};
+    lv_obj_t * labels[4];
+    uint32_t i;
+    for(i = 0; i < 4; i++) {
+        labels[i] = lv_label_create(scr, NULL);
+        lv_label_set_text(labels[i], "00");
+        lv_obj_align(labels[i], NULL, aligns[i], 0, 0);
+    }
+
+    lv_obj_t * slider = lv_slider_create(scr, NULL);
+    lv_obj_set_width(slider, 160);
+    lv_obj_align(slider, NULL, LV_ALIGN_CENTER, 0, 0);
+
+    uint32_t f;
+    for(f = 0; f < 60; f++) {
+        frame_start();
+        lv_label_set_text_fmt(labels[f % 4], "%02u", (unsigned)f);
+        lv_slider_set_value(slider, (int16_t)((f * 5) % 100), LV_ANIM_OFF);
+        frame_end();
+    }
+
+    print_result("corners");
+    lv_obj_del(scr);
+}
+
+/**
+ * A column of readings with a few pixels between the lines, all updated in every frame
+ */
+static void scenario_readings(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    lv_obj_t * labels[10];
+    uint32_t i;
+    for(i = 0; i < 10; i++) {
+        labels[i] = lv_label_create(scr, NULL);
+        lv_obj_set_pos(labels[i], 200, 20 + i * 20);
+        lv_label_set_text(labels[i], "0 ppm");
+    }
+
+    uint32_t f;
+    for(f = 0; f < 30; f++) {
+        frame_start();
+        for(i = 0; i < 10; i++) {
+            lv_label_set_text_fmt(labels[i], "%u ppm", (unsigned)((f * 37 + i * 101) % 2000));
+        }
+        frame_end();
+    }
+
+    print_result("readings");
+    lv_obj_del(scr);
+}
+
+static void frame_start(void)
+{
+    /*Drop what the set up invalidated and record from here*/
+    _lv_inv_area(disp, NULL);
+    trace_cnt = 0;
+    recording = true;
+}
+
+static void frame_end(void)
+{
+    recording = false;
+    res.frames++;
+
+    /*Pixels which really changed*/
+    _lv_memset_00(dirty_map, sizeof(dirty_map));
+    uint32_t i;
+    for(i = 0; i < trace_cnt; i++) {
+        lv_coord_t y;
+        for(y = trace[i].y1; y <= trace[i].y2; y++) {
+            _lv_memset(&dirty_map[y * HOR_RES + trace[i].x1], 1, lv_area_get_width(&trace[i]));
+        }
+    }
+    for(i = 0; i < sizeof(dirty_map); i++) res.dirty_px += dirty_map[i];
+
+    /*Replay the trace into the old buffer handling*/
+    lv_area_t old_areas[LV_INV_BUF_SIZE];
+    uint32_t old_cnt = 0;
+    for(i = 0; i < trace_cnt; i++) old_inv_area(old_areas, &old_cnt, &trace[i]);
+
+    lv_area_t areas[LV_INV_BUF_SIZE];
+    uint8_t joined[LV_INV_BUF_SIZE];
+    uint32_t area_cnt;
+    uint32_t r;
+
+    uint64_t start = time_ns();
+    for(r = 0; r < JOIN_REPEAT; r++) {
+        _lv_memcpy_small(areas, old_areas, sizeof(lv_area_t) * old_cnt);
+        _lv_memset_00(joined, sizeof(joined));
+        old_join_area(areas, joined, old_cnt);
+    }
+    res.old_join_ns += (uint32_t)((time_ns() - start) / JOIN_REPEAT);
+    res.old_px += drawn_px(areas, joined, old_cnt, &area_cnt);
+    res.old_areas += area_cnt;
+
+    /*The display already holds the areas stored by the new buffer handling*/
+    uint32_t new_cnt = lv_disp_get_inv_buf_size(disp);
+    start = time_ns();
+    for(r = 0; r < JOIN_REPEAT; r++) {
+        _lv_memcpy_small(areas, disp->inv_areas, sizeof(lv_area_t) * new_cnt);
+        _lv_memset_00(joined, sizeof(joined));
+        _lv_refr_join_areas(areas, joined, new_cnt);
+    }
+    res.new_join_ns += (uint32_t)((time_ns() - start) / JOIN_REPEAT);
+    res.new_px += drawn_px(areas, joined, new_cnt, &area_cnt);
+    res.new_areas += area_cnt;
+
+    _lv_inv_area(disp, NULL);
+}
+
+static void print_result(const char * name)
+{
+    uint32_t f = res.frames;
+    printf("%-9s  %6u  %8u  %6u  %9.1f  %6u  %6u  %9.1f  %6u\n", name, (unsigned)f,
+           (unsigned)(res.dirty_px / f), (unsigned)(res.old_px / f), (double)res.old_areas / f,
+           (unsigned)(res.old_join_ns / f), (unsigned)(res.new_px / f), (double)res.new_areas / f,
+           (unsigned)(res.new_join_ns / f));
+
+    _lv_memset_00(&res, sizeof(res));
+}
+
+static void record_cb(lv_disp_drv_t * disp_drv, lv_area_t * area)
+{
+    LV_UNUSED(disp_drv);
+    if(recording && trace_cnt < TRACE_SIZE) lv_area_copy(&trace[trace_cnt++], area);
+}
+
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(color_p);
+    lv_disp_flush_ready(disp_drv);
+}
+
+/**
+ * `_lv_inv_area()` before the areas were joined on overflow
+ */
+static void old_inv_area(lv_area_t * areas, uint32_t * cnt, const lv_area_t * area)
+{
+    uint32_t i;
+    for(i = 0; i < *cnt; i++) {
+        if(_lv_area_is_in(area, &areas[i], 0)) return;
+    }
+
+    if(*cnt < LV_INV_BUF_SIZE) {
+        lv_area_copy(&areas[*cnt], area);
+        (*cnt)++;
+    }
+    else {
+        lv_area_set(&areas[0], 0, 0, HOR_RES - 1, VER_RES - 1);
+        *cnt = 1;
+    }
+}
+
+/**
+ * `lv_refr_join_area()` before the cost model
+ */
+static void old_join_area(lv_area_t * areas, uint8_t * joined, uint32_t cnt)
+{
+    uint32_t join_from;
+    uint32_t join_in;
+    lv_area_t joined_area;
+    for(join_in = 0; join_in < cnt; join_in++) {
+        if(joined[join_in] != 0) continue;
+
+        for(join_from = 0; join_from < cnt; join_from++) {
+            if(joined[join_from] != 0 || join_in == join_from) continue;
+            if(_lv_area_is_on(&areas[join_in], &areas[join_from]) == false) continue;
+
+            _lv_area_join(&joined_area, &areas[join_in], &areas[join_from]);
+            if(lv_area_get_size(&joined_area) < (lv_area_get_size(&areas[join_in]) + lv_area_get_size(&areas[join_from]))) {
+                lv_area_copy(&areas[join_in], &joined_area);
+                joined[join_from] = 1;
+            }
+        }
+    }
+}
+
+static uint32_t drawn_px(const lv_area_t * areas, const uint8_t * joined, uint32_t cnt, uint32_t * area_cnt)
+{
+    uint32_t px = 0;
+    uint32_t i;
+    *area_cnt = 0;
+    for(i = 0; i < cnt; i++) {
+        if(joined[i]) continue;
+        px += lv_area_get_size(&areas[i]);
+        (*area_cnt)++;
+    }
+    return px;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file lv_bench_label.c
+ * Measures the text layout of labels on the CleaningTracker screen: the 1024 character debug log
+ * (appending, redrawing, scrolling, finding the cursor) and the clock title which is aligned after every change.
+ * Build it once with and once without the line cache to compare:
+ *
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144 -DLV_LABEL_LINE_CACHE=0"
+ * ./bench_label
+ * make clean
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144 -DLV_LABEL_LINE_CACHE=1"
+ * ./bench_label
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         320
+#define VER_RES         240
+#define FRAMES          500
+#define LOG_LENGTH      1024
+#define POS_REPEAT      2000
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void create_screen(void);
+static void scenario_log_append(void);
+static void scenario_log_redraw(void);
+static void scenario_log_scroll(void);
+static void scenario_cursor(void);
+static void scenario_title(void);
+static void log_add(const char * txt);
+static void frame(void);
+static void print_result(const char * name, uint64_t ns, uint32_t cnt);
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t * disp;
+static lv_obj_t * scr;
+static lv_obj_t * date_label;
+static lv_obj_t * txtarea;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    static lv_disp_buf_t disp_buf;
+    static lv_color_t buf[HOR_RES * 24];
+    lv_disp_buf_init(&disp_buf, buf, NULL, HOR_RES * 24);
+
+    lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.buffer = &disp_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp = lv_disp_drv_register(&disp_drv);
+
+    create_screen();
+
+    printf("LV_LABEL_LINE_CACHE %d\n", LV_LABEL_LINE_CACHE);
+    printf("scenario      count  us/each\n");
+    scenario_log_append();
+    scenario_log_redraw();
+    scenario_log_scroll();
+    scenario_cursor();
+    scenario_title();
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The CleaningTracker screen with the clock title and a full debug log
+ */
+static void create_screen(void)
+{
+    scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    date_label = lv_label_create(scr, NULL);
+    lv_obj_set_style_local_text_font(date_label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_THEME_DEFAULT_FONT_TITLE);
+    lv_label_set_text(date_label, "Mon 00:00");
+    lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 10);
+
+    txtarea = lv_textarea_create(scr, NULL);
+    lv_obj_set_size(txtarea, 300, 180);
+    lv_obj_align(txtarea, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -12);
+    lv_textarea_set_max_length(txtarea, LOG_LENGTH);
+    lv_textarea_set_cursor_hidden(txtarea, true);
+    lv_textarea_set_text(txtarea, "Starting CleaningTracker\n");
+
+    uint32_t i;
+    for(i = 0; lv_label_get_text(lv_textarea_get_label(txtarea))[LOG_LENGTH - 100] == '\0'; i++) {
+        char line[64];
+        lv_snprintf(line, sizeof(line), "Published the due time of the cafeteria, %u\n", (unsigned)i);
+        log_add(line);
+    }
+
+    lv_refr_now(disp);
+}
+
+/**
+ * A line is logged every frame, the oldest characters are dropped to stay below the limit
+ */
+static void scenario_log_append(void)
+{
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        char line[64];
+        lv_snprintf(line, sizeof(line), "Shadow delta received, %u\n", (unsigned)f);
+        log_add(line);
+        frame();
+    }
+    print_result("log append", time_ns() - start, FRAMES);
+}
+
+/**
+ * The log is redrawn without changes, e.g. because a widget on it has changed
+ */
+static void scenario_log_redraw(void)
+{
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_obj_invalidate(txtarea);
+        frame();
+    }
+    print_result("log redraw", time_ns() - start, FRAMES);
+}
+
+/**
+ * The log is scrolled up and down
+ */
+static void scenario_log_scroll(void)
+{
+    lv_obj_t * scrl = lv_page_get_scrollable(txtarea);
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_obj_set_y(scrl, -(lv_coord_t)((f * 4) % 400));
+        frame();
+    }
+    print_result("log scroll", time_ns() - start, FRAMES);
+}
+
+/**
+ * Find the position of the last character as the textarea does for the cursor
+ */
+static void scenario_cursor(void)
+{
+    lv_obj_t * label = lv_textarea_get_label(txtarea);
+    uint32_t last = _lv_txt_get_encoded_length(lv_label_get_text(label));
+    uint64_t start = time_ns();
+    uint32_t i;
+    for(i = 0; i < POS_REPEAT; i++) {
+        lv_point_t p;
+        lv_label_get_letter_pos(label, last - (i % 64), &p);
+    }
+    print_result("cursor", time_ns() - start, POS_REPEAT);
+}
+
+/**
+ * The clock title is updated and aligned again every frame
+ */
+static void scenario_title(void)
+{
+    uint64_t start = time_ns();
+    uint32_t f;
+    for(f = 0; f < FRAMES; f++) {
+        lv_label_set_text_fmt(date_label, "Mon %02u:%02u", (unsigned)((f / 60) % 24), (unsigned)(f % 60));
+        lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 10);
+        frame();
+    }
+    print_result("title", time_ns() - start, FRAMES);
+}
+
+/**
+ * Add a line to the log like the debug console of the application does
+ */
+static void log_add(const char * txt)
+{
+    size_t len = strlen(lv_textarea_get_text(txtarea));
+    size_t add_len = strlen(txt);
+    if(len + add_len >= LOG_LENGTH) {
+        lv_textarea_set_cursor_pos(txtarea, 0);
+        while(len + add_len >= LOG_LENGTH) {
+            lv_textarea_del_char_forward(txtarea);
+            len--;
+        }
+        lv_textarea_set_cursor_pos(txtarea, LV_TEXTAREA_CURSOR_LAST);
+    }
+    lv_textarea_add_text(txtarea, txt);
+}
+
+static void frame(void)
+{
+    lv_refr_now(disp);
+}
+
+static void print_result(const char * name, uint64_t ns, uint32_t cnt)
+{
+    printf("%-11s  %6u  %7.2f\n", name, (unsigned)cnt, (double)ns / cnt / 1000);
+}
+
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(color_p);
+    lv_disp_flush_ready(disp_drv);
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * @file lv_bench_logview.c
+ * Measures the debug console of the CleaningTracker screen at high log rates: the 1024 character
+ * textarea pruned from the front like the application did and the log view keeping the newest lines.
+ * Both are measured hidden (as in release builds) and visible with a frame after every batch of lines.
+ *
+ * make bench_logview DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144"
+ * ./bench_logview
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         320
+#define VER_RES         240
+#define LINES           2000
+#define LOG_LENGTH      1024
+#define LOG_LINE_CNT    32
+#define LOG_LINE_LEN    64
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef void (*log_add_cb_t)(const char * txt);
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void create_screen(void);
+static void scenario(const char * name, lv_obj_t * obj, log_add_cb_t log_add, bool hidden, uint32_t burst);
+static void textarea_add(const char * txt);
+static void logview_add(const char * txt);
+static void print_result(const char * name, uint64_t ns, uint32_t cnt);
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t * disp;
+static lv_obj_t * scr;
+static lv_obj_t * txtarea;
+static lv_obj_t * logview;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    static lv_disp_buf_t disp_buf;
+    static lv_color_t buf[HOR_RES * 24];
+    lv_disp_buf_init(&disp_buf, buf, NULL, HOR_RES * 24);
+
+    lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.buffer = &disp_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp = lv_disp_drv_register(&disp_drv);
+
+    create_screen();
+
+    printf("scenario            lines  us/line\n");
+    scenario("textarea hidden", txtarea, textarea_add, true, 1);
+    scenario("logview hidden", logview, logview_add, true, 1);
+    scenario("textarea 1/frame", txtarea, textarea_add, false, 1);
+    scenario("logview 1/frame", logview, logview_add, false, 1);
+    scenario("textarea 10/frame", txtarea, textarea_add, false, 10);
+    scenario("logview 10/frame", logview, logview_add, false, 10);
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The debug console of the CleaningTracker screen once as textarea and once as log view
+ */
+static void create_screen(void)
+{
+    scr = lv_obj_create(NULL, NULL);
+    lv_scr_load(scr);
+
+    txtarea = lv_textarea_create(scr, NULL);
+    lv_obj_set_size(txtarea, 300, 180);
+    lv_obj_align(txtarea, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -12);
+    lv_textarea_set_max_length(txtarea, LOG_LENGTH);
+    lv_textarea_set_text_sel(txtarea, false);
+    lv_textarea_set_cursor_hidden(txtarea, true);
+    lv_textarea_set_text(txtarea, "Starting CleaningTracker\n");
+    lv_obj_set_hidden(txtarea, true);
+
+    logview = lv_logview_create(scr, NULL);
+    lv_logview_set_buffer(logview, LOG_LINE_CNT, LOG_LINE_LEN);
+    lv_obj_set_size(logview, 300, 180);
+    lv_obj_align(logview, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -12);
+    lv_logview_add_text(logview, "Starting CleaningTracker\n");
+    lv_obj_set_hidden(logview, true);
+
+    lv_refr_now(disp);
+}
+
+/**
+ * Log `LINES` lines into a full console, `burst` lines between two frames
+ */
+static void scenario(const char * name, lv_obj_t * obj, log_add_cb_t log_add, bool hidden, uint32_t burst)
+{
+    lv_obj_set_hidden(obj, hidden);
+
+    /*Fill the console first to measure the steady state*/
+    uint32_t i;
+    for(i = 0; i < 64; i++) log_add("Published the due time of the cafeteria\n");
+    lv_refr_now(disp);
+
+    uint64_t start = time_ns();
+    for(i = 0; i < LINES; i++) {
+        char line[64];
+        lv_snprintf(line, sizeof(line), "Shadow delta received, %u\n", (unsigned)i);
+        log_add(line);
+        if((i + 1) % burst == 0) lv_refr_now(disp);
+    }
+    print_result(name, time_ns() - start, LINES);
+
+    lv_obj_set_hidden(obj, true);
+    lv_refr_now(disp);
+}
+
+/**
+ * Add a line like the debug console did: drop as many characters from the front as added
+ */
+static void textarea_add(const char * txt)
+{
+    size_t len = strlen(lv_textarea_get_text(txtarea));
+    size_t add_len = strlen(txt);
+    if(len + add_len >= LOG_LENGTH) {
+        size_t i;
+        for(i = 0; i < add_len; i++) {
+            lv_textarea_set_cursor_pos(txtarea, 0);
+            lv_textarea_del_char_forward(txtarea);
+        }
+        lv_textarea_set_cursor_pos(txtarea, LV_TEXTAREA_CURSOR_LAST);
+    }
+    lv_textarea_add_text(txtarea, txt);
+}
+
+static void logview_add(const char * txt)
+{
+    lv_logview_add_text(logview, txt);
+}
+
+static void print_result(const char * name, uint64_t ns, uint32_t cnt)
+{
+    printf("%-18s  %5u  %7.2f\n", name, (unsigned)cnt, (double)ns / cnt / 1000);
+}
+
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(color_p);
+    lv_disp_flush_ready(disp_drv);
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
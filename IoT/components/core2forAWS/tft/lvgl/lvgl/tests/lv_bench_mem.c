@@ -0,0 +1,273 @@
+/**
+ * @file lv_bench_mem.c
+ * Stresses the built-in memory pool: the CleaningTracker screen and a list screen are created and deleted
+ * alternately while a label on the top layer keeps reallocating its text, then random allocations, reallocations
+ * and frees run in a smaller pool. Prints the average and the worst time of the operations and the fragmentation.
+ * Build it once with first fit and once with TLSF to compare:
+ *
+ * make bench_mem DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=65536 -DLV_MEM_TLSF=0"
+ * ./bench_mem
+ * make clean
+ * make bench_mem DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=65536 -DLV_MEM_TLSF=1"
+ * ./bench_mem
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HOR_RES         320
+#define VER_RES         240
+#define SCREEN_CNT      2000
+#define LIST_BTN_CNT    12
+#define CHURN_OPS       200000
+#define CHURN_SLOTS     48
+#define CHURN_SIZE_MAX  512
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint64_t sum;
+    uint64_t max;
+    uint32_t cnt;
+    uint32_t fail_cnt;
+    uint32_t biggest_min;   /*The smallest `free_biggest_size` seen*/
+} stat_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void screens(void);
+static void churn(void);
+static lv_obj_t * create_tracker_screen(void);
+static lv_obj_t * create_list_screen(void);
+static void stat_add(stat_t * stat, uint64_t ns);
+static void print_result(const char * name, const stat_t * stat);
+static uint32_t rnd(void);
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t * disp;
+static uint32_t rnd_seed = 1;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    static lv_disp_buf_t disp_buf;
+    static lv_color_t buf[HOR_RES * 24];
+    lv_disp_buf_init(&disp_buf, buf, NULL, HOR_RES * 24);
+
+    lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.buffer = &disp_buf;
+    disp_drv.flush_cb = flush_cb;
+    disp = lv_disp_drv_register(&disp_drv);
+
+    printf("allocator: %s, pool: %u bytes\n", LV_MEM_TLSF ? "TLSF" : "first fit", (unsigned)LV_MEM_SIZE);
+    printf("scenario       ops       us/op    max us  fails  frag%%  biggest  biggest min\n");
+    screens();
+    churn();
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Switch between two screens. An operation is creating the new screen and deleting the old one.
+ */
+static void screens(void)
+{
+    stat_t stat = {0};
+    stat.biggest_min = UINT32_MAX;
+
+    lv_obj_t * status = lv_label_create(lv_layer_top(), NULL);
+    lv_obj_t * old_scr = lv_scr_act();
+
+    uint32_t i;
+    for(i = 0; i < SCREEN_CNT; i++) {
+        uint64_t start = time_ns();
+        lv_obj_t * scr = i % 2 ? create_list_screen() : create_tracker_screen();
+        lv_scr_load(scr);
+        lv_obj_del(old_scr);
+        stat_add(&stat, time_ns() - start);
+        old_scr = scr;
+
+        /*Long living allocations between the screens*/
+        lv_label_set_text_fmt(status, "Screen %u, %u lines published%s", (unsigned)i, (unsigned)(i * 7),
+                              i % 3 ? "" : " and the shadow is synchronized");
+        lv_refr_now(disp);
+
+        lv_mem_monitor_t mon;
+        lv_mem_monitor(&mon);
+        if(mon.free_biggest_size < stat.biggest_min) stat.biggest_min = mon.free_biggest_size;
+    }
+    print_result("screens", &stat);
+
+    lv_obj_del(status);
+}
+
+/**
+ * Random allocations, reallocations and frees of 1..`CHURN_SIZE_MAX` bytes
+ */
+static void churn(void)
+{
+    stat_t stat = {0};
+    stat.biggest_min = UINT32_MAX;
+
+    void * slots[CHURN_SLOTS] = {NULL};
+    uint32_t i;
+    for(i = 0; i < CHURN_OPS; i++) {
+        uint32_t s = rnd() % CHURN_SLOTS;
+        uint32_t size = rnd() % CHURN_SIZE_MAX + 1;
+
+        uint64_t start = time_ns();
+        if(slots[s] == NULL) {
+            slots[s] = lv_mem_alloc(size);
+            if(slots[s] == NULL) stat.fail_cnt++;
+        }
+        else if(rnd() % 4 == 0) {
+            void * p = lv_mem_realloc(slots[s], size);
+            if(p) slots[s] = p;
+            else stat.fail_cnt++;
+        }
+        else {
+            lv_mem_free(slots[s]);
+            slots[s] = NULL;
+        }
+        stat_add(&stat, time_ns() - start);
+
+        if(i % 1000 == 0) {
+            lv_mem_monitor_t mon;
+            lv_mem_monitor(&mon);
+            if(mon.free_biggest_size < stat.biggest_min) stat.biggest_min = mon.free_biggest_size;
+        }
+    }
+    print_result("churn", &stat);
+
+    for(i = 0; i < CHURN_SLOTS; i++) lv_mem_free(slots[i]);
+}
+
+/**
+ * The screen of the application
+ */
+static lv_obj_t * create_tracker_screen(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+
+    lv_obj_t * label = lv_label_create(scr, NULL);
+    lv_label_set_text(label, LV_SYMBOL_WIFI);
+    lv_obj_align(label, NULL, LV_ALIGN_IN_TOP_RIGHT, -10, 6);
+
+    label = lv_label_create(scr, NULL);
+    lv_label_set_text(label, "Cafeteria");
+    lv_obj_align(label, NULL, LV_ALIGN_IN_TOP_MID, 0, 6);
+
+    label = lv_label_create(scr, NULL);
+    lv_label_set_text(label, "Due: 2021-03-04 12:30");
+    lv_obj_align(label, NULL, LV_ALIGN_IN_TOP_MID, 0, 30);
+
+    lv_obj_t * bar = lv_bar_create(scr, NULL);
+    lv_obj_set_size(bar, 280, 16);
+    lv_bar_set_value(bar, 60, LV_ANIM_OFF);
+    lv_obj_align(bar, NULL, LV_ALIGN_IN_TOP_MID, 0, 56);
+
+    lv_obj_t * btn = lv_btn_create(scr, NULL);
+    lv_obj_align(btn, NULL, LV_ALIGN_CENTER, 0, -10);
+    label = lv_label_create(btn, NULL);
+    lv_label_set_text(label, "Cleaned");
+
+    lv_obj_t * logview = lv_logview_create(scr, NULL);
+    lv_logview_set_buffer(logview, 32, 64);
+    lv_obj_set_size(logview, 300, 80);
+    lv_obj_align(logview, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -8);
+    lv_logview_add_text(logview, "Starting CleaningTracker\n");
+
+    return scr;
+}
+
+/**
+ * A settings-like screen with many small objects
+ */
+static lv_obj_t * create_list_screen(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL, NULL);
+
+    lv_obj_t * list = lv_list_create(scr, NULL);
+    lv_obj_set_size(list, 300, 220);
+    lv_obj_align(list, NULL, LV_ALIGN_CENTER, 0, 0);
+
+    uint32_t i;
+    for(i = 0; i < LIST_BTN_CNT; i++) {
+        char txt[32];
+        lv_snprintf(txt, sizeof(txt), "Room %u", (unsigned)(i + 1));
+        lv_list_add_btn(list, LV_SYMBOL_HOME, txt);
+    }
+
+    return scr;
+}
+
+static void stat_add(stat_t * stat, uint64_t ns)
+{
+    stat->sum += ns;
+    stat->cnt++;
+    if(ns > stat->max) stat->max = ns;
+}
+
+static void print_result(const char * name, const stat_t * stat)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("%-10s  %7u  %10.3f  %8.1f  %5u  %5u  %7u  %11u\n", name, (unsigned)stat->cnt,
+           (double)stat->sum / stat->cnt / 1000, (double)stat->max / 1000, (unsigned)stat->fail_cnt,
+           (unsigned)mon.frag_pct, (unsigned)mon.free_biggest_size, (unsigned)stat->biggest_min);
+}
+
+static uint32_t rnd(void)
+{
+    rnd_seed = rnd_seed * 1103515245 + 12345;
+    return (rnd_seed >> 16) & 0x7fff;
+}
+
+static void flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(color_p);
+    lv_disp_flush_ready(disp_drv);
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file lv_bench_task.c
+ * Measures the cost of `lv_task_handler()` with 10..500 tasks.
+ * The tick is simulated: every call advances it by 1 ms, so each run handles 60 seconds of tasks.
+ *
+ * make bench DEFINES="-DLV_CONF_PATH=lvgl/tests/lv_test_conf.h -DLV_BUILD_TEST -DLV_MEM_SIZE=262144"
+ * ./bench_task
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lvgl.h"
+#include <stdio.h>
+#include <time.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_CALLS 60000
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void bench(uint32_t task_cnt);
+static void bench_cb(lv_task_t * task);
+static uint64_t time_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint32_t run_cnt;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(void)
+{
+    lv_init();
+
+    printf("tasks  calls  task runs  ns/call\n");
+    bench(10);
+    bench(50);
+    bench(100);
+    bench(200);
+    bench(500);
+
+    return 0;
+}
+
+/* Referenced by lv_test_conf.h, only used with LV_TICK_CUSTOM */
+uint32_t custom_tick_get(void)
+{
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void bench(uint32_t task_cnt)
+{
+    static lv_task_t * tasks[500];
+    uint32_t i;
+
+    /*Periods of 20..500 ms spread over all priorities, as animations, input and refresh would be*/
+    for(i = 0; i < task_cnt; i++) {
+        uint32_t period = 20 + (i * 37) % 481;
+        tasks[i] = lv_task_create(bench_cb, period, (lv_task_prio_t)(LV_TASK_PRIO_LOWEST + i % 5), NULL);
+        if(tasks[i] == NULL) {
+            printf("Out of memory at %u tasks, raise LV_MEM_SIZE\n", (unsigned)i);
+            task_cnt = i;
+            break;
+        }
+    }
+
+    run_cnt = 0;
+    uint64_t start = time_ns();
+    for(i = 0; i < BENCH_CALLS; i++) {
+        lv_tick_inc(1);
+        lv_task_handler();
+    }
+    uint64_t elapsed = time_ns() - start;
+
+    printf("%5u  %5u  %9u  %7u\n", (unsigned)task_cnt, (unsigned)BENCH_CALLS, (unsigned)run_cnt,
+           (unsigned)(elapsed / BENCH_CALLS));
+
+    for(i = 0; i < task_cnt; i++) lv_task_del(tasks[i]);
+}
+
+static void bench_cb(lv_task_t * task)
+{
+    LV_UNUSED(task);
+    run_cnt++;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -13,6 +13,11 @@
 #include "lv_test_obj.h"
 #include "lv_test_style.h"
 #include "lv_test_font_loader.h"
+#include "lv_test_task.h"
+#include "lv_test_refr.h"
+#include "lv_test_glyph_cache.h"
+#include "lv_test_draw_cache.h"
+#include "lv_test_tlsf.h"
 
 /*********************
  *      DEFINES
@@ -48,6 +53,11 @@ void lv_test_core(void)
     lv_test_obj();
     lv_test_style();
     lv_test_font_loader();
+    lv_test_task();
+    lv_test_refr();
+    lv_test_glyph_cache();
+    lv_test_draw_cache();
+    lv_test_tlsf();
 }
 
 /**********************
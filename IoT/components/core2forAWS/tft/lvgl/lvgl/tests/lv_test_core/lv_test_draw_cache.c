@@ -0,0 +1,283 @@
+/**
+ * @file lv_test_draw_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_draw_cache.h"
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+#if LV_USE_OBJ_DRAW_CACHE
+static void hit_on_redraw(void);
+static void same_as_uncached(void);
+static void state_change(void);
+static void style_change(void);
+static void parent_change(void);
+static lv_obj_t * create_obj(lv_obj_t * parent);
+static void get_rect(lv_obj_t * obj, lv_draw_rect_dsc_t * dsc, bool cached);
+static void get_label(lv_obj_t * obj, lv_draw_label_dsc_t * dsc, bool cached);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_draw_cache(void)
+{
+#if LV_USE_OBJ_DRAW_CACHE
+    lv_test_print("");
+    lv_test_print("======================");
+    lv_test_print("Start draw cache tests");
+    lv_test_print("======================");
+
+    hit_on_redraw();
+    same_as_uncached();
+    state_change();
+    style_change();
+    parent_change();
+#endif
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#if LV_USE_OBJ_DRAW_CACHE
+static void hit_on_redraw(void)
+{
+    lv_test_print("");
+    lv_test_print("Resolve the styles once:");
+    lv_test_print("------------------------");
+
+    lv_obj_t * obj = create_obj(lv_scr_act());
+    lv_obj_draw_cache_stats_t stats_start;
+    lv_obj_draw_cache_stats_t stats;
+    lv_obj_get_draw_cache_stats(&stats_start);
+
+    lv_draw_rect_dsc_t first;
+    lv_draw_rect_dsc_t second;
+    get_rect(obj, &first, true);
+    get_rect(obj, &second, true);
+
+    lv_obj_get_draw_cache_stats(&stats);
+    lv_test_assert_int_eq(1, stats.miss - stats_start.miss, "Resolved on the first draw");
+    lv_test_assert_int_eq(1, stats.hit - stats_start.hit, "Copied on the second draw");
+    lv_test_assert_array_eq((uint8_t *)&first, (uint8_t *)&second, sizeof(first), "The same descriptor");
+
+    lv_obj_get_draw_cache_stats(&stats_start);
+    lv_draw_rect_dsc_t uncached;
+    get_rect(obj, &uncached, false);
+    lv_obj_get_draw_cache_stats(&stats);
+    lv_test_assert_int_eq(0, stats.miss - stats_start.miss, "No caching while disabled");
+    lv_test_assert_int_eq(0, stats.hit - stats_start.hit, "No caching while disabled");
+
+    lv_obj_del(obj);
+}
+
+static void same_as_uncached(void)
+{
+    lv_test_print("");
+    lv_test_print("Respect the caller's descriptor:");
+    lv_test_print("--------------------------------");
+
+    lv_obj_t * obj = create_obj(lv_scr_act());
+    lv_obj_set_style_local_border_width(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, 2);
+    lv_obj_set_style_local_shadow_width(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, 5);
+    lv_obj_set_style_local_text_sel_color(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_RED);
+
+    uint32_t i;
+    for(i = 0; i < 2; i++) {
+        /*Fill the cache in the first round and use it in the second*/
+        lv_draw_rect_dsc_t ref;
+        lv_draw_rect_dsc_t act;
+        lv_draw_rect_dsc_init(&ref);
+        ref.bg_opa = LV_OPA_TRANSP;
+        ref.shadow_opa = LV_OPA_TRANSP;
+        ref.bg_color = LV_COLOR_BLUE;
+        act = ref;
+        _lv_obj_disable_style_caching(obj, true);
+        lv_obj_init_draw_rect_dsc(obj, LV_OBJ_PART_MAIN, &ref);
+        _lv_obj_disable_style_caching(obj, false);
+        lv_obj_init_draw_rect_dsc(obj, LV_OBJ_PART_MAIN, &act);
+        lv_test_assert_array_eq((uint8_t *)&ref, (uint8_t *)&act, sizeof(ref), "Disabled parts are kept");
+
+        lv_draw_label_dsc_t ref_label;
+        lv_draw_label_dsc_t act_label;
+        lv_draw_label_dsc_init(&ref_label);
+        ref_label.sel_start = 1;
+        ref_label.sel_end = 3;
+        ref_label.ofs_y = 7;
+        act_label = ref_label;
+        _lv_obj_disable_style_caching(obj, true);
+        lv_obj_init_draw_label_dsc(obj, LV_OBJ_PART_MAIN, &ref_label);
+        _lv_obj_disable_style_caching(obj, false);
+        lv_obj_init_draw_label_dsc(obj, LV_OBJ_PART_MAIN, &act_label);
+        lv_test_assert_array_eq((uint8_t *)&ref_label, (uint8_t *)&act_label, sizeof(ref_label),
+                                "Selection colors and offsets");
+    }
+
+#if LV_USE_OPA_SCALE
+    lv_obj_set_style_local_opa_scale(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_50);
+    lv_draw_rect_dsc_t ref;
+    lv_draw_rect_dsc_t act;
+    get_rect(obj, &ref, false);
+    get_rect(obj, &act, true);
+    get_rect(obj, &act, true);
+    lv_test_assert_array_eq((uint8_t *)&ref, (uint8_t *)&act, sizeof(ref), "Scaled opacities");
+#endif
+
+    lv_obj_del(obj);
+}
+
+static void state_change(void)
+{
+    lv_test_print("");
+    lv_test_print("Refresh on state change:");
+    lv_test_print("------------------------");
+
+    lv_obj_t * obj = create_obj(lv_scr_act());
+    lv_obj_t * child = create_obj(obj);
+    lv_obj_set_style_local_bg_color(obj, LV_OBJ_PART_MAIN, LV_STATE_CHECKED, LV_COLOR_RED);
+    lv_obj_set_style_local_text_color(obj, LV_OBJ_PART_MAIN, LV_STATE_CHECKED, LV_COLOR_RED);
+
+    lv_draw_rect_dsc_t rect;
+    lv_draw_label_dsc_t label;
+    get_rect(obj, &rect, true);
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_GREEN, rect.bg_color, "Default state");
+    lv_test_assert_color_eq(LV_COLOR_GREEN, label.color, "Default state inherited");
+
+    lv_obj_add_state(obj, LV_STATE_CHECKED);
+    get_rect(obj, &rect, true);
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_RED, rect.bg_color, "Checked state");
+    lv_test_assert_color_eq(LV_COLOR_RED, label.color, "Checked state inherited");
+
+    lv_obj_clear_state(obj, LV_STATE_CHECKED);
+    get_rect(obj, &rect, true);
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_GREEN, rect.bg_color, "Back to default state");
+    lv_test_assert_color_eq(LV_COLOR_GREEN, label.color, "Back to default state inherited");
+
+    lv_obj_del(obj);
+}
+
+static void style_change(void)
+{
+    lv_test_print("");
+    lv_test_print("Refresh on style change:");
+    lv_test_print("------------------------");
+
+    lv_obj_t * obj = create_obj(lv_scr_act());
+    lv_draw_rect_dsc_t rect;
+    get_rect(obj, &rect, true);
+    lv_test_assert_color_eq(LV_COLOR_GREEN, rect.bg_color, "Local style");
+
+    lv_obj_set_style_local_bg_color(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_BLUE);
+    get_rect(obj, &rect, true);
+    lv_test_assert_color_eq(LV_COLOR_BLUE, rect.bg_color, "Local style changed");
+
+    static lv_style_t style;
+    lv_style_init(&style);
+    lv_style_set_radius(&style, LV_STATE_DEFAULT, 12);
+    lv_obj_add_style(obj, LV_OBJ_PART_MAIN, &style);
+    get_rect(obj, &rect, true);
+    lv_test_assert_int_eq(12, rect.radius, "Style added");
+
+    lv_style_set_radius(&style, LV_STATE_DEFAULT, 3);
+    lv_obj_report_style_mod(&style);
+    get_rect(obj, &rect, true);
+    lv_test_assert_int_eq(3, rect.radius, "Style modified");
+
+    lv_obj_remove_style(obj, LV_OBJ_PART_MAIN, &style);
+    get_rect(obj, &rect, true);
+    lv_test_assert_int_eq(0, rect.radius, "Style removed");
+
+    lv_obj_del(obj);
+    lv_style_reset(&style);
+}
+
+static void parent_change(void)
+{
+    lv_test_print("");
+    lv_test_print("Refresh on parent change:");
+    lv_test_print("-------------------------");
+
+    lv_obj_t * parent1 = create_obj(lv_scr_act());
+    lv_obj_t * parent2 = create_obj(lv_scr_act());
+    lv_obj_t * child = create_obj(parent1);
+    lv_obj_set_style_local_text_color(parent2, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_BLUE);
+
+    lv_draw_label_dsc_t label;
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_GREEN, label.color, "Inherited from the first parent");
+
+    lv_obj_set_parent(child, parent2);
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_BLUE, label.color, "Inherited from the new parent");
+
+    lv_obj_set_style_local_text_color(parent2, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_RED);
+    get_label(child, &label, true);
+    lv_test_assert_color_eq(LV_COLOR_RED, label.color, "The parent's style changed");
+
+    lv_obj_del(parent1);
+    lv_obj_del(parent2);
+}
+
+/**
+ * Create an object without theme styles. The background and the inherited text color are green.
+ */
+static lv_obj_t * create_obj(lv_obj_t * parent)
+{
+    lv_obj_t * obj = lv_obj_create(parent, NULL);
+    lv_obj_reset_style_list(obj, LV_OBJ_PART_MAIN);
+    if(parent == lv_scr_act()) {
+        lv_obj_set_style_local_bg_opa(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_COVER);
+        lv_obj_set_style_local_bg_color(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_GREEN);
+        lv_obj_set_style_local_text_color(obj, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_GREEN);
+    }
+    return obj;
+}
+
+static void get_rect(lv_obj_t * obj, lv_draw_rect_dsc_t * dsc, bool cached)
+{
+    lv_draw_rect_dsc_init(dsc);
+    if(!cached) _lv_obj_disable_style_caching(obj, true);
+    lv_obj_init_draw_rect_dsc(obj, LV_OBJ_PART_MAIN, dsc);
+    if(!cached) _lv_obj_disable_style_caching(obj, false);
+}
+
+static void get_label(lv_obj_t * obj, lv_draw_label_dsc_t * dsc, bool cached)
+{
+    lv_draw_label_dsc_init(dsc);
+    if(!cached) _lv_obj_disable_style_caching(obj, true);
+    lv_obj_init_draw_label_dsc(obj, LV_OBJ_PART_MAIN, dsc);
+    if(!cached) _lv_obj_disable_style_caching(obj, false);
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file lv_test_glyph_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_glyph_cache.h"
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BITMAP_MAX  1024
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+#if LV_FONT_MONTSERRAT_28_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+static void hit_and_miss(void);
+static void keep_recently_used(void);
+static void invalidate(void);
+static uint32_t bitmap_size(uint32_t letter);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_glyph_cache(void)
+{
+#if LV_FONT_MONTSERRAT_28_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+    lv_test_print("");
+    lv_test_print("=======================");
+    lv_test_print("Start glyph cache tests");
+    lv_test_print("=======================");
+
+    hit_and_miss();
+    keep_recently_used();
+    invalidate();
+#endif
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#if LV_FONT_MONTSERRAT_28_COMPRESSED && LV_FONT_GLYPH_CACHE_SIZE
+static void hit_and_miss(void)
+{
+    lv_test_print("");
+    lv_test_print("Decompress a glyph once:");
+    lv_test_print("------------------------");
+
+    static uint8_t first[BITMAP_MAX];
+    lv_font_glyph_cache_stats_t stats;
+    lv_font_glyph_cache_invalidate(NULL);
+    lv_font_glyph_cache_get_stats(&stats);
+    lv_test_assert_int_eq(0, stats.entries, "The cache is empty");
+
+    uint32_t size = bitmap_size('A');
+    const uint8_t * bmp = lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+    _lv_memcpy(first, bmp, size);
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+
+    lv_font_glyph_cache_stats_t stats2;
+    lv_font_glyph_cache_get_stats(&stats2);
+    lv_test_assert_int_eq(1, stats2.miss - stats.miss, "The first call decompressed");
+    lv_test_assert_int_eq(1, stats2.hit - stats.hit, "The second call hit");
+    lv_test_assert_int_eq(1, stats2.entries, "One glyph is cached");
+
+    /*Fill the cache with an other glyph of each letter*/
+    uint32_t letter;
+    for(letter = '0'; letter <= 'z'; letter++) {
+        lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, letter);
+    }
+    lv_font_glyph_cache_get_stats(&stats2);
+    lv_test_assert_int_gt(0, stats2.evicted, "Glyphs were dropped");
+    lv_test_assert_int_lt(LV_FONT_GLYPH_CACHE_SIZE + 1, stats2.used, "The cache stays in its size");
+
+    lv_font_glyph_cache_invalidate(NULL);
+    bmp = lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+    lv_test_assert_array_eq(first, bmp, size, "Decompressed again it is the same");
+}
+
+static void keep_recently_used(void)
+{
+    lv_test_print("");
+    lv_test_print("Drop the least recently used:");
+    lv_test_print("-----------------------------");
+
+    lv_font_glyph_cache_invalidate(NULL);
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'B');
+
+    /*Use 'A' between each new glyph until the cache overflows*/
+    uint32_t letter;
+    for(letter = '0'; letter <= 'z'; letter++) {
+        if(letter == 'A' || letter == 'B') continue;
+        lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+        lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, letter);
+    }
+
+    lv_font_glyph_cache_stats_t stats;
+    lv_font_glyph_cache_stats_t stats2;
+    lv_font_glyph_cache_get_stats(&stats);
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+    lv_font_glyph_cache_get_stats(&stats2);
+    lv_test_assert_int_eq(1, stats2.hit - stats.hit, "The glyph used often is still cached");
+
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'B');
+    lv_font_glyph_cache_get_stats(&stats);
+    lv_test_assert_int_eq(1, stats.miss - stats2.miss, "The glyph used once was dropped");
+}
+
+static void invalidate(void)
+{
+    lv_test_print("");
+    lv_test_print("Drop the glyphs of a font:");
+    lv_test_print("--------------------------");
+
+    lv_font_get_glyph_bitmap(&lv_font_montserrat_28_compressed, 'A');
+    lv_font_glyph_cache_invalidate(&lv_font_montserrat_28_compressed);
+
+    lv_font_glyph_cache_stats_t stats;
+    lv_font_glyph_cache_get_stats(&stats);
+    lv_test_assert_int_eq(0, stats.entries, "No glyph is cached");
+    lv_test_assert_int_eq(0, stats.used, "No memory is used");
+}
+
+static uint32_t bitmap_size(uint32_t letter)
+{
+    lv_font_glyph_dsc_t dsc;
+    lv_font_get_glyph_dsc(&lv_font_montserrat_28_compressed, &dsc, letter, 0);
+    return (dsc.box_w * dsc.box_h * 4 + 7) / 8;     /*3 bpp is decompressed to 4 bpp*/
+}
+#endif
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file lv_test_refr.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_refr.h"
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void join_overlapping(void);
+static void join_close(void);
+static void keep_far(void);
+static void join_chain(void);
+static void overflow(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_area_t areas[4];
+static uint8_t joined[4];
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_refr(void)
+{
+    lv_test_print("");
+    lv_test_print("===================");
+    lv_test_print("Start lv_refr tests");
+    lv_test_print("===================");
+
+    join_overlapping();
+    join_close();
+    keep_far();
+    join_chain();
+    overflow();
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void join_overlapping(void)
+{
+    lv_test_print("");
+    lv_test_print("Join overlapping areas:");
+    lv_test_print("-----------------------");
+
+    _lv_memset_00(joined, sizeof(joined));
+    lv_area_set(&areas[0], 10, 50, 109, 99);
+    lv_area_set(&areas[1], 10, 10, 109, 69);
+    lv_area_set(&areas[2], 30, 60, 39, 69);
+    _lv_refr_join_areas(areas, joined, 3);
+
+    lv_test_assert_int_eq(10, areas[0].y1, "The areas are sorted by their top");
+    lv_test_assert_int_eq(0, joined[0], "The first area is kept");
+    lv_test_assert_int_eq(1, joined[1], "The overlapping area is joined");
+    lv_test_assert_int_eq(1, joined[2], "The contained area is joined");
+    lv_test_assert_int_eq(100 * 90, lv_area_get_size(&areas[0]), "The kept area is the bounding box");
+}
+
+static void join_close(void)
+{
+    lv_test_print("");
+    lv_test_print("Join areas with a small gap:");
+    lv_test_print("----------------------------");
+
+    /*50x22 joined vs. 2 * 50x10 + cost*/
+    _lv_memset_00(joined, sizeof(joined));
+    lv_area_set(&areas[0], 0, 0, 49, 9);
+    lv_area_set(&areas[1], 0, 12, 49, 21);
+    _lv_refr_join_areas(areas, joined, 2);
+
+    lv_test_assert_int_eq(1, joined[1], "Two rows apart areas are joined");
+    lv_test_assert_int_eq(21, areas[0].y2, "The joined area covers both");
+}
+
+static void keep_far(void)
+{
+    lv_test_print("");
+    lv_test_print("Keep distant areas:");
+    lv_test_print("-------------------");
+
+    _lv_memset_00(joined, sizeof(joined));
+    lv_area_set(&areas[0], 0, 0, 19, 19);
+    lv_area_set(&areas[1], 100, 100, 119, 119);
+    lv_area_set(&areas[2], 200, 0, 219, 19);
+    _lv_refr_join_areas(areas, joined, 3);
+
+    lv_test_assert_int_eq(0, joined[0] + joined[1] + joined[2], "No area is joined");
+}
+
+static void join_chain(void)
+{
+    lv_test_print("");
+    lv_test_print("Join after an other join:");
+    lv_test_print("-------------------------");
+
+    /*The bottom halves pay off together and then with the top*/
+    _lv_memset_00(joined, sizeof(joined));
+    lv_area_set(&areas[0], 0, 0, 99, 49);
+    lv_area_set(&areas[1], 0, 50, 49, 99);
+    lv_area_set(&areas[2], 50, 50, 99, 99);
+    _lv_refr_join_areas(areas, joined, 3);
+
+    lv_test_assert_int_eq(1, joined[1], "The bottom left area is joined");
+    lv_test_assert_int_eq(1, joined[2], "The bottom right area is joined");
+    lv_test_assert_int_eq(100 * 100, lv_area_get_size(&areas[0]), "The kept area is the bounding box");
+}
+
+static void overflow(void)
+{
+    lv_test_print("");
+    lv_test_print("Keep redrawing small when the buffer is full:");
+    lv_test_print("---------------------------------------------");
+
+    lv_disp_t * disp = lv_disp_get_default();
+    _lv_inv_area(disp, NULL);
+
+    /*More areas than the buffer can store, on a grid fitting the smallest test display*/
+    lv_area_t a;
+    uint32_t i;
+    for(i = 0; i < LV_INV_BUF_SIZE + 8; i++) {
+        lv_area_set(&a, (i % 8) * 16, (i / 8) * 12, (i % 8) * 16 + 3, (i / 8) * 12 + 3);
+        _lv_inv_area(disp, &a);
+    }
+
+    lv_test_assert_int_eq(LV_INV_BUF_SIZE, lv_disp_get_inv_buf_size(disp), "The buffer is full");
+
+    uint32_t covered = 0;
+    uint32_t size_sum = 0;
+    for(i = 0; i < LV_INV_BUF_SIZE + 8; i++) {
+        lv_area_set(&a, (i % 8) * 16, (i / 8) * 12, (i % 8) * 16 + 3, (i / 8) * 12 + 3);
+        uint32_t j;
+        for(j = 0; j < LV_INV_BUF_SIZE; j++) {
+            if(_lv_area_is_in(&a, &disp->inv_areas[j], 0)) {
+                covered++;
+                break;
+            }
+        }
+    }
+    for(i = 0; i < LV_INV_BUF_SIZE; i++) size_sum += lv_area_get_size(&disp->inv_areas[i]);
+
+    lv_test_assert_int_eq(LV_INV_BUF_SIZE + 8, covered, "Every invalidated area is kept");
+    lv_test_assert_int_lt(2000, size_sum, "Not the whole screen is redrawn");
+
+    _lv_inv_area(disp, NULL);
+}
+
+#endif
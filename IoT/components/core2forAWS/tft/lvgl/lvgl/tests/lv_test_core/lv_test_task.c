@@ -0,0 +1,257 @@
+/**
+ * @file lv_test_task.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_task.h"
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define RUN_LOG_SIZE 16
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void priority_order(void);
+static void period_and_ready(void);
+static void once_per_call(void);
+static void delete_and_repeat(void);
+static void change_priority(void);
+static void many_tasks(void);
+static void log_cb(lv_task_t * task);
+static void count_cb(lv_task_t * task);
+static void del_self_cb(lv_task_t * task);
+static void clear_log(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uintptr_t run_log[RUN_LOG_SIZE];
+static uint32_t run_cnt;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_task(void)
+{
+    lv_test_print("");
+    lv_test_print("===================");
+    lv_test_print("Start lv_task tests");
+    lv_test_print("===================");
+
+    priority_order();
+    period_and_ready();
+    once_per_call();
+    delete_and_repeat();
+    change_priority();
+    many_tasks();
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void priority_order(void)
+{
+    lv_test_print("");
+    lv_test_print("Run due tasks by priority:");
+    lv_test_print("--------------------------");
+
+    lv_task_t * low = lv_task_create(log_cb, 1000, LV_TASK_PRIO_LOW, (void *)1);
+    lv_task_t * high = lv_task_create(log_cb, 1000, LV_TASK_PRIO_HIGH, (void *)3);
+    lv_task_t * mid = lv_task_create(log_cb, 1000, LV_TASK_PRIO_MID, (void *)2);
+    lv_task_t * highest = lv_task_create(log_cb, 1000, LV_TASK_PRIO_HIGHEST, (void *)4);
+
+    clear_log();
+    lv_task_handler();
+    lv_test_assert_int_eq(0, run_cnt, "No task runs before its period");
+
+    lv_task_ready(low);
+    lv_task_ready(mid);
+    lv_task_ready(high);
+    lv_task_ready(highest);
+    lv_task_handler();
+    lv_test_assert_int_eq(4, run_cnt, "All ready tasks ran");
+    lv_test_assert_int_eq(4, run_log[0], "The highest priority ran first");
+    lv_test_assert_int_eq(3, run_log[1], "The high priority ran second");
+    lv_test_assert_int_eq(2, run_log[2], "The mid priority ran third");
+    lv_test_assert_int_eq(1, run_log[3], "The low priority ran last");
+
+    lv_task_del(low);
+    lv_task_del(mid);
+    lv_task_del(high);
+    lv_task_del(highest);
+}
+
+static void period_and_ready(void)
+{
+    lv_test_print("");
+    lv_test_print("Report the time to the next task:");
+    lv_test_print("---------------------------------");
+
+    lv_task_t * slow = lv_task_create(log_cb, 5000, LV_TASK_PRIO_LOWEST, (void *)1);
+    lv_task_t * fast = lv_task_create(log_cb, 2000, LV_TASK_PRIO_HIGH, (void *)2);
+
+    clear_log();
+    uint32_t next = lv_task_handler();
+    lv_test_assert_int_eq(0, run_cnt, "No task ran");
+    lv_test_assert_int_lt(2001, next, "The time to the next run is at most the shortest period");
+    lv_test_assert_int_gt(1000, next, "The time to the next run is near the shortest period");
+
+    lv_task_ready(slow);
+    next = lv_task_handler();
+    lv_test_assert_int_eq(1, run_cnt, "The task made ready ran");
+    lv_test_assert_int_eq(1, run_log[0], "It was the slow task");
+    lv_test_assert_int_lt(2001, next, "The fast task is still the next one");
+
+    lv_task_set_period(fast, 10000);
+    next = lv_task_handler();
+    lv_test_assert_int_gt(2000, next, "A longer period moves the deadline");
+
+    lv_task_reset(slow);
+    lv_task_set_prio(fast, LV_TASK_PRIO_OFF);
+    next = lv_task_handler();
+    lv_test_assert_int_gt(4000, next, "A stopped task is not waited for");
+
+    lv_task_del(slow);
+    lv_task_del(fast);
+}
+
+static void once_per_call(void)
+{
+    lv_test_print("");
+    lv_test_print("Run a task at most once per call:");
+    lv_test_print("---------------------------------");
+
+    lv_task_t * busy = lv_task_create(log_cb, 0, LV_TASK_PRIO_MID, (void *)1);
+    lv_task_t * other = lv_task_create(log_cb, 0, LV_TASK_PRIO_LOW, (void *)2);
+
+    clear_log();
+    uint32_t next = lv_task_handler();
+    lv_test_assert_int_eq(2, run_cnt, "Both tasks with 0 period ran once");
+    lv_test_assert_int_eq(0, next, "They are due again right away");
+
+    lv_task_handler();
+    lv_test_assert_int_eq(4, run_cnt, "And ran once more in the next call");
+
+    lv_task_del(busy);
+    lv_task_del(other);
+}
+
+static void delete_and_repeat(void)
+{
+    lv_test_print("");
+    lv_test_print("Delete tasks while they run:");
+    lv_test_print("----------------------------");
+
+    lv_task_t * once = lv_task_create(log_cb, 0, LV_TASK_PRIO_MID, (void *)1);
+    lv_task_set_repeat_count(once, 1);
+    lv_task_create(del_self_cb, 0, LV_TASK_PRIO_HIGH, (void *)2);
+    lv_task_t * stays = lv_task_create(log_cb, 0, LV_TASK_PRIO_LOW, (void *)3);
+
+    clear_log();
+    lv_task_handler();
+    lv_test_assert_int_eq(3, run_cnt, "All three tasks ran");
+
+    lv_task_handler();
+    lv_test_assert_int_eq(4, run_cnt, "Only the task left ran again");
+    lv_test_assert_int_eq(3, run_log[3], "It was the remaining task");
+
+    lv_task_del(stays);
+}
+
+static void change_priority(void)
+{
+    lv_test_print("");
+    lv_test_print("Change the priority of tasks:");
+    lv_test_print("-----------------------------");
+
+    lv_task_t * a = lv_task_create(log_cb, 1000, LV_TASK_PRIO_OFF, (void *)1);
+    lv_task_t * b = lv_task_create(log_cb, 1000, LV_TASK_PRIO_MID, (void *)2);
+
+    clear_log();
+    lv_task_ready(a);
+    lv_task_ready(b);
+    lv_task_handler();
+    lv_test_assert_int_eq(1, run_cnt, "A task created stopped does not run");
+
+    lv_task_set_prio(a, LV_TASK_PRIO_HIGHEST);
+    lv_task_set_prio(b, LV_TASK_PRIO_LOWEST);
+    lv_task_ready(a);
+    lv_task_ready(b);
+    lv_task_handler();
+    lv_test_assert_int_eq(3, run_cnt, "Both tasks ran after the change");
+    lv_test_assert_int_eq(1, run_log[1], "The task raised to highest ran first");
+    lv_test_assert_int_eq(2, run_log[2], "The task lowered to lowest ran last");
+
+    lv_task_del(a);
+    lv_task_del(b);
+}
+
+static void many_tasks(void)
+{
+    lv_test_print("");
+    lv_test_print("Run only the due ones of many tasks:");
+    lv_test_print("------------------------------------");
+
+    lv_task_t * tasks[20];
+    uint32_t i;
+    for(i = 0; i < 20; i++) {
+        tasks[i] = lv_task_create(count_cb, 1000 + i * 100, (lv_task_prio_t)(LV_TASK_PRIO_LOWEST + i % 5), NULL);
+    }
+
+    run_cnt = 0;
+    for(i = 0; i < 20; i += 3) lv_task_ready(tasks[i]);
+    lv_task_handler();
+    lv_test_assert_int_eq(7, run_cnt, "Every made ready task ran once");
+
+    for(i = 0; i < 20; i += 2) lv_task_del(tasks[i]);
+    for(i = 1; i < 20; i += 2) lv_task_ready(tasks[i]);
+    lv_task_handler();
+    lv_test_assert_int_eq(17, run_cnt, "The tasks left ran after deleting every second");
+
+    for(i = 1; i < 20; i += 2) lv_task_del(tasks[i]);
+}
+
+static void log_cb(lv_task_t * task)
+{
+    if(run_cnt < RUN_LOG_SIZE) run_log[run_cnt] = (uintptr_t)task->user_data;
+    run_cnt++;
+}
+
+static void count_cb(lv_task_t * task)
+{
+    LV_UNUSED(task);
+    run_cnt++;
+}
+
+static void del_self_cb(lv_task_t * task)
+{
+    log_cb(task);
+    lv_task_del(task);
+}
+
+static void clear_log(void)
+{
+    run_cnt = 0;
+    _lv_memset_00(run_log, sizeof(run_log));
+}
+
+#endif
@@ -0,0 +1,303 @@
+/**
+ * @file lv_test_tlsf.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_tlsf.h"
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+#define POOL_SIZE   (8 * 1024)
+#define SLOT_CNT    32
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void create(void);
+static void join_free_blocks(void);
+static void resize_in_place(void);
+static void out_of_memory(void);
+static void random_churn(void);
+static void mem_api(void);
+static lv_tlsf_t * create_pool(lv_tlsf_monitor_t * mon_p);
+static uint32_t rnd(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint64_t pool[POOL_SIZE / sizeof(uint64_t)];
+static uint32_t rnd_seed;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_tlsf(void)
+{
+    lv_test_print("");
+    lv_test_print("===================");
+    lv_test_print("Start lv_tlsf tests");
+    lv_test_print("===================");
+
+    create();
+    join_free_blocks();
+    resize_in_place();
+    out_of_memory();
+    random_churn();
+    mem_api();
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void create(void)
+{
+    lv_test_print("");
+    lv_test_print("Create a pool:");
+    lv_test_print("--------------");
+
+    lv_test_assert_ptr_eq(NULL, lv_tlsf_create(pool, 16), "Too small area");
+
+    /*Unaligned start*/
+    lv_tlsf_t * tlsf = lv_tlsf_create((uint8_t *)pool + 1, POOL_SIZE - 1);
+    lv_test_assert_true(tlsf != NULL, "Unaligned area");
+    lv_test_assert_int_eq(0, (uintptr_t)tlsf % sizeof(void *), "Descriptor aligned");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Unaligned area consistent");
+
+    lv_tlsf_monitor_t mon;
+    tlsf = create_pool(&mon);
+    lv_test_assert_int_eq(1, mon.free_cnt, "One free block");
+    lv_test_assert_int_eq(0, mon.used_cnt, "No used block");
+    lv_test_assert_int_eq(mon.free_size, mon.free_biggest_size, "The free block is the biggest");
+    lv_test_assert_int_lt(POOL_SIZE, mon.total_size, "Descriptor not in the blocks");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent after create");
+}
+
+static void join_free_blocks(void)
+{
+    lv_test_print("");
+    lv_test_print("Join the free blocks:");
+    lv_test_print("---------------------");
+
+    lv_tlsf_monitor_t mon_start;
+    lv_tlsf_t * tlsf = create_pool(&mon_start);
+
+    uint8_t * a = lv_tlsf_alloc(tlsf, 100);
+    uint8_t * b = lv_tlsf_alloc(tlsf, 200);
+    uint8_t * c = lv_tlsf_alloc(tlsf, 300);
+    lv_test_assert_int_eq(0, (uintptr_t)a % sizeof(void *), "Allocation aligned");
+    lv_test_assert_int_gt(99, lv_tlsf_get_size(a), "Allocation is big enough");
+    lv_test_assert_true(a + lv_tlsf_get_size(a) <= b, "Allocations don't overlap");
+
+    lv_tlsf_monitor_t mon;
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(3, mon.used_cnt, "Three used blocks");
+    lv_test_assert_int_eq(1, mon.free_cnt, "The rest is one free block");
+    lv_test_assert_int_eq(mon.used_size, mon.used_max, "Maximum follows the usage");
+
+    lv_tlsf_free(tlsf, b);
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(2, mon.free_cnt, "Freed block in the middle");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent with a hole");
+
+    /*Fits into the hole of `b`*/
+    uint8_t * d = lv_tlsf_alloc(tlsf, 150);
+    lv_test_assert_ptr_eq(b, d, "Hole reused");
+    lv_tlsf_free(tlsf, d);
+
+    lv_tlsf_free(tlsf, a);
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(2, mon.free_cnt, "Joined with the next block");
+
+    lv_tlsf_free(tlsf, c);
+    lv_tlsf_free(tlsf, NULL);
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(1, mon.free_cnt, "Joined with the previous and the next block");
+    lv_test_assert_int_eq(0, mon.used_cnt, "Everything freed");
+    lv_test_assert_int_eq(0, mon.used_size, "No used size");
+    lv_test_assert_int_gt(0, mon.used_max, "Maximum kept");
+    lv_test_assert_int_eq(mon_start.free_size, mon.free_size, "The whole pool is free again");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent after free");
+}
+
+static void resize_in_place(void)
+{
+    lv_test_print("");
+    lv_test_print("Resize in place:");
+    lv_test_print("----------------");
+
+    lv_tlsf_t * tlsf = create_pool(NULL);
+
+    uint8_t * a = lv_tlsf_alloc(tlsf, 64);
+    uint8_t * b = lv_tlsf_alloc(tlsf, 64);
+    _lv_memset(a, 0x5a, 64);
+
+    lv_test_assert_true(!lv_tlsf_resize(tlsf, a, 256), "Can't grow into a used block");
+    lv_test_assert_int_eq(64, lv_tlsf_get_size(a), "Unchanged after a failed resize");
+
+    lv_tlsf_free(tlsf, b);
+    lv_test_assert_true(lv_tlsf_resize(tlsf, a, 256), "Grow into the free block");
+    lv_test_assert_int_gt(255, lv_tlsf_get_size(a), "Grown");
+    lv_test_assert_int_eq(0x5a, a[63], "Content kept");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent after grow");
+
+    lv_test_assert_true(lv_tlsf_resize(tlsf, a, 32), "Shrink");
+    lv_test_assert_int_eq(32, lv_tlsf_get_size(a), "Shrunk");
+    lv_test_assert_ptr_eq(a + 32 + 2 * sizeof(void *), lv_tlsf_alloc(tlsf, 16), "Rest given back");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent after shrink");
+
+    lv_test_assert_true(!lv_tlsf_resize(tlsf, a, POOL_SIZE), "Can't grow over the pool");
+}
+
+static void out_of_memory(void)
+{
+    lv_test_print("");
+    lv_test_print("Run out of memory:");
+    lv_test_print("------------------");
+
+    lv_tlsf_monitor_t mon;
+    lv_tlsf_t * tlsf = create_pool(&mon);
+
+    lv_test_assert_ptr_eq(NULL, lv_tlsf_alloc(tlsf, 0), "Zero size");
+    lv_test_assert_ptr_eq(NULL, lv_tlsf_alloc(tlsf, POOL_SIZE), "Bigger than the pool");
+
+    /*Small sizes have exact size classes so every big enough block is found*/
+    uint32_t cnt = 0;
+    while(lv_tlsf_alloc(tlsf, 48) != NULL) cnt++;
+    lv_test_assert_int_gt(0, cnt, "Allocated until full");
+
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(cnt, mon.used_cnt, "Failed allocations don't use blocks");
+    lv_test_assert_int_lt(48, mon.free_biggest_size, "No big enough block left");
+    lv_test_assert_int_eq(LV_RES_OK, lv_tlsf_check(tlsf), "Consistent when full");
+}
+
+/**
+ * Allocate, resize and free random sizes and check the content and the pool after every step
+ */
+static void random_churn(void)
+{
+    lv_test_print("");
+    lv_test_print("Random allocations:");
+    lv_test_print("-------------------");
+
+    lv_tlsf_monitor_t mon_start;
+    lv_tlsf_t * tlsf = create_pool(&mon_start);
+
+    uint8_t * slots[SLOT_CNT] = {NULL};
+    uint32_t sizes[SLOT_CNT] = {0};
+    bool ok = true;
+    uint32_t fail_cnt = 0;
+    uint32_t i;
+    rnd_seed = 1;
+    for(i = 0; i < 5000 && ok; i++) {
+        uint32_t s = rnd() % SLOT_CNT;
+
+        /*The content must be unchanged by the other blocks*/
+        uint32_t j;
+        for(j = 0; j < sizes[s]; j++) {
+            if(slots[s][j] != (uint8_t)s) ok = false;
+        }
+
+        if(slots[s] == NULL) {
+            sizes[s] = rnd() % 400 + 1;
+            slots[s] = lv_tlsf_alloc(tlsf, sizes[s]);
+            if(slots[s] == NULL) {
+                sizes[s] = 0;
+                fail_cnt++;
+            }
+        }
+        else if(rnd() % 4 == 0) {
+            uint32_t new_size = rnd() % 400 + 1;
+            if(lv_tlsf_resize(tlsf, slots[s], new_size)) sizes[s] = new_size;
+        }
+        else {
+            lv_tlsf_free(tlsf, slots[s]);
+            slots[s] = NULL;
+            sizes[s] = 0;
+        }
+
+        if(slots[s]) _lv_memset(slots[s], (uint8_t)s, sizes[s]);
+        if(lv_tlsf_check(tlsf) != LV_RES_OK) ok = false;
+    }
+    lv_test_assert_true(ok, "Content and pool consistent after every step");
+    lv_test_assert_int_lt(5000 / 10, fail_cnt, "Pool rarely full");
+
+    for(i = 0; i < SLOT_CNT; i++) lv_tlsf_free(tlsf, slots[i]);
+
+    lv_tlsf_monitor_t mon;
+    lv_tlsf_monitor(tlsf, &mon);
+    lv_test_assert_int_eq(1, mon.free_cnt, "One free block at the end");
+    lv_test_assert_int_eq(mon_start.free_size, mon.free_size, "The whole pool is free at the end");
+}
+
+/**
+ * `lv_mem` reports the same on both allocators
+ */
+static void mem_api(void)
+{
+    lv_test_print("");
+    lv_test_print("lv_mem on the selected allocator:");
+    lv_test_print("---------------------------------");
+
+    lv_mem_monitor_t mon_start;
+    lv_mem_monitor(&mon_start);
+
+    uint8_t * p = lv_mem_alloc(40);
+    lv_test_assert_int_gt(39, _lv_mem_get_size(p), "Size of an allocation");
+    _lv_memset(p, 0x33, 40);
+    p = lv_mem_realloc(p, 400);
+    lv_test_assert_int_gt(399, _lv_mem_get_size(p), "Size after realloc");
+    lv_test_assert_int_eq(0x33, p[39], "Content kept by realloc");
+    lv_test_assert_int_eq(LV_RES_OK, lv_mem_test(), "Consistent after realloc");
+
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    lv_test_assert_int_lt(mon_start.free_size, mon.free_size, "Free size reduced");
+    lv_test_assert_true(mon.free_size < mon.total_size, "Free size below the total");
+#endif
+
+    lv_mem_free(p);
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor(&mon);
+    lv_test_assert_int_eq(mon_start.free_size, mon.free_size, "Free size restored");
+#endif
+    lv_test_assert_int_eq(LV_RES_OK, lv_mem_test(), "Consistent after free");
+}
+
+/**
+ * Create a pool in `pool`
+ * @param mon_p if not NULL the usage of the new pool is stored here
+ */
+static lv_tlsf_t * create_pool(lv_tlsf_monitor_t * mon_p)
+{
+    lv_tlsf_t * tlsf = lv_tlsf_create(pool, POOL_SIZE);
+    if(mon_p) lv_tlsf_monitor(tlsf, mon_p);
+    return tlsf;
+}
+
+static uint32_t rnd(void)
+{
+    rnd_seed = rnd_seed * 1103515245 + 12345;
+    return (rnd_seed >> 16) & 0x7fff;
+}
+
+#endif
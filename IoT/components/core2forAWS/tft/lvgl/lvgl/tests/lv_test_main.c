@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "lv_test_core/lv_test_core.h"
 #include "lv_test_widgets/lv_test_label.h"
+#include "lv_test_widgets/lv_test_logview.h"
 
 #if LV_BUILD_TEST
 #include <sys/time.h>
@@ -21,6 +22,7 @@ int main(void)
 
     lv_test_core();
     lv_test_label();
+    lv_test_logview();
 
     printf("Exit with success!\n");
     return 0;
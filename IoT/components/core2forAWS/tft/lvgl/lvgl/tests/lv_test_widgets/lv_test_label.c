@@ -24,10 +24,18 @@
  *  STATIC PROTOTYPES
  **********************/
 static void create_copy(void);
+#if LV_USE_LABEL && LV_LABEL_LINE_CACHE
+static void line_cache(void);
+static void check_layout(lv_obj_t * label, const char * s);
+static lv_design_res_t design_uncached(lv_obj_t * label, const lv_area_t * clip_area, lv_design_mode_t mode);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_USE_LABEL && LV_LABEL_LINE_CACHE
+static lv_color_t cached_fb[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+#endif
 
 /**********************
  *      MACROS
@@ -46,6 +54,9 @@ void lv_test_label(void)
 
 #if LV_USE_LABEL
     create_copy();
+#if LV_LABEL_LINE_CACHE
+    line_cache();
+#endif
 #else
     lv_test_print("Skip label test: LV_USE_LABEL == 0");
 #endif
@@ -66,4 +77,128 @@ static void create_copy(void)
     lv_test_assert_img_eq("lv_test_img32_label_1.png", "Create a label and leave the default settings");
 #endif
 }
+
+#if LV_LABEL_LINE_CACHE
+static void line_cache(void)
+{
+    lv_test_print("");
+    lv_test_print("Cache the line breaks");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    lv_obj_t * label = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_set_style_local_pad_all(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_BREAK);
+    lv_obj_set_width(label, 120);
+    lv_label_set_text(label, "A long line which needs to be wrapped\nshort\n\nand another long line at the end\n");
+    check_layout(label, "Initial text");
+
+    lv_label_set_text(label, "Other text with different line breaks, wider than the label");
+    check_layout(label, "Text change");
+
+    lv_label_ins_text(label, 5, "inserted\n");
+    check_layout(label, "Text insertion");
+
+    lv_obj_set_width(label, 70);
+    check_layout(label, "Width change");
+
+    lv_obj_set_style_local_text_letter_space(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, 4);
+    check_layout(label, "Letter space change");
+
+    lv_obj_set_style_local_text_font(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, &lv_font_montserrat_22);
+    check_layout(label, "Font change");
+
+    lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
+    check_layout(label, "Align change");
+
+    lv_label_set_long_mode(label, LV_LABEL_LONG_EXPAND);
+    check_layout(label, "Long mode change");
+
+    /*The size, the letter positions and the drawing have to share the line breaks of an expanding label*/
+    lv_label_line_cache_stats_t before;
+    lv_label_line_cache_stats_t after;
+    lv_label_line_cache_get_stats(&before);
+
+    lv_point_t p;
+    lv_label_get_letter_pos(label, 10, &p);
+    lv_label_get_letter_on(label, &p);
+    lv_obj_invalidate(label);
+    lv_refr_now(NULL);
+
+    lv_label_line_cache_get_stats(&after);
+    lv_test_assert_int_eq(before.miss, after.miss, "No line breaking again on an expanding label");
+    lv_test_assert_int_gt(before.hit, after.hit, "Line cache hits on an expanding label");
+
+    lv_obj_del(label);
+}
+
+/**
+ * Compare the size, the letter positions and the drawing of a label with the ones calculated without the cache
+ */
+static void check_layout(lv_obj_t * label, const char * s)
+{
+    lv_label_ext_t * ext = lv_obj_get_ext_attr(label);
+    const char * txt = lv_label_get_text(label);
+    const lv_font_t * font = lv_obj_get_style_text_font(label, LV_LABEL_PART_MAIN);
+    lv_style_int_t line_space = lv_obj_get_style_text_line_space(label, LV_LABEL_PART_MAIN);
+    lv_style_int_t letter_space = lv_obj_get_style_text_letter_space(label, LV_LABEL_PART_MAIN);
+    lv_coord_t line_h = lv_font_get_line_height(font) + line_space;
+    lv_txt_flag_t flag = ext->long_mode == LV_LABEL_LONG_EXPAND ? LV_TXT_FLAG_FIT : LV_TXT_FLAG_NONE;
+    lv_coord_t max_w = ext->long_mode == LV_LABEL_LONG_EXPAND ? LV_COORD_MAX : lv_obj_get_width(label);
+
+    lv_point_t size;
+    _lv_txt_get_size(&size, txt, font, letter_space, line_space, max_w, flag);
+    lv_test_assert_int_eq(size.y, lv_obj_get_height(label), s);
+
+    uint32_t line_start = 0;
+    lv_coord_t y = 0;
+    while(txt[line_start] != '\0') {
+        uint32_t char_id = _lv_txt_encoded_get_char_id(txt, line_start);
+        lv_point_t p;
+        lv_label_get_letter_pos(label, char_id, &p);
+        lv_test_assert_int_eq(y, p.y, s);
+
+        if(lv_label_get_align(label) == LV_LABEL_ALIGN_LEFT) {
+            p.x = 0;
+            p.y = y + 1;
+            lv_test_assert_int_eq(char_id, lv_label_get_letter_on(label, &p), s);
+        }
+
+        line_start += _lv_txt_get_next_line(&txt[line_start], font, letter_space, max_w, flag);
+        y += line_h;
+    }
+
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    extern lv_color_t test_fb[];
+    _lv_memcpy(cached_fb, test_fb, sizeof(cached_fb));
+
+    lv_design_cb_t design_ori = lv_obj_get_design_cb(label);
+    lv_obj_set_design_cb(label, design_uncached);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_obj_set_design_cb(label, design_ori);
+
+    lv_test_assert_array_eq((const uint8_t *)cached_fb, (const uint8_t *)test_fb, sizeof(cached_fb), s);
+}
+
+/**
+ * Draw the text of a label like the label does, but let `lv_draw_label` break the lines
+ */
+static lv_design_res_t design_uncached(lv_obj_t * label, const lv_area_t * clip_area, lv_design_mode_t mode)
+{
+    if(mode != LV_DESIGN_DRAW_MAIN) return LV_DESIGN_RES_NOT_COVER;
+
+    lv_label_ext_t * ext = lv_obj_get_ext_attr(label);
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    if(ext->long_mode == LV_LABEL_LONG_EXPAND) dsc.flag |= LV_TXT_FLAG_FIT;
+    if(lv_label_get_align(label) == LV_LABEL_ALIGN_CENTER) dsc.flag |= LV_TXT_FLAG_CENTER;
+    lv_obj_init_draw_label_dsc(label, LV_LABEL_PART_MAIN, &dsc);
+
+    lv_draw_label(&label->coords, clip_area, &dsc, ext->text, NULL);
+
+    return LV_DESIGN_RES_OK;
+}
+#endif
 #endif
@@ -0,0 +1,271 @@
+/**
+ * @file lv_test_logview.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../lvgl.h"
+#include "../lv_test_assert.h"
+#include "lv_test_logview.h"
+#include <string.h>
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+#if LV_USE_LOGVIEW
+static void ring(void);
+static void line_breaks(void);
+static void scroll(void);
+static void draw(void);
+static void invalidate(void);
+static lv_obj_t * create_plain(lv_coord_t w, lv_coord_t h);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#if LV_USE_LOGVIEW
+static lv_color_t logview_fb[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+#endif
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_test_logview(void)
+{
+    lv_test_print("");
+    lv_test_print("===================");
+    lv_test_print("Start lv_logview tests");
+    lv_test_print("===================");
+
+#if LV_USE_LOGVIEW
+    ring();
+    line_breaks();
+    scroll();
+    draw();
+    invalidate();
+#else
+    lv_test_print("Skip log view test: LV_USE_LOGVIEW == 0");
+#endif
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#if LV_USE_LOGVIEW
+static void ring(void)
+{
+    lv_test_print("");
+    lv_test_print("Keep the newest lines");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    lv_obj_t * logview = create_plain(120, 60);
+    lv_logview_set_buffer(logview, 4, 16);
+
+    lv_logview_add_text(logview, "one\ntwo\nthree\n");
+    lv_test_assert_int_eq(3, lv_logview_get_line_count(logview), "Line count before full");
+    lv_test_assert_str_eq("one", lv_logview_get_line(logview, 0), "Oldest line before full");
+
+    lv_logview_add_text(logview, "four\nfive\n");
+    lv_test_assert_int_eq(4, lv_logview_get_line_count(logview), "Line count when full");
+    lv_test_assert_str_eq("two", lv_logview_get_line(logview, 0), "Oldest line dropped");
+    lv_test_assert_str_eq("five", lv_logview_get_line(logview, 3), "Newest line");
+    lv_test_assert_ptr_eq(NULL, lv_logview_get_line(logview, 4), "Line out of range");
+
+    lv_logview_add_text(logview, "par");
+    lv_logview_add_text(logview, "tial");
+    lv_logview_add_text(logview, "\n\n");
+    lv_test_assert_str_eq("partial", lv_logview_get_line(logview, 2), "Line continued");
+    lv_test_assert_str_eq("", lv_logview_get_line(logview, 3), "Empty line");
+
+    lv_logview_clear(logview);
+    lv_test_assert_int_eq(0, lv_logview_get_line_count(logview), "Clear");
+
+    lv_obj_del(logview);
+}
+
+static void line_breaks(void)
+{
+    lv_test_print("");
+    lv_test_print("Break the lines");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    lv_obj_t * logview = create_plain(LV_HOR_RES_MAX, 60);
+    lv_logview_set_buffer(logview, 8, 8);
+
+    lv_logview_add_text(logview, "0123456789ab\n");
+    lv_test_assert_str_eq("01234567", lv_logview_get_line(logview, 0), "Full line broken");
+    lv_test_assert_str_eq("89ab", lv_logview_get_line(logview, 1), "Rest of the full line");
+
+    /*7 bytes and a 2 byte long character which doesn't fit*/
+    lv_logview_add_text(logview, "aaaaaaa\xC3\xA1\n");
+    lv_test_assert_str_eq("aaaaaaa", lv_logview_get_line(logview, 2), "Full line broken before a character");
+    lv_test_assert_str_eq("\xC3\xA1", lv_logview_get_line(logview, 3), "Character not cut");
+
+    /*A character cut at the end of the added text*/
+    lv_logview_add_text(logview, "b\xC3");
+    lv_logview_add_text(logview, "\xA1" "c\n");
+    lv_test_assert_str_eq("b\xC3\xA1" "c", lv_logview_get_line(logview, 4), "Cut character continued");
+
+    /*Wrap the words to the width*/
+    const char * txt = "Shadow delta received from the cloud";
+    lv_coord_t w = 60;
+    lv_obj_set_width(logview, w);
+    lv_logview_set_buffer(logview, 16, 64);
+    lv_logview_add_text(logview, txt);
+    lv_logview_add_text(logview, "\n");
+
+    const lv_font_t * font = lv_obj_get_style_text_font(logview, LV_LOGVIEW_PART_MAIN);
+    char joined[64] = "";
+    uint16_t i;
+    for(i = 0; i < lv_logview_get_line_count(logview); i++) {
+        const char * line = lv_logview_get_line(logview, i);
+        lv_test_assert_int_eq(_lv_txt_get_next_line(line, font, 0, w, LV_TXT_FLAG_NONE), strlen(line), "Line fits");
+        strcat(joined, line);
+    }
+    lv_test_assert_int_gt(1, lv_logview_get_line_count(logview), "Long line wrapped");
+    lv_test_assert_str_eq(txt, joined, "Wrapped lines keep the text");
+
+    lv_obj_del(logview);
+}
+
+static void scroll(void)
+{
+    lv_test_print("");
+    lv_test_print("Scroll back");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    const lv_font_t * font = lv_theme_get_font_normal();
+    lv_obj_t * logview = create_plain(120, lv_font_get_line_height(font) * 3);
+    lv_logview_set_buffer(logview, 8, 16);
+    lv_logview_add_text(logview, "0\n1\n2\n3\n4\n");
+
+    lv_logview_set_scroll(logview, 100);
+    lv_test_assert_int_eq(2, lv_logview_get_scroll(logview), "Scroll limited to the oldest line");
+
+    lv_logview_set_scroll(logview, 1);
+    lv_logview_add_text(logview, "5\n6\n");
+    lv_test_assert_int_eq(3, lv_logview_get_scroll(logview), "Scrolled view stays on its lines");
+
+    lv_logview_add_text(logview, "7\n8\n9\n");
+    lv_test_assert_int_eq(5, lv_logview_get_scroll(logview), "Scrolled view limited when the lines are dropped");
+
+    lv_obj_del(logview);
+}
+
+/**
+ * Compare the drawn rows with a label showing the same lines
+ */
+static void draw(void)
+{
+    lv_test_print("");
+    lv_test_print("Draw the visible lines");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    const lv_font_t * font = lv_theme_get_font_normal();
+    lv_obj_t * logview = create_plain(LV_HOR_RES_MAX / 2, lv_font_get_line_height(font) * 3 + 2);
+    lv_logview_set_buffer(logview, 8, 32);
+    lv_logview_add_text(logview, "Starting\nConnected\nPublished\nShadow delta");
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    extern lv_color_t test_fb[];
+    _lv_memcpy(logview_fb, test_fb, sizeof(logview_fb));
+
+    lv_obj_t * label = lv_label_create(lv_scr_act(), NULL);
+    lv_label_set_text(label, "Connected\nPublished\nShadow delta");
+    lv_obj_set_hidden(logview, true);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_test_assert_array_eq((const uint8_t *)logview_fb, (const uint8_t *)test_fb, sizeof(logview_fb),
+                            "Newest lines drawn in the rows");
+
+    lv_obj_set_hidden(label, true);
+    lv_obj_set_hidden(logview, false);
+    lv_logview_set_scroll(logview, 1);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    _lv_memcpy(logview_fb, test_fb, sizeof(logview_fb));
+
+    lv_label_set_text(label, "Starting\nConnected\nPublished");
+    lv_obj_set_hidden(label, false);
+    lv_obj_set_hidden(logview, true);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_test_assert_array_eq((const uint8_t *)logview_fb, (const uint8_t *)test_fb, sizeof(logview_fb),
+                            "Scrolled lines drawn in the rows");
+
+    lv_obj_del(label);
+    lv_obj_del(logview);
+}
+
+/**
+ * Only the row of the growing line is redrawn until the lines have to move
+ */
+static void invalidate(void)
+{
+    lv_test_print("");
+    lv_test_print("Invalidate the changed rows");
+    lv_test_print("---------------------------");
+
+    lv_obj_clean(lv_scr_act());
+    const lv_font_t * font = lv_theme_get_font_normal();
+    lv_coord_t font_h = lv_font_get_line_height(font);
+    lv_obj_t * logview = create_plain(100, font_h * 2);
+    lv_obj_set_pos(logview, 10, 20);
+    lv_logview_add_text(logview, "first\nsecond");
+    lv_refr_now(NULL);
+
+    lv_disp_t * disp = lv_disp_get_default();
+    lv_logview_add_text(logview, " line");
+    lv_test_assert_int_eq(1, disp->inv_p, "One area for the growing line");
+    lv_test_assert_int_eq(20 + font_h, disp->inv_areas[0].y1, "Top of the last row");
+    lv_test_assert_int_eq(20 + 2 * font_h - 1, disp->inv_areas[0].y2, "Bottom of the last row");
+    lv_refr_now(NULL);
+
+    lv_logview_add_text(logview, "\nthird");
+    lv_test_assert_int_eq(1, disp->inv_p, "One area for the moved lines");
+    lv_test_assert_int_eq(20, disp->inv_areas[0].y1, "Top of the log view");
+    lv_refr_now(NULL);
+
+    lv_obj_del(logview);
+}
+
+/**
+ * A log view without background, border and padding to compare it with a label
+ */
+static lv_obj_t * create_plain(lv_coord_t w, lv_coord_t h)
+{
+    lv_obj_t * logview = lv_logview_create(lv_scr_act(), NULL);
+    lv_obj_set_style_local_bg_opa(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_TRANSP);
+    lv_obj_set_style_local_border_width(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_obj_set_style_local_outline_width(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_obj_set_style_local_shadow_width(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_obj_set_style_local_pad_all(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_obj_set_style_local_text_line_space(logview, LV_LOGVIEW_PART_MAIN, LV_STATE_DEFAULT, 0);
+    lv_obj_set_size(logview, w, h);
+    return logview;
+}
+#endif
+#endif
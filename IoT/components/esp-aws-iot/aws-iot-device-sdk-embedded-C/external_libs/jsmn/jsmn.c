@@ -30,6 +30,271 @@
 
 #include "jsmn.h"
 
+#if !defined(JSMN_NO_SIMD) && defined(__SSE2__) && defined(__GNUC__)
+#define JSMN_HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__x86_64__) || defined(__i386__)
+/* AVX2 code is compiled per function and only used if the CPU has it */
+#define JSMN_HAVE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+/* The scanner is known at compile time unless AVX2 is preferred, then it is
+ * picked once before main() runs, never from jsmn_parse. */
+#if defined(JSMN_HAVE_SSE2)
+static jsmnscan_t jsmn_scan = JSMN_SCAN_SSE2;
+#else
+static jsmnscan_t jsmn_scan = JSMN_SCAN_SCALAR;
+#endif
+
+#ifdef JSMN_HAVE_SSE2
+/**
+ * Vector scanners look at whole 16 or 32 byte blocks that lie before len
+ * and return the offset of the first interesting byte, or the offset of the
+ * first byte they did not look at. The scalar loop finishes from there.
+ */
+static size_t jsmn_scan_string_sse2(const char *js, size_t pos, size_t len) {
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i zero = _mm_setzero_si128();
+	for (; pos + 16 <= len; pos += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(js + pos));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+					_mm_cmpeq_epi8(v, backslash)), _mm_cmpeq_epi8(v, zero));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(m);
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+
+static size_t jsmn_scan_primitive_sse2(const char *js, size_t pos, size_t len) {
+	/* Signed compare: bytes >= 128 are negative and count as control characters */
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i del = _mm_set1_epi8(127);
+	const __m128i comma = _mm_set1_epi8(',');
+	const __m128i bracket = _mm_set1_epi8(']');
+	const __m128i brace = _mm_set1_epi8('}');
+#ifndef JSMN_STRICT
+	const __m128i colon = _mm_set1_epi8(':');
+#endif
+	for (; pos + 16 <= len; pos += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(js + pos));
+		__m128i m = _mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, space));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, del));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, comma));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, bracket));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, brace));
+#ifndef JSMN_STRICT
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, colon));
+#endif
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(m);
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+
+static size_t jsmn_scan_whitespace_sse2(const char *js, size_t pos, size_t len) {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	for (; pos + 16 <= len; pos += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(js + pos));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+		unsigned int mask = ~(unsigned int)_mm_movemask_epi8(m) & 0xFFFFu;
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+#endif /* JSMN_HAVE_SSE2 */
+
+#ifdef JSMN_HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t jsmn_scan_string_avx2(const char *js, size_t pos, size_t len) {
+	const __m256i quote = _mm256_set1_epi8('\"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i zero = _mm256_setzero_si256();
+	for (; pos + 32 <= len; pos += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(js + pos));
+		__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+					_mm256_cmpeq_epi8(v, backslash)), _mm256_cmpeq_epi8(v, zero));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(m);
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+
+__attribute__((target("avx2")))
+static size_t jsmn_scan_primitive_avx2(const char *js, size_t pos, size_t len) {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i del = _mm256_set1_epi8(127);
+	const __m256i comma = _mm256_set1_epi8(',');
+	const __m256i bracket = _mm256_set1_epi8(']');
+	const __m256i brace = _mm256_set1_epi8('}');
+#ifndef JSMN_STRICT
+	const __m256i colon = _mm256_set1_epi8(':');
+#endif
+	for (; pos + 32 <= len; pos += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(js + pos));
+		/* v < ' ' as signed bytes, AVX2 only has a greater-than compare */
+		__m256i m = _mm256_or_si256(_mm256_cmpgt_epi8(space, v), _mm256_cmpeq_epi8(v, space));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, del));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, comma));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, bracket));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, brace));
+#ifndef JSMN_STRICT
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, colon));
+#endif
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(m);
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+
+__attribute__((target("avx2")))
+static size_t jsmn_scan_whitespace_avx2(const char *js, size_t pos, size_t len) {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i lf = _mm256_set1_epi8('\n');
+	for (; pos + 32 <= len; pos += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(js + pos));
+		__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+		unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(m);
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+	}
+	return pos;
+}
+#endif /* JSMN_HAVE_AVX2 */
+
+/**
+ * Returns the offset of the next quote, backslash or NUL inside a string.
+ */
+static size_t jsmn_scan_string(const char *js, size_t pos, size_t len) {
+#ifdef JSMN_HAVE_AVX2
+	if (jsmn_scan == JSMN_SCAN_AVX2) {
+		pos = jsmn_scan_string_avx2(js, pos, len);
+	}
+#endif
+#ifdef JSMN_HAVE_SSE2
+	/* Also covers the last 16 to 31 bytes after the AVX2 loop */
+	if (jsmn_scan >= JSMN_SCAN_SSE2) {
+		pos = jsmn_scan_string_sse2(js, pos, len);
+	}
+#endif
+	for (; pos < len; pos++) {
+		char c = js[pos];
+		if (c == '\"' || c == '\\' || c == '\0') {
+			break;
+		}
+	}
+	return pos;
+}
+
+/**
+ * Returns the offset of the next byte that ends a primitive or is invalid in one.
+ */
+static size_t jsmn_scan_primitive(const char *js, size_t pos, size_t len) {
+#ifdef JSMN_HAVE_AVX2
+	if (jsmn_scan == JSMN_SCAN_AVX2) {
+		pos = jsmn_scan_primitive_avx2(js, pos, len);
+	}
+#endif
+#ifdef JSMN_HAVE_SSE2
+	/* Also covers the last 16 to 31 bytes after the AVX2 loop */
+	if (jsmn_scan >= JSMN_SCAN_SSE2) {
+		pos = jsmn_scan_primitive_sse2(js, pos, len);
+	}
+#endif
+	for (; pos < len; pos++) {
+		char c = js[pos];
+		if (c < 32 || c >= 127 || c == ' ' || c == ',' || c == ']' || c == '}'
+#ifndef JSMN_STRICT
+				|| c == ':'
+#endif
+				) {
+			break;
+		}
+	}
+	return pos;
+}
+
+/**
+ * Returns the offset of the next byte that is not JSON whitespace.
+ */
+static size_t jsmn_scan_whitespace(const char *js, size_t pos, size_t len) {
+#ifdef JSMN_HAVE_AVX2
+	if (jsmn_scan == JSMN_SCAN_AVX2) {
+		pos = jsmn_scan_whitespace_avx2(js, pos, len);
+	}
+#endif
+#ifdef JSMN_HAVE_SSE2
+	/* Also covers the last 16 to 31 bytes after the AVX2 loop */
+	if (jsmn_scan >= JSMN_SCAN_SSE2) {
+		pos = jsmn_scan_whitespace_sse2(js, pos, len);
+	}
+#endif
+	for (; pos < len; pos++) {
+		char c = js[pos];
+		if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+			break;
+		}
+	}
+	return pos;
+}
+
+static jsmnscan_t jsmn_supported_scan(void) {
+#ifdef JSMN_HAVE_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return JSMN_SCAN_AVX2;
+	}
+#endif
+#ifdef JSMN_HAVE_SSE2
+	return JSMN_SCAN_SSE2;
+#else
+	return JSMN_SCAN_SCALAR;
+#endif
+}
+
+jsmnscan_t jsmn_set_scan(jsmnscan_t scan) {
+	jsmnscan_t supported = jsmn_supported_scan();
+	if (scan == JSMN_SCAN_AUTO) {
+#ifdef JSMN_PREFER_AVX2
+		scan = supported;
+#else
+		/* Strings and primitives in Shadow documents are mostly shorter than
+		 * 32 bytes, where AVX2 measured slower than SSE2. */
+		scan = supported > JSMN_SCAN_SSE2 ? JSMN_SCAN_SSE2 : supported;
+#endif
+	} else if (scan > supported) {
+		scan = supported;
+	}
+	jsmn_scan = scan;
+	return scan;
+}
+
+#if defined(JSMN_HAVE_AVX2) && defined(JSMN_PREFER_AVX2)
+__attribute__((constructor)) static void jsmn_select_scan(void) {
+	jsmn_set_scan(JSMN_SCAN_AUTO);
+}
+#endif
+
 /**
  * Allocates a fresh unused token from the token pull.
  */
@@ -69,6 +334,9 @@ static int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
 
 	start = parser->pos;
 
+	/* Skip the bytes the loop below would pass over anyway */
+	parser->pos = jsmn_scan_primitive(js, parser->pos, len);
+
 	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
 		switch (js[parser->pos]) {
 #ifndef JSMN_STRICT
@@ -121,7 +389,14 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
 
 	/* Skip starting quote */
 	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
-		char c = js[parser->pos];
+		char c;
+
+		/* Jump to the next quote, backslash or NUL */
+		parser->pos = jsmn_scan_string(js, parser->pos, len);
+		if (parser->pos >= len || js[parser->pos] == '\0') {
+			break;
+		}
+		c = js[parser->pos];
 
 		/* Quote: end of string */
 		if (c == '\"') {
@@ -266,6 +541,8 @@ int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
 					tokens[parser->toksuper].size++;
 				break;
 			case '\t' : case '\r' : case '\n' : case ' ':
+				/* Continue at the next non whitespace byte */
+				parser->pos = jsmn_scan_whitespace(js, parser->pos + 1, len) - 1;
 				break;
 			case ':':
 				parser->toksuper = parser->toknext - 1;
@@ -87,6 +87,20 @@ typedef struct {
 	int toksuper; /* superior token node, e.g parent object or array */
 } jsmn_parser;
 
+/**
+ * Character scanner used by jsmn_parse to skip over string contents,
+ * primitives and whitespace. Vector scanners are built on x86 when __SSE2__
+ * is defined, unless JSMN_NO_SIMD is defined. JSMN_SCAN_AUTO picks SSE2, or
+ * AVX2 when the CPU has it and JSMN_PREFER_AVX2 is defined. All scanners
+ * produce identical tokens.
+ */
+typedef enum {
+	JSMN_SCAN_AUTO = 0,
+	JSMN_SCAN_SCALAR = 1,
+	JSMN_SCAN_SSE2 = 2,
+	JSMN_SCAN_AVX2 = 3
+} jsmnscan_t;
+
 /**
  * Create JSON parser over an array of tokens
  */
@@ -99,6 +113,14 @@ void jsmn_init(jsmn_parser *parser);
 int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
 		jsmntok_t *tokens, unsigned int num_tokens);
 
+/**
+ * Select the character scanner used by all parsers. Falls back to the best
+ * available scanner if the requested one is not supported, and returns the
+ * scanner actually in use. The JSMN_SCAN_AUTO scanner is already selected at
+ * startup, call this only to override it and not while another task parses.
+ */
+jsmnscan_t jsmn_set_scan(jsmnscan_t scan);
+
 #ifdef __cplusplus
 }
 #endif
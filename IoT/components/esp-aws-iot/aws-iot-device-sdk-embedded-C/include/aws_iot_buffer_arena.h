@@ -0,0 +1,178 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_buffer_arena.h
+ * @brief Shared static buffer arena for the MQTT and Shadow layers
+ *
+ * Without the arena every working buffer of the MQTT client and the Shadow
+ * layer is its own fixed array, so RAM usage is the sum of all of them even
+ * though most are only needed while a single packet is processed.
+ *
+ * With ENABLE_IOT_BUFFER_ARENA defined in aws_iot_config.h those buffers are
+ * carved out of one region of AWS_IOT_BUFFER_ARENA_SIZE bytes instead:
+ *
+ *  - Connection lifetime buffers (the MQTT TX/RX buffers) are reserved once
+ *    from the top of the region with aws_iot_arena_reserve().
+ *  - Packet lifetime buffers (received Shadow documents, JSON tokens, topic
+ *    names, outgoing Shadow documents) are bump allocated from the bottom with
+ *    aws_iot_arena_alloc() and released in LIFO order with
+ *    aws_iot_arena_mark() / aws_iot_arena_release().
+ *
+ * The region can be placed in a specific memory (for example external RAM)
+ * by defining AWS_IOT_BUFFER_ARENA_ATTR.
+ *
+ * Scoped allocations are not thread safe. Like the Shadow API itself, they
+ * must all be made from the task that drives the client.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_BUFFER_ARENA_H_
+#define AWS_IOT_SDK_SRC_IOT_BUFFER_ARENA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_config.h"
+
+#ifdef ENABLE_IOT_BUFFER_ARENA
+
+#ifndef AWS_IOT_BUFFER_ARENA_SIZE
+#define AWS_IOT_BUFFER_ARENA_SIZE 4096 ///< Total size of the arena in bytes
+#endif
+
+#ifndef AWS_IOT_BUFFER_ARENA_MAX_BLOCKS
+#define AWS_IOT_BUFFER_ARENA_MAX_BLOCKS 32 ///< Maximum number of live scoped allocations
+#endif
+
+#ifndef AWS_IOT_BUFFER_ARENA_ATTR
+#define AWS_IOT_BUFFER_ARENA_ATTR ///< Placement attribute for the arena storage
+#endif
+
+/**
+ * @brief Consumers of the arena, used for usage accounting
+ */
+typedef enum {
+	IOT_ARENA_MQTT_TX = 0,       ///< MQTT client outgoing packet buffer
+	IOT_ARENA_MQTT_RX = 1,       ///< MQTT client incoming packet buffer
+	IOT_ARENA_SHADOW_RX = 2,     ///< Copy of a received Shadow document
+	IOT_ARENA_JSON_TOKENS = 3,   ///< jsmn token array for the Shadow JSON parser
+	IOT_ARENA_SHADOW_DOC = 4,    ///< Outgoing Shadow document built by the application
+	IOT_ARENA_TOPIC = 5,         ///< Temporary topic name buffers
+	IOT_ARENA_REGION_COUNT
+} IoT_Arena_Region_t;
+
+/**
+ * @brief Usage counters of one region
+ */
+typedef struct {
+	size_t currentBytes;   ///< Bytes currently held
+	size_t peakBytes;      ///< Highest value of currentBytes since the last reset
+	uint32_t allocCount;   ///< Successful allocations
+	uint32_t failCount;    ///< Allocations refused because the arena was full
+} IoT_Arena_Region_Stats_t;
+
+/**
+ * @brief Position in the scoped part of the arena, see aws_iot_arena_mark()
+ */
+typedef size_t IoT_Arena_Mark_t;
+
+/**
+ * @brief Reserve a connection lifetime buffer
+ *
+ * Reservations are made once per region and never released. Reserving the
+ * same region again returns the existing block if it is large enough, so
+ * re-initializing a client does not leak arena space.
+ *
+ * @param region Region the buffer is accounted to
+ * @param size Size in bytes
+ *
+ * @return Pointer to the buffer, NULL if the arena cannot hold it
+ */
+void *aws_iot_arena_reserve(IoT_Arena_Region_t region, size_t size);
+
+/**
+ * @brief Allocate a packet lifetime buffer
+ *
+ * @param region Region the buffer is accounted to
+ * @param size Size in bytes
+ *
+ * @return Pointer to the buffer, NULL if the arena is full
+ */
+void *aws_iot_arena_alloc(IoT_Arena_Region_t region, size_t size);
+
+/**
+ * @brief Remember the current allocation position
+ *
+ * @return Mark to pass to aws_iot_arena_release()
+ */
+IoT_Arena_Mark_t aws_iot_arena_mark(void);
+
+/**
+ * @brief Release every scoped allocation made after a mark
+ *
+ * @param mark Value returned by aws_iot_arena_mark()
+ */
+void aws_iot_arena_release(IoT_Arena_Mark_t mark);
+
+/**
+ * @brief Identify a live scoped allocation
+ *
+ * Every scoped allocation gets a unique ticket. A module can cache a scoped
+ * buffer together with its ticket and reuse it for the rest of the current
+ * packet: once the buffer has been released, or its memory handed out again,
+ * the ticket no longer matches.
+ *
+ * @param pBuf Buffer returned by aws_iot_arena_alloc()
+ *
+ * @return Ticket of the live allocation starting at pBuf, 0 if there is none
+ */
+uint32_t aws_iot_arena_ticket(const void *pBuf);
+
+/**
+ * @brief Get the usage counters of a region
+ *
+ * @param region Region to query
+ * @param pStats Output counters
+ */
+void aws_iot_arena_get_stats(IoT_Arena_Region_t region, IoT_Arena_Region_Stats_t *pStats);
+
+/**
+ * @brief Highest number of arena bytes in use at the same time, reservations included
+ *
+ * @return Peak usage in bytes
+ */
+size_t aws_iot_arena_get_peak(void);
+
+/**
+ * @brief Reset the peak and counter values, keeping live allocations
+ */
+void aws_iot_arena_reset_stats(void);
+
+/**
+ * @brief Log the capacity, peak and per-region usage with IOT_INFO
+ */
+void aws_iot_arena_report(void);
+
+#endif /* ENABLE_IOT_BUFFER_ARENA */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_BUFFER_ARENA_H_ */
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_deferred_log.h
+ * @brief Deferred binary logging
+ *
+ * Log calls on hot paths spend most of their time formatting the message and
+ * pushing it out of the UART. The deferred log does neither on the calling
+ * task: it stores the address of the format string, the address of the tag
+ * and the raw argument values into a lock free ring of fixed size records.
+ *
+ * aws_iot_deferred_log_drain(), normally called from a low priority task,
+ * turns committed records into text safe lines of the form
+ * "#DL1:<base64 record>" on the console. The host side decoder resolves the
+ * format and tag addresses from the firmware ELF file and prints the
+ * messages, so format strings never have to be formatted on the device.
+ *
+ * Arguments are captured according to the conversion specifiers of the
+ * format string. Integer, character and pointer arguments take 4 bytes,
+ * "ll"/"j" integers and floating point arguments 8 bytes. Strings are copied
+ * into the record, truncated to AWS_IOT_DEFERRED_LOG_MAX_STRING bytes, unless
+ * the record is written with aws_iot_deferred_log_write_ref(), which stores
+ * the string address instead (for strings in flash such as __func__).
+ *
+ * When the ring is full the oldest records are overwritten; the decoder
+ * reports the gap from the record sequence numbers.
+ *
+ * The functions are declared regardless of ENABLE_IOT_DEFERRED_LOG because
+ * aws_iot_log.h may include this header before aws_iot_config.h is complete.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_DEFERRED_LOG_H_
+#define AWS_IOT_SDK_SRC_IOT_DEFERRED_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_config.h"
+
+#ifndef AWS_IOT_DEFERRED_LOG_DEPTH
+#define AWS_IOT_DEFERRED_LOG_DEPTH 64 ///< Number of records kept in the ring
+#endif
+
+#ifndef AWS_IOT_DEFERRED_LOG_ARG_BYTES
+#define AWS_IOT_DEFERRED_LOG_ARG_BYTES 40 ///< Argument bytes available in one record
+#endif
+
+#ifndef AWS_IOT_DEFERRED_LOG_MAX_STRING
+#define AWS_IOT_DEFERRED_LOG_MAX_STRING 24 ///< Longest string argument copied into a record
+#endif
+
+#ifndef AWS_IOT_DEFERRED_LOG_LEVEL
+#define AWS_IOT_DEFERRED_LOG_LEVEL IOT_DLOG_LEVEL_INFO ///< Most verbose level compiled in
+#endif
+
+#define IOT_DLOG_LEVEL_ERROR 1   ///< Same numbering as the ESP-IDF log levels
+#define IOT_DLOG_LEVEL_WARN 2
+#define IOT_DLOG_LEVEL_INFO 3
+#define IOT_DLOG_LEVEL_DEBUG 4
+#define IOT_DLOG_LEVEL_VERBOSE 5
+
+#define IOT_DLOG_FLAG_STRING_REF 0x01u ///< String arguments are stored as addresses
+#define IOT_DLOG_FLAG_TRUNCATED 0x02u  ///< Arguments did not fit or a string was shortened
+
+#define AWS_IOT_DEFERRED_LOG_LINE_PREFIX "#DL1:" ///< Start of every drained line, "1" is the record layout version
+#define AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN 19u ///< Encoded record size without arguments
+
+/**
+ * @brief Encoded record size
+ *
+ * Layout, little-endian: u32 sequence, u32 timestampUs, u32 tag address,
+ * u32 format address, u8 level, u8 flags, u8 argument length, arguments.
+ */
+#define AWS_IOT_DEFERRED_LOG_RECORD_MAX_LEN (AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN + AWS_IOT_DEFERRED_LOG_ARG_BYTES)
+
+/**
+ * @brief Longest line passed to the drain sink, without the terminating NUL
+ */
+#define AWS_IOT_DEFERRED_LOG_LINE_MAX_LEN \
+	(sizeof(AWS_IOT_DEFERRED_LOG_LINE_PREFIX) - 1 + ((AWS_IOT_DEFERRED_LOG_RECORD_MAX_LEN + 2) / 3) * 4 + 1)
+
+/**
+ * @brief Deferred log counters
+ */
+typedef struct {
+	uint32_t written;     ///< Records committed to the ring
+	uint32_t drained;     ///< Records handed to a sink
+	uint32_t overwritten; ///< Records lost because the ring wrapped before they were drained
+	uint32_t truncated;   ///< Records whose arguments did not fit or were shortened
+} IoT_Deferred_Log_Stats_t;
+
+/**
+ * @brief Receives one drained line
+ *
+ * @param pLine Line starting with AWS_IOT_DEFERRED_LOG_LINE_PREFIX and ending with '\n'
+ * @param lineLen Length of pLine
+ * @param pContext Value passed to aws_iot_deferred_log_drain()
+ */
+typedef void (*IoT_Deferred_Log_Sink_t)(const char *pLine, size_t lineLen, void *pContext);
+
+#ifdef __GNUC__
+#define IOT_DLOG_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define IOT_DLOG_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+/**
+ * @brief Record a message
+ *
+ * Safe to call from any task. Never blocks and never formats.
+ *
+ * @param level One of the IOT_DLOG_LEVEL_* values
+ * @param pTag Tag, must stay valid for the lifetime of the firmware (a literal)
+ * @param pFormat printf style format, must be a literal
+ */
+void aws_iot_deferred_log_write(uint8_t level, const char *pTag, const char *pFormat, ...)
+	IOT_DLOG_PRINTF_FORMAT(3, 4);
+
+/**
+ * @brief Record a message whose string arguments are literals
+ *
+ * Same as aws_iot_deferred_log_write() but "%s" arguments are stored by
+ * address, which is cheaper and keeps the whole string.
+ */
+void aws_iot_deferred_log_write_ref(uint8_t level, const char *pTag, const char *pFormat, ...)
+	IOT_DLOG_PRINTF_FORMAT(3, 4);
+
+/**
+ * @brief Hand committed records to a sink, oldest first
+ *
+ * Only one task may drain at a time.
+ *
+ * @param sink Called once per record
+ * @param pContext Passed to the sink
+ * @param maxRecords Stop after this many records, 0 for no limit
+ *
+ * @return Number of records drained
+ */
+uint32_t aws_iot_deferred_log_drain(IoT_Deferred_Log_Sink_t sink, void *pContext, uint32_t maxRecords);
+
+/**
+ * @brief Change the most verbose level recorded at run time
+ *
+ * Levels above AWS_IOT_DEFERRED_LOG_LEVEL are compiled out and cannot be
+ * enabled here.
+ *
+ * @param level One of the IOT_DLOG_LEVEL_* values
+ */
+void aws_iot_deferred_log_set_level(uint8_t level);
+
+/**
+ * @brief Get the deferred log counters
+ *
+ * @param pStats Output counters
+ */
+void aws_iot_deferred_log_get_stats(IoT_Deferred_Log_Stats_t *pStats);
+
+/**
+ * @brief Drop all records and clear the counters
+ *
+ * Must not race with writers, intended for start-up and tests.
+ */
+void aws_iot_deferred_log_reset(void);
+
+#define IOT_DEFERRED_LOG(level, tag, format, ...) \
+	do { \
+		if((level) <= AWS_IOT_DEFERRED_LOG_LEVEL) { \
+			aws_iot_deferred_log_write((level), (tag), format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+#define IOT_DEFERRED_LOG_REF(level, tag, format, ...) \
+	do { \
+		if((level) <= AWS_IOT_DEFERRED_LOG_LEVEL) { \
+			aws_iot_deferred_log_write_ref((level), (tag), format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+#define IOT_DEFERRED_LOGE(tag, format, ...) IOT_DEFERRED_LOG(IOT_DLOG_LEVEL_ERROR, tag, format, ##__VA_ARGS__)
+#define IOT_DEFERRED_LOGW(tag, format, ...) IOT_DEFERRED_LOG(IOT_DLOG_LEVEL_WARN, tag, format, ##__VA_ARGS__)
+#define IOT_DEFERRED_LOGI(tag, format, ...) IOT_DEFERRED_LOG(IOT_DLOG_LEVEL_INFO, tag, format, ##__VA_ARGS__)
+#define IOT_DEFERRED_LOGD(tag, format, ...) IOT_DEFERRED_LOG(IOT_DLOG_LEVEL_DEBUG, tag, format, ##__VA_ARGS__)
+#define IOT_DEFERRED_LOGV(tag, format, ...) IOT_DEFERRED_LOG(IOT_DLOG_LEVEL_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_DEFERRED_LOG_H_ */
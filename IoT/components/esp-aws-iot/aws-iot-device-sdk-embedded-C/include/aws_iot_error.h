@@ -156,7 +156,11 @@ typedef enum {
 	/** Some limit has been exceeded, e.g. the maximum number of subscriptions has been reached */
 			LIMIT_EXCEEDED_ERROR = -51,
 	/** Invalid input topic type */
-			INVALID_TOPIC_TYPE_ERROR = -52
+			INVALID_TOPIC_TYPE_ERROR = -52,
+	/** An MQTT 5 acknowledgement carried a failure reason code, see aws_iot_mqtt_get_last_reason_code() */
+			MQTT_REASON_CODE_ERROR = -53,
+	/** The server closed the MQTT 5 connection with a DISCONNECT packet, see aws_iot_mqtt_get_last_reason_code() */
+			MQTT_SERVER_DISCONNECT_ERROR = -54
 } IoT_Error_t;
 
 #ifdef __cplusplus
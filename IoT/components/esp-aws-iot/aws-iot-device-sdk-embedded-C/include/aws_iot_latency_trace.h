@@ -0,0 +1,152 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_latency_trace.h
+ * @brief End-to-end latency trace ring buffer
+ *
+ * Records compact, microsecond-timestamped events at fixed points along the
+ * path from a user action to the cloud acknowledgement (UI, application,
+ * Shadow, MQTT and TLS layers). The trace is compiled out entirely unless
+ * ENABLE_IOT_LATENCY_TRACE is defined in aws_iot_config.h, so the trace
+ * points cost nothing in production builds.
+ *
+ * Recording is lock free and safe to call from any task. The ring keeps the
+ * most recent AWS_IOT_LATENCY_TRACE_DEPTH events; older events are overwritten.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_LATENCY_TRACE_H_
+#define AWS_IOT_SDK_SRC_IOT_LATENCY_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_config.h"
+
+#ifndef AWS_IOT_LATENCY_TRACE_DEPTH
+#define AWS_IOT_LATENCY_TRACE_DEPTH 128 ///< Number of events kept in the trace ring
+#endif
+
+#define AWS_IOT_LATENCY_TRACE_BLOB_MAGIC 0x4C54u ///< "LT", first two bytes of a serialized trace blob
+#define AWS_IOT_LATENCY_TRACE_BLOB_VERSION 1u ///< Version of the serialized trace blob layout
+#define AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN 8u ///< Size of the serialized blob header in bytes
+#define AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN 8u ///< Size of one serialized trace entry in bytes
+
+/**
+ * @brief Trace points along the end-to-end path
+ *
+ * Values are part of the serialized blob format, only append new events.
+ */
+typedef enum {
+	IOT_TRACE_NONE = 0,                 ///< Unused slot
+	IOT_TRACE_UI_INPUT = 1,             ///< Touch event handled by the UI
+	IOT_TRACE_APP_UPDATE_REQUEST = 2,   ///< Application requested a Shadow update
+	IOT_TRACE_SHADOW_ACTION = 3,        ///< Shadow action entered the SDK
+	IOT_TRACE_SHADOW_PUBLISH = 4,       ///< Shadow document handed to MQTT publish
+	IOT_TRACE_MQTT_SEND_START = 5,      ///< MQTT packet serialized, write starting. arg = packet length
+	IOT_TRACE_MQTT_SEND_DONE = 6,       ///< MQTT packet fully written. arg = packet length
+	IOT_TRACE_TLS_WRITE_START = 7,      ///< TLS record write starting. arg = length
+	IOT_TRACE_TLS_WRITE_DONE = 8,       ///< TLS record write returned. arg = bytes written
+	IOT_TRACE_TLS_READ_DONE = 9,        ///< TLS read returned data. arg = bytes read
+	IOT_TRACE_MQTT_PACKET_RECEIVED = 10,///< Complete MQTT packet read. arg = packet type
+	IOT_TRACE_SHADOW_ACK_RECEIVED = 11, ///< Shadow accepted/rejected response matched a pending request
+	IOT_TRACE_APP_ACK_HANDLED = 12,     ///< Application callback for the Shadow response ran
+	IOT_TRACE_APP_UI_UPDATED = 13,      ///< Application finished refreshing the UI
+	IOT_TRACE_EVENT_COUNT
+} IoT_Latency_Trace_Event_t;
+
+/**
+ * @brief One trace record
+ *
+ * The timestamp is the low 32 bits of the microsecond clock, which wraps
+ * roughly every 71 minutes. Deltas between neighbouring events are what
+ * matter, so the wrap is harmless when computed with unsigned arithmetic.
+ */
+typedef struct {
+	uint32_t timestampUs; ///< Microsecond timestamp, truncated to 32 bits
+	uint16_t event;       ///< One of IoT_Latency_Trace_Event_t
+	uint16_t arg;         ///< Event specific argument
+} IoT_Latency_Trace_Entry_t;
+
+#ifdef ENABLE_IOT_LATENCY_TRACE
+
+/**
+ * @brief Record a trace event
+ *
+ * @param event Event identifier
+ * @param arg Event specific argument, truncated to 16 bits
+ */
+void aws_iot_latency_trace_record(IoT_Latency_Trace_Event_t event, uint32_t arg);
+
+/**
+ * @brief Clear all recorded events
+ */
+void aws_iot_latency_trace_reset(void);
+
+/**
+ * @brief Copy recorded events, oldest first
+ *
+ * @param pEntries Destination array
+ * @param maxEntries Capacity of pEntries
+ *
+ * @return Number of entries copied
+ */
+uint32_t aws_iot_latency_trace_snapshot(IoT_Latency_Trace_Entry_t *pEntries, uint32_t maxEntries);
+
+/**
+ * @brief Print the recorded events with per-step deltas on the console
+ */
+void aws_iot_latency_trace_dump(void);
+
+/**
+ * @brief Serialize the recorded events into a compact little-endian blob
+ *
+ * Layout: u16 magic, u8 version, u8 reserved, u32 entry count, followed by
+ * count entries of u32 timestampUs, u16 event, u16 arg. If the buffer is too
+ * small, only the newest events that fit are written.
+ *
+ * @param pBuf Destination buffer
+ * @param bufLen Size of pBuf in bytes
+ *
+ * @return Number of bytes written, 0 if the buffer cannot hold the header
+ */
+size_t aws_iot_latency_trace_serialize(unsigned char *pBuf, size_t bufLen);
+
+/**
+ * @brief Get the printable name of a trace event
+ *
+ * @param event Event identifier
+ *
+ * @return Static string, never NULL
+ */
+const char *aws_iot_latency_trace_event_name(uint16_t event);
+
+#define IOT_LATENCY_TRACE(event, arg) aws_iot_latency_trace_record((event), (uint32_t) (arg))
+
+#else
+
+#define IOT_LATENCY_TRACE(event, arg)
+
+#endif /* ENABLE_IOT_LATENCY_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_LATENCY_TRACE_H_ */
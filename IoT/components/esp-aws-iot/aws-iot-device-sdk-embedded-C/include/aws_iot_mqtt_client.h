@@ -64,6 +64,32 @@ extern "C" {
 /** Greatest packet identifier, per MQTT spec */
 #define MAX_PACKET_ID 65535
 
+#ifdef ENABLE_IOT_MQTT5
+#ifndef AWS_IOT_MQTT5_TOPIC_ALIASES
+#define AWS_IOT_MQTT5_TOPIC_ALIASES 4 ///< Topic aliases the client maps for outgoing publishes on one connection
+#endif
+
+#ifndef AWS_IOT_MQTT5_TOPIC_ALIAS_LEN
+#define AWS_IOT_MQTT5_TOPIC_ALIAS_LEN 128 ///< Longest topic that gets an alias, longer topics are always sent in full
+#endif
+
+#ifndef AWS_IOT_MQTT_COALESCE_BUF_LEN
+#define AWS_IOT_MQTT_COALESCE_BUF_LEN 256 ///< Bytes of small packets batched into one TLS record
+#endif
+
+#ifndef AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS
+#define AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS 20 ///< Longest time a batched packet waits for the end of the yield cycle
+#endif
+
+#ifndef AWS_IOT_MQTT_COALESCE_RECORD_OVERHEAD
+#define AWS_IOT_MQTT_COALESCE_RECORD_OVERHEAD 69 ///< Bytes one TLS record and TCP segment add on the wire (AES-GCM record, IPv4 and TCP headers)
+#endif
+
+#ifndef AWS_IOT_MQTT5_SESSION_EXPIRY_SEC
+#define AWS_IOT_MQTT5_SESSION_EXPIRY_SEC 3600 ///< Session expiry interval requested when isCleanSession is false
+#endif
+#endif
+
 typedef struct _Client AWS_IoT_Client;
 
 /**
@@ -96,11 +122,14 @@ typedef struct {
 /**
  * @brief MQTT Version Type
  *
- * Defining an MQTT version type. Only 3.1.1 is supported at this time
+ * Defining an MQTT version type. MQTT 5 can only be used when the SDK is built
+ * with ENABLE_IOT_MQTT5, otherwise connecting with it fails with
+ * MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR.
  *
  */
 typedef enum {
-	MQTT_3_1_1 = 4    ///< MQTT 3.1.1 (protocol message byte = 4)
+	MQTT_3_1_1 = 4,   ///< MQTT 3.1.1 (protocol message byte = 4)
+	MQTT_5 = 5        ///< MQTT 5.0 (protocol message byte = 5)
 } MQTT_Ver_t;
 
 /**
@@ -243,6 +272,37 @@ typedef struct _MessageHandlers {
 	void *pApplicationHandlerData; ///< Context to pass to application handler
 } MessageHandlers;   /* Message handlers are indexed by subscription topic */
 
+#ifdef ENABLE_IOT_MQTT5
+/**
+ * @brief MQTT 5 Topic Alias
+ *
+ * Topic the client mapped to an alias on the current connection. The alias
+ * number is the index in ClientData::topicAliases plus one.
+ *
+ */
+typedef struct _TopicAlias {
+	uint16_t topicNameLen; ///< Length of the mapped topic, 0 when the alias is not mapped
+	uint32_t lastUse; ///< Publish count when the alias was last sent, to find the least recently used one
+	char topicName[AWS_IOT_MQTT5_TOPIC_ALIAS_LEN]; ///< Copy of the mapped topic
+} TopicAlias;
+#endif
+
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+/**
+ * @brief Write coalescing counters
+ *
+ * Small packets produced in one yield cycle (PUBACK, PINGREQ and QoS 0
+ * PUBLISH) are written to the network as one TLS record.
+ *
+ */
+typedef struct {
+	uint32_t packetsQueued; ///< Packets that went through the batch buffer
+	uint32_t recordsWritten; ///< Batches written to the network
+	uint32_t recordsSaved; ///< Network writes avoided, packetsQueued minus recordsWritten
+	uint32_t bytesSaved; ///< Estimated wire bytes avoided, recordsSaved times AWS_IOT_MQTT_COALESCE_RECORD_OVERHEAD
+} IoT_Mqtt_Coalesce_Stats_t;
+#endif
+
 /**
  * @brief MQTT Client Status
  *
@@ -278,8 +338,13 @@ typedef struct _ClientData {
 	size_t writeBufSize; ///< Size of this client's outgoing data buffer
 	size_t readBufSize; ///< Size of this client's incoming data buffer
 	size_t readBufIndex; ///< Current offset into the incoming data buffer
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	unsigned char *writeBuf; ///< Buffer for outgoing data, reserved from the buffer arena
+	unsigned char *readBuf; ///< Buffer for incoming data, reserved from the buffer arena
+#else
 	unsigned char writeBuf[AWS_IOT_MQTT_TX_BUF_LEN]; ///< Buffer for outgoing data
 	unsigned char readBuf[AWS_IOT_MQTT_RX_BUF_LEN]; ///< Buffer for incoming data
+#endif
 
 #ifdef _ENABLE_THREAD_SUPPORT_
 	bool isBlockOnThreadLockEnabled; ///< Whether to use nonblocking or blocking mutex APIs
@@ -293,6 +358,23 @@ typedef struct _ClientData {
 	MessageHandlers messageHandlers[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS]; ///< Callbacks for incoming messages
 	iot_disconnect_handler disconnectHandler; ///< Callback when a disconnection is detected
 	void *disconnectHandlerData; ///< Context for disconnect handler
+
+#ifdef ENABLE_IOT_MQTT5
+	uint16_t topicAliasMax; ///< Topic Alias Maximum the server sent in CONNACK, 0 if it accepts no aliases
+	uint32_t maxPacketSize; ///< Maximum Packet Size the server sent in CONNACK, 0 if it sent none
+	uint8_t lastReasonCode; ///< Reason code of the last MQTT 5 CONNACK, PUBACK, SUBACK, UNSUBACK or DISCONNECT received
+	uint32_t topicAliasUseCount; ///< Publishes sent with an alias on this connection
+	TopicAlias topicAliases[AWS_IOT_MQTT5_TOPIC_ALIASES]; ///< Aliases mapped on this connection
+#endif
+
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+	bool isCoalescingWrites; ///< Whether small packets are batched, true while a yield cycle runs
+	uint8_t coalescePacketCount; ///< Packets waiting in coalesceBuf
+	size_t coalesceLen; ///< Bytes waiting in coalesceBuf
+	Timer coalesceFlushTimer; ///< Started by the first batched packet, bounds how long it waits
+	IoT_Mqtt_Coalesce_Stats_t coalesceStats; ///< Write coalescing counters
+	unsigned char coalesceBuf[AWS_IOT_MQTT_COALESCE_BUF_LEN]; ///< Packets batched for one network write
+#endif
 } ClientData;
 
 /**
@@ -321,6 +403,8 @@ struct _Client {
  * @functionpage{aws_iot_mqtt_autoreconnect_set_status,mqtt,autoreconnect_set_status}
  * @functionpage{aws_iot_mqtt_get_network_disconnected_count,mqtt,get_network_disconnected_count}
  * @functionpage{aws_iot_mqtt_reset_network_disconnected_count,mqtt,reset_network_disconnected_count}
+ * @functionpage{aws_iot_mqtt_get_last_reason_code,mqtt,get_last_reason_code}
+ * @functionpage{aws_iot_mqtt_get_coalesce_stats,mqtt,get_coalesce_stats}
  */
 
 /**
@@ -483,6 +567,43 @@ uint32_t aws_iot_mqtt_get_network_disconnected_count(AWS_IoT_Client *pClient);
 void aws_iot_mqtt_reset_network_disconnected_count(AWS_IoT_Client *pClient);
 /* @[declare_mqtt_reset_network_disconnected_count] */
 
+#ifdef ENABLE_IOT_MQTT5
+/**
+ * @brief Get the reason code of the last MQTT 5 acknowledgement or server DISCONNECT.
+ *
+ * Operations on an MQTT 5 connection return MQTT_REASON_CODE_ERROR when the server
+ * acknowledges them with a failure reason code (0x80 or above), and
+ * MQTT_SERVER_DISCONNECT_ERROR when the server closes the connection with a DISCONNECT
+ * packet. A refused CONNACK is mapped to the closest MQTT_CONNACK_* error. This
+ * function returns the reason code the server actually sent, see the MQTT 5.0
+ * specification, section 2.4.
+ *
+ * @param[in] pClient MQTT client context
+ *
+ * @return The last reason code received, 0 (success) if there was none.
+ */
+/* @[declare_mqtt_get_last_reason_code] */
+uint8_t aws_iot_mqtt_get_last_reason_code(AWS_IoT_Client *pClient);
+/* @[declare_mqtt_get_last_reason_code] */
+#endif
+
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+/**
+ * @brief Get the write coalescing counters of an MQTT client.
+ *
+ * The counters start at zero when the client is initialized and keep counting
+ * across reconnects.
+ *
+ * @param[in] pClient MQTT client context
+ * @param[out] pStats Counters
+ *
+ * @return NULL_VALUE_ERROR if an argument is NULL, SUCCESS otherwise.
+ */
+/* @[declare_mqtt_get_coalesce_stats] */
+IoT_Error_t aws_iot_mqtt_get_coalesce_stats(AWS_IoT_Client *pClient, IoT_Mqtt_Coalesce_Stats_t *pStats);
+/* @[declare_mqtt_get_coalesce_stats] */
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -105,6 +105,13 @@ void aws_iot_mqtt_internal_write_utf8_string(unsigned char **pptr, const char *s
 
 IoT_Error_t aws_iot_mqtt_internal_flushBuffers( AWS_IoT_Client *pClient );
 IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer);
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+IoT_Error_t aws_iot_mqtt_internal_queue_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer);
+IoT_Error_t aws_iot_mqtt_internal_flush_packets(AWS_IoT_Client *pClient, Timer *pTimer);
+void aws_iot_mqtt_internal_discard_packets(AWS_IoT_Client *pClient);
+#else
+#define aws_iot_mqtt_internal_queue_packet(pClient, length, pTimer) aws_iot_mqtt_internal_send_packet(pClient, length, pTimer)
+#endif
 IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType);
 IoT_Error_t aws_iot_mqtt_internal_wait_for_read(AWS_IoT_Client *pClient, uint8_t packetType, Timer *pTimer);
 IoT_Error_t aws_iot_mqtt_internal_serialize_zero(unsigned char *pTxBuf, size_t txBufLen,
@@ -113,7 +120,41 @@ IoT_Error_t aws_iot_mqtt_internal_deserialize_publish(uint8_t *dup, QoS *qos,
 													  uint8_t *retained, uint16_t *pPacketId,
 													  char **pTopicName, uint16_t *topicNameLen,
 													  unsigned char **payload, size_t *payloadLen,
-													  unsigned char *pRxBuf, size_t rxBufLen);
+													  MQTT_Ver_t version, unsigned char *pRxBuf, size_t rxBufLen);
+
+#ifdef ENABLE_IOT_MQTT5
+
+/* MQTT 5 property identifiers used by the client, MQTT 5.0 specification 2.2.2.2 */
+#define MQTT5_PROPERTY_SESSION_EXPIRY_INTERVAL 0x11
+#define MQTT5_PROPERTY_SERVER_KEEP_ALIVE 0x13
+#define MQTT5_PROPERTY_TOPIC_ALIAS_MAXIMUM 0x22
+#define MQTT5_PROPERTY_TOPIC_ALIAS 0x23
+#define MQTT5_PROPERTY_MAXIMUM_PACKET_SIZE 0x27
+
+/** Reason codes from this value on report a failure, MQTT 5.0 specification 2.4 */
+#define MQTT5_REASON_CODE_FAILURE 0x80
+
+/**
+ * MQTT 5 property read from a packet. Integer properties are returned in
+ * value, string, binary and user properties point into the packet.
+ */
+typedef struct {
+	uint8_t id;				/**< Property identifier */
+	uint32_t value;			/**< Value of byte, two byte, four byte and variable byte integer properties */
+	unsigned char *pData;	/**< Start of string, binary and user properties */
+	uint32_t dataLen;		/**< Length of pData */
+} MQTT5Property;
+
+uint32_t aws_iot_mqtt_internal_get_var_int_len(uint32_t value);
+IoT_Error_t aws_iot_mqtt_internal_read_var_int(unsigned char **pptr, unsigned char *pEnd, uint32_t *pValue);
+IoT_Error_t aws_iot_mqtt_internal_read_properties_len(unsigned char **pptr, unsigned char *pEnd,
+													  unsigned char **pPropertiesEnd);
+IoT_Error_t aws_iot_mqtt_internal_read_property(unsigned char **pptr, unsigned char *pPropertiesEnd,
+												MQTT5Property *pProperty);
+IoT_Error_t aws_iot_mqtt_internal_read_ack_reason_code(unsigned char *pRxBuf, size_t rxBufLen, uint8_t *pReasonCode);
+void aws_iot_mqtt_internal_reset_topic_aliases(AWS_IoT_Client *pClient);
+
+#endif
 
 IoT_Error_t aws_iot_mqtt_set_client_state(AWS_IoT_Client *pClient, ClientState expectedCurrentState,
 										  ClientState newState);
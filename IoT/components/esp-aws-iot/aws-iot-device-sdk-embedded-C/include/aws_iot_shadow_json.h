@@ -25,6 +25,7 @@ extern "C" {
 
 #include "aws_iot_error.h"
 #include "aws_iot_shadow_json_data.h"
+#include "jsmn.h"
 
 bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, void *pJsonHandler, int32_t *pTokenCount);
 
@@ -44,6 +45,8 @@ bool extractClientToken(const char *pJsonDocument, size_t jsonSize, char *pExtra
 
 bool extractVersionNumber(const char *pJsonDocument, void *pJsonHandler, int32_t tokenCount, uint32_t *pVersionNumber);
 
+const jsmntok_t *getParsedJsonTokens(void);
+
 #ifdef __cplusplus
 }
 #endif
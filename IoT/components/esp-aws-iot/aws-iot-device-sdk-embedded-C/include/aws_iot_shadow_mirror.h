@@ -0,0 +1,239 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_mirror.h
+ * @brief Local mirror of the Thing Shadow document
+ *
+ * Keeps the reported and desired state of this device's Shadow in RAM so
+ * the application can read it without a get round trip. The mirror is
+ * seeded from a get/accepted document and then merged incrementally from
+ * update/accepted and delta documents. A get/rejected document with code
+ * 404 seeds it empty, the Thing has no Shadow yet. When ENABLE_IOT_SHADOW_MIRROR is
+ * defined the Shadow client feeds those documents in on its own; the
+ * application only has to issue the first aws_iot_shadow_get().
+ *
+ * Nested objects are flattened into dotted keys ("sensors.co2"); arrays are
+ * kept as raw JSON text. A null value removes the field, as it does in the
+ * Shadow service. Documents older than the mirror are ignored. A document
+ * that skips versions is still merged, but the mirror then reports that it
+ * needs a resync, because the updates in between were not seen.
+ *
+ * Registered callbacks are told about fields that were added, changed or
+ * removed, never about fields a document repeats with the same value. The
+ * first seed is not reported, there is nothing it changes; use the lookups
+ * once aws_iot_shadow_mirror_needs_resync() is false.
+ *
+ * The mirror is not locked. Use it from the task that calls
+ * aws_iot_shadow_yield().
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_SHADOW_MIRROR_H_
+#define AWS_IOT_SDK_SRC_IOT_SHADOW_MIRROR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_config.h"
+#include "aws_iot_error.h"
+
+#ifndef AWS_IOT_SHADOW_MIRROR_MAX_FIELDS
+#define AWS_IOT_SHADOW_MIRROR_MAX_FIELDS 16 ///< Fields kept across the reported and desired sections
+#endif
+
+#ifndef AWS_IOT_SHADOW_MIRROR_KEY_LEN
+#define AWS_IOT_SHADOW_MIRROR_KEY_LEN 32 ///< Longest dotted key, including the terminating NUL
+#endif
+
+#ifndef AWS_IOT_SHADOW_MIRROR_VALUE_LEN
+#define AWS_IOT_SHADOW_MIRROR_VALUE_LEN 48 ///< Longest value text, including the terminating NUL
+#endif
+
+#ifndef AWS_IOT_SHADOW_MIRROR_MAX_CALLBACKS
+#define AWS_IOT_SHADOW_MIRROR_MAX_CALLBACKS 4 ///< Change callbacks that can be registered
+#endif
+
+#define AWS_IOT_SHADOW_MIRROR_MAX_DEPTH 8 ///< Deepest object nesting that is mirrored
+
+/**
+ * @brief Section of the Shadow state a field belongs to
+ */
+typedef enum {
+	SHADOW_MIRROR_REPORTED = 0,
+	SHADOW_MIRROR_DESIRED = 1
+} ShadowMirrorSection_t;
+
+/**
+ * @brief Kind of document merged into the mirror
+ */
+typedef enum {
+	SHADOW_MIRROR_DOC_GET_ACCEPTED,    ///< Full document, replaces the mirror
+	SHADOW_MIRROR_DOC_UPDATE_ACCEPTED, ///< Reported and desired changes
+	SHADOW_MIRROR_DOC_DELTA,           ///< Desired fields that differ from reported
+	SHADOW_MIRROR_DOC_GET_REJECTED     ///< Error of a get, code 404 empties the mirror
+} ShadowMirrorDocument_t;
+
+/**
+ * @brief Type of a mirrored value
+ */
+typedef enum {
+	SHADOW_MIRROR_TYPE_STRING,    ///< JSON string, stored without quotes and not unescaped
+	SHADOW_MIRROR_TYPE_PRIMITIVE, ///< Number, true or false
+	SHADOW_MIRROR_TYPE_ARRAY      ///< Raw JSON array text
+} ShadowMirrorValueType_t;
+
+/**
+ * @brief Mirror counters
+ */
+typedef struct {
+	uint32_t documents; ///< Documents merged
+	uint32_t stale;     ///< Documents ignored because they were older than the mirror
+	uint32_t gaps;      ///< Documents that skipped versions
+	uint32_t dropped;   ///< Fields not kept because the table was full or the key or value too long
+} IoT_Shadow_Mirror_Stats_t;
+
+/**
+ * @brief Called for a field that was added, changed or removed
+ *
+ * Called while a document is being merged, so fields later in the same
+ * document may not be applied yet.
+ *
+ * @param section Section of the field
+ * @param pKey Dotted key
+ * @param pValue New value text, NULL when the field was removed
+ * @param type Type of the new value, meaningless when pValue is NULL
+ * @param pContext Value passed at registration
+ */
+typedef void (*IoT_Shadow_Mirror_Callback_t)(ShadowMirrorSection_t section, const char *pKey, const char *pValue,
+											 ShadowMirrorValueType_t type, void *pContext);
+
+/**
+ * @brief Empty the mirror, drop the callbacks and clear the counters
+ */
+void aws_iot_shadow_mirror_reset(void);
+
+/**
+ * @brief Merge a Shadow document
+ *
+ * @param docType Which Shadow topic the document came from
+ * @param pJsonDocument Document text
+ * @param jsonSize Length of pJsonDocument
+ *
+ * @return SUCCESS when merged or ignored as stale, SHADOW_JSON_ERROR when the
+ * document is not valid or has no version, or a rejected document has no code
+ */
+IoT_Error_t aws_iot_shadow_mirror_apply(ShadowMirrorDocument_t docType, const char *pJsonDocument, size_t jsonSize);
+
+/**
+ * @brief Merge a document already parsed by the Shadow JSON parser
+ *
+ * Used by the Shadow client, which has the tokens at hand.
+ */
+IoT_Error_t aws_iot_shadow_mirror_apply_parsed(ShadowMirrorDocument_t docType, const char *pJsonDocument,
+											   int32_t tokenCount);
+
+/**
+ * @brief Mark the mirror as out of date
+ *
+ * Called when the connection was lost and updates may have been missed.
+ * The fields stay readable until the next get/accepted document.
+ */
+void aws_iot_shadow_mirror_invalidate(void);
+
+/**
+ * @brief Whether the mirror should be seeded again with aws_iot_shadow_get()
+ *
+ * True before the first get/accepted or 404 get/rejected document, after a
+ * version gap and after aws_iot_shadow_mirror_invalidate().
+ */
+bool aws_iot_shadow_mirror_needs_resync(void);
+
+/**
+ * @brief Shadow version the mirror is at, 0 before the first document
+ */
+uint32_t aws_iot_shadow_mirror_get_version(void);
+
+/**
+ * @brief Register a change callback
+ *
+ * @param section Section to watch
+ * @param pKey Dotted key to watch, NULL for every field of the section. Not copied.
+ * @param callback Called on changes
+ * @param pContext Passed to the callback
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR or LIMIT_EXCEEDED_ERROR when all slots are used
+ */
+IoT_Error_t aws_iot_shadow_mirror_register_callback(ShadowMirrorSection_t section, const char *pKey,
+													IoT_Shadow_Mirror_Callback_t callback, void *pContext);
+
+/**
+ * @brief Look up the raw text of a field
+ *
+ * @param section Section of the field
+ * @param pKey Dotted key
+ * @param pType Output, type of the value, may be NULL
+ *
+ * @return Value text, valid until the next merge, or NULL when the field does not exist
+ */
+const char *aws_iot_shadow_mirror_get_raw(ShadowMirrorSection_t section, const char *pKey,
+										  ShadowMirrorValueType_t *pType);
+
+/**
+ * @brief Copy a string field
+ *
+ * @return SUCCESS, FAILURE when the field does not exist, SHADOW_JSON_ERROR
+ * when it is not a string, SHADOW_JSON_BUFFER_TRUNCATED when pBuf is too small
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_string(ShadowMirrorSection_t section, const char *pKey, char *pBuf,
+											 size_t bufLen);
+
+/**
+ * @brief Read an integer field
+ *
+ * @return SUCCESS, FAILURE when the field does not exist, JSON_PARSE_ERROR when it is not a number
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_int(ShadowMirrorSection_t section, const char *pKey, int32_t *pValue);
+
+/**
+ * @brief Read a number field
+ *
+ * @return SUCCESS, FAILURE when the field does not exist, JSON_PARSE_ERROR when it is not a number
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_float(ShadowMirrorSection_t section, const char *pKey, float *pValue);
+
+/**
+ * @brief Read a true/false field
+ *
+ * @return SUCCESS, FAILURE when the field does not exist, JSON_PARSE_ERROR when it is not a boolean
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_bool(ShadowMirrorSection_t section, const char *pKey, bool *pValue);
+
+/**
+ * @brief Get the mirror counters
+ *
+ * @param pStats Output counters
+ */
+void aws_iot_shadow_mirror_get_stats(IoT_Shadow_Mirror_Stats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_SHADOW_MIRROR_H_ */
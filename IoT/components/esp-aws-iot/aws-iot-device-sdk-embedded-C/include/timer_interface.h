@@ -98,6 +98,16 @@ uint32_t left_ms(Timer *);
  */
 void init_timer(Timer *);
 
+/**
+ * @brief Read a monotonic microsecond clock
+ *
+ * Used for fine grained measurements such as latency tracing. The epoch is
+ * platform specific, only differences between two readings are meaningful.
+ *
+ * @return uint64_t - microseconds since an arbitrary fixed point
+ */
+uint64_t timer_now_us(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "timer_platform.h"
 
@@ -70,6 +71,12 @@ void init_timer(Timer *timer) {
 	timer->end_time = (struct timeval) {0, 0};
 }
 
+uint64_t timer_now_us(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000u + (uint64_t) (now.tv_nsec / 1000);
+}
+
 void delay(unsigned milliseconds)
 {
 	useconds_t sleepTime = (useconds_t)(milliseconds * 1000);
@@ -26,6 +26,7 @@ extern "C" {
 
 #include "aws_iot_error.h"
 #include "aws_iot_log.h"
+#include "aws_iot_latency_trace.h"
 #include "network_interface.h"
 #include "network_platform.h"
 
@@ -293,6 +294,8 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 	int ret = 0;
 	TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
 
+	IOT_LATENCY_TRACE(IOT_TRACE_TLS_WRITE_START, len);
+
 	for(written_so_far = 0, frags = 0;
 		written_so_far < len && !has_timer_expired(timer); written_so_far += ret, frags++) {
 		while(!has_timer_expired(timer) &&
@@ -311,6 +314,7 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 	}
 
 	*written_len = written_so_far;
+	IOT_LATENCY_TRACE(IOT_TRACE_TLS_WRITE_DONE, written_so_far);
 
 	if(isErrorFlag) {
 		return NETWORK_SSL_WRITE_ERROR;
@@ -344,6 +348,7 @@ IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Tim
 	}
 
 	if (len == 0) {
+		IOT_LATENCY_TRACE(IOT_TRACE_TLS_READ_DONE, rxLen);
 		*read_len = rxLen;
 		return SUCCESS;
 	}
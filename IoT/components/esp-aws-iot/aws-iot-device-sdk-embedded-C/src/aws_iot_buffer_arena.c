@@ -0,0 +1,228 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_buffer_arena.c
+ * @brief Shared static buffer arena for the MQTT and Shadow layers
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_buffer_arena.h"
+
+#ifdef ENABLE_IOT_BUFFER_ARENA
+
+#include <string.h>
+
+#include "aws_iot_log.h"
+
+#define ARENA_ALIGNMENT 8
+#define ARENA_ALIGN(x) (((x) + (ARENA_ALIGNMENT - 1)) & ~((size_t) (ARENA_ALIGNMENT - 1)))
+
+typedef struct {
+	size_t offset;
+	size_t size;
+	uint32_t ticket;
+	IoT_Arena_Region_t region;
+} ArenaBlock_t;
+
+static union {
+	uint64_t alignment;
+	unsigned char bytes[ARENA_ALIGN(AWS_IOT_BUFFER_ARENA_SIZE)];
+} arenaStorage AWS_IOT_BUFFER_ARENA_ATTR;
+
+/* Scoped allocations grow up from offset 0, reservations grow down from the end */
+static size_t scopedTop = 0;
+static size_t reservedBottom = sizeof(arenaStorage.bytes);
+static size_t peakBytes = 0;
+static uint32_t nextTicket = 1;
+
+static ArenaBlock_t blocks[AWS_IOT_BUFFER_ARENA_MAX_BLOCKS];
+static uint32_t blockCount = 0;
+
+static unsigned char *reservations[IOT_ARENA_REGION_COUNT];
+static size_t reservationSizes[IOT_ARENA_REGION_COUNT];
+
+static IoT_Arena_Region_Stats_t regionStats[IOT_ARENA_REGION_COUNT];
+
+static const char *regionNames[IOT_ARENA_REGION_COUNT] = {
+	"mqtt_tx",
+	"mqtt_rx",
+	"shadow_rx",
+	"json_tokens",
+	"shadow_doc",
+	"topic",
+};
+
+static void _aws_iot_arena_account(IoT_Arena_Region_t region, size_t size) {
+	size_t inUse;
+
+	regionStats[region].currentBytes += size;
+	regionStats[region].allocCount++;
+	if(regionStats[region].currentBytes > regionStats[region].peakBytes) {
+		regionStats[region].peakBytes = regionStats[region].currentBytes;
+	}
+
+	inUse = scopedTop + (sizeof(arenaStorage.bytes) - reservedBottom);
+	if(inUse > peakBytes) {
+		peakBytes = inUse;
+	}
+}
+
+void *aws_iot_arena_reserve(IoT_Arena_Region_t region, size_t size) {
+	size_t alignedSize;
+
+	if(region >= IOT_ARENA_REGION_COUNT || 0 == size) {
+		return NULL;
+	}
+
+	if(NULL != reservations[region]) {
+		if(reservationSizes[region] >= size) {
+			return reservations[region];
+		}
+		IOT_ERROR("Arena region %s already reserved with %u bytes, %u requested", regionNames[region],
+				  (unsigned) reservationSizes[region], (unsigned) size);
+		regionStats[region].failCount++;
+		return NULL;
+	}
+
+	alignedSize = ARENA_ALIGN(size);
+	if(reservedBottom - scopedTop < alignedSize) {
+		IOT_ERROR("Arena too small to reserve %u bytes for %s", (unsigned) size, regionNames[region]);
+		regionStats[region].failCount++;
+		return NULL;
+	}
+
+	reservedBottom -= alignedSize;
+	reservations[region] = &arenaStorage.bytes[reservedBottom];
+	reservationSizes[region] = alignedSize;
+	_aws_iot_arena_account(region, alignedSize);
+
+	return reservations[region];
+}
+
+void *aws_iot_arena_alloc(IoT_Arena_Region_t region, size_t size) {
+	size_t alignedSize;
+	ArenaBlock_t *pBlock;
+
+	if(region >= IOT_ARENA_REGION_COUNT || 0 == size) {
+		return NULL;
+	}
+
+	alignedSize = ARENA_ALIGN(size);
+	if(reservedBottom - scopedTop < alignedSize || blockCount >= AWS_IOT_BUFFER_ARENA_MAX_BLOCKS) {
+		IOT_WARN("Arena full, %u bytes for %s refused", (unsigned) size, regionNames[region]);
+		regionStats[region].failCount++;
+		return NULL;
+	}
+
+	pBlock = &blocks[blockCount++];
+	pBlock->offset = scopedTop;
+	pBlock->size = alignedSize;
+	pBlock->region = region;
+	pBlock->ticket = nextTicket++;
+	if(0 == nextTicket) {
+		nextTicket = 1;
+	}
+
+	scopedTop += alignedSize;
+	_aws_iot_arena_account(region, alignedSize);
+
+	return &arenaStorage.bytes[pBlock->offset];
+}
+
+IoT_Arena_Mark_t aws_iot_arena_mark(void) {
+	return scopedTop;
+}
+
+void aws_iot_arena_release(IoT_Arena_Mark_t mark) {
+	ArenaBlock_t *pBlock;
+
+	if(mark >= scopedTop) {
+		return;
+	}
+
+	while(blockCount > 0 && blocks[blockCount - 1].offset >= mark) {
+		pBlock = &blocks[--blockCount];
+		regionStats[pBlock->region].currentBytes -= pBlock->size;
+	}
+
+	scopedTop = mark;
+}
+
+uint32_t aws_iot_arena_ticket(const void *pBuf) {
+	uint32_t i;
+
+	if(NULL == pBuf) {
+		return 0;
+	}
+
+	for(i = blockCount; i > 0; i--) {
+		if(pBuf == &arenaStorage.bytes[blocks[i - 1].offset]) {
+			return blocks[i - 1].ticket;
+		}
+	}
+
+	return 0;
+}
+
+void aws_iot_arena_get_stats(IoT_Arena_Region_t region, IoT_Arena_Region_Stats_t *pStats) {
+	if(NULL == pStats) {
+		return;
+	}
+
+	if(region >= IOT_ARENA_REGION_COUNT) {
+		memset(pStats, 0, sizeof(*pStats));
+		return;
+	}
+
+	*pStats = regionStats[region];
+}
+
+size_t aws_iot_arena_get_peak(void) {
+	return peakBytes;
+}
+
+void aws_iot_arena_reset_stats(void) {
+	uint32_t i;
+
+	for(i = 0; i < IOT_ARENA_REGION_COUNT; i++) {
+		regionStats[i].peakBytes = regionStats[i].currentBytes;
+		regionStats[i].allocCount = 0;
+		regionStats[i].failCount = 0;
+	}
+	peakBytes = scopedTop + (sizeof(arenaStorage.bytes) - reservedBottom);
+}
+
+void aws_iot_arena_report(void) {
+	uint32_t i;
+
+	IOT_INFO("buffer arena: %u bytes, peak %u, reserved %u, scoped in use %u",
+			 (unsigned) sizeof(arenaStorage.bytes), (unsigned) peakBytes,
+			 (unsigned) (sizeof(arenaStorage.bytes) - reservedBottom), (unsigned) scopedTop);
+	for(i = 0; i < IOT_ARENA_REGION_COUNT; i++) {
+		IOT_INFO("buffer arena %-12s current %u, peak %u, allocs %u, fails %u", regionNames[i],
+				 (unsigned) regionStats[i].currentBytes, (unsigned) regionStats[i].peakBytes,
+				 (unsigned) regionStats[i].allocCount, (unsigned) regionStats[i].failCount);
+	}
+}
+
+#endif /* ENABLE_IOT_BUFFER_ARENA */
+
+#ifdef __cplusplus
+}
+#endif
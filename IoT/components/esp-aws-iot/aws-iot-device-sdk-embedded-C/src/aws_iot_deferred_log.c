@@ -0,0 +1,426 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_deferred_log.c
+ * @brief Deferred binary logging
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_deferred_log.h"
+
+#ifdef ENABLE_IOT_DEFERRED_LOG
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "timer_interface.h"
+
+typedef enum {
+	LENGTH_DEFAULT,
+	LENGTH_LONG,
+	LENGTH_LONG_LONG,
+	LENGTH_SIZE,
+	LENGTH_LONG_DOUBLE
+} LengthModifier_t;
+
+typedef struct {
+	uint32_t seq;          ///< 0 while the slot is being written, ticket + 1 once committed
+	uint32_t timestampUs;
+	const char *pTag;
+	const char *pFormat;
+	uint8_t level;
+	uint8_t flags;
+	uint8_t argLen;
+	unsigned char args[AWS_IOT_DEFERRED_LOG_ARG_BYTES];
+} DeferredLogSlot_t;
+
+typedef struct {
+	unsigned char *pCursor;
+	unsigned char *pEnd;
+	bool truncated;   ///< An argument did not fit, capture stopped
+	bool shortened;   ///< A string argument was cut to AWS_IOT_DEFERRED_LOG_MAX_STRING
+} ArgWriter_t;
+
+static DeferredLogSlot_t logRing[AWS_IOT_DEFERRED_LOG_DEPTH];
+
+/* Tickets are claimed with a single atomic increment, the slot of ticket t is
+ * t % AWS_IOT_DEFERRED_LOG_DEPTH. logTail is only touched by the draining task. */
+static uint32_t logHead = 0;
+static uint32_t logTail = 0;
+static uint8_t logLevel = AWS_IOT_DEFERRED_LOG_LEVEL;
+
+static IoT_Deferred_Log_Stats_t logStats;
+
+static const char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void _aws_iot_deferred_log_put_u32(unsigned char *pBuf, uint32_t value) {
+	pBuf[0] = (unsigned char) (value & 0xFF);
+	pBuf[1] = (unsigned char) ((value >> 8) & 0xFF);
+	pBuf[2] = (unsigned char) ((value >> 16) & 0xFF);
+	pBuf[3] = (unsigned char) (value >> 24);
+}
+
+static bool _aws_iot_deferred_log_reserve(ArgWriter_t *pWriter, size_t len) {
+	if(pWriter->truncated || (size_t) (pWriter->pEnd - pWriter->pCursor) < len) {
+		pWriter->truncated = true;
+		return false;
+	}
+	return true;
+}
+
+static void _aws_iot_deferred_log_arg32(ArgWriter_t *pWriter, uint32_t value) {
+	if(_aws_iot_deferred_log_reserve(pWriter, 4)) {
+		_aws_iot_deferred_log_put_u32(pWriter->pCursor, value);
+		pWriter->pCursor += 4;
+	}
+}
+
+static void _aws_iot_deferred_log_arg64(ArgWriter_t *pWriter, uint64_t value) {
+	if(_aws_iot_deferred_log_reserve(pWriter, 8)) {
+		_aws_iot_deferred_log_put_u32(pWriter->pCursor, (uint32_t) value);
+		_aws_iot_deferred_log_put_u32(pWriter->pCursor + 4, (uint32_t) (value >> 32));
+		pWriter->pCursor += 8;
+	}
+}
+
+static void _aws_iot_deferred_log_arg_string(ArgWriter_t *pWriter, const char *pString, int precision) {
+	size_t maxLen = AWS_IOT_DEFERRED_LOG_MAX_STRING;
+	size_t len = 0;
+
+	if(NULL == pString) {
+		pString = "(null)";
+	}
+	if(precision >= 0 && (size_t) precision < maxLen) {
+		maxLen = (size_t) precision;
+	}
+	while(len < maxLen && '\0' != pString[len]) {
+		len++;
+	}
+	if(AWS_IOT_DEFERRED_LOG_MAX_STRING == len && '\0' != pString[len]) {
+		pWriter->shortened = true;
+	}
+
+	if(_aws_iot_deferred_log_reserve(pWriter, len + 1)) {
+		*pWriter->pCursor++ = (unsigned char) len;
+		memcpy(pWriter->pCursor, pString, len);
+		pWriter->pCursor += len;
+	}
+}
+
+/* Walks the conversion specifiers of the format and stores each argument in
+ * its raw form. The host decoder applies the same rules to read them back. */
+static void _aws_iot_deferred_log_capture(ArgWriter_t *pWriter, const char *pFormat, uint8_t flags, va_list *pArgs) {
+	const char *p = pFormat;
+	LengthModifier_t length;
+	int precision;
+	double floatValue;
+	uint64_t floatBits;
+
+	while('\0' != *p && !pWriter->truncated) {
+		if('%' != *p++) {
+			continue;
+		}
+		if('%' == *p) {
+			p++;
+			continue;
+		}
+
+		while('-' == *p || '+' == *p || ' ' == *p || '#' == *p || '0' == *p) {
+			p++;
+		}
+
+		if('*' == *p) {
+			_aws_iot_deferred_log_arg32(pWriter, (uint32_t) va_arg(*pArgs, int));
+			p++;
+		} else {
+			while(*p >= '0' && *p <= '9') {
+				p++;
+			}
+		}
+
+		precision = -1;
+		if('.' == *p) {
+			p++;
+			precision = 0;
+			if('*' == *p) {
+				precision = va_arg(*pArgs, int);
+				_aws_iot_deferred_log_arg32(pWriter, (uint32_t) precision);
+				p++;
+			} else {
+				while(*p >= '0' && *p <= '9') {
+					precision = precision * 10 + (*p++ - '0');
+				}
+			}
+		}
+
+		length = LENGTH_DEFAULT;
+		if('h' == *p) {
+			p += ('h' == p[1]) ? 2 : 1;
+		} else if('l' == *p) {
+			length = ('l' == p[1]) ? LENGTH_LONG_LONG : LENGTH_LONG;
+			p += ('l' == p[1]) ? 2 : 1;
+		} else if('j' == *p) {
+			length = LENGTH_LONG_LONG;
+			p++;
+		} else if('z' == *p || 't' == *p) {
+			length = LENGTH_SIZE;
+			p++;
+		} else if('L' == *p) {
+			length = LENGTH_LONG_DOUBLE;
+			p++;
+		}
+
+		switch(*p) {
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+			case 'c':
+				if(LENGTH_LONG_LONG == length) {
+					_aws_iot_deferred_log_arg64(pWriter, (uint64_t) va_arg(*pArgs, long long));
+				} else if(LENGTH_LONG == length) {
+					_aws_iot_deferred_log_arg32(pWriter, (uint32_t) va_arg(*pArgs, long));
+				} else if(LENGTH_SIZE == length) {
+					_aws_iot_deferred_log_arg32(pWriter, (uint32_t) va_arg(*pArgs, size_t));
+				} else {
+					_aws_iot_deferred_log_arg32(pWriter, (uint32_t) va_arg(*pArgs, int));
+				}
+				break;
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				if(LENGTH_LONG_DOUBLE == length) {
+					floatValue = (double) va_arg(*pArgs, long double);
+				} else {
+					floatValue = va_arg(*pArgs, double);
+				}
+				memcpy(&floatBits, &floatValue, sizeof(floatBits));
+				_aws_iot_deferred_log_arg64(pWriter, floatBits);
+				break;
+			case 'p':
+			case 'n':
+				_aws_iot_deferred_log_arg32(pWriter, (uint32_t) (uintptr_t) va_arg(*pArgs, void *));
+				break;
+			case 's':
+				if(flags & IOT_DLOG_FLAG_STRING_REF) {
+					_aws_iot_deferred_log_arg32(pWriter, (uint32_t) (uintptr_t) va_arg(*pArgs, const char *));
+				} else {
+					_aws_iot_deferred_log_arg_string(pWriter, va_arg(*pArgs, const char *), precision);
+				}
+				break;
+			default:
+				/* Unknown conversion, the remaining argument types cannot be known */
+				pWriter->truncated = true;
+				break;
+		}
+
+		if('\0' != *p) {
+			p++;
+		}
+	}
+}
+
+static void _aws_iot_deferred_log_record(uint8_t level, uint8_t flags, const char *pTag, const char *pFormat,
+										 va_list *pArgs) {
+	uint32_t ticket;
+	DeferredLogSlot_t *pSlot;
+	ArgWriter_t writer;
+
+	if(level > __atomic_load_n(&logLevel, __ATOMIC_RELAXED) || NULL == pFormat) {
+		return;
+	}
+
+	ticket = __atomic_fetch_add(&logHead, 1, __ATOMIC_RELAXED);
+	pSlot = &logRing[ticket % AWS_IOT_DEFERRED_LOG_DEPTH];
+
+	/* Invalidate the slot first so a concurrent drain never mixes two records */
+	__atomic_store_n(&pSlot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	pSlot->timestampUs = (uint32_t) timer_now_us();
+	pSlot->pTag = pTag;
+	pSlot->pFormat = pFormat;
+	pSlot->level = level;
+
+	writer.pCursor = pSlot->args;
+	writer.pEnd = pSlot->args + sizeof(pSlot->args);
+	writer.truncated = false;
+	writer.shortened = false;
+	_aws_iot_deferred_log_capture(&writer, pFormat, flags, pArgs);
+
+	if(writer.truncated || writer.shortened) {
+		flags |= IOT_DLOG_FLAG_TRUNCATED;
+		__atomic_fetch_add(&logStats.truncated, 1, __ATOMIC_RELAXED);
+	}
+	pSlot->flags = flags;
+	pSlot->argLen = (uint8_t) (writer.pCursor - pSlot->args);
+
+	__atomic_store_n(&pSlot->seq, ticket + 1, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&logStats.written, 1, __ATOMIC_RELAXED);
+}
+
+void aws_iot_deferred_log_write(uint8_t level, const char *pTag, const char *pFormat, ...) {
+	va_list args;
+
+	va_start(args, pFormat);
+	_aws_iot_deferred_log_record(level, 0, pTag, pFormat, &args);
+	va_end(args);
+}
+
+void aws_iot_deferred_log_write_ref(uint8_t level, const char *pTag, const char *pFormat, ...) {
+	va_list args;
+
+	va_start(args, pFormat);
+	_aws_iot_deferred_log_record(level, IOT_DLOG_FLAG_STRING_REF, pTag, pFormat, &args);
+	va_end(args);
+}
+
+static size_t _aws_iot_deferred_log_base64(char *pOut, const unsigned char *pIn, size_t inLen) {
+	size_t i;
+	size_t outLen = 0;
+	uint32_t triple;
+
+	for(i = 0; i < inLen; i += 3) {
+		triple = (uint32_t) pIn[i] << 16;
+		if(i + 1 < inLen) {
+			triple |= (uint32_t) pIn[i + 1] << 8;
+		}
+		if(i + 2 < inLen) {
+			triple |= pIn[i + 2];
+		}
+
+		pOut[outLen++] = base64Alphabet[(triple >> 18) & 0x3F];
+		pOut[outLen++] = base64Alphabet[(triple >> 12) & 0x3F];
+		pOut[outLen++] = (i + 1 < inLen) ? base64Alphabet[(triple >> 6) & 0x3F] : '=';
+		pOut[outLen++] = (i + 2 < inLen) ? base64Alphabet[triple & 0x3F] : '=';
+	}
+
+	return outLen;
+}
+
+/* Skips records that writers have already overwritten */
+static void _aws_iot_deferred_log_catch_up(void) {
+	uint32_t head = __atomic_load_n(&logHead, __ATOMIC_ACQUIRE);
+
+	if(head - logTail > AWS_IOT_DEFERRED_LOG_DEPTH) {
+		__atomic_fetch_add(&logStats.overwritten, head - AWS_IOT_DEFERRED_LOG_DEPTH - logTail, __ATOMIC_RELAXED);
+		logTail = head - AWS_IOT_DEFERRED_LOG_DEPTH;
+	}
+}
+
+uint32_t aws_iot_deferred_log_drain(IoT_Deferred_Log_Sink_t sink, void *pContext, uint32_t maxRecords) {
+	static DeferredLogSlot_t record;
+	static unsigned char encoded[AWS_IOT_DEFERRED_LOG_RECORD_MAX_LEN];
+	static char line[AWS_IOT_DEFERRED_LOG_LINE_MAX_LEN + 1];
+	DeferredLogSlot_t *pSlot;
+	uint32_t seq;
+	uint32_t drained = 0;
+	size_t lineLen;
+
+	if(NULL == sink) {
+		return 0;
+	}
+
+	_aws_iot_deferred_log_catch_up();
+
+	while(0 == maxRecords || drained < maxRecords) {
+		pSlot = &logRing[logTail % AWS_IOT_DEFERRED_LOG_DEPTH];
+
+		seq = __atomic_load_n(&pSlot->seq, __ATOMIC_ACQUIRE);
+		if(seq != logTail + 1) {
+			/* Either not committed yet, or overwritten since catch_up ran */
+			uint32_t before = logTail;
+			_aws_iot_deferred_log_catch_up();
+			if(before == logTail) {
+				break;
+			}
+			continue;
+		}
+
+		memcpy(&record, pSlot, sizeof(record));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(__atomic_load_n(&pSlot->seq, __ATOMIC_RELAXED) != seq) {
+			_aws_iot_deferred_log_catch_up();
+			continue;
+		}
+
+		_aws_iot_deferred_log_put_u32(encoded, logTail);
+		_aws_iot_deferred_log_put_u32(encoded + 4, record.timestampUs);
+		_aws_iot_deferred_log_put_u32(encoded + 8, (uint32_t) (uintptr_t) record.pTag);
+		_aws_iot_deferred_log_put_u32(encoded + 12, (uint32_t) (uintptr_t) record.pFormat);
+		encoded[16] = record.level;
+		encoded[17] = record.flags;
+		encoded[18] = record.argLen;
+		memcpy(encoded + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN, record.args, record.argLen);
+
+		lineLen = sizeof(AWS_IOT_DEFERRED_LOG_LINE_PREFIX) - 1;
+		memcpy(line, AWS_IOT_DEFERRED_LOG_LINE_PREFIX, lineLen);
+		lineLen += _aws_iot_deferred_log_base64(line + lineLen, encoded,
+												AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN + record.argLen);
+		line[lineLen++] = '\n';
+		line[lineLen] = '\0';
+
+		logTail++;
+		drained++;
+		__atomic_fetch_add(&logStats.drained, 1, __ATOMIC_RELAXED);
+		sink(line, lineLen, pContext);
+	}
+
+	return drained;
+}
+
+void aws_iot_deferred_log_set_level(uint8_t level) {
+	if(level > AWS_IOT_DEFERRED_LOG_LEVEL) {
+		level = AWS_IOT_DEFERRED_LOG_LEVEL;
+	}
+	__atomic_store_n(&logLevel, level, __ATOMIC_RELAXED);
+}
+
+void aws_iot_deferred_log_get_stats(IoT_Deferred_Log_Stats_t *pStats) {
+	if(NULL == pStats) {
+		return;
+	}
+
+	pStats->written = __atomic_load_n(&logStats.written, __ATOMIC_RELAXED);
+	pStats->drained = __atomic_load_n(&logStats.drained, __ATOMIC_RELAXED);
+	pStats->overwritten = __atomic_load_n(&logStats.overwritten, __ATOMIC_RELAXED);
+	pStats->truncated = __atomic_load_n(&logStats.truncated, __ATOMIC_RELAXED);
+}
+
+void aws_iot_deferred_log_reset(void) {
+	memset(logRing, 0, sizeof(logRing));
+	memset(&logStats, 0, sizeof(logStats));
+	__atomic_store_n(&logHead, 0, __ATOMIC_RELAXED);
+	logTail = 0;
+	__atomic_store_n(&logLevel, AWS_IOT_DEFERRED_LOG_LEVEL, __ATOMIC_RELAXED);
+}
+
+#endif /* ENABLE_IOT_DEFERRED_LOG */
+
+#ifdef __cplusplus
+}
+#endif
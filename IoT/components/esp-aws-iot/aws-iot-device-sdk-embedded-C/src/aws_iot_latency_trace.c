@@ -0,0 +1,178 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_latency_trace.c
+ * @brief End-to-end latency trace ring buffer
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_latency_trace.h"
+
+#ifdef ENABLE_IOT_LATENCY_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "timer_interface.h"
+
+static IoT_Latency_Trace_Entry_t traceRing[AWS_IOT_LATENCY_TRACE_DEPTH];
+
+/* Total number of events ever recorded. The slot for the next event is
+ * traceHead % AWS_IOT_LATENCY_TRACE_DEPTH. Claiming a slot is a single atomic
+ * increment, so trace points never block and never take the SDK mutexes. */
+static uint32_t traceHead = 0;
+
+static const char *traceEventNames[IOT_TRACE_EVENT_COUNT] = {
+	"none",
+	"ui_input",
+	"app_update_request",
+	"shadow_action",
+	"shadow_publish",
+	"mqtt_send_start",
+	"mqtt_send_done",
+	"tls_write_start",
+	"tls_write_done",
+	"tls_read_done",
+	"mqtt_packet_received",
+	"shadow_ack_received",
+	"app_ack_handled",
+	"app_ui_updated",
+};
+
+static void _aws_iot_latency_trace_put_u16(unsigned char *pBuf, uint16_t value) {
+	pBuf[0] = (unsigned char) (value & 0xFF);
+	pBuf[1] = (unsigned char) (value >> 8);
+}
+
+static void _aws_iot_latency_trace_put_u32(unsigned char *pBuf, uint32_t value) {
+	_aws_iot_latency_trace_put_u16(pBuf, (uint16_t) (value & 0xFFFF));
+	_aws_iot_latency_trace_put_u16(pBuf + 2, (uint16_t) (value >> 16));
+}
+
+void aws_iot_latency_trace_record(IoT_Latency_Trace_Event_t event, uint32_t arg) {
+	uint32_t slot;
+	IoT_Latency_Trace_Entry_t *pEntry;
+
+	slot = __atomic_fetch_add(&traceHead, 1, __ATOMIC_RELAXED);
+	pEntry = &traceRing[slot % AWS_IOT_LATENCY_TRACE_DEPTH];
+
+	pEntry->timestampUs = (uint32_t) timer_now_us();
+	pEntry->event = (uint16_t) event;
+	pEntry->arg = (uint16_t) (arg > UINT16_MAX ? UINT16_MAX : arg);
+}
+
+void aws_iot_latency_trace_reset(void) {
+	__atomic_store_n(&traceHead, 0, __ATOMIC_RELAXED);
+	memset(traceRing, 0, sizeof(traceRing));
+}
+
+uint32_t aws_iot_latency_trace_snapshot(IoT_Latency_Trace_Entry_t *pEntries, uint32_t maxEntries) {
+	uint32_t head;
+	uint32_t count;
+	uint32_t first;
+	uint32_t i;
+
+	if(NULL == pEntries || 0 == maxEntries) {
+		return 0;
+	}
+
+	head = __atomic_load_n(&traceHead, __ATOMIC_RELAXED);
+	count = head < AWS_IOT_LATENCY_TRACE_DEPTH ? head : AWS_IOT_LATENCY_TRACE_DEPTH;
+	if(count > maxEntries) {
+		count = maxEntries;
+	}
+
+	/* Keep the newest events when the destination is smaller than the ring */
+	first = head - count;
+	for(i = 0; i < count; i++) {
+		pEntries[i] = traceRing[(first + i) % AWS_IOT_LATENCY_TRACE_DEPTH];
+	}
+
+	return count;
+}
+
+const char *aws_iot_latency_trace_event_name(uint16_t event) {
+	if(event >= IOT_TRACE_EVENT_COUNT) {
+		return "unknown";
+	}
+	return traceEventNames[event];
+}
+
+void aws_iot_latency_trace_dump(void) {
+	static IoT_Latency_Trace_Entry_t entries[AWS_IOT_LATENCY_TRACE_DEPTH];
+	uint32_t count;
+	uint32_t i;
+	uint32_t firstUs;
+	uint32_t prevUs;
+
+	count = aws_iot_latency_trace_snapshot(entries, AWS_IOT_LATENCY_TRACE_DEPTH);
+	printf("latency trace: %u events\n", (unsigned) count);
+	if(0 == count) {
+		return;
+	}
+
+	printf("%10s %10s  %-22s %s\n", "t+us", "delta_us", "event", "arg");
+	firstUs = entries[0].timestampUs;
+	prevUs = firstUs;
+	for(i = 0; i < count; i++) {
+		printf("%10u %10u  %-22s %u\n", (unsigned) (entries[i].timestampUs - firstUs),
+			   (unsigned) (entries[i].timestampUs - prevUs), aws_iot_latency_trace_event_name(entries[i].event),
+			   (unsigned) entries[i].arg);
+		prevUs = entries[i].timestampUs;
+	}
+}
+
+size_t aws_iot_latency_trace_serialize(unsigned char *pBuf, size_t bufLen) {
+	static IoT_Latency_Trace_Entry_t entries[AWS_IOT_LATENCY_TRACE_DEPTH];
+	uint32_t count;
+	uint32_t capacity;
+	uint32_t i;
+	unsigned char *pCursor;
+
+	if(NULL == pBuf || bufLen < AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN) {
+		return 0;
+	}
+
+	capacity = (uint32_t) ((bufLen - AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN) / AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN);
+	if(capacity > AWS_IOT_LATENCY_TRACE_DEPTH) {
+		capacity = AWS_IOT_LATENCY_TRACE_DEPTH;
+	}
+	count = capacity > 0 ? aws_iot_latency_trace_snapshot(entries, capacity) : 0;
+
+	_aws_iot_latency_trace_put_u16(pBuf, AWS_IOT_LATENCY_TRACE_BLOB_MAGIC);
+	pBuf[2] = (unsigned char) AWS_IOT_LATENCY_TRACE_BLOB_VERSION;
+	pBuf[3] = 0;
+	_aws_iot_latency_trace_put_u32(pBuf + 4, count);
+
+	pCursor = pBuf + AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN;
+	for(i = 0; i < count; i++) {
+		_aws_iot_latency_trace_put_u32(pCursor, entries[i].timestampUs);
+		_aws_iot_latency_trace_put_u16(pCursor + 4, entries[i].event);
+		_aws_iot_latency_trace_put_u16(pCursor + 6, entries[i].arg);
+		pCursor += AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN;
+	}
+
+	return (size_t) (pCursor - pBuf);
+}
+
+#endif /* ENABLE_IOT_LATENCY_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
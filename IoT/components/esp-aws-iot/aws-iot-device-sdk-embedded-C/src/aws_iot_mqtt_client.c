@@ -42,6 +42,7 @@ extern "C" {
 #include <string.h>
 
 #include "aws_iot_log.h"
+#include "aws_iot_buffer_arena.h"
 #include "aws_iot_mqtt_client_interface.h"
 #include "aws_iot_mqtt_client_common_internal.h"
 #include "aws_iot_version.h"
@@ -255,7 +256,20 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, const IoT_Client_Init_Par
 	pClient->clientData.commandTimeoutMs = pInitParams->mqttCommandTimeout_ms;
 	pClient->clientData.writeBufSize = AWS_IOT_MQTT_TX_BUF_LEN;
 	pClient->clientData.readBufSize = AWS_IOT_MQTT_RX_BUF_LEN;
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	pClient->clientData.writeBuf = (unsigned char *) aws_iot_arena_reserve(IOT_ARENA_MQTT_TX, AWS_IOT_MQTT_TX_BUF_LEN);
+	pClient->clientData.readBuf = (unsigned char *) aws_iot_arena_reserve(IOT_ARENA_MQTT_RX, AWS_IOT_MQTT_RX_BUF_LEN);
+	if(NULL == pClient->clientData.writeBuf || NULL == pClient->clientData.readBuf) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+#endif
 	pClient->clientData.counterNetworkDisconnected = 0;
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+	pClient->clientData.isCoalescingWrites = false;
+	pClient->clientData.coalesceLen = 0;
+	pClient->clientData.coalescePacketCount = 0;
+	memset(&pClient->clientData.coalesceStats, 0, sizeof(pClient->clientData.coalesceStats));
+#endif
 	pClient->clientData.disconnectHandler = pInitParams->disconnectHandler;
 	pClient->clientData.disconnectHandlerData = pInitParams->disconnectHandlerData;
 	pClient->clientData.nextPacketId = 1;
@@ -392,6 +406,28 @@ void aws_iot_mqtt_reset_network_disconnected_count(AWS_IoT_Client *pClient) {
 	pClient->clientData.counterNetworkDisconnected = 0;
 }
 
+#ifdef ENABLE_IOT_MQTT5
+uint8_t aws_iot_mqtt_get_last_reason_code(AWS_IoT_Client *pClient) {
+	if(NULL == pClient) {
+		return 0;
+	}
+
+	return pClient->clientData.lastReasonCode;
+}
+#endif
+
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+IoT_Error_t aws_iot_mqtt_get_coalesce_stats(AWS_IoT_Client *pClient, IoT_Mqtt_Coalesce_Stats_t *pStats) {
+	if(NULL == pClient || NULL == pStats) {
+		return NULL_VALUE_ERROR;
+	}
+
+	*pStats = pClient->clientData.coalesceStats;
+
+	return SUCCESS;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,8 @@ extern "C" {
 
 #include <aws_iot_mqtt_client.h>
 #include "aws_iot_mqtt_client_common_internal.h"
+#include "aws_iot_latency_trace.h"
+#include "aws_iot_buffer_arena.h"
 
 /** Max length of packet header */
 #define MAX_NO_OF_REMAINING_LENGTH_BYTES 4
@@ -296,43 +298,27 @@ IoT_Error_t aws_iot_mqtt_internal_init_header(MQTTHeader *pHeader, MessageTypes
 	FUNC_EXIT_RC(SUCCESS);
 }
 
-/**
- * @brief Send an MQTT packet on the network
- *
- * @param pClient MQTT client which holds packet
- * @param length Length of packet to send
- * @param pTimer Amount of time allowed to send packet
- *
- * @return IoT_Error_t of send status
- */
-IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer) {
-
+/* Write length bytes of pBuf to the network under the write mutex */
+static IoT_Error_t _aws_iot_mqtt_internal_write(AWS_IoT_Client *pClient, const unsigned char *pBuf, size_t length,
+												 Timer *pTimer) {
 	size_t sentLen, sent;
 	IoT_Error_t rc = FAILURE;
 
-	FUNC_ENTRY;
-
-	if(NULL == pClient || NULL == pTimer) {
-		FUNC_EXIT_RC(NULL_VALUE_ERROR);
-	}
-
-	if(length >= pClient->clientData.writeBufSize) {
-		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
-	}
-
 #ifdef _ENABLE_THREAD_SUPPORT_
 	rc = aws_iot_mqtt_client_lock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
 	if(SUCCESS != rc) {
-		FUNC_EXIT_RC(rc);
+		return rc;
 	}
 #endif
 
 	sentLen = 0;
 	sent = 0;
 
+	IOT_LATENCY_TRACE(IOT_TRACE_MQTT_SEND_START, length);
+
 	while(sent < length && !has_timer_expired(pTimer)) {
 		rc = pClient->networkStack.write(&(pClient->networkStack),
-						 &pClient->clientData.writeBuf[sent],
+						 (unsigned char *) &pBuf[sent],
 						 (length - sent),
 						 pTimer,
 						 &sentLen);
@@ -346,19 +332,165 @@ IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t le
 #ifdef _ENABLE_THREAD_SUPPORT_
 	rc = aws_iot_mqtt_client_unlock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
 	if(SUCCESS != rc) {
-		FUNC_EXIT_RC(rc);
+		return rc;
 	}
 #endif
 
 	if(sent == length) {
+		IOT_LATENCY_TRACE(IOT_TRACE_MQTT_SEND_DONE, length);
 		/* record the fact that we have successfully sent the packet */
 		//countdown_sec(&c->pingTimer, c->clientData.keepAliveInterval);
-		FUNC_EXIT_RC(SUCCESS);
+		return SUCCESS;
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Send an MQTT packet on the network
+ *
+ * @param pClient MQTT client which holds packet
+ * @param length Length of packet to send
+ * @param pTimer Amount of time allowed to send packet
+ *
+ * @return IoT_Error_t of send status
+ */
+IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pTimer) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(length >= pClient->clientData.writeBufSize) {
+		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
 	}
 
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+	/* Packets batched earlier go out first so the server sees them in order */
+	rc = aws_iot_mqtt_internal_flush_packets(pClient, pTimer);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+#endif
+
+	rc = _aws_iot_mqtt_internal_write(pClient, pClient->clientData.writeBuf, length, pTimer);
+
 	FUNC_EXIT_RC(rc);
 }
 
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+/**
+ * @brief Send a small packet as part of the current yield cycle's batch
+ *
+ * While a yield cycle runs, the packet serialized in the write buffer is
+ * appended to the batch buffer instead of being written on its own. The
+ * batch is written as one record at the end of the cycle, when the next
+ * packet does not fit, when another packet is sent directly, or once the
+ * first batched packet has waited AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS.
+ * Outside a yield cycle the packet is sent directly.
+ *
+ * @param pClient MQTT client
+ * @param length Length of the packet in the write buffer
+ * @param pTimer Timer for a write this call has to do
+ *
+ * @return SUCCESS or the error of a network write
+ */
+IoT_Error_t aws_iot_mqtt_internal_queue_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer) {
+	ClientData *pData;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pTimer) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	pData = &pClient->clientData;
+	if(!pData->isCoalescingWrites || length > AWS_IOT_MQTT_COALESCE_BUF_LEN) {
+		rc = aws_iot_mqtt_internal_send_packet(pClient, length, pTimer);
+		FUNC_EXIT_RC(rc);
+	}
+
+	if(pData->coalesceLen + length > AWS_IOT_MQTT_COALESCE_BUF_LEN) {
+		rc = aws_iot_mqtt_internal_flush_packets(pClient, pTimer);
+		if(SUCCESS != rc) {
+			FUNC_EXIT_RC(rc);
+		}
+	}
+
+	if(0 == pData->coalesceLen) {
+		init_timer(&pData->coalesceFlushTimer);
+		countdown_ms(&pData->coalesceFlushTimer, AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS);
+	}
+
+	memcpy(&pData->coalesceBuf[pData->coalesceLen], pData->writeBuf, length);
+	pData->coalesceLen += length;
+	pData->coalescePacketCount++;
+	pData->coalesceStats.packetsQueued++;
+
+	if(has_timer_expired(&pData->coalesceFlushTimer)) {
+		rc = aws_iot_mqtt_internal_flush_packets(pClient, pTimer);
+		FUNC_EXIT_RC(rc);
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+/**
+ * @brief Write the batched packets as one record
+ *
+ * The batch is emptied whether or not the write succeeds, a failed write
+ * leaves the connection unusable anyway.
+ *
+ * @param pClient MQTT client
+ * @param pTimer Timer for the write, NULL to use the command timeout
+ *
+ * @return SUCCESS, also when there was nothing to write, or the write error
+ */
+IoT_Error_t aws_iot_mqtt_internal_flush_packets(AWS_IoT_Client *pClient, Timer *pTimer) {
+	ClientData *pData;
+	Timer writeTimer;
+	IoT_Error_t rc;
+
+	if(NULL == pClient) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pData = &pClient->clientData;
+	if(0 == pData->coalesceLen) {
+		return SUCCESS;
+	}
+
+	if(NULL == pTimer) {
+		init_timer(&writeTimer);
+		countdown_ms(&writeTimer, pData->commandTimeoutMs);
+		pTimer = &writeTimer;
+	}
+
+	rc = _aws_iot_mqtt_internal_write(pClient, pData->coalesceBuf, pData->coalesceLen, pTimer);
+	if(SUCCESS == rc) {
+		pData->coalesceStats.recordsWritten++;
+		pData->coalesceStats.recordsSaved += (uint32_t) (pData->coalescePacketCount - 1);
+		pData->coalesceStats.bytesSaved += (uint32_t) (pData->coalescePacketCount - 1) *
+										   AWS_IOT_MQTT_COALESCE_RECORD_OVERHEAD;
+	} else {
+		IOT_WARN("Failed to write %u batched packets", (unsigned int) pData->coalescePacketCount);
+	}
+
+	aws_iot_mqtt_internal_discard_packets(pClient);
+
+	return rc;
+}
+
+void aws_iot_mqtt_internal_discard_packets(AWS_IoT_Client *pClient) {
+	pClient->clientData.coalesceLen = 0;
+	pClient->clientData.coalescePacketCount = 0;
+}
+#endif
+
 static IoT_Error_t _aws_iot_mqtt_internal_readWrapper( AWS_IoT_Client *pClient, size_t offset, size_t size, Timer *pTimer, size_t * read_len ) {
     IoT_Error_t rc;
     int byteToRead;
@@ -587,7 +719,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient
 	rc = aws_iot_mqtt_internal_deserialize_publish(&msg.isDup, &msg.qos, &msg.isRetained,
 												   &msg.id, &topicName, &topicNameLen,
 												   (unsigned char **) &msg.payload, &msg.payloadLen,
-												   pClient->clientData.readBuf,
+												   pClient->clientData.options.MQTTVersion, pClient->clientData.readBuf,
 												   pClient->clientData.readBufSize);
 
 	if(SUCCESS != rc) {
@@ -606,7 +738,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient
 			pClient->clientData.writeBufSize, PUBACK, 0, msg.id, &len);
 
 		if(SUCCESS == rc) {
-			rc = aws_iot_mqtt_internal_send_packet(pClient, len, &sendTimer);
+			rc = aws_iot_mqtt_internal_queue_packet(pClient, len, &sendTimer);
 
 			if(SUCCESS != rc) {
 				IOT_WARN("Failed to send PUBACK");
@@ -668,6 +800,8 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 		return rc;
 	}
 
+	IOT_LATENCY_TRACE(IOT_TRACE_MQTT_PACKET_RECEIVED, *pPacketType);
+
 	switch(*pPacketType) {
 		case CONNACK:
 		case PUBACK:
@@ -676,7 +810,14 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 			/* SDK is blocking, these responses will be forwarded to calling function to process */
 			break;
 		case PUBLISH: {
+#ifdef ENABLE_IOT_BUFFER_ARENA
+			/* Arena buffers taken while the subscription callbacks run live as long as this packet */
+			IoT_Arena_Mark_t packetScope = aws_iot_arena_mark();
+			rc = _aws_iot_mqtt_internal_handle_publish(pClient);
+			aws_iot_arena_release(packetScope);
+#else
 			rc = _aws_iot_mqtt_internal_handle_publish(pClient);
+#endif
 			break;
 		}
 		case PUBREC:
@@ -688,6 +829,21 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 			pClient->clientStatus.isPingOutstanding = false;
 			break;
 		}
+#ifdef ENABLE_IOT_MQTT5
+		case DISCONNECT: {
+			/* MQTT 5 servers say why they close the connection, e.g. session taken over */
+			if(MQTT_5 != pClient->clientData.options.MQTTVersion ||
+			   SUCCESS != aws_iot_mqtt_internal_read_ack_reason_code(pClient->clientData.readBuf,
+																	 pClient->clientData.readBufSize,
+																	 &(pClient->clientData.lastReasonCode))) {
+				rc = MQTT_RX_MESSAGE_PACKET_TYPE_INVALID_ERROR;
+				break;
+			}
+			IOT_WARN("Server sent DISCONNECT, reason code 0x%02X", pClient->clientData.lastReasonCode);
+			rc = MQTT_SERVER_DISCONNECT_ERROR;
+			break;
+		}
+#endif
 		default: {
 			/* Either unknown packet type or Failure occurred
              * Should not happen */
@@ -787,6 +943,231 @@ IoT_Error_t aws_iot_mqtt_internal_serialize_zero(unsigned char *pTxBuf, size_t t
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+#ifdef ENABLE_IOT_MQTT5
+
+/**
+ * @brief Length of a value encoded as MQTT 5 variable byte integer
+ *
+ * @param value Value to encode
+ *
+ * @return Number of bytes aws_iot_mqtt_internal_write_len_to_buffer() writes for value
+ */
+uint32_t aws_iot_mqtt_internal_get_var_int_len(uint32_t value) {
+	if(value < 128) {
+		return 1;
+	} else if(value < 16384) {
+		return 2;
+	} else if(value < 2097152) {
+		return 3;
+	}
+	return 4;
+}
+
+/**
+ * @brief Reads a variable byte integer without reading past the end of the packet
+ *
+ * @param pptr pointer to the input buffer - incremented by the number of bytes used
+ * @param pEnd end of the packet
+ * @param pValue decoded value
+ *
+ * @return SUCCESS, or MQTT_DECODE_REMAINING_LENGTH_ERROR if the integer is malformed or truncated
+ */
+IoT_Error_t aws_iot_mqtt_internal_read_var_int(unsigned char **pptr, unsigned char *pEnd, uint32_t *pValue) {
+	uint32_t multiplier = 1;
+	uint32_t len = 0;
+	unsigned char encodedByte;
+
+	*pValue = 0;
+	do {
+		if(++len > MAX_NO_OF_REMAINING_LENGTH_BYTES || *pptr >= pEnd) {
+			return MQTT_DECODE_REMAINING_LENGTH_ERROR;
+		}
+		encodedByte = aws_iot_mqtt_internal_read_char(pptr);
+		*pValue += (encodedByte & 127) * multiplier;
+		multiplier *= 128;
+	} while((encodedByte & 128) != 0);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Reads the property length of an MQTT 5 packet
+ *
+ * @param pptr pointer to the input buffer, points to the first property on return
+ * @param pEnd end of the packet
+ * @param pPropertiesEnd end of the properties
+ *
+ * @return SUCCESS, or FAILURE if the properties do not fit the packet
+ */
+IoT_Error_t aws_iot_mqtt_internal_read_properties_len(unsigned char **pptr, unsigned char *pEnd,
+													  unsigned char **pPropertiesEnd) {
+	uint32_t propertiesLen;
+
+	if(SUCCESS != aws_iot_mqtt_internal_read_var_int(pptr, pEnd, &propertiesLen) ||
+	   propertiesLen > (uint32_t) (pEnd - *pptr)) {
+		return FAILURE;
+	}
+
+	*pPropertiesEnd = *pptr + propertiesLen;
+	return SUCCESS;
+}
+
+/**
+ * @brief Reads one MQTT 5 property
+ *
+ * Unknown properties are a protocol error, MQTT 5.0 specification 2.2.2.2.
+ *
+ * @param pptr pointer to the input buffer - incremented past the property
+ * @param pPropertiesEnd end of the properties, from aws_iot_mqtt_internal_read_properties_len()
+ * @param pProperty property read
+ *
+ * @return SUCCESS, or FAILURE if the property is unknown or truncated
+ */
+IoT_Error_t aws_iot_mqtt_internal_read_property(unsigned char **pptr, unsigned char *pPropertiesEnd,
+												MQTT5Property *pProperty) {
+	uint32_t size;
+	uint32_t itr;
+	uint32_t available;
+
+	if(*pptr >= pPropertiesEnd) {
+		return FAILURE;
+	}
+
+	pProperty->id = aws_iot_mqtt_internal_read_char(pptr);
+	pProperty->value = 0;
+	pProperty->pData = *pptr;
+	pProperty->dataLen = 0;
+	available = (uint32_t) (pPropertiesEnd - *pptr);
+
+	switch(pProperty->id) {
+		case 0x01: /* Payload Format Indicator */
+		case 0x17: /* Request Problem Information */
+		case 0x19: /* Request Response Information */
+		case 0x24: /* Maximum QoS */
+		case 0x25: /* Retain Available */
+		case 0x28: /* Wildcard Subscription Available */
+		case 0x29: /* Subscription Identifier Available */
+		case 0x2A: /* Shared Subscription Available */
+			if(available < 1) {
+				return FAILURE;
+			}
+			pProperty->value = aws_iot_mqtt_internal_read_char(pptr);
+			break;
+		case MQTT5_PROPERTY_SERVER_KEEP_ALIVE:
+		case 0x21: /* Receive Maximum */
+		case MQTT5_PROPERTY_TOPIC_ALIAS_MAXIMUM:
+		case MQTT5_PROPERTY_TOPIC_ALIAS:
+			if(available < 2) {
+				return FAILURE;
+			}
+			pProperty->value = aws_iot_mqtt_internal_read_uint16_t(pptr);
+			break;
+		case 0x02: /* Message Expiry Interval */
+		case MQTT5_PROPERTY_SESSION_EXPIRY_INTERVAL:
+		case 0x18: /* Will Delay Interval */
+		case MQTT5_PROPERTY_MAXIMUM_PACKET_SIZE:
+			if(available < 4) {
+				return FAILURE;
+			}
+			pProperty->value = (uint32_t) aws_iot_mqtt_internal_read_uint16_t(pptr) << 16;
+			pProperty->value |= aws_iot_mqtt_internal_read_uint16_t(pptr);
+			break;
+		case 0x0B: /* Subscription Identifier */
+			if(SUCCESS != aws_iot_mqtt_internal_read_var_int(pptr, pPropertiesEnd, &(pProperty->value))) {
+				return FAILURE;
+			}
+			break;
+		case 0x03: /* Content Type */
+		case 0x08: /* Response Topic */
+		case 0x09: /* Correlation Data */
+		case 0x12: /* Assigned Client Identifier */
+		case 0x15: /* Authentication Method */
+		case 0x16: /* Authentication Data */
+		case 0x1A: /* Response Information */
+		case 0x1C: /* Server Reference */
+		case 0x1F: /* Reason String */
+		case 0x26: /* User Property, a pair of strings */
+			for(itr = 0; itr < ((0x26 == pProperty->id) ? 2u : 1u); itr++) {
+				if(pPropertiesEnd - *pptr < 2) {
+					return FAILURE;
+				}
+				size = aws_iot_mqtt_internal_read_uint16_t(pptr);
+				if(size > (uint32_t) (pPropertiesEnd - *pptr)) {
+					return FAILURE;
+				}
+				*pptr += size;
+			}
+			pProperty->dataLen = (uint32_t) (*pptr - pProperty->pData);
+			break;
+		default:
+			return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Reads the reason code of an MQTT 5 acknowledgement
+ *
+ * Handles PUBACK, SUBACK and UNSUBACK for a single topic, and DISCONNECT.
+ * A PUBACK or DISCONNECT without reason code means success (0x00).
+ *
+ * @param pRxBuf the raw buffer data, starting with the fixed header
+ * @param rxBufLen the length in bytes of the data in the supplied buffer
+ * @param pReasonCode returned reason code
+ *
+ * @return SUCCESS, or FAILURE if the packet is malformed
+ */
+IoT_Error_t aws_iot_mqtt_internal_read_ack_reason_code(unsigned char *pRxBuf, size_t rxBufLen, uint8_t *pReasonCode) {
+	unsigned char *curData = pRxBuf;
+	unsigned char *endData;
+	unsigned char *propertiesEnd;
+	uint32_t decodedLen = 0;
+	uint8_t packetType;
+
+	if(NULL == pRxBuf || NULL == pReasonCode || 2 > rxBufLen) {
+		return NULL_VALUE_ERROR;
+	}
+
+	packetType = MQTT_HEADER_FIELD_TYPE(aws_iot_mqtt_internal_read_char(&curData));
+	if(SUCCESS != aws_iot_mqtt_internal_read_var_int(&curData, pRxBuf + rxBufLen, &decodedLen) ||
+	   decodedLen > (uint32_t) (pRxBuf + rxBufLen - curData)) {
+		return FAILURE;
+	}
+	endData = curData + decodedLen;
+
+	if(DISCONNECT != packetType) {
+		if(endData - curData < 2) {
+			return FAILURE;
+		}
+		curData += 2; /* packet identifier */
+	}
+
+	*pReasonCode = 0;
+	switch(packetType) {
+		case PUBACK:
+		case DISCONNECT:
+			if(curData < endData) {
+				*pReasonCode = aws_iot_mqtt_internal_read_char(&curData);
+			}
+			break;
+		case SUBACK:
+		case UNSUBACK:
+			if(SUCCESS != aws_iot_mqtt_internal_read_properties_len(&curData, endData, &propertiesEnd) ||
+			   propertiesEnd >= endData) {
+				return FAILURE;
+			}
+			*pReasonCode = *propertiesEnd;
+			break;
+		default:
+			return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+#endif /* ENABLE_IOT_MQTT5 */
+
 #ifdef __cplusplus
 }
 #endif
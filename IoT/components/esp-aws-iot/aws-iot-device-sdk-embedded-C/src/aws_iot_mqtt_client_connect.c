@@ -96,9 +96,68 @@ typedef enum {
 	CONNACK_IDENTIFIER_REJECTED_ERROR = 2, /**< Client identifier rejected */
 	CONNACK_SERVER_UNAVAILABLE_ERROR = 3, /**< Server unavailable */
 	CONNACK_BAD_USERDATA_ERROR = 4, /**< Bad username */
-	CONNACK_NOT_AUTHORIZED_ERROR = 5 /**< Not authorized */
+	CONNACK_NOT_AUTHORIZED_ERROR = 5, /**< Not authorized */
+	CONNACK_V5_UNSUPPORTED_PROTOCOL_VERSION = 0x84, /**< MQTT 5: Unsupported protocol version */
+	CONNACK_V5_CLIENT_IDENTIFIER_NOT_VALID = 0x85, /**< MQTT 5: Client identifier not valid */
+	CONNACK_V5_BAD_USER_NAME_OR_PASSWORD = 0x86, /**< MQTT 5: Bad user name or password */
+	CONNACK_V5_NOT_AUTHORIZED = 0x87, /**< MQTT 5: Not authorized */
+	CONNACK_V5_SERVER_UNAVAILABLE = 0x88, /**< MQTT 5: Server unavailable */
+	CONNACK_V5_SERVER_BUSY = 0x89, /**< MQTT 5: Server busy */
+	CONNACK_V5_BANNED = 0x8A, /**< MQTT 5: Banned */
+	CONNACK_V5_BAD_AUTHENTICATION_METHOD = 0x8C /**< MQTT 5: Bad authentication method */
 } MQTT_Connack_Return_Codes;
 
+/**
+  * Maps a CONNACK return code (MQTT 3.1.1) or reason code (MQTT 5) to an IoT_Error_t
+  * @param connackRc the code received
+  * @return the matching MQTT_CONNACK_* value
+  */
+static IoT_Error_t _aws_iot_mqtt_get_connack_error(unsigned char connackRc) {
+	switch(connackRc) {
+		case CONNACK_CONNECTION_ACCEPTED:
+			return MQTT_CONNACK_CONNECTION_ACCEPTED;
+		case CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR:
+		case CONNACK_V5_UNSUPPORTED_PROTOCOL_VERSION:
+			return MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR;
+		case CONNACK_IDENTIFIER_REJECTED_ERROR:
+		case CONNACK_V5_CLIENT_IDENTIFIER_NOT_VALID:
+			return MQTT_CONNACK_IDENTIFIER_REJECTED_ERROR;
+		case CONNACK_SERVER_UNAVAILABLE_ERROR:
+		case CONNACK_V5_SERVER_UNAVAILABLE:
+		case CONNACK_V5_SERVER_BUSY:
+			return MQTT_CONNACK_SERVER_UNAVAILABLE_ERROR;
+		case CONNACK_BAD_USERDATA_ERROR:
+		case CONNACK_V5_BAD_USER_NAME_OR_PASSWORD:
+		case CONNACK_V5_BAD_AUTHENTICATION_METHOD:
+			return MQTT_CONNACK_BAD_USERDATA_ERROR;
+		case CONNACK_NOT_AUTHORIZED_ERROR:
+		case CONNACK_V5_NOT_AUTHORIZED:
+		case CONNACK_V5_BANNED:
+			return MQTT_CONNACK_NOT_AUTHORIZED_ERROR;
+		default:
+			return MQTT_CONNACK_UNKNOWN_ERROR;
+	}
+}
+
+#ifdef ENABLE_IOT_MQTT5
+/**
+  * Determines the length of the CONNECT properties sent on an MQTT 5 connection.
+  * The client limits the packets the server sends to its RX buffer, and asks the
+  * server to keep the session for AWS_IOT_MQTT5_SESSION_EXPIRY_SEC if it is not clean.
+  * @param pConnectParams the options to be used to build the connect packet
+  * @return the length of the properties, without the property length field
+  */
+static uint32_t _aws_iot_mqtt5_get_connect_properties_len(IoT_Client_Connect_Params *pConnectParams) {
+	uint32_t len = 5; /* Maximum Packet Size */
+
+	if(!pConnectParams->isCleanSession) {
+		len += 5; /* Session Expiry Interval */
+	}
+
+	return len;
+}
+#endif
+
 /**
   * Determines the length of the MQTT connect packet that would be produced using the supplied connect options.
   * @param options the options to be used to build the connect packet
@@ -123,6 +182,16 @@ static uint32_t _aws_iot_get_connect_packet_length(IoT_Client_Connect_Params *pC
 		len = len + pConnectParams->will.topicNameLen + 2 + pConnectParams->will.msgLen + 2;
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == pConnectParams->MQTTVersion) {
+		len += _aws_iot_mqtt5_get_connect_properties_len(pConnectParams);
+		len += aws_iot_mqtt_internal_get_var_int_len(_aws_iot_mqtt5_get_connect_properties_len(pConnectParams));
+		if(pConnectParams->isWillMsgPresent) {
+			len += 1; /* empty will properties */
+		}
+	}
+#endif
+
 	if(NULL != pConnectParams->pUsername) {
 		len = len + pConnectParams->usernameLen + 2;
 	}
@@ -162,6 +231,9 @@ static IoT_Error_t _aws_iot_mqtt_serialize_connect(unsigned char *pTxBuf, size_t
 	/* Check needed here before we start writing to the Tx buffer */
 	switch(pConnectParams->MQTTVersion) {
 		case MQTT_3_1_1:
+#ifdef ENABLE_IOT_MQTT5
+		case MQTT_5:
+#endif
 			break;
 		default:
 			return MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR;
@@ -212,6 +284,20 @@ static IoT_Error_t _aws_iot_mqtt_serialize_connect(unsigned char *pTxBuf, size_t
 	aws_iot_mqtt_internal_write_char(&ptr, flags.all);
 	aws_iot_mqtt_internal_write_uint_16(&ptr, pConnectParams->keepAliveIntervalInSec);
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == pConnectParams->MQTTVersion) {
+		ptr += aws_iot_mqtt_internal_write_len_to_buffer(ptr, _aws_iot_mqtt5_get_connect_properties_len(pConnectParams));
+		aws_iot_mqtt_internal_write_char(&ptr, MQTT5_PROPERTY_MAXIMUM_PACKET_SIZE);
+		aws_iot_mqtt_internal_write_uint_16(&ptr, (uint16_t) (AWS_IOT_MQTT_RX_BUF_LEN >> 16));
+		aws_iot_mqtt_internal_write_uint_16(&ptr, (uint16_t) (AWS_IOT_MQTT_RX_BUF_LEN & 0xFFFF));
+		if(!pConnectParams->isCleanSession) {
+			aws_iot_mqtt_internal_write_char(&ptr, MQTT5_PROPERTY_SESSION_EXPIRY_INTERVAL);
+			aws_iot_mqtt_internal_write_uint_16(&ptr, (uint16_t) (AWS_IOT_MQTT5_SESSION_EXPIRY_SEC >> 16));
+			aws_iot_mqtt_internal_write_uint_16(&ptr, (uint16_t) (AWS_IOT_MQTT5_SESSION_EXPIRY_SEC & 0xFFFF));
+		}
+	}
+#endif
+
 	/* If the code have passed the check for incorrect values above, no client id was passed as argument */
 	if(NULL == pConnectParams->pClientID) {
 		aws_iot_mqtt_internal_write_uint_16(&ptr, 0);
@@ -220,6 +306,11 @@ static IoT_Error_t _aws_iot_mqtt_serialize_connect(unsigned char *pTxBuf, size_t
 	}
 
 	if(pConnectParams->isWillMsgPresent) {
+#ifdef ENABLE_IOT_MQTT5
+		if(MQTT_5 == pConnectParams->MQTTVersion) {
+			aws_iot_mqtt_internal_write_char(&ptr, 0); /* will properties */
+		}
+#endif
 		aws_iot_mqtt_internal_write_utf8_string(&ptr, pConnectParams->will.pTopicName,
 												pConnectParams->will.topicNameLen);
 		aws_iot_mqtt_internal_write_utf8_string(&ptr, pConnectParams->will.pMessage, pConnectParams->will.msgLen);
@@ -294,32 +385,82 @@ static IoT_Error_t _aws_iot_mqtt_deserialize_connack(unsigned char *pSessionPres
 	flags.all = aws_iot_mqtt_internal_read_char(&curdata);
 	*pSessionPresent = flags.bits.sessionpresent;
 	connack_rc_char = aws_iot_mqtt_internal_read_char(&curdata);
-	switch(connack_rc_char) {
-		case CONNACK_CONNECTION_ACCEPTED:
-			*pConnackRc = MQTT_CONNACK_CONNECTION_ACCEPTED;
-			break;
-		case CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR:
-			*pConnackRc = MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR;
-			break;
-		case CONNACK_IDENTIFIER_REJECTED_ERROR:
-			*pConnackRc = MQTT_CONNACK_IDENTIFIER_REJECTED_ERROR;
-			break;
-		case CONNACK_SERVER_UNAVAILABLE_ERROR:
-			*pConnackRc = MQTT_CONNACK_SERVER_UNAVAILABLE_ERROR;
-			break;
-		case CONNACK_BAD_USERDATA_ERROR:
-			*pConnackRc = MQTT_CONNACK_BAD_USERDATA_ERROR;
-			break;
-		case CONNACK_NOT_AUTHORIZED_ERROR:
-			*pConnackRc = MQTT_CONNACK_NOT_AUTHORIZED_ERROR;
-			break;
-		default:
-			*pConnackRc = MQTT_CONNACK_UNKNOWN_ERROR;
-			break;
+	*pConnackRc = _aws_iot_mqtt_get_connack_error(connack_rc_char);
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+#ifdef ENABLE_IOT_MQTT5
+/**
+  * Deserializes an MQTT 5 CONNACK and applies the properties the server sent to the client:
+  * Topic Alias Maximum, Maximum Packet Size and Server Keep Alive
+  * @param pClient the client, receives the properties and the reason code
+  * @param pSessionPresent the session present flag returned
+  * @param pConnackRc returned connack reason code, mapped to IoT_Error_t
+  * @return IoT_Error_t indicating function execution status
+  */
+static IoT_Error_t _aws_iot_mqtt5_deserialize_connack(AWS_IoT_Client *pClient, unsigned char *pSessionPresent,
+													  IoT_Error_t *pConnackRc) {
+	unsigned char *curdata, *enddata, *propertiesEnd;
+	uint32_t decodedLen;
+	IoT_Error_t rc;
+	MQTT5Property property;
+	MQTT_Connack_Header_Flags flags = {0};
+
+	FUNC_ENTRY;
+
+	curdata = pClient->clientData.readBuf;
+	enddata = curdata + pClient->clientData.readBufSize;
+
+	if(CONNACK != MQTT_HEADER_FIELD_TYPE(aws_iot_mqtt_internal_read_char(&curdata))) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+
+	rc = aws_iot_mqtt_internal_read_var_int(&curdata, enddata, &decodedLen);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+	if(2 > decodedLen || decodedLen > (uint32_t) (enddata - curdata)) {
+		FUNC_EXIT_RC(MQTT_DECODE_REMAINING_LENGTH_ERROR);
+	}
+	enddata = curdata + decodedLen;
+
+	flags.all = aws_iot_mqtt_internal_read_char(&curdata);
+	*pSessionPresent = flags.bits.sessionpresent;
+	pClient->clientData.lastReasonCode = aws_iot_mqtt_internal_read_char(&curdata);
+	*pConnackRc = _aws_iot_mqtt_get_connack_error(pClient->clientData.lastReasonCode);
+
+	/* A server that only speaks MQTT 3.1.1 refuses the connection with a two byte CONNACK */
+	if(curdata == enddata) {
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	if(SUCCESS != aws_iot_mqtt_internal_read_properties_len(&curdata, enddata, &propertiesEnd)) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+	while(curdata < propertiesEnd) {
+		if(SUCCESS != aws_iot_mqtt_internal_read_property(&curdata, propertiesEnd, &property)) {
+			FUNC_EXIT_RC(FAILURE);
+		}
+		switch(property.id) {
+			case MQTT5_PROPERTY_TOPIC_ALIAS_MAXIMUM:
+				pClient->clientData.topicAliasMax = (uint16_t) property.value;
+				break;
+			case MQTT5_PROPERTY_MAXIMUM_PACKET_SIZE:
+				pClient->clientData.maxPacketSize = property.value;
+				break;
+			case MQTT5_PROPERTY_SERVER_KEEP_ALIVE:
+				/* The client must use the keep alive the server asks for, MQTT 5.0 specification 3.2.2.3.14 */
+				pClient->clientData.keepAliveInterval = (uint16_t) property.value;
+				break;
+			default:
+				break;
+		}
 	}
 
 	FUNC_EXIT_RC(SUCCESS);
 }
+#endif
 
 /**
  * @brief Check if client state is valid for a connect request
@@ -401,6 +542,17 @@ static IoT_Error_t _aws_iot_mqtt_internal_connect(AWS_IoT_Client *pClient, const
 	countdown_ms(&connect_timer, pClient->clientData.commandTimeoutMs);
 
 	pClient->clientData.keepAliveInterval = pClient->clientData.options.keepAliveIntervalInSec;
+#ifdef ENABLE_IOT_MQTT5
+	/* Topic aliases and server limits only last for one network connection */
+	aws_iot_mqtt_internal_reset_topic_aliases(pClient);
+	pClient->clientData.topicAliasMax = 0;
+	pClient->clientData.maxPacketSize = 0;
+	pClient->clientData.lastReasonCode = 0;
+#endif
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+	/* Nothing batched on a previous connection may reach the new one */
+	aws_iot_mqtt_internal_discard_packets(pClient);
+#endif
 	rc = _aws_iot_mqtt_serialize_connect(pClient->clientData.writeBuf, pClient->clientData.writeBufSize,
 										 &(pClient->clientData.options), &len);
 	if(SUCCESS != rc || 0 >= len) {
@@ -420,8 +572,15 @@ static IoT_Error_t _aws_iot_mqtt_internal_connect(AWS_IoT_Client *pClient, const
 	}
 
 	/* Received CONNACK, check the return code */
-	rc = _aws_iot_mqtt_deserialize_connack((unsigned char *) &sessionPresent, &connack_rc, pClient->clientData.readBuf,
-										   pClient->clientData.readBufSize);
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == pClient->clientData.options.MQTTVersion) {
+		rc = _aws_iot_mqtt5_deserialize_connack(pClient, (unsigned char *) &sessionPresent, &connack_rc);
+	} else
+#endif
+	{
+		rc = _aws_iot_mqtt_deserialize_connack((unsigned char *) &sessionPresent, &connack_rc,
+											   pClient->clientData.readBuf, pClient->clientData.readBufSize);
+	}
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
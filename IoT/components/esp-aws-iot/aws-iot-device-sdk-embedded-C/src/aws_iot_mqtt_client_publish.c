@@ -80,6 +80,8 @@ static IoT_Error_t _aws_iot_mqtt_read_string_with_len(char **stringVar, uint16_t
   * @param topicNameLen uint16_t - the length of the Topic Name
   * @param pPayload byte buffer - the MQTT publish payload
   * @param payloadLen size_t - the length of the MQTT payload
+  * @param version MQTT_Ver_t - the protocol version of the session
+  * @param topicAlias uint16_t - MQTT 5 topic alias, 0 for none. Pass topicNameLen 0 to send the alias only
   * @param pSerializedLen uint32_t - pointer to the variable that stores serialized len
   *
   * @return An IoT Error Type defining successful/failed call
@@ -88,9 +90,11 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 															QoS qos, uint8_t retained, uint16_t packetId,
 															const char *pTopicName, uint16_t topicNameLen,
 															const unsigned char *pPayload, size_t payloadLen,
+															MQTT_Ver_t version, uint16_t topicAlias,
 															uint32_t *pSerializedLen) {
 	unsigned char *ptr;
 	uint32_t rem_len;
+	uint32_t properties_len = 0;
 	IoT_Error_t rc;
 	MQTTHeader header = {0};
 
@@ -106,6 +110,17 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 	if(qos > 0) {
 		rem_len += 2; /* packetId */
 	}
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		if(0 != topicAlias) {
+			properties_len = 3; /* Topic Alias */
+		}
+		rem_len += properties_len + aws_iot_mqtt_internal_get_var_int_len(properties_len);
+	}
+#else
+	(void) version;
+	(void) topicAlias;
+#endif
 	if(aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(rem_len) > txBufLen) {
 		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
 	}
@@ -124,6 +139,18 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 		aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		ptr += aws_iot_mqtt_internal_write_len_to_buffer(ptr, properties_len);
+		if(0 != topicAlias) {
+			aws_iot_mqtt_internal_write_char(&ptr, MQTT5_PROPERTY_TOPIC_ALIAS);
+			aws_iot_mqtt_internal_write_uint_16(&ptr, topicAlias);
+		}
+	}
+#else
+	(void) properties_len;
+#endif
+
 	memcpy(ptr, pPayload, payloadLen);
 	ptr += payloadLen;
 
@@ -177,6 +204,71 @@ IoT_Error_t aws_iot_mqtt_internal_serialize_ack(unsigned char *pTxBuf, size_t tx
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+#ifdef ENABLE_IOT_MQTT5
+void aws_iot_mqtt_internal_reset_topic_aliases(AWS_IoT_Client *pClient) {
+	uint16_t i;
+
+	for(i = 0; i < AWS_IOT_MQTT5_TOPIC_ALIASES; i++) {
+		pClient->clientData.topicAliases[i].topicNameLen = 0;
+		pClient->clientData.topicAliases[i].lastUse = 0;
+	}
+	pClient->clientData.topicAliasUseCount = 0;
+}
+
+/**
+  * Picks the topic alias for a publish. A topic that already has an alias is sent as the
+  * alias alone, otherwise a free or the least recently used alias is assigned to the topic.
+  * The table is only updated by _aws_iot_mqtt5_commit_topic_alias once the packet is sent,
+  * so a failed send does not leave an alias the server never learned.
+  * @param pClient Reference to the IoT Client
+  * @param pTopicName Topic Name to publish to
+  * @param topicNameLen Length of the topic name
+  * @param pIsKnown returns 1 if the server already knows the alias
+  *
+  * @return Alias to send, 0 if the topic is sent without an alias
+  */
+static uint16_t _aws_iot_mqtt5_get_topic_alias(AWS_IoT_Client *pClient, const char *pTopicName,
+											   uint16_t topicNameLen, uint8_t *pIsKnown) {
+	TopicAlias *pAliases = pClient->clientData.topicAliases;
+	uint16_t aliasCount = pClient->clientData.topicAliasMax;
+	uint16_t i, slot = 0;
+
+	*pIsKnown = 0;
+	if(AWS_IOT_MQTT5_TOPIC_ALIASES < aliasCount) {
+		aliasCount = AWS_IOT_MQTT5_TOPIC_ALIASES;
+	}
+	if(0 == aliasCount || AWS_IOT_MQTT5_TOPIC_ALIAS_LEN < topicNameLen) {
+		return 0;
+	}
+
+	for(i = 0; i < aliasCount; i++) {
+		if(pAliases[i].topicNameLen == topicNameLen && 0 == memcmp(pAliases[i].topicName, pTopicName, topicNameLen)) {
+			*pIsKnown = 1;
+			return (uint16_t) (i + 1);
+		}
+		if(pAliases[i].lastUse < pAliases[slot].lastUse) {
+			slot = i;
+		}
+	}
+
+	return (uint16_t) (slot + 1);
+}
+
+/**
+  * Records that the server now maps alias to the topic, or refreshes a known alias
+  */
+static void _aws_iot_mqtt5_commit_topic_alias(AWS_IoT_Client *pClient, uint16_t alias, const char *pTopicName,
+											  uint16_t topicNameLen) {
+	TopicAlias *pAlias = &(pClient->clientData.topicAliases[alias - 1]);
+
+	if(pAlias->topicNameLen != topicNameLen || 0 != memcmp(pAlias->topicName, pTopicName, topicNameLen)) {
+		memcpy(pAlias->topicName, pTopicName, topicNameLen);
+		pAlias->topicNameLen = topicNameLen;
+	}
+	pAlias->lastUse = ++(pClient->clientData.topicAliasUseCount);
+}
+#endif
+
 /**
  * @brief Publish an MQTT message on a topic
  *
@@ -200,7 +292,13 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 	uint32_t len = 0;
 	uint16_t packet_id;
 	unsigned char dup, type;
+	uint16_t topicAlias = 0;
+	uint16_t sentTopicNameLen = topicNameLen;
 	IoT_Error_t rc;
+#ifdef ENABLE_IOT_MQTT5
+	uint8_t isAliasKnown = 0;
+	uint8_t reasonCode;
+#endif
 
 	FUNC_ENTRY;
 
@@ -211,20 +309,48 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 		pParams->id = aws_iot_mqtt_get_next_packet_id(pClient);
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == pClient->clientData.options.MQTTVersion) {
+		topicAlias = _aws_iot_mqtt5_get_topic_alias(pClient, pTopicName, topicNameLen, &isAliasKnown);
+		if(isAliasKnown) {
+			sentTopicNameLen = 0;
+		}
+	}
+#endif
+
 	rc = _aws_iot_mqtt_internal_serialize_publish(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
 												  pParams->qos, pParams->isRetained, pParams->id, pTopicName,
-												  topicNameLen, (unsigned char *) pParams->payload,
-												  pParams->payloadLen, &len);
+												  sentTopicNameLen, (unsigned char *) pParams->payload,
+												  pParams->payloadLen, pClient->clientData.options.MQTTVersion,
+												  topicAlias, &len);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
 
-	/* send the publish packet */
-	rc = aws_iot_mqtt_internal_send_packet(pClient, len, &timer);
+#ifdef ENABLE_IOT_MQTT5
+	if(0 != pClient->clientData.maxPacketSize && len > pClient->clientData.maxPacketSize) {
+		IOT_ERROR("PUBLISH of %u bytes exceeds the server maximum packet size", (unsigned int) len);
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+#endif
+
+	/* send the publish packet, a QoS 0 publish made during a yield cycle joins the cycle's batch.
+	 * A QoS 1 publish is sent right away because its PUBACK is awaited below. */
+	if(QOS0 == pParams->qos) {
+		rc = aws_iot_mqtt_internal_queue_packet(pClient, len, &timer);
+	} else {
+		rc = aws_iot_mqtt_internal_send_packet(pClient, len, &timer);
+	}
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(0 != topicAlias) {
+		_aws_iot_mqtt5_commit_topic_alias(pClient, topicAlias, pTopicName, topicNameLen);
+	}
+#endif
+
 	/* Wait for ack if QoS1 */
 	if(QOS1 == pParams->qos) {
 		rc = aws_iot_mqtt_internal_wait_for_read(pClient, PUBACK, &timer);
@@ -237,6 +363,22 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
+
+#ifdef ENABLE_IOT_MQTT5
+		if(MQTT_5 == pClient->clientData.options.MQTTVersion) {
+			rc = aws_iot_mqtt_internal_read_ack_reason_code(pClient->clientData.readBuf,
+															pClient->clientData.readBufSize, &reasonCode);
+			if(SUCCESS != rc) {
+				FUNC_EXIT_RC(rc);
+			}
+			pClient->clientData.lastReasonCode = reasonCode;
+			/* 0x10 "No matching subscribers" still means the message was accepted */
+			if(MQTT5_REASON_CODE_FAILURE <= reasonCode) {
+				IOT_WARN("PUBACK reason code 0x%02X", reasonCode);
+				FUNC_EXIT_RC(MQTT_REASON_CODE_ERROR);
+			}
+		}
+#endif
 	}
 
 	FUNC_EXIT_RC(SUCCESS);
@@ -287,6 +429,7 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
   * @param topicNameLen returned uint16_t - the length of the MQTT topic in the publish
   * @param payload returned byte buffer - the MQTT publish payload
   * @param payloadLen returned size_t - the length of the MQTT payload
+  * @param version the protocol version of the session, MQTT 5 packets carry properties
   * @param pRxBuf the raw buffer data, of the correct length determined by the remaining length field
   * @param rxBufLen the length in bytes of the data in the supplied buffer
   *
@@ -296,7 +439,7 @@ IoT_Error_t aws_iot_mqtt_internal_deserialize_publish(uint8_t *dup, QoS *qos,
 													  uint8_t *retained, uint16_t *pPacketId,
 													  char **pTopicName, uint16_t *topicNameLen,
 													  unsigned char **payload, size_t *payloadLen,
-													  unsigned char *pRxBuf, size_t rxBufLen) {
+													  MQTT_Ver_t version, unsigned char *pRxBuf, size_t rxBufLen) {
 	unsigned char *curData = pRxBuf;
 	unsigned char *endData = NULL;
 	IoT_Error_t rc = FAILURE;
@@ -347,6 +490,17 @@ IoT_Error_t aws_iot_mqtt_internal_deserialize_publish(uint8_t *dup, QoS *qos,
 		*pPacketId = aws_iot_mqtt_internal_read_uint16_t(&curData);
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		/* The client never offers a Topic Alias Maximum, so the server must send the topic */
+		if(0 == *topicNameLen || SUCCESS != aws_iot_mqtt_internal_read_properties_len(&curData, endData, &curData)) {
+			FUNC_EXIT_RC(FAILURE);
+		}
+	}
+#else
+	(void) version;
+#endif
+
 	*payloadLen = (size_t) (endData - curData);
 	*payload = curData;
 
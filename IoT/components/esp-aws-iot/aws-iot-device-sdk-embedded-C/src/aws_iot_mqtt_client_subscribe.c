@@ -51,6 +51,7 @@ extern "C" {
   * @param pTopicNameList - array of topic filter names
   * @param pTopicNameLenList - array of length of topic filter names
   * @param pRequestedQoSs - array of requested QoS
+  * @param version - the protocol version of the session
   * @param pSerializedLen - the length of the serialized data
   *
   * @return An IoT Error Type defining successful/failed operation
@@ -58,7 +59,8 @@ extern "C" {
 static IoT_Error_t _aws_iot_mqtt_serialize_subscribe(unsigned char *pTxBuf, size_t txBufLen,
 													 unsigned char dup, uint16_t packetId, uint32_t topicCount,
 													 const char **pTopicNameList, uint16_t *pTopicNameLenList,
-													 QoS *pRequestedQoSs, uint32_t *pSerializedLen) {
+													 QoS *pRequestedQoSs, MQTT_Ver_t version,
+													 uint32_t *pSerializedLen) {
 	unsigned char *ptr;
 	uint32_t itr, rem_len;
 	IoT_Error_t rc;
@@ -71,6 +73,13 @@ static IoT_Error_t _aws_iot_mqtt_serialize_subscribe(unsigned char *pTxBuf, size
 
 	ptr = pTxBuf;
 	rem_len = 2; /* packetId */
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		rem_len += 1; /* empty properties */
+	}
+#else
+	(void) version;
+#endif
 
 	for(itr = 0; itr < topicCount; ++itr) {
 		rem_len += (uint32_t) (pTopicNameLenList[itr] + 2 + 1); /* topic + length + req_qos */
@@ -92,6 +101,12 @@ static IoT_Error_t _aws_iot_mqtt_serialize_subscribe(unsigned char *pTxBuf, size
 
 	aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		aws_iot_mqtt_internal_write_char(&ptr, 0);
+	}
+#endif
+
 	for(itr = 0; itr < topicCount; ++itr) {
 		aws_iot_mqtt_internal_write_utf8_string(&ptr, pTopicNameList[itr], pTopicNameLenList[itr]);
 		aws_iot_mqtt_internal_write_char(&ptr, (unsigned char) pRequestedQoSs[itr]);
@@ -107,7 +122,8 @@ static IoT_Error_t _aws_iot_mqtt_serialize_subscribe(unsigned char *pTxBuf, size
   * @param pPacketId returned integer - the MQTT packet identifier
   * @param maxExpectedQoSCount - the maximum number of members allowed in the grantedQoSs array
   * @param pGrantedQoSCount returned uint32_t - number of members in the grantedQoSs array
-  * @param pGrantedQoSs returned array of QoS type - the granted qualities of service
+  * @param pGrantedQoSs returned array of QoS type - the granted qualities of service, reason codes on MQTT 5
+  * @param version the protocol version of the session
   * @param pRxBuf the raw buffer data, of the correct length determined by the remaining length field
   * @param rxBufLen the length in bytes of the data in the supplied buffer
   *
@@ -115,7 +131,7 @@ static IoT_Error_t _aws_iot_mqtt_serialize_subscribe(unsigned char *pTxBuf, size
   */
 static IoT_Error_t _aws_iot_mqtt_deserialize_suback(uint16_t *pPacketId, uint32_t maxExpectedQoSCount,
 													uint32_t *pGrantedQoSCount, QoS *pGrantedQoSs,
-													unsigned char *pRxBuf, size_t rxBufLen) {
+													MQTT_Ver_t version, unsigned char *pRxBuf, size_t rxBufLen) {
 	unsigned char *curData, *endData;
 	uint32_t decodedLen, readBytesLen;
 	IoT_Error_t decodeRc;
@@ -158,6 +174,14 @@ static IoT_Error_t _aws_iot_mqtt_deserialize_suback(uint16_t *pPacketId, uint32_
 
 	*pPacketId = aws_iot_mqtt_internal_read_uint16_t(&curData);
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version && SUCCESS != aws_iot_mqtt_internal_read_properties_len(&curData, endData, &curData)) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+#else
+	(void) version;
+#endif
+
 	*pGrantedQoSCount = 0;
 	while(curData < endData) {
 		if(*pGrantedQoSCount > maxExpectedQoSCount) {
@@ -169,6 +193,29 @@ static IoT_Error_t _aws_iot_mqtt_deserialize_suback(uint16_t *pPacketId, uint32_
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+#ifdef ENABLE_IOT_MQTT5
+/**
+  * Checks the SUBACK reason code of an MQTT 5 session, a refused subscription is an error
+  * @param pClient Reference to the IoT Client, receives the reason code
+  * @param reasonCode granted QoS or reason code from the SUBACK
+  *
+  * @return SUCCESS or MQTT_REASON_CODE_ERROR
+  */
+static IoT_Error_t _aws_iot_mqtt5_check_suback(AWS_IoT_Client *pClient, QoS reasonCode) {
+	if(MQTT_5 != pClient->clientData.options.MQTTVersion) {
+		return SUCCESS;
+	}
+
+	pClient->clientData.lastReasonCode = (uint8_t) reasonCode;
+	if(MQTT5_REASON_CODE_FAILURE <= (uint8_t) reasonCode) {
+		IOT_WARN("SUBACK reason code 0x%02X", (uint8_t) reasonCode);
+		return MQTT_REASON_CODE_ERROR;
+	}
+
+	return SUCCESS;
+}
+#endif
+
 /* Returns MAX_MESSAGE_HANDLERS value if no free index is available */
 static uint32_t _aws_iot_mqtt_get_free_message_handler_index(AWS_IoT_Client *pClient) {
 	uint32_t itr;
@@ -224,7 +271,8 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 	rxPacketId = 0;
 
 	rc = _aws_iot_mqtt_serialize_subscribe(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
-										   txPacketId, 1, &pTopicName, &topicNameLen, &qos, &serializedLen);
+										   txPacketId, 1, &pTopicName, &topicNameLen, &qos,
+										   pClient->clientData.options.MQTTVersion, &serializedLen);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
@@ -247,11 +295,18 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 	}
 
 	/* Granted QoS can be 0, 1 or 2 */
-	rc = _aws_iot_mqtt_deserialize_suback(&rxPacketId, 1, &count, grantedQoS, pClient->clientData.readBuf,
-										  pClient->clientData.readBufSize);
+	rc = _aws_iot_mqtt_deserialize_suback(&rxPacketId, 1, &count, grantedQoS, pClient->clientData.options.MQTTVersion,
+										  pClient->clientData.readBuf, pClient->clientData.readBufSize);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+#ifdef ENABLE_IOT_MQTT5
+	rc = _aws_iot_mqtt5_check_suback(pClient, grantedQoS[0]);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
+#endif
 
 	/* TODO : Figure out how to test this before activating this check */
 	//if(txPacketId != rxPacketId) {
@@ -354,7 +409,8 @@ static IoT_Error_t _aws_iot_mqtt_internal_resubscribe(AWS_IoT_Client *pClient) {
 											   aws_iot_mqtt_get_next_packet_id(pClient), 1,
 											   &(pClient->clientData.messageHandlers[itr].topicName),
 											   &(pClient->clientData.messageHandlers[itr].topicNameLen),
-											   &(pClient->clientData.messageHandlers[itr].qos), &len);
+											   &(pClient->clientData.messageHandlers[itr].qos),
+											   pClient->clientData.options.MQTTVersion, &len);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
@@ -372,12 +428,20 @@ static IoT_Error_t _aws_iot_mqtt_internal_resubscribe(AWS_IoT_Client *pClient) {
 		}
 
 		/* Granted QoS can be 0, 1 or 2 */
-		rc = _aws_iot_mqtt_deserialize_suback(&packetId, 1, &count, grantedQoS, pClient->clientData.readBuf,
+		rc = _aws_iot_mqtt_deserialize_suback(&packetId, 1, &count, grantedQoS,
+											  pClient->clientData.options.MQTTVersion, pClient->clientData.readBuf,
 											  pClient->clientData.readBufSize);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
 
+#ifdef ENABLE_IOT_MQTT5
+		rc = _aws_iot_mqtt5_check_suback(pClient, grantedQoS[0]);
+		if(SUCCESS != rc) {
+			FUNC_EXIT_RC(rc);
+		}
+#endif
+
 		/* Record that this topic has been subscribed to, so that we do not
 		 * attempt to subscribe again to the same topic. */
 		pClient->clientData.messageHandlers[itr].resubscribed = 1;
@@ -50,13 +50,15 @@ extern "C" {
   * @param count - number of members in the topicFilters array
   * @param pTopicNameList - array of topic filter names
   * @param pTopicNameLenList - array of length of topic filter names in pTopicNameList
+  * @param version - the protocol version of the session
   * @param pSerializedLen - the length of the serialized data
   * @return IoT_Error_t indicating function execution status
   */
 static IoT_Error_t _aws_iot_mqtt_serialize_unsubscribe(unsigned char *pTxBuf, size_t txBufLen,
 													   uint8_t dup, uint16_t packetId,
 													   uint32_t count, const char **pTopicNameList,
-													   uint16_t *pTopicNameLenList, uint32_t *pSerializedLen) {
+													   uint16_t *pTopicNameLenList, MQTT_Ver_t version,
+													   uint32_t *pSerializedLen) {
 	unsigned char *ptr = pTxBuf;
 	uint32_t i = 0;
 	uint32_t rem_len = 2; /* packetId */
@@ -65,6 +67,14 @@ static IoT_Error_t _aws_iot_mqtt_serialize_unsubscribe(unsigned char *pTxBuf, si
 
 	FUNC_ENTRY;
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		rem_len += 1; /* empty properties */
+	}
+#else
+	(void) version;
+#endif
+
 	for(i = 0; i < count; ++i) {
 		rem_len += (uint32_t) (pTopicNameLenList[i] + 2); /* topic + length */
 	}
@@ -83,6 +93,12 @@ static IoT_Error_t _aws_iot_mqtt_serialize_unsubscribe(unsigned char *pTxBuf, si
 
 	aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == version) {
+		aws_iot_mqtt_internal_write_char(&ptr, 0);
+	}
+#endif
+
 	for(i = 0; i < count; ++i) {
 		aws_iot_mqtt_internal_write_utf8_string(&ptr, pTopicNameList[i], pTopicNameLenList[i]);
 	}
@@ -141,6 +157,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_unsubscribe(AWS_IoT_Client *pClient, c
 	uint32_t i = 0;
 	IoT_Error_t rc;
 	bool subscriptionExists = false;
+#ifdef ENABLE_IOT_MQTT5
+	uint8_t reasonCode;
+#endif
 
 	FUNC_ENTRY;
 
@@ -162,7 +181,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_unsubscribe(AWS_IoT_Client *pClient, c
 
 	rc = _aws_iot_mqtt_serialize_unsubscribe(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
 											 aws_iot_mqtt_get_next_packet_id(pClient), 1, &pTopicFilter,
-											 &topicFilterLen, &serializedLen);
+											 &topicFilterLen, pClient->clientData.options.MQTTVersion, &serializedLen);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
@@ -183,6 +202,22 @@ static IoT_Error_t _aws_iot_mqtt_internal_unsubscribe(AWS_IoT_Client *pClient, c
 		FUNC_EXIT_RC(rc);
 	}
 
+#ifdef ENABLE_IOT_MQTT5
+	if(MQTT_5 == pClient->clientData.options.MQTTVersion) {
+		rc = aws_iot_mqtt_internal_read_ack_reason_code(pClient->clientData.readBuf, pClient->clientData.readBufSize,
+														&reasonCode);
+		if(SUCCESS != rc) {
+			FUNC_EXIT_RC(rc);
+		}
+		pClient->clientData.lastReasonCode = reasonCode;
+		/* Keep the handler, the server still has the subscription */
+		if(MQTT5_REASON_CODE_FAILURE <= reasonCode) {
+			IOT_WARN("UNSUBACK reason code 0x%02X", reasonCode);
+			FUNC_EXIT_RC(MQTT_REASON_CODE_ERROR);
+		}
+	}
+#endif
+
 	/* Remove from message handler array */
 	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
 		if(pClient->clientData.messageHandlers[i].topicName != NULL &&
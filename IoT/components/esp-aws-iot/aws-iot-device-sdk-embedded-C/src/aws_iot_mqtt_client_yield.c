@@ -46,6 +46,9 @@ extern "C" {
   */
 static void _aws_iot_mqtt_force_client_disconnect(AWS_IoT_Client *pClient) {
 	pClient->clientStatus.clientState = CLIENT_STATE_DISCONNECTED_ERROR;
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+	aws_iot_mqtt_internal_discard_packets(pClient);
+#endif
 	pClient->networkStack.disconnect(&(pClient->networkStack));
 	pClient->networkStack.destroy(&(pClient->networkStack));
 }
@@ -161,7 +164,7 @@ static IoT_Error_t _aws_iot_mqtt_keep_alive(AWS_IoT_Client *pClient) {
 	}
 
 	/* send the ping packet */
-	rc = aws_iot_mqtt_internal_send_packet(pClient, serialized_len, &timer);
+	rc = aws_iot_mqtt_internal_queue_packet(pClient, serialized_len, &timer);
 	if(SUCCESS != rc) {
 		//If sending a PING fails we can no longer determine if we are connected.  In this case we decide we are disconnected and begin reconnection attempts
 		rc = _aws_iot_mqtt_handle_disconnect(pClient);
@@ -229,12 +232,27 @@ static IoT_Error_t _aws_iot_mqtt_internal_yield(AWS_IoT_Client *pClient, uint32_
 			continue;
 		}
 
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+		/* PUBACKs, PINGREQs and QoS 0 PUBLISHes from subscription callbacks
+		 * produced in this cycle are written together at its end */
+		pClient->clientData.isCoalescingWrites = true;
+#endif
 		yieldRc = aws_iot_mqtt_internal_cycle_read(pClient, &timer, &packet_type);
 		if(SUCCESS == yieldRc) {
 			yieldRc = _aws_iot_mqtt_keep_alive(pClient);
+		}
+#ifdef ENABLE_IOT_MQTT_WRITE_COALESCING
+		pClient->clientData.isCoalescingWrites = false;
+		if(SUCCESS == yieldRc) {
+			yieldRc = aws_iot_mqtt_internal_flush_packets(pClient, NULL);
 		} else {
-			// SSL read and write errors are terminal, connection must be closed and retried
-			if(NETWORK_SSL_READ_ERROR == yieldRc || NETWORK_SSL_WRITE_ERROR == yieldRc || NETWORK_SSL_WRITE_TIMEOUT_ERROR == yieldRc) {
+			aws_iot_mqtt_internal_discard_packets(pClient);
+		}
+#endif
+		if(SUCCESS != yieldRc) {
+			// SSL read and write errors and a DISCONNECT from the server are terminal, connection must be closed and retried
+			if(NETWORK_SSL_READ_ERROR == yieldRc || NETWORK_SSL_WRITE_ERROR == yieldRc || NETWORK_SSL_WRITE_TIMEOUT_ERROR == yieldRc ||
+			   MQTT_SERVER_DISCONNECT_ERROR == yieldRc) {
 				yieldRc = _aws_iot_mqtt_handle_disconnect(pClient);
 			}
 		}
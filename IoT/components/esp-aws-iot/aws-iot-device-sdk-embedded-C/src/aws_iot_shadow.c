@@ -30,8 +30,13 @@ extern "C" {
 #include "aws_iot_shadow_actions.h"
 #include "aws_iot_shadow_json.h"
 #include "aws_iot_shadow_key.h"
+#include "aws_iot_shadow_mirror.h"
 #include "aws_iot_shadow_records.h"
 
+#ifndef AWS_IOT_SHADOW_MQTT_VERSION
+#define AWS_IOT_SHADOW_MQTT_VERSION MQTT_3_1_1 ///< Protocol version of the Shadow MQTT connection
+#endif
+
 const ShadowInitParameters_t ShadowInitParametersDefault = {(char *) AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, NULL, NULL,
 															NULL, false, NULL};
 
@@ -100,6 +105,9 @@ IoT_Error_t aws_iot_shadow_init(AWS_IoT_Client *pClient, const ShadowInitParamet
 	resetClientTokenSequenceNum();
 	aws_iot_shadow_reset_last_received_version();
 	initDeltaTokens();
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+	aws_iot_shadow_mirror_reset();
+#endif
 
 	FUNC_EXIT_RC(SUCCESS);
 }
@@ -119,7 +127,7 @@ IoT_Error_t aws_iot_shadow_connect(AWS_IoT_Client *pClient, const ShadowConnectP
 	snprintf(mqttClientID, MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES, "%s", pParams->pMqttClientId);
 
 	ConnectParams.keepAliveIntervalInSec = 600; // NOTE: Temporary fix
-	ConnectParams.MQTTVersion = MQTT_3_1_1;
+	ConnectParams.MQTTVersion = AWS_IOT_SHADOW_MQTT_VERSION;
 	ConnectParams.isCleanSession = true;
 	ConnectParams.isWillMsgPresent = false;
 	ConnectParams.pClientID = pParams->pMqttClientId;
@@ -134,6 +142,9 @@ IoT_Error_t aws_iot_shadow_connect(AWS_IoT_Client *pClient, const ShadowConnectP
 	}
 
 	initializeRecords(pClient);
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+	aws_iot_shadow_mirror_invalidate();
+#endif
 
 	if(NULL != pParams->deleteActionHandler) {
 		snprintf(deleteAcceptedTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES,
@@ -159,12 +170,23 @@ IoT_Error_t aws_iot_shadow_register_delta(AWS_IoT_Client *pMqttClient, jsonStruc
 }
 
 IoT_Error_t aws_iot_shadow_yield(AWS_IoT_Client *pClient, uint32_t timeout) {
+	IoT_Error_t rc;
+
 	if(NULL == pClient) {
 		return NULL_VALUE_ERROR;
 	}
 
 	HandleExpiredResponseCallbacks();
-	return aws_iot_mqtt_yield(pClient, timeout);
+	rc = aws_iot_mqtt_yield(pClient, timeout);
+
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+	if(NETWORK_RECONNECTED == rc) {
+		/* Updates published while the connection was down were not seen */
+		aws_iot_shadow_mirror_invalidate();
+	}
+#endif
+
+	return rc;
 }
 
 IoT_Error_t aws_iot_shadow_disconnect(AWS_IoT_Client *pClient) {
@@ -25,6 +25,8 @@ extern "C" {
 #include "aws_iot_shadow_actions.h"
 
 #include "aws_iot_log.h"
+#include "aws_iot_buffer_arena.h"
+#include "aws_iot_latency_trace.h"
 #include "aws_iot_shadow_json.h"
 #include "aws_iot_shadow_records.h"
 #include "aws_iot_config.h"
@@ -37,6 +39,9 @@ IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions
 	bool isAckWaitListFree = false;
 	uint8_t indexAckWaitList;
 	char extractedClientToken[MAX_SIZE_CLIENT_ID_WITH_SEQUENCE];
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	IoT_Arena_Mark_t actionScope;
+#endif
 
 	FUNC_ENTRY;
 
@@ -44,6 +49,13 @@ IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	/* Parser tokens and topic names used for this request live until it is published */
+	actionScope = aws_iot_arena_mark();
+#endif
+
+	IOT_LATENCY_TRACE(IOT_TRACE_SHADOW_ACTION, action);
+
 	isClientTokenPresent = extractClientToken(pJsonDocumentToBeSent, jsonSize, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
 
 	if(isClientTokenPresent && (NULL != callback)) {
@@ -72,6 +84,10 @@ IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions
 						 timeout_seconds);
 	}
 
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	aws_iot_arena_release(actionScope);
+#endif
+
 	FUNC_EXIT_RC(ret_val);
 }
 
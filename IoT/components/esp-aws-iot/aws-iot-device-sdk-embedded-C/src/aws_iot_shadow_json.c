@@ -29,6 +29,7 @@ extern "C" {
 
 #include "aws_iot_json_utils.h"
 #include "aws_iot_log.h"
+#include "aws_iot_buffer_arena.h"
 #include "aws_iot_shadow_key.h"
 #include "aws_iot_config.h"
 
@@ -374,17 +375,45 @@ static IoT_Error_t convertDataToString(char *pStringBuffer, size_t maxSizoString
 }
 
 static jsmn_parser shadowJsonParser;
+
+#ifdef ENABLE_IOT_BUFFER_ARENA
+static jsmntok_t *jsonTokenStruct = NULL;
+static uint32_t jsonTokenTicket = 0;
+
+/* The tokens are only needed while one document is parsed and inspected. Take
+ * them from the arena scope of the current packet and reuse them until that
+ * scope is released. */
+static bool acquireJsonTokens(void) {
+	if(NULL == jsonTokenStruct || 0 == jsonTokenTicket || aws_iot_arena_ticket(jsonTokenStruct) != jsonTokenTicket) {
+		jsonTokenStruct = (jsmntok_t *) aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS,
+															sizeof(jsmntok_t) * MAX_JSON_TOKEN_EXPECTED);
+		jsonTokenTicket = aws_iot_arena_ticket(jsonTokenStruct);
+	}
+	return NULL != jsonTokenStruct;
+}
+
+static bool areJsonTokensLive(void) {
+	return 0 != jsonTokenTicket && aws_iot_arena_ticket(jsonTokenStruct) == jsonTokenTicket;
+}
+#else
 static jsmntok_t jsonTokenStruct[MAX_JSON_TOKEN_EXPECTED];
 
+#define acquireJsonTokens() (true)
+#define areJsonTokensLive() (true)
+#endif
+
 bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, void *pJsonHandler, int32_t *pTokenCount) {
 	int32_t tokenCount;
 
 	IOT_UNUSED(pJsonHandler);
 
+	if(!acquireJsonTokens()) {
+		return false;
+	}
+
 	jsmn_init(&shadowJsonParser);
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
@@ -437,6 +466,10 @@ bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, void *pJsonHandl
 
 	IOT_UNUSED(pJsonHandler);
 
+	if(!areJsonTokensLive()) {
+		return false;
+	}
+
 	for(i = 1; i < tokenCount; ) {
 		if(jsoneq(pJsonDocument, &(jsonTokenStruct[i]), pDataStruct->pKey) == 0) {
 			dataToken = jsonTokenStruct[i + 1];
@@ -480,10 +513,13 @@ bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, void *pJsonHandl
 bool isReceivedJsonValid(const char *pJsonDocument, size_t jsonSize ) {
 	int32_t tokenCount;
 
+	if(!acquireJsonTokens()) {
+		return false;
+	}
+
 	jsmn_init(&shadowJsonParser);
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
@@ -502,10 +538,14 @@ bool extractClientToken(const char *pJsonDocument, size_t jsonSize, char *pExtra
 	int32_t tokenCount, i;
 	size_t length;
 	jsmntok_t ClientJsonToken;
+
+	if(!acquireJsonTokens()) {
+		return false;
+	}
+
 	jsmn_init(&shadowJsonParser);
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
@@ -542,6 +582,10 @@ bool extractVersionNumber(const char *pJsonDocument, void *pJsonHandler, int32_t
 
 	IOT_UNUSED(pJsonHandler);
 
+	if(!areJsonTokensLive()) {
+		return false;
+	}
+
 	for(i = 1; i < tokenCount; i++) {
 		if(jsoneq(pJsonDocument, &(jsonTokenStruct[i]), SHADOW_VERSION_STRING) == 0) {
 			ret_val = parseUnsignedInteger32Value(pVersionNumber, pJsonDocument, &jsonTokenStruct[i + 1]);
@@ -553,6 +597,15 @@ bool extractVersionNumber(const char *pJsonDocument, void *pJsonHandler, int32_t
 	return false;
 }
 
+/* Tokens of the document last parsed by isJsonValidAndParse(), or NULL once
+ * they have been released. Any other parse in this file overwrites them. */
+const jsmntok_t *getParsedJsonTokens(void) {
+	if(!areJsonTokensLive()) {
+		return NULL;
+	}
+	return jsonTokenStruct;
+}
+
 #ifdef __cplusplus
 }
 #endif
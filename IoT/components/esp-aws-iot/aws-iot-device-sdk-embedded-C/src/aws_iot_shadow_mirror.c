@@ -0,0 +1,519 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_mirror.c
+ * @brief Local mirror of the Thing Shadow document
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_shadow_mirror.h"
+
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+
+#include <string.h>
+
+#include "aws_iot_json_utils.h"
+#include "aws_iot_log.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_key.h"
+
+typedef struct {
+	bool inUse;
+	bool seen;    ///< Present in the get/accepted document being merged
+	uint8_t section;
+	uint8_t type;
+	char key[AWS_IOT_SHADOW_MIRROR_KEY_LEN];
+	char value[AWS_IOT_SHADOW_MIRROR_VALUE_LEN];
+} ShadowMirrorField_t;
+
+typedef struct {
+	ShadowMirrorSection_t section;
+	const char *pKey;
+	IoT_Shadow_Mirror_Callback_t callback;
+	void *pContext;
+} ShadowMirrorCallbackRecord_t;
+
+static ShadowMirrorField_t mirrorFields[AWS_IOT_SHADOW_MIRROR_MAX_FIELDS];
+static ShadowMirrorCallbackRecord_t mirrorCallbacks[AWS_IOT_SHADOW_MIRROR_MAX_CALLBACKS];
+static IoT_Shadow_Mirror_Stats_t mirrorStats;
+static uint32_t mirrorVersion = 0;
+static bool mirrorSeeded = false;
+static bool mirrorStale = false;
+static bool mirrorNotify = true;   ///< Cleared while the first seed is merged
+
+void aws_iot_shadow_mirror_reset(void) {
+	memset(mirrorFields, 0, sizeof(mirrorFields));
+	memset(mirrorCallbacks, 0, sizeof(mirrorCallbacks));
+	memset(&mirrorStats, 0, sizeof(mirrorStats));
+	mirrorVersion = 0;
+	mirrorSeeded = false;
+	mirrorStale = false;
+	mirrorNotify = true;
+}
+
+void aws_iot_shadow_mirror_invalidate(void) {
+	mirrorStale = true;
+}
+
+bool aws_iot_shadow_mirror_needs_resync(void) {
+	return !mirrorSeeded || mirrorStale;
+}
+
+uint32_t aws_iot_shadow_mirror_get_version(void) {
+	return mirrorVersion;
+}
+
+void aws_iot_shadow_mirror_get_stats(IoT_Shadow_Mirror_Stats_t *pStats) {
+	if(NULL != pStats) {
+		*pStats = mirrorStats;
+	}
+}
+
+IoT_Error_t aws_iot_shadow_mirror_register_callback(ShadowMirrorSection_t section, const char *pKey,
+													IoT_Shadow_Mirror_Callback_t callback, void *pContext) {
+	uint8_t i;
+
+	if(NULL == callback) {
+		return NULL_VALUE_ERROR;
+	}
+
+	for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_CALLBACKS; i++) {
+		if(NULL == mirrorCallbacks[i].callback) {
+			mirrorCallbacks[i].section = section;
+			mirrorCallbacks[i].pKey = pKey;
+			mirrorCallbacks[i].callback = callback;
+			mirrorCallbacks[i].pContext = pContext;
+			return SUCCESS;
+		}
+	}
+
+	return LIMIT_EXCEEDED_ERROR;
+}
+
+static void notifyChange(const ShadowMirrorField_t *pField, bool removed) {
+	uint8_t i;
+
+	if(!mirrorNotify) {
+		return;
+	}
+
+	for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_CALLBACKS; i++) {
+		if(NULL == mirrorCallbacks[i].callback || (uint8_t) mirrorCallbacks[i].section != pField->section) {
+			continue;
+		}
+		if(NULL != mirrorCallbacks[i].pKey && 0 != strcmp(mirrorCallbacks[i].pKey, pField->key)) {
+			continue;
+		}
+		mirrorCallbacks[i].callback((ShadowMirrorSection_t) pField->section, pField->key,
+									removed ? NULL : pField->value, (ShadowMirrorValueType_t) pField->type,
+									mirrorCallbacks[i].pContext);
+	}
+}
+
+static ShadowMirrorField_t *findField(ShadowMirrorSection_t section, const char *pKey) {
+	uint16_t i;
+
+	for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_FIELDS; i++) {
+		if(mirrorFields[i].inUse && (uint8_t) section == mirrorFields[i].section &&
+		   0 == strcmp(mirrorFields[i].key, pKey)) {
+			return &mirrorFields[i];
+		}
+	}
+	return NULL;
+}
+
+/* The key and value stay in the slot until it is reused, so the callback
+ * still sees them after the field is gone from lookups. */
+static void removeField(ShadowMirrorField_t *pField) {
+	pField->inUse = false;
+	notifyChange(pField, true);
+}
+
+/* Remove pKey itself when withSelf is set, and every field nested under it.
+ * An empty key removes the whole section. */
+static void removeTree(ShadowMirrorSection_t section, const char *pKey, size_t keyLen, bool withSelf) {
+	uint16_t i;
+
+	for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_FIELDS; i++) {
+		ShadowMirrorField_t *pField = &mirrorFields[i];
+		if(!pField->inUse || (uint8_t) section != pField->section || 0 != strncmp(pField->key, pKey, keyLen)) {
+			continue;
+		}
+		if(0 == keyLen || '.' == pField->key[keyLen] || (withSelf && '\0' == pField->key[keyLen])) {
+			removeField(pField);
+		}
+	}
+}
+
+static void setField(ShadowMirrorSection_t section, const char *pKey, const char *pValue, size_t valueLen,
+					 ShadowMirrorValueType_t type) {
+	ShadowMirrorField_t *pField = findField(section, pKey);
+	uint16_t i;
+
+	if(valueLen >= AWS_IOT_SHADOW_MIRROR_VALUE_LEN) {
+		IOT_WARN("Shadow mirror value of %s too long (%u)", pKey, (unsigned int) valueLen);
+		mirrorStats.dropped++;
+		if(NULL != pField) {
+			/* Better no value than an outdated one */
+			removeField(pField);
+		}
+		return;
+	}
+
+	if(NULL != pField) {
+		pField->seen = true;
+		if((uint8_t) type == pField->type && 0 == strncmp(pField->value, pValue, valueLen) &&
+		   '\0' == pField->value[valueLen]) {
+			return;
+		}
+	} else {
+		for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_FIELDS && NULL == pField; i++) {
+			if(!mirrorFields[i].inUse) {
+				pField = &mirrorFields[i];
+			}
+		}
+		if(NULL == pField) {
+			IOT_WARN("Shadow mirror full, %s not kept", pKey);
+			mirrorStats.dropped++;
+			return;
+		}
+		pField->inUse = true;
+		pField->seen = true;
+		pField->section = (uint8_t) section;
+		strcpy(pField->key, pKey);
+	}
+
+	pField->type = (uint8_t) type;
+	memcpy(pField->value, pValue, valueLen);
+	pField->value[valueLen] = '\0';
+	notifyChange(pField, false);
+}
+
+/* Index of the first token after the value starting at index i */
+static int32_t skipValue(const jsmntok_t *pTokens, int32_t tokenCount, int32_t i) {
+	int32_t end = pTokens[i].end;
+
+	for(i++; i < tokenCount && pTokens[i].start < end; i++) {
+	}
+	return i;
+}
+
+/* Value token of a key in the object at index obj, or -1 */
+static int32_t findMember(const char *pJsonDocument, const jsmntok_t *pTokens, int32_t tokenCount, int32_t obj,
+						  const char *pKey) {
+	int32_t i = obj + 1;
+
+	while(i + 1 < tokenCount && pTokens[i].start < pTokens[obj].end) {
+		if(0 == jsoneq(pJsonDocument, (jsmntok_t *) &pTokens[i], pKey)) {
+			return i + 1;
+		}
+		i = skipValue(pTokens, tokenCount, i + 1);
+	}
+	return -1;
+}
+
+static bool isNullToken(const char *pJsonDocument, const jsmntok_t *pToken) {
+	return JSMN_PRIMITIVE == pToken->type && 'n' == pJsonDocument[pToken->start];
+}
+
+static void mergeObject(ShadowMirrorSection_t section, const char *pJsonDocument, const jsmntok_t *pTokens,
+						int32_t tokenCount, int32_t obj, char *pKey, size_t keyLen, uint8_t depth) {
+	int32_t i = obj + 1;
+
+	while(i + 1 < tokenCount && pTokens[i].start < pTokens[obj].end) {
+		const jsmntok_t *pName = &pTokens[i];
+		const jsmntok_t *pValue = &pTokens[i + 1];
+		size_t nameLen = (size_t) (pName->end - pName->start);
+		size_t childLen = keyLen + (keyLen > 0 ? 1 : 0) + nameLen;
+
+		if(childLen >= AWS_IOT_SHADOW_MIRROR_KEY_LEN || (JSMN_OBJECT == pValue->type &&
+														  depth >= AWS_IOT_SHADOW_MIRROR_MAX_DEPTH)) {
+			IOT_WARN("Shadow mirror key %.*s too long or too deep", (int) nameLen, pJsonDocument + pName->start);
+			mirrorStats.dropped++;
+		} else {
+			if(keyLen > 0) {
+				pKey[keyLen] = '.';
+			}
+			memcpy(&pKey[childLen - nameLen], pJsonDocument + pName->start, nameLen);
+			pKey[childLen] = '\0';
+
+			if(JSMN_OBJECT == pValue->type) {
+				ShadowMirrorField_t *pLeaf = findField(section, pKey);
+				if(NULL != pLeaf) {
+					removeField(pLeaf);
+				}
+				mergeObject(section, pJsonDocument, pTokens, tokenCount, i + 1, pKey, childLen, depth + 1);
+			} else if(isNullToken(pJsonDocument, pValue)) {
+				removeTree(section, pKey, childLen, true);
+			} else {
+				removeTree(section, pKey, childLen, false);
+				setField(section, pKey, pJsonDocument + pValue->start, (size_t) (pValue->end - pValue->start),
+						 JSMN_STRING == pValue->type ? SHADOW_MIRROR_TYPE_STRING :
+						 (JSMN_ARRAY == pValue->type ? SHADOW_MIRROR_TYPE_ARRAY : SHADOW_MIRROR_TYPE_PRIMITIVE));
+			}
+			pKey[keyLen] = '\0';
+		}
+
+		i = skipValue(pTokens, tokenCount, i + 1);
+	}
+}
+
+static void mergeSection(ShadowMirrorSection_t section, const char *pJsonDocument, const jsmntok_t *pTokens,
+						 int32_t tokenCount, int32_t value) {
+	char key[AWS_IOT_SHADOW_MIRROR_KEY_LEN];
+
+	if(value < 0) {
+		return;
+	}
+
+	if(JSMN_OBJECT == pTokens[value].type) {
+		key[0] = '\0';
+		mergeObject(section, pJsonDocument, pTokens, tokenCount, value, key, 0, 1);
+	} else if(isNullToken(pJsonDocument, &pTokens[value])) {
+		removeTree(section, "", 0, true);
+	}
+}
+
+/* A get is rejected with 404 when the Thing has no Shadow. That is a
+ * complete answer too, the Shadow is empty and starts over at version 1
+ * once something creates it. Other errors leave the mirror as it is. */
+static IoT_Error_t applyGetRejected(const char *pJsonDocument, const jsmntok_t *pTokens, int32_t tokenCount) {
+	int32_t codeIndex = findMember(pJsonDocument, pTokens, tokenCount, 0, "code");
+	uint32_t code = 0;
+
+	if(codeIndex < 0 || SUCCESS != parseUnsignedInteger32Value(&code, pJsonDocument,
+																 (jsmntok_t *) &pTokens[codeIndex])) {
+		return SHADOW_JSON_ERROR;
+	}
+
+	if(404 == code) {
+		removeTree(SHADOW_MIRROR_REPORTED, "", 0, true);
+		removeTree(SHADOW_MIRROR_DESIRED, "", 0, true);
+		mirrorVersion = 0;
+		mirrorSeeded = true;
+		mirrorStale = false;
+		mirrorStats.documents++;
+	}
+
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_mirror_apply_parsed(ShadowMirrorDocument_t docType, const char *pJsonDocument,
+											   int32_t tokenCount) {
+	const jsmntok_t *pTokens = getParsedJsonTokens();
+	int32_t versionIndex;
+	int32_t state;
+	uint32_t version = 0;
+	uint16_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pJsonDocument || NULL == pTokens || tokenCount < 1 || JSMN_OBJECT != pTokens[0].type) {
+		FUNC_EXIT_RC(SHADOW_JSON_ERROR);
+	}
+
+	if(SHADOW_MIRROR_DOC_GET_REJECTED == docType) {
+		FUNC_EXIT_RC(applyGetRejected(pJsonDocument, pTokens, tokenCount));
+	}
+
+	versionIndex = findMember(pJsonDocument, pTokens, tokenCount, 0, SHADOW_VERSION_STRING);
+	if(versionIndex < 0 || SUCCESS != parseUnsignedInteger32Value(&version, pJsonDocument,
+																	(jsmntok_t *) &pTokens[versionIndex])) {
+		FUNC_EXIT_RC(SHADOW_JSON_ERROR);
+	}
+
+	if(version < mirrorVersion) {
+		IOT_DEBUG("Shadow mirror at version %u, ignoring version %u", mirrorVersion, version);
+		mirrorStats.stale++;
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	/* update/accepted and the delta of the same update carry the same
+	 * version, so only a jump of more than one means updates were missed */
+	if(mirrorSeeded && SHADOW_MIRROR_DOC_GET_ACCEPTED != docType && version > mirrorVersion + 1) {
+		IOT_WARN("Shadow mirror skipped from version %u to %u", mirrorVersion, version);
+		mirrorStats.gaps++;
+		mirrorStale = true;
+	}
+
+	state = findMember(pJsonDocument, pTokens, tokenCount, 0, "state");
+
+	if(SHADOW_MIRROR_DOC_DELTA == docType) {
+		if(state >= 0 && JSMN_OBJECT == pTokens[state].type) {
+			mergeSection(SHADOW_MIRROR_DESIRED, pJsonDocument, pTokens, tokenCount, state);
+		}
+	} else {
+		if(SHADOW_MIRROR_DOC_GET_ACCEPTED == docType) {
+			for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_FIELDS; i++) {
+				mirrorFields[i].seen = false;
+			}
+			/* The first seed changes nothing, the fields were never known */
+			mirrorNotify = mirrorSeeded;
+		}
+
+		if(state >= 0 && JSMN_OBJECT == pTokens[state].type) {
+			mergeSection(SHADOW_MIRROR_REPORTED, pJsonDocument, pTokens, tokenCount,
+						 findMember(pJsonDocument, pTokens, tokenCount, state, "reported"));
+			mergeSection(SHADOW_MIRROR_DESIRED, pJsonDocument, pTokens, tokenCount,
+						 findMember(pJsonDocument, pTokens, tokenCount, state, "desired"));
+		}
+
+		if(SHADOW_MIRROR_DOC_GET_ACCEPTED == docType) {
+			/* Whatever the full document no longer has was deleted meanwhile */
+			for(i = 0; i < AWS_IOT_SHADOW_MIRROR_MAX_FIELDS; i++) {
+				if(mirrorFields[i].inUse && !mirrorFields[i].seen) {
+					removeField(&mirrorFields[i]);
+				}
+			}
+			mirrorSeeded = true;
+			mirrorStale = false;
+			mirrorNotify = true;
+		}
+	}
+
+	mirrorVersion = version;
+	mirrorStats.documents++;
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_shadow_mirror_apply(ShadowMirrorDocument_t docType, const char *pJsonDocument, size_t jsonSize) {
+	int32_t tokenCount;
+
+	if(NULL == pJsonDocument) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(!isJsonValidAndParse(pJsonDocument, jsonSize, NULL, &tokenCount)) {
+		return SHADOW_JSON_ERROR;
+	}
+
+	return aws_iot_shadow_mirror_apply_parsed(docType, pJsonDocument, tokenCount);
+}
+
+const char *aws_iot_shadow_mirror_get_raw(ShadowMirrorSection_t section, const char *pKey,
+										  ShadowMirrorValueType_t *pType) {
+	ShadowMirrorField_t *pField;
+
+	if(NULL == pKey) {
+		return NULL;
+	}
+
+	pField = findField(section, pKey);
+	if(NULL == pField) {
+		return NULL;
+	}
+
+	if(NULL != pType) {
+		*pType = (ShadowMirrorValueType_t) pField->type;
+	}
+	return pField->value;
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_string(ShadowMirrorSection_t section, const char *pKey, char *pBuf,
+											 size_t bufLen) {
+	ShadowMirrorValueType_t type;
+	const char *pValue;
+	size_t len;
+
+	if(NULL == pBuf) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pValue = aws_iot_shadow_mirror_get_raw(section, pKey, &type);
+	if(NULL == pValue) {
+		return FAILURE;
+	}
+	if(SHADOW_MIRROR_TYPE_STRING != type) {
+		return SHADOW_JSON_ERROR;
+	}
+
+	len = strlen(pValue);
+	if(len + 1 > bufLen) {
+		return SHADOW_JSON_BUFFER_TRUNCATED;
+	}
+	memcpy(pBuf, pValue, len + 1);
+
+	return SUCCESS;
+}
+
+/* A token over the stored text, so the json utils parsers can be reused */
+static const char *getPrimitive(ShadowMirrorSection_t section, const char *pKey, jsmntok_t *pToken) {
+	ShadowMirrorValueType_t type;
+	const char *pValue = aws_iot_shadow_mirror_get_raw(section, pKey, &type);
+
+	if(NULL != pValue) {
+		memset(pToken, 0, sizeof(*pToken));
+		pToken->type = SHADOW_MIRROR_TYPE_PRIMITIVE == type ? JSMN_PRIMITIVE : JSMN_STRING;
+		pToken->start = 0;
+		pToken->end = (int) strlen(pValue);
+	}
+	return pValue;
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_int(ShadowMirrorSection_t section, const char *pKey, int32_t *pValue) {
+	jsmntok_t token;
+	const char *pText;
+
+	if(NULL == pValue) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pText = getPrimitive(section, pKey, &token);
+	if(NULL == pText) {
+		return FAILURE;
+	}
+	return parseInteger32Value(pValue, pText, &token);
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_float(ShadowMirrorSection_t section, const char *pKey, float *pValue) {
+	jsmntok_t token;
+	const char *pText;
+
+	if(NULL == pValue) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pText = getPrimitive(section, pKey, &token);
+	if(NULL == pText) {
+		return FAILURE;
+	}
+	return parseFloatValue(pValue, pText, &token);
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_bool(ShadowMirrorSection_t section, const char *pKey, bool *pValue) {
+	jsmntok_t token;
+	const char *pText;
+
+	if(NULL == pValue) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pText = getPrimitive(section, pKey, &token);
+	if(NULL == pText) {
+		return FAILURE;
+	}
+	return parseBooleanValue(pValue, pText, &token);
+}
+
+#endif /* ENABLE_IOT_SHADOW_MIRROR */
+
+#ifdef __cplusplus
+}
+#endif
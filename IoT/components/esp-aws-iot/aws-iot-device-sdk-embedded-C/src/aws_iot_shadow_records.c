@@ -30,7 +30,10 @@ extern "C" {
 #include "timer_interface.h"
 #include "aws_iot_json_utils.h"
 #include "aws_iot_log.h"
+#include "aws_iot_buffer_arena.h"
+#include "aws_iot_latency_trace.h"
 #include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_mirror.h"
 #include "aws_iot_config.h"
 
 typedef struct {
@@ -74,8 +77,28 @@ char shadowDeltaTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
 SubscriptionRecord_t SubscriptionList[MAX_TOPICS_AT_ANY_GIVEN_TIME];
 
 #define SUBSCRIBE_SETTLING_TIME 2
+
+#ifdef ENABLE_IOT_BUFFER_ARENA
+/* Received documents are copied into the arena scope of the packet being
+ * handled, so the copy is only as large as the payload and is released with it.
+ * Timeout callbacks have no document and get an empty string. */
+static char shadowNoDocument[] = "";
+
+/* Temporary topic names are taken from the arena and released when the
+ * function that needed them returns */
+#define TOPIC_BUFFER_SCOPE_BEGIN() IoT_Arena_Mark_t topicScope = aws_iot_arena_mark()
+#define TOPIC_BUFFER_SCOPE_END() aws_iot_arena_release(topicScope)
+#define TOPIC_BUFFER(name) char *name = (char *) aws_iot_arena_alloc(IOT_ARENA_TOPIC, MAX_SHADOW_TOPIC_LENGTH_BYTES)
+#define TOPIC_BUFFER_VALID(name) (NULL != (name))
+#else
 char shadowRxBuf[SHADOW_MAX_SIZE_OF_RX_BUFFER];
 
+#define TOPIC_BUFFER_SCOPE_BEGIN()
+#define TOPIC_BUFFER_SCOPE_END()
+#define TOPIC_BUFFER(name) char name[MAX_SHADOW_TOPIC_LENGTH_BYTES]
+#define TOPIC_BUFFER_VALID(name) (true)
+#endif
+
 static JsonTokenTable_t tokenTable[MAX_JSON_TOKEN_EXPECTED];
 static uint32_t tokenTableIndex = 0;
 static bool deltaTopicSubscribedFlag = false;
@@ -168,6 +191,39 @@ static void topicNameFromThingAndAction(char *pTopic, const char *pThingName, Sh
 	}
 }
 
+/**
+ * @brief Copy a received Shadow document into a NULL terminated buffer for jsmn
+ *
+ * @param params Received message
+ * @param pBufSize Output, size of the returned buffer
+ *
+ * @return The document buffer, NULL if the payload does not fit
+ */
+static char *copyReceivedDocument(IoT_Publish_Message_Params *params, size_t *pBufSize) {
+	char *pRxBuf;
+
+	if(params->payloadLen >= SHADOW_MAX_SIZE_OF_RX_BUFFER) {
+		IOT_WARN("Payload larger than RX Buffer");
+		return NULL;
+	}
+
+#ifdef ENABLE_IOT_BUFFER_ARENA
+	*pBufSize = params->payloadLen + 1;
+	pRxBuf = (char *) aws_iot_arena_alloc(IOT_ARENA_SHADOW_RX, *pBufSize);
+	if(NULL == pRxBuf) {
+		return NULL;
+	}
+#else
+	*pBufSize = SHADOW_MAX_SIZE_OF_RX_BUFFER;
+	pRxBuf = shadowRxBuf;
+#endif
+
+	memcpy(pRxBuf, params->payload, params->payloadLen);
+	pRxBuf[params->payloadLen] = '\0';    // jsmn_parse relies on a string
+
+	return pRxBuf;
+}
+
 static bool isValidShadowVersionUpdate(const char *pTopicName) {
 	if(strstr(pTopicName, myThingName) != NULL &&
 	   ((strstr(pTopicName, "get/accepted") != NULL) ||
@@ -177,40 +233,61 @@ static bool isValidShadowVersionUpdate(const char *pTopicName) {
 	return false;
 }
 
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+/* Feed the accepted documents of this Thing, and the get/rejected that says
+ * it has no Shadow yet, into the local mirror while the parser tokens are
+ * still valid */
+static void mirrorReceivedDocument(const char *pTopicName, const char *pRxBuf, int32_t tokenCount) {
+	if(strstr(pTopicName, myThingName) == NULL) {
+		return;
+	}
+	if(strstr(pTopicName, "get/accepted") != NULL) {
+		aws_iot_shadow_mirror_apply_parsed(SHADOW_MIRROR_DOC_GET_ACCEPTED, pRxBuf, tokenCount);
+	} else if(strstr(pTopicName, "update/accepted") != NULL) {
+		aws_iot_shadow_mirror_apply_parsed(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED, pRxBuf, tokenCount);
+	} else if(strstr(pTopicName, "get/rejected") != NULL) {
+		aws_iot_shadow_mirror_apply_parsed(SHADOW_MIRROR_DOC_GET_REJECTED, pRxBuf, tokenCount);
+	}
+}
+#endif
+
 static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
 							  IoT_Publish_Message_Params *params, void *pData) {
 	int32_t tokenCount;
 	uint8_t i;
 	void *pJsonHandler = NULL;
 	char temporaryClientToken[MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE];
+	char *pRxBuf;
+	size_t rxBufSize;
 
 	IOT_UNUSED(pClient);
 	IOT_UNUSED(topicNameLen);
 	IOT_UNUSED(pData);
 
-	if(params->payloadLen >= SHADOW_MAX_SIZE_OF_RX_BUFFER) {
-		IOT_WARN("Payload larger than RX Buffer");
+	pRxBuf = copyReceivedDocument(params, &rxBufSize);
+	if(NULL == pRxBuf) {
 		return;
 	}
 
-	memcpy(shadowRxBuf, params->payload, params->payloadLen);
-	shadowRxBuf[params->payloadLen] = '\0';    // jsmn_parse relies on a string
-
-	if(!isJsonValidAndParse(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, pJsonHandler, &tokenCount)) {
+	if(!isJsonValidAndParse(pRxBuf, rxBufSize, pJsonHandler, &tokenCount)) {
 		IOT_WARN("Received JSON is not valid");
 		return;
 	}
 
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+	mirrorReceivedDocument(topicName, pRxBuf, tokenCount);
+#endif
+
 	if(isValidShadowVersionUpdate(topicName)) {
 		uint32_t tempVersionNumber = 0;
-		if(extractVersionNumber(shadowRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
+		if(extractVersionNumber(pRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
 			if(tempVersionNumber > shadowJsonVersionNum) {
 				shadowJsonVersionNum = tempVersionNumber;
 			}
 		}
 	}
 
-	if(extractClientToken(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, temporaryClientToken, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE)) {
+	if(extractClientToken(pRxBuf, rxBufSize, temporaryClientToken, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE)) {
 		for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
 			if(!AckWaitList[i].isFree) {
 				if(strcmp(AckWaitList[i].clientTokenID, temporaryClientToken) == 0) {
@@ -221,9 +298,10 @@ static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName, uint16_t
 						status = SHADOW_ACK_REJECTED;
 					}
 					if(status == SHADOW_ACK_ACCEPTED || status == SHADOW_ACK_REJECTED) {
+						IOT_LATENCY_TRACE(IOT_TRACE_SHADOW_ACK_RECEIVED, status);
 						if(AckWaitList[i].callback != NULL) {
 							AckWaitList[i].callback(AckWaitList[i].thingName, AckWaitList[i].action, status,
-													shadowRxBuf, AckWaitList[i].pCallbackContext);
+													pRxBuf, AckWaitList[i].pCallbackContext);
 						}
 						unsubscribeFromAcceptedAndRejected(i);
 						AckWaitList[i].isFree = true;
@@ -249,12 +327,18 @@ static int16_t findIndexOfSubscriptionList(const char *pTopic) {
 
 static void unsubscribeFromAcceptedAndRejected(uint8_t index) {
 
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	TOPIC_BUFFER_SCOPE_BEGIN();
+	TOPIC_BUFFER(TemporaryTopicNameAccepted);
+	TOPIC_BUFFER(TemporaryTopicNameRejected);
 	IoT_Error_t ret_val = SUCCESS;
 
 	int16_t indexSubList;
 
+	if(!TOPIC_BUFFER_VALID(TemporaryTopicNameAccepted) || !TOPIC_BUFFER_VALID(TemporaryTopicNameRejected)) {
+		TOPIC_BUFFER_SCOPE_END();
+		return;
+	}
+
 	topicNameFromThingAndAction(TemporaryTopicNameAccepted, AckWaitList[index].thingName, AckWaitList[index].action,
 								SHADOW_ACCEPTED);
 	topicNameFromThingAndAction(TemporaryTopicNameRejected, AckWaitList[index].thingName, AckWaitList[index].action,
@@ -285,6 +369,8 @@ static void unsubscribeFromAcceptedAndRejected(uint8_t index) {
 			SubscriptionList[indexSubList].count--;
 		}
 	}
+
+	TOPIC_BUFFER_SCOPE_END();
 }
 
 void initializeRecords(AWS_IoT_Client *pClient) {
@@ -306,8 +392,14 @@ bool isSubscriptionPresent(const char *pThingName, ShadowActions_t action) {
 	uint8_t i = 0;
 	bool isAcceptedPresent = false;
 	bool isRejectedPresent = false;
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	TOPIC_BUFFER_SCOPE_BEGIN();
+	TOPIC_BUFFER(TemporaryTopicNameAccepted);
+	TOPIC_BUFFER(TemporaryTopicNameRejected);
+
+	if(!TOPIC_BUFFER_VALID(TemporaryTopicNameAccepted) || !TOPIC_BUFFER_VALID(TemporaryTopicNameRejected)) {
+		TOPIC_BUFFER_SCOPE_END();
+		return false;
+	}
 
 	topicNameFromThingAndAction(TemporaryTopicNameAccepted, pThingName, action, SHADOW_ACCEPTED);
 	topicNameFromThingAndAction(TemporaryTopicNameRejected, pThingName, action, SHADOW_REJECTED);
@@ -322,6 +414,8 @@ bool isSubscriptionPresent(const char *pThingName, ShadowActions_t action) {
 		}
 	}
 
+	TOPIC_BUFFER_SCOPE_END();
+
 	if(isRejectedPresent && isAcceptedPresent) {
 		return true;
 	}
@@ -385,9 +479,15 @@ IoT_Error_t subscribeToShadowActionAcks(const char *pThingName, ShadowActions_t
 }
 
 void incrementSubscriptionCnt(const char *pThingName, ShadowActions_t action, bool isSticky) {
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	TOPIC_BUFFER_SCOPE_BEGIN();
+	TOPIC_BUFFER(TemporaryTopicNameAccepted);
+	TOPIC_BUFFER(TemporaryTopicNameRejected);
 	uint8_t i;
+
+	if(!TOPIC_BUFFER_VALID(TemporaryTopicNameAccepted) || !TOPIC_BUFFER_VALID(TemporaryTopicNameRejected)) {
+		TOPIC_BUFFER_SCOPE_END();
+		return;
+	}
 	topicNameFromThingAndAction(TemporaryTopicNameAccepted, pThingName, action, SHADOW_ACCEPTED);
 	topicNameFromThingAndAction(TemporaryTopicNameRejected, pThingName, action, SHADOW_REJECTED);
 
@@ -400,25 +500,37 @@ void incrementSubscriptionCnt(const char *pThingName, ShadowActions_t action, bo
 			}
 		}
 	}
+
+	TOPIC_BUFFER_SCOPE_END();
 }
 
 IoT_Error_t publishToShadowAction(const char *pThingName, ShadowActions_t action, const char *pJsonDocumentToBeSent) {
 	IoT_Error_t ret_val = SUCCESS;
-	char TemporaryTopicName[MAX_SHADOW_TOPIC_LENGTH_BYTES];
 	IoT_Publish_Message_Params msgParams;
 
 	if(NULL == pThingName || NULL == pJsonDocumentToBeSent) {
 		return NULL_VALUE_ERROR;
 	}
 
+	TOPIC_BUFFER_SCOPE_BEGIN();
+	TOPIC_BUFFER(TemporaryTopicName);
+
+	if(!TOPIC_BUFFER_VALID(TemporaryTopicName)) {
+		TOPIC_BUFFER_SCOPE_END();
+		return FAILURE;
+	}
+
 	topicNameFromThingAndAction(TemporaryTopicName, pThingName, action, SHADOW_ACTION);
 
 	msgParams.qos = QOS0;
 	msgParams.isRetained = 0;
 	msgParams.payloadLen = strlen(pJsonDocumentToBeSent);
 	msgParams.payload = (char *) pJsonDocumentToBeSent;
+	IOT_LATENCY_TRACE(IOT_TRACE_SHADOW_PUBLISH, msgParams.payloadLen);
 	ret_val = aws_iot_mqtt_publish(pMqttClient, TemporaryTopicName, (uint16_t) strlen(TemporaryTopicName), &msgParams);
 
+	TOPIC_BUFFER_SCOPE_END();
+
 	return ret_val;
 }
 
@@ -460,8 +572,13 @@ void HandleExpiredResponseCallbacks(void) {
 		if(!AckWaitList[i].isFree) {
 			if(has_timer_expired(&(AckWaitList[i].timer))) {
 				if(AckWaitList[i].callback != NULL) {
+#ifdef ENABLE_IOT_BUFFER_ARENA
+					AckWaitList[i].callback(AckWaitList[i].thingName, AckWaitList[i].action, SHADOW_ACK_TIMEOUT,
+											shadowNoDocument, AckWaitList[i].pCallbackContext);
+#else
 					AckWaitList[i].callback(AckWaitList[i].thingName, AckWaitList[i].action, SHADOW_ACK_TIMEOUT,
 											shadowRxBuf, AckWaitList[i].pCallbackContext);
+#endif
 				}
 				AckWaitList[i].isFree = true;
 				unsubscribeFromAcceptedAndRejected(i);
@@ -478,6 +595,8 @@ static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 	int32_t DataPosition;
 	uint32_t dataLength;
 	uint32_t tempVersionNumber = 0;
+	char *pRxBuf;
+	size_t rxBufSize;
 
 	FUNC_ENTRY;
 
@@ -486,21 +605,22 @@ static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 	IOT_UNUSED(topicNameLen);
 	IOT_UNUSED(pData);
 
-	if(params->payloadLen >= SHADOW_MAX_SIZE_OF_RX_BUFFER) {
-		IOT_WARN("Payload larger than RX Buffer");
+	pRxBuf = copyReceivedDocument(params, &rxBufSize);
+	if(NULL == pRxBuf) {
 		return;
 	}
 
-	memcpy(shadowRxBuf, params->payload, params->payloadLen);
-	shadowRxBuf[params->payloadLen] = '\0';    // jsmn_parse relies on a string
-
-	if(!isJsonValidAndParse(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, pJsonHandler, &tokenCount)) {
+	if(!isJsonValidAndParse(pRxBuf, rxBufSize, pJsonHandler, &tokenCount)) {
 		IOT_WARN("Received JSON is not valid");
 		return;
 	}
 
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+	aws_iot_shadow_mirror_apply_parsed(SHADOW_MIRROR_DOC_DELTA, pRxBuf, tokenCount);
+#endif
+
 	if(shadowDiscardOldDeltaFlag) {
-		if(extractVersionNumber(shadowRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
+		if(extractVersionNumber(pRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
 			if(tempVersionNumber > shadowJsonVersionNum) {
 				shadowJsonVersionNum = tempVersionNumber;
 			} else {
@@ -513,10 +633,10 @@ static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 
 	for(i = 0; i < tokenTableIndex; i++) {
 		if(!tokenTable[i].isFree) {
-			if(isJsonKeyMatchingAndUpdateValue(shadowRxBuf, pJsonHandler, tokenCount,
+			if(isJsonKeyMatchingAndUpdateValue(pRxBuf, pJsonHandler, tokenCount,
 											   (jsonStruct_t *) tokenTable[i].pStruct, &dataLength, &DataPosition)) {
 				if(tokenTable[i].callback != NULL) {
-					tokenTable[i].callback(shadowRxBuf + DataPosition, dataLength,
+					tokenTable[i].callback(pRxBuf + DataPosition, dataLength,
 										   (jsonStruct_t *) tokenTable[i].pStruct);
 				}
 			}
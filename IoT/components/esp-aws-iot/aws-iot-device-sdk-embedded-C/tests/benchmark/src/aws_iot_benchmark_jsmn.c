@@ -0,0 +1,300 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_benchmark_jsmn.c
+ * @brief jsmn tokenizer benchmark over generated Shadow documents
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "jsmn.h"
+
+#define BENCH_MAX_DOC_LEN 8192
+#define BENCH_MAX_TOKENS 512
+
+typedef struct {
+	char *pJson;
+	size_t len;
+} BenchDocument_t;
+
+static const char *scanNames[] = { "auto", "scalar", "sse2", "avx2" };
+
+static const char *cleaningStates[] = { "CLEANED", "DIRTY", "IN_PROGRESS" };
+
+static double nowSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* A get/accepted style document: reported and desired state, delta, metadata for every field */
+static size_t buildShadowDocument(char *pBuf, size_t bufLen, unsigned int room) {
+	unsigned int ts = 1614852672u + room * 37u;
+	const char *pState = cleaningStates[room % 3];
+	const char *pDesired = cleaningStates[(room + 1) % 3];
+	int len;
+
+	len = snprintf(pBuf, bufLen,
+		"{\"state\":{\"desired\":{\"cleaningStatus\":\"%s\",\"targetTemperature\":%u.5,\"schedule\":[\"08:00\",\"12:00\",\"17:30\"]},"
+		"\"reported\":{\"timestampStatus\":\"2021-03-%02u %02u:%02u:%02u\",\"clientidStatus\":\"0123%08X%06XEE\","
+		"\"cleaningStatus\":\"%s\",\"temperature\":%u.%u,\"humidity\":%u,\"occupied\":%s,\"firmware\":\"1.4.%u\","
+		"\"notes\":\"Room %u on floor %u, last visit by team \\\"%c\\\". Check the window latch \\u2013 reported twice.\","
+		"\"sensors\":{\"co2\":%u,\"lux\":%u,\"door\":\"closed\",\"battery\":[%u,%u,%u]}},"
+		"\"delta\":{\"cleaningStatus\":\"%s\"}},"
+		"\"metadata\":{\"desired\":{\"cleaningStatus\":{\"timestamp\":%u},\"targetTemperature\":{\"timestamp\":%u},"
+		"\"schedule\":[{\"timestamp\":%u},{\"timestamp\":%u},{\"timestamp\":%u}]},"
+		"\"reported\":{\"timestampStatus\":{\"timestamp\":%u},\"clientidStatus\":{\"timestamp\":%u},"
+		"\"cleaningStatus\":{\"timestamp\":%u},\"temperature\":{\"timestamp\":%u},\"humidity\":{\"timestamp\":%u},"
+		"\"occupied\":{\"timestamp\":%u},\"firmware\":{\"timestamp\":%u},\"notes\":{\"timestamp\":%u},"
+		"\"sensors\":{\"co2\":{\"timestamp\":%u},\"lux\":{\"timestamp\":%u},\"door\":{\"timestamp\":%u},"
+		"\"battery\":[{\"timestamp\":%u},{\"timestamp\":%u},{\"timestamp\":%u}]}}},"
+		"\"version\":%u,\"timestamp\":%u,\"clientToken\":\"0123%08X%06XEE-%u\"}",
+		pDesired, 20 + room % 5, 1 + room % 28, room % 24, room % 60, (room * 7) % 60, room, room * 13,
+		pState, 19 + room % 6, room % 10, 30 + room % 40, (room & 1) ? "true" : "false", room % 9,
+		room, room / 20, 'A' + (char) (room % 26),
+		400 + room % 300, 100 + room % 700, 90 - room % 10, 80 - room % 10, 70 - room % 10,
+		pState,
+		ts, ts, ts, ts, ts,
+		ts + 1, ts + 1, ts + 1, ts + 2, ts + 2, ts + 2, ts + 3, ts + 3,
+		ts + 4, ts + 4, ts + 4, ts + 5, ts + 5, ts + 5,
+		1000 + room, ts + 6, room, room * 13, room);
+
+	return (len > 0 && (size_t) len < bufLen) ? (size_t) len : 0;
+}
+
+/* Re-indent a compact document the way a JSON pretty printer would */
+static size_t prettyPrint(const char *pIn, size_t inLen, char *pOut, size_t outLen) {
+	size_t i;
+	size_t o = 0;
+	int depth = 0;
+	int inString = 0;
+	int d;
+
+#define PUT(c) do { if(o + 1 >= outLen) { return 0; } pOut[o++] = (c); } while(0)
+#define NEWLINE() do { PUT('\n'); for(d = 0; d < depth * 4; d++) { PUT(' '); } } while(0)
+
+	for(i = 0; i < inLen; i++) {
+		char c = pIn[i];
+		if(inString) {
+			PUT(c);
+			if('\\' == c && i + 1 < inLen) {
+				PUT(pIn[++i]);
+			} else if('"' == c) {
+				inString = 0;
+			}
+			continue;
+		}
+		switch(c) {
+			case '"':
+				inString = 1;
+				PUT(c);
+				break;
+			case '{':
+			case '[':
+				PUT(c);
+				depth++;
+				NEWLINE();
+				break;
+			case '}':
+			case ']':
+				depth--;
+				NEWLINE();
+				PUT(c);
+				break;
+			case ',':
+				PUT(c);
+				NEWLINE();
+				break;
+			case ':':
+				PUT(c);
+				PUT(' ');
+				break;
+			default:
+				PUT(c);
+				break;
+		}
+	}
+
+#undef NEWLINE
+#undef PUT
+
+	pOut[o] = '\0';
+	return o;
+}
+
+static int parseDocument(const BenchDocument_t *pDoc, jsmntok_t *pTokens) {
+	jsmn_parser parser;
+	jsmn_init(&parser);
+	return jsmn_parse(&parser, pDoc->pJson, pDoc->len, pTokens, BENCH_MAX_TOKENS);
+}
+
+static int verifyScanner(jsmnscan_t scan, const BenchDocument_t *pDocs, unsigned int count) {
+	static jsmntok_t expected[BENCH_MAX_TOKENS];
+	static jsmntok_t actual[BENCH_MAX_TOKENS];
+	unsigned int i;
+	int expectedRc;
+	int actualRc;
+
+	for(i = 0; i < count; i++) {
+		jsmn_set_scan(JSMN_SCAN_SCALAR);
+		memset(expected, 0, sizeof(expected));
+		expectedRc = parseDocument(&pDocs[i], expected);
+
+		jsmn_set_scan(scan);
+		memset(actual, 0, sizeof(actual));
+		actualRc = parseDocument(&pDocs[i], actual);
+
+		if(expectedRc <= 0 || expectedRc != actualRc || 0 != memcmp(expected, actual, sizeof(expected))) {
+			printf("scanner %s disagrees with scalar on document %u (%d vs %d tokens)\n",
+				   scanNames[scan], i, actualRc, expectedRc);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static double runScanner(jsmnscan_t scan, const BenchDocument_t *pDocs, unsigned int count, unsigned int iterations) {
+	static jsmntok_t tokens[BENCH_MAX_TOKENS];
+	unsigned int it;
+	unsigned int i;
+	volatile int sink = 0;
+	double start;
+
+	jsmn_set_scan(scan);
+
+	/* Warm up caches and branch predictors */
+	for(i = 0; i < count; i++) {
+		sink += parseDocument(&pDocs[i], tokens);
+	}
+
+	start = nowSeconds();
+	for(it = 0; it < iterations; it++) {
+		for(i = 0; i < count; i++) {
+			sink += parseDocument(&pDocs[i], tokens);
+		}
+	}
+	(void) sink;
+
+	return nowSeconds() - start;
+}
+
+static int benchmarkSet(const char *pLabel, const BenchDocument_t *pDocs, unsigned int count, unsigned int iterations) {
+	jsmnscan_t scan;
+	size_t totalBytes = 0;
+	double scalarSeconds = 0;
+	double seconds;
+	unsigned int i;
+
+	for(i = 0; i < count; i++) {
+		totalBytes += pDocs[i].len;
+	}
+
+	printf("\n%s: %u documents, %.0f bytes on average, %u passes\n", pLabel, count,
+		   (double) totalBytes / count, iterations);
+	printf("%-8s %10s %12s %8s\n", "scanner", "MB/s", "ns/document", "speedup");
+
+	for(scan = JSMN_SCAN_SCALAR; scan <= JSMN_SCAN_AVX2; scan++) {
+		if(jsmn_set_scan(scan) != scan) {
+			printf("%-8s %10s\n", scanNames[scan], "n/a");
+			continue;
+		}
+		if(!verifyScanner(scan, pDocs, count)) {
+			return 0;
+		}
+
+		seconds = runScanner(scan, pDocs, count, iterations);
+		if(JSMN_SCAN_SCALAR == scan) {
+			scalarSeconds = seconds;
+		}
+		printf("%-8s %10.1f %12.1f %7.2fx\n", scanNames[scan],
+			   (double) totalBytes * iterations / seconds / 1e6,
+			   seconds * 1e9 / ((double) count * iterations), scalarSeconds / seconds);
+	}
+
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	unsigned int rooms = 200;
+	unsigned int iterations = 200;
+	int pretty = 0;
+	BenchDocument_t *pCompact;
+	BenchDocument_t *pPretty;
+	char scratch[BENCH_MAX_DOC_LEN];
+	unsigned int i;
+	int ok = 1;
+	int opt;
+
+	while(-1 != (opt = getopt(argc, argv, "r:i:p"))) {
+		switch(opt) {
+			case 'r':
+				rooms = (unsigned int) strtoul(optarg, NULL, 10);
+				break;
+			case 'i':
+				iterations = (unsigned int) strtoul(optarg, NULL, 10);
+				break;
+			case 'p':
+				pretty = 1;
+				break;
+			default:
+				printf("usage: %s [-r rooms] [-i passes] [-p]\n", argv[0]);
+				return 1;
+		}
+	}
+	if(0 == rooms || 0 == iterations) {
+		printf("rooms and passes must be positive\n");
+		return 1;
+	}
+
+	pCompact = (BenchDocument_t *) calloc(rooms, sizeof(BenchDocument_t));
+	pPretty = (BenchDocument_t *) calloc(rooms, sizeof(BenchDocument_t));
+	if(NULL == pCompact || NULL == pPretty) {
+		return 1;
+	}
+
+	for(i = 0; i < rooms; i++) {
+		pCompact[i].len = buildShadowDocument(scratch, sizeof(scratch), i);
+		pCompact[i].pJson = (char *) malloc(pCompact[i].len + 1);
+		memcpy(pCompact[i].pJson, scratch, pCompact[i].len + 1);
+
+		if(pretty) {
+			pPretty[i].len = prettyPrint(pCompact[i].pJson, pCompact[i].len, scratch, sizeof(scratch));
+			pPretty[i].pJson = (char *) malloc(pPretty[i].len + 1);
+			memcpy(pPretty[i].pJson, scratch, pPretty[i].len + 1);
+		}
+	}
+
+	printf("jsmn_parse benchmark, default scanner on this CPU: %s\n", scanNames[jsmn_set_scan(JSMN_SCAN_AUTO)]);
+
+	ok = benchmarkSet("compact shadow documents", pCompact, rooms, iterations);
+	if(ok && pretty) {
+		ok = benchmarkSet("pretty printed shadow documents", pPretty, rooms, iterations);
+	}
+
+	for(i = 0; i < rooms; i++) {
+		free(pCompact[i].pJson);
+		free(pPretty[i].pJson);
+	}
+	free(pCompact);
+	free(pPretty);
+
+	return ok ? 0 : 1;
+}
@@ -18,8 +18,12 @@
 
 // Get from console
 // =================================================
+#ifndef AWS_IOT_MQTT_HOST
 #define AWS_IOT_MQTT_HOST              "" ///< Customer specific MQTT HOST. The same will be used for Thing Shadow
+#endif
+#ifndef AWS_IOT_MQTT_PORT
 #define AWS_IOT_MQTT_PORT              443 ///< default port for MQTT/S
+#endif
 #define AWS_IOT_MQTT_CLIENT_ID         "c-sdk-client-id" ///< MQTT client ID should be unique for every device
 #define AWS_IOT_MY_THING_NAME          "AWS-IoT-C-SDK" ///< Thing Name of the Shadow this device is associated with
 #define AWS_IOT_ROOT_CA_FILENAME       "rootCA.crt" ///< Root CA file name
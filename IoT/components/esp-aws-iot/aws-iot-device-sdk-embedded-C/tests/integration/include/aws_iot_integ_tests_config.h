@@ -43,4 +43,19 @@
 #define INTEGRATION_TEST_CLIENT_ID_PUB "EMB_C_SDK_INTEG_TESTER_PUB"
 #define INTEGRATION_TEST_CLIENT_ID_SUB "EMB_C_SDK_INTEG_TESTER_SUB"
 
+/* Throughput mode: number of QoS 1 messages published and looped back */
+#define THROUGHPUT_MESSAGE_COUNT 1000
+
+/* Throughput mode: payload size in bytes, including the sequence header */
+#define THROUGHPUT_PAYLOAD_SIZE 64
+
+/* Throughput mode: number of forced disconnect / manual reconnect cycles to time */
+#define THROUGHPUT_RECONNECT_COUNT 5
+
+/* Throughput mode: how long to keep yielding for outstanding messages after the last publish */
+#define THROUGHPUT_DRAIN_TIMEOUT_MS 5000
+
+/* Throughput mode: topic used for the loop-back traffic */
+#define THROUGHPUT_TEST_TOPIC "Tests/Integration/EmbeddedC/Throughput"
+
 #endif /* TESTS_INTEGRATION_INTEG_TESTS_CONFIG_H_ */
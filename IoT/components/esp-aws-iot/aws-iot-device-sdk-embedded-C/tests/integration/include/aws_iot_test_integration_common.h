@@ -39,5 +39,19 @@
 int aws_iot_mqtt_tests_basic_connectivity();
 int aws_iot_mqtt_tests_multiple_clients();
 int aws_iot_mqtt_tests_auto_reconnect();
+int aws_iot_jobs_basic_test();
+
+/**
+ * @brief Load parameters for the throughput test
+ *
+ * Every value of zero selects the default from aws_iot_integ_tests_config.h
+ */
+typedef struct {
+	unsigned int messageCount;	///< Messages to publish
+	unsigned int payloadSize;	///< Bytes per message payload
+	unsigned int reconnectCount;	///< Forced disconnect/reconnect cycles to time
+} ThroughputTestParams;
+
+int aws_iot_mqtt_tests_throughput(const ThroughputTestParams *pParams);
 
 #endif /* TESTS_INTEGRATION_COMMON_H_ */
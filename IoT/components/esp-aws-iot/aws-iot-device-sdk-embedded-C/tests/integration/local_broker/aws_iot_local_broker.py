@@ -0,0 +1,773 @@
+#!/usr/bin/env python3
+#
+# Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#
+# http://aws.amazon.com/apache2.0
+#
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+"""Local stand-in for AWS IoT Core used by the integration tests.
+
+Implements the subset of MQTT 3.1.1 the SDK uses (QoS 0/1, wildcards,
+keep-alive, session takeover) over TLS with mutual authentication, plus
+emulation of the classic Device Shadow and Jobs reserved topics:
+
+  $aws/things/<thing>/shadow/{get,update,delete}  -> accepted/rejected,
+                                                     update/delta,
+                                                     update/documents
+  $aws/things/<thing>/jobs/{get,start-next}       -> accepted/rejected
+  $aws/things/<thing>/jobs/<jobId>/{get,update}   -> accepted/rejected,
+                                                     notify, notify-next
+
+Run `aws_iot_local_broker.py --gen-certs` once to create a CA, a server
+certificate for localhost and the client identity used by the integration
+tests (written to the SDK's certs directory), then run `make local` from
+tests/integration, which starts the broker and points the tests at it.
+"""
+import argparse
+import asyncio
+import json
+import os
+import signal
+import ssl
+import struct
+import subprocess
+import sys
+import time
+
+CONNECT = 1
+CONNACK = 2
+PUBLISH = 3
+PUBACK = 4
+SUBSCRIBE = 8
+SUBACK = 9
+UNSUBSCRIBE = 10
+UNSUBACK = 11
+PINGREQ = 12
+PINGRESP = 13
+DISCONNECT = 14
+
+THINGS_PREFIX = '$aws/things/'
+
+
+def encode_remaining_length(length):
+    out = bytearray()
+    while True:
+        byte = length % 128
+        length //= 128
+        if length > 0:
+            byte |= 0x80
+        out.append(byte)
+        if length == 0:
+            return bytes(out)
+
+
+def encode_string(value):
+    data = value.encode('utf-8') if isinstance(value, str) else value
+    return struct.pack('!H', len(data)) + data
+
+
+def topic_matches(topic_filter, topic):
+    filter_levels = topic_filter.split('/')
+    topic_levels = topic.split('/')
+    # Wildcards never match topics starting with '$' at the first level (MQTT 3.1.1 - 4.7.2)
+    if topic.startswith('$') and filter_levels[0] in ('+', '#'):
+        return False
+    for index, level in enumerate(filter_levels):
+        if level == '#':
+            return True
+        if index >= len(topic_levels):
+            return False
+        if level != '+' and level != topic_levels[index]:
+            return False
+    return len(filter_levels) == len(topic_levels)
+
+
+def now():
+    return int(time.time())
+
+
+class Stats(object):
+    def __init__(self):
+        self.connects = 0
+        self.publishes_in = 0
+        self.publishes_out = 0
+        self.bytes_in = 0
+        self.bytes_out = 0
+        self.shadow_requests = 0
+        self.jobs_requests = 0
+        self.started = time.time()
+
+    def report(self):
+        elapsed = max(time.time() - self.started, 1e-6)
+        return ('connects=%d publish_in=%d (%.1f/s) publish_out=%d (%.1f/s) bytes_in=%d bytes_out=%d '
+                'shadow=%d jobs=%d' % (self.connects, self.publishes_in, self.publishes_in / elapsed,
+                                        self.publishes_out, self.publishes_out / elapsed, self.bytes_in,
+                                        self.bytes_out, self.shadow_requests, self.jobs_requests))
+
+
+class Session(object):
+    """One connected MQTT client."""
+
+    def __init__(self, broker, reader, writer):
+        self.broker = broker
+        self.reader = reader
+        self.writer = writer
+        self.client_id = None
+        self.keep_alive = 0
+        self.subscriptions = {}
+        self.next_packet_id = 1
+        self.closed = False
+        self.peer = writer.get_extra_info('peername')
+
+    def log(self, message):
+        self.broker.log('[%s] %s' % (self.client_id or self.peer, message))
+
+    def allocate_packet_id(self):
+        packet_id = self.next_packet_id
+        self.next_packet_id = 1 if self.next_packet_id == 65535 else self.next_packet_id + 1
+        return packet_id
+
+    def send(self, packet_type, flags, body):
+        if self.closed:
+            return
+        packet = bytes([(packet_type << 4) | flags]) + encode_remaining_length(len(body)) + body
+        self.broker.stats.bytes_out += len(packet)
+        self.writer.write(packet)
+
+    def send_publish(self, topic, payload, qos):
+        body = encode_string(topic)
+        if qos > 0:
+            body += struct.pack('!H', self.allocate_packet_id())
+        body += payload
+        self.broker.stats.publishes_out += 1
+        self.send(PUBLISH, qos << 1, body)
+
+    async def read_packet(self):
+        header = await self.reader.readexactly(1)
+        multiplier = 1
+        length = 0
+        for _ in range(4):
+            byte = (await self.reader.readexactly(1))[0]
+            length += (byte & 0x7F) * multiplier
+            multiplier *= 128
+            if not byte & 0x80:
+                break
+        else:
+            raise ValueError('malformed remaining length')
+        body = await self.reader.readexactly(length) if length else b''
+        self.broker.stats.bytes_in += 1 + len(encode_remaining_length(length)) + length
+        return header[0] >> 4, header[0] & 0x0F, body
+
+    async def run(self):
+        try:
+            packet_type, _, body = await asyncio.wait_for(self.read_packet(), self.broker.connect_timeout)
+            if packet_type != CONNECT or not self.handle_connect(body):
+                return
+            while not self.closed:
+                timeout = self.keep_alive * 1.5 if self.keep_alive else None
+                packet_type, flags, body = await asyncio.wait_for(self.read_packet(), timeout)
+                if not self.dispatch(packet_type, flags, body):
+                    break
+                await self.writer.drain()
+        except asyncio.TimeoutError:
+            self.log('keep-alive expired')
+        except (asyncio.IncompleteReadError, ConnectionError, ssl.SSLError):
+            pass
+        except ValueError as err:
+            self.log('protocol error: %s' % err)
+        finally:
+            self.close()
+
+    def close(self):
+        if self.closed:
+            return
+        self.closed = True
+        self.broker.detach(self)
+        try:
+            self.writer.close()
+        except Exception:
+            pass
+
+    def handle_connect(self, body):
+        offset = 0
+        (name_len,) = struct.unpack_from('!H', body, offset)
+        offset += 2
+        protocol = body[offset:offset + name_len]
+        offset += name_len
+        level = body[offset]
+        connect_flags = body[offset + 1]
+        (self.keep_alive,) = struct.unpack_from('!H', body, offset + 2)
+        offset += 4
+        (id_len,) = struct.unpack_from('!H', body, offset)
+        offset += 2
+        self.client_id = body[offset:offset + id_len].decode('utf-8')
+
+        if protocol != b'MQTT' or level != 4:
+            self.send(CONNACK, 0, b'\x00\x01')
+            return False
+        if not self.client_id:
+            self.send(CONNACK, 0, b'\x00\x02')
+            return False
+        if self.broker.refuse_connections:
+            self.send(CONNACK, 0, b'\x00\x03')
+            return False
+
+        self.broker.attach(self)
+        self.broker.stats.connects += 1
+        self.log('connected (keep-alive %ds, clean session %d)' % (self.keep_alive, (connect_flags >> 1) & 1))
+        self.send(CONNACK, 0, b'\x00\x00')
+        return True
+
+    def dispatch(self, packet_type, flags, body):
+        if packet_type == PUBLISH:
+            self.handle_publish(flags, body)
+        elif packet_type == PUBACK:
+            pass
+        elif packet_type == SUBSCRIBE:
+            self.handle_subscribe(body)
+        elif packet_type == UNSUBSCRIBE:
+            self.handle_unsubscribe(body)
+        elif packet_type == PINGREQ:
+            self.send(PINGRESP, 0, b'')
+        elif packet_type == DISCONNECT:
+            return False
+        else:
+            raise ValueError('unexpected packet type %d' % packet_type)
+        return True
+
+    def handle_publish(self, flags, body):
+        qos = (flags >> 1) & 0x03
+        (topic_len,) = struct.unpack_from('!H', body, 0)
+        topic = body[2:2 + topic_len].decode('utf-8')
+        offset = 2 + topic_len
+        if qos > 0:
+            (packet_id,) = struct.unpack_from('!H', body, offset)
+            offset += 2
+        payload = body[offset:]
+        self.broker.stats.publishes_in += 1
+        if qos == 1:
+            self.send(PUBACK, 0, struct.pack('!H', packet_id))
+        elif qos > 1:
+            # AWS IoT does not support QoS 2 and closes the connection
+            raise ValueError('QoS 2 publish')
+        self.broker.route(self, topic, payload, qos)
+
+    def handle_subscribe(self, body):
+        (packet_id,) = struct.unpack_from('!H', body, 0)
+        offset = 2
+        granted = bytearray()
+        while offset < len(body):
+            (filter_len,) = struct.unpack_from('!H', body, offset)
+            offset += 2
+            topic_filter = body[offset:offset + filter_len].decode('utf-8')
+            offset += filter_len
+            qos = body[offset]
+            offset += 1
+            if qos > 1:
+                granted.append(0x80)
+                continue
+            self.subscriptions[topic_filter] = qos
+            granted.append(qos)
+        self.send(SUBACK, 0, struct.pack('!H', packet_id) + bytes(granted))
+
+    def handle_unsubscribe(self, body):
+        (packet_id,) = struct.unpack_from('!H', body, 0)
+        offset = 2
+        while offset < len(body):
+            (filter_len,) = struct.unpack_from('!H', body, offset)
+            offset += 2
+            self.subscriptions.pop(body[offset:offset + filter_len].decode('utf-8'), None)
+            offset += filter_len
+        self.send(UNSUBACK, 0, struct.pack('!H', packet_id))
+
+
+class ShadowService(object):
+    """Classic (unnamed) Device Shadow semantics: versioning, metadata, delta."""
+
+    def __init__(self, broker):
+        self.broker = broker
+        self.documents = {}
+
+    def handle(self, thing, operation, payload):
+        prefix = '%s%s/shadow/%s' % (THINGS_PREFIX, thing, operation)
+        if payload:
+            try:
+                request = json.loads(payload.decode('utf-8'))
+            except ValueError:
+                return self.reject(prefix, 400, 'Payload contains invalid json', None)
+            if not isinstance(request, dict):
+                return self.reject(prefix, 400, 'Payload contains invalid json', None)
+        else:
+            request = {}
+        token = request.get('clientToken')
+        self.broker.stats.shadow_requests += 1
+
+        if operation == 'get':
+            self.get(thing, prefix, token)
+        elif operation == 'update':
+            self.update(thing, prefix, request, token)
+        elif operation == 'delete':
+            self.delete(thing, prefix, request, token)
+
+    def reject(self, prefix, code, message, token):
+        response = {'code': code, 'message': message, 'timestamp': now()}
+        if token is not None:
+            response['clientToken'] = token
+        self.broker.publish_json(prefix + '/rejected', response)
+
+    def get(self, thing, prefix, token):
+        document = self.documents.get(thing)
+        if document is None:
+            return self.reject(prefix, 404, 'No shadow exists with name: \'%s\'' % thing, token)
+        state = {}
+        for section in ('desired', 'reported'):
+            if section in document['state']:
+                state[section] = document['state'][section]
+        delta = self.delta(document['state'])
+        if delta:
+            state['delta'] = delta
+        response = {'state': state, 'metadata': document['metadata'], 'version': document['version'],
+                    'timestamp': now()}
+        if token is not None:
+            response['clientToken'] = token
+        self.broker.publish_json(prefix + '/accepted', response)
+
+    def update(self, thing, prefix, request, token):
+        state = request.get('state')
+        if not isinstance(state, dict):
+            return self.reject(prefix, 400, 'Missing required node: state', token)
+        for section in state:
+            if section not in ('desired', 'reported'):
+                return self.reject(prefix, 400, 'State contains an invalid node: \'%s\'' % section, token)
+            if state[section] is not None and not isinstance(state[section], dict):
+                return self.reject(prefix, 400, 'Invalid JSON', token)
+
+        document = self.documents.get(thing)
+        if document is None:
+            document = {'state': {}, 'metadata': {}, 'version': 0}
+        expected = request.get('version')
+        if expected is not None and expected != document['version']:
+            return self.reject(prefix, 409, 'Version conflict', token)
+
+        previous = json.loads(json.dumps(document))
+        timestamp = now()
+        update_metadata = {}
+        for section, values in state.items():
+            if values is None:
+                document['state'].pop(section, None)
+                document['metadata'].pop(section, None)
+                update_metadata[section] = {'timestamp': timestamp}
+                continue
+            target = document['state'].setdefault(section, {})
+            target_metadata = document['metadata'].setdefault(section, {})
+            update_metadata[section] = self.merge(target, target_metadata, values, timestamp)
+            if not target:
+                document['state'].pop(section)
+                document['metadata'].pop(section, None)
+
+        document['version'] += 1
+        self.documents[thing] = document
+
+        accepted = {'state': state, 'metadata': update_metadata, 'version': document['version'],
+                    'timestamp': timestamp}
+        if token is not None:
+            accepted['clientToken'] = token
+        self.broker.publish_json(prefix + '/accepted', accepted)
+
+        documents = {'previous': previous if previous['version'] else None,
+                     'current': document, 'timestamp': timestamp}
+        if token is not None:
+            documents['clientToken'] = token
+        self.broker.publish_json(prefix + '/documents', documents)
+
+        delta = self.delta(document['state'])
+        if delta and 'desired' in state:
+            message = {'state': delta, 'metadata': self.delta_metadata(delta, document['metadata'].get('desired', {})),
+                       'version': document['version'], 'timestamp': timestamp}
+            if token is not None:
+                message['clientToken'] = token
+            self.broker.publish_json(prefix + '/delta', message)
+
+    def delete(self, thing, prefix, request, token):
+        document = self.documents.get(thing)
+        if document is None:
+            return self.reject(prefix, 404, 'No shadow exists with name: \'%s\'' % thing, token)
+        expected = request.get('version')
+        if expected is not None and expected != document['version']:
+            return self.reject(prefix, 409, 'Version conflict', token)
+        del self.documents[thing]
+        response = {'version': document['version'], 'timestamp': now()}
+        if token is not None:
+            response['clientToken'] = token
+        self.broker.publish_json(prefix + '/accepted', response)
+
+    def merge(self, target, target_metadata, values, timestamp):
+        metadata = {}
+        for key, value in values.items():
+            if value is None:
+                target.pop(key, None)
+                target_metadata.pop(key, None)
+                metadata[key] = {'timestamp': timestamp}
+            elif isinstance(value, dict):
+                child = target.get(key)
+                if not isinstance(child, dict):
+                    child = target[key] = {}
+                child_metadata = target_metadata.get(key)
+                if not isinstance(child_metadata, dict) or 'timestamp' in child_metadata:
+                    child_metadata = target_metadata[key] = {}
+                metadata[key] = self.merge(child, child_metadata, value, timestamp)
+                if not child:
+                    target.pop(key)
+                    target_metadata.pop(key, None)
+            else:
+                target[key] = value
+                target_metadata[key] = {'timestamp': timestamp}
+                metadata[key] = {'timestamp': timestamp}
+        return metadata
+
+    def delta(self, state):
+        desired = state.get('desired')
+        if not desired:
+            return None
+        return self.diff(desired, state.get('reported', {}))
+
+    def diff(self, desired, reported):
+        result = {}
+        for key, value in desired.items():
+            other = reported.get(key) if isinstance(reported, dict) else None
+            if isinstance(value, dict) and isinstance(other, dict):
+                child = self.diff(value, other)
+                if child:
+                    result[key] = child
+            elif value != other:
+                result[key] = value
+        return result
+
+    def delta_metadata(self, delta, metadata):
+        result = {}
+        for key, value in delta.items():
+            entry = metadata.get(key, {})
+            if isinstance(value, dict) and isinstance(entry, dict) and 'timestamp' not in entry:
+                result[key] = self.delta_metadata(value, entry)
+            else:
+                result[key] = entry
+        return result
+
+
+class JobsService(object):
+    """Per-thing job execution queue with the Jobs MQTT API request/response flow."""
+
+    TERMINAL = ('SUCCEEDED', 'FAILED', 'REJECTED', 'REMOVED', 'CANCELED', 'TIMED_OUT')
+
+    def __init__(self, broker):
+        self.broker = broker
+        self.executions = {}
+        self.execution_number = 0
+
+    def add_job(self, thing, job_id, document):
+        self.execution_number += 1
+        execution = {'jobId': job_id, 'thingName': thing, 'status': 'QUEUED', 'queuedAt': now(),
+                     'lastUpdatedAt': now(), 'versionNumber': 1, 'executionNumber': self.execution_number,
+                     'jobDocument': document}
+        self.executions.setdefault(thing, []).append(execution)
+
+    def pending(self, thing):
+        return [e for e in self.executions.get(thing, []) if e['status'] not in self.TERMINAL]
+
+    def summary(self, execution):
+        return {key: execution[key] for key in ('jobId', 'queuedAt', 'lastUpdatedAt', 'versionNumber',
+                                                'executionNumber')}
+
+    def handle(self, thing, path, payload):
+        prefix = '%s%s/jobs/%s' % (THINGS_PREFIX, thing, path)
+        try:
+            request = json.loads(payload.decode('utf-8')) if payload else {}
+        except ValueError:
+            return self.reject(prefix, 'InvalidJson', 'Payload contains invalid json', None)
+        if not isinstance(request, dict):
+            return self.reject(prefix, 'InvalidJson', 'Payload contains invalid json', None)
+        token = request.get('clientToken')
+        self.broker.stats.jobs_requests += 1
+
+        levels = path.split('/')
+        if levels == ['get']:
+            pending = self.pending(thing)
+            response = {'inProgressJobs': [self.summary(e) for e in pending if e['status'] == 'IN_PROGRESS'],
+                        'queuedJobs': [self.summary(e) for e in pending if e['status'] == 'QUEUED'],
+                        'timestamp': now()}
+            self.accept(prefix, response, token)
+        elif levels == ['start-next']:
+            pending = self.pending(thing)
+            response = {'timestamp': now()}
+            if pending:
+                execution = pending[0]
+                if execution['status'] == 'QUEUED':
+                    execution['status'] = 'IN_PROGRESS'
+                    execution['startedAt'] = now()
+                    execution['versionNumber'] += 1
+                if 'statusDetails' in request:
+                    execution['statusDetails'] = request['statusDetails']
+                response['execution'] = execution
+            self.accept(prefix, response, token)
+        elif len(levels) == 2 and levels[1] == 'get':
+            execution = self.find(thing, levels[0])
+            response = {'timestamp': now()}
+            if execution is not None:
+                response['execution'] = dict(execution)
+                if request.get('includeJobDocument') is False:
+                    response['execution'].pop('jobDocument', None)
+            elif levels[0] != '$next':
+                return self.reject(prefix, 'ResourceNotFound', 'Job execution not found', token)
+            self.accept(prefix, response, token)
+        elif len(levels) == 2 and levels[1] == 'update':
+            self.update(thing, prefix, levels[0], request, token)
+
+    def find(self, thing, job_id):
+        pending = self.pending(thing)
+        if job_id == '$next':
+            return pending[0] if pending else None
+        for execution in self.executions.get(thing, []):
+            if execution['jobId'] == job_id:
+                return execution
+        return None
+
+    def update(self, thing, prefix, job_id, request, token):
+        execution = self.find(thing, job_id)
+        if execution is None:
+            return self.reject(prefix, 'ResourceNotFound', 'Job execution not found', token)
+        status = request.get('status')
+        if status not in ('IN_PROGRESS',) + self.TERMINAL:
+            return self.reject(prefix, 'InvalidRequest', 'Invalid status', token)
+        expected = request.get('expectedVersion')
+        if expected and expected != execution['versionNumber']:
+            return self.reject(prefix, 'VersionMismatch', 'Version mismatch', token,
+                               {'status': execution['status'], 'versionNumber': execution['versionNumber']})
+        if execution['status'] in self.TERMINAL:
+            return self.reject(prefix, 'TerminalStateReached', 'Job execution is in a terminal state', token)
+
+        was_next = self.find(thing, '$next') is execution
+        execution['status'] = status
+        execution['lastUpdatedAt'] = now()
+        execution['versionNumber'] += 1
+        if 'statusDetails' in request:
+            execution['statusDetails'] = request['statusDetails']
+
+        response = {'timestamp': now()}
+        if request.get('includeJobExecutionState'):
+            response['executionState'] = {'status': status, 'versionNumber': execution['versionNumber'],
+                                          'statusDetails': execution.get('statusDetails', {})}
+        if request.get('includeJobDocument'):
+            response['jobDocument'] = execution['jobDocument']
+        self.accept(prefix, response, token)
+
+        if status in self.TERMINAL:
+            self.notify(thing, was_next)
+
+    def notify(self, thing, next_changed):
+        pending = self.pending(thing)
+        base = '%s%s/jobs/' % (THINGS_PREFIX, thing)
+        self.broker.publish_json(base + 'notify', {
+            'timestamp': now(),
+            'jobs': {
+                'QUEUED': [self.summary(e) for e in pending if e['status'] == 'QUEUED'],
+                'IN_PROGRESS': [self.summary(e) for e in pending if e['status'] == 'IN_PROGRESS'],
+            }})
+        if next_changed:
+            message = {'timestamp': now()}
+            if pending:
+                message['execution'] = pending[0]
+            self.broker.publish_json(base + 'notify-next', message)
+
+    def accept(self, prefix, response, token):
+        if token is not None:
+            response['clientToken'] = token
+        self.broker.publish_json(prefix + '/accepted', response)
+
+    def reject(self, prefix, code, message, token, state=None):
+        response = {'code': code, 'message': message, 'timestamp': now()}
+        if token is not None:
+            response['clientToken'] = token
+        if state is not None:
+            response['executionState'] = state
+        self.broker.publish_json(prefix + '/rejected', response)
+
+
+class Broker(object):
+    def __init__(self, args):
+        self.args = args
+        self.sessions = {}
+        self.stats = Stats()
+        self.shadow = ShadowService(self)
+        self.jobs = JobsService(self)
+        self.connect_timeout = 10
+        self.refuse_connections = False
+        self.verbose = args.verbose
+
+    def log(self, message):
+        if self.verbose:
+            sys.stderr.write('%.3f %s\n' % (time.time(), message))
+
+    def attach(self, session):
+        previous = self.sessions.get(session.client_id)
+        if previous is not None and previous is not session:
+            # AWS IoT disconnects the existing session when a client id is reused
+            previous.log('taken over by a new connection')
+            previous.close()
+        self.sessions[session.client_id] = session
+
+    def detach(self, session):
+        if self.sessions.get(session.client_id) is session:
+            del self.sessions[session.client_id]
+            session.log('disconnected')
+
+    def publish_json(self, topic, document):
+        self.deliver(topic, json.dumps(document, separators=(',', ':')).encode('utf-8'), 1)
+
+    def deliver(self, topic, payload, qos):
+        for session in list(self.sessions.values()):
+            granted = None
+            for topic_filter, sub_qos in session.subscriptions.items():
+                if topic_matches(topic_filter, topic):
+                    granted = sub_qos if granted is None else max(granted, sub_qos)
+            if granted is not None:
+                session.send_publish(topic, payload, min(qos, granted))
+
+    def route(self, sender, topic, payload, qos):
+        if topic.startswith(THINGS_PREFIX):
+            levels = topic[len(THINGS_PREFIX):].split('/', 2)
+            if len(levels) == 3 and levels[1] == 'shadow' and levels[2] in ('get', 'update', 'delete'):
+                self.shadow.handle(levels[0], levels[2], payload)
+                return
+            if len(levels) == 3 and levels[1] == 'jobs' and not levels[2].endswith(('accepted', 'rejected')):
+                self.jobs.handle(levels[0], levels[2], payload)
+                return
+        self.deliver(topic, payload, qos)
+
+    async def handle_client(self, reader, writer):
+        await Session(self, reader, writer).run()
+
+    async def report_stats(self):
+        while True:
+            await asyncio.sleep(self.args.stats_interval)
+            sys.stderr.write('broker: %s\n' % self.stats.report())
+
+    async def serve(self):
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.minimum_version = ssl.TLSVersion.TLSv1_2
+        context.load_cert_chain(os.path.join(self.args.certs, 'server.crt'),
+                                os.path.join(self.args.certs, 'server.key'))
+        context.load_verify_locations(os.path.join(self.args.certs, self.args.root_ca))
+        context.verify_mode = ssl.CERT_REQUIRED if self.args.require_client_cert else ssl.CERT_OPTIONAL
+
+        server = await asyncio.start_server(self.handle_client, self.args.host, self.args.port, ssl=context)
+        sys.stderr.write('broker: listening on %s:%d\n' % (self.args.host, self.args.port))
+        if self.args.stats_interval > 0:
+            asyncio.ensure_future(self.report_stats())
+        async with server:
+            await server.serve_forever()
+
+
+def generate_certs(directory, root_ca, client_cert, client_key, force):
+    """Creates a throwaway CA plus localhost server and client identities with openssl."""
+    os.makedirs(directory, exist_ok=True)
+
+    def path(name):
+        return os.path.join(directory, name)
+
+    existing = [name for name in (root_ca, client_cert, client_key) if os.path.exists(path(name))]
+    if existing and not force:
+        # The same directory holds the real AWS IoT identity when testing against the cloud
+        sys.stderr.write('broker: refusing to overwrite %s in %s (use --force)\n' % (', '.join(existing), directory))
+        return 1
+
+    def openssl(*args):
+        subprocess.check_call(('openssl',) + args, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    openssl('ecparam', '-name', 'prime256v1', '-genkey', '-noout', '-out', path('rootCA.key'))
+    openssl('req', '-x509', '-new', '-key', path('rootCA.key'), '-sha256', '-days', '3650',
+            '-subj', '/CN=AWS IoT SDK local test CA', '-out', path(root_ca))
+
+    extensions = path('server.ext')
+    with open(extensions, 'w') as ext:
+        ext.write('subjectAltName=DNS:localhost,IP:127.0.0.1\n')
+    for name, subject, ext in (('server', '/CN=localhost', extensions), ('client', '/CN=local-test-client', None)):
+        key = path(name + '.key') if name == 'server' else path(client_key)
+        crt = path(name + '.crt') if name == 'server' else path(client_cert)
+        openssl('ecparam', '-name', 'prime256v1', '-genkey', '-noout', '-out', key)
+        openssl('req', '-new', '-key', key, '-subj', subject, '-out', path(name + '.csr'))
+        sign = ['x509', '-req', '-in', path(name + '.csr'), '-CA', path(root_ca), '-CAkey', path('rootCA.key'),
+                '-CAcreateserial', '-days', '825', '-sha256', '-out', crt]
+        if ext is not None:
+            sign += ['-extfile', ext]
+        openssl(*sign)
+        os.remove(path(name + '.csr'))
+    os.remove(extensions)
+    sys.stderr.write('broker: certificates written to %s\n' % directory)
+    return 0
+
+
+def load_jobs(broker, specs, sample_count, thing):
+    for spec in specs:
+        job_id, _, document_path = spec.partition('=')
+        document = {'operation': 'test'}
+        if document_path:
+            with open(document_path) as document_file:
+                document = json.load(document_file)
+        broker.jobs.add_job(thing, job_id, document)
+    for index in range(sample_count):
+        broker.jobs.add_job(thing, 'local-sample-job-%d' % (index + 1), {'operation': 'sample', 'index': index})
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Local MQTT broker with AWS IoT Shadow and Jobs emulation')
+    parser.add_argument('--host', default='localhost', help='address to listen on')
+    parser.add_argument('--port', type=int, default=8883, help='TLS port to listen on')
+    parser.add_argument('--certs', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..',
+                                                        'certs'), help='directory holding the certificates')
+    parser.add_argument('--root-ca', default='rootCA.crt', help='CA certificate file name inside --certs')
+    parser.add_argument('--client-cert', default='cert.pem', help='client certificate file name for --gen-certs')
+    parser.add_argument('--client-key', default='privkey.pem', help='client key file name for --gen-certs')
+    parser.add_argument('--gen-certs', action='store_true', help='generate the CA, server and client identities and exit')
+    parser.add_argument('--force', action='store_true', help='let --gen-certs overwrite existing certificates')
+    parser.add_argument('--require-client-cert', action='store_true', help='reject clients without a certificate')
+    parser.add_argument('--thing', default='AWS-IoT-C-SDK', help='thing name used for --job and --sample-jobs')
+    parser.add_argument('--job', action='append', default=[], metavar='JOBID[=document.json]',
+                        help='queue a job execution for --thing (repeatable)')
+    parser.add_argument('--sample-jobs', type=int, default=1, help='number of generated jobs to queue for --thing')
+    parser.add_argument('--refuse-connections', action='store_true',
+                        help='answer every CONNECT with "server unavailable" (reconnect back-off testing)')
+    parser.add_argument('--stats-interval', type=float, default=0, help='seconds between statistics reports')
+    parser.add_argument('-v', '--verbose', action='store_true', help='log connection events')
+    args = parser.parse_args()
+
+    if args.gen_certs:
+        return generate_certs(args.certs, args.root_ca, args.client_cert, args.client_key, args.force)
+
+    broker = Broker(args)
+    broker.refuse_connections = args.refuse_connections
+    load_jobs(broker, args.job, args.sample_jobs, args.thing)
+
+    loop = asyncio.new_event_loop()
+    asyncio.set_event_loop(loop)
+    main_task = loop.create_task(broker.serve())
+    for signum in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(signum, main_task.cancel)
+    try:
+        loop.run_until_complete(main_task)
+    except asyncio.CancelledError:
+        pass
+    finally:
+        sys.stderr.write('broker: %s\n' % broker.stats.report())
+        loop.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
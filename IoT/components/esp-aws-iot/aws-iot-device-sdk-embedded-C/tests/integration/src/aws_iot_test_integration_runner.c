@@ -20,8 +20,64 @@
 
 #include "aws_iot_test_integration_common.h"
 
-int main() {
+static int aws_iot_mqtt_tests_run_throughput(const ThroughputTestParams *pParams) {
+	int rc;
+
+	printf("\n\n");
+	printf("*************************************************************************************************\n");
+	printf("* Starting THROUGHPUT MQTT Version 3.1.1 QoS 1 Loop-back Publish and Reconnect                  *\n");
+	printf("*************************************************************************************************\n");
+	rc = aws_iot_mqtt_tests_throughput(pParams);
+	if(0 != rc) {
+		printf("\n********************************************************************************************************\n");
+		printf("* THROUGHPUT MQTT Version 3.1.1 QoS 1 Loop-back Publish and Reconnect FAILED! RC : %4d               *\n", rc);
+		printf("********************************************************************************************************\n");
+		return 1;
+	}
+	printf("\n*************************************************************************************************\n");
+	printf("* THROUGHPUT MQTT Version 3.1.1 QoS 1 Loop-back Publish and Reconnect SUCCESS!!                 *\n");
+	printf("*************************************************************************************************\n");
+	return 0;
+}
+
+static void aws_iot_mqtt_tests_usage(const char *pName) {
+	printf("Usage: %s [-t] [-n messages] [-s payload_bytes] [-r reconnects]\n", pName);
+	printf("  -t  run only the throughput test instead of the functional tests\n");
+	printf("  -n  messages to publish in the throughput test (default %d)\n", THROUGHPUT_MESSAGE_COUNT);
+	printf("  -s  payload size of each throughput message (default %d)\n", THROUGHPUT_PAYLOAD_SIZE);
+	printf("  -r  disconnect/reconnect cycles to time (default %d)\n", THROUGHPUT_RECONNECT_COUNT);
+}
+
+int main(int argc, char **argv) {
 	int rc = 0;
+	int opt;
+	bool throughputMode = false;
+	ThroughputTestParams throughputParams = {0, 0, 0};
+
+	while(-1 != (opt = getopt(argc, argv, "tn:s:r:h"))) {
+		switch(opt) {
+			case 't':
+				throughputMode = true;
+				break;
+			case 'n':
+				throughputParams.messageCount = (unsigned int) strtoul(optarg, NULL, 10);
+				break;
+			case 's':
+				throughputParams.payloadSize = (unsigned int) strtoul(optarg, NULL, 10);
+				break;
+			case 'r':
+				throughputParams.reconnectCount = (unsigned int) strtoul(optarg, NULL, 10);
+				break;
+			case 'h':
+			default:
+				aws_iot_mqtt_tests_usage(argv[0]);
+				return ('h' == opt) ? 0 : 1;
+		}
+	}
+
+	if(throughputMode) {
+		return aws_iot_mqtt_tests_run_throughput(&throughputParams);
+	}
 
 	printf("\n\n");
 	printf("*************************************************************************************************\n");
@@ -0,0 +1,313 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_test_throughput.c
+ * @brief Integration Test measuring publish throughput, loop-back latency and reconnect time
+ *
+ * The client subscribes to its own test topic and publishes numbered QoS 1 messages on it.
+ * Each payload starts with the message sequence number, which indexes the send timestamp,
+ * so the time until the broker delivers the message back gives the round trip latency.
+ * Intended to be run against the local broker in tests/integration/local_broker, but works
+ * against AWS IoT as well (mind the account's publish rate limits).
+ */
+
+#include <time.h>
+
+#include "aws_iot_test_integration_common.h"
+
+static uint64_t *sendTimeUs;
+static uint32_t *latencyUs;
+static unsigned int receivedCount;
+static unsigned int duplicateCount;
+static unsigned int unexpectedCount;
+static unsigned int messageCount;
+
+static uint64_t aws_iot_mqtt_tests_now_us(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec * 1000000) + ((uint64_t) now.tv_nsec / 1000);
+}
+
+static int aws_iot_mqtt_tests_compare_u32(const void *a, const void *b) {
+	uint32_t left = *(const uint32_t *) a;
+	uint32_t right = *(const uint32_t *) b;
+	return (left > right) - (left < right);
+}
+
+static uint32_t aws_iot_mqtt_tests_percentile(const uint32_t *sorted, unsigned int count, unsigned int percent) {
+	unsigned int index;
+
+	if(0 == count) {
+		return 0;
+	}
+	index = (count * percent + 99) / 100;
+	return sorted[(index > 0 ? index : 1) - 1];
+}
+
+static void aws_iot_mqtt_tests_throughput_callback(AWS_IoT_Client *pClient, char *topicName,
+												   uint16_t topicNameLen, IoT_Publish_Message_Params *params,
+												   void *pData) {
+	uint64_t now = aws_iot_mqtt_tests_now_us();
+	unsigned int sequence = 0;
+	size_t i;
+
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(topicName);
+	IOT_UNUSED(topicNameLen);
+	IOT_UNUSED(pData);
+
+	for(i = 0; i < params->payloadLen && ((char *) params->payload)[i] >= '0' && ((char *) params->payload)[i] <= '9'; i++) {
+		sequence = (sequence * 10) + (unsigned int) (((char *) params->payload)[i] - '0');
+	}
+
+	if(0 == i || sequence >= messageCount || 0 == sendTimeUs[sequence]) {
+		unexpectedCount++;
+		return;
+	}
+	if(0 != latencyUs[sequence]) {
+		duplicateCount++;
+		return;
+	}
+
+	/* Store at least 1us so a zero entry keeps meaning "not received yet" */
+	latencyUs[sequence] = (uint32_t) ((now - sendTimeUs[sequence]) > 0 ? (now - sendTimeUs[sequence]) : 1);
+	receivedCount++;
+}
+
+static void aws_iot_mqtt_tests_disconnect_callback_handler(AWS_IoT_Client *pClient, void *param) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(param);
+}
+
+static IoT_Error_t aws_iot_mqtt_tests_throughput_connect(AWS_IoT_Client *pClient, char *pClientId) {
+	char certDirectory[15] = "../../certs";
+	static char clientCRT[PATH_MAX + 1];
+	static char root_CA[PATH_MAX + 1];
+	static char clientKey[PATH_MAX + 1];
+	char CurrentWD[PATH_MAX + 1];
+	IoT_Client_Init_Params initParams = IoT_Client_Init_Params_initializer;
+	IoT_Client_Connect_Params connectParams = IoT_Client_Connect_Params_initializer;
+	unsigned int connectCounter = 0;
+	IoT_Error_t rc;
+
+	getcwd(CurrentWD, sizeof(CurrentWD));
+	snprintf(root_CA, PATH_MAX + 1, "%s/%s/%s", CurrentWD, certDirectory, AWS_IOT_ROOT_CA_FILENAME);
+	snprintf(clientCRT, PATH_MAX + 1, "%s/%s/%s", CurrentWD, certDirectory, AWS_IOT_CERTIFICATE_FILENAME);
+	snprintf(clientKey, PATH_MAX + 1, "%s/%s/%s", CurrentWD, certDirectory, AWS_IOT_PRIVATE_KEY_FILENAME);
+
+	initParams.pHostURL = AWS_IOT_MQTT_HOST;
+	initParams.port = AWS_IOT_MQTT_PORT;
+	initParams.pRootCALocation = root_CA;
+	initParams.pDeviceCertLocation = clientCRT;
+	initParams.pDevicePrivateKeyLocation = clientKey;
+	initParams.mqttCommandTimeout_ms = 10000;
+	initParams.tlsHandshakeTimeout_ms = 10000;
+	initParams.mqttPacketTimeout_ms = 5000;
+	initParams.isSSLHostnameVerify = true;
+	initParams.disconnectHandler = aws_iot_mqtt_tests_disconnect_callback_handler;
+	initParams.enableAutoReconnect = false;
+	initParams.isBlockOnThreadLockEnabled = true;
+	rc = aws_iot_mqtt_init(pClient, &initParams);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+
+	connectParams.keepAliveIntervalInSec = 10;
+	connectParams.isCleanSession = true;
+	connectParams.MQTTVersion = MQTT_3_1_1;
+	connectParams.pClientID = pClientId;
+	connectParams.clientIDLen = (uint16_t) strlen(pClientId);
+	connectParams.isWillMsgPresent = false;
+
+	do {
+		rc = aws_iot_mqtt_connect(pClient, &connectParams);
+		connectCounter++;
+	} while(SUCCESS != rc && connectCounter < CONNECT_MAX_ATTEMPT_COUNT);
+
+	return rc;
+}
+
+static int aws_iot_mqtt_tests_measure_reconnect(AWS_IoT_Client *pClient, unsigned int reconnectCount) {
+	uint32_t *reconnectUs;
+	unsigned int done = 0;
+	unsigned int i;
+	uint64_t start;
+	IoT_Error_t rc;
+	int waitCount;
+
+	if(0 == reconnectCount) {
+		return 0;
+	}
+
+	reconnectUs = calloc(reconnectCount, sizeof(uint32_t));
+	if(NULL == reconnectUs) {
+		return -1;
+	}
+
+	for(i = 0; i < reconnectCount; i++) {
+		/* Drop the TLS session underneath the client and let yield notice it */
+		iot_tls_disconnect(&(pClient->networkStack));
+		for(waitCount = 0; waitCount < 50 && aws_iot_mqtt_is_client_connected(pClient); waitCount++) {
+			aws_iot_mqtt_yield(pClient, 100);
+		}
+
+		start = aws_iot_mqtt_tests_now_us();
+		rc = aws_iot_mqtt_attempt_reconnect(pClient);
+		if(NETWORK_RECONNECTED != rc) {
+			IOT_ERROR("Reconnect %u failed : %d\n", i + 1, rc);
+			break;
+		}
+		reconnectUs[done++] = (uint32_t) (aws_iot_mqtt_tests_now_us() - start);
+	}
+
+	qsort(reconnectUs, done, sizeof(uint32_t), aws_iot_mqtt_tests_compare_u32);
+	printf("Reconnects : %u of %u\n", done, reconnectCount);
+	if(done > 0) {
+		printf("Reconnect time (ms) : min %.2f  p50 %.2f  max %.2f\n",
+			   reconnectUs[0] / 1000.0,
+			   aws_iot_mqtt_tests_percentile(reconnectUs, done, 50) / 1000.0,
+			   reconnectUs[done - 1] / 1000.0);
+	}
+	free(reconnectUs);
+
+	return (done == reconnectCount) ? 0 : -5;
+}
+
+int aws_iot_mqtt_tests_throughput(const ThroughputTestParams *pParams) {
+	AWS_IoT_Client client;
+	IoT_Publish_Message_Params params;
+	char clientId[50];
+	char *payload;
+	uint32_t *sortedLatency;
+	unsigned int payloadSize, reconnectCount;
+	unsigned int i, sorted = 0;
+	unsigned int publishErrors = 0;
+	uint64_t start, publishEnd, end;
+	double elapsedSec;
+	IoT_Error_t rc;
+	int test_result = 0;
+
+	messageCount = (NULL != pParams && 0 != pParams->messageCount) ? pParams->messageCount : THROUGHPUT_MESSAGE_COUNT;
+	payloadSize = (NULL != pParams && 0 != pParams->payloadSize) ? pParams->payloadSize : THROUGHPUT_PAYLOAD_SIZE;
+	reconnectCount = (NULL != pParams && 0 != pParams->reconnectCount) ? pParams->reconnectCount : THROUGHPUT_RECONNECT_COUNT;
+	if(payloadSize < 12) {
+		payloadSize = 12;
+	}
+
+	receivedCount = 0;
+	duplicateCount = 0;
+	unexpectedCount = 0;
+	sendTimeUs = calloc(messageCount, sizeof(uint64_t));
+	latencyUs = calloc(messageCount, sizeof(uint32_t));
+	sortedLatency = calloc(messageCount, sizeof(uint32_t));
+	payload = malloc(payloadSize);
+	if(NULL == sendTimeUs || NULL == latencyUs || NULL == sortedLatency || NULL == payload) {
+		IOT_ERROR("Unable to allocate throughput test buffers\n");
+		test_result = -1;
+		goto cleanup;
+	}
+
+	srand((unsigned int) time(NULL));
+	snprintf(clientId, 50, "%s_%d", INTEGRATION_TEST_CLIENT_ID, rand() % 10000);
+	printf("\nClient ID : %s, host %s:%d\n", clientId, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT);
+	printf("Messages : %u, payload : %u bytes, reconnect cycles : %u\n", messageCount, payloadSize, reconnectCount);
+
+	start = aws_iot_mqtt_tests_now_us();
+	rc = aws_iot_mqtt_tests_throughput_connect(&client, clientId);
+	if(SUCCESS != rc) {
+		IOT_ERROR("## Connect Failed. error code %d\n", rc);
+		test_result = -1;
+		goto cleanup;
+	}
+	printf("Connect time (ms) : %.2f\n", (aws_iot_mqtt_tests_now_us() - start) / 1000.0);
+
+	rc = aws_iot_mqtt_subscribe(&client, THROUGHPUT_TEST_TOPIC, strlen(THROUGHPUT_TEST_TOPIC), QOS1,
+								aws_iot_mqtt_tests_throughput_callback, NULL);
+	if(SUCCESS != rc) {
+		IOT_ERROR("Subscribe failed : %d\n", rc);
+		test_result = -2;
+		goto disconnect;
+	}
+
+	memset(payload, 'x', payloadSize);
+	params.qos = QOS1;
+	params.isRetained = 0;
+	params.payload = payload;
+	params.payloadLen = payloadSize;
+
+	start = aws_iot_mqtt_tests_now_us();
+	for(i = 0; i < messageCount; i++) {
+		/* Zero-padded sequence followed by a separator, the rest is filler */
+		snprintf(payload, 12, "%010u", i);
+		payload[10] = ':';
+		sendTimeUs[i] = aws_iot_mqtt_tests_now_us();
+		/* A QoS 1 publish blocks on its PUBACK and dispatches incoming messages meanwhile */
+		rc = aws_iot_mqtt_publish(&client, THROUGHPUT_TEST_TOPIC, strlen(THROUGHPUT_TEST_TOPIC), &params);
+		if(SUCCESS != rc) {
+			publishErrors++;
+			sendTimeUs[i] = 0;
+		}
+	}
+	publishEnd = aws_iot_mqtt_tests_now_us();
+
+	while(receivedCount + publishErrors < messageCount &&
+		  (aws_iot_mqtt_tests_now_us() - publishEnd) < (uint64_t) THROUGHPUT_DRAIN_TIMEOUT_MS * 1000) {
+		aws_iot_mqtt_yield(&client, 10);
+	}
+	end = aws_iot_mqtt_tests_now_us();
+
+	for(i = 0; i < messageCount; i++) {
+		if(0 != latencyUs[i]) {
+			sortedLatency[sorted++] = latencyUs[i];
+		}
+	}
+	qsort(sortedLatency, sorted, sizeof(uint32_t), aws_iot_mqtt_tests_compare_u32);
+
+	elapsedSec = (end - start) / 1000000.0;
+	printf("\nPublished : %u (errors %u) in %.3f s -> %.1f msg/s\n", messageCount - publishErrors, publishErrors,
+		   (publishEnd - start) / 1000000.0, (messageCount - publishErrors) / ((publishEnd - start) / 1000000.0));
+	printf("Received : %u (duplicates %u, unexpected %u) in %.3f s -> %.1f msg/s, %.1f KiB/s\n", receivedCount,
+		   duplicateCount, unexpectedCount, elapsedSec, receivedCount / elapsedSec,
+		   (receivedCount * (double) payloadSize) / 1024.0 / elapsedSec);
+	if(sorted > 0) {
+		printf("Loop-back latency (ms) : min %.2f  p50 %.2f  p99 %.2f  max %.2f\n",
+			   sortedLatency[0] / 1000.0,
+			   aws_iot_mqtt_tests_percentile(sortedLatency, sorted, 50) / 1000.0,
+			   aws_iot_mqtt_tests_percentile(sortedLatency, sorted, 99) / 1000.0,
+			   sortedLatency[sorted - 1] / 1000.0);
+	}
+
+	if(receivedCount * 100.0f / messageCount < RX_RECEIVE_PERCENTAGE) {
+		IOT_ERROR("Only %u of %u messages were received\n", receivedCount, messageCount);
+		test_result = -3;
+	}
+
+	if(0 == test_result) {
+		test_result = aws_iot_mqtt_tests_measure_reconnect(&client, reconnectCount);
+	}
+
+disconnect:
+	aws_iot_mqtt_disconnect(&client);
+cleanup:
+	free(sendTimeUs);
+	free(latencyUs);
+	free(sortedLatency);
+	free(payload);
+	sendTimeUs = NULL;
+	latencyUs = NULL;
+
+	return test_result;
+}
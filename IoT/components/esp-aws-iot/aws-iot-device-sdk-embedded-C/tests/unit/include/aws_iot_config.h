@@ -70,4 +70,30 @@
 #define AWS_IOT_MQTT_MIN_RECONNECT_WAIT_INTERVAL 1000 ///< Minimum time before the First reconnect attempt is made as part of the exponential back-off algorithm
 #define AWS_IOT_MQTT_MAX_RECONNECT_WAIT_INTERVAL 128000 ///< Maximum time interval after which exponential back-off will stop attempting to reconnect.
 
+// Latency tracing, small depth so the tests exercise wrap around
+#define ENABLE_IOT_LATENCY_TRACE
+#define AWS_IOT_LATENCY_TRACE_DEPTH 16
+
+// Deferred logging, small depth so the tests exercise overwriting
+#define ENABLE_IOT_DEFERRED_LOG
+#define AWS_IOT_DEFERRED_LOG_DEPTH 8
+#define AWS_IOT_DEFERRED_LOG_LEVEL IOT_DLOG_LEVEL_DEBUG
+
+// MQTT 5, two aliases so the tests exercise replacement. Sessions stay on 3.1.1 unless a test asks for MQTT_5
+#define ENABLE_IOT_MQTT5
+#define AWS_IOT_MQTT5_TOPIC_ALIASES 2
+
+// Write coalescing, a small buffer so the tests exercise a full batch
+#define ENABLE_IOT_MQTT_WRITE_COALESCING
+#define AWS_IOT_MQTT_COALESCE_BUF_LEN 16
+
+// Shadow mirror, few fields so the tests exercise a full table
+#define ENABLE_IOT_SHADOW_MIRROR
+#define AWS_IOT_SHADOW_MIRROR_MAX_FIELDS 8
+
+// Buffer arena, sized for the MQTT buffers plus one received Shadow document with its tokens and topics
+#define ENABLE_IOT_BUFFER_ARENA
+#define AWS_IOT_BUFFER_ARENA_SIZE 6144
+#define AWS_IOT_BUFFER_ARENA_MAX_BLOCKS 8
+
 #endif /* IOT_TESTS_UNIT_CONFIG_H_ */
@@ -0,0 +1,39 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_buffer_arena.cpp
+ * @brief IoT Client Unit Testing - Buffer Arena Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(BufferArenaTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(BufferArenaTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(BufferArenaTests)
+};
+
+TEST_GROUP_C_WRAPPER(BufferArenaTests, ScopedAllocReleasedInOrder)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, AllocationsAligned)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, TicketsIdentifyLiveAllocations)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, ReservationsFromTheTop)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, ExhaustionCountsFailures)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, BlockLimitCountsFailures)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, ResetStatsKeepsLiveAllocations)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, DeltaDocumentInPacketScope)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, DeltaDroppedWhenArenaFull)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, UpdateTopicInActionScope)
+TEST_GROUP_C_WRAPPER(BufferArenaTests, UpdateFailsWhenArenaFull)
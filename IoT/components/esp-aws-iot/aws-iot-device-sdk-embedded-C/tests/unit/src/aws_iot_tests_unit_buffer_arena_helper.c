@@ -0,0 +1,427 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_buffer_arena_helper.c
+ * @brief IoT Client Unit Testing - Buffer Arena Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_buffer_arena.h"
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#undef AWS_IOT_MY_THING_NAME
+#define AWS_IOT_MY_THING_NAME "AWS-IoT-C-SDK"
+
+#define SHADOW_DELTA_UPDATE "$aws/things/%s/shadow/update/delta"
+#define SHADOW_UPDATE "$aws/things/%s/shadow/update"
+
+#define ARENA_ALIGNED(x) (((x) + 7u) & ~(size_t) 7u)
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static ShadowInitParameters_t shadowInitParams;
+static ShadowConnectParameters_t shadowConnectParams;
+
+static IoT_Arena_Mark_t testScope;
+static char shadowDeltaTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+static bool windowOpenData;
+
+static void windowCallback(const char *pJsonStringData, uint32_t JsonStringDataLen, jsonStruct_t *pContext) {
+	IOT_UNUSED(pJsonStringData);
+	IOT_UNUSED(JsonStringDataLen);
+	IOT_UNUSED(pContext);
+}
+
+/* Largest scoped allocation the arena can currently satisfy */
+static size_t arenaFreeBytes(void) {
+	IoT_Arena_Mark_t mark = aws_iot_arena_mark();
+	size_t size;
+
+	for(size = AWS_IOT_BUFFER_ARENA_SIZE; size > 0; size -= 8) {
+		if(NULL != aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, size)) {
+			break;
+		}
+	}
+	aws_iot_arena_release(mark);
+	aws_iot_arena_reset_stats();
+
+	return size;
+}
+
+static void connectShadowClient(void) {
+	IoT_Error_t rc;
+
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	rc = aws_iot_shadow_init(&client, &shadowInitParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	shadowConnectParams.pMyThingName = AWS_IOT_MY_THING_NAME;
+	shadowConnectParams.pMqttClientId = AWS_IOT_MQTT_CLIENT_ID;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID);
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	rc = aws_iot_shadow_connect(&client, &shadowConnectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+}
+
+/* Register a delta handler for "window" and queue a delta document for the next yield */
+static void registerWindowDelta(char *pDocument) {
+	jsonStruct_t *pHandler;
+	static jsonStruct_t windowHandler;
+	IoT_Publish_Message_Params params;
+
+	pHandler = &windowHandler;
+	pHandler->cb = windowCallback;
+	pHandler->pKey = "window";
+	pHandler->type = SHADOW_JSON_BOOL;
+	pHandler->pData = &windowOpenData;
+	pHandler->dataLength = sizeof(bool);
+	windowOpenData = false;
+
+	params.payloadLen = strlen(pDocument);
+	params.payload = pDocument;
+	params.qos = QOS0;
+
+	snprintf(shadowDeltaTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES, SHADOW_DELTA_UPDATE, AWS_IOT_MY_THING_NAME);
+
+	ResetTLSBuffer();
+	setTLSRxBufferForSuback(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_delta(&client, pHandler));
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params, params.payload);
+}
+
+TEST_GROUP_C_SETUP(BufferArenaTests) {
+	/* Other groups leave their MQTT buffers reserved, the tests only rely on what is free */
+	testScope = aws_iot_arena_mark();
+	aws_iot_arena_reset_stats();
+	ResetTLSBuffer();
+}
+
+TEST_GROUP_C_TEARDOWN(BufferArenaTests) {
+	aws_iot_arena_release(testScope);
+	CHECK_EQUAL_C_INT(testScope, aws_iot_arena_mark());
+}
+
+TEST_C(BufferArenaTests, ScopedAllocReleasedInOrder) {
+	IoT_Arena_Region_Stats_t stats;
+	IoT_Arena_Mark_t inner;
+	unsigned char *pA, *pB, *pC;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - scoped allocations released in order \n");
+
+	pA = (unsigned char *) aws_iot_arena_alloc(IOT_ARENA_TOPIC, 10);
+	pB = (unsigned char *) aws_iot_arena_alloc(IOT_ARENA_SHADOW_RX, 100);
+	CHECK_C(NULL != pA && NULL != pB);
+	CHECK_C(pA + ARENA_ALIGNED(10) == pB);
+
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(ARENA_ALIGNED(10), stats.currentBytes);
+	CHECK_EQUAL_C_INT(1, stats.allocCount);
+
+	inner = aws_iot_arena_mark();
+	pC = (unsigned char *) aws_iot_arena_alloc(IOT_ARENA_TOPIC, 40);
+	CHECK_C(pB + ARENA_ALIGNED(100) == pC);
+	aws_iot_arena_release(inner);
+	CHECK_EQUAL_C_INT(inner, aws_iot_arena_mark());
+
+	/* The released bytes are handed out again */
+	CHECK_C(pC == aws_iot_arena_alloc(IOT_ARENA_TOPIC, 40));
+
+	aws_iot_arena_release(testScope);
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	CHECK_EQUAL_C_INT(ARENA_ALIGNED(10) + ARENA_ALIGNED(40), stats.peakBytes);
+	aws_iot_arena_get_stats(IOT_ARENA_SHADOW_RX, &stats);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	CHECK_C(pA == aws_iot_arena_alloc(IOT_ARENA_TOPIC, 1));
+
+	/* Releasing to a mark above the current position changes nothing */
+	aws_iot_arena_release(aws_iot_arena_mark() + 64);
+	CHECK_EQUAL_C_INT(testScope + ARENA_ALIGNED(1), aws_iot_arena_mark());
+
+	IOT_DEBUG("-->Success - scoped allocations released in order \n");
+}
+
+TEST_C(BufferArenaTests, AllocationsAligned) {
+	size_t size;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - allocations aligned \n");
+
+	for(size = 1; size <= 17; size++) {
+		void *pBuf = aws_iot_arena_alloc(IOT_ARENA_TOPIC, size);
+		CHECK_C(NULL != pBuf);
+		CHECK_EQUAL_C_INT(0, (uintptr_t) pBuf % 8);
+		aws_iot_arena_release(testScope);
+	}
+
+	CHECK_C(NULL == aws_iot_arena_alloc(IOT_ARENA_TOPIC, 0));
+	CHECK_C(NULL == aws_iot_arena_alloc(IOT_ARENA_REGION_COUNT, 8));
+	CHECK_EQUAL_C_INT(testScope, aws_iot_arena_mark());
+
+	IOT_DEBUG("-->Success - allocations aligned \n");
+}
+
+TEST_C(BufferArenaTests, TicketsIdentifyLiveAllocations) {
+	void *pA, *pB, *pAgain;
+	uint32_t ticketA;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - tickets identify live allocations \n");
+
+	pA = aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, 32);
+	pB = aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, 32);
+	ticketA = aws_iot_arena_ticket(pA);
+	CHECK_C(0 != ticketA);
+	CHECK_C(ticketA != aws_iot_arena_ticket(pB));
+	CHECK_EQUAL_C_INT(0, aws_iot_arena_ticket((unsigned char *) pA + 8));
+	CHECK_EQUAL_C_INT(0, aws_iot_arena_ticket(NULL));
+
+	aws_iot_arena_release(testScope);
+	CHECK_EQUAL_C_INT(0, aws_iot_arena_ticket(pA));
+
+	/* The same memory handed out again is a different allocation */
+	pAgain = aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, 32);
+	CHECK_C(pA == pAgain);
+	CHECK_C(0 != aws_iot_arena_ticket(pAgain));
+	CHECK_C(ticketA != aws_iot_arena_ticket(pAgain));
+
+	IOT_DEBUG("-->Success - tickets identify live allocations \n");
+}
+
+TEST_C(BufferArenaTests, ReservationsFromTheTop) {
+	IoT_Arena_Region_Stats_t stats;
+	unsigned char *pTx, *pRx;
+	unsigned char *pScoped;
+	uint32_t failCount;
+	size_t freeBytes;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - reservations from the top \n");
+
+	/* The MQTT client reserves its buffers on init, reserving them again returns the same block */
+	pTx = (unsigned char *) aws_iot_arena_reserve(IOT_ARENA_MQTT_TX, AWS_IOT_MQTT_TX_BUF_LEN);
+	pRx = (unsigned char *) aws_iot_arena_reserve(IOT_ARENA_MQTT_RX, AWS_IOT_MQTT_RX_BUF_LEN);
+	CHECK_C(NULL != pTx && NULL != pRx);
+	CHECK_C(pTx == aws_iot_arena_reserve(IOT_ARENA_MQTT_TX, AWS_IOT_MQTT_TX_BUF_LEN));
+	CHECK_C(pTx == aws_iot_arena_reserve(IOT_ARENA_MQTT_TX, 16));
+	aws_iot_arena_get_stats(IOT_ARENA_MQTT_TX, &stats);
+	CHECK_EQUAL_C_INT(ARENA_ALIGNED(AWS_IOT_MQTT_TX_BUF_LEN), stats.currentBytes);
+
+	/* A bigger buffer for the same region is refused */
+	failCount = stats.failCount;
+	CHECK_C(NULL == aws_iot_arena_reserve(IOT_ARENA_MQTT_TX, AWS_IOT_MQTT_TX_BUF_LEN + 8));
+	aws_iot_arena_get_stats(IOT_ARENA_MQTT_TX, &stats);
+	CHECK_EQUAL_C_INT(failCount + 1, stats.failCount);
+	CHECK_C(NULL == aws_iot_arena_reserve(IOT_ARENA_REGION_COUNT, 8));
+	CHECK_C(NULL == aws_iot_arena_reserve(IOT_ARENA_TOPIC, 0));
+
+	/* Scoped allocations end below the reservations, even when they take everything */
+	freeBytes = arenaFreeBytes();
+	pScoped = (unsigned char *) aws_iot_arena_alloc(IOT_ARENA_SHADOW_RX, freeBytes);
+	CHECK_C(NULL != pScoped);
+	CHECK_C(pScoped + freeBytes <= pTx);
+	CHECK_C(pScoped + freeBytes <= pRx);
+	CHECK_C(NULL == aws_iot_arena_alloc(IOT_ARENA_SHADOW_RX, 8));
+
+	/* A reservation can't take space from live scoped allocations */
+	CHECK_C(NULL == aws_iot_arena_reserve(IOT_ARENA_SHADOW_DOC, 8));
+	aws_iot_arena_get_stats(IOT_ARENA_SHADOW_DOC, &stats);
+	CHECK_EQUAL_C_INT(1, stats.failCount);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+
+	IOT_DEBUG("-->Success - reservations from the top \n");
+}
+
+TEST_C(BufferArenaTests, ExhaustionCountsFailures) {
+	IoT_Arena_Region_Stats_t stats;
+	size_t freeBytes;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - exhaustion counts failures \n");
+
+	freeBytes = arenaFreeBytes();
+	CHECK_C(freeBytes >= 256);
+
+	CHECK_C(NULL != aws_iot_arena_alloc(IOT_ARENA_SHADOW_RX, freeBytes - 64));
+	CHECK_C(NULL == aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, 72));
+	CHECK_C(NULL == aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, 65));
+	CHECK_C(NULL != aws_iot_arena_alloc(IOT_ARENA_TOPIC, 64));
+
+	aws_iot_arena_get_stats(IOT_ARENA_JSON_TOKENS, &stats);
+	CHECK_EQUAL_C_INT(2, stats.failCount);
+	CHECK_EQUAL_C_INT(0, stats.allocCount);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(0, stats.failCount);
+	CHECK_EQUAL_C_INT(1, stats.allocCount);
+
+	/* Everything is usable again once the scope is released */
+	aws_iot_arena_release(testScope);
+	CHECK_C(NULL != aws_iot_arena_alloc(IOT_ARENA_JSON_TOKENS, freeBytes));
+
+	IOT_DEBUG("-->Success - exhaustion counts failures \n");
+}
+
+TEST_C(BufferArenaTests, BlockLimitCountsFailures) {
+	IoT_Arena_Region_Stats_t stats;
+	uint32_t count = 0;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - block limit counts failures \n");
+
+	while(NULL != aws_iot_arena_alloc(IOT_ARENA_TOPIC, 8)) {
+		count++;
+	}
+	CHECK_EQUAL_C_INT(AWS_IOT_BUFFER_ARENA_MAX_BLOCKS, count);
+
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(1, stats.failCount);
+	CHECK_EQUAL_C_INT(AWS_IOT_BUFFER_ARENA_MAX_BLOCKS * 8, stats.currentBytes);
+
+	IOT_DEBUG("-->Success - block limit counts failures \n");
+}
+
+TEST_C(BufferArenaTests, ResetStatsKeepsLiveAllocations) {
+	IoT_Arena_Region_Stats_t stats;
+	size_t peak;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - reset stats keeps live allocations \n");
+
+	aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, 200);
+	aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, 100);
+	peak = aws_iot_arena_get_peak();
+	aws_iot_arena_release(testScope);
+	aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, 48);
+	CHECK_EQUAL_C_INT(peak, aws_iot_arena_get_peak());
+
+	aws_iot_arena_reset_stats();
+	aws_iot_arena_get_stats(IOT_ARENA_SHADOW_DOC, &stats);
+	CHECK_EQUAL_C_INT(48, stats.currentBytes);
+	CHECK_EQUAL_C_INT(48, stats.peakBytes);
+	CHECK_EQUAL_C_INT(0, stats.allocCount);
+	CHECK_EQUAL_C_INT(peak - ARENA_ALIGNED(200) - ARENA_ALIGNED(100) + 48, aws_iot_arena_get_peak());
+
+	IOT_DEBUG("-->Success - reset stats keeps live allocations \n");
+}
+
+TEST_C(BufferArenaTests, DeltaDocumentInPacketScope) {
+	char deltaDocument[] = "{\"state\":{\"delta\":{\"window\":true}},\"version\":1}";
+	IoT_Arena_Region_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - delta document in packet scope \n");
+
+	connectShadowClient();
+	registerWindowDelta(deltaDocument);
+	aws_iot_arena_reset_stats();
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 3000));
+	CHECK_EQUAL_C_INT(true, windowOpenData);
+
+	/* The copy is as large as the payload and gone with the packet, the mock message carries a few extra bytes */
+	aws_iot_arena_get_stats(IOT_ARENA_SHADOW_RX, &stats);
+	CHECK_EQUAL_C_INT(1, stats.allocCount);
+	CHECK_C(stats.peakBytes >= sizeof(deltaDocument));
+	CHECK_C(stats.peakBytes <= ARENA_ALIGNED(sizeof(deltaDocument) + 8));
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	aws_iot_arena_get_stats(IOT_ARENA_JSON_TOKENS, &stats);
+	CHECK_C(stats.allocCount >= 1);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	CHECK_EQUAL_C_INT(testScope, aws_iot_arena_mark());
+
+	IOT_DEBUG("-->Success - delta document in packet scope \n");
+}
+
+TEST_C(BufferArenaTests, DeltaDroppedWhenArenaFull) {
+	char deltaDocument[] = "{\"state\":{\"delta\":{\"window\":true}},\"version\":1}";
+	IoT_Arena_Region_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - delta dropped when the arena is full \n");
+
+	connectShadowClient();
+	registerWindowDelta(deltaDocument);
+
+	/* Leave less than the document needs */
+	CHECK_C(NULL != aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, arenaFreeBytes() - 16));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 3000));
+	CHECK_EQUAL_C_INT(false, windowOpenData);
+	aws_iot_arena_get_stats(IOT_ARENA_SHADOW_RX, &stats);
+	CHECK_EQUAL_C_INT(1, stats.failCount);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+
+	IOT_DEBUG("-->Success - delta dropped when the arena is full \n");
+}
+
+TEST_C(BufferArenaTests, UpdateTopicInActionScope) {
+	char updateDocument[] = "{\"state\":{\"reported\":{\"window\":true}}, \"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-0\"}";
+	char expectedTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	IoT_Arena_Region_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - update topic in action scope \n");
+
+	connectShadowClient();
+	aws_iot_arena_reset_stats();
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update(&client, AWS_IOT_MY_THING_NAME, updateDocument, NULL, NULL, 4, false));
+	snprintf(expectedTopic, sizeof(expectedTopic), SHADOW_UPDATE, AWS_IOT_MY_THING_NAME);
+	CHECK_EQUAL_C_STRING(expectedTopic, LastPublishMessageTopic);
+
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(1, stats.allocCount);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	aws_iot_arena_get_stats(IOT_ARENA_JSON_TOKENS, &stats);
+	CHECK_C(stats.allocCount >= 1);
+	CHECK_EQUAL_C_INT(0, stats.currentBytes);
+	CHECK_EQUAL_C_INT(testScope, aws_iot_arena_mark());
+
+	IOT_DEBUG("-->Success - update topic in action scope \n");
+}
+
+TEST_C(BufferArenaTests, UpdateFailsWhenArenaFull) {
+	char updateDocument[] = "{\"state\":{\"reported\":{\"window\":true}}}";
+	IoT_Arena_Region_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Buffer Arena Tests - update fails when the arena is full \n");
+
+	connectShadowClient();
+	CHECK_C(NULL != aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, arenaFreeBytes()));
+	snprintf(LastPublishMessageTopic, sizeof(LastPublishMessageTopic), "No Message");
+
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_update(&client, AWS_IOT_MY_THING_NAME, updateDocument, NULL, NULL, 4, false));
+	CHECK_EQUAL_C_STRING("No Message", LastPublishMessageTopic);
+	aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &stats);
+	CHECK_EQUAL_C_INT(1, stats.failCount);
+
+	IOT_DEBUG("-->Success - update fails when the arena is full \n");
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_deferred_log.cpp
+ * @brief IoT Client Unit Testing - Deferred Log Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(DeferredLogTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(DeferredLogTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(DeferredLogTests)
+};
+
+TEST_GROUP_C_WRAPPER(DeferredLogTests, RecordLayout)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, StringArgumentsCopiedOrReferenced)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, WideAndStarArguments)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, TruncatedArguments)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, OverwriteKeepsNewest)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, LevelFilter)
+TEST_GROUP_C_WRAPPER(DeferredLogTests, DrainLimitAndNullSink)
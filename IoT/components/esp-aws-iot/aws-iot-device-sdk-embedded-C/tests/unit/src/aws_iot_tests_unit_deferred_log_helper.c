@@ -0,0 +1,297 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_deferred_log_helper.c
+ * @brief IoT Client Unit Testing - Deferred Log Tests helper
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+#include <aws_iot_deferred_log.h>
+#include <aws_iot_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_CAPTURED_LINES 16
+
+static const char *testTag = "test";
+static const char *formatInt = "value %d";
+static const char *formatStrings = "%s and %s";
+static const char *formatWide = "%lld %f %.*s";
+static const char *formatMany = "%d %d %d %d %d %d %d %d %d %d %d %d";
+
+static unsigned char capturedRecords[MAX_CAPTURED_LINES][AWS_IOT_DEFERRED_LOG_RECORD_MAX_LEN];
+static size_t capturedLens[MAX_CAPTURED_LINES];
+static uint32_t capturedCount;
+static bool capturedLinesValid;
+
+static uint32_t readLe32(const unsigned char *pBuf) {
+	return (uint32_t) pBuf[0] | ((uint32_t) pBuf[1] << 8) | ((uint32_t) pBuf[2] << 16) | ((uint32_t) pBuf[3] << 24);
+}
+
+static int base64Value(char c) {
+	const char *pAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char *pFound = strchr(pAlphabet, c);
+	return ('\0' != c && NULL != pFound) ? (int) (pFound - pAlphabet) : -1;
+}
+
+static size_t base64Decode(const char *pIn, size_t inLen, unsigned char *pOut) {
+	size_t i;
+	size_t outLen = 0;
+	uint32_t quad;
+	int j;
+
+	for(i = 0; i + 4 <= inLen; i += 4) {
+		quad = 0;
+		for(j = 0; j < 4; j++) {
+			quad = (quad << 6) | (uint32_t) ('=' == pIn[i + j] ? 0 : base64Value(pIn[i + j]));
+		}
+		pOut[outLen++] = (unsigned char) (quad >> 16);
+		if('=' != pIn[i + 2]) {
+			pOut[outLen++] = (unsigned char) (quad >> 8);
+		}
+		if('=' != pIn[i + 3]) {
+			pOut[outLen++] = (unsigned char) quad;
+		}
+	}
+
+	return outLen;
+}
+
+static void captureSink(const char *pLine, size_t lineLen, void *pContext) {
+	size_t prefixLen = strlen(AWS_IOT_DEFERRED_LOG_LINE_PREFIX);
+
+	(*(uint32_t *) pContext)++;
+
+	if(lineLen > AWS_IOT_DEFERRED_LOG_LINE_MAX_LEN || 0 != strncmp(pLine, AWS_IOT_DEFERRED_LOG_LINE_PREFIX, prefixLen)
+	   || '\n' != pLine[lineLen - 1] || '\0' != pLine[lineLen]) {
+		capturedLinesValid = false;
+		return;
+	}
+
+	if(capturedCount < MAX_CAPTURED_LINES) {
+		capturedLens[capturedCount] = base64Decode(pLine + prefixLen, lineLen - prefixLen - 1,
+												   capturedRecords[capturedCount]);
+		capturedCount++;
+	}
+}
+
+static uint32_t drainAll(uint32_t maxRecords) {
+	uint32_t calls = 0;
+	uint32_t drained = aws_iot_deferred_log_drain(captureSink, &calls, maxRecords);
+	CHECK_EQUAL_C_INT(drained, calls);
+	CHECK_C(capturedLinesValid);
+	return drained;
+}
+
+TEST_GROUP_C_SETUP(DeferredLogTests) {
+	aws_iot_deferred_log_reset();
+	memset(capturedRecords, 0, sizeof(capturedRecords));
+	capturedCount = 0;
+	capturedLinesValid = true;
+}
+
+TEST_GROUP_C_TEARDOWN(DeferredLogTests) {
+	aws_iot_deferred_log_reset();
+}
+
+TEST_C(DeferredLogTests, RecordLayout) {
+	const unsigned char *pRecord = capturedRecords[0];
+	IoT_Deferred_Log_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - record layout \n");
+
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatInt, -7);
+	CHECK_EQUAL_C_INT(1, drainAll(0));
+
+	CHECK_EQUAL_C_INT(AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN + 4, capturedLens[0]);
+	CHECK_EQUAL_C_INT(0, readLe32(pRecord));
+	CHECK_EQUAL_C_INT((uint32_t) (uintptr_t) testTag, readLe32(pRecord + 8));
+	CHECK_EQUAL_C_INT((uint32_t) (uintptr_t) formatInt, readLe32(pRecord + 12));
+	CHECK_EQUAL_C_INT(IOT_DLOG_LEVEL_INFO, pRecord[16]);
+	CHECK_EQUAL_C_INT(0, pRecord[17]);
+	CHECK_EQUAL_C_INT(4, pRecord[18]);
+	CHECK_EQUAL_C_INT((uint32_t) -7, readLe32(pRecord + 19));
+
+	/* Drained records are gone */
+	CHECK_EQUAL_C_INT(0, drainAll(0));
+
+	aws_iot_deferred_log_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.written);
+	CHECK_EQUAL_C_INT(1, stats.drained);
+	CHECK_EQUAL_C_INT(0, stats.overwritten);
+	CHECK_EQUAL_C_INT(0, stats.truncated);
+
+	IOT_DEBUG("-->Success - record layout \n");
+}
+
+TEST_C(DeferredLogTests, StringArgumentsCopiedOrReferenced) {
+	char volatileText[AWS_IOT_DEFERRED_LOG_MAX_STRING + 8];
+	const unsigned char *pArgs;
+	IoT_Deferred_Log_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - string arguments copied or referenced \n");
+
+	strcpy(volatileText, "abc");
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatStrings, volatileText, "de");
+	/* Changing the buffer afterwards must not change the record */
+	strcpy(volatileText, "xyz");
+
+	memset(volatileText, 'a', sizeof(volatileText) - 1);
+	volatileText[sizeof(volatileText) - 1] = '\0';
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatStrings, volatileText, "");
+
+	aws_iot_deferred_log_write_ref(IOT_DLOG_LEVEL_INFO, testTag, formatStrings, formatInt, testTag);
+
+	CHECK_EQUAL_C_INT(3, drainAll(0));
+
+	pArgs = capturedRecords[0] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN;
+	CHECK_EQUAL_C_INT(3, pArgs[0]);
+	CHECK_C(0 == memcmp(pArgs + 1, "abc", 3));
+	CHECK_EQUAL_C_INT(2, pArgs[4]);
+	CHECK_C(0 == memcmp(pArgs + 5, "de", 2));
+
+	/* Long strings are cut and the record is flagged */
+	pArgs = capturedRecords[1] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN;
+	CHECK_EQUAL_C_INT(IOT_DLOG_FLAG_TRUNCATED, capturedRecords[1][17]);
+	CHECK_EQUAL_C_INT(AWS_IOT_DEFERRED_LOG_MAX_STRING, pArgs[0]);
+	CHECK_EQUAL_C_INT(0, pArgs[AWS_IOT_DEFERRED_LOG_MAX_STRING + 1]);
+
+	/* Referenced strings are stored as addresses */
+	pArgs = capturedRecords[2] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN;
+	CHECK_EQUAL_C_INT(IOT_DLOG_FLAG_STRING_REF, capturedRecords[2][17]);
+	CHECK_EQUAL_C_INT(8, capturedRecords[2][18]);
+	CHECK_EQUAL_C_INT((uint32_t) (uintptr_t) formatInt, readLe32(pArgs));
+	CHECK_EQUAL_C_INT((uint32_t) (uintptr_t) testTag, readLe32(pArgs + 4));
+
+	aws_iot_deferred_log_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.truncated);
+
+	IOT_DEBUG("-->Success - string arguments copied or referenced \n");
+}
+
+TEST_C(DeferredLogTests, WideAndStarArguments) {
+	const unsigned char *pArgs = capturedRecords[0] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN;
+	double value = 2.5;
+	double decoded;
+	uint64_t bits;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - wide and star arguments \n");
+
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatWide, -2LL, value, 2, "hello");
+	CHECK_EQUAL_C_INT(1, drainAll(0));
+
+	/* 8 byte integer, 8 byte double, 4 byte precision, length prefixed string cut to the precision */
+	CHECK_EQUAL_C_INT(8 + 8 + 4 + 1 + 2, capturedRecords[0][18]);
+	CHECK_EQUAL_C_INT(0xFFFFFFFE, readLe32(pArgs));
+	CHECK_EQUAL_C_INT(0xFFFFFFFF, readLe32(pArgs + 4));
+	bits = (uint64_t) readLe32(pArgs + 8) | ((uint64_t) readLe32(pArgs + 12) << 32);
+	memcpy(&decoded, &bits, sizeof(decoded));
+	CHECK_C(value == decoded);
+	CHECK_EQUAL_C_INT(2, readLe32(pArgs + 16));
+	CHECK_EQUAL_C_INT(2, pArgs[20]);
+	CHECK_C(0 == memcmp(pArgs + 21, "he", 2));
+
+	IOT_DEBUG("-->Success - wide and star arguments \n");
+}
+
+TEST_C(DeferredLogTests, TruncatedArguments) {
+	IoT_Deferred_Log_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - truncated arguments \n");
+
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatMany, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12);
+	CHECK_EQUAL_C_INT(1, drainAll(0));
+
+	CHECK_EQUAL_C_INT(IOT_DLOG_FLAG_TRUNCATED, capturedRecords[0][17]);
+	CHECK_EQUAL_C_INT((AWS_IOT_DEFERRED_LOG_ARG_BYTES / 4) * 4, capturedRecords[0][18]);
+	CHECK_EQUAL_C_INT(1, readLe32(capturedRecords[0] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN));
+
+	aws_iot_deferred_log_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.truncated);
+
+	IOT_DEBUG("-->Success - truncated arguments \n");
+}
+
+TEST_C(DeferredLogTests, OverwriteKeepsNewest) {
+	IoT_Deferred_Log_Stats_t stats;
+	uint32_t i;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - overwrite keeps newest \n");
+
+	for(i = 0; i < AWS_IOT_DEFERRED_LOG_DEPTH + 3; i++) {
+		aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatInt, (int) i);
+	}
+
+	CHECK_EQUAL_C_INT(AWS_IOT_DEFERRED_LOG_DEPTH, drainAll(0));
+	for(i = 0; i < AWS_IOT_DEFERRED_LOG_DEPTH; i++) {
+		/* Sequence numbers show the gap to the decoder */
+		CHECK_EQUAL_C_INT(i + 3, readLe32(capturedRecords[i]));
+		CHECK_EQUAL_C_INT(i + 3, readLe32(capturedRecords[i] + AWS_IOT_DEFERRED_LOG_RECORD_HEADER_LEN));
+	}
+
+	aws_iot_deferred_log_get_stats(&stats);
+	CHECK_EQUAL_C_INT(AWS_IOT_DEFERRED_LOG_DEPTH + 3, stats.written);
+	CHECK_EQUAL_C_INT(AWS_IOT_DEFERRED_LOG_DEPTH, stats.drained);
+	CHECK_EQUAL_C_INT(3, stats.overwritten);
+
+	IOT_DEBUG("-->Success - overwrite keeps newest \n");
+}
+
+TEST_C(DeferredLogTests, LevelFilter) {
+	IOT_DEBUG("\n-->Running Deferred Log Tests - level filter \n");
+
+	aws_iot_deferred_log_set_level(IOT_DLOG_LEVEL_WARN);
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_INFO, testTag, formatInt, 1);
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_WARN, testTag, formatInt, 2);
+	CHECK_EQUAL_C_INT(1, drainAll(0));
+	CHECK_EQUAL_C_INT(IOT_DLOG_LEVEL_WARN, capturedRecords[0][16]);
+
+	/* The run time level cannot go above the compiled level */
+	aws_iot_deferred_log_set_level(IOT_DLOG_LEVEL_VERBOSE);
+	aws_iot_deferred_log_write(IOT_DLOG_LEVEL_VERBOSE, testTag, formatInt, 3);
+	IOT_DEFERRED_LOGV(testTag, "compiled out %d", 4);
+	IOT_DEFERRED_LOGD(testTag, "kept %d", 5);
+	CHECK_EQUAL_C_INT(1, drainAll(0));
+	CHECK_EQUAL_C_INT(IOT_DLOG_LEVEL_DEBUG, capturedRecords[1][16]);
+
+	IOT_DEBUG("-->Success - level filter \n");
+}
+
+TEST_C(DeferredLogTests, DrainLimitAndNullSink) {
+	uint32_t i;
+
+	IOT_DEBUG("\n-->Running Deferred Log Tests - drain limit and null sink \n");
+
+	for(i = 0; i < 5; i++) {
+		aws_iot_deferred_log_write(IOT_DLOG_LEVEL_ERROR, testTag, formatInt, (int) i);
+	}
+
+	CHECK_EQUAL_C_INT(0, aws_iot_deferred_log_drain(NULL, NULL, 0));
+	CHECK_EQUAL_C_INT(2, drainAll(2));
+	CHECK_EQUAL_C_INT(3, drainAll(0));
+	CHECK_EQUAL_C_INT(2, readLe32(capturedRecords[2]));
+
+	IOT_DEBUG("-->Success - drain limit and null sink \n");
+}
+
+#ifdef __cplusplus
+}
+#endif
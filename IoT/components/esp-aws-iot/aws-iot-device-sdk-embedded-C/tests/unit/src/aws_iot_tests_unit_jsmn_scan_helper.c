@@ -0,0 +1,193 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_jsmn_scan_helper.c
+ * @brief IoT Client Unit Testing - jsmn Scanner Tests helper
+ *
+ * Every scanner must produce exactly the tokens and errors of the scalar one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+#include <jsmn.h>
+#include <aws_iot_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCAN_TEST_MAX_TOKENS 64
+
+static const char *shadowDocuments[] = {
+	"{\"state\":{\"reported\":{\"timestampStatus\":\"2021-03-04 10:11:12\",\"clientidStatus\":\"0123C0FFEE456789EE\","
+	"\"cleaningStatus\":\"CLEANED\",\"temperature\":22.5,\"occupied\":false,\"sensors\":[1,2,3,null]}},"
+	"\"metadata\":{\"reported\":{\"timestampStatus\":{\"timestamp\":1614852672},\"clientidStatus\":{\"timestamp\":1614852672},"
+	"\"cleaningStatus\":{\"timestamp\":1614852672}}},\"version\":4711,\"timestamp\":1614852673,"
+	"\"clientToken\":\"0123C0FFEE456789EE-42\"}",
+	"{\n    \"state\": {\n        \"desired\": {\n            \"cleaningStatus\": \"DIRTY\"\n        },\n"
+	"        \"delta\": {\n            \"cleaningStatus\": \"DIRTY\"\n        }\n    },\n"
+	"    \"version\": 12,\n\t\"timestamp\": 1614852673\r\n}",
+	"{\"escaped\":\"quote \\\" backslash \\\\ slash \\/ unicode \\u00e9\\u20AC tab \\t end\",\"k\":\"\"}",
+	"[true,false,null,-1.5e10,0,\"x\",{},[],{\"a\":[{\"b\":{}}]}]",
+};
+
+static const char *invalidDocuments[] = {
+	"{\"bad escape\":\"\\x41\"}",
+	"{\"bad unicode\":\"\\u12G4\"}",
+	"{\"control\":bad\x01value}",
+	"{\"high\":bad\x80value}",
+	"{\"unterminated\":\"abcdefghijklmnopqrstuvwxyz0123456789",
+	"{\"open\":[1,2,3",
+	"{\"mismatch\":[1,2,3}",
+};
+
+static jsmnscan_t scanners[] = { JSMN_SCAN_SSE2, JSMN_SCAN_AVX2 };
+
+static int parseWith(jsmnscan_t scan, const char *pJson, size_t len, jsmntok_t *pTokens, unsigned int *pPos) {
+	jsmn_parser parser;
+	int rc;
+
+	jsmn_set_scan(scan);
+	jsmn_init(&parser);
+	memset(pTokens, 0xA5, sizeof(jsmntok_t) * SCAN_TEST_MAX_TOKENS);
+	rc = jsmn_parse(&parser, pJson, len, pTokens, SCAN_TEST_MAX_TOKENS);
+	*pPos = parser.pos;
+	return rc;
+}
+
+static void checkSameAsScalar(const char *pSource, size_t len) {
+	char *pJson;
+	jsmntok_t expected[SCAN_TEST_MAX_TOKENS];
+	jsmntok_t actual[SCAN_TEST_MAX_TOKENS];
+	unsigned int expectedPos;
+	unsigned int actualPos;
+	int expectedRc;
+	int actualRc;
+	size_t i;
+
+	/* Exactly len bytes without terminator, so reads past the end are caught by memory checkers */
+	pJson = (char *) malloc(len > 0 ? len : 1);
+	CHECK_C(NULL != pJson);
+	memcpy(pJson, pSource, len);
+
+	expectedRc = parseWith(JSMN_SCAN_SCALAR, pJson, len, expected, &expectedPos);
+	for(i = 0; i < sizeof(scanners) / sizeof(scanners[0]); i++) {
+		actualRc = parseWith(scanners[i], pJson, len, actual, &actualPos);
+		CHECK_EQUAL_C_INT(expectedRc, actualRc);
+		CHECK_EQUAL_C_INT(expectedPos, actualPos);
+		CHECK_C(0 == memcmp(expected, actual, sizeof(expected)));
+	}
+
+	free(pJson);
+}
+
+TEST_GROUP_C_SETUP(JsmnScanTests) {
+}
+
+TEST_GROUP_C_TEARDOWN(JsmnScanTests) {
+	jsmn_set_scan(JSMN_SCAN_AUTO);
+}
+
+TEST_C(JsmnScanTests, ScannersAgreeOnShadowDocuments) {
+	jsmntok_t tokens[SCAN_TEST_MAX_TOKENS];
+	unsigned int pos;
+	size_t i;
+
+	IOT_DEBUG("\n-->Running jsmn Scanner Tests - scanners agree on shadow documents \n");
+
+	for(i = 0; i < sizeof(shadowDocuments) / sizeof(shadowDocuments[0]); i++) {
+		CHECK_C(parseWith(JSMN_SCAN_SCALAR, shadowDocuments[i], strlen(shadowDocuments[i]), tokens, &pos) > 0);
+		checkSameAsScalar(shadowDocuments[i], strlen(shadowDocuments[i]));
+	}
+
+	IOT_DEBUG("-->Success - scanners agree on shadow documents \n");
+}
+
+TEST_C(JsmnScanTests, ScannersAgreeOnBlockBoundaries) {
+	char json[160];
+	size_t padding;
+	size_t split;
+
+	IOT_DEBUG("\n-->Running jsmn Scanner Tests - scanners agree on block boundaries \n");
+
+	/* Move the interesting bytes across every position of a 16 and 32 byte block */
+	for(padding = 0; padding < 40; padding++) {
+		snprintf(json, sizeof(json), "{\"%.*s\":\"%.*s\\\"x\",%*s\"n\":%.*s1}", (int) padding,
+				 "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", (int) (40 - padding),
+				 "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb", (int) padding, "", (int) padding,
+				 "1234567890123456789012345678901234567890");
+		checkSameAsScalar(json, strlen(json));
+
+		/* Cut the document short everywhere */
+		for(split = 0; split < strlen(json); split++) {
+			checkSameAsScalar(json, split);
+		}
+	}
+
+	IOT_DEBUG("-->Success - scanners agree on block boundaries \n");
+}
+
+TEST_C(JsmnScanTests, ScannersAgreeOnErrors) {
+	jsmntok_t tokens[SCAN_TEST_MAX_TOKENS];
+	unsigned int pos;
+	size_t i;
+
+	IOT_DEBUG("\n-->Running jsmn Scanner Tests - scanners agree on errors \n");
+
+	for(i = 0; i < sizeof(invalidDocuments) / sizeof(invalidDocuments[0]); i++) {
+		CHECK_C(parseWith(JSMN_SCAN_SCALAR, invalidDocuments[i], strlen(invalidDocuments[i]), tokens, &pos) < 0);
+		checkSameAsScalar(invalidDocuments[i], strlen(invalidDocuments[i]));
+	}
+
+	IOT_DEBUG("-->Success - scanners agree on errors \n");
+}
+
+TEST_C(JsmnScanTests, ScannersStopAtLength) {
+	/* The bytes after len, including the NUL inside the buffer, must never be looked at */
+	static const char json[] = "{\"key\":\"value\"}                                \0{\"after\":\"nul\"}";
+	jsmntok_t tokens[SCAN_TEST_MAX_TOKENS];
+	unsigned int pos;
+
+	IOT_DEBUG("\n-->Running jsmn Scanner Tests - scanners stop at length \n");
+
+	checkSameAsScalar(json, sizeof(json) - 1);
+	checkSameAsScalar(json, 5);
+	checkSameAsScalar(json, 15);
+	CHECK_EQUAL_C_INT(3, parseWith(JSMN_SCAN_AUTO, json, sizeof(json) - 1, tokens, &pos));
+	CHECK_EQUAL_C_INT(strlen(json), pos);
+
+	IOT_DEBUG("-->Success - scanners stop at length \n");
+}
+
+TEST_C(JsmnScanTests, UnsupportedScannerFallsBack) {
+	jsmnscan_t best;
+
+	IOT_DEBUG("\n-->Running jsmn Scanner Tests - unsupported scanner falls back \n");
+
+	best = jsmn_set_scan(JSMN_SCAN_AUTO);
+	CHECK_C(best >= JSMN_SCAN_SCALAR && best <= JSMN_SCAN_AVX2);
+	CHECK_EQUAL_C_INT(JSMN_SCAN_SCALAR, jsmn_set_scan(JSMN_SCAN_SCALAR));
+	/* AVX2 is used when supported, otherwise the best scanner available */
+	CHECK_C(jsmn_set_scan(JSMN_SCAN_AVX2) >= best);
+
+	IOT_DEBUG("-->Success - unsupported scanner falls back \n");
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_latency_trace.cpp
+ * @brief IoT Client Unit Testing - Latency Trace Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(LatencyTraceTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(LatencyTraceTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(LatencyTraceTests)
+};
+
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, RecordAndSnapshotInOrder)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, RingKeepsNewestEvents)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, SnapshotNullOrEmptyDestination)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, SerializeLayout)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, SerializeTruncatesToNewest)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, SerializeBufferTooSmall)
+TEST_GROUP_C_WRAPPER(LatencyTraceTests, EventNames)
@@ -0,0 +1,184 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_latency_trace_helper.c
+ * @brief IoT Client Unit Testing - Latency Trace Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+#include <aws_iot_latency_trace.h>
+#include <aws_iot_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static uint32_t readLe32(const unsigned char *pBuf) {
+	return (uint32_t) pBuf[0] | ((uint32_t) pBuf[1] << 8) | ((uint32_t) pBuf[2] << 16) | ((uint32_t) pBuf[3] << 24);
+}
+
+static uint16_t readLe16(const unsigned char *pBuf) {
+	return (uint16_t) (pBuf[0] | (pBuf[1] << 8));
+}
+
+TEST_GROUP_C_SETUP(LatencyTraceTests) {
+	aws_iot_latency_trace_reset();
+}
+
+TEST_GROUP_C_TEARDOWN(LatencyTraceTests) {
+	aws_iot_latency_trace_reset();
+}
+
+TEST_C(LatencyTraceTests, RecordAndSnapshotInOrder) {
+	IoT_Latency_Trace_Entry_t entries[AWS_IOT_LATENCY_TRACE_DEPTH];
+	uint32_t count;
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - record and snapshot in order \n");
+
+	aws_iot_latency_trace_record(IOT_TRACE_UI_INPUT, 0);
+	aws_iot_latency_trace_record(IOT_TRACE_MQTT_SEND_START, 42);
+	aws_iot_latency_trace_record(IOT_TRACE_MQTT_SEND_DONE, 100000);
+
+	count = aws_iot_latency_trace_snapshot(entries, AWS_IOT_LATENCY_TRACE_DEPTH);
+	CHECK_EQUAL_C_INT(3, count);
+	CHECK_EQUAL_C_INT(IOT_TRACE_UI_INPUT, entries[0].event);
+	CHECK_EQUAL_C_INT(IOT_TRACE_MQTT_SEND_START, entries[1].event);
+	CHECK_EQUAL_C_INT(42, entries[1].arg);
+	CHECK_EQUAL_C_INT(IOT_TRACE_MQTT_SEND_DONE, entries[2].event);
+	/* Arguments wider than 16 bits saturate */
+	CHECK_EQUAL_C_INT(UINT16_MAX, entries[2].arg);
+	CHECK_C((uint32_t) (entries[2].timestampUs - entries[0].timestampUs) < 1000000);
+
+	IOT_DEBUG("-->Success - record and snapshot in order \n");
+}
+
+TEST_C(LatencyTraceTests, RingKeepsNewestEvents) {
+	IoT_Latency_Trace_Entry_t entries[AWS_IOT_LATENCY_TRACE_DEPTH];
+	uint32_t count;
+	uint32_t i;
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - ring keeps newest events \n");
+
+	for(i = 0; i < AWS_IOT_LATENCY_TRACE_DEPTH + 5; i++) {
+		aws_iot_latency_trace_record(IOT_TRACE_TLS_READ_DONE, i);
+	}
+
+	count = aws_iot_latency_trace_snapshot(entries, AWS_IOT_LATENCY_TRACE_DEPTH);
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_DEPTH, count);
+	for(i = 0; i < count; i++) {
+		CHECK_EQUAL_C_INT(i + 5, entries[i].arg);
+	}
+
+	/* A smaller destination gets the newest events */
+	count = aws_iot_latency_trace_snapshot(entries, 2);
+	CHECK_EQUAL_C_INT(2, count);
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_DEPTH + 3, entries[0].arg);
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_DEPTH + 4, entries[1].arg);
+
+	IOT_DEBUG("-->Success - ring keeps newest events \n");
+}
+
+TEST_C(LatencyTraceTests, SnapshotNullOrEmptyDestination) {
+	IoT_Latency_Trace_Entry_t entry;
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - snapshot with null or empty destination \n");
+
+	aws_iot_latency_trace_record(IOT_TRACE_UI_INPUT, 0);
+	CHECK_EQUAL_C_INT(0, aws_iot_latency_trace_snapshot(NULL, 1));
+	CHECK_EQUAL_C_INT(0, aws_iot_latency_trace_snapshot(&entry, 0));
+
+	aws_iot_latency_trace_reset();
+	CHECK_EQUAL_C_INT(0, aws_iot_latency_trace_snapshot(&entry, 1));
+
+	IOT_DEBUG("-->Success - snapshot with null or empty destination \n");
+}
+
+TEST_C(LatencyTraceTests, SerializeLayout) {
+	unsigned char blob[AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN + 2 * AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN];
+	IoT_Latency_Trace_Entry_t entries[2];
+	size_t len;
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - serialize layout \n");
+
+	aws_iot_latency_trace_record(IOT_TRACE_SHADOW_ACTION, 1);
+	aws_iot_latency_trace_record(IOT_TRACE_SHADOW_ACK_RECEIVED, 7);
+	aws_iot_latency_trace_snapshot(entries, 2);
+
+	len = aws_iot_latency_trace_serialize(blob, sizeof(blob));
+	CHECK_EQUAL_C_INT(sizeof(blob), len);
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_BLOB_MAGIC, readLe16(blob));
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_BLOB_VERSION, blob[2]);
+	CHECK_EQUAL_C_INT(2, readLe32(blob + 4));
+
+	CHECK_EQUAL_C_INT(entries[0].timestampUs, readLe32(blob + 8));
+	CHECK_EQUAL_C_INT(IOT_TRACE_SHADOW_ACTION, readLe16(blob + 12));
+	CHECK_EQUAL_C_INT(1, readLe16(blob + 14));
+	CHECK_EQUAL_C_INT(entries[1].timestampUs, readLe32(blob + 16));
+	CHECK_EQUAL_C_INT(IOT_TRACE_SHADOW_ACK_RECEIVED, readLe16(blob + 20));
+	CHECK_EQUAL_C_INT(7, readLe16(blob + 22));
+
+	IOT_DEBUG("-->Success - serialize layout \n");
+}
+
+TEST_C(LatencyTraceTests, SerializeTruncatesToNewest) {
+	unsigned char blob[AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN + AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN + 3];
+	size_t len;
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - serialize truncates to newest \n");
+
+	aws_iot_latency_trace_record(IOT_TRACE_TLS_WRITE_START, 10);
+	aws_iot_latency_trace_record(IOT_TRACE_TLS_WRITE_DONE, 20);
+
+	len = aws_iot_latency_trace_serialize(blob, sizeof(blob));
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN + AWS_IOT_LATENCY_TRACE_BLOB_ENTRY_LEN, len);
+	CHECK_EQUAL_C_INT(1, readLe32(blob + 4));
+	CHECK_EQUAL_C_INT(IOT_TRACE_TLS_WRITE_DONE, readLe16(blob + 12));
+	CHECK_EQUAL_C_INT(20, readLe16(blob + 14));
+
+	IOT_DEBUG("-->Success - serialize truncates to newest \n");
+}
+
+TEST_C(LatencyTraceTests, SerializeBufferTooSmall) {
+	unsigned char blob[AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN];
+
+	IOT_DEBUG("\n-->Running Latency Trace Tests - serialize buffer too small \n");
+
+	aws_iot_latency_trace_record(IOT_TRACE_UI_INPUT, 0);
+	CHECK_EQUAL_C_INT(0, aws_iot_latency_trace_serialize(NULL, sizeof(blob)));
+	CHECK_EQUAL_C_INT(0, aws_iot_latency_trace_serialize(blob, AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN - 1));
+
+	/* Header only is still a valid, empty blob */
+	CHECK_EQUAL_C_INT(AWS_IOT_LATENCY_TRACE_BLOB_HEADER_LEN, aws_iot_latency_trace_serialize(blob, sizeof(blob)));
+	CHECK_EQUAL_C_INT(0, readLe32(blob + 4));
+
+	IOT_DEBUG("-->Success - serialize buffer too small \n");
+}
+
+TEST_C(LatencyTraceTests, EventNames) {
+	IOT_DEBUG("\n-->Running Latency Trace Tests - event names \n");
+
+	CHECK_EQUAL_C_STRING("ui_input", aws_iot_latency_trace_event_name(IOT_TRACE_UI_INPUT));
+	CHECK_EQUAL_C_STRING("app_ui_updated", aws_iot_latency_trace_event_name(IOT_TRACE_APP_UI_UPDATED));
+	CHECK_EQUAL_C_STRING("unknown", aws_iot_latency_trace_event_name(IOT_TRACE_EVENT_COUNT));
+
+	IOT_DEBUG("-->Success - event names \n");
+}
+
+#ifdef __cplusplus
+}
+#endif
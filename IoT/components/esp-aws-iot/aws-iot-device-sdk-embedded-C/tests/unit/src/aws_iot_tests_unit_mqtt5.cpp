@@ -0,0 +1,56 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_mqtt5.cpp
+ * @brief IoT Client Unit Testing - MQTT 5 Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(MQTT5Tests) {
+	TEST_GROUP_C_SETUP_WRAPPER(MQTT5Tests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(MQTT5Tests)
+};
+
+/* CONNECT carries protocol level 5 and the client properties */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ConnectPacketHasVersion5AndProperties)
+/* CONNACK properties are applied to the client */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ConnackPropertiesApplied)
+/* CONNACK reason codes map to the MQTT_CONNACK_* errors */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ConnackReasonCodeMapped)
+/* A 3.1.1 server refusing the protocol level is reported as such */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ConnackFromVersion3ServerRefused)
+/* Second publish to a topic sends the alias only */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, RepeatedPublishUsesAlias)
+/* No alias when the server does not announce a Topic Alias Maximum */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, NoAliasWhenServerDisallows)
+/* The least recently used alias is reassigned */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, LeastRecentlyUsedAliasReplaced)
+/* An alias is not assumed known if its PUBLISH could not be sent */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, FailedSendDoesNotCommitAlias)
+/* Failure reason code in PUBACK */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, PubackFailureReasonCode)
+/* Publish larger than the server Maximum Packet Size */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, PublishExceedingMaxPacketSize)
+/* SUBSCRIBE carries properties, a refused SUBACK is an error */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, SubscribeWithReasonCodes)
+/* Incoming PUBLISH with properties reaches the handler */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, IncomingPublishWithProperties)
+/* DISCONNECT from the server closes the connection */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ServerDisconnect)
+/* Aliases do not survive a reconnect */
+TEST_GROUP_C_WRAPPER(MQTT5Tests, ReconnectResetsAliases)
@@ -0,0 +1,388 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_mqtt5_helper.c
+ * @brief IoT Client Unit Testing - MQTT 5 Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_log.h"
+
+static IoT_Client_Init_Params initParams;
+static IoT_Client_Connect_Params connectParams;
+static IoT_Publish_Message_Params pubParams;
+static AWS_IoT_Client iotClient;
+
+static char subTopic[10] = "sdk/Test";
+static uint16_t subTopicLen = 8;
+static char receivedPayload[32];
+static size_t receivedPayloadLen;
+
+/* CONNACK with Topic Alias Maximum 5, more than the client keeps */
+static const unsigned char connackWithAliases[] = { 0x20, 0x06, 0x00, 0x00, 0x03, 0x22, 0x00, 0x05 };
+static const unsigned char connackNoProperties[] = { 0x20, 0x03, 0x00, 0x00, 0x00 };
+
+static void setRxPacket(const unsigned char *pPacket, size_t len) {
+	memcpy(RxBuffer.pBuffer, pPacket, len);
+	RxBuffer.len = len;
+	RxBuffer.NoMsgFlag = false;
+	RxIndex = 0;
+}
+
+static IoT_Error_t connectV5(const unsigned char *pConnack, size_t connackLen) {
+	ResetTLSBuffer();
+	setRxPacket(pConnack, connackLen);
+	return aws_iot_mqtt_connect(&iotClient, &connectParams);
+}
+
+/* Offset of the first byte after the fixed header */
+static size_t txVariableHeaderStart(void) {
+	size_t i = 1;
+
+	while(TxBuffer.pBuffer[i] & 0x80) {
+		i++;
+	}
+
+	return i + 1;
+}
+
+/* Checks the topic and the property block of the last QoS 0 PUBLISH sent */
+static void checkPublishTopicAndAlias(const char *pTopic, uint16_t alias) {
+	size_t pos = txVariableHeaderStart();
+	size_t topicLen = (size_t) ((TxBuffer.pBuffer[pos] << 8) | TxBuffer.pBuffer[pos + 1]);
+
+	CHECK_EQUAL_C_INT(0x30, TxBuffer.pBuffer[0]);
+	CHECK_EQUAL_C_INT(strlen(pTopic), topicLen);
+	CHECK_C(0 == memcmp(&TxBuffer.pBuffer[pos + 2], pTopic, topicLen));
+	pos += 2 + topicLen;
+
+	if(0 == alias) {
+		CHECK_EQUAL_C_INT(0, TxBuffer.pBuffer[pos]);
+	} else {
+		CHECK_EQUAL_C_INT(3, TxBuffer.pBuffer[pos]);
+		CHECK_EQUAL_C_INT(0x23, TxBuffer.pBuffer[pos + 1]);
+		CHECK_EQUAL_C_INT(alias, (TxBuffer.pBuffer[pos + 2] << 8) | TxBuffer.pBuffer[pos + 3]);
+	}
+}
+
+static IoT_Error_t publishQoS0(const char *pTopic) {
+	pubParams.qos = QOS0;
+	return aws_iot_mqtt_publish(&iotClient, pTopic, (uint16_t) strlen(pTopic), &pubParams);
+}
+
+static void mqtt5MessageHandler(AWS_IoT_Client *pClient, char *pTopicName, uint16_t topicNameLen,
+								IoT_Publish_Message_Params *pParams, void *pClientData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(pTopicName);
+	IOT_UNUSED(topicNameLen);
+	IOT_UNUSED(pClientData);
+
+	receivedPayloadLen = pParams->payloadLen < sizeof(receivedPayload) ? pParams->payloadLen : sizeof(receivedPayload);
+	memcpy(receivedPayload, pParams->payload, receivedPayloadLen);
+}
+
+TEST_GROUP_C_SETUP(MQTT5Tests) {
+	IoT_Error_t rc;
+
+	ResetTLSBuffer();
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	initParams.mqttCommandTimeout_ms = 2000;
+	rc = aws_iot_mqtt_init(&iotClient, &initParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	connectParams.MQTTVersion = MQTT_5;
+
+	pubParams.qos = QOS0;
+	pubParams.isRetained = 0;
+	pubParams.payload = (void *) "hello";
+	pubParams.payloadLen = 5;
+
+	receivedPayloadLen = 0;
+}
+
+TEST_GROUP_C_TEARDOWN(MQTT5Tests) {
+	ResetTLSBuffer();
+}
+
+TEST_C(MQTT5Tests, ConnectPacketHasVersion5AndProperties) {
+	size_t pos;
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - CONNECT packet \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+
+	pos = txVariableHeaderStart();
+	CHECK_EQUAL_C_INT(0x10, TxBuffer.pBuffer[0]);
+	CHECK_C(0 == memcmp(&TxBuffer.pBuffer[pos], "\x00\x04MQTT\x05", 7));
+	pos += 7 + 1 + 2; /* flags, keep alive */
+
+	/* Properties: Maximum Packet Size, no Session Expiry on a clean session */
+	CHECK_EQUAL_C_INT(5, TxBuffer.pBuffer[pos]);
+	CHECK_EQUAL_C_INT(0x27, TxBuffer.pBuffer[pos + 1]);
+	CHECK_EQUAL_C_INT(AWS_IOT_MQTT_RX_BUF_LEN, (TxBuffer.pBuffer[pos + 2] << 24) | (TxBuffer.pBuffer[pos + 3] << 16) |
+											   (TxBuffer.pBuffer[pos + 4] << 8) | TxBuffer.pBuffer[pos + 5]);
+	pos += 6;
+
+	CHECK_EQUAL_C_INT(strlen(AWS_IOT_MQTT_CLIENT_ID), (TxBuffer.pBuffer[pos] << 8) | TxBuffer.pBuffer[pos + 1]);
+	CHECK_C(0 == memcmp(&TxBuffer.pBuffer[pos + 2], AWS_IOT_MQTT_CLIENT_ID, strlen(AWS_IOT_MQTT_CLIENT_ID)));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - CONNECT packet \n");
+}
+
+TEST_C(MQTT5Tests, ConnackPropertiesApplied) {
+	const unsigned char connack[] = { 0x20, 0x0E, 0x01, 0x00, 0x0B,
+									  0x22, 0x00, 0x02,
+									  0x27, 0x00, 0x00, 0x01, 0x00,
+									  0x13, 0x00, 0x1E };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - CONNACK properties \n");
+
+	connectParams.isCleanSession = false;
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connack, sizeof(connack)));
+	CHECK_EQUAL_C_INT(2, iotClient.clientData.topicAliasMax);
+	CHECK_EQUAL_C_INT(256, iotClient.clientData.maxPacketSize);
+	CHECK_EQUAL_C_INT(30, iotClient.clientData.keepAliveInterval);
+	CHECK_EQUAL_C_INT(0, aws_iot_mqtt_get_last_reason_code(&iotClient));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - CONNACK properties \n");
+}
+
+TEST_C(MQTT5Tests, ConnackReasonCodeMapped) {
+	unsigned char connack[] = { 0x20, 0x03, 0x00, 0x87, 0x00 };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - CONNACK reason codes \n");
+
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_NOT_AUTHORIZED_ERROR, connectV5(connack, sizeof(connack)));
+	CHECK_EQUAL_C_INT(0x87, aws_iot_mqtt_get_last_reason_code(&iotClient));
+	CHECK_EQUAL_C_INT(false, aws_iot_mqtt_is_client_connected(&iotClient));
+
+	connack[3] = 0x84;
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR, connectV5(connack, sizeof(connack)));
+
+	connack[3] = 0x89;
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_SERVER_UNAVAILABLE_ERROR, connectV5(connack, sizeof(connack)));
+
+	connack[3] = 0x8C;
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_BAD_USERDATA_ERROR, connectV5(connack, sizeof(connack)));
+
+	connack[3] = 0x95;
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_UNKNOWN_ERROR, connectV5(connack, sizeof(connack)));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - CONNACK reason codes \n");
+}
+
+TEST_C(MQTT5Tests, ConnackFromVersion3ServerRefused) {
+	const unsigned char connack[] = { 0x20, 0x02, 0x00, 0x01 };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - CONNACK from a 3.1.1 server \n");
+
+	CHECK_EQUAL_C_INT(MQTT_CONNACK_UNACCEPTABLE_PROTOCOL_VERSION_ERROR, connectV5(connack, sizeof(connack)));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - CONNACK from a 3.1.1 server \n");
+}
+
+TEST_C(MQTT5Tests, RepeatedPublishUsesAlias) {
+	IOT_DEBUG("-->Running MQTT 5 Tests - repeated publish uses alias \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackWithAliases, sizeof(connackWithAliases)));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 1);
+	CHECK_C(0 == memcmp(&TxBuffer.pBuffer[TxBuffer.len - 5], "hello", 5));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("", 1);
+	CHECK_EQUAL_C_INT(2 + 2 + 4 + 5, TxBuffer.len);
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - repeated publish uses alias \n");
+}
+
+TEST_C(MQTT5Tests, NoAliasWhenServerDisallows) {
+	IOT_DEBUG("-->Running MQTT 5 Tests - no alias without Topic Alias Maximum \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 0);
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 0);
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - no alias without Topic Alias Maximum \n");
+}
+
+TEST_C(MQTT5Tests, LeastRecentlyUsedAliasReplaced) {
+	IOT_DEBUG("-->Running MQTT 5 Tests - least recently used alias replaced \n");
+
+	/* The server allows 5, the client keeps AWS_IOT_MQTT5_TOPIC_ALIASES (2) */
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackWithAliases, sizeof(connackWithAliases)));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 1);
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/b"));
+	checkPublishTopicAndAlias("sdk/b", 2);
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("", 1);
+
+	/* sdk/b is the least recently used */
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/c"));
+	checkPublishTopicAndAlias("sdk/c", 2);
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/b"));
+	checkPublishTopicAndAlias("sdk/b", 1);
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/c"));
+	checkPublishTopicAndAlias("", 2);
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - least recently used alias replaced \n");
+}
+
+TEST_C(MQTT5Tests, FailedSendDoesNotCommitAlias) {
+	IOT_DEBUG("-->Running MQTT 5 Tests - failed send does not commit alias \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackWithAliases, sizeof(connackWithAliases)));
+
+	setTLSTxBufferForError(NETWORK_SSL_WRITE_ERROR);
+	CHECK_EQUAL_C_INT(NETWORK_SSL_WRITE_ERROR, publishQoS0("sdk/a"));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 1);
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - failed send does not commit alias \n");
+}
+
+TEST_C(MQTT5Tests, PubackFailureReasonCode) {
+	const unsigned char pubackRefused[] = { 0x40, 0x04, 0x00, 0x01, 0x87, 0x00 };
+	const unsigned char pubackNoSubscribers[] = { 0x40, 0x03, 0x00, 0x02, 0x10 };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - PUBACK reason codes \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+	pubParams.qos = QOS1;
+
+	setRxPacket(pubackRefused, sizeof(pubackRefused));
+	CHECK_EQUAL_C_INT(MQTT_REASON_CODE_ERROR, aws_iot_mqtt_publish(&iotClient, "sdk/a", 5, &pubParams));
+	CHECK_EQUAL_C_INT(0x87, aws_iot_mqtt_get_last_reason_code(&iotClient));
+
+	setRxPacket(pubackNoSubscribers, sizeof(pubackNoSubscribers));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_publish(&iotClient, "sdk/a", 5, &pubParams));
+	CHECK_EQUAL_C_INT(0x10, aws_iot_mqtt_get_last_reason_code(&iotClient));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - PUBACK reason codes \n");
+}
+
+TEST_C(MQTT5Tests, PublishExceedingMaxPacketSize) {
+	const unsigned char connack[] = { 0x20, 0x08, 0x00, 0x00, 0x05, 0x27, 0x00, 0x00, 0x00, 0x10 };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - Maximum Packet Size \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connack, sizeof(connack)));
+	TxBuffer.len = 0;
+
+	pubParams.payload = (void *) "a payload that does not fit";
+	pubParams.payloadLen = strlen((const char *) pubParams.payload);
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, publishQoS0("sdk/a"));
+	CHECK_EQUAL_C_INT(0, TxBuffer.len);
+
+	pubParams.payloadLen = 2;
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - Maximum Packet Size \n");
+}
+
+TEST_C(MQTT5Tests, SubscribeWithReasonCodes) {
+	const unsigned char subackGranted[] = { 0x90, 0x04, 0x00, 0x01, 0x00, 0x01 };
+	const unsigned char subackRefused[] = { 0x90, 0x04, 0x00, 0x02, 0x00, 0x87 };
+	size_t pos;
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - SUBSCRIBE and SUBACK \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+
+	setRxPacket(subackGranted, sizeof(subackGranted));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_subscribe(&iotClient, subTopic, subTopicLen, QOS1,
+													  mqtt5MessageHandler, NULL));
+	pos = txVariableHeaderStart();
+	CHECK_EQUAL_C_INT(0x82, TxBuffer.pBuffer[0]);
+	CHECK_EQUAL_C_INT(0, TxBuffer.pBuffer[pos + 2]); /* properties after the packet id */
+	CHECK_EQUAL_C_INT(subTopicLen, (TxBuffer.pBuffer[pos + 3] << 8) | TxBuffer.pBuffer[pos + 4]);
+	CHECK_EQUAL_C_INT(QOS1, TxBuffer.pBuffer[pos + 5 + subTopicLen]);
+
+	setRxPacket(subackRefused, sizeof(subackRefused));
+	CHECK_EQUAL_C_INT(MQTT_REASON_CODE_ERROR, aws_iot_mqtt_subscribe(&iotClient, "sdk/other", 9, QOS1,
+																	 mqtt5MessageHandler, NULL));
+	CHECK_EQUAL_C_INT(0x87, aws_iot_mqtt_get_last_reason_code(&iotClient));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - SUBSCRIBE and SUBACK \n");
+}
+
+TEST_C(MQTT5Tests, IncomingPublishWithProperties) {
+	const unsigned char subackGranted[] = { 0x90, 0x04, 0x00, 0x01, 0x00, 0x00 };
+	/* QoS 0 PUBLISH with Payload Format Indicator and Message Expiry Interval properties */
+	const unsigned char publish[] = { 0x30, 0x15, 0x00, 0x08, 's', 'd', 'k', '/', 'T', 'e', 's', 't',
+									  0x07, 0x01, 0x01, 0x02, 0x00, 0x00, 0x00, 0x3C, 'h', 'i', '!' };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - incoming PUBLISH with properties \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+	setRxPacket(subackGranted, sizeof(subackGranted));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_subscribe(&iotClient, subTopic, subTopicLen, QOS0,
+													  mqtt5MessageHandler, NULL));
+
+	setRxPacket(publish, sizeof(publish));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_yield(&iotClient, 100));
+	CHECK_EQUAL_C_INT(3, receivedPayloadLen);
+	CHECK_C(0 == memcmp(receivedPayload, "hi!", 3));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - incoming PUBLISH with properties \n");
+}
+
+TEST_C(MQTT5Tests, ServerDisconnect) {
+	const unsigned char disconnect[] = { 0xE0, 0x02, 0x8B, 0x00 };
+
+	IOT_DEBUG("-->Running MQTT 5 Tests - DISCONNECT from the server \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackNoProperties, sizeof(connackNoProperties)));
+
+	setRxPacket(disconnect, sizeof(disconnect));
+	CHECK_EQUAL_C_INT(NETWORK_DISCONNECTED_ERROR, aws_iot_mqtt_yield(&iotClient, 100));
+	CHECK_EQUAL_C_INT(0x8B, aws_iot_mqtt_get_last_reason_code(&iotClient));
+	CHECK_EQUAL_C_INT(false, aws_iot_mqtt_is_client_connected(&iotClient));
+	CHECK_EQUAL_C_INT(1, aws_iot_mqtt_get_network_disconnected_count(&iotClient));
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - DISCONNECT from the server \n");
+}
+
+TEST_C(MQTT5Tests, ReconnectResetsAliases) {
+	IOT_DEBUG("-->Running MQTT 5 Tests - reconnect resets aliases \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackWithAliases, sizeof(connackWithAliases)));
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("", 1);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_disconnect(&iotClient));
+	CHECK_EQUAL_C_INT(SUCCESS, connectV5(connackWithAliases, sizeof(connackWithAliases)));
+
+	CHECK_EQUAL_C_INT(SUCCESS, publishQoS0("sdk/a"));
+	checkPublishTopicAndAlias("sdk/a", 1);
+
+	IOT_DEBUG("-->Success - MQTT 5 Tests - reconnect resets aliases \n");
+}
@@ -0,0 +1,56 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_shadow_mirror.cpp
+ * @brief IoT Client Unit Testing - Shadow Mirror Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(ShadowMirrorTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(ShadowMirrorTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(ShadowMirrorTests)
+};
+
+/* get/accepted seeds both sections with typed values */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, SeedFromGetAccepted)
+/* The mirror asks for a get until it has been seeded */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, NeedsResyncUntilSeeded)
+/* update/accepted only notifies the fields that changed */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, UpdateNotifiesChangedFieldsOnly)
+/* Documents older than the mirror are ignored */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, OlderDocumentIgnored)
+/* Delta fields land in the desired section */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, DeltaMergedIntoDesired)
+/* null removes a field and everything nested under it */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, NullRemovesField)
+/* A skipped version asks for a resync, the next get clears it */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, VersionGapRequestsResync)
+/* Seeding again removes fields the full document no longer has */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, ReseedRemovesMissingFields)
+/* Callbacks only see their own section and key */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, CallbackFilteredByKey)
+/* The first seed is not reported to the callbacks, a reseed is */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, FirstSeedNotNotified)
+/* get/rejected with 404 seeds an empty mirror, other codes do not */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, NotFoundSeedsEmpty)
+/* Fields beyond the table size are dropped and counted */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, FullTableDropsFields)
+/* Typed lookups check the stored type and the buffer size */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, TypedLookupErrors)
+/* Documents without a version are rejected */
+TEST_GROUP_C_WRAPPER(ShadowMirrorTests, DocumentWithoutVersionRejected)
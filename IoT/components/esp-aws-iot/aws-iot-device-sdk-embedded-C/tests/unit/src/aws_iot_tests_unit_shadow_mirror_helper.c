@@ -0,0 +1,426 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_shadow_mirror_helper.c
+ * @brief IoT Client Unit Testing - Shadow Mirror Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+#include <aws_iot_shadow_mirror.h>
+#include <aws_iot_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_RECORDED_CHANGES 16
+
+typedef struct {
+	ShadowMirrorSection_t section;
+	char key[AWS_IOT_SHADOW_MIRROR_KEY_LEN];
+	char value[AWS_IOT_SHADOW_MIRROR_VALUE_LEN];
+	bool removed;
+} RecordedChange_t;
+
+static RecordedChange_t changes[MAX_RECORDED_CHANGES];
+static uint8_t changeCount;
+
+static const char seedDocument[] = "{\"state\":{\"desired\":{\"cleaningStatus\":\"DIRTY\",\"target\":21.5},"
+	"\"reported\":{\"cleaningStatus\":\"CLEANED\",\"humidity\":42,\"occupied\":true,"
+	"\"sensors\":{\"co2\":512,\"door\":\"closed\"},\"schedule\":[\"08:00\",\"12:00\"]},"
+	"\"delta\":{\"cleaningStatus\":\"DIRTY\"}},"
+	"\"metadata\":{\"reported\":{\"humidity\":{\"timestamp\":1614852672}}},"
+	"\"version\":10,\"timestamp\":1614852680}";
+
+static void recordChange(ShadowMirrorSection_t section, const char *pKey, const char *pValue,
+						 ShadowMirrorValueType_t type, void *pContext) {
+	IOT_UNUSED(type);
+	IOT_UNUSED(pContext);
+
+	if(changeCount < MAX_RECORDED_CHANGES) {
+		changes[changeCount].section = section;
+		snprintf(changes[changeCount].key, sizeof(changes[changeCount].key), "%s", pKey);
+		snprintf(changes[changeCount].value, sizeof(changes[changeCount].value), "%s", pValue ? pValue : "");
+		changes[changeCount].removed = (NULL == pValue);
+	}
+	changeCount++;
+}
+
+static IoT_Error_t applyDocument(ShadowMirrorDocument_t docType, const char *pJson) {
+	return aws_iot_shadow_mirror_apply(docType, pJson, strlen(pJson));
+}
+
+static bool hasString(ShadowMirrorSection_t section, const char *pKey, const char *pExpected) {
+	char buf[AWS_IOT_SHADOW_MIRROR_VALUE_LEN];
+
+	return SUCCESS == aws_iot_shadow_mirror_get_string(section, pKey, buf, sizeof(buf)) &&
+		   0 == strcmp(buf, pExpected);
+}
+
+TEST_GROUP_C_SETUP(ShadowMirrorTests) {
+	aws_iot_shadow_mirror_reset();
+	memset(changes, 0, sizeof(changes));
+	changeCount = 0;
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowMirrorTests) {
+	aws_iot_shadow_mirror_reset();
+}
+
+TEST_C(ShadowMirrorTests, SeedFromGetAccepted) {
+	ShadowMirrorValueType_t type;
+	int32_t humidity = 0;
+	float target = 0;
+	bool occupied = false;
+	const char *pRaw;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - seed from get/accepted \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(10, aws_iot_shadow_mirror_get_version());
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+	CHECK_C(hasString(SHADOW_MIRROR_DESIRED, "cleaningStatus", "DIRTY"));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "sensors.door", "closed"));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "humidity", &humidity));
+	CHECK_EQUAL_C_INT(42, humidity);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "sensors.co2", &humidity));
+	CHECK_EQUAL_C_INT(512, humidity);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_float(SHADOW_MIRROR_DESIRED, "target", &target));
+	CHECK_C(target > 21.4f && target < 21.6f);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_bool(SHADOW_MIRROR_REPORTED, "occupied", &occupied));
+	CHECK_C(occupied);
+
+	pRaw = aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "schedule", &type);
+	CHECK_C(NULL != pRaw);
+	CHECK_EQUAL_C_INT(SHADOW_MIRROR_TYPE_ARRAY, type);
+	CHECK_EQUAL_C_STRING("[\"08:00\",\"12:00\"]", pRaw);
+
+	/* Neither metadata nor the delta section of a get are mirrored */
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "humidity.timestamp", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "sensors", NULL));
+
+	IOT_DEBUG("-->Success - seed from get/accepted \n");
+}
+
+TEST_C(ShadowMirrorTests, NeedsResyncUntilSeeded) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - needs resync until seeded \n");
+
+	CHECK_C(aws_iot_shadow_mirror_needs_resync());
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+											 "{\"state\":{\"reported\":{\"humidity\":40}},\"version\":3}"));
+	CHECK_C(aws_iot_shadow_mirror_needs_resync());
+	CHECK_EQUAL_C_INT(3, aws_iot_shadow_mirror_get_version());
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+
+	aws_iot_shadow_mirror_invalidate();
+	CHECK_C(aws_iot_shadow_mirror_needs_resync());
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+
+	IOT_DEBUG("-->Success - needs resync until seeded \n");
+}
+
+TEST_C(ShadowMirrorTests, UpdateNotifiesChangedFieldsOnly) {
+	int32_t humidity = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - update notifies changed fields only \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_REPORTED, NULL,
+																		recordChange, NULL));
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"cleaningStatus\":\"CLEANED\",\"humidity\":45,\"sensors\":{\"co2\":530,\"door\":\"closed\"}}},"
+		"\"metadata\":{},\"version\":11,\"clientToken\":\"abc-1\"}"));
+
+	CHECK_EQUAL_C_INT(2, changeCount);
+	CHECK_EQUAL_C_STRING("humidity", changes[0].key);
+	CHECK_EQUAL_C_STRING("45", changes[0].value);
+	CHECK_EQUAL_C_STRING("sensors.co2", changes[1].key);
+	CHECK_EQUAL_C_STRING("530", changes[1].value);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "humidity", &humidity));
+	CHECK_EQUAL_C_INT(45, humidity);
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "sensors.door", "closed"));
+	CHECK_EQUAL_C_INT(11, aws_iot_shadow_mirror_get_version());
+
+	IOT_DEBUG("-->Success - update notifies changed fields only \n");
+}
+
+TEST_C(ShadowMirrorTests, OlderDocumentIgnored) {
+	IoT_Shadow_Mirror_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - older document ignored \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_DELTA,
+											 "{\"version\":9,\"state\":{\"cleaningStatus\":\"OLD\"}}"));
+	CHECK_C(hasString(SHADOW_MIRROR_DESIRED, "cleaningStatus", "DIRTY"));
+	CHECK_EQUAL_C_INT(10, aws_iot_shadow_mirror_get_version());
+
+	aws_iot_shadow_mirror_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.documents);
+	CHECK_EQUAL_C_INT(1, stats.stale);
+
+	IOT_DEBUG("-->Success - older document ignored \n");
+}
+
+TEST_C(ShadowMirrorTests, DeltaMergedIntoDesired) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - delta merged into desired \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																		recordChange, NULL));
+
+	/* update/accepted and delta of the same update share the version */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"desired\":{\"cleaningStatus\":\"IN_PROGRESS\"}},\"version\":11}"));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_DELTA,
+		"{\"version\":11,\"timestamp\":1614852690,\"state\":{\"cleaningStatus\":\"IN_PROGRESS\"},"
+		"\"metadata\":{\"cleaningStatus\":{\"timestamp\":1614852690}}}"));
+
+	CHECK_EQUAL_C_INT(1, changeCount);
+	CHECK_EQUAL_C_INT(SHADOW_MIRROR_DESIRED, changes[0].section);
+	CHECK_EQUAL_C_STRING("IN_PROGRESS", changes[0].value);
+	CHECK_C(hasString(SHADOW_MIRROR_DESIRED, "cleaningStatus", "IN_PROGRESS"));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+
+	IOT_DEBUG("-->Success - delta merged into desired \n");
+}
+
+TEST_C(ShadowMirrorTests, NullRemovesField) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - null removes field \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_REPORTED, NULL,
+																		recordChange, NULL));
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"sensors\":null,\"humidity\":null}},\"version\":11}"));
+
+	CHECK_EQUAL_C_INT(3, changeCount);
+	CHECK_C(changes[0].removed && changes[1].removed && changes[2].removed);
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "sensors.co2", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "sensors.door", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "humidity", NULL));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+
+	/* A whole section set to null */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+											 "{\"state\":{\"desired\":null},\"version\":12}"));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_DESIRED, "cleaningStatus", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_DESIRED, "target", NULL));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+
+	IOT_DEBUG("-->Success - null removes field \n");
+}
+
+TEST_C(ShadowMirrorTests, VersionGapRequestsResync) {
+	IoT_Shadow_Mirror_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - version gap requests resync \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_DELTA,
+											 "{\"version\":13,\"state\":{\"cleaningStatus\":\"CLEANED\"}}"));
+
+	/* Still merged, but the updates in between were missed */
+	CHECK_C(hasString(SHADOW_MIRROR_DESIRED, "cleaningStatus", "CLEANED"));
+	CHECK_C(aws_iot_shadow_mirror_needs_resync());
+	aws_iot_shadow_mirror_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.gaps);
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED,
+		"{\"state\":{\"reported\":{\"cleaningStatus\":\"CLEANED\"}},\"version\":14}"));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+
+	IOT_DEBUG("-->Success - version gap requests resync \n");
+}
+
+TEST_C(ShadowMirrorTests, ReseedRemovesMissingFields) {
+	uint8_t i;
+	uint8_t removed = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - reseed removes missing fields \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_REPORTED, NULL,
+																		recordChange, NULL));
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED,
+		"{\"state\":{\"reported\":{\"cleaningStatus\":\"CLEANED\",\"humidity\":42}},\"version\":20}"));
+
+	/* occupied, sensors.co2, sensors.door and schedule are gone, the rest is unchanged */
+	for(i = 0; i < changeCount; i++) {
+		CHECK_C(changes[i].removed);
+		removed++;
+	}
+	CHECK_EQUAL_C_INT(4, removed);
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "occupied", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_DESIRED, "cleaningStatus", NULL));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+
+	IOT_DEBUG("-->Success - reseed removes missing fields \n");
+}
+
+TEST_C(ShadowMirrorTests, CallbackFilteredByKey) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - callback filtered by key \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, "cleaningStatus",
+																		recordChange, NULL));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"desired\":{\"cleaningStatus\":\"IN_PROGRESS\",\"target\":22},"
+		"\"reported\":{\"cleaningStatus\":\"DIRTY\"}},\"version\":11}"));
+
+	CHECK_EQUAL_C_INT(1, changeCount);
+	CHECK_EQUAL_C_INT(SHADOW_MIRROR_DESIRED, changes[0].section);
+	CHECK_EQUAL_C_STRING("cleaningStatus", changes[0].key);
+	CHECK_EQUAL_C_STRING("IN_PROGRESS", changes[0].value);
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																				 NULL, NULL));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																		recordChange, NULL));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																		recordChange, NULL));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																		recordChange, NULL));
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																					 recordChange, NULL));
+
+	IOT_DEBUG("-->Success - callback filtered by key \n");
+}
+
+TEST_C(ShadowMirrorTests, FirstSeedNotNotified) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - first seed not notified \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_register_callback(SHADOW_MIRROR_DESIRED, NULL,
+																		recordChange, NULL));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(0, changeCount);
+	CHECK_C(hasString(SHADOW_MIRROR_DESIRED, "cleaningStatus", "DIRTY"));
+
+	/* A reseed after missed updates reports what changed meanwhile */
+	aws_iot_shadow_mirror_invalidate();
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED,
+		"{\"state\":{\"desired\":{\"cleaningStatus\":\"CLEANED\",\"target\":21.5}},\"version\":15}"));
+	CHECK_EQUAL_C_INT(1, changeCount);
+	CHECK_EQUAL_C_STRING("cleaningStatus", changes[0].key);
+	CHECK_EQUAL_C_STRING("CLEANED", changes[0].value);
+
+	IOT_DEBUG("-->Success - first seed not notified \n");
+}
+
+TEST_C(ShadowMirrorTests, NotFoundSeedsEmpty) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - not found seeds empty \n");
+
+	/* Other errors keep asking for a get */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_REJECTED,
+		"{\"code\":429,\"message\":\"Too Many Requests\",\"clientToken\":\"abc-1\"}"));
+	CHECK_C(aws_iot_shadow_mirror_needs_resync());
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, applyDocument(SHADOW_MIRROR_DOC_GET_REJECTED, "{\"message\":\"x\"}"));
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_REJECTED,
+		"{\"code\":404,\"message\":\"No shadow exists with name: 'thing'\",\"clientToken\":\"abc-2\"}"));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+	CHECK_EQUAL_C_INT(0, aws_iot_shadow_mirror_get_version());
+
+	/* A Shadow deleted meanwhile empties the mirror, and its next version 1 is merged */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	aws_iot_shadow_mirror_invalidate();
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_REJECTED, "{\"code\":404}"));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "cleaningStatus", NULL));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_DESIRED, "cleaningStatus", NULL));
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"cleaningStatus\":\"CLEANED\"}},\"version\":1}"));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "cleaningStatus", "CLEANED"));
+	CHECK_C(!aws_iot_shadow_mirror_needs_resync());
+
+	IOT_DEBUG("-->Success - not found seeds empty \n");
+}
+
+TEST_C(ShadowMirrorTests, FullTableDropsFields) {
+	IoT_Shadow_Mirror_Stats_t stats;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - full table drops fields \n");
+
+	/* Seed document has exactly AWS_IOT_SHADOW_MIRROR_MAX_FIELDS leaf values */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"firmware\":\"1.4.2\",\"humidity\":43}},\"version\":11}"));
+
+	aws_iot_shadow_mirror_get_stats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.dropped);
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "firmware", NULL));
+	CHECK_C(NULL != aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "humidity", NULL));
+
+	/* Removing a field makes room */
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"schedule\":null,\"firmware\":\"1.4.2\"}},\"version\":12}"));
+	CHECK_C(hasString(SHADOW_MIRROR_REPORTED, "firmware", "1.4.2"));
+
+	IOT_DEBUG("-->Success - full table drops fields \n");
+}
+
+TEST_C(ShadowMirrorTests, TypedLookupErrors) {
+	char small[4];
+	int32_t value;
+	bool flag;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - typed lookup errors \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, applyDocument(SHADOW_MIRROR_DOC_GET_ACCEPTED, seedDocument));
+
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "missing", &value));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "cleaningStatus",
+																	   &value));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_shadow_mirror_get_bool(SHADOW_MIRROR_REPORTED, "humidity", &flag));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, aws_iot_shadow_mirror_get_string(SHADOW_MIRROR_REPORTED, "humidity",
+																		   small, sizeof(small)));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_BUFFER_TRUNCATED,
+					  aws_iot_shadow_mirror_get_string(SHADOW_MIRROR_REPORTED, "cleaningStatus", small, sizeof(small)));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_mirror_get_int(SHADOW_MIRROR_REPORTED, "humidity", NULL));
+
+	IOT_DEBUG("-->Success - typed lookup errors \n");
+}
+
+TEST_C(ShadowMirrorTests, DocumentWithoutVersionRejected) {
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - document without version rejected \n");
+
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED,
+		"{\"state\":{\"reported\":{\"humidity\":40}}}"));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED, "[1,2]"));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, applyDocument(SHADOW_MIRROR_DOC_UPDATE_ACCEPTED, "{\"state\":"));
+	CHECK_C(NULL == aws_iot_shadow_mirror_get_raw(SHADOW_MIRROR_REPORTED, "humidity", NULL));
+	CHECK_EQUAL_C_INT(0, aws_iot_shadow_mirror_get_version());
+
+	IOT_DEBUG("-->Success - document without version rejected \n");
+}
+
+#ifdef __cplusplus
+}
+#endif
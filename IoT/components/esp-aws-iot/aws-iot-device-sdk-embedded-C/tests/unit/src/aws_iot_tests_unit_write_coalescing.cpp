@@ -0,0 +1,42 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_write_coalescing.cpp
+ * @brief IoT Client Unit Testing - Write Coalescing Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(WriteCoalescingTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(WriteCoalescingTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(WriteCoalescingTests)
+};
+
+/* A publish outside yield is written on its own */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, PublishOutsideYieldWrittenDirectly)
+/* PUBACK and a QoS 0 publish from the callback share one write */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, PubackAndCallbackPublishOneWrite)
+/* PUBACK and PINGREQ of the same cycle share one write */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, PubackAndPingreqOneWrite)
+/* A packet that does not fit writes the batch first */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, FullBatchWrittenEarly)
+/* A packet too large to batch is written after the batch */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, LargePacketWrittenAfterBatch)
+/* A failed batch write disconnects the client */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, FailedWriteDisconnects)
+/* Stats with NULL parameters */
+TEST_GROUP_C_WRAPPER(WriteCoalescingTests, GetStatsNullParams)
@@ -0,0 +1,277 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_write_coalescing_helper.c
+ * @brief IoT Client Unit Testing - Write Coalescing Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_log.h"
+
+static IoT_Client_Init_Params initParams;
+static IoT_Client_Connect_Params connectParams;
+static IoT_Publish_Message_Params testPubMsgParams;
+static AWS_IoT_Client iotClient;
+
+static char subTopic[10] = "sdk/Test";
+static uint16_t subTopicLen = 8;
+
+/* PUBACK for the packet id setTLSRxBufferWithMsgOnSubscribedTopic uses */
+static const unsigned char expectedPuback[] = { 0x40, 0x02, 0x02, 0x03 };
+/* QoS 0 PUBLISH of "b" to "a", six bytes */
+static const unsigned char expectedSmallPublish[] = { 0x30, 0x04, 0x00, 0x01, 'a', 'b' };
+
+static int callbackPublishCount;
+static size_t callbackPayloadLen;
+static IoT_Error_t callbackPublishRc;
+
+static void iot_tests_unit_coalescing_callback_handler(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
+													   IoT_Publish_Message_Params *params, void *pData) {
+	static char payload[32];
+	IoT_Publish_Message_Params pubParams;
+	int i;
+
+	IOT_UNUSED(topicName);
+	IOT_UNUSED(topicNameLen);
+	IOT_UNUSED(params);
+	IOT_UNUSED(pData);
+
+	memset(payload, 'b', sizeof(payload));
+	pubParams.qos = QOS0;
+	pubParams.isRetained = 0;
+	pubParams.payload = payload;
+	pubParams.payloadLen = callbackPayloadLen;
+
+	for(i = 0; i < callbackPublishCount; i++) {
+		callbackPublishRc = aws_iot_mqtt_publish(pClient, "a", 1, &pubParams);
+	}
+}
+
+/* Subscribe, then leave a QoS 1 message on the subscribed topic for the next yield */
+static void subscribeAndReceiveQoS1(void) {
+	IoT_Error_t rc;
+
+	setTLSRxBufferForSuback(subTopic, subTopicLen, QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, subTopic, subTopicLen, QOS1,
+								iot_tests_unit_coalescing_callback_handler, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(subTopic, subTopicLen, QOS1, testPubMsgParams, "x");
+}
+
+static void getStats(IoT_Mqtt_Coalesce_Stats_t *pStats) {
+	IoT_Error_t rc = aws_iot_mqtt_get_coalesce_stats(&iotClient, pStats);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+}
+
+TEST_GROUP_C_SETUP(WriteCoalescingTests) {
+	IoT_Error_t rc;
+
+	ResetTLSBuffer();
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	rc = aws_iot_mqtt_init(&iotClient, &initParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	connectParams.keepAliveIntervalInSec = 5;
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	rc = aws_iot_mqtt_connect(&iotClient, &connectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	rc = aws_iot_mqtt_autoreconnect_set_status(&iotClient, false);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	testPubMsgParams.qos = QOS1;
+	testPubMsgParams.isRetained = 0;
+	testPubMsgParams.payload = (void *) "x";
+	testPubMsgParams.payloadLen = 1;
+
+	callbackPublishCount = 0;
+	callbackPayloadLen = 1;
+	callbackPublishRc = SUCCESS;
+	ResetTLSBuffer();
+}
+
+TEST_GROUP_C_TEARDOWN(WriteCoalescingTests) {
+	/* A test might have already caused a disconnect by this point */
+	IoT_Error_t rc = aws_iot_mqtt_disconnect(&iotClient);
+	IOT_UNUSED(rc);
+	ResetTLSBuffer();
+}
+
+TEST_C(WriteCoalescingTests, PublishOutsideYieldWrittenDirectly) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Publish_Message_Params pubParams;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - Publish outside yield \n");
+
+	pubParams.qos = QOS0;
+	pubParams.isRetained = 0;
+	pubParams.payload = (void *) "b";
+	pubParams.payloadLen = 1;
+	rc = aws_iot_mqtt_publish(&iotClient, "a", 1, &pubParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	CHECK_EQUAL_C_INT(sizeof(expectedSmallPublish), TxBuffer.len);
+	CHECK_C(0 == memcmp(TxBuffer.pBuffer, expectedSmallPublish, sizeof(expectedSmallPublish)));
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(0, stats.packetsQueued);
+	CHECK_EQUAL_C_INT(0, stats.recordsWritten);
+
+	IOT_DEBUG("-->Success - Publish outside yield \n");
+}
+
+TEST_C(WriteCoalescingTests, PubackAndCallbackPublishOneWrite) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - PUBACK and callback publish \n");
+
+	callbackPublishCount = 1;
+	subscribeAndReceiveQoS1();
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(SUCCESS, callbackPublishRc);
+
+	CHECK_EQUAL_C_INT(sizeof(expectedPuback) + sizeof(expectedSmallPublish), TxBuffer.len);
+	CHECK_C(0 == memcmp(TxBuffer.pBuffer, expectedPuback, sizeof(expectedPuback)));
+	CHECK_C(0 == memcmp(&TxBuffer.pBuffer[sizeof(expectedPuback)], expectedSmallPublish,
+						sizeof(expectedSmallPublish)));
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(2, stats.packetsQueued);
+	CHECK_EQUAL_C_INT(1, stats.recordsWritten);
+	CHECK_EQUAL_C_INT(1, stats.recordsSaved);
+	CHECK_EQUAL_C_INT(AWS_IOT_MQTT_COALESCE_RECORD_OVERHEAD, stats.bytesSaved);
+
+	IOT_DEBUG("-->Success - PUBACK and callback publish \n");
+}
+
+TEST_C(WriteCoalescingTests, PubackAndPingreqOneWrite) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - PUBACK and PINGREQ \n");
+
+	subscribeAndReceiveQoS1();
+	sleep(connectParams.keepAliveIntervalInSec);
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	CHECK_EQUAL_C_INT(sizeof(expectedPuback) + 2, TxBuffer.len);
+	CHECK_C(0 == memcmp(TxBuffer.pBuffer, expectedPuback, sizeof(expectedPuback)));
+	CHECK_EQUAL_C_INT(0xC0, TxBuffer.pBuffer[sizeof(expectedPuback)]);
+	CHECK_EQUAL_C_INT(0x00, TxBuffer.pBuffer[sizeof(expectedPuback) + 1]);
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.recordsWritten);
+	CHECK_EQUAL_C_INT(1, stats.recordsSaved);
+
+	IOT_DEBUG("-->Success - PUBACK and PINGREQ \n");
+}
+
+TEST_C(WriteCoalescingTests, FullBatchWrittenEarly) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - Full batch \n");
+
+	/* 4 + 6 + 6 bytes fill the 16 byte test buffer, the third publish starts a new batch */
+	callbackPublishCount = 3;
+	subscribeAndReceiveQoS1();
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(SUCCESS, callbackPublishRc);
+
+	CHECK_EQUAL_C_INT(sizeof(expectedSmallPublish), TxBuffer.len);
+	CHECK_C(0 == memcmp(TxBuffer.pBuffer, expectedSmallPublish, sizeof(expectedSmallPublish)));
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(4, stats.packetsQueued);
+	CHECK_EQUAL_C_INT(2, stats.recordsWritten);
+	CHECK_EQUAL_C_INT(2, stats.recordsSaved);
+
+	IOT_DEBUG("-->Success - Full batch \n");
+}
+
+TEST_C(WriteCoalescingTests, LargePacketWrittenAfterBatch) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - Large packet \n");
+
+	/* The PUBACK is written before the publish, which is not batched */
+	callbackPublishCount = 1;
+	callbackPayloadLen = AWS_IOT_MQTT_COALESCE_BUF_LEN;
+	subscribeAndReceiveQoS1();
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(SUCCESS, callbackPublishRc);
+
+	CHECK_EQUAL_C_INT(0x30, TxBuffer.pBuffer[0]);
+	CHECK_EQUAL_C_INT(AWS_IOT_MQTT_COALESCE_BUF_LEN + 5, TxBuffer.len);
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(1, stats.packetsQueued);
+	CHECK_EQUAL_C_INT(1, stats.recordsWritten);
+	CHECK_EQUAL_C_INT(0, stats.recordsSaved);
+
+	IOT_DEBUG("-->Success - Large packet \n");
+}
+
+TEST_C(WriteCoalescingTests, FailedWriteDisconnects) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - Failed write \n");
+
+	callbackPublishCount = 1;
+	subscribeAndReceiveQoS1();
+	setTLSTxBufferForError(NETWORK_SSL_WRITE_ERROR);
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(NETWORK_DISCONNECTED_ERROR, rc);
+	CHECK_EQUAL_C_INT(0, aws_iot_mqtt_is_client_connected(&iotClient));
+
+	/* The DISCONNECT went out alone, the failed batch was dropped */
+	CHECK_EQUAL_C_INT(1, isLastTLSTxMessageDisconnect());
+	CHECK_EQUAL_C_INT(2, TxBuffer.len);
+
+	getStats(&stats);
+	CHECK_EQUAL_C_INT(0, stats.recordsWritten);
+
+	IOT_DEBUG("-->Success - Failed write \n");
+}
+
+TEST_C(WriteCoalescingTests, GetStatsNullParams) {
+	IoT_Mqtt_Coalesce_Stats_t stats;
+
+	IOT_DEBUG("-->Running Write Coalescing Tests - Stats with NULL parameters \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_get_coalesce_stats(NULL, &stats));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_get_coalesce_stats(&iotClient, NULL));
+
+	IOT_DEBUG("-->Success - Stats with NULL parameters \n");
+}
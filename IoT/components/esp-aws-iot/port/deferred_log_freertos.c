@@ -0,0 +1,69 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * Additions Copyright 2016 Espressif Systems (Shanghai) PTE LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file deferred_log_freertos.c
+ * @brief FreeRTOS task that drains the deferred log to the console.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "deferred_log_platform.h"
+
+#ifdef ENABLE_IOT_DEFERRED_LOG
+
+static TaskHandle_t drainTask = NULL;
+
+static void deferred_log_sink(const char *pLine, size_t lineLen, void *pContext) {
+    /* One fwrite per line keeps the line whole next to regular ESP_LOGx output */
+    fwrite(pLine, 1, lineLen, stdout);
+}
+
+static void deferred_log_drain_task(void *param) {
+    while (1) {
+        if (aws_iot_deferred_log_drain(deferred_log_sink, NULL, 0) > 0) {
+            fflush(stdout);
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_AWS_IOT_DEFERRED_LOG_FLUSH_MS));
+    }
+}
+
+bool aws_iot_deferred_log_start_drain_task(void) {
+    if (drainTask == NULL) {
+        xTaskCreate(deferred_log_drain_task, "dlog_drain", 2048, NULL, tskIDLE_PRIORITY + 1, &drainTask);
+    }
+    return drainTask != NULL;
+}
+
+#else
+
+bool aws_iot_deferred_log_start_drain_task(void) {
+    return false;
+}
+
+#endif /* ENABLE_IOT_DEFERRED_LOG */
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,6 +21,13 @@
 #ifndef _AWS_IOT_CONFIG_H_
 #define _AWS_IOT_CONFIG_H_
 
+// Deferred logging. Defined before aws_iot_log.h is included, it uses these values
+#ifdef CONFIG_AWS_IOT_DEFERRED_LOG
+#define ENABLE_IOT_DEFERRED_LOG ///< Record log messages unformatted in a ring buffer, see aws_iot_deferred_log.h
+#define AWS_IOT_DEFERRED_LOG_DEPTH CONFIG_AWS_IOT_DEFERRED_LOG_DEPTH ///< Number of records kept in the deferred log ring
+#define AWS_IOT_DEFERRED_LOG_LEVEL CONFIG_AWS_IOT_DEFERRED_LOG_LEVEL ///< Most verbose level recorded in the deferred log
+#endif
+
 #include "aws_iot_log.h"
 
 // This configuration macro needs to be available globally to enable threading
@@ -62,4 +69,40 @@
 #define AWS_IOT_MQTT_MIN_RECONNECT_WAIT_INTERVAL CONFIG_AWS_IOT_MQTT_MIN_RECONNECT_WAIT_INTERVAL ///< Minimum time before the First reconnect attempt is made as part of the exponential back-off algorithm
 #define AWS_IOT_MQTT_MAX_RECONNECT_WAIT_INTERVAL CONFIG_AWS_IOT_MQTT_MAX_RECONNECT_WAIT_INTERVAL ///< Maximum time interval after which exponential back-off will stop attempting to reconnect.
 
+// Shared buffer arena
+#ifdef CONFIG_AWS_IOT_BUFFER_ARENA
+#define ENABLE_IOT_BUFFER_ARENA ///< Take the MQTT and Shadow working buffers from one arena, see aws_iot_buffer_arena.h
+#define AWS_IOT_BUFFER_ARENA_SIZE CONFIG_AWS_IOT_BUFFER_ARENA_SIZE ///< Total size of the buffer arena in bytes
+#ifdef CONFIG_AWS_IOT_BUFFER_ARENA_IN_EXT_RAM
+#include "esp_attr.h"
+#define AWS_IOT_BUFFER_ARENA_ATTR EXT_RAM_ATTR ///< Place the buffer arena in external RAM
+#endif
+#endif
+
+// Latency tracing
+#ifdef CONFIG_AWS_IOT_LATENCY_TRACE
+#define ENABLE_IOT_LATENCY_TRACE ///< Compile in the end-to-end latency trace points, see aws_iot_latency_trace.h
+#define AWS_IOT_LATENCY_TRACE_DEPTH CONFIG_AWS_IOT_LATENCY_TRACE_DEPTH ///< Number of events kept in the latency trace ring buffer
+#endif
+
+// MQTT 5
+#ifdef CONFIG_AWS_IOT_MQTT5
+#define ENABLE_IOT_MQTT5 ///< Compile in MQTT 5 support, MQTT_5 can then be used as MQTTVersion
+#define AWS_IOT_MQTT5_TOPIC_ALIASES CONFIG_AWS_IOT_MQTT5_TOPIC_ALIASES ///< Topic aliases the client assigns on outgoing PUBLISH packets
+#define AWS_IOT_SHADOW_MQTT_VERSION MQTT_5 ///< Shadow connections use MQTT 5
+#endif
+
+// Write coalescing
+#ifdef CONFIG_AWS_IOT_MQTT_WRITE_COALESCING
+#define ENABLE_IOT_MQTT_WRITE_COALESCING ///< Write the small packets of a yield cycle as one TLS record
+#define AWS_IOT_MQTT_COALESCE_BUF_LEN CONFIG_AWS_IOT_MQTT_COALESCE_BUF_LEN ///< Bytes of packets collected before a write
+#define AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS CONFIG_AWS_IOT_MQTT_COALESCE_MAX_DELAY_MS ///< Longest wait of a collected packet
+#endif
+
+// Shadow mirror
+#ifdef CONFIG_AWS_IOT_SHADOW_MIRROR
+#define ENABLE_IOT_SHADOW_MIRROR ///< Keep a local copy of the Shadow state, see aws_iot_shadow_mirror.h
+#define AWS_IOT_SHADOW_MIRROR_MAX_FIELDS CONFIG_AWS_IOT_SHADOW_MIRROR_MAX_FIELDS ///< Fields kept across the reported and desired sections
+#endif
+
 #endif /* _AWS_IOT_CONFIG_H_ */
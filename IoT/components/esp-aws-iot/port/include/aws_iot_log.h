@@ -27,6 +27,28 @@
    headers include aws_iot_log.h, but our modified fork does.
 */
 
+#ifdef CONFIG_AWS_IOT_DEFERRED_LOG
+
+#include "aws_iot_deferred_log.h"
+
+/* Debug, info and trace output is recorded in the deferred log and formatted
+   on the host, warnings and errors still go out immediately.
+*/
+#define IOT_DEBUG(format, ...) IOT_DEFERRED_LOGD("aws_iot", format, ##__VA_ARGS__)
+#define IOT_INFO(format, ...) IOT_DEFERRED_LOGI("aws_iot", format, ##__VA_ARGS__)
+#define IOT_WARN(format, ...) ESP_LOGW("aws_iot", format, ##__VA_ARGS__)
+#define IOT_ERROR(format, ...) ESP_LOGE("aws_iot", format, ##__VA_ARGS__)
+
+/* __func__ lives in flash, so it is stored by address */
+#define FUNC_ENTRY IOT_DEFERRED_LOG_REF(IOT_DLOG_LEVEL_VERBOSE, "aws_iot", "FUNC_ENTRY:   %s L#%d", __func__, __LINE__)
+#define FUNC_EXIT_RC(x) \
+    do {                                                                \
+        IOT_DEFERRED_LOG_REF(IOT_DLOG_LEVEL_VERBOSE, "aws_iot", "FUNC_EXIT:   %s L#%d Return Code : %d", __func__, __LINE__, x); \
+        return x; \
+    } while(0)
+
+#else
+
 // redefine the AWS IoT log functions to call into the IDF log layer
 #define IOT_DEBUG(format, ...) ESP_LOGD("aws_iot", format, ##__VA_ARGS__)
 #define IOT_INFO(format, ...) ESP_LOGI("aws_iot", format, ##__VA_ARGS__)
@@ -42,3 +64,5 @@
         ESP_LOGV("aws_iot", "FUNC_EXIT:   %s L#%d Return Code : %d \n", __func__, __LINE__, x); \
         return x; \
     } while(0)
+
+#endif /* CONFIG_AWS_IOT_DEFERRED_LOG */
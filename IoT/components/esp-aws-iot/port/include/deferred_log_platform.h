@@ -0,0 +1,43 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * Additions Copyright 2016 Espressif Systems (Shanghai) PTE LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AWS_IOTSDK_DEFERRED_LOG_PLATFORM_H
+#define AWS_IOTSDK_DEFERRED_LOG_PLATFORM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include "aws_iot_deferred_log.h"
+
+/**
+ * @brief Start the task that drains the deferred log to the console
+ *
+ * The task runs just above idle priority and writes the pending records as
+ * "#DL1:" lines every CONFIG_AWS_IOT_DEFERRED_LOG_FLUSH_MS milliseconds.
+ * Calling it more than once has no effect.
+ *
+ * @return true if the task is running
+ */
+bool aws_iot_deferred_log_start_drain_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOTSDK_DEFERRED_LOG_PLATFORM_H */
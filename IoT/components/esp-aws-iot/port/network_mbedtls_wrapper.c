@@ -21,6 +21,7 @@
 
 #include "aws_iot_config.h"
 #include "aws_iot_error.h"
+#include "aws_iot_latency_trace.h"
 #include "network_interface.h"
 #include "network_platform.h"
 
@@ -30,6 +31,12 @@
 #include "mbedtls/atca_mbedtls_wrap.h"
 #include "tng_atca.h"
 #include "tng_atcacert_client.h"
+#ifdef CONFIG_ATCA_CERT_CACHE
+#include "atca_cert_cache.h"
+#endif
+#ifdef CONFIG_ATCA_ENTROPY_POOL
+#include "atca_entropy_pool.h"
+#endif
 #include "i2c_device.h"
 #include "atecc608.h"
 #endif
@@ -106,6 +113,11 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
     TLSDataParams *tlsDataParams = NULL;
     char portBuffer[6];
     char info_buf[256];
+#if defined(CONFIG_AWS_IOT_USE_HARDWARE_SECURE_ELEMENT) && defined(CONFIG_ATCA_ENTROPY_POOL)
+    bool useEntropyPool = false;
+    atca_entropy_pool_stats_t poolBefore;
+    atca_entropy_pool_stats_t poolAfter;
+#endif
 
     if(NULL == pNetwork) {
         return NULL_VALUE_ERROR;
@@ -170,7 +182,12 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
 
         if (ret == 0) {            
             ESP_LOGI(TAG, "Attempting to use device certificate from ATECC608");
+#ifdef CONFIG_ATCA_CERT_CACHE
+            /* Rebuilt once, later connections take it from RAM or NVS */
+            ret = atca_cert_cache_add(&(tlsDataParams->clicert), cert_def);
+#else
             ret = atca_mbedtls_cert_add(&(tlsDataParams->clicert), cert_def);
+#endif
 
         } else {
             ESP_LOGE(TAG, "failed! could not load cert from ATECC608, tng_get_device_cert_def returned %02x", ret);
@@ -263,6 +280,13 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
     } else {
         mbedtls_ssl_conf_authmode(&(tlsDataParams->conf), MBEDTLS_SSL_VERIFY_OPTIONAL);
     }
+#if defined(CONFIG_AWS_IOT_USE_HARDWARE_SECURE_ELEMENT) && defined(CONFIG_ATCA_ENTROPY_POOL)
+    /* Handshake randomness comes from the pooled ATECC608 blocks, not from Random commands */
+    if(pNetwork->tlsConnectParams.pDevicePrivateKeyLocation[0] == '#' && atca_entropy_pool_init() == 0) {
+        useEntropyPool = true;
+        mbedtls_ssl_conf_rng(&(tlsDataParams->conf), atca_entropy_pool_random, NULL);
+    } else
+#endif
     mbedtls_ssl_conf_rng(&(tlsDataParams->conf), mbedtls_ctr_drbg_random, &(tlsDataParams->ctr_drbg));
 
     mbedtls_ssl_conf_ca_chain(&(tlsDataParams->conf), &(tlsDataParams->cacert), NULL);
@@ -300,6 +324,11 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
 
     ESP_LOGD(TAG, "SSL state connect : %d ", tlsDataParams->ssl.state);
     ESP_LOGD(TAG, "Performing the SSL/TLS handshake...");
+#if defined(CONFIG_AWS_IOT_USE_HARDWARE_SECURE_ELEMENT) && defined(CONFIG_ATCA_ENTROPY_POOL)
+    if(useEntropyPool) {
+        atca_entropy_pool_get_stats(&poolBefore);
+    }
+#endif
     while((ret = mbedtls_ssl_handshake(&(tlsDataParams->ssl))) != 0) {
         if(ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
             ESP_LOGE(TAG, "failed! mbedtls_ssl_handshake returned -0x%x", -ret);
@@ -310,6 +339,18 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
         }
     }
 
+#if defined(CONFIG_AWS_IOT_USE_HARDWARE_SECURE_ELEMENT) && defined(CONFIG_ATCA_ENTROPY_POOL)
+    if(useEntropyPool) {
+        atca_entropy_pool_get_stats(&poolAfter);
+        ESP_LOGI(TAG, "Handshake took %u random bytes from the pool, %u ATECC608 Random commands avoided, %u sent",
+                 (unsigned) (poolAfter.bytes - poolBefore.bytes),
+                 (unsigned) (poolAfter.commands_avoided - poolBefore.commands_avoided),
+                 (unsigned) (poolAfter.random_commands - poolBefore.random_commands));
+        /* The device is idle until the next signature, top the pool up now */
+        atca_entropy_pool_refill();
+    }
+#endif
+
     ESP_LOGD(TAG, "ok    [ Protocol is %s ]    [ Ciphersuite is %s ]", mbedtls_ssl_get_version(&(tlsDataParams->ssl)),
           mbedtls_ssl_get_ciphersuite(&(tlsDataParams->ssl)));
     if((ret = mbedtls_ssl_get_record_expansion(&(tlsDataParams->ssl))) >= 0) {
@@ -352,6 +393,8 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
     int frags, ret = 0;
     TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
 
+    IOT_LATENCY_TRACE(IOT_TRACE_TLS_WRITE_START, len);
+
     for(written_so_far = 0, frags = 0;
         written_so_far < len && !has_timer_expired(timer); written_so_far += ret, frags++) {
         while(!has_timer_expired(timer) &&
@@ -370,6 +413,7 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
     }
 
     *written_len = written_so_far;
+    IOT_LATENCY_TRACE(IOT_TRACE_TLS_WRITE_DONE, written_so_far);
 
     if(isErrorFlag) {
         return NETWORK_SSL_WRITE_ERROR;
@@ -416,6 +460,7 @@ IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Tim
     }
 
     if (len == 0) {
+        IOT_LATENCY_TRACE(IOT_TRACE_TLS_READ_DONE, rxLen);
         *read_len = rxLen;
         return SUCCESS;
     }
@@ -29,6 +29,7 @@ extern "C" {
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 const static char *TAG = "aws_timer";
 
@@ -78,6 +79,10 @@ void init_timer(Timer *timer) {
     timer->last_polled_ticks = 0;
 }
 
+uint64_t timer_now_us(void) {
+    return (uint64_t) esp_timer_get_time();
+}
+
 #ifdef __cplusplus
 }
 #endif
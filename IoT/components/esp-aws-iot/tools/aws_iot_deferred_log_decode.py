@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+#
+# Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#
+# http://aws.amazon.com/apache2.0
+#
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+"""Host side decoder for the AWS IoT deferred log.
+
+The device writes deferred log records as "#DL1:<base64>" lines, see
+aws_iot_deferred_log.h. A record holds the addresses of its tag and format
+string plus the raw argument values. This script looks the strings up in
+the firmware ELF file and formats the messages like ESP_LOGx would. All
+other console lines are passed through unchanged.
+
+    idf.py monitor | tee console.log
+    aws_iot_deferred_log_decode.py build/<project>.elf console.log
+
+Reads standard input when no log file is given, so it can also sit behind
+any serial terminal that prints raw lines.
+"""
+
+import argparse
+import base64
+import re
+import struct
+import sys
+
+LINE_PREFIX = '#DL1:'
+HEADER = struct.Struct('<IIIIBBB')
+
+FLAG_STRING_REF = 0x01
+FLAG_TRUNCATED = 0x02
+
+LEVEL_LETTERS = {1: 'E', 2: 'W', 3: 'I', 4: 'D', 5: 'V'}
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+CONVERSION = re.compile(
+    r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d*))?'
+    r'(?P<length>hh|h|ll|l|j|z|t|L)?(?P<conv>[diuoxXcfFeEgGaApsn%])')
+
+
+class Elf:
+    """Minimal ELF reader: maps addresses of loaded sections to file contents."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+        if self.data[5] != 1:
+            raise ValueError('only little-endian ELF files are supported')
+        is64 = self.data[4] == 2
+        if is64:
+            shoff, = struct.unpack_from('<Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x3A)
+            section = struct.Struct('<IIQQQQIIQQ')
+        else:
+            shoff, = struct.unpack_from('<I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+            section = struct.Struct('<IIIIIIIIII')
+
+        self.ranges = []
+        for i in range(shnum):
+            fields = section.unpack_from(self.data, shoff + i * shentsize)
+            sh_type, sh_flags, sh_addr, sh_offset, sh_size = fields[1], fields[2], fields[3], fields[4], fields[5]
+            if sh_flags & SHF_ALLOC and sh_type != SHT_NOBITS and sh_size > 0:
+                self.ranges.append((sh_addr, sh_addr + sh_size, sh_offset))
+
+    def string(self, address):
+        for start, end, offset in self.ranges:
+            if start <= address < end:
+                begin = offset + address - start
+                stop = self.data.find(b'\0', begin, offset + end - start)
+                if stop < 0:
+                    stop = offset + end - start
+                return self.data[begin:stop].decode('utf-8', 'replace')
+        return None
+
+
+class ArgReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, size):
+        if self.pos + size > len(self.data):
+            raise IndexError
+        chunk = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return chunk
+
+    def u32(self):
+        return struct.unpack('<I', self.take(4))[0]
+
+    def i32(self):
+        return struct.unpack('<i', self.take(4))[0]
+
+    def u64(self):
+        return struct.unpack('<Q', self.take(8))[0]
+
+    def i64(self):
+        return struct.unpack('<q', self.take(8))[0]
+
+    def f64(self):
+        return struct.unpack('<d', self.take(8))[0]
+
+
+def format_message(elf, fmt, flags, args):
+    """Apply the device side capture rules in reverse and format with Python's % operator."""
+    reader = ArgReader(args)
+    out = []
+    pos = 0
+    missing = False
+
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+        conv = match.group('conv')
+        if conv == '%':
+            out.append('%')
+            continue
+        try:
+            width = match.group('width') or ''
+            if width == '*':
+                width = str(reader.i32())
+            precision = match.group('precision')
+            if precision == '*':
+                precision = str(reader.i32())
+            spec = '%' + match.group('flags') + width + ('.' + precision if precision is not None else '')
+            length = match.group('length') or ''
+            wide = length in ('ll', 'j')
+
+            if conv in 'di':
+                out.append((spec + 'd') % (reader.i64() if wide else reader.i32()))
+            elif conv in 'uoxX':
+                value = reader.u64() if wide else reader.u32()
+                out.append((spec + ('d' if conv == 'u' else conv)) % value)
+            elif conv == 'c':
+                out.append((spec + 'c') % (reader.u32() & 0xFF))
+            elif conv in 'fFeEgG':
+                out.append((spec + conv) % reader.f64())
+            elif conv in 'aA':
+                text = reader.f64().hex()
+                out.append(text.upper() if conv == 'A' else text)
+            elif conv == 'p':
+                out.append('0x%08x' % reader.u32())
+            elif conv == 'n':
+                reader.u32()
+            elif conv == 's':
+                if flags & FLAG_STRING_REF:
+                    address = reader.u32()
+                    text = elf.string(address)
+                    if text is None:
+                        text = '<0x%08x>' % address
+                else:
+                    text = reader.take(reader.take(1)[0]).decode('utf-8', 'replace')
+                out.append((spec + 's') % text)
+        except IndexError:
+            out.append('<?>')
+            missing = True
+    out.append(fmt[pos:])
+
+    message = ''.join(out).rstrip('\n')
+    if missing or flags & FLAG_TRUNCATED:
+        message += ' [truncated]'
+    return message
+
+
+class Decoder:
+    def __init__(self, elf):
+        self.elf = elf
+        self.expected_seq = None
+        self.last_ts = None
+        self.ts_high = 0
+
+    def timestamp_ms(self, ts):
+        # The device clock is 32 bits of microseconds, it wraps every ~71 minutes
+        if self.last_ts is not None and ts < self.last_ts:
+            self.ts_high += 1 << 32
+        self.last_ts = ts
+        return (self.ts_high + ts) // 1000
+
+    def decode(self, payload):
+        record = base64.b64decode(payload)
+        seq, ts, tag_addr, fmt_addr, level, flags, arg_len = HEADER.unpack_from(record)
+        args = record[HEADER.size:HEADER.size + arg_len]
+
+        lines = []
+        if self.expected_seq is not None and seq != self.expected_seq:
+            lost = (seq - self.expected_seq) & 0xFFFFFFFF
+            if lost < 0x80000000:
+                lines.append('--- %d deferred log records lost ---' % lost)
+        self.expected_seq = (seq + 1) & 0xFFFFFFFF
+
+        tag = self.elf.string(tag_addr) or '0x%08x' % tag_addr
+        fmt = self.elf.string(fmt_addr)
+        if fmt is None:
+            message = '<unknown format 0x%08x, wrong ELF file?>' % fmt_addr
+        else:
+            message = format_message(self.elf, fmt, flags, args)
+        lines.append('%s (%d) %s: %s' % (LEVEL_LETTERS.get(level, '?'), self.timestamp_ms(ts), tag, message))
+        return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf', help='firmware ELF file the log was produced by')
+    parser.add_argument('log', nargs='?', help='console capture, standard input if omitted')
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf))
+    source = open(args.log, 'r', errors='replace') if args.log else sys.stdin
+
+    with source:
+        for line in source:
+            index = line.find(LINE_PREFIX)
+            if index < 0:
+                sys.stdout.write(line)
+                continue
+            if index > 0:
+                sys.stdout.write(line[:index] + '\n')
+            try:
+                for decoded in decoder.decode(line[index + len(LINE_PREFIX):].strip()):
+                    print(decoded)
+            except (ValueError, struct.error) as e:
+                print('--- undecodable deferred log line (%s) ---' % e)
+            sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
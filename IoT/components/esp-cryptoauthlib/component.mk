@@ -32,6 +32,9 @@ COMPONENT_ADD_INCLUDEDIRS := $(CRYPTOAUTHLIB_DIR) $(CRYPTOAUTHLIB_DIR)/hal $(CRY
 
 # Library requires some global defines
 CFLAGS+=-DESP32 -DATCA_HAL_I2C -DATCA_USE_RTOS_TIMER -Wno-pointer-sign
+ifndef CONFIG_ATCA_ADAPTIVE_POLL
+CFLAGS+=-DATCA_NO_ADAPTIVE_POLL
+endif
 
 $(CRYPTOAUTHLIB_DIR)/hal/hal_freertos.o: CFLAGS+= -I$(IDF_PATH)/components/freertos/include/freertos
 
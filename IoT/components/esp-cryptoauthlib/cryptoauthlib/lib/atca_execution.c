@@ -8,6 +8,12 @@
  * however, by defining the ATCA_NO_POLL symbol the code will instead wait an
  * estimated max execution time before requesting the result.
  *
+ * Polling is adaptive unless ATCA_NO_ADAPTIVE_POLL is defined: the completion
+ * time of every opcode is learned, the first read is made just before the
+ * command usually completes and further reads back off from there. A device
+ * that is still busy does not acknowledge the read, so reading early only
+ * costs a short bus transaction and never disturbs the command.
+ *
  * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
  *
  * \page License
@@ -39,6 +45,11 @@
 #include "atca_devtypes.h"
 #include "hal/atca_hal.h"
 
+#if defined(ATCA_ADAPTIVE_POLL) && defined(ESP32) && !defined(ATCA_POLL_TIME_US)
+#include "esp_timer.h"
+#define ATCA_POLL_TIME_US()     ((uint32_t)esp_timer_get_time())
+#endif
+
 #ifndef ATCA_POLLING_INIT_TIME_MSEC
 #define ATCA_POLLING_INIT_TIME_MSEC       1
 #endif
@@ -51,6 +62,18 @@
 #define ATCA_POLLING_MAX_TIME_MSEC        2500
 #endif
 
+#ifndef ATCA_POLLING_MIN_TIME_USEC
+#define ATCA_POLLING_MIN_TIME_USEC        500
+#endif
+
+#ifndef ATCA_POLLING_EARLY_SHIFT
+#define ATCA_POLLING_EARLY_SHIFT          3     // First read 1/8 before the learned completion time
+#endif
+
+#ifndef ATCA_POLL_STATS_ENTRIES
+#define ATCA_POLL_STATS_ENTRIES           32
+#endif
+
 #ifdef ATCA_NO_POLL
 // *INDENT-OFF* - Preserve time formatting from the code formatter
 /*Execution times for ATSHA204A supported commands...*/
@@ -273,6 +296,194 @@ ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd)
 }
 #endif
 
+#ifdef ATCA_ADAPTIVE_POLL
+/* Opcode 0 marks a free slot, no command uses it */
+static atca_poll_stats_t atca_poll_stats[ATCA_POLL_STATS_ENTRIES];
+
+/** \brief Find or allocate the statistics slot of a command. The mode selects
+ *         what the command does (GenKey private or public key, Sign internal or
+ *         external message, 4 or 32 byte Read), so it has a slot of its own.
+ *  \param[in] opcode  Opcode value of the command
+ *  \param[in] mode    Param1 of the command
+ *  \return the slot, or NULL when all slots are taken
+ */
+static atca_poll_stats_t* atca_poll_find(uint8_t opcode, uint8_t mode)
+{
+    size_t i;
+
+    for (i = 0; i < ATCA_POLL_STATS_ENTRIES; i++)
+    {
+        if (atca_poll_stats[i].opcode == opcode && atca_poll_stats[i].mode == mode)
+        {
+            return &atca_poll_stats[i];
+        }
+        if (atca_poll_stats[i].opcode == 0)
+        {
+            atca_poll_stats[i].opcode = opcode;
+            atca_poll_stats[i].mode = mode;
+            return &atca_poll_stats[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** \brief Wait between reads. Short waits spin so they are not rounded up to
+ *         an RTOS tick, longer ones let other tasks run.
+ */
+static void atca_poll_delay_us(uint32_t delay_us)
+{
+    if (delay_us >= ATCA_POLLING_FREQUENCY_TIME_MSEC * 1000)
+    {
+        atca_delay_ms(delay_us / 1000);
+    }
+    else
+    {
+        atca_delay_us(delay_us);
+    }
+}
+
+static void atca_poll_record(atca_poll_stats_t* stats, ATCA_STATUS status, uint32_t elapsed_us)
+{
+    uint32_t elapsed_ms = elapsed_us / 1000;
+    uint8_t bucket = 0;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    if (status != ATCA_SUCCESS)
+    {
+        stats->timeouts++;
+        return;
+    }
+
+    stats->count++;
+    if (stats->typical_us == 0)
+    {
+        stats->typical_us = elapsed_us;
+    }
+    else if (elapsed_us > stats->typical_us)
+    {
+        stats->typical_us += (elapsed_us - stats->typical_us) >> 3;
+    }
+    else
+    {
+        stats->typical_us -= (stats->typical_us - elapsed_us) >> 3;
+    }
+    if (elapsed_us > stats->max_us)
+    {
+        stats->max_us = elapsed_us;
+    }
+
+    while (bucket < ATCA_POLL_HISTOGRAM_BUCKETS - 1 && elapsed_ms >= (1u << bucket))
+    {
+        bucket++;
+    }
+    stats->histogram[bucket]++;
+}
+
+/** \brief Wait for the response of a command that was just sent and read it
+ *
+ * \param[in]    iface   Interface the command was sent on
+ * \param[inout] packet  Packet that was sent, receives the response
+ * \param[out]   rxsize  Size of the response
+ *
+ * \return ATCA_SUCCESS on success, otherwise the error of the last read.
+ */
+static ATCA_STATUS atca_poll_response(ATCAIface iface, ATCAPacket* packet, uint16_t* rxsize)
+{
+    atca_poll_stats_t* stats = atca_poll_find(packet->opcode, packet->param1);
+    uint32_t backoff_us = ATCA_POLLING_MIN_TIME_USEC;
+    uint32_t waited_us = 0;
+    uint32_t elapsed_us;
+    uint32_t wait_us;
+    ATCA_STATUS status;
+
+#ifdef ATCA_POLL_TIME_US
+    uint32_t start_us = ATCA_POLL_TIME_US();
+#endif
+
+    if (stats != NULL && stats->typical_us > ATCA_POLLING_INIT_TIME_MSEC * 1000)
+    {
+        wait_us = stats->typical_us - (stats->typical_us >> ATCA_POLLING_EARLY_SHIFT);
+    }
+    else
+    {
+        wait_us = ATCA_POLLING_INIT_TIME_MSEC * 1000;
+    }
+
+    for (;; )
+    {
+        atca_poll_delay_us(wait_us);
+        waited_us += wait_us;
+
+        memset(packet->data, 0, sizeof(packet->data));
+        *rxsize = sizeof(packet->data);
+        status = atreceive(iface, packet->data, rxsize);
+
+#ifdef ATCA_POLL_TIME_US
+        elapsed_us = ATCA_POLL_TIME_US() - start_us;
+#else
+        // Without a clock the requested waits are the best estimate
+        elapsed_us = waited_us;
+#endif
+        if (status == ATCA_SUCCESS || elapsed_us >= ATCA_POLLING_MAX_TIME_MSEC * 1000)
+        {
+            break;
+        }
+
+        if (stats != NULL)
+        {
+            stats->polls++;
+        }
+        wait_us = backoff_us;
+        if (backoff_us < ATCA_POLLING_FREQUENCY_TIME_MSEC * 1000)
+        {
+            backoff_us *= 2;
+        }
+    }
+
+    atca_poll_record(stats, status, elapsed_us);
+    return status;
+}
+
+/** \brief Get the completion times observed for a command
+ *  \param[in]  opcode  Opcode value of the command
+ *  \param[in]  mode    Param1 of the command
+ *  \param[out] stats   Observed times
+ *  \return ATCA_SUCCESS, or ATCA_BAD_OPCODE when the command was not executed yet
+ */
+ATCA_STATUS atca_poll_get_stats(uint8_t opcode, uint8_t mode, atca_poll_stats_t* stats)
+{
+    size_t i;
+
+    if (stats == NULL)
+    {
+        return ATCA_BAD_PARAM;
+    }
+
+    for (i = 0; i < ATCA_POLL_STATS_ENTRIES && atca_poll_stats[i].opcode != 0; i++)
+    {
+        if (atca_poll_stats[i].opcode == opcode && atca_poll_stats[i].mode == mode)
+        {
+            *stats = atca_poll_stats[i];
+            return ATCA_SUCCESS;
+        }
+    }
+
+    return ATCA_BAD_OPCODE;
+}
+
+/** \brief Forget the learned completion times and the histograms
+ */
+void atca_poll_reset_stats(void)
+{
+    memset(atca_poll_stats, 0, sizeof(atca_poll_stats));
+}
+#endif
+
 /** \brief Wakes up device, sends the packet, waits for command completion,
  *         receives response, and puts the device into the idle state.
  *
@@ -286,8 +497,10 @@ ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd)
 ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
 {
     ATCA_STATUS status;
+#ifndef ATCA_ADAPTIVE_POLL
     uint32_t execution_or_wait_time;
     uint32_t max_delay_count;
+#endif
     uint16_t rxsize;
 
     do
@@ -299,7 +512,7 @@ ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
         }
         execution_or_wait_time = device->mCommands->execution_time_msec;
         max_delay_count = 0;
-#else
+#elif !defined(ATCA_ADAPTIVE_POLL)
         execution_or_wait_time = ATCA_POLLING_INIT_TIME_MSEC;
         max_delay_count = ATCA_POLLING_MAX_TIME_MSEC / ATCA_POLLING_FREQUENCY_TIME_MSEC;
 #endif
@@ -315,6 +528,9 @@ ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
             break;
         }
 
+#ifdef ATCA_ADAPTIVE_POLL
+        status = atca_poll_response(device->mIface, packet, &rxsize);
+#else
         // Delay for execution time or initial wait before polling
         atca_delay_ms(execution_or_wait_time);
 
@@ -334,6 +550,7 @@ ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
 #endif
         }
         while (max_delay_count-- > 0);
+#endif
         if (status != ATCA_SUCCESS)
         {
             break;
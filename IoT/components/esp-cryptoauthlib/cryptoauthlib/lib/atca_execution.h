@@ -59,6 +59,32 @@ typedef struct
 ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd);
 #endif
 
+#if !defined(ATCA_NO_POLL) && !defined(ATCA_NO_ADAPTIVE_POLL)
+#define ATCA_ADAPTIVE_POLL
+
+/** \brief Number of histogram buckets, bucket n counts completions under 2^n ms
+ *         and the last one everything slower
+ */
+#define ATCA_POLL_HISTOGRAM_BUCKETS 12
+
+/** \brief Completion times the adaptive poller observed for one opcode and mode
+ */
+typedef struct
+{
+    uint8_t  opcode;
+    uint8_t  mode;                                      //!< Param1 of the command
+    uint32_t count;                                     //!< Commands that completed
+    uint32_t timeouts;                                  //!< Commands that never answered
+    uint32_t polls;                                     //!< Reads the device refused because it was still busy
+    uint32_t typical_us;                                //!< Learned completion time, the first poll is scheduled from it
+    uint32_t max_us;                                    //!< Slowest completion
+    uint32_t histogram[ATCA_POLL_HISTOGRAM_BUCKETS];    //!< Completion times
+} atca_poll_stats_t;
+
+ATCA_STATUS atca_poll_get_stats(uint8_t opcode, uint8_t mode, atca_poll_stats_t* stats);
+void atca_poll_reset_stats(void);
+#endif
+
 ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device);
 
 #ifdef __cplusplus
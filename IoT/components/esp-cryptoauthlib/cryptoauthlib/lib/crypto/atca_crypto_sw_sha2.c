@@ -82,26 +82,8 @@ int atcac_sw_sha2_256_finish(atcac_sha2_256_ctx* ctx, uint8_t digest[ATCA_SHA2_2
 
 int atcac_sw_sha2_256(const uint8_t* data, size_t data_size, uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE])
 {
-    int ret;
-    atcac_sha2_256_ctx ctx;
-
-    ret = atcac_sw_sha2_256_init(&ctx);
-    if (ret != ATCA_SUCCESS)
-    {
-        return ret;
-    }
-
-    ret = atcac_sw_sha2_256_update(&ctx, data, data_size);
-    if (ret != ATCA_SUCCESS)
-    {
-        return ret;
-    }
-
-    ret = atcac_sw_sha2_256_finish(&ctx, digest);
-    if (ret != ATCA_SUCCESS)
-    {
-        return ret;
-    }
+    // The single call version can use the SHA peripheral on targets that have one
+    sw_sha256(data, (unsigned int)data_size, digest);
 
     return ATCA_SUCCESS;
 }
\ No newline at end of file
@@ -28,16 +28,46 @@
 #include <string.h>
 #include "sha2_routines.h"
 #include "atca_compiler.h"
+
+#ifndef SW_SHA256_NO_ACCEL
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SW_SHA256_HAVE_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define SW_SHA256_HAVE_ARMV8
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(ESP32)
+#define SW_SHA256_HAVE_ESP32
+#include "mbedtls/sha256.h"
+#endif
+#endif
+
 #define rotate_right(value, places) ((value >> places) | (value << (32 - places)))
 
+static const uint32_t sha256_k[] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+typedef void (*sw_sha256_process_fn)(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count);
+
 /**
- * \brief Processes whole blocks (64 bytes) of data.
+ * \brief Processes whole blocks (64 bytes) of data in portable C.
  *
  * \param[in] ctx          SHA256 hash context
  * \param[in] blocks       Raw blocks to be processed
  * \param[in] block_count  Number of 64-byte blocks to process
  */
-static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+static void sw_sha256_process_c(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
 {
     int i = 0;
     uint32_t block = 0;
@@ -48,17 +78,6 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
         uint8_t  w_byte[SHA256_BLOCK_SIZE * sizeof(uint32_t)];
     } w_union;
 
-    static const uint32_t k[] = {
-        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-    };
-
     // Loop through all the blocks to process
     for (block = 0; block < block_count; block++)
     {
@@ -117,7 +136,7 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
                  ^ rotate_right(rotate_register[4], 25);
             ch = (rotate_register[4] & rotate_register[5])
                  ^ (~rotate_register[4] & rotate_register[6]);
-            t1 = rotate_register[7] + s1 + ch + k[i] + w_union.w_word[i];
+            t1 = rotate_register[7] + s1 + ch + sha256_k[i] + w_union.w_word[i];
 
             rotate_register[7] = rotate_register[6];
             rotate_register[6] = rotate_register[5];
@@ -137,6 +156,214 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
     }
 }
 
+#ifdef SW_SHA256_HAVE_SHANI
+/**
+ * \brief Processes whole blocks with the x86 SHA extensions.
+ *
+ * The extensions keep the state as ABEF/CDGH register pairs, so it is
+ * reordered on entry and exit. Each pass of the round loop does four rounds
+ * and extends the message schedule by four words.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sw_sha256_process_shani(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, abef_save, cdgh_save, msg, tmp;
+    __m128i w[4];
+    int i;
+
+    tmp = _mm_loadu_si128((const __m128i*)&ctx->hash[0]);
+    state1 = _mm_loadu_si128((const __m128i*)&ctx->hash[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       // EFGH
+    state0 = _mm_alignr_epi8(tmp, state1, 8);       // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    // CDGH
+
+    for (; block_count > 0; block_count--, blocks += SHA256_BLOCK_SIZE)
+    {
+        abef_save = state0;
+        cdgh_save = state1;
+
+        for (i = 0; i < 4; i++)
+        {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&blocks[i * 16]), byte_swap);
+        }
+
+        for (i = 0; i < 16; i++)
+        {
+            msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i*)&sha256_k[i * 4]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+            if (i < 12)
+            {
+                // Words 16 and up: w[t] = s1(w[t-2]) + w[t-7] + s0(w[t-15]) + w[t-16]
+                tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+                tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+            }
+
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+
+    _mm_storeu_si128((__m128i*)&ctx->hash[0], state0);
+    _mm_storeu_si128((__m128i*)&ctx->hash[4], state1);
+}
+
+static int sw_sha256_cpu_has_shani(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    // SSSE3 and SSE4.1 for the shuffles and blends, SHA for the rounds
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1u << 9)) || !(ecx & (1u << 19)))
+    {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        return 0;
+    }
+    return (ebx & (1u << 29)) ? 1 : 0;
+}
+#endif
+
+#ifdef SW_SHA256_HAVE_ARMV8
+/**
+ * \brief Processes whole blocks with the ARMv8 cryptography extensions.
+ *
+ * Each pass of the round loop does four rounds and extends the message
+ * schedule by four words.
+ */
+static void sw_sha256_process_armv8(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+{
+    uint32x4_t state0, state1, abcd_save, efgh_save, msg, tmp;
+    uint32x4_t w[4];
+    int i;
+
+    state0 = vld1q_u32(&ctx->hash[0]);
+    state1 = vld1q_u32(&ctx->hash[4]);
+
+    for (; block_count > 0; block_count--, blocks += SHA256_BLOCK_SIZE)
+    {
+        abcd_save = state0;
+        efgh_save = state1;
+
+        for (i = 0; i < 4; i++)
+        {
+            w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&blocks[i * 16])));
+        }
+
+        for (i = 0; i < 16; i++)
+        {
+            msg = vaddq_u32(w[i & 3], vld1q_u32(&sha256_k[i * 4]));
+
+            if (i < 12)
+            {
+                w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3], w[(i + 3) & 3]);
+            }
+
+            tmp = state0;
+            state0 = vsha256hq_u32(state0, state1, msg);
+            state1 = vsha256h2q_u32(state1, tmp, msg);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(&ctx->hash[0], state0);
+    vst1q_u32(&ctx->hash[4], state1);
+}
+#endif
+
+static sw_sha256_process_fn sw_sha256_active_process = NULL;
+
+/** \brief Selects the block function used by all software SHA256 contexts
+ *
+ * The CPU is probed once; later calls only switch between the implementations
+ * found. Contexts that are in progress may be switched, they all keep the
+ * same state format.
+ *
+ * \param[in] impl  Implementation to use. If the CPU does not support it, or
+ *                  for SW_SHA256_IMPL_AUTO, the fastest supported one is used.
+ * \return The implementation now in use
+ */
+sw_sha256_impl sw_sha256_set_impl(sw_sha256_impl impl)
+{
+    static int probed = 0;
+    static int have_shani = 0;
+    static int have_armv8 = 0;
+
+    if (!probed)
+    {
+#ifdef SW_SHA256_HAVE_SHANI
+        have_shani = sw_sha256_cpu_has_shani();
+#endif
+#ifdef SW_SHA256_HAVE_ARMV8
+        have_armv8 = (getauxval(AT_HWCAP) & HWCAP_SHA2) ? 1 : 0;
+#endif
+        probed = 1;
+    }
+
+    if ((SW_SHA256_IMPL_SHANI == impl && !have_shani) || (SW_SHA256_IMPL_ARMV8 == impl && !have_armv8))
+    {
+        impl = SW_SHA256_IMPL_AUTO;
+    }
+    if (SW_SHA256_IMPL_AUTO == impl)
+    {
+        impl = have_shani ? SW_SHA256_IMPL_SHANI : have_armv8 ? SW_SHA256_IMPL_ARMV8 : SW_SHA256_IMPL_C;
+    }
+
+    switch (impl)
+    {
+#ifdef SW_SHA256_HAVE_SHANI
+    case SW_SHA256_IMPL_SHANI:
+        sw_sha256_active_process = sw_sha256_process_shani;
+        break;
+#endif
+#ifdef SW_SHA256_HAVE_ARMV8
+    case SW_SHA256_IMPL_ARMV8:
+        sw_sha256_active_process = sw_sha256_process_armv8;
+        break;
+#endif
+    default:
+        impl = SW_SHA256_IMPL_C;
+        sw_sha256_active_process = sw_sha256_process_c;
+        break;
+    }
+
+    return impl;
+}
+
+/**
+ * \brief Processes whole blocks (64 bytes) of data with the selected implementation.
+ *
+ * \param[in] ctx          SHA256 hash context
+ * \param[in] blocks       Raw blocks to be processed
+ * \param[in] block_count  Number of 64-byte blocks to process
+ */
+static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+{
+    if (block_count == 0)
+    {
+        return;
+    }
+    if (sw_sha256_active_process == NULL)
+    {
+        sw_sha256_set_impl(SW_SHA256_IMPL_AUTO);
+    }
+    sw_sha256_active_process(ctx, blocks, block_count);
+}
+
 /**
  * \brief Intialize the software SHA256.
  *
@@ -251,6 +478,14 @@ void sw_sha256(const uint8_t* message, unsigned int len, uint8_t digest[SHA256_D
 {
     sw_sha256_ctx ctx;
 
+#ifdef SW_SHA256_HAVE_ESP32
+    // Uses the SHA peripheral when it is free, mbedtls falls back to software otherwise
+    if (mbedtls_sha256_ret(message, len, digest, 0) == 0)
+    {
+        return;
+    }
+#endif
+
     sw_sha256_init(&ctx);
     sw_sha256_update(&ctx, message, len);
     sw_sha256_final(&ctx, digest);
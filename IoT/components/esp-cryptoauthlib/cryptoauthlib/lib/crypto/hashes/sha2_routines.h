@@ -37,6 +37,24 @@
 extern "C" {
 #endif
 
+/** \brief Block function used by the software SHA256
+ *
+ * The portable C code runs everywhere. On Linux hosts the SHA extensions of
+ * the CPU are used when it has them: SHA-NI on x86 and the cryptography
+ * extensions on ARMv8 (the latter only when built with +crypto or +sha2).
+ * On the ESP32, sw_sha256() hands the whole message to the SHA peripheral
+ * through mbedtls instead; the streaming functions stay on the C code there
+ * because the peripheral cannot resume from a saved hash state.
+ * Define SW_SHA256_NO_ACCEL to build the C code only.
+ */
+typedef enum
+{
+    SW_SHA256_IMPL_AUTO = 0,    //!< Fastest implementation the CPU supports
+    SW_SHA256_IMPL_C,           //!< Portable C
+    SW_SHA256_IMPL_SHANI,       //!< x86 SHA extensions
+    SW_SHA256_IMPL_ARMV8        //!< ARMv8 cryptography extensions
+} sw_sha256_impl;
+
 typedef struct
 {
     uint32_t total_msg_size;                //!< Total number of message bytes processed
@@ -53,6 +71,8 @@ void sw_sha256_final(sw_sha256_ctx * ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
 
 void sw_sha256(const uint8_t * message, unsigned int len, uint8_t digest[SHA256_DIGEST_SIZE]);
 
+sw_sha256_impl sw_sha256_set_impl(sw_sha256_impl impl);
+
 #ifdef __cplusplus
 }
 #endif
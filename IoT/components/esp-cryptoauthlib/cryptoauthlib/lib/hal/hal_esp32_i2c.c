@@ -51,6 +51,8 @@ ATCA_STATUS hal_i2c_init(void *hal, ATCAIfaceCfg *cfg)
     if (i2c_device_bus == NULL) {
         return ATCA_COMM_FAIL;
     } else {
+        // Commands run for up to ~100 ms, touch and the PMU go first while they do
+        i2c_device_set_priority(i2c_device_bus, I2C_DEVICE_PRIORITY_LOW);
         return ATCA_SUCCESS;
     }
 }
@@ -74,7 +76,7 @@ ATCA_STATUS hal_i2c_send(ATCAIface iface, uint8_t *txdata, int txlength)
     (void)i2c_master_write(cmd, txdata, txlength, ACK_CHECK_EN);
     (void)i2c_master_stop(cmd);
 
-    rc = i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+    rc = i2c_device_exec(i2c_device_bus, &cmd, 1);
 
     (void)i2c_cmd_link_delete(cmd);
 
@@ -93,17 +95,21 @@ ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t *rxdata, uint16_t *rxlength
     int high = 0;
     int low = 0;
 
+    // The length byte decides how the read continues, nobody else may use the bus in between
+    i2c_apply_bus(i2c_device_bus);
+
     cmd = i2c_cmd_link_create();
     (void)i2c_master_start(cmd);
     (void)i2c_master_write_byte(cmd, cfg->atcai2c.slave_address | I2C_MASTER_READ, ACK_CHECK_EN);
     (void)i2c_master_read_byte(cmd, rxdata, ACK_VAL);
 
-    rc = i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+    rc = i2c_device_exec(i2c_device_bus, &cmd, 1);
 
     (void)i2c_cmd_link_delete(cmd);
 
     if (ESP_OK != rc)
     {
+        i2c_free_bus(i2c_device_bus);
         return ATCA_COMM_FAIL;
     }
 
@@ -118,16 +124,17 @@ ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t *rxdata, uint16_t *rxlength
         }
         (void)i2c_master_read_byte(cmd, rxdata + (*rxlength) - 1, NACK_VAL);
         (void)i2c_master_stop(cmd);
-        rc = i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+        rc = i2c_device_exec(i2c_device_bus, &cmd, 1);
         (void)i2c_cmd_link_delete(cmd);
     }
     else
     {
         cmd = i2c_cmd_link_create();
         (void)i2c_master_stop(cmd);
-        rc = i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+        rc = i2c_device_exec(i2c_device_bus, &cmd, 1);
         (void)i2c_cmd_link_delete(cmd);
     }
+    i2c_free_bus(i2c_device_bus);
 
 //    ESP_LOG_BUFFER_HEX(TAG, rxdata, *rxlength);
 
@@ -154,7 +161,6 @@ ATCA_STATUS hal_i2c_wake(ATCAIface iface)
     uint16_t rxlen;
     uint8_t data[4] = { 0 };
     const uint8_t expected[4] = { 0x04, 0x11, 0x33, 0x43 };
-    i2c_apply_bus(i2c_device_bus);
 //    if (bdrt != 100000) {
 //        hal_i2c_change_baud(iface, 100000);
 //    }
@@ -165,7 +171,7 @@ ATCA_STATUS hal_i2c_wake(ATCAIface iface)
     (void)i2c_master_start(cmd);
     (void)i2c_master_write_byte(cmd, I2C_MASTER_WRITE, ACK_CHECK_DIS);
     (void)i2c_master_stop(cmd);
-    (void)i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+    (void)i2c_device_exec(i2c_device_bus, &cmd, 1);
     (void)i2c_cmd_link_delete(cmd);
 
     atca_delay_ms(10);   // wait tWHI + tWLO which is configured based on device type and configuration structure
@@ -190,9 +196,8 @@ ATCA_STATUS hal_i2c_idle(ATCAIface iface)
     (void)i2c_master_write_byte(cmd, cfg->atcai2c.slave_address | I2C_MASTER_WRITE, ACK_CHECK_EN);
     (void)i2c_master_write(cmd, &idle_data, 1, ACK_CHECK_DIS);
     (void)i2c_master_stop(cmd);
-    (void)i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+    (void)i2c_device_exec(i2c_device_bus, &cmd, 1);
     (void)i2c_cmd_link_delete(cmd);
-    i2c_free_bus(i2c_device_bus);
     return ATCA_SUCCESS;
 }
 
@@ -207,7 +212,7 @@ ATCA_STATUS hal_i2c_sleep(ATCAIface iface)
     (void)i2c_master_write_byte(cmd, cfg->atcai2c.slave_address | I2C_MASTER_WRITE, ACK_CHECK_EN);
     (void)i2c_master_write(cmd, &sleep_data, 1, ACK_CHECK_DIS);
     (void)i2c_master_stop(cmd);
-    (void)i2c_master_cmd_begin(cfg->atcai2c.bus, cmd, 10);
+    (void)i2c_device_exec(i2c_device_bus, &cmd, 1);
     (void)i2c_cmd_link_delete(cmd);
 
     return ATCA_SUCCESS;
@@ -0,0 +1,235 @@
+/**
+ * \file
+ * \brief Throughput and latency of the software SHA256 implementations.
+ *
+ * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "crypto/hashes/sha2_routines.h"
+
+#define BENCH_MAX_SIZE      (16 * 1024)
+#define BENCH_LATENCY_RUNS  (1001)
+
+static const char* impl_names[] = { "auto", "c", "sha-ni", "armv8" };
+
+static const size_t bench_sizes[] = { 64, 256, 1024, 4096, 16384 };
+
+typedef struct
+{
+    const char* message;
+    const char* digest;
+} known_answer;
+
+/* FIPS 180-2 examples */
+static const known_answer known_answers[] = {
+    { "",
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc",
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void to_hex(const uint8_t* bytes, size_t len, char* hex)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        sprintf(&hex[i * 2], "%02x", bytes[i]);
+    }
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+
+    return (da > db) - (da < db);
+}
+
+/* Known answers, then random messages against the C code, whole and in random pieces */
+static int verify_impl(sw_sha256_impl impl, const uint8_t* data)
+{
+    uint8_t expected[SHA256_DIGEST_SIZE];
+    uint8_t actual[SHA256_DIGEST_SIZE];
+    char hex[SHA256_DIGEST_SIZE * 2 + 1];
+    sw_sha256_ctx ctx;
+    size_t i;
+    size_t len;
+    size_t pos;
+    size_t piece;
+
+    sw_sha256_set_impl(impl);
+    for (i = 0; i < sizeof(known_answers) / sizeof(known_answers[0]); i++)
+    {
+        sw_sha256((const uint8_t*)known_answers[i].message, (unsigned int)strlen(known_answers[i].message), actual);
+        to_hex(actual, sizeof(actual), hex);
+        if (strcmp(hex, known_answers[i].digest) != 0)
+        {
+            printf("%s: wrong digest for \"%s\"\n", impl_names[impl], known_answers[i].message);
+            return 0;
+        }
+    }
+
+    for (len = 0; len < 1200; len += 1 + len / 8)
+    {
+        sw_sha256_set_impl(SW_SHA256_IMPL_C);
+        sw_sha256(data, (unsigned int)len, expected);
+
+        sw_sha256_set_impl(impl);
+        sw_sha256_init(&ctx);
+        for (pos = 0; pos < len; pos += piece)
+        {
+            piece = (size_t)(rand() % 150);
+            if (piece > len - pos)
+            {
+                piece = len - pos;
+            }
+            sw_sha256_update(&ctx, &data[pos], (uint32_t)piece);
+        }
+        sw_sha256_final(&ctx, actual);
+
+        if (memcmp(expected, actual, sizeof(expected)) != 0)
+        {
+            printf("%s: digest of %u bytes differs from the C code\n", impl_names[impl], (unsigned int)len);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void bench_impl(sw_sha256_impl impl, const uint8_t* data, double min_seconds)
+{
+    static double samples[BENCH_LATENCY_RUNS];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    volatile uint8_t sink = 0;
+    size_t s;
+    unsigned long calls;
+    unsigned long batch;
+    unsigned long i;
+    double start;
+    double elapsed;
+
+    sw_sha256_set_impl(impl);
+
+    for (s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++)
+    {
+        size_t size = bench_sizes[s];
+
+        /* Latency: median of single calls, warm cache */
+        sw_sha256(data, (unsigned int)size, digest);
+        for (i = 0; i < BENCH_LATENCY_RUNS; i++)
+        {
+            start = now_ns();
+            sw_sha256(data, (unsigned int)size, digest);
+            samples[i] = now_ns() - start;
+            sink ^= digest[0];
+        }
+        qsort(samples, BENCH_LATENCY_RUNS, sizeof(samples[0]), compare_doubles);
+
+        /* Throughput: back to back calls for at least min_seconds */
+        calls = 0;
+        batch = 1 + (unsigned long)(1024 * 1024 / size);
+        start = now_ns();
+        do
+        {
+            for (i = 0; i < batch; i++)
+            {
+                sw_sha256(data, (unsigned int)size, digest);
+                sink ^= digest[0];
+            }
+            calls += batch;
+            elapsed = now_ns() - start;
+        }
+        while (elapsed < min_seconds * 1e9);
+
+        printf("%-8s %8u %10.1f %12.0f %12.0f\n", impl_names[impl], (unsigned int)size,
+               (double)size * calls / elapsed * 1e3, samples[BENCH_LATENCY_RUNS / 2],
+               samples[BENCH_LATENCY_RUNS * 99 / 100]);
+    }
+    (void)sink;
+}
+
+int main(int argc, char** argv)
+{
+    static uint8_t data[BENCH_MAX_SIZE];
+    double min_seconds = 0.5;
+    sw_sha256_impl impl;
+    size_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            min_seconds = strtod(optarg, NULL);
+            break;
+        default:
+            printf("usage: %s [-t seconds per size]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    srand(1);
+    for (i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)rand();
+    }
+
+    printf("software SHA256 benchmark, default implementation on this CPU: %s\n",
+           impl_names[sw_sha256_set_impl(SW_SHA256_IMPL_AUTO)]);
+    printf("%-8s %8s %10s %12s %12s\n", "impl", "bytes", "MB/s", "median ns", "p99 ns");
+
+    for (impl = SW_SHA256_IMPL_C; impl <= SW_SHA256_IMPL_ARMV8; impl++)
+    {
+        if (sw_sha256_set_impl(impl) != impl)
+        {
+            printf("%-8s %8s\n", impl_names[impl], "n/a");
+            continue;
+        }
+        if (!verify_impl(impl, data))
+        {
+            return 1;
+        }
+        bench_impl(impl, data, min_seconds);
+    }
+
+    return 0;
+}
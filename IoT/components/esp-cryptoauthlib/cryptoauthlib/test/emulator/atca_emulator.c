@@ -0,0 +1,954 @@
+/**
+ * \file
+ * \brief Software ATECC608A for host builds.
+ *
+ * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rand.h>
+
+#include "cryptoauthlib.h"
+#include "atcacert/atcacert_def.h"
+#include "crypto/atca_crypto_sw_sha2.h"
+#include "tngtls_cert_def_2_device.h"
+#include "atca_emulator.h"
+
+/* Response status codes of the device */
+#define EMU_STATUS_SUCCESS      0x00
+#define EMU_STATUS_MISCOMPARE   0x01
+#define EMU_STATUS_PARSE_ERROR  0x03
+#define EMU_STATUS_EXEC_ERROR   0x0F
+
+#define EMU_CONFIG_SIZE         128
+#define EMU_OTP_SIZE            64
+#define EMU_SLOT_COUNT          16
+#define EMU_SLOT_MAX_SIZE       416
+
+/* TNG-TLS layout */
+#define EMU_TNG_PRIMARY_KEY_SLOT    0
+#define EMU_TNG_DEVICE_CERT_SLOT    10
+#define EMU_TNG_SIGNER_KEY_SLOT     11
+
+/* tWLO + tWHI of the wake pulse */
+#define EMU_WAKE_US             1560
+
+typedef struct
+{
+    uint32_t typical_us;
+    uint32_t jitter_us;
+} emu_latency_t;
+
+typedef struct
+{
+    uint8_t  config[EMU_CONFIG_SIZE];
+    uint8_t  otp[EMU_OTP_SIZE];
+    uint8_t  data[EMU_SLOT_COUNT][EMU_SLOT_MAX_SIZE];
+    uint8_t  private_key[EMU_SLOT_COUNT][ATCA_KEY_SIZE];
+    bool     has_private_key[EMU_SLOT_COUNT];
+
+    uint8_t  tempkey[64];
+    bool     tempkey_valid;
+    uint8_t  msg_digest[64];
+    bool     msg_digest_valid;
+
+    uint8_t  response[ATCA_RSP_SIZE_MAX];
+    size_t   response_size;
+    uint64_t ready_us;          // Time the response of the last command becomes readable
+
+    emu_latency_t latency[256];
+    uint32_t      failures[256];    // Commands still to fail, by opcode
+    uint32_t      latency_scale;
+    uint32_t      bus_hz;
+
+    atca_emulator_stats_t stats;
+} atca_emulator_t;
+
+static atca_emulator_t emu;
+static bool emu_initialized;
+
+// *INDENT-OFF* - Preserve time formatting from the code formatter
+/* Maximum execution times of the ATECC608A-M0 in ms, the typical time is modeled as half of it */
+static const struct
+{
+    uint8_t  opcode;
+    uint16_t max_ms;
+} emu_default_latency[] = {
+    { ATCA_AES,          27 },
+    { ATCA_CHECKMAC,     40 },
+    { ATCA_COUNTER,      25 },
+    { ATCA_DERIVE_KEY,   50 },
+    { ATCA_ECDH,         75 },
+    { ATCA_GENDIG,       25 },
+    { ATCA_GENKEY,       115 },
+    { ATCA_INFO,         5 },
+    { ATCA_KDF,          165 },
+    { ATCA_LOCK,         35 },
+    { ATCA_MAC,          55 },
+    { ATCA_NONCE,        20 },
+    { ATCA_PRIVWRITE,    50 },
+    { ATCA_RANDOM,       23 },
+    { ATCA_READ,         5 },
+    { ATCA_SECUREBOOT,   80 },
+    { ATCA_SELFTEST,     250 },
+    { ATCA_SHA,          36 },
+    { ATCA_SIGN,         115 },
+    { ATCA_UPDATE_EXTRA, 10 },
+    { ATCA_VERIFY,       105 },
+    { ATCA_WRITE,        45 }
+};
+// *INDENT-ON*
+
+static uint64_t emu_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void emu_busy_wait_us(uint64_t delay_us)
+{
+    uint64_t end = emu_now_us() + delay_us;
+
+    while (emu_now_us() < end)
+    {
+    }
+}
+
+/* Nine clocks per byte including the acknowledge */
+static void emu_bus_transfer(size_t bytes)
+{
+    if (emu.bus_hz != 0)
+    {
+        emu_busy_wait_us((uint64_t)bytes * 9u * 1000000u / emu.bus_hz);
+    }
+}
+
+static size_t emu_slot_size(uint8_t slot)
+{
+    if (slot < 8)
+    {
+        return 36;
+    }
+    return (slot == 8) ? EMU_SLOT_MAX_SIZE : 72;
+}
+
+/*
+ * P-256 with OpenSSL
+ */
+
+static EC_GROUP* emu_group(void)
+{
+    static EC_GROUP* group;
+
+    if (group == NULL)
+    {
+        group = EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1);
+    }
+    return group;
+}
+
+static int emu_bn_to_bytes(const BIGNUM* bn, uint8_t* out)
+{
+    return BN_bn2binpad(bn, out, ATCA_KEY_SIZE) == ATCA_KEY_SIZE;
+}
+
+static EC_POINT* emu_point_from_public_key(const uint8_t* public_key)
+{
+    EC_POINT* point = EC_POINT_new(emu_group());
+    BIGNUM* x = BN_bin2bn(public_key, ATCA_KEY_SIZE, NULL);
+    BIGNUM* y = BN_bin2bn(public_key + ATCA_KEY_SIZE, ATCA_KEY_SIZE, NULL);
+
+    if (point == NULL || x == NULL || y == NULL ||
+        EC_POINT_set_affine_coordinates(emu_group(), point, x, y, NULL) != 1)
+    {
+        EC_POINT_free(point);
+        point = NULL;
+    }
+    BN_free(x);
+    BN_free(y);
+    return point;
+}
+
+static int emu_point_to_public_key(const EC_POINT* point, uint8_t* public_key)
+{
+    BIGNUM* x = BN_new();
+    BIGNUM* y = BN_new();
+    int ok = x != NULL && y != NULL &&
+             EC_POINT_get_affine_coordinates(emu_group(), point, x, y, NULL) == 1 &&
+             emu_bn_to_bytes(x, public_key) && emu_bn_to_bytes(y, public_key + ATCA_KEY_SIZE);
+
+    BN_free(x);
+    BN_free(y);
+    return ok;
+}
+
+static EC_KEY* emu_key_from_private_key(const uint8_t* private_key)
+{
+    EC_KEY* key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    BIGNUM* d = BN_bin2bn(private_key, ATCA_KEY_SIZE, NULL);
+
+    if (key == NULL || d == NULL || EC_KEY_set_private_key(key, d) != 1)
+    {
+        EC_KEY_free(key);
+        key = NULL;
+    }
+    BN_free(d);
+    return key;
+}
+
+static ATCA_STATUS emu_public_key(const uint8_t* private_key, uint8_t* public_key)
+{
+    EC_POINT* point = EC_POINT_new(emu_group());
+    BIGNUM* d = BN_bin2bn(private_key, ATCA_KEY_SIZE, NULL);
+    int ok = point != NULL && d != NULL &&
+             EC_POINT_mul(emu_group(), point, d, NULL, NULL, NULL) == 1 &&
+             emu_point_to_public_key(point, public_key);
+
+    EC_POINT_free(point);
+    BN_clear_free(d);
+    return ok ? ATCA_SUCCESS : ATCA_GEN_FAIL;
+}
+
+ATCA_STATUS atca_emulator_sw_genkey(uint8_t* private_key, uint8_t* public_key)
+{
+    BIGNUM* d = BN_new();
+    int ok = d != NULL &&
+             BN_priv_rand_range(d, EC_GROUP_get0_order(emu_group())) == 1 &&
+             !BN_is_zero(d) &&
+             emu_bn_to_bytes(d, private_key);
+
+    BN_clear_free(d);
+    if (!ok)
+    {
+        return ATCA_GEN_FAIL;
+    }
+    return public_key != NULL ? emu_public_key(private_key, public_key) : ATCA_SUCCESS;
+}
+
+ATCA_STATUS atca_emulator_sw_sign(const uint8_t* private_key, const uint8_t* digest, uint8_t* signature)
+{
+    EC_KEY* key = emu_key_from_private_key(private_key);
+    ECDSA_SIG* sig = key != NULL ? ECDSA_do_sign(digest, ATCA_SHA_DIGEST_SIZE, key) : NULL;
+    const BIGNUM* r;
+    const BIGNUM* s;
+    int ok = 0;
+
+    if (sig != NULL)
+    {
+        ECDSA_SIG_get0(sig, &r, &s);
+        ok = emu_bn_to_bytes(r, signature) && emu_bn_to_bytes(s, signature + ATCA_KEY_SIZE);
+    }
+    ECDSA_SIG_free(sig);
+    EC_KEY_free(key);
+    return ok ? ATCA_SUCCESS : ATCA_GEN_FAIL;
+}
+
+ATCA_STATUS atca_emulator_sw_verify(const uint8_t* public_key, const uint8_t* digest, const uint8_t* signature, bool* is_verified)
+{
+    EC_KEY* key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    EC_POINT* point = emu_point_from_public_key(public_key);
+    ECDSA_SIG* sig = ECDSA_SIG_new();
+    BIGNUM* r = BN_bin2bn(signature, ATCA_KEY_SIZE, NULL);
+    BIGNUM* s = BN_bin2bn(signature + ATCA_KEY_SIZE, ATCA_KEY_SIZE, NULL);
+    ATCA_STATUS status = ATCA_BAD_PARAM;
+
+    *is_verified = false;
+    if (key != NULL && point != NULL && sig != NULL && r != NULL && s != NULL &&
+        EC_KEY_set_public_key(key, point) == 1 && ECDSA_SIG_set0(sig, r, s) == 1)
+    {
+        r = s = NULL;   // Owned by sig now
+        *is_verified = ECDSA_do_verify(digest, ATCA_SHA_DIGEST_SIZE, sig, key) == 1;
+        status = ATCA_SUCCESS;
+    }
+    BN_free(r);
+    BN_free(s);
+    ECDSA_SIG_free(sig);
+    EC_POINT_free(point);
+    EC_KEY_free(key);
+    return status;
+}
+
+ATCA_STATUS atca_emulator_sw_ecdh(const uint8_t* private_key, const uint8_t* public_key, uint8_t* pms)
+{
+    EC_POINT* peer = emu_point_from_public_key(public_key);
+    EC_POINT* shared = EC_POINT_new(emu_group());
+    BIGNUM* d = BN_bin2bn(private_key, ATCA_KEY_SIZE, NULL);
+    uint8_t shared_key[ATCA_PUB_KEY_SIZE];
+    int ok = peer != NULL && shared != NULL && d != NULL &&
+             EC_POINT_mul(emu_group(), shared, NULL, peer, d, NULL) == 1 &&
+             emu_point_to_public_key(shared, shared_key);
+
+    if (ok)
+    {
+        // The premaster secret is the X coordinate of the shared point
+        memcpy(pms, shared_key, ATCA_KEY_SIZE);
+    }
+    EC_POINT_free(peer);
+    EC_POINT_free(shared);
+    BN_clear_free(d);
+    return ok ? ATCA_SUCCESS : ATCA_BAD_PARAM;
+}
+
+/*
+ * Commands
+ */
+
+static void emu_respond(const uint8_t* data, size_t data_size)
+{
+    emu.response[ATCA_COUNT_IDX] = (uint8_t)(data_size + ATCA_PACKET_OVERHEAD);
+    memcpy(&emu.response[ATCA_RSP_DATA_IDX], data, data_size);
+    atCRC(data_size + ATCA_COUNT_SIZE, emu.response, &emu.response[data_size + ATCA_COUNT_SIZE]);
+    emu.response_size = data_size + ATCA_PACKET_OVERHEAD;
+}
+
+static void emu_respond_status(uint8_t status)
+{
+    if (status != EMU_STATUS_SUCCESS)
+    {
+        emu.stats.errors++;
+    }
+    emu_respond(&status, 1);
+}
+
+/* Byte offset and size of a Read/Write access, or NULL when it is out of range */
+static uint8_t* emu_zone_access(uint8_t param1, uint16_t address, size_t* size, int* slot)
+{
+    size_t offset;
+
+    *size = (param1 & ATCA_ZONE_READWRITE_32) ? ATCA_BLOCK_SIZE : ATCA_WORD_SIZE;
+    *slot = -1;
+
+    switch (param1 & ATCA_ZONE_MASK)
+    {
+    case ATCA_ZONE_CONFIG:
+        offset = ((address >> 3) & 0x1F) * ATCA_BLOCK_SIZE + (address & 0x07) * ATCA_WORD_SIZE;
+        return (offset + *size <= EMU_CONFIG_SIZE) ? &emu.config[offset] : NULL;
+
+    case ATCA_ZONE_OTP:
+        offset = ((address >> 3) & 0x1F) * ATCA_BLOCK_SIZE + (address & 0x07) * ATCA_WORD_SIZE;
+        return (offset + *size <= EMU_OTP_SIZE) ? &emu.otp[offset] : NULL;
+
+    case ATCA_ZONE_DATA:
+        *slot = (address >> 3) & 0x0F;
+        offset = (address >> 8) * ATCA_BLOCK_SIZE + (address & 0x07) * ATCA_WORD_SIZE;
+        return (offset + *size <= emu_slot_size((uint8_t)*slot)) ? &emu.data[*slot][offset] : NULL;
+
+    default:
+        return NULL;
+    }
+}
+
+static void emu_cmd_read(uint8_t param1, uint16_t param2)
+{
+    size_t size;
+    int slot;
+    uint8_t* mem = emu_zone_access(param1, param2, &size, &slot);
+    size_t offset;
+
+    if (mem == NULL && slot >= 0 && size == ATCA_BLOCK_SIZE)
+    {
+        // atcab_read_pubkey() reads the last block of a 72 byte slot as a whole, the bytes past
+        // the end of the slot are never written and read as zeros
+        offset = (param2 >> 8) * ATCA_BLOCK_SIZE;
+        if (offset < emu_slot_size((uint8_t)slot) && offset + size <= EMU_SLOT_MAX_SIZE)
+        {
+            mem = &emu.data[slot][offset];
+        }
+    }
+
+    if (mem == NULL)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+    }
+    else if (slot >= 0 && emu.has_private_key[slot])
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+    }
+    else
+    {
+        emu_respond(mem, size);
+    }
+}
+
+static void emu_cmd_write(uint8_t param1, uint16_t param2, const uint8_t* data, size_t data_size)
+{
+    size_t size;
+    int slot;
+    uint8_t* mem = emu_zone_access(param1, param2, &size, &slot);
+
+    // Only unencrypted writes to data slots without a private key are emulated
+    if (mem == NULL || slot < 0 || data_size < size || (param1 & ATCA_ZONE_ENCRYPTED))
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+    }
+    else if (emu.has_private_key[slot])
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+    }
+    else
+    {
+        memcpy(mem, data, size);
+        emu_respond_status(EMU_STATUS_SUCCESS);
+    }
+}
+
+static void emu_cmd_info(uint8_t param1)
+{
+    uint8_t info[4] = { 0 };
+
+    if (param1 == INFO_MODE_REVISION)
+    {
+        memcpy(info, &emu.config[4], sizeof(info));
+    }
+    emu_respond(info, sizeof(info));
+}
+
+static void emu_cmd_random(void)
+{
+    uint8_t random[RANDOM_NUM_SIZE];
+
+    RAND_bytes(random, sizeof(random));
+    emu_respond(random, sizeof(random));
+}
+
+static void emu_cmd_nonce(uint8_t param1, uint16_t param2, const uint8_t* data, size_t data_size)
+{
+    uint8_t msg[RANDOM_NUM_SIZE + NONCE_NUMIN_SIZE + 3];
+    uint8_t random[RANDOM_NUM_SIZE];
+    size_t input_size;
+    uint8_t* target;
+    bool* target_valid;
+
+    if ((param1 & NONCE_MODE_MASK) == NONCE_MODE_PASSTHROUGH)
+    {
+        input_size = (param1 & NONCE_MODE_INPUT_LEN_64) ? 64 : 32;
+        if (data_size < input_size)
+        {
+            emu_respond_status(EMU_STATUS_PARSE_ERROR);
+            return;
+        }
+        switch (param1 & NONCE_MODE_TARGET_MASK)
+        {
+        case NONCE_MODE_TARGET_TEMPKEY:
+            target = emu.tempkey;
+            target_valid = &emu.tempkey_valid;
+            break;
+        case NONCE_MODE_TARGET_MSGDIGBUF:
+            target = emu.msg_digest;
+            target_valid = &emu.msg_digest_valid;
+            break;
+        default:
+            emu_respond_status(EMU_STATUS_PARSE_ERROR);
+            return;
+        }
+        memcpy(target, data, input_size);
+        *target_valid = true;
+        emu_respond_status(EMU_STATUS_SUCCESS);
+        return;
+    }
+
+    if ((param1 & NONCE_MODE_MASK) == NONCE_MODE_INVALID || data_size < NONCE_NUMIN_SIZE)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+
+    // TempKey = SHA256(RandOut, NumIn, Opcode, Mode, LSB of Param2)
+    RAND_bytes(random, sizeof(random));
+    memcpy(msg, random, RANDOM_NUM_SIZE);
+    memcpy(&msg[RANDOM_NUM_SIZE], data, NONCE_NUMIN_SIZE);
+    msg[RANDOM_NUM_SIZE + NONCE_NUMIN_SIZE] = ATCA_NONCE;
+    msg[RANDOM_NUM_SIZE + NONCE_NUMIN_SIZE + 1] = param1;
+    msg[RANDOM_NUM_SIZE + NONCE_NUMIN_SIZE + 2] = (uint8_t)param2;
+    atcac_sw_sha2_256(msg, sizeof(msg), emu.tempkey);
+    emu.tempkey_valid = true;
+    emu_respond(random, sizeof(random));
+}
+
+static void emu_cmd_genkey(uint8_t param1, uint16_t param2)
+{
+    uint8_t public_key[ATCA_PUB_KEY_SIZE];
+    uint16_t slot = param2;
+
+    if (slot >= EMU_SLOT_COUNT || (param1 & ~GENKEY_MODE_PRIVATE) != 0)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+
+    if (param1 & GENKEY_MODE_PRIVATE)
+    {
+        if (atca_emulator_sw_genkey(emu.private_key[slot], public_key) != ATCA_SUCCESS)
+        {
+            emu_respond_status(EMU_STATUS_EXEC_ERROR);
+            return;
+        }
+        emu.has_private_key[slot] = true;
+    }
+    else if (!emu.has_private_key[slot] || emu_public_key(emu.private_key[slot], public_key) != ATCA_SUCCESS)
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+        return;
+    }
+
+    emu_respond(public_key, sizeof(public_key));
+}
+
+static const uint8_t* emu_message(uint8_t source_mask_bit)
+{
+    if (source_mask_bit)
+    {
+        return emu.msg_digest_valid ? emu.msg_digest : NULL;
+    }
+    return emu.tempkey_valid ? emu.tempkey : NULL;
+}
+
+static void emu_cmd_sign(uint8_t param1, uint16_t param2)
+{
+    uint8_t signature[ATCA_SIG_SIZE];
+    const uint8_t* message = emu_message(param1 & SIGN_MODE_SOURCE_MSGDIGBUF);
+
+    // Only the external message mode is emulated
+    if ((param1 & SIGN_MODE_EXTERNAL) == 0 || param2 >= EMU_SLOT_COUNT)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+    if (message == NULL || !emu.has_private_key[param2] ||
+        atca_emulator_sw_sign(emu.private_key[param2], message, signature) != ATCA_SUCCESS)
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+        return;
+    }
+
+    emu.tempkey_valid = false;
+    emu_respond(signature, sizeof(signature));
+}
+
+static void emu_cmd_verify(uint8_t param1, uint16_t param2, const uint8_t* data, size_t data_size)
+{
+    const uint8_t* message = emu_message(param1 & VERIFY_MODE_SOURCE_MSGDIGBUF);
+    bool is_verified = false;
+
+    if ((param1 & VERIFY_MODE_MASK) != VERIFY_MODE_EXTERNAL || param2 != VERIFY_KEY_P256 ||
+        data_size < ATCA_SIG_SIZE + ATCA_PUB_KEY_SIZE)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+    if (message == NULL ||
+        atca_emulator_sw_verify(&data[ATCA_SIG_SIZE], message, data, &is_verified) != ATCA_SUCCESS)
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+        return;
+    }
+
+    emu.tempkey_valid = false;
+    emu_respond_status(is_verified ? EMU_STATUS_SUCCESS : EMU_STATUS_MISCOMPARE);
+}
+
+static void emu_cmd_ecdh(uint8_t param1, uint16_t param2, const uint8_t* data, size_t data_size)
+{
+    uint8_t pms[ATCA_KEY_SIZE];
+
+    // Slot key in, premaster secret out in the clear or into TempKey
+    if ((param1 & ECDH_MODE_SOURCE_MASK) != ECDH_MODE_SOURCE_EEPROM_SLOT ||
+        (param1 & ECDH_MODE_OUTPUT_MASK) != ECDH_MODE_OUTPUT_CLEAR ||
+        (param1 & ECDH_MODE_COPY_MASK) == ECDH_MODE_COPY_EEPROM_SLOT ||
+        param2 >= EMU_SLOT_COUNT || data_size < ATCA_PUB_KEY_SIZE)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+    if (!emu.has_private_key[param2] || atca_emulator_sw_ecdh(emu.private_key[param2], data, pms) != ATCA_SUCCESS)
+    {
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+        return;
+    }
+
+    if ((param1 & ECDH_MODE_COPY_MASK) == ECDH_MODE_COPY_TEMP_KEY)
+    {
+        memcpy(emu.tempkey, pms, sizeof(pms));
+        emu.tempkey_valid = true;
+        emu_respond_status(EMU_STATUS_SUCCESS);
+    }
+    else
+    {
+        emu_respond(pms, sizeof(pms));
+    }
+}
+
+static void emu_execute(const uint8_t* packet, size_t packet_size)
+{
+    uint8_t count = packet[ATCA_COUNT_IDX];
+    uint8_t crc[ATCA_CRC_SIZE];
+    uint8_t opcode;
+    uint8_t param1;
+    uint16_t param2;
+    const uint8_t* data;
+    size_t data_size;
+
+    if (count < ATCA_CMD_SIZE_MIN || count > packet_size)
+    {
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        return;
+    }
+    atCRC(count - ATCA_CRC_SIZE, packet, crc);
+    if (memcmp(crc, &packet[count - ATCA_CRC_SIZE], ATCA_CRC_SIZE) != 0)
+    {
+        emu_respond_status(0xFF);   // Communication error, resend
+        return;
+    }
+
+    opcode = packet[ATCA_OPCODE_IDX];
+    param1 = packet[ATCA_PARAM1_IDX];
+    param2 = (uint16_t)(packet[ATCA_PARAM2_IDX] | (packet[ATCA_PARAM2_IDX + 1] << 8));
+    data = &packet[ATCA_DATA_IDX];
+    data_size = count - ATCA_CMD_SIZE_MIN;
+
+    emu.stats.commands[opcode]++;
+
+    if (emu.failures[opcode] != 0)
+    {
+        emu.failures[opcode]--;
+        emu_respond_status(EMU_STATUS_EXEC_ERROR);
+        return;
+    }
+
+    switch (opcode)
+    {
+    case ATCA_INFO:
+        emu_cmd_info(param1);
+        break;
+    case ATCA_READ:
+        emu_cmd_read(param1, param2);
+        break;
+    case ATCA_WRITE:
+        emu_cmd_write(param1, param2, data, data_size);
+        break;
+    case ATCA_LOCK:
+        // Both zones are locked already, locking a slot is accepted and ignored
+        emu_respond_status(EMU_STATUS_SUCCESS);
+        break;
+    case ATCA_RANDOM:
+        emu_cmd_random();
+        break;
+    case ATCA_NONCE:
+        emu_cmd_nonce(param1, param2, data, data_size);
+        break;
+    case ATCA_GENKEY:
+        emu_cmd_genkey(param1, param2);
+        break;
+    case ATCA_SIGN:
+        emu_cmd_sign(param1, param2);
+        break;
+    case ATCA_VERIFY:
+        emu_cmd_verify(param1, param2, data, data_size);
+        break;
+    case ATCA_ECDH:
+        emu_cmd_ecdh(param1, param2, data, data_size);
+        break;
+    default:
+        emu_respond_status(EMU_STATUS_PARSE_ERROR);
+        break;
+    }
+}
+
+static uint32_t emu_execution_time_us(uint8_t opcode)
+{
+    const emu_latency_t* latency = &emu.latency[opcode];
+    int64_t time_us = latency->typical_us;
+
+    if (latency->jitter_us != 0)
+    {
+        time_us += (int64_t)(rand() % (2 * latency->jitter_us + 1)) - latency->jitter_us;
+    }
+    if (time_us < 0)
+    {
+        time_us = 0;
+    }
+    return (uint32_t)((uint64_t)time_us * emu.latency_scale / 100u);
+}
+
+/*
+ * HAL
+ */
+
+static ATCA_STATUS hal_emulator_init(void* hal, void* cfg)
+{
+    (void)hal;
+    (void)cfg;
+
+    if (!emu_initialized)
+    {
+        atca_emulator_reset();
+    }
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_post_init(void* iface)
+{
+    (void)iface;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_send(void* iface, uint8_t* txdata, int txlength)
+{
+    (void)iface;
+
+    // txdata[0] is the word address slot, the packet starts at the count
+    emu.stats.bytes_sent += (uint32_t)txlength + 1;
+    emu_bus_transfer((size_t)txlength + 2);
+
+    emu_execute(&txdata[1], (size_t)txlength);
+    emu.ready_us = emu_now_us() + emu_execution_time_us(txdata[1 + ATCA_OPCODE_IDX]);
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_receive(void* iface, uint8_t* rxdata, uint16_t* rxlength)
+{
+    (void)iface;
+
+    if (emu_now_us() < emu.ready_us)
+    {
+        // Still executing, the device does not acknowledge its address
+        emu.stats.busy_reads++;
+        emu_bus_transfer(1);
+        return ATCA_COMM_FAIL;
+    }
+    if (emu.response_size == 0 || *rxlength < emu.response_size)
+    {
+        return ATCA_RX_FAIL;
+    }
+
+    memcpy(rxdata, emu.response, emu.response_size);
+    *rxlength = (uint16_t)emu.response_size;
+    emu.stats.bytes_received += (uint32_t)emu.response_size;
+    emu_bus_transfer(emu.response_size + 1);
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_wake(void* iface)
+{
+    (void)iface;
+
+    emu.stats.wakes++;
+    if (emu.bus_hz != 0)
+    {
+        emu_busy_wait_us(EMU_WAKE_US);
+    }
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_idle(void* iface)
+{
+    (void)iface;
+    emu.response_size = 0;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_sleep(void* iface)
+{
+    (void)iface;
+    // Sleep clears the volatile state, idle keeps it
+    emu.response_size = 0;
+    emu.tempkey_valid = false;
+    emu.msg_digest_valid = false;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS hal_emulator_release(void* hal_data)
+{
+    (void)hal_data;
+    return ATCA_SUCCESS;
+}
+
+ATCAIfaceCfg cfg_atecc608_emulator = {
+    .iface_type  = ATCA_CUSTOM_IFACE,
+    .devtype     = ATECC608A,
+    .atcacustom  = {
+        .halinit     = hal_emulator_init,
+        .halpostinit = hal_emulator_post_init,
+        .halsend     = hal_emulator_send,
+        .halreceive  = hal_emulator_receive,
+        .halwake     = hal_emulator_wake,
+        .halidle     = hal_emulator_idle,
+        .halsleep    = hal_emulator_sleep,
+        .halrelease  = hal_emulator_release
+    },
+    .wake_delay  = EMU_WAKE_US,
+    .rx_retries  = 20
+};
+
+/*
+ * Control
+ */
+
+void atca_emulator_reset(void)
+{
+    static const uint8_t revision[4] = { 0x00, 0x00, 0x60, 0x02 };
+    static const char tng_tls_otp_id[] = "wdNxAjae";
+    size_t i;
+
+    memset(&emu, 0, sizeof(emu));
+    emu_initialized = true;
+
+    // Serial number 0123xxxxxxxxxxxx01, the last byte tells TNG parts apart
+    emu.config[0] = 0x01;
+    emu.config[1] = 0x23;
+    RAND_bytes(&emu.config[2], 2);
+    RAND_bytes(&emu.config[8], 4);
+    emu.config[12] = 0x01;
+    memcpy(&emu.config[4], revision, sizeof(revision));
+    emu.config[14] = 0x01;          // I2C enabled
+    emu.config[16] = 0x6A;          // TNG I2C address
+    emu.config[ATCA_CHIPMODE_OFFSET] = 0x00;
+    emu.config[86] = ATCA_LOCKED;   // Data zone
+    emu.config[87] = ATCA_LOCKED;   // Config zone
+    memcpy(emu.otp, tng_tls_otp_id, sizeof(tng_tls_otp_id) - 1);
+
+    atca_emulator_sw_genkey(emu.private_key[EMU_TNG_PRIMARY_KEY_SLOT], NULL);
+    emu.has_private_key[EMU_TNG_PRIMARY_KEY_SLOT] = true;
+
+    for (i = 0; i < sizeof(emu_default_latency) / sizeof(emu_default_latency[0]); i++)
+    {
+        emu.latency[emu_default_latency[i].opcode].typical_us = emu_default_latency[i].max_ms * 500u;
+        emu.latency[emu_default_latency[i].opcode].jitter_us = emu_default_latency[i].max_ms * 100u;
+    }
+    emu.latency_scale = 100;
+    emu.bus_hz = 400000;
+}
+
+ATCA_STATUS atca_emulator_provision_tng(uint8_t* signer_public_key, uint8_t* cert, size_t* cert_size)
+{
+    const atcacert_def_t* cert_def = &g_tngtls_cert_def_2_device;
+    static const atcacert_device_loc_t config_loc = {
+        .zone   = DEVZONE_CONFIG,
+        .offset = 0,
+        .count  = ATCA_BLOCK_SIZE
+    };
+    atcacert_build_state_t build_state;
+    uint8_t signer_private_key[ATCA_KEY_SIZE];
+    uint8_t device_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t comp_cert[72];
+    uint8_t tbs_digest[ATCA_SHA_DIGEST_SIZE];
+    uint8_t signature[ATCA_SIG_SIZE];
+    uint8_t built[1024];
+    size_t built_size = sizeof(built);
+    int ret;
+
+    if (!emu_initialized)
+    {
+        atca_emulator_reset();
+    }
+
+    if ((ret = atca_emulator_sw_genkey(signer_private_key, signer_public_key)) != ATCA_SUCCESS ||
+        (ret = emu_public_key(emu.private_key[EMU_TNG_PRIMARY_KEY_SLOT], device_public_key)) != ATCA_SUCCESS)
+    {
+        return ret;
+    }
+
+    // Build the certificate the way it will be rebuilt, with the template's dates and signer ID
+    if ((ret = atcacert_get_comp_cert(cert_def, cert_def->cert_template, cert_def->cert_template_size, comp_cert)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_cert_build_start(&build_state, cert_def, built, &built_size, signer_public_key)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_cert_build_process(&build_state, &config_loc, emu.config)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_cert_build_process(&build_state, &cert_def->public_key_dev_loc, device_public_key)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_cert_build_process(&build_state, &cert_def->comp_cert_dev_loc, comp_cert)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_cert_build_finish(&build_state)) != ATCACERT_E_SUCCESS)
+    {
+        return ret;
+    }
+
+    // Sign it with the signer key and keep the signature in the compressed certificate
+    if ((ret = atcacert_get_tbs_digest(cert_def, built, built_size, tbs_digest)) != ATCACERT_E_SUCCESS ||
+        (ret = atca_emulator_sw_sign(signer_private_key, tbs_digest, signature)) != ATCA_SUCCESS ||
+        (ret = atcacert_set_signature(cert_def, built, &built_size, sizeof(built), signature)) != ATCACERT_E_SUCCESS ||
+        (ret = atcacert_get_comp_cert(cert_def, built, built_size, comp_cert)) != ATCACERT_E_SUCCESS)
+    {
+        return ret;
+    }
+
+    memcpy(emu.data[EMU_TNG_DEVICE_CERT_SLOT], comp_cert, sizeof(comp_cert));
+    atcacert_public_key_add_padding(signer_public_key, emu.data[EMU_TNG_SIGNER_KEY_SLOT]);
+    memset(signer_private_key, 0, sizeof(signer_private_key));
+
+    if (cert_size != NULL)
+    {
+        if (cert != NULL)
+        {
+            if (*cert_size < built_size)
+            {
+                *cert_size = built_size;
+                return ATCA_SMALL_BUFFER;
+            }
+            memcpy(cert, built, built_size);
+        }
+        *cert_size = built_size;
+    }
+    return ATCA_SUCCESS;
+}
+
+void atca_emulator_set_latency(uint8_t opcode, uint32_t typical_us, uint32_t jitter_us)
+{
+    emu.latency[opcode].typical_us = typical_us;
+    emu.latency[opcode].jitter_us = jitter_us;
+}
+
+void atca_emulator_fail_commands(uint8_t opcode, uint32_t count)
+{
+    emu.failures[opcode] = count;
+}
+
+void atca_emulator_set_latency_scale(uint32_t percent)
+{
+    emu.latency_scale = percent;
+}
+
+void atca_emulator_set_bus_speed(uint32_t hz)
+{
+    emu.bus_hz = hz;
+}
+
+uint32_t atca_emulator_time_us(void)
+{
+    return (uint32_t)emu_now_us();
+}
+
+void atca_emulator_get_stats(atca_emulator_stats_t* stats)
+{
+    *stats = emu.stats;
+}
+
+void atca_emulator_clear_stats(void)
+{
+    memset(&emu.stats, 0, sizeof(emu.stats));
+}
@@ -0,0 +1,143 @@
+/**
+ * \file
+ * \brief Software ATECC608A for host builds.
+ *
+ * The emulator sits behind a custom interface HAL (cfg_atecc608_emulator),
+ * so atcab_init() and everything above it (basic API, atcacert, tng) run
+ * unchanged on a Linux host. It receives the same command packets the I2C
+ * HAL would put on the bus, checks their CRC, executes them against an
+ * in-memory config zone, OTP zone and 16 data slots, and answers with
+ * CRC-protected responses.
+ *
+ * Supported commands: Info, Read, Write, Lock, Random, Nonce, GenKey, Sign,
+ * Verify (external key) and ECDH. P-256 operations use OpenSSL. Slots that
+ * hold a private key cannot be read or written, other permission bits of
+ * the slot and key configuration are not enforced.
+ *
+ * After atca_emulator_reset() the device looks like an ATECC608A-TNGTLS:
+ * config and data zones locked, a private key in slot 0 and the Trust&GO
+ * OTP identifier. atca_emulator_provision_tng() adds the compressed device
+ * certificate and the signer public key, so tng_atcacert_read_device_cert()
+ * works against it.
+ *
+ * Command execution times follow a latency model. While a command is
+ * "executing" the emulator refuses to return the response, the same way
+ * the device NACKs its address, so the library's polling runs exactly as it
+ * does on the bus. Bus transfers and the wake pulse take time as well.
+ *
+ * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#ifndef ATCA_EMULATOR_H
+#define ATCA_EMULATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cryptoauthlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \brief Interface configuration that routes the library to the emulator */
+extern ATCAIfaceCfg cfg_atecc608_emulator;
+
+/** \brief Emulator counters */
+typedef struct
+{
+    uint32_t commands[256];     //!< Commands executed, by opcode
+    uint32_t errors;            //!< Commands answered with an error status
+    uint32_t busy_reads;        //!< Response reads refused because a command was executing
+    uint32_t wakes;             //!< Wake pulses
+    uint32_t bytes_sent;        //!< Bytes the host sent, including the word address
+    uint32_t bytes_received;    //!< Bytes the host read
+} atca_emulator_stats_t;
+
+/** \brief Put the emulated device back into its factory state
+ *
+ * New serial number and slot 0 key, TNG-TLS configuration, zones locked,
+ * default latency model at 100 % and a 400 kHz bus. Counters are cleared.
+ */
+void atca_emulator_reset(void);
+
+/** \brief Provision a Trust&GO TLS device certificate chain
+ *
+ * Creates a signer key, writes its public key to slot 11, issues the
+ * device certificate for the slot 0 key with the TNG-TLS template and
+ * writes the compressed certificate to slot 10.
+ *
+ * \param[out] signer_public_key  Signer public key, X and Y (64 bytes)
+ * \param[out] cert               Issued device certificate, may be NULL
+ * \param[inout] cert_size        As input the size of cert, as output the certificate size
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atca_emulator_provision_tng(uint8_t* signer_public_key, uint8_t* cert, size_t* cert_size);
+
+/** \brief Set the execution time of one command
+ * \param[in] opcode      Command opcode
+ * \param[in] typical_us  Typical execution time in microseconds
+ * \param[in] jitter_us   Execution time varies uniformly by up to this much either way
+ */
+void atca_emulator_set_latency(uint8_t opcode, uint32_t typical_us, uint32_t jitter_us);
+
+/** \brief Make the next commands with an opcode fail with an execution error
+ * \param[in] opcode  Command opcode
+ * \param[in] count   Number of commands to fail, 0 stops failing them
+ */
+void atca_emulator_fail_commands(uint8_t opcode, uint32_t count);
+
+/** \brief Scale all execution times, in percent. 0 makes every command complete at once. */
+void atca_emulator_set_latency_scale(uint32_t percent);
+
+/** \brief Set the emulated I2C clock. 0 makes transfers and the wake pulse take no time. */
+void atca_emulator_set_bus_speed(uint32_t hz);
+
+/** \brief Read the emulator counters */
+void atca_emulator_get_stats(atca_emulator_stats_t* stats);
+
+/** \brief Clear the emulator counters */
+void atca_emulator_clear_stats(void);
+
+/** \brief Monotonic microsecond clock the latency model runs on
+ *
+ * Host builds pass it to the library as ATCA_POLL_TIME_US() so the adaptive
+ * poller measures completion times the way it does with esp_timer.
+ */
+uint32_t atca_emulator_time_us(void);
+
+/** \brief Software P-256 operations the emulator uses, for checking results in tests
+ *  Keys are raw big-endian: private 32 bytes, public X and Y 64 bytes, signatures R and S 64 bytes.
+ * @{
+ */
+ATCA_STATUS atca_emulator_sw_genkey(uint8_t* private_key, uint8_t* public_key);
+ATCA_STATUS atca_emulator_sw_sign(const uint8_t* private_key, const uint8_t* digest, uint8_t* signature);
+ATCA_STATUS atca_emulator_sw_verify(const uint8_t* public_key, const uint8_t* digest, const uint8_t* signature, bool* is_verified);
+ATCA_STATUS atca_emulator_sw_ecdh(const uint8_t* private_key, const uint8_t* public_key, uint8_t* pms);
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATCA_EMULATOR_H */
@@ -0,0 +1,476 @@
+/**
+ * \file
+ * \brief Tests and a TLS connect benchmark against the ATECC608A emulator.
+ *
+ * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cryptoauthlib.h"
+#include "atca_execution.h"
+#include "atcacert/atcacert_def.h"
+#include "crypto/atca_crypto_sw_sha2.h"
+#include "tng_atca.h"
+#include "tng_atcacert_client.h"
+#include "atca_emulator.h"
+#include "atca_cert_cache.h"
+#include "nvs.h"
+
+static int tests_run;
+static int tests_failed;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(int cond, const char* text, int line)
+{
+    tests_run++;
+    if (!cond)
+    {
+        tests_failed++;
+        printf("FAIL line %d: %s\n", line, text);
+    }
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+
+    return (da > db) - (da < db);
+}
+
+static void test_device_info(void)
+{
+    uint8_t sn[ATCA_SERIAL_NUM_SIZE];
+    uint8_t revision[4];
+    uint8_t random[RANDOM_NUM_SIZE];
+    uint8_t random2[RANDOM_NUM_SIZE];
+    bool is_locked = false;
+    tng_type_t type;
+
+    CHECK(atcab_read_serial_number(sn) == ATCA_SUCCESS);
+    CHECK(sn[0] == 0x01 && sn[1] == 0x23 && sn[8] == 0x01);
+
+    CHECK(atcab_info(revision) == ATCA_SUCCESS);
+    CHECK(revision[2] == 0x60 && revision[3] == 0x02);
+
+    CHECK(atcab_is_locked(LOCK_ZONE_CONFIG, &is_locked) == ATCA_SUCCESS && is_locked);
+    CHECK(atcab_is_locked(LOCK_ZONE_DATA, &is_locked) == ATCA_SUCCESS && is_locked);
+
+    CHECK(tng_get_type(&type) == ATCA_SUCCESS && type == TNGTYPE_TLS);
+
+    CHECK(atcab_random(random) == ATCA_SUCCESS);
+    CHECK(atcab_random(random2) == ATCA_SUCCESS);
+    CHECK(memcmp(random, random2, sizeof(random)) != 0);
+}
+
+static void test_sign_verify(void)
+{
+    uint8_t public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t digest[ATCA_SHA_DIGEST_SIZE];
+    uint8_t signature[ATCA_SIG_SIZE];
+    bool is_verified = false;
+
+    atcac_sw_sha2_256((const uint8_t*)"emulator", 8, digest);
+
+    // Slot 0 key that came with the device
+    CHECK(atcab_get_pubkey(0, public_key) == ATCA_SUCCESS);
+    CHECK(atcab_sign(0, digest, signature) == ATCA_SUCCESS);
+    CHECK(atca_emulator_sw_verify(public_key, digest, signature, &is_verified) == ATCA_SUCCESS && is_verified);
+
+    // Fresh key in slot 2
+    CHECK(atcab_genkey(2, public_key) == ATCA_SUCCESS);
+    CHECK(atcab_sign(2, digest, signature) == ATCA_SUCCESS);
+    CHECK(atca_emulator_sw_verify(public_key, digest, signature, &is_verified) == ATCA_SUCCESS && is_verified);
+
+    // Verify on the device, good and tampered signatures
+    CHECK(atcab_verify_extern(digest, signature, public_key, &is_verified) == ATCA_SUCCESS && is_verified);
+    signature[5] ^= 0x01;
+    CHECK(atcab_verify_extern(digest, signature, public_key, &is_verified) == ATCA_SUCCESS && !is_verified);
+
+    // Private keys stay in the device
+    CHECK(atcab_read_zone(ATCA_ZONE_DATA, 0, 0, 0, public_key, ATCA_BLOCK_SIZE) != ATCA_SUCCESS);
+}
+
+static void test_ecdh(void)
+{
+    uint8_t device_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t peer_private_key[ATCA_KEY_SIZE];
+    uint8_t peer_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t pms[ATCA_KEY_SIZE];
+    uint8_t peer_pms[ATCA_KEY_SIZE];
+
+    CHECK(atcab_genkey(2, device_public_key) == ATCA_SUCCESS);
+    CHECK(atca_emulator_sw_genkey(peer_private_key, peer_public_key) == ATCA_SUCCESS);
+
+    CHECK(atcab_ecdh(2, peer_public_key, pms) == ATCA_SUCCESS);
+    CHECK(atca_emulator_sw_ecdh(peer_private_key, device_public_key, peer_pms) == ATCA_SUCCESS);
+    CHECK(memcmp(pms, peer_pms, sizeof(pms)) == 0);
+}
+
+static void test_read_write(void)
+{
+    uint8_t data[72];
+    uint8_t readback[72];
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+    CHECK(atcab_write_bytes_zone(ATCA_ZONE_DATA, 12, 0, data, sizeof(data)) == ATCA_SUCCESS);
+    CHECK(atcab_read_bytes_zone(ATCA_ZONE_DATA, 12, 0, readback, sizeof(readback)) == ATCA_SUCCESS);
+    CHECK(memcmp(data, readback, sizeof(data)) == 0);
+
+    CHECK(atcab_read_bytes_zone(ATCA_ZONE_DATA, 12, 4, readback, 8) == ATCA_SUCCESS);
+    CHECK(memcmp(&data[4], readback, 8) == 0);
+}
+
+static void test_tng_certificate(void)
+{
+    const atcacert_def_t* cert_def = NULL;
+    uint8_t signer_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t device_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t cert_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t issued[1024];
+    uint8_t cert[1024];
+    size_t issued_size = sizeof(issued);
+    size_t cert_size = sizeof(cert);
+    uint8_t tbs_digest[ATCA_SHA_DIGEST_SIZE];
+    uint8_t signature[ATCA_SIG_SIZE];
+    bool is_verified = false;
+
+    CHECK(atca_emulator_provision_tng(signer_public_key, issued, &issued_size) == ATCA_SUCCESS);
+
+    CHECK(tng_get_device_cert_def(&cert_def) == ATCA_SUCCESS);
+    CHECK(cert_def != NULL && cert_def->cert_template_size > 0);
+
+    // The certificate the device reconstructs must be the one that was issued
+    CHECK(tng_atcacert_read_device_cert(cert, &cert_size, NULL) == ATCACERT_E_SUCCESS);
+    CHECK(cert_size == issued_size && memcmp(cert, issued, cert_size) == 0);
+
+    // Signed by the signer and carrying the slot 0 key
+    CHECK(atcacert_get_tbs_digest(cert_def, cert, cert_size, tbs_digest) == ATCACERT_E_SUCCESS);
+    CHECK(atcacert_get_signature(cert_def, cert, cert_size, signature) == ATCACERT_E_SUCCESS);
+    CHECK(atca_emulator_sw_verify(signer_public_key, tbs_digest, signature, &is_verified) == ATCA_SUCCESS && is_verified);
+
+    CHECK(atcab_get_pubkey(0, device_public_key) == ATCA_SUCCESS);
+    CHECK(atcacert_get_subj_public_key(cert_def, cert, cert_size, cert_public_key) == ATCACERT_E_SUCCESS);
+    CHECK(memcmp(device_public_key, cert_public_key, sizeof(cert_public_key)) == 0);
+}
+
+static void test_poll_stats_by_mode(void)
+{
+    uint8_t serial_number[ATCA_SERIAL_NUM_SIZE];
+    uint8_t word[ATCA_WORD_SIZE];
+    atca_poll_stats_t stats;
+
+    atca_poll_reset_stats();
+
+    // 32 and 4 byte reads are learned apart
+    CHECK(atcab_read_serial_number(serial_number) == ATCA_SUCCESS);
+    CHECK(atcab_read_serial_number(serial_number) == ATCA_SUCCESS);
+    CHECK(atcab_read_zone(ATCA_ZONE_CONFIG, 0, 0, 1, word, sizeof(word)) == ATCA_SUCCESS);
+
+    CHECK(atca_poll_get_stats(ATCA_READ, ATCA_ZONE_CONFIG | ATCA_ZONE_READWRITE_32, &stats) == ATCA_SUCCESS);
+    CHECK(stats.opcode == ATCA_READ && stats.mode == (ATCA_ZONE_CONFIG | ATCA_ZONE_READWRITE_32));
+    CHECK(stats.count == 2);
+    CHECK(atca_poll_get_stats(ATCA_READ, ATCA_ZONE_CONFIG, &stats) == ATCA_SUCCESS);
+    CHECK(stats.count == 1);
+    CHECK(atca_poll_get_stats(ATCA_READ, ATCA_ZONE_DATA, &stats) == ATCA_BAD_OPCODE);
+
+    atca_poll_reset_stats();
+}
+
+/** \brief Read the NVS copy of the certificate cache, returns the blob size or 0 if there is none */
+static size_t read_cached_cert_blob(const atcacert_def_t* cert_def, uint8_t* blob, size_t blob_size)
+{
+    nvs_handle handle;
+    char key[16];
+
+    snprintf(key, sizeof(key), "crt_%u_%u_%u", (unsigned)cert_def->type, (unsigned)cert_def->template_id,
+             (unsigned)cert_def->chain_id);
+    if (nvs_open("atca_cert", NVS_READONLY, &handle) != ESP_OK
+        || nvs_get_blob(handle, key, blob, &blob_size) != ESP_OK)
+    {
+        return 0;
+    }
+    nvs_close(handle);
+    return blob_size;
+}
+
+static void write_cached_cert_blob(const atcacert_def_t* cert_def, const uint8_t* blob, size_t blob_size)
+{
+    nvs_handle handle;
+    char key[16];
+
+    snprintf(key, sizeof(key), "crt_%u_%u_%u", (unsigned)cert_def->type, (unsigned)cert_def->template_id,
+             (unsigned)cert_def->chain_id);
+    CHECK(nvs_open("atca_cert", NVS_READWRITE, &handle) == ESP_OK);
+    CHECK(nvs_set_blob(handle, key, blob, blob_size) == ESP_OK);
+    nvs_close(handle);
+}
+
+static void test_cert_cache_identity_failure(void)
+{
+    const atcacert_def_t* cert_def = NULL;
+    uint8_t signer_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t issued[1024];
+    size_t issued_size = sizeof(issued);
+    uint8_t blob[1200];
+    const uint8_t* der = NULL;
+    size_t der_size = 0;
+    atca_emulator_stats_t stats;
+
+    CHECK(atca_emulator_provision_tng(signer_public_key, issued, &issued_size) == ATCA_SUCCESS);
+    CHECK(tng_get_device_cert_def(&cert_def) == ATCA_SUCCESS);
+    atca_cert_cache_clear();
+
+    // The serial number read is the first command, the certificate is still rebuilt
+    atca_emulator_clear_stats();
+    atca_emulator_fail_commands(ATCA_READ, 1);
+    CHECK(atca_cert_cache_get(cert_def, &der, &der_size) == ATCA_SUCCESS);
+    atca_emulator_get_stats(&stats);
+    CHECK(stats.errors == 1);
+    CHECK(der_size == issued_size && memcmp(der, issued, der_size) == 0);
+
+    // but nothing goes to NVS without the identity that validates it
+    CHECK(read_cached_cert_blob(cert_def, blob, sizeof(blob)) == 0);
+
+    atca_cert_cache_clear();
+}
+
+static void test_cert_cache_stale_copy(void)
+{
+    const atcacert_def_t* cert_def = NULL;
+    uint8_t signer_public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t issued[1024];
+    size_t issued_size = sizeof(issued);
+    uint8_t stale_blob[1200];
+    size_t stale_blob_size;
+    uint8_t blob[1200];
+    size_t blob_size;
+    const uint8_t* der = NULL;
+    size_t der_size = 0;
+
+    CHECK(tng_get_device_cert_def(&cert_def) == ATCA_SUCCESS);
+
+    // A copy made for the certificate the device had before
+    CHECK(atca_emulator_provision_tng(signer_public_key, NULL, &issued_size) == ATCA_SUCCESS);
+    atca_cert_cache_clear();
+    CHECK(atca_cert_cache_get(cert_def, &der, &der_size) == ATCA_SUCCESS);
+    stale_blob_size = read_cached_cert_blob(cert_def, stale_blob, sizeof(stale_blob));
+    CHECK(stale_blob_size > der_size);
+
+    // Reprovisioned, and after a reboot NVS still holds the old copy
+    issued_size = sizeof(issued);
+    CHECK(atca_emulator_provision_tng(signer_public_key, issued, &issued_size) == ATCA_SUCCESS);
+    atca_cert_cache_clear();
+    write_cached_cert_blob(cert_def, stale_blob, stale_blob_size);
+
+    CHECK(atca_cert_cache_get(cert_def, &der, &der_size) == ATCA_SUCCESS);
+    CHECK(der_size == issued_size && memcmp(der, issued, der_size) == 0);
+
+    // The stale copy is replaced by the rebuilt certificate
+    blob_size = read_cached_cert_blob(cert_def, blob, sizeof(blob));
+    CHECK(blob_size > der_size && memcmp(&blob[blob_size - der_size], issued, der_size) == 0);
+    CHECK(blob_size != stale_blob_size || memcmp(blob, stale_blob, blob_size) != 0);
+
+    atca_cert_cache_clear();
+}
+
+/** \brief Secure element part of a mutual TLS connect with the TNG key
+ *
+ * The client certificate is read and rebuilt, the public key is read to
+ * match it against the private key, and the CertificateVerify handshake
+ * digest is signed with slot 0.
+ */
+static int tls_connect(void)
+{
+    uint8_t cert[1024];
+    size_t cert_size = sizeof(cert);
+    uint8_t public_key[ATCA_PUB_KEY_SIZE];
+    uint8_t digest[ATCA_SHA_DIGEST_SIZE];
+    uint8_t signature[ATCA_SIG_SIZE];
+
+    if (tng_atcacert_read_device_cert(cert, &cert_size, NULL) != ATCACERT_E_SUCCESS ||
+        atcab_get_pubkey(0, public_key) != ATCA_SUCCESS)
+    {
+        return -1;
+    }
+    atcac_sw_sha2_256(cert, cert_size, digest);
+    return atcab_sign(0, digest, signature) == ATCA_SUCCESS ? 0 : -1;
+}
+
+static void print_poll_stats(uint8_t opcode, const char* name)
+{
+    atca_poll_stats_t stats;
+    unsigned mode;
+
+    for (mode = 0; mode <= 0xFF; mode++)
+    {
+        if (atca_poll_get_stats(opcode, (uint8_t)mode, &stats) == ATCA_SUCCESS)
+        {
+            printf("  %-8s 0x%02X %6u commands %6u busy polls  typical %6.2f ms  max %6.2f ms\n",
+                   name, mode, (unsigned)stats.count, (unsigned)stats.polls,
+                   stats.typical_us / 1000.0, stats.max_us / 1000.0);
+        }
+    }
+}
+
+static int benchmark_tls_connect(int connections)
+{
+    atca_emulator_stats_t stats;
+    double* times = malloc(sizeof(double) * (size_t)connections);
+    double total = 0;
+    double start;
+    int i;
+
+    if (times == NULL)
+    {
+        return -1;
+    }
+
+    atca_emulator_clear_stats();
+    atca_poll_reset_stats();
+
+    for (i = 0; i < connections; i++)
+    {
+        start = now_ms();
+        if (tls_connect() != 0)
+        {
+            printf("TLS connect %d failed\n", i);
+            free(times);
+            return -1;
+        }
+        times[i] = now_ms() - start;
+        total += times[i];
+    }
+    qsort(times, (size_t)connections, sizeof(double), compare_doubles);
+    atca_emulator_get_stats(&stats);
+
+    printf("TLS connect, %d connections\n", connections);
+    printf("  mean %.2f ms  median %.2f ms  p99 %.2f ms\n",
+           total / connections, times[connections / 2], times[(connections * 99) / 100]);
+    printf("  per connect: %.1f commands  %.1f busy reads  %.1f wakes  %.0f bytes on the bus\n",
+           (double)(stats.commands[ATCA_READ] + stats.commands[ATCA_GENKEY] + stats.commands[ATCA_NONCE] +
+                    stats.commands[ATCA_SIGN]) / connections,
+           (double)stats.busy_reads / connections, (double)stats.wakes / connections,
+           (double)(stats.bytes_sent + stats.bytes_received) / connections);
+    print_poll_stats(ATCA_READ, "Read");
+    print_poll_stats(ATCA_GENKEY, "GenKey");
+    print_poll_stats(ATCA_NONCE, "Nonce");
+    print_poll_stats(ATCA_SIGN, "Sign");
+
+    free(times);
+    return 0;
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-l latency_percent] [-b bus_hz] [-n connections]\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t latency_percent = 100;
+    uint32_t bus_hz = 400000;
+    int connections = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'l':
+            latency_percent = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'b':
+            bus_hz = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            connections = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (connections <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Functional tests run without delays
+    atca_emulator_reset();
+    atca_emulator_set_latency_scale(0);
+    atca_emulator_set_bus_speed(0);
+
+    if (atcab_init(&cfg_atecc608_emulator) != ATCA_SUCCESS)
+    {
+        printf("atcab_init failed\n");
+        return 1;
+    }
+
+    test_device_info();
+    test_sign_verify();
+    test_ecdh();
+    test_read_write();
+    test_tng_certificate();
+    test_cert_cache_identity_failure();
+    test_cert_cache_stale_copy();
+    test_poll_stats_by_mode();
+
+    printf("%d checks, %d failed\n", tests_run, tests_failed);
+    if (tests_failed != 0)
+    {
+        atcab_release();
+        return 1;
+    }
+
+    atca_emulator_set_latency_scale(latency_percent);
+    atca_emulator_set_bus_speed(bus_hz);
+    printf("Latency %u %%, bus %u Hz\n", (unsigned)latency_percent, (unsigned)bus_hz);
+    if (benchmark_tls_connect(connections) != 0)
+    {
+        atcab_release();
+        return 1;
+    }
+
+    atcab_release();
+    return 0;
+}
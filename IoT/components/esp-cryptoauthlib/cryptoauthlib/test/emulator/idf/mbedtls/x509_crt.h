@@ -0,0 +1,19 @@
+/**
+ * \file
+ * \brief Host stand-in for mbedtls/x509_crt.h, the host build has no mbedtls
+ */
+
+#ifndef MBEDTLS_X509_CRT_H
+#define MBEDTLS_X509_CRT_H
+
+#include <stddef.h>
+
+typedef struct mbedtls_x509_crt
+{
+    const unsigned char* der;
+    size_t               der_size;
+} mbedtls_x509_crt;
+
+int mbedtls_x509_crt_parse_der(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen);
+
+#endif /* MBEDTLS_X509_CRT_H */
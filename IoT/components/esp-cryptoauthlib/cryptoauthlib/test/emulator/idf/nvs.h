@@ -0,0 +1,34 @@
+/**
+ * \file
+ * \brief Host stand-in for the ESP-IDF NVS blob API, kept in memory by idf_host.c
+ */
+
+#ifndef NVS_H
+#define NVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int esp_err_t;
+typedef uint32_t nvs_handle;
+
+#define ESP_OK                      0
+#define ESP_ERR_NO_MEM              0x101
+#define ESP_ERR_NVS_NOT_FOUND       0x1102
+#define ESP_ERR_NVS_INVALID_LENGTH  0x110c
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode;
+
+esp_err_t nvs_open(const char* name, nvs_open_mode open_mode, nvs_handle* out_handle);
+esp_err_t nvs_get_blob(nvs_handle handle, const char* key, void* out_value, size_t* length);
+esp_err_t nvs_set_blob(nvs_handle handle, const char* key, const void* value, size_t length);
+esp_err_t nvs_erase_key(nvs_handle handle, const char* key);
+esp_err_t nvs_erase_all(nvs_handle handle);
+esp_err_t nvs_commit(nvs_handle handle);
+void nvs_close(nvs_handle handle);
+
+#endif /* NVS_H */
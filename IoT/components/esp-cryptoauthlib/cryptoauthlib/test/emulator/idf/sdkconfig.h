@@ -0,0 +1,6 @@
+/**
+ * \file
+ * \brief Host stand-in for the ESP-IDF sdkconfig.h, enables the port code built with the emulator
+ */
+
+#define CONFIG_ATCA_CERT_CACHE 1
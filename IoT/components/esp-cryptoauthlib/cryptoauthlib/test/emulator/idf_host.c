@@ -0,0 +1,210 @@
+/**
+ * \file
+ * \brief Host stand-ins for the ESP-IDF and mbedtls functions the port code calls.
+ *
+ * NVS keeps blobs in memory for as long as the process runs. The mbedtls
+ * certificate parser only checks the outer DER SEQUENCE, enough to tell a
+ * certificate from garbage.
+ *
+ * \copyright (c) 2015-2018 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/atca_mbedtls_wrap.h"
+
+#define NVS_HOST_NAMESPACES     4
+#define NVS_HOST_ENTRIES        16
+#define NVS_HOST_NAME_SIZE      16
+
+typedef struct
+{
+    nvs_handle handle;
+    char       key[NVS_HOST_NAME_SIZE];
+    uint8_t*   value;
+    size_t     length;
+} nvs_host_entry_t;
+
+static char nvs_namespaces[NVS_HOST_NAMESPACES][NVS_HOST_NAME_SIZE];
+static nvs_host_entry_t nvs_entries[NVS_HOST_ENTRIES];
+
+static nvs_host_entry_t* nvs_host_find(nvs_handle handle, const char* key)
+{
+    int i;
+
+    for (i = 0; i < NVS_HOST_ENTRIES; i++)
+    {
+        if (nvs_entries[i].value && nvs_entries[i].handle == handle && 0 == strcmp(nvs_entries[i].key, key))
+        {
+            return &nvs_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode open_mode, nvs_handle* out_handle)
+{
+    int i;
+
+    (void)open_mode;
+
+    if (strlen(name) >= NVS_HOST_NAME_SIZE)
+    {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    for (i = 0; i < NVS_HOST_NAMESPACES; i++)
+    {
+        if ('\0' == nvs_namespaces[i][0])
+        {
+            strcpy(nvs_namespaces[i], name);
+        }
+        if (0 == strcmp(nvs_namespaces[i], name))
+        {
+            *out_handle = (nvs_handle)(i + 1);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_blob(nvs_handle handle, const char* key, void* out_value, size_t* length)
+{
+    nvs_host_entry_t* entry = nvs_host_find(handle, key);
+
+    if (NULL == entry)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value)
+    {
+        if (*length < entry->length)
+        {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, entry->value, entry->length);
+    }
+    *length = entry->length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle handle, const char* key, const void* value, size_t length)
+{
+    nvs_host_entry_t* entry = nvs_host_find(handle, key);
+    uint8_t* copy;
+    int i;
+
+    if (strlen(key) >= NVS_HOST_NAME_SIZE)
+    {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    for (i = 0; i < NVS_HOST_ENTRIES && NULL == entry; i++)
+    {
+        if (NULL == nvs_entries[i].value)
+        {
+            entry = &nvs_entries[i];
+        }
+    }
+    if (NULL == entry || NULL == (copy = malloc(length ? length : 1)))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(copy, value, length);
+    free(entry->value);
+    entry->handle = handle;
+    strcpy(entry->key, key);
+    entry->value = copy;
+    entry->length = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle handle, const char* key)
+{
+    nvs_host_entry_t* entry = nvs_host_find(handle, key);
+
+    if (NULL == entry)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(entry->value);
+    memset(entry, 0, sizeof(*entry));
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle handle)
+{
+    int i;
+
+    for (i = 0; i < NVS_HOST_ENTRIES; i++)
+    {
+        if (nvs_entries[i].value && nvs_entries[i].handle == handle)
+        {
+            free(nvs_entries[i].value);
+            memset(&nvs_entries[i], 0, sizeof(nvs_entries[i]));
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle handle)
+{
+    (void)handle;
+}
+
+int mbedtls_x509_crt_parse_der(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen)
+{
+    size_t length;
+
+    // SEQUENCE with a two byte length, as every certificate the device rebuilds
+    if (buflen < 4 || buf[0] != 0x30 || buf[1] != 0x82)
+    {
+        return -0x2180;     // MBEDTLS_ERR_X509_INVALID_FORMAT
+    }
+    length = ((size_t)buf[2] << 8 | buf[3]) + 4;
+    if (length != buflen)
+    {
+        return -0x2180;
+    }
+
+    chain->der = buf;
+    chain->der_size = buflen;
+    return 0;
+}
+
+int atca_mbedtls_cert_add(struct mbedtls_x509_crt * cert, const struct atcacert_def_s * cert_def)
+{
+    (void)cert;
+    (void)cert_def;
+
+    // lib/mbedtls is not built on the host
+    return -1;
+}
@@ -0,0 +1,349 @@
+/**
+ * \file
+ * \brief Cache of certificates rebuilt from the ATECC608 compressed certificates
+ */
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_ATCA_CERT_CACHE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/x509_crt.h"
+#include "nvs.h"
+#include "esp_log.h"
+
+#include "cryptoauthlib.h"
+#include "atcacert/atcacert_client.h"
+#include "atcacert/atcacert_def.h"
+#include "crypto/atca_crypto_sw_sha2.h"
+#include "mbedtls/atca_mbedtls_wrap.h"
+#include "atca_cert_cache.h"
+
+#define ATCA_CERT_CACHE_NVS_NAMESPACE   "atca_cert"
+#define ATCA_CERT_CACHE_MAGIC           (0x41434331u)   // "ACC1"
+#define ATCA_CERT_CACHE_MAX_COMP_CERT   (72)
+
+static const char *TAG = "atca_cert_cache";
+
+/** \brief What a cached certificate was built from, stored in front of the DER in NVS */
+typedef struct
+{
+    uint32_t magic;
+    uint8_t  serial_number[ATCA_SERIAL_NUM_SIZE];
+    uint8_t  comp_cert_digest[ATCA_SHA2_256_DIGEST_SIZE];
+    uint16_t der_size;
+} atca_cert_cache_header_t;
+
+typedef struct
+{
+    const atcacert_def_t* cert_def;
+    uint8_t*              der;
+    size_t                der_size;
+} atca_cert_cache_entry_t;
+
+static atca_cert_cache_entry_t cache_entries[ATCA_CERT_CACHE_ENTRIES];
+
+static void atca_cert_cache_nvs_key(const atcacert_def_t* cert_def, char key[16])
+{
+    snprintf(key, 16, "crt_%u_%u_%u", (unsigned)cert_def->type, (unsigned)cert_def->template_id,
+             (unsigned)cert_def->chain_id);
+}
+
+/** \brief Read the serial number and digest the compressed certificate */
+static int atca_cert_cache_read_identity(const atcacert_def_t* cert_def, atca_cert_cache_header_t* header)
+{
+    uint8_t comp_cert[ATCA_CERT_CACHE_MAX_COMP_CERT];
+    size_t comp_cert_size = cert_def->comp_cert_dev_loc.count;
+    int ret;
+
+    if (comp_cert_size > sizeof(comp_cert))
+    {
+        return ATCA_BAD_PARAM;
+    }
+
+    memset(header, 0, sizeof(*header));
+    header->magic = ATCA_CERT_CACHE_MAGIC;
+
+    if (ATCA_SUCCESS != (ret = atcab_read_serial_number(header->serial_number)))
+    {
+        return ret;
+    }
+    if (ATCACERT_E_SUCCESS != (ret = atcacert_read_device_loc(&cert_def->comp_cert_dev_loc, comp_cert)))
+    {
+        return ret;
+    }
+
+    return atcac_sw_sha2_256(comp_cert, comp_cert_size, header->comp_cert_digest);
+}
+
+/** \brief Load the NVS copy if it was made from this device and compressed certificate */
+static int atca_cert_cache_load(const atcacert_def_t* cert_def, const atca_cert_cache_header_t* identity,
+                                uint8_t** der, size_t* der_size)
+{
+    nvs_handle handle;
+    char key[16];
+    uint8_t* blob = NULL;
+    size_t blob_size = 0;
+    atca_cert_cache_header_t header;
+    int ret = ATCA_FUNC_FAIL;
+
+    atca_cert_cache_nvs_key(cert_def, key);
+    if (ESP_OK != nvs_open(ATCA_CERT_CACHE_NVS_NAMESPACE, NVS_READONLY, &handle))
+    {
+        return ATCA_FUNC_FAIL;
+    }
+
+    if (ESP_OK == nvs_get_blob(handle, key, NULL, &blob_size) && blob_size > sizeof(header)
+        && NULL != (blob = malloc(blob_size))
+        && ESP_OK == nvs_get_blob(handle, key, blob, &blob_size))
+    {
+        memcpy(&header, blob, sizeof(header));
+        if (header.magic == identity->magic
+            && 0 == memcmp(header.serial_number, identity->serial_number, sizeof(header.serial_number))
+            && 0 == memcmp(header.comp_cert_digest, identity->comp_cert_digest, sizeof(header.comp_cert_digest))
+            && header.der_size == blob_size - sizeof(header))
+        {
+            // Reuse the blob, the DER moves to the front
+            memmove(blob, &blob[sizeof(header)], header.der_size);
+            *der = blob;
+            *der_size = header.der_size;
+            blob = NULL;
+            ret = ATCA_SUCCESS;
+        }
+        else
+        {
+            ESP_LOGI(TAG, "Stored %s is for another device or certificate", key);
+        }
+    }
+
+    free(blob);
+    nvs_close(handle);
+
+    return ret;
+}
+
+static void atca_cert_cache_store(const atcacert_def_t* cert_def, atca_cert_cache_header_t* identity,
+                                  const uint8_t* der, size_t der_size)
+{
+    nvs_handle handle;
+    char key[16];
+    uint8_t* blob;
+
+    atca_cert_cache_nvs_key(cert_def, key);
+    identity->der_size = (uint16_t)der_size;
+
+    if (NULL == (blob = malloc(sizeof(*identity) + der_size)))
+    {
+        return;
+    }
+    memcpy(blob, identity, sizeof(*identity));
+    memcpy(&blob[sizeof(*identity)], der, der_size);
+
+    if (ESP_OK == nvs_open(ATCA_CERT_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle))
+    {
+        if (ESP_OK != nvs_set_blob(handle, key, blob, sizeof(*identity) + der_size) || ESP_OK != nvs_commit(handle))
+        {
+            ESP_LOGW(TAG, "Could not store %s", key);
+        }
+        nvs_close(handle);
+    }
+
+    free(blob);
+}
+
+/** \brief Rebuild a certificate on the device, as atca_mbedtls_cert_add() does */
+static int atca_cert_cache_rebuild(const atcacert_def_t* cert_def, uint8_t** der, size_t* der_size)
+{
+    uint8_t ca_key[64];
+    size_t cert_size = cert_def->cert_template_size + 8;
+    uint8_t* cert_buf;
+    int ret = ATCA_SUCCESS;
+
+    if (cert_def->ca_cert_def)
+    {
+        const atcacert_device_loc_t * ca_key_cfg = &cert_def->ca_cert_def->public_key_dev_loc;
+
+        if (ca_key_cfg->is_genkey)
+        {
+            ret = atcab_get_pubkey(ca_key_cfg->slot, ca_key);
+        }
+        else
+        {
+            ret = atcab_read_pubkey(ca_key_cfg->slot, ca_key);
+        }
+    }
+    if (ATCA_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    if (NULL == (cert_buf = malloc(cert_size)))
+    {
+        return ATCA_ALLOC_FAILURE;
+    }
+
+    ret = atcacert_read_cert(cert_def, cert_def->ca_cert_def ? ca_key : NULL, cert_buf, &cert_size);
+    if (ATCACERT_E_SUCCESS != ret)
+    {
+        free(cert_buf);
+        return ret;
+    }
+
+    *der = cert_buf;
+    *der_size = cert_size;
+
+    return ATCA_SUCCESS;
+}
+
+static atca_cert_cache_entry_t* atca_cert_cache_find(const atcacert_def_t* cert_def)
+{
+    int i;
+
+    for (i = 0; i < ATCA_CERT_CACHE_ENTRIES; i++)
+    {
+        if (cache_entries[i].cert_def == cert_def && cache_entries[i].der)
+        {
+            return &cache_entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void atca_cert_cache_forget(const atcacert_def_t* cert_def)
+{
+    atca_cert_cache_entry_t* entry = atca_cert_cache_find(cert_def);
+    nvs_handle handle;
+    char key[16];
+
+    if (entry)
+    {
+        free(entry->der);
+        memset(entry, 0, sizeof(*entry));
+    }
+
+    atca_cert_cache_nvs_key(cert_def, key);
+    if (ESP_OK == nvs_open(ATCA_CERT_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle))
+    {
+        nvs_erase_key(handle, key);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+
+int atca_cert_cache_get(const atcacert_def_t* cert_def, const uint8_t** der, size_t* der_size)
+{
+    atca_cert_cache_entry_t* entry;
+    atca_cert_cache_header_t identity;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    int identity_ret;
+    int ret;
+    int i;
+
+    if (NULL == cert_def || NULL == der || NULL == der_size)
+    {
+        return ATCA_BAD_PARAM;
+    }
+
+    if (NULL == (entry = atca_cert_cache_find(cert_def)))
+    {
+        for (i = 0; i < ATCA_CERT_CACHE_ENTRIES && NULL == entry; i++)
+        {
+            if (NULL == cache_entries[i].der)
+            {
+                entry = &cache_entries[i];
+            }
+        }
+        if (NULL == entry)
+        {
+            ESP_LOGW(TAG, "Cache full, raise ATCA_CERT_CACHE_ENTRIES");
+            return ATCA_ALLOC_FAILURE;
+        }
+
+        // The identity validates the NVS copy and is stored with a new one
+        identity_ret = atca_cert_cache_read_identity(cert_def, &identity);
+        if (ATCA_SUCCESS == identity_ret
+            && ATCA_SUCCESS == atca_cert_cache_load(cert_def, &identity, &cert, &cert_size))
+        {
+            ESP_LOGD(TAG, "Certificate loaded from NVS");
+        }
+        else
+        {
+            if (ATCA_SUCCESS != (ret = atca_cert_cache_rebuild(cert_def, &cert, &cert_size)))
+            {
+                return ret;
+            }
+            // Without a complete identity the copy could never be validated, keep it in RAM only
+            if (ATCA_SUCCESS == identity_ret)
+            {
+                atca_cert_cache_store(cert_def, &identity, cert, cert_size);
+            }
+            else
+            {
+                ESP_LOGW(TAG, "Device identity not read (0x%x), certificate not stored", identity_ret);
+            }
+        }
+
+        entry->cert_def = cert_def;
+        entry->der = cert;
+        entry->der_size = cert_size;
+    }
+
+    *der = entry->der;
+    *der_size = entry->der_size;
+
+    return ATCA_SUCCESS;
+}
+
+int atca_cert_cache_add(mbedtls_x509_crt * cert, const atcacert_def_t * cert_def)
+{
+    const uint8_t* der;
+    size_t der_size;
+    int ret;
+
+    if (ATCA_SUCCESS != atca_cert_cache_get(cert_def, &der, &der_size))
+    {
+        // Whatever went wrong, the uncached path still gets a certificate if the device can
+        return atca_mbedtls_cert_add(cert, cert_def);
+    }
+
+    ret = mbedtls_x509_crt_parse_der(cert, der, der_size);
+    if (0 != ret)
+    {
+        // A damaged copy must not stick around, rebuild it once from the device
+        ESP_LOGW(TAG, "Cached certificate did not parse (-0x%x), rebuilding it", -ret);
+        atca_cert_cache_forget(cert_def);
+        if (ATCA_SUCCESS != (ret = atca_cert_cache_get(cert_def, &der, &der_size)))
+        {
+            return ret;
+        }
+        ret = mbedtls_x509_crt_parse_der(cert, der, der_size);
+    }
+
+    return ret;
+}
+
+void atca_cert_cache_clear(void)
+{
+    nvs_handle handle;
+    int i;
+
+    for (i = 0; i < ATCA_CERT_CACHE_ENTRIES; i++)
+    {
+        free(cache_entries[i].der);
+        memset(&cache_entries[i], 0, sizeof(cache_entries[i]));
+    }
+
+    if (ESP_OK == nvs_open(ATCA_CERT_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle))
+    {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+
+#endif /* CONFIG_ATCA_CERT_CACHE */
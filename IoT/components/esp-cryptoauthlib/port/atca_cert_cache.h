@@ -0,0 +1,62 @@
+/**
+ * \file
+ * \brief Cache of certificates rebuilt from the ATECC608 compressed certificates
+ *
+ * Rebuilding a certificate from its atcacert definition reads the compressed
+ * certificate, the serial number and the public keys over I2C and then
+ * reconstructs the DER encoding. The cache keeps the result in RAM for the
+ * rest of the boot and in NVS across boots, so later TLS connections get the
+ * certificate without touching the device.
+ *
+ * An NVS copy is only used when it was made from the same device serial
+ * number and the same compressed certificate (compared by SHA256 digest),
+ * which costs two short reads on the first use after boot. Reprovisioning
+ * the device therefore invalidates it on its own.
+ *
+ * Entries are looked up by certificate definition, so the device and signer
+ * certificates of a Trust&GO chain are cached separately. NVS must have been
+ * initialized with nvs_flash_init(); without it only the RAM cache is used.
+ * The cache is not locked, use it from the task that makes TLS connections.
+ */
+
+#ifndef ATCA_CERT_CACHE_H_
+#define ATCA_CERT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mbedtls_x509_crt;
+struct atcacert_def_s;
+
+/** \brief Number of certificate definitions the cache holds */
+#ifndef ATCA_CERT_CACHE_ENTRIES
+#define ATCA_CERT_CACHE_ENTRIES 2
+#endif
+
+/** \brief Get the DER encoding of a certificate, rebuilding it only on a cache miss
+ * \param[in]  cert_def  Certificate definition
+ * \param[out] der       Certificate, owned by the cache and valid until atca_cert_cache_clear()
+ * \param[out] der_size  Size of the certificate
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+int atca_cert_cache_get(const struct atcacert_def_s * cert_def, const uint8_t ** der, size_t * der_size);
+
+/** \brief Drop-in replacement for atca_mbedtls_cert_add() that goes through the cache
+ * \param[in,out] cert mbedtls cert chain. Must have already been initialized
+ * \param[in] cert_def Certificate definition that will be added
+ * \return 0 on success, otherwise an error code.
+ */
+int atca_cert_cache_add(struct mbedtls_x509_crt * cert, const struct atcacert_def_s * cert_def);
+
+/** \brief Forget every cached certificate, in RAM and in NVS */
+void atca_cert_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATCA_CERT_CACHE_H_ */
@@ -0,0 +1,271 @@
+/**
+ * \file
+ * \brief Pool of ATECC608 random blocks in front of a local CTR-DRBG
+ */
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_ATCA_ENTROPY_POOL
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "esp_log.h"
+
+#include "cryptoauthlib.h"
+
+#ifdef CONFIG_ATCA_ENTROPY_POOL_BLOCKS
+#define ATCA_ENTROPY_POOL_BLOCKS CONFIG_ATCA_ENTROPY_POOL_BLOCKS
+#endif
+#include "atca_entropy_pool.h"
+
+#define ATCA_ENTROPY_POOL_SIZE  (ATCA_ENTROPY_POOL_BLOCKS * RANDOM_NUM_SIZE)
+
+static const char *TAG = "atca_entropy_pool";
+static const char personalization[] = "atca_entropy_pool";
+
+static SemaphoreHandle_t pool_mutex;
+static mbedtls_ctr_drbg_context drbg;
+static bool drbg_seeded;
+
+/* Pooled random bytes, consumed from the end */
+static uint8_t pool[ATCA_ENTROPY_POOL_SIZE];
+static size_t pool_bytes;
+
+static atca_entropy_pool_stats_t pool_stats;
+
+static void atca_entropy_pool_zeroize(void* buf, size_t len)
+{
+    volatile uint8_t* p = (volatile uint8_t*)buf;
+
+    while (len--)
+    {
+        *p++ = 0;
+    }
+}
+
+/** \brief Read one block from the device, rejecting the fixed pattern an unlocked device returns */
+static int atca_entropy_pool_read_block(uint8_t block[RANDOM_NUM_SIZE])
+{
+    ATCA_STATUS status;
+    size_t i;
+
+    status = atcab_random(block);
+    if (ATCA_SUCCESS != status)
+    {
+        return status;
+    }
+
+    for (i = 0; i < RANDOM_NUM_SIZE; i++)
+    {
+        if (block[i] != ((i & 2) ? 0x00 : 0xFF))
+        {
+            return ATCA_SUCCESS;
+        }
+    }
+    ESP_LOGE(TAG, "Device returned the test pattern, its configuration zone is not locked");
+    return ATCA_NOT_LOCKED;
+}
+
+/** \brief mbedtls entropy callback of the generator, called with pool_mutex held */
+static int atca_entropy_pool_entropy(void* ctx, unsigned char* output, size_t len)
+{
+    uint8_t block[RANDOM_NUM_SIZE];
+    bool counted = false;
+    size_t chunk;
+
+    (void)ctx;
+    pool_stats.reseeds++;
+
+    while (len > 0)
+    {
+        if (0 == pool_bytes)
+        {
+            if (!counted)
+            {
+                pool_stats.empty_reseeds++;
+                counted = true;
+            }
+            pool_stats.random_commands++;
+            if (ATCA_SUCCESS != atca_entropy_pool_read_block(block))
+            {
+                return MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+            }
+            chunk = len < sizeof(block) ? len : sizeof(block);
+            memcpy(output, block, chunk);
+            atca_entropy_pool_zeroize(block, sizeof(block));
+        }
+        else
+        {
+            chunk = len < pool_bytes ? len : pool_bytes;
+            pool_bytes -= chunk;
+            memcpy(output, &pool[pool_bytes], chunk);
+            atca_entropy_pool_zeroize(&pool[pool_bytes], chunk);
+        }
+        output += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+int atca_entropy_pool_refill(void)
+{
+    uint8_t block[RANDOM_NUM_SIZE];
+    int ret = ATCA_SUCCESS;
+
+    if (NULL == pool_mutex)
+    {
+        return ATCA_FUNC_FAIL;
+    }
+
+    for (;;)
+    {
+        xSemaphoreTake(pool_mutex, portMAX_DELAY);
+        if (pool_bytes + sizeof(block) > sizeof(pool))
+        {
+            xSemaphoreGive(pool_mutex);
+            break;
+        }
+        xSemaphoreGive(pool_mutex);
+
+        /* The device is read without the lock, generator users only wait for the copy */
+        ret = atca_entropy_pool_read_block(block);
+
+        xSemaphoreTake(pool_mutex, portMAX_DELAY);
+        pool_stats.random_commands++;
+        if (ATCA_SUCCESS != ret)
+        {
+            xSemaphoreGive(pool_mutex);
+            break;
+        }
+        if (pool_bytes + sizeof(block) <= sizeof(pool))
+        {
+            memcpy(&pool[pool_bytes], block, sizeof(block));
+            pool_bytes += sizeof(block);
+        }
+        xSemaphoreGive(pool_mutex);
+    }
+
+    atca_entropy_pool_zeroize(block, sizeof(block));
+    return ret;
+}
+
+int atca_entropy_pool_init(void)
+{
+    int ret;
+
+    if (NULL == pool_mutex)
+    {
+        if (NULL == (pool_mutex = xSemaphoreCreateMutex()))
+        {
+            return ATCA_ALLOC_FAILURE;
+        }
+    }
+
+    if (ATCA_SUCCESS != (ret = atca_entropy_pool_refill()))
+    {
+        ESP_LOGE(TAG, "atcab_random returned %02x", ret);
+        return ret;
+    }
+
+    xSemaphoreTake(pool_mutex, portMAX_DELAY);
+    if (!drbg_seeded)
+    {
+        mbedtls_ctr_drbg_init(&drbg);
+        ret = mbedtls_ctr_drbg_seed(&drbg, atca_entropy_pool_entropy, NULL,
+                                    (const unsigned char*)personalization, sizeof(personalization) - 1);
+        if (0 == ret)
+        {
+            mbedtls_ctr_drbg_set_reseed_interval(&drbg, ATCA_ENTROPY_POOL_RESEED_INTERVAL);
+            drbg_seeded = true;
+        }
+        else
+        {
+            ESP_LOGE(TAG, "mbedtls_ctr_drbg_seed returned -0x%x", -ret);
+            mbedtls_ctr_drbg_free(&drbg);
+        }
+    }
+    xSemaphoreGive(pool_mutex);
+
+    if (0 != ret)
+    {
+        return ret;
+    }
+
+    /* Seeding took blocks out of the pool, top it up while nothing else runs */
+    return atca_entropy_pool_refill();
+}
+
+int atca_entropy_pool_random(void* ctx, unsigned char* output, size_t len)
+{
+    size_t chunk;
+    int ret = 0;
+
+    (void)ctx;
+
+    if (NULL == pool_mutex)
+    {
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+
+    xSemaphoreTake(pool_mutex, portMAX_DELAY);
+    if (!drbg_seeded)
+    {
+        xSemaphoreGive(pool_mutex);
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+
+    pool_stats.requests++;
+    pool_stats.bytes += len;
+    pool_stats.commands_avoided += (len + RANDOM_NUM_SIZE - 1) / RANDOM_NUM_SIZE;
+
+    while (len > 0 && 0 == ret)
+    {
+        chunk = len < MBEDTLS_CTR_DRBG_MAX_REQUEST ? len : MBEDTLS_CTR_DRBG_MAX_REQUEST;
+        ret = mbedtls_ctr_drbg_random(&drbg, output, chunk);
+        output += chunk;
+        len -= chunk;
+    }
+    xSemaphoreGive(pool_mutex);
+
+    return ret;
+}
+
+void atca_entropy_pool_get_stats(atca_entropy_pool_stats_t* stats)
+{
+    if (NULL != pool_mutex)
+    {
+        xSemaphoreTake(pool_mutex, portMAX_DELAY);
+    }
+    *stats = pool_stats;
+    stats->blocks = pool_bytes / RANDOM_NUM_SIZE;
+    if (NULL != pool_mutex)
+    {
+        xSemaphoreGive(pool_mutex);
+    }
+}
+
+void atca_entropy_pool_free(void)
+{
+    if (NULL == pool_mutex)
+    {
+        return;
+    }
+
+    xSemaphoreTake(pool_mutex, portMAX_DELAY);
+    if (drbg_seeded)
+    {
+        mbedtls_ctr_drbg_free(&drbg);
+        drbg_seeded = false;
+    }
+    atca_entropy_pool_zeroize(pool, sizeof(pool));
+    pool_bytes = 0;
+    xSemaphoreGive(pool_mutex);
+}
+
+#endif /* CONFIG_ATCA_ENTROPY_POOL */
@@ -0,0 +1,87 @@
+/**
+ * \file
+ * \brief Pool of ATECC608 random blocks in front of a local CTR-DRBG
+ *
+ * Every atcab_random() is a full I2C command: wake, send, wait for the
+ * execution time, read 32 bytes, idle. The pool pulls several of those
+ * blocks in one go at a time the bus is otherwise quiet and keeps them in
+ * RAM. Random bytes are then produced by an AES CTR-DRBG that is seeded and
+ * periodically reseeded from the pooled blocks, so a TLS handshake, a nonce
+ * or a client token costs no I2C traffic at all while the pool has blocks.
+ *
+ * The device is never read from a background task, because cryptoauthlib
+ * does not serialize commands between tasks and a handshake is signing on
+ * the same device. The pool is filled by atca_entropy_pool_init(), by
+ * atca_entropy_pool_refill() at the caller's idle points and, only when it
+ * ran dry, directly by a reseed.
+ *
+ * The generator itself is locked, so it can be used from several tasks.
+ */
+
+#ifndef ATCA_ENTROPY_POOL_H_
+#define ATCA_ENTROPY_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \brief Number of 32 byte blocks the pool holds */
+#ifndef ATCA_ENTROPY_POOL_BLOCKS
+#define ATCA_ENTROPY_POOL_BLOCKS 4
+#endif
+
+/** \brief Generator requests served between two reseeds from the pool */
+#ifndef ATCA_ENTROPY_POOL_RESEED_INTERVAL
+#define ATCA_ENTROPY_POOL_RESEED_INTERVAL 256
+#endif
+
+/** \brief Pool counters */
+typedef struct
+{
+    uint32_t random_commands;   //!< atcab_random() commands sent to the device
+    uint32_t commands_avoided;  //!< atcab_random() commands the served requests would have needed
+    uint32_t requests;          //!< Requests served by the generator
+    uint32_t bytes;             //!< Random bytes served by the generator
+    uint32_t reseeds;           //!< Reseeds of the generator
+    uint32_t empty_reseeds;     //!< Reseeds that found the pool empty and read the device directly
+    uint32_t blocks;            //!< Blocks in the pool right now
+} atca_entropy_pool_stats_t;
+
+/** \brief Create the generator and fill the pool
+ *
+ * The device must have been initialized with atcab_init(). Calling it again
+ * only tops up the pool.
+ *
+ * \return 0 on success, otherwise an mbedtls or ATCA error code.
+ */
+int atca_entropy_pool_init(void);
+
+/** \brief Top up the pool, call it when the device is otherwise idle
+ * \return 0 on success, otherwise the atcab_random() error code.
+ */
+int atca_entropy_pool_refill(void);
+
+/** \brief mbedtls f_rng compatible generator, e.g. for mbedtls_ssl_conf_rng()
+ * \param[in]  ctx     Unused, may be NULL
+ * \param[out] output  Random bytes
+ * \param[in]  len     Number of bytes wanted
+ * \return 0 on success, otherwise an mbedtls error code.
+ */
+int atca_entropy_pool_random(void * ctx, unsigned char * output, size_t len);
+
+/** \brief Read the pool counters
+ * \param[out] stats Counters
+ */
+void atca_entropy_pool_get_stats(atca_entropy_pool_stats_t * stats);
+
+/** \brief Drop the generator state and the pooled blocks */
+void atca_entropy_pool_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATCA_ENTROPY_POOL_H_ */
@@ -2,6 +2,33 @@
 
 #include "bm8563.h"     // includes type rtc_date_t
 
+/*
+ * The update functions can be called from any task without taking
+ * xGuiSemaphore: they post the update and the gui task applies it before
+ * its next rendering pass.
+ */
+
+typedef struct {
+    uint32_t posted;            // updates posted
+    uint32_t coalesced;         // state updates replaced by a newer one before they were shown
+    uint32_t dropped;           // textarea messages lost to a full queue
+    uint32_t max_depth;         // most textarea pieces a producer had waiting
+    uint32_t drain_max_us;      // longest time applying the waiting updates took
+    uint32_t gui_hold_max_us;   // longest time the gui task held xGuiSemaphore
+} ui_queue_stats_t;
+
+typedef struct {
+    uint32_t applied;       // updates that changed a widget or the LEDs
+    uint32_t skipped;       // updates that matched what is already shown
+    uint32_t redrawn_px;    // pixels LVGL redrew because of invalidated areas
+    uint32_t spi_bytes;     // bytes sent to the display
+    uint32_t frames;        // lvgl passes that redrew something
+    uint32_t frame_us;      // time those passes took
+    uint32_t frame_max_us;  // the longest of them
+    uint32_t glyph_hits;    // compressed font glyphs found already decompressed
+    uint32_t glyph_misses;  // compressed font glyphs decompressed
+} ui_render_stats_t;
+
 // initializes ui components
 void ui_init();
 
@@ -25,3 +52,9 @@ void ui_set_led_color(uint32_t color);
 
 // easter egg
 void ui_activate_easter_egg(char *text);
+
+// reads the UI queue counters
+void ui_get_queue_stats(ui_queue_stats_t *stats);
+
+// reads the rendering counters, they count up from boot
+void ui_get_render_stats(ui_render_stats_t *stats);
@@ -17,6 +17,10 @@
 #include "aws_iot_version.h"
 #include "aws_iot_mqtt_client_interface.h"
 #include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_mirror.h"
+#include "aws_iot_latency_trace.h"
+#include "aws_iot_buffer_arena.h"
+#include "deferred_log_platform.h"
 
 #include "core2forAWS.h"
 
@@ -25,8 +29,22 @@
 
 static const char *TAG = "MAIN";
 
+/* Messages logged from the aws_iot_task loop every second. With deferred logging they are
+   recorded unformatted and decoded on the host, see tools/aws_iot_deferred_log_decode.py */
+#ifdef CONFIG_AWS_IOT_DEFERRED_LOG
+#define LOOP_LOGI(tag, format, ...) IOT_DEFERRED_LOGI(tag, format, ##__VA_ARGS__)
+#else
+#define LOOP_LOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#endif
+
 #define MAX_LENGTH_OF_UPDATE_JSON_BUFFER 200
 
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+/* Wait between attempts to seed the shadow mirror, doubled after each attempt */
+#define SHADOW_RESYNC_MIN_BACKOFF_MS 5000
+#define SHADOW_RESYNC_MAX_BACKOFF_MS 60000
+#endif
+
 /* CA Root certificate */
 extern const uint8_t aws_root_ca_pem_start[] asm("_binary_aws_root_ca_pem_start");
 extern const uint8_t aws_root_ca_pem_end[] asm("_binary_aws_root_ca_pem_end");
@@ -60,6 +78,9 @@ void disconnect_callback_handler(AWS_IoT_Client *pClient, void *data) {
         rc = aws_iot_mqtt_attempt_reconnect(pClient);
         if(NETWORK_RECONNECTED == rc) {
             ESP_LOGW(TAG, "Manual Reconnect Successful");
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+            aws_iot_shadow_mirror_invalidate();     // shadow updates published while offline were missed
+#endif
         } else {
             ESP_LOGW(TAG, "Manual Reconnect Failed - %d", rc);
         }
@@ -68,6 +89,59 @@ void disconnect_callback_handler(AWS_IoT_Client *pClient, void *data) {
 
 static bool shadowUpdateInProgress;
 
+#ifdef ENABLE_IOT_LATENCY_TRACE
+static bool latencyTraceReady;  // set once the shadow update round trip has completed
+
+// prints the trace of the last update on the console and optionally publishes it as a compact blob.
+// Called from the main loop, publishing from inside the shadow callback would re-enter yield.
+static void latency_trace_report(AWS_IoT_Client *pClient, const char *client_id) {
+    aws_iot_latency_trace_dump();
+
+#ifdef CONFIG_LATENCY_TRACE_PUBLISH
+    static unsigned char traceBlob[AWS_IOT_MQTT_TX_BUF_LEN - MAX_SHADOW_TOPIC_LENGTH_BYTES - 8];
+    char topic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+    IoT_Publish_Message_Params params;
+
+    snprintf(topic, sizeof(topic), "%s/latency_trace", client_id);
+    params.qos = QOS0;
+    params.isRetained = 0;
+    params.payload = traceBlob;
+    params.payloadLen = aws_iot_latency_trace_serialize(traceBlob, sizeof(traceBlob));
+
+    IoT_Error_t rc = aws_iot_mqtt_publish(pClient, topic, (uint16_t) strlen(topic), &params);
+    if(SUCCESS != rc) {
+        ESP_LOGW(TAG, "Latency trace publish failed %d", rc);
+    }
+#else
+    IOT_UNUSED(pClient);
+    IOT_UNUSED(client_id);
+#endif
+
+    aws_iot_latency_trace_reset();
+}
+#endif
+
+#ifdef CONFIG_AWS_IOT_BUFFER_ARENA_REPORT
+// logs the peak use of the shared buffer arena, use it to size CONFIG_AWS_IOT_BUFFER_ARENA_SIZE
+static void log_arena_usage(void) {
+    IoT_Arena_Region_Stats_t tx, rx, shadowRx, tokens, doc, topic;
+
+    aws_iot_arena_get_stats(IOT_ARENA_MQTT_TX, &tx);
+    aws_iot_arena_get_stats(IOT_ARENA_MQTT_RX, &rx);
+    aws_iot_arena_get_stats(IOT_ARENA_SHADOW_RX, &shadowRx);
+    aws_iot_arena_get_stats(IOT_ARENA_JSON_TOKENS, &tokens);
+    aws_iot_arena_get_stats(IOT_ARENA_SHADOW_DOC, &doc);
+    aws_iot_arena_get_stats(IOT_ARENA_TOPIC, &topic);
+
+    LOOP_LOGI(TAG, "Buffer arena: peak %u of %u bytes, %u allocations refused",
+              (unsigned) aws_iot_arena_get_peak(), AWS_IOT_BUFFER_ARENA_SIZE,
+              tx.failCount + rx.failCount + shadowRx.failCount + tokens.failCount + doc.failCount + topic.failCount);
+    LOOP_LOGI(TAG, "Buffer arena peaks: mqtt tx %u, rx %u, shadow rx %u, json tokens %u, shadow doc %u, topic %u",
+              (unsigned) tx.peakBytes, (unsigned) rx.peakBytes, (unsigned) shadowRx.peakBytes,
+              (unsigned) tokens.peakBytes, (unsigned) doc.peakBytes, (unsigned) topic.peakBytes);
+}
+#endif
+
 void ShadowUpdateStatusCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
                                 const char *pReceivedJsonDocument, void *pContextData) {
     IOT_UNUSED(pThingName);
@@ -75,7 +149,11 @@ void ShadowUpdateStatusCallback(const char *pThingName, ShadowActions_t action,
     IOT_UNUSED(pReceivedJsonDocument);
     IOT_UNUSED(pContextData);
 
+    IOT_LATENCY_TRACE(IOT_TRACE_APP_ACK_HANDLED, status);
     shadowUpdateInProgress = false;
+#ifdef ENABLE_IOT_LATENCY_TRACE
+    latencyTraceReady = true;
+#endif
 
     if(SHADOW_ACK_TIMEOUT == status) {
         ESP_LOGE(TAG, "Update timed out");
@@ -86,6 +164,32 @@ void ShadowUpdateStatusCallback(const char *pThingName, ShadowActions_t action,
     }
 }
 
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+void ShadowGetStatusCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+                             const char *pReceivedJsonDocument, void *pContextData) {
+    IOT_UNUSED(pThingName);
+    IOT_UNUSED(action);
+    IOT_UNUSED(pReceivedJsonDocument);
+    IOT_UNUSED(pContextData);
+
+    shadowUpdateInProgress = false;
+
+    // the document itself has already been merged into the mirror by the shadow client,
+    // a 404 for a thing without a shadow seeds it empty
+    if(!aws_iot_shadow_mirror_needs_resync()) {
+        char reported[32];
+        if(SUCCESS != aws_iot_shadow_mirror_get_string(SHADOW_MIRROR_REPORTED, "cleaningStatus",
+                                                       reported, sizeof(reported))) {
+            strcpy(reported, "none");
+        }
+        ESP_LOGI(TAG, "Shadow mirror seeded at version %u, reported cleaning status %s",
+                 aws_iot_shadow_mirror_get_version(), reported);
+    } else {
+        ESP_LOGW(TAG, "Shadow get failed (%d), retrying later", status);
+    }
+}
+#endif
+
 void cleaningStatus_Callback(const char *pJsonString, uint32_t JsonStringDataLen, jsonStruct_t *pContext) {
     IOT_UNUSED(pJsonString);
     IOT_UNUSED(JsonStringDataLen);
@@ -107,8 +211,12 @@ char cleaningStatus[32] = "";
 void aws_iot_task(void *param) {
     IoT_Error_t rc = FAILURE;
 
+#ifdef ENABLE_IOT_BUFFER_ARENA
+    char *JsonDocumentBuffer = NULL;    // taken from the shared buffer arena only while an update is composed and sent
+#else
     char JsonDocumentBuffer[MAX_LENGTH_OF_UPDATE_JSON_BUFFER];
-    size_t sizeOfJsonDocumentBuffer = sizeof(JsonDocumentBuffer) / sizeof(JsonDocumentBuffer[0]);
+#endif
+    size_t sizeOfJsonDocumentBuffer = MAX_LENGTH_OF_UPDATE_JSON_BUFFER;
 
     jsonStruct_t timestampStatusActuator;
     timestampStatusActuator.cb = NULL;
@@ -230,6 +338,17 @@ void aws_iot_task(void *param) {
     BM8563_GetTime(&dueDate);
     dueDate.hour+=1;
 
+    ui_render_stats_t lastRenderStats;
+    ui_get_render_stats(&lastRenderStats);
+    uint8_t renderStatsMinute = dueDate.minute;
+
+    bool cleanedUpdatePending = false;  // Cleaned was pressed but its shadow update has not been sent yet
+
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+    TickType_t resyncBackoff = pdMS_TO_TICKS(SHADOW_RESYNC_MIN_BACKOFF_MS);
+    TickType_t nextResync = xTaskGetTickCount();
+#endif
+
     // loop and publish changes
     while(NETWORK_ATTEMPTING_RECONNECT == rc || NETWORK_RECONNECTED == rc || SUCCESS == rc) {
         rc = aws_iot_shadow_yield(&iotCoreClient, 200);
@@ -246,7 +365,7 @@ void aws_iot_task(void *param) {
         ui_date_label_update(date);     // show time on UI
 
         int timediff = (dueDate.hour * 60 + dueDate.minute) - (date.hour * 60 + date.minute);   // minutes between now and cleaning due time
-        ESP_LOGI(TAG, "timediff: %d", timediff);
+        LOOP_LOGI(TAG, "timediff: %d", timediff);
         if (timediff < 0)
             ui_set_led_color(0xFF0000); // set LED strips to RED if no time left
         else if (timediff < 15)
@@ -258,8 +377,36 @@ void aws_iot_task(void *param) {
             timediff = 0;
         ui_set_due_bar(timediff * 100 / 60);    // show remaining time on the progressbar as well
 
+        if (date.minute != renderStatsMinute) {    // once a minute, log how much the UI redrew
+            ui_render_stats_t renderStats;
+            ui_get_render_stats(&renderStats);
+            LOOP_LOGI(TAG, "UI last minute: %u updates applied, %u skipped, %u px redrawn, %u SPI bytes",
+                      renderStats.applied - lastRenderStats.applied, renderStats.skipped - lastRenderStats.skipped,
+                      renderStats.redrawn_px - lastRenderStats.redrawn_px, renderStats.spi_bytes - lastRenderStats.spi_bytes);
+            uint32_t frames = renderStats.frames - lastRenderStats.frames;
+            LOOP_LOGI(TAG, "UI last minute: %u frames, %u us average, %u us longest since boot",
+                      frames, frames ? (renderStats.frame_us - lastRenderStats.frame_us) / frames : 0, renderStats.frame_max_us);
+            uint32_t glyphs = (renderStats.glyph_hits - lastRenderStats.glyph_hits) + (renderStats.glyph_misses - lastRenderStats.glyph_misses);
+            if (glyphs)
+                LOOP_LOGI(TAG, "UI last minute: %u compressed glyphs drawn, %u%% from the glyph cache",
+                          glyphs, (renderStats.glyph_hits - lastRenderStats.glyph_hits) * 100 / glyphs);
+            lastRenderStats = renderStats;
+            renderStatsMinute = date.minute;
+#ifdef CONFIG_AWS_IOT_BUFFER_ARENA_REPORT
+            log_arena_usage();
+#endif
+        }
+
         // END get sensor readings
 
+#ifdef ENABLE_IOT_LATENCY_TRACE
+        if (latencyTraceReady) {    // first UI refresh after the update was acknowledged closes the trace
+            IOT_LATENCY_TRACE(IOT_TRACE_APP_UI_UPDATED, 0);
+            latencyTraceReady = false;
+            latency_trace_report(&iotCoreClient, client_id);
+        }
+#endif
+
 
         // if room is cleaned
         if (is_cleaned_button_clicked()) { // send message only if Cleaned
@@ -273,31 +420,80 @@ void aws_iot_task(void *param) {
             sprintf(cleaningStatus, "CLEANED");         // Cleaning status
 
             // log
-            ESP_LOGI(TAG, "*****************************************************************************************");
-            ESP_LOGI(TAG, "On Device: timestampStatus %s", timestampStatus);
-            ESP_LOGI(TAG, "On Device: clientidStatus %s", clientidStatus);
-            ESP_LOGI(TAG, "On Device: cleaningStatus %s", cleaningStatus);
+            LOOP_LOGI(TAG, "*****************************************************************************************");
+            LOOP_LOGI(TAG, "On Device: timestampStatus %s", timestampStatus);
+            LOOP_LOGI(TAG, "On Device: clientidStatus %s", clientidStatus);
+            LOOP_LOGI(TAG, "On Device: cleaningStatus %s", cleaningStatus);
 
-            // compose and update shadow document with: timestamp + clientid + cleaningstatus
-            rc = aws_iot_shadow_init_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
-            if(SUCCESS == rc) {
-                rc = aws_iot_shadow_add_reported(JsonDocumentBuffer, sizeOfJsonDocumentBuffer, 3,
-                    &timestampStatusActuator,
-                    &clientidStatusActuator,
-                    &cleaningStatusActuator);
+            cleanedUpdatePending = true;
+        }
+
+        if (cleanedUpdatePending) {    // the press stays pending until its update has been sent
+            bool haveBuffer = true;
+#ifdef ENABLE_IOT_BUFFER_ARENA
+            IoT_Arena_Mark_t updateScope = aws_iot_arena_mark();
+            JsonDocumentBuffer = (char *) aws_iot_arena_alloc(IOT_ARENA_SHADOW_DOC, sizeOfJsonDocumentBuffer);
+            haveBuffer = (JsonDocumentBuffer != NULL);
+            if (!haveBuffer) {
+                ESP_LOGW(TAG, "No buffer arena space for the shadow document, retrying on the next loop");
+            }
+#endif
+
+            if (haveBuffer) {
+                cleanedUpdatePending = false;
+
+                // compose and update shadow document with: timestamp + clientid + cleaningstatus
+                rc = aws_iot_shadow_init_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
                 if(SUCCESS == rc) {
-                    rc = aws_iot_finalize_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
+                    rc = aws_iot_shadow_add_reported(JsonDocumentBuffer, sizeOfJsonDocumentBuffer, 3,
+                        &timestampStatusActuator,
+                        &clientidStatusActuator,
+                        &cleaningStatusActuator);
                     if(SUCCESS == rc) {
-                        ESP_LOGI(TAG, "Update Shadow: %s", JsonDocumentBuffer);
-                        rc = aws_iot_shadow_update(&iotCoreClient, client_id, JsonDocumentBuffer,
-                                                ShadowUpdateStatusCallback, NULL, 4, true);
-                        shadowUpdateInProgress = true;
+                        rc = aws_iot_finalize_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
+                        if(SUCCESS == rc) {
+                            ESP_LOGI(TAG, "Update Shadow: %s", JsonDocumentBuffer);
+                            IOT_LATENCY_TRACE(IOT_TRACE_APP_UPDATE_REQUEST, strlen(JsonDocumentBuffer));
+                            rc = aws_iot_shadow_update(&iotCoreClient, client_id, JsonDocumentBuffer,
+                                                    ShadowUpdateStatusCallback, NULL, 4, true);
+                            shadowUpdateInProgress = true;
+                        }
                     }
                 }
+
+                LOOP_LOGI(TAG, "*****************************************************************************************");
+                LOOP_LOGI(TAG, "Stack remaining for task '%s' is %d bytes", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL));
+
+                ui_queue_stats_t uiStats;
+                ui_get_queue_stats(&uiStats);
+                LOOP_LOGI(TAG, "UI queue: %u posted, %u coalesced, %u dropped, depth max %u, drain max %u us, gui lock held max %u us",
+                          uiStats.posted, uiStats.coalesced, uiStats.dropped, uiStats.max_depth, uiStats.drain_max_us,
+                          uiStats.gui_hold_max_us);
+            }
+#ifdef ENABLE_IOT_BUFFER_ARENA
+            aws_iot_arena_release(updateScope);    // the document has been published, give its space back
+            JsonDocumentBuffer = NULL;
+#endif
+        }
+
+#ifdef ENABLE_IOT_SHADOW_MIRROR
+        // seed the mirror once after connecting, and again whenever it may have missed updates.
+        // Attempts back off so a failing get does not keep the shadow busy.
+        if (!aws_iot_shadow_mirror_needs_resync()) {
+            resyncBackoff = pdMS_TO_TICKS(SHADOW_RESYNC_MIN_BACKOFF_MS);
+        } else if (!shadowUpdateInProgress && (int32_t) (xTaskGetTickCount() - nextResync) >= 0) {
+            rc = aws_iot_shadow_get(&iotCoreClient, client_id, ShadowGetStatusCallback, NULL, 4, false);
+            if(SUCCESS == rc) {
+                shadowUpdateInProgress = true;
+            } else {
+                ESP_LOGW(TAG, "Shadow get error %d", rc);
+                rc = SUCCESS;   // keep the cached values and retry later
             }
-            ESP_LOGI(TAG, "*****************************************************************************************");
-            ESP_LOGI(TAG, "Stack remaining for task '%s' is %d bytes", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL));
+            nextResync = xTaskGetTickCount() + resyncBackoff;
+            if (resyncBackoff < pdMS_TO_TICKS(SHADOW_RESYNC_MAX_BACKOFF_MS))
+                resyncBackoff *= 2;
         }
+#endif
 
         vTaskDelay(pdMS_TO_TICKS(1000));    // wait 1 sec, then loop
     }
@@ -323,6 +519,9 @@ void app_main()
     Core2ForAWS_LED_Enable(1);
 
     ui_init();
+#ifdef CONFIG_AWS_IOT_DEFERRED_LOG
+    aws_iot_deferred_log_start_drain_task();
+#endif
     initialise_wifi();
 
     xTaskCreatePinnedToCore(&aws_iot_task, "aws_iot_task", 4096*2, NULL, 5, NULL, 1);
@@ -10,13 +10,20 @@
 #include "freertos/event_groups.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "core2forAWS.h"
+#include "aws_iot_latency_trace.h"
 #include "ui.h"
 
-#define MAX_TEXTAREA_LENGTH 1024
+#define LOG_LINE_CNT 32             // lines kept by the debug console, the oldest one is dropped
+#define LOG_LINE_LEN 64             // longer lines are broken
 
-static lv_obj_t *out_txtarea;
+#define UI_QUEUE_LENGTH 8           // textarea pieces per producer ring, a power of two
+#define UI_QUEUE_PRODUCERS 4        // tasks that can post textarea text
+#define UI_CMD_TEXT_LENGTH 96       // longer textarea messages are posted in pieces
+
+static lv_obj_t *out_logview;
 static lv_obj_t *wifi_label;
 static lv_obj_t *room_label;
 static lv_obj_t *date_label;
@@ -29,13 +36,239 @@ char easter_egg_text[200];
 
 static char *TAG = "UI";
 
+/*
+ * UI updates from other tasks are posted as commands and applied by the gui
+ * task right before its lv_task_handler() pass, so a producer never waits
+ * for xGuiSemaphore.
+ *
+ * Widget state (labels, due bar, easter egg) is posted into one latest-value
+ * slot per command type: a newer update replaces one that was not applied
+ * yet, so the last state posted is always shown and nothing is lost when
+ * producers outpace the display. Textarea text is a stream instead. Every
+ * producer task gets a ring of its own on its first post, which keeps each
+ * ring single-producer/single-consumer and lock-free. A message goes into
+ * the ring whole or not at all when the ring is full.
+ */
+typedef enum {
+    UI_CMD_EASTER_EGG,      // state commands, applied in this order
+    UI_CMD_WIFI_LABEL,
+    UI_CMD_DATE_LABEL,
+    UI_CMD_DUE_BAR,
+    UI_CMD_TEXTAREA_ADD,
+} ui_cmd_type_t;
+
+#define UI_CMD_STATE_COUNT UI_CMD_TEXTAREA_ADD
+
+typedef struct {
+    ui_cmd_type_t type;
+    union {
+        char text[UI_CMD_TEXT_LENGTH];
+        struct {
+            bool state;
+            char ssid[33];
+        } wifi;
+        rtc_date_t date;
+        int16_t value;
+    };
+} ui_cmd_t;
+
+typedef struct {
+    TaskHandle_t owner;
+    uint32_t head;      // written by the producer only
+    uint32_t tail;      // written by the gui task only
+    ui_cmd_t cmds[UI_QUEUE_LENGTH];
+} ui_ring_t;
+
+static ui_ring_t ui_rings[UI_QUEUE_PRODUCERS];
+static ui_queue_stats_t ui_stats;
+
+static struct {
+    uint32_t pending;                       // bit per state command waiting to be applied
+    ui_cmd_t cmds[UI_CMD_STATE_COUNT];
+} ui_state;
+static portMUX_TYPE ui_state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * What the widgets and LEDs currently show. Updates are compared against it
+ * and only the objects that really change get touched, so LVGL invalidates
+ * (and the display redraws) nothing when e.g. the time is posted again
+ * within the same minute.
+ */
+static struct {
+    char date_text[sizeof(easter_egg_text)];
+    char wifi_text[100];
+    int16_t due_bar;
+    uint32_t led_color;
+} ui_view;
+static ui_render_stats_t ui_render_stats;
+
+// ring of the calling task, claimed on its first post
+static ui_ring_t *ui_producer_ring(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < UI_QUEUE_PRODUCERS; i++) {
+        if (__atomic_load_n(&ui_rings[i].owner, __ATOMIC_ACQUIRE) == self) {
+            return &ui_rings[i];
+        }
+    }
+    for (int i = 0; i < UI_QUEUE_PRODUCERS; i++) {
+        TaskHandle_t expected = NULL;
+        if (__atomic_compare_exchange_n(&ui_rings[i].owner, &expected, self, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return &ui_rings[i];
+        }
+    }
+    return NULL;
+}
+
+// stores a state command in its slot, replacing the one not applied yet
+static void ui_post_state(const ui_cmd_t *cmd) {
+    uint32_t bit = 1u << cmd->type;
+
+    portENTER_CRITICAL(&ui_state_lock);
+    bool replaced = (ui_state.pending & bit) != 0;
+    ui_state.cmds[cmd->type] = *cmd;
+    ui_state.pending |= bit;
+    portEXIT_CRITICAL(&ui_state_lock);
+    Core2ForAWS_Display_Wake();
+
+    __atomic_add_fetch(&ui_stats.posted, 1, __ATOMIC_RELAXED);
+    if (replaced) {
+        __atomic_add_fetch(&ui_stats.coalesced, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// copies text into the caller's ring in pieces, drops all of it when the ring has no room for every piece
+static void ui_post_text(const char *text) {
+    ui_ring_t *ring = ui_producer_ring();
+    if (ring == NULL) {
+        __atomic_add_fetch(&ui_stats.dropped, 1, __ATOMIC_RELAXED);
+        ESP_LOGE(TAG, "No UI queue left for task %s", pcTaskGetTaskName(NULL));
+        return;
+    }
+
+    size_t len = strlen(text);
+    uint32_t pieces = len == 0 ? 1 : (len + UI_CMD_TEXT_LENGTH - 2) / (UI_CMD_TEXT_LENGTH - 1);
+    if (pieces > UI_QUEUE_LENGTH) {
+        pieces = UI_QUEUE_LENGTH;       // the rest could never be queued, show what fits
+        len = pieces * (UI_CMD_TEXT_LENGTH - 1);
+    }
+
+    uint32_t head = ring->head;
+    uint32_t depth = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (depth + pieces > UI_QUEUE_LENGTH) {
+        __atomic_add_fetch(&ui_stats.dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (uint32_t i = 0; i < pieces; i++) {
+        ui_cmd_t *cmd = &ring->cmds[(head + i) % UI_QUEUE_LENGTH];
+        size_t chunk = len < sizeof(cmd->text) - 1 ? len : sizeof(cmd->text) - 1;
+        cmd->type = UI_CMD_TEXTAREA_ADD;
+        memcpy(cmd->text, text, chunk);
+        cmd->text[chunk] = '\0';
+        text += chunk;
+        len -= chunk;
+    }
+    // the gui task sees the whole message at once
+    __atomic_store_n(&ring->head, head + pieces, __ATOMIC_RELEASE);
+    Core2ForAWS_Display_Wake();
+
+    __atomic_add_fetch(&ui_stats.posted, 1, __ATOMIC_RELAXED);
+    if (depth + pieces > ui_stats.max_depth) {
+        ui_stats.max_depth = depth + pieces;
+    }
+}
+
+static void ui_apply(const ui_cmd_t *cmd);
+
+// gui task, xGuiSemaphore held
+static void ui_drain(void) {
+    int64_t start_us = esp_timer_get_time();
+    uint32_t applied = 0;
+
+    if (__atomic_load_n(&ui_state.pending, __ATOMIC_RELAXED) != 0) {
+        ui_cmd_t cmds[UI_CMD_STATE_COUNT];
+        portENTER_CRITICAL(&ui_state_lock);
+        uint32_t pending = ui_state.pending;
+        ui_state.pending = 0;
+        for (int type = 0; type < UI_CMD_STATE_COUNT; type++) {
+            if (pending & (1u << type)) {
+                cmds[type] = ui_state.cmds[type];
+            }
+        }
+        portEXIT_CRITICAL(&ui_state_lock);
+
+        for (int type = 0; type < UI_CMD_STATE_COUNT; type++) {
+            if (pending & (1u << type)) {
+                ui_apply(&cmds[type]);
+                applied++;
+            }
+        }
+    }
+
+    for (int i = 0; i < UI_QUEUE_PRODUCERS; i++) {
+        ui_ring_t *ring = &ui_rings[i];
+        uint32_t tail = ring->tail;
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        while (tail != head) {
+            ui_apply(&ring->cmds[tail % UI_QUEUE_LENGTH]);
+            tail++;
+            __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+            applied++;
+        }
+    }
+
+    if (applied > 0) {
+        uint32_t drain_us = (uint32_t)(esp_timer_get_time() - start_us);
+        if (drain_us > ui_stats.drain_max_us) {
+            ui_stats.drain_max_us = drain_us;
+        }
+    }
+}
+
+void ui_get_queue_stats(ui_queue_stats_t *stats) {
+    *stats = ui_stats;
+    stats->gui_hold_max_us = Core2ForAWS_Display_GetMaxHoldTime();
+}
+
+void ui_get_render_stats(ui_render_stats_t *stats) {
+    *stats = ui_render_stats;
+    Core2ForAWS_Display_GetRedrawStats(&stats->redrawn_px, &stats->spi_bytes);
+    Core2ForAWS_Display_GetFrameStats(&stats->frames, &stats->frame_us, &stats->frame_max_us);
+
+    lv_font_glyph_cache_stats_t glyphs;
+    lv_font_glyph_cache_get_stats(&glyphs);
+    stats->glyph_hits = glyphs.hit;
+    stats->glyph_misses = glyphs.miss;
+}
+
+// gui task: sets a label's text unless it already shows it, returns whether it changed
+static bool ui_view_set_text(lv_obj_t *label, char *shown, size_t shown_size, const char *text) {
+    if (strcmp(shown, text) == 0) {
+        ui_render_stats.skipped++;
+        return false;
+    }
+    snprintf(shown, shown_size, "%s", text);
+    lv_label_set_text(label, text);
+    ui_render_stats.applied++;
+    return true;
+}
+
 // sets the value of the due bar ( 0 .. 100 )
 void ui_set_due_bar(int16_t value) {
-    lv_bar_set_value(due_bar, value, LV_ANIM_OFF);  
+    ui_cmd_t cmd = { .type = UI_CMD_DUE_BAR, .value = value };
+    ui_post_state(&cmd);
 }
 
 // sets the color of the leds ( example: 0x00FF00 )
 void ui_set_led_color(uint32_t color) {
+    if (__atomic_exchange_n(&ui_view.led_color, color, __ATOMIC_RELAXED) == color) {
+        __atomic_add_fetch(&ui_render_stats.skipped, 1, __ATOMIC_RELAXED);
+        return;     // the strips already show it
+    }
+    __atomic_add_fetch(&ui_render_stats.applied, 1, __ATOMIC_RELAXED);
+
     Core2ForAWS_Sk6812_SetSideColor(SK6812_SIDE_LEFT, color);  // setting both LED strips to the same color
     Core2ForAWS_Sk6812_SetSideColor(SK6812_SIDE_RIGHT, color); // setting both LED strips to the same color
     Core2ForAWS_Sk6812_Show();
@@ -45,6 +278,7 @@ void ui_set_led_color(uint32_t color) {
 static void cleaned_button_event_handler(lv_obj_t * obj, lv_event_t event)
 {
     if(event == LV_EVENT_CLICKED) {
+        IOT_LATENCY_TRACE(IOT_TRACE_UI_INPUT, 0);
         cleaned_button_clicked = true;  // store in variable that the button was clicked
         ESP_LOGI(TAG, "Done button clicked");
     }
@@ -59,10 +293,16 @@ bool is_cleaned_button_clicked() {
 
 // easter egg
 void ui_activate_easter_egg(char *text) {
+    ui_cmd_t cmd = { .type = UI_CMD_EASTER_EGG };
+    snprintf(cmd.text, sizeof(cmd.text), "%s", text);
+    ui_post_state(&cmd);
+}
+
+static void ui_apply_easter_egg(const char *text) {
     easter_egg_activated = true;
-    sprintf (easter_egg_text, "%s", text);
+    snprintf(easter_egg_text, sizeof(easter_egg_text), "%s", text);
 
-    lv_obj_set_hidden(out_txtarea, true);
+    lv_obj_set_hidden(out_logview, true);
     lv_obj_set_hidden(wifi_label, true);
     lv_obj_set_hidden(room_label, true);
     lv_obj_set_hidden(due_bar, true);
@@ -70,34 +310,26 @@ void ui_activate_easter_egg(char *text) {
     lv_obj_set_hidden(cleaned_button_label, true);
 }
 
-static void ui_textarea_prune(size_t new_text_length){
-    const char * current_text = lv_textarea_get_text(out_txtarea);
-    size_t current_text_len = strlen(current_text);
-    if(current_text_len + new_text_length >= MAX_TEXTAREA_LENGTH){
-        for(int i = 0; i < new_text_length; i++){
-            lv_textarea_set_cursor_pos(out_txtarea, 0);
-            lv_textarea_del_char_forward(out_txtarea);
-        }
-        lv_textarea_set_cursor_pos(out_txtarea, LV_TEXTAREA_CURSOR_LAST);
-    }
-}
-
 // adds text to textarea for debug purposes
 void ui_textarea_add(char *baseTxt, char *param, size_t paramLen) {
     if( baseTxt != NULL ){
-        xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+        const char *text = baseTxt;
+        char *formatted = NULL;
         if (param != NULL && paramLen != 0){
-            size_t baseTxtLen = strlen(baseTxt);
-            ui_textarea_prune(paramLen);
-            size_t bufLen = baseTxtLen + paramLen;
-            char buf[(int) bufLen];
-            sprintf(buf, baseTxt, param);
-            lv_textarea_add_text(out_txtarea, buf);
-        } 
-        else{
-            lv_textarea_add_text(out_txtarea, baseTxt); 
+            size_t bufLen = strlen(baseTxt) + paramLen + 1;
+            formatted = malloc(bufLen);
+            if (formatted == NULL) {
+                ESP_LOGE(TAG, "No memory for textarea text");
+                return;
+            }
+            snprintf(formatted, bufLen, baseTxt, param);
+            text = formatted;
         }
-        xSemaphoreGive(xGuiSemaphore);
+
+        // posted in pieces that fit a command, the gui task appends them in order
+        ui_post_text(text);
+
+        free(formatted);
     } 
     else{
         ESP_LOGE(TAG, "Textarea baseTxt is NULL!");
@@ -106,27 +338,64 @@ void ui_textarea_add(char *baseTxt, char *param, size_t paramLen) {
 
 // sets wifi label text and state
 void ui_wifi_label_update(bool state, char *ssid){
-    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
-    if (state == false) {   // if there is no wifi signal
-        lv_label_set_text(wifi_label, LV_SYMBOL_WIFI);  // black wifi symbol
-    } 
-    else{
-        char buffer[100];
-        sprintf (buffer, "#0000ff %s # %s", LV_SYMBOL_WIFI, ssid);  // blue wifi symbol + black wifi ssid text
-        lv_label_set_text(wifi_label, buffer);
+    ui_cmd_t cmd = { .type = UI_CMD_WIFI_LABEL, .wifi.state = state };
+    if (ssid != NULL) {
+        snprintf(cmd.wifi.ssid, sizeof(cmd.wifi.ssid), "%s", ssid);
     }
-    xSemaphoreGive(xGuiSemaphore);
+    ui_post_state(&cmd);
 }
 
 // sets date label based on date value
 void ui_date_label_update(rtc_date_t date){
-    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
-    char label_datetext[200];
-    sprintf(label_datetext, "%02d:%02d", date.hour, date.minute);   // label text shows only the current time in format e.g. 20:43
-    lv_label_set_text(date_label, easter_egg_activated ? easter_egg_text : label_datetext);
-    lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);     // re-aligning because text size can change based on current time
-    lv_label_set_align(date_label, LV_LABEL_ALIGN_CENTER);          // re-aligning because text size can change based on current time
-    xSemaphoreGive(xGuiSemaphore);
+    ui_cmd_t cmd = { .type = UI_CMD_DATE_LABEL, .date = date };
+    ui_post_state(&cmd);
+}
+
+// gui task: applies a posted update to the widgets
+static void ui_apply(const ui_cmd_t *cmd) {
+    switch (cmd->type) {
+    case UI_CMD_TEXTAREA_ADD:
+        lv_logview_add_text(out_logview, cmd->text);
+        ui_render_stats.applied++;
+        break;
+
+    case UI_CMD_WIFI_LABEL: {
+        char buffer[sizeof(ui_view.wifi_text)];
+        if (cmd->wifi.state == false) {   // if there is no wifi signal
+            sprintf (buffer, "%s", LV_SYMBOL_WIFI);  // black wifi symbol
+        } 
+        else{
+            sprintf (buffer, "#0000ff %s # %s", LV_SYMBOL_WIFI, cmd->wifi.ssid);  // blue wifi symbol + black wifi ssid text
+        }
+        ui_view_set_text(wifi_label, ui_view.wifi_text, sizeof(ui_view.wifi_text), buffer);
+        break;
+    }
+
+    case UI_CMD_DATE_LABEL: {
+        char label_datetext[sizeof(ui_view.date_text)];
+        sprintf(label_datetext, "%02d:%02d", cmd->date.hour, cmd->date.minute);   // label text shows only the current time in format e.g. 20:43
+        if (ui_view_set_text(date_label, ui_view.date_text, sizeof(ui_view.date_text),
+                             easter_egg_activated ? easter_egg_text : label_datetext)) {
+            lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);     // re-aligning because text size can change based on current time
+            lv_label_set_align(date_label, LV_LABEL_ALIGN_CENTER);          // re-aligning because text size can change based on current time
+        }
+        break;
+    }
+
+    case UI_CMD_DUE_BAR:
+        if (cmd->value == ui_view.due_bar) {
+            ui_render_stats.skipped++;
+            break;
+        }
+        ui_view.due_bar = cmd->value;
+        lv_bar_set_value(due_bar, cmd->value, LV_ANIM_OFF);
+        ui_render_stats.applied++;
+        break;
+
+    case UI_CMD_EASTER_EGG:
+        ui_apply_easter_egg(cmd->text);
+        break;
+    }
 }
 
 // initializes ui components - setting styles, and positioning UI elements with default values
@@ -146,6 +415,7 @@ void ui_init() {
     wifi_label = lv_label_create(lv_scr_act(), NULL);
     lv_obj_align(wifi_label, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 6);
     lv_label_set_text(wifi_label, LV_SYMBOL_WIFI);  // default value until connection is ready
+    snprintf(ui_view.wifi_text, sizeof(ui_view.wifi_text), "%s", LV_SYMBOL_WIFI);
     lv_label_set_recolor(wifi_label, true);
 
     room_label = lv_label_create(lv_scr_act(), NULL);
@@ -156,6 +426,7 @@ void ui_init() {
     date_label = lv_label_create(lv_scr_act(), NULL);
     lv_obj_add_style(date_label, LV_OBJ_PART_MAIN, &title_style);
     lv_label_set_text(date_label, "00:00");     // default value until connection is ready
+    snprintf(ui_view.date_text, sizeof(ui_view.date_text), "00:00");
     lv_obj_align(date_label, NULL, LV_ALIGN_IN_TOP_MID, 0, 60);
     lv_label_set_align(date_label, LV_LABEL_ALIGN_CENTER);
     lv_label_set_recolor(date_label, true);
@@ -164,6 +435,7 @@ void ui_init() {
     lv_obj_set_size(due_bar, 180, 20);
     lv_obj_align(due_bar, NULL, LV_ALIGN_IN_TOP_MID, 0, 140);
     lv_bar_set_value(due_bar, 100, LV_ANIM_OFF);
+    ui_view.due_bar = 100;
 
     static lv_style_t cleaned_button_style;
     lv_style_set_border_color(&cleaned_button_style, LV_STATE_DEFAULT, LV_COLOR_GREEN);
@@ -179,18 +451,16 @@ void ui_init() {
     lv_obj_add_style(cleaned_button_label, LV_OBJ_PART_MAIN, &subtitle_style);
     lv_label_set_text(cleaned_button_label, "Cleaned");
     
-    out_txtarea = lv_textarea_create(lv_scr_act(), NULL);   // for debug
-    lv_obj_set_size(out_txtarea, 300, 180);
-    lv_obj_align(out_txtarea, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -12);
-    lv_textarea_set_max_length(out_txtarea, MAX_TEXTAREA_LENGTH);
-    lv_textarea_set_text_sel(out_txtarea, false);
-    lv_textarea_set_cursor_hidden(out_txtarea, true);
-    lv_textarea_set_text(out_txtarea, "Starting CleaningTracker\n");
-    lv_obj_set_hidden(out_txtarea, true);   // hidden for release
+    out_logview = lv_logview_create(lv_scr_act(), NULL);   // for debug
+    lv_logview_set_buffer(out_logview, LOG_LINE_CNT, LOG_LINE_LEN);
+    lv_obj_set_size(out_logview, 300, 180);
+    lv_obj_align(out_logview, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -12);
+    lv_logview_add_text(out_logview, "Starting CleaningTracker\n");
+    lv_obj_set_hidden(out_logview, true);   // hidden for release
     
     xSemaphoreGive(xGuiSemaphore);
 
-    Core2ForAWS_Sk6812_SetSideColor(SK6812_SIDE_LEFT, 0x0000FF);    // set both LED strips to Blue until connection is ready
-    Core2ForAWS_Sk6812_SetSideColor(SK6812_SIDE_RIGHT, 0x0000FF);   // set both LED strips to Blue until connection is ready
-    Core2ForAWS_Sk6812_Show();
+    Core2ForAWS_Display_SetUpdateCallback(ui_drain);    // posted updates are applied from now on
+
+    ui_set_led_color(0x0000FF);     // set both LED strips to Blue until connection is ready
 }